@@ -0,0 +1,27 @@
+# Copyright 2022 The Magma Authors.
+
+# This source code is licensed under the BSD-style license found in the
+# LICENSE file in the root directory of this source tree.
+
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""
+Benchmark binaries. They are not tests and are tagged manual, so that
+`bazel build //...` and `bazel test //...` skip them. Build or run one
+explicitly, e.g. `bazel run //path/to:bench_name -- <args>`.
+"""
+
+load("@rules_cc//cc:defs.bzl", "cc_binary")
+
+def cc_bench(name, srcs, deps = [], tags = [], **kwargs):
+    cc_binary(
+        name = name,
+        srcs = srcs,
+        deps = deps,
+        tags = tags + ["manual", "benchmark"],
+        **kwargs
+    )
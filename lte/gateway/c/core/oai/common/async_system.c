@@ -83,7 +83,7 @@ static int handle_message(zloop_t* loop, zsock_t* reader, void* arg) {
 
     case TERMINATE_MESSAGE: {
       itti_free_msg_content(received_message_p);
-      free(received_message_p);
+      itti_free_msg(received_message_p);
       async_system_exit();
     } break;
 
@@ -95,7 +95,7 @@ static int handle_message(zloop_t* loop, zsock_t* reader, void* arg) {
   }
 
   itti_free_msg_content(received_message_p);
-  free(received_message_p);
+  itti_free_msg(received_message_p);
   return 0;
 }
 
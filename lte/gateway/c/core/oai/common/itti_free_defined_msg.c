@@ -321,6 +321,9 @@ void itti_free_msg_content(MessageDef* const message_p) {
       free_wrapper((void**)&message_p->ittiMsg.ngap_gnb_initiated_reset_req
                        .ue_to_reset_list);
       break;
+    case UDP_DATA_BATCH_IND:
+      free_wrapper((void**)&message_p->ittiMsg.udp_data_batch_ind.datagrams);
+      break;
     default:;
   }
 }
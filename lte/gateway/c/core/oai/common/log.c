@@ -58,6 +58,7 @@
 #include "lte/gateway/c/core/common/assertions.h"
 #include "lte/gateway/c/core/common/dynamic_memory_check.h"
 #include "lte/gateway/c/core/oai/common/log.h"
+#include "lte/gateway/c/core/oai/common/log_binary.h"
 #include "lte/gateway/c/core/oai/common/shared_ts_log.h"
 #include "lte/gateway/c/core/oai/lib/hashtable/hashtable.h"
 #include "lte/gateway/c/core/oai/lib/itti/intertask_interface.h"
@@ -76,20 +77,11 @@
 #define LOG_CONNECT_PERIOD_MSEC 2000
 #define LOG_FLUSH_PERIOD_MSEC 50
 
-#define LOG_DISPLAYED_FILENAME_MAX_LENGTH 32
-#define LOG_DISPLAYED_LOG_LEVEL_NAME_MAX_LENGTH 5
-#define LOG_DISPLAYED_PROTO_NAME_MAX_LENGTH 6
 #define LOG_FUNC_INDENT_SPACES 3
 #define LOG_INDENT_MAX 30
 #define LOG_LEVEL_NAME_MAX_LENGTH 10
 
-#define LOG_CTXT_INFO_FMT \
-  "%06" PRIu64 " %s %08lX %-*.*s %-*.*s %-*.*s:%04u   %*s"
-#define LOG_CTXT_INFO_ID_FMT \
-  "%06" PRIu64 " %s %08lX %-*.*s %-*.*s %-*.*s:%04u   [%lu]%*s"
-
 #define LOG_MAGMA_REPO_ROOT "/oai/"
-#define MAX_TIME_STR_LEN 32
 //-------------------------------
 
 typedef unsigned long log_message_number_t;
@@ -128,6 +120,10 @@ typedef struct oai_log_s {
   bool is_output_is_fd; /* We may want to not use syslog even if exe is a daemon
                          */
   bool is_async;        /* We way want no buffering */
+  bool is_binary;       /* Messages formatted by the log thread */
+  bool is_binary_file;  /* Binary records written to log_fd */
+  bool is_itti_connected;
+  bool is_task_created;
   bool is_ansi_codes;   /* ANSI codes for color in console output */
   bstring bserver_address; /*!< \brief TCP remote (or local) server hostname */
   bstring bserver_port;    /*!< \brief TCP remote (or local) server port     */
@@ -160,6 +156,11 @@ typedef struct oai_log_s {
       log_handler; /*!< \brief Logging handler function pointers */
   oai_shared_log_handler_t
       shared_log_handler; /*!< \brief Logging handler function pointers */
+  log_binary_clock_t binary_first_clock; /*!< \brief First and last samples
+                                            converting the timestamps */
+  log_binary_clock_t binary_last_clock;
+  log_binary_strings_t
+      binary_strings; /*!< \brief Strings written to the binary log file */
 } oai_log_t;
 
 #define LOG_START_USE g_oai_log.log_handler.log_start_use
@@ -180,6 +181,8 @@ void log_message_finish_async(struct shared_log_queue_item_s* messageP);
 
 task_zmq_ctx_t log_task_zmq_ctx;
 static int timer_id = -1;
+// Context of the thread, in the hashtable too
+static __thread log_thread_ctxt_t* log_thread_ctxt = NULL;
 
 //------------------------------------------------------------------------------
 static log_queue_item_t* new_queue_item(void) {
@@ -281,6 +284,10 @@ static void get_thread_context(log_thread_ctxt_t** thread_ctxt) {
   hashtable_rc_t hash_rc = HASH_TABLE_OK;
 
   if (NULL == *thread_ctxt) {
+    if (log_thread_ctxt) {
+      *thread_ctxt = log_thread_ctxt;
+      return;
+    }
     pthread_t p = pthread_self();
     hash_rc = hashtable_ts_get(g_oai_log.thread_context_htbl, (hash_key_t)p,
                                (void**)thread_ctxt);
@@ -292,6 +299,7 @@ static void get_thread_context(log_thread_ctxt_t** thread_ctxt) {
       AssertFatal(HASH_TABLE_KEY_NOT_EXISTS != hash_rc,
                   "Could not get new log thread context\n");
     }
+    log_thread_ctxt = *thread_ctxt;
   }
 }
 
@@ -300,7 +308,7 @@ static int handle_message(zloop_t* loop, zsock_t* reader, void* arg) {
 
   switch (ITTI_MSG_ID(received_message_p)) {
     case TERMINATE_MESSAGE: {
-      free(received_message_p);
+      itti_free_msg(received_message_p);
       log_exit();
     } break;
 
@@ -308,10 +316,83 @@ static int handle_message(zloop_t* loop, zsock_t* reader, void* arg) {
     } break;
   }
 
-  free(received_message_p);
+  itti_free_msg(received_message_p);
   return 0;
 }
 
+//------------------------------------------------------------------------------
+// Formats a record queued by a logging thread, or writes it to the binary log
+// file with the strings it refers to
+static void log_binary_handle_record(const log_binary_record_t* record,
+                                     __attribute__((unused)) void* arg) {
+  char line[LOG_BINARY_LINE_MAX];
+  int rv = 0;
+
+  if (LOG_BINARY_RECORD_MESSAGE == record->type) {
+    const log_binary_message_t* message = (const log_binary_message_t*)record;
+    const char* format = (const char*)(uintptr_t)message->format;
+    const char* file =
+        get_short_file_name((const char*)(uintptr_t)message->file);
+
+    if (g_oai_log.is_binary_file) {
+      if (!log_binary_strings_get(&g_oai_log.binary_strings,
+                                  message->format)) {
+        log_binary_strings_put(&g_oai_log.binary_strings, message->format,
+                               format);
+        rv |= log_binary_write_string(g_oai_log.log_fd, message->format,
+                                      format);
+      }
+      if (!log_binary_strings_get(&g_oai_log.binary_strings, message->file)) {
+        log_binary_strings_put(&g_oai_log.binary_strings, message->file, file);
+        rv |= log_binary_write_string(g_oai_log.log_fd, message->file, file);
+      }
+      rv |= log_binary_write_record(g_oai_log.log_fd, record);
+    } else {
+      rv = log_binary_format_line(
+          message, format, file, &g_oai_log.log_level2str[message->level][0],
+          &g_oai_log.log_proto2str[message->proto][0],
+          __sync_fetch_and_add(&g_oai_log.log_message_number, 1),
+          log_binary_realtime_ns(&g_oai_log.binary_first_clock,
+                                 &g_oai_log.binary_last_clock,
+                                 message->timestamp),
+          line, sizeof(line));
+      if (rv >= 0) {
+        if (g_oai_log.is_ansi_codes) {
+          strncat(line, ANSI_COLOR_RESET, sizeof(line) - rv - 1);
+        }
+        log_string(g_oai_log.log_level2syslog[message->level], line);
+      }
+    }
+  } else if (LOG_BINARY_RECORD_DROPPED == record->type) {
+    if (g_oai_log.is_binary_file) {
+      rv = log_binary_write_record(g_oai_log.log_fd, record);
+    } else {
+      log_binary_format_dropped((const log_binary_dropped_t*)record, line,
+                                sizeof(line));
+      log_string(g_oai_log.log_level2syslog[OAILOG_LEVEL_WARNING], line);
+    }
+  }
+  if (rv < 0) {
+    OAI_FPRINTF_ERR("Error while logging binary record %u\n", record->type);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Drains the messages of the logging threads
+static void log_binary_flush(void) {
+  if (!g_oai_log.is_binary) {
+    return;
+  }
+  log_binary_clock_sample(&g_oai_log.binary_last_clock);
+  if (g_oai_log.is_binary_file) {
+    log_binary_write_clock(g_oai_log.log_fd, &g_oai_log.binary_last_clock);
+  }
+  log_binary_drain(log_binary_handle_record, NULL);
+  if (g_oai_log.is_binary_file) {
+    fflush(g_oai_log.log_fd);
+  }
+}
+
 //------------------------------------------------------------------------------
 static int handle_timer(zloop_t* loop, int id, void* arg) {
   timer_id = -1;
@@ -320,7 +401,7 @@ static int handle_timer(zloop_t* loop, int id, void* arg) {
     timer_id = start_timer(&log_task_zmq_ctx, LOG_CONNECT_PERIOD_MSEC,
                            TIMER_REPEAT_ONCE, handle_timer, NULL);
   } else {
-    // log_flush_messages ();
+    log_binary_flush();
     timer_id = start_timer(&log_task_zmq_ctx, LOG_FLUSH_PERIOD_MSEC,
                            TIMER_REPEAT_ONCE, handle_timer, NULL);
   }
@@ -446,6 +527,38 @@ static void log_signal_callback_handler(int signum) {
     return;
   }
 }
+//------------------------------------------------------------------------------
+static void log_create_task(void) {
+  if (!g_oai_log.is_task_created) {
+    int rv = itti_create_task(TASK_LOG, &log_thread, NULL);
+    AssertFatal(rv == 0, "Create task for OAI logging failed!\n");
+    g_oai_log.is_task_created = true;
+  }
+}
+
+//------------------------------------------------------------------------------
+// The logging threads queue the messages from now on, the log thread formats
+// them or writes them as is to the log file
+static void log_configure_binary(void) {
+  log_binary_init();
+  log_binary_clock_sample(&g_oai_log.binary_first_clock);
+  g_oai_log.binary_last_clock = g_oai_log.binary_first_clock;
+  if (g_oai_log.is_binary_file) {
+    int rv = log_binary_write_header(
+        g_oai_log.log_fd, &g_oai_log.log_level2str[0][0], MAX_LOG_LEVEL,
+        LOG_LEVEL_NAME_MAX_LENGTH, &g_oai_log.log_proto2str[0][0],
+        MAX_LOG_PROTOS, LOG_MAX_PROTO_NAME_LENGTH);
+    rv |= log_binary_write_clock(g_oai_log.log_fd,
+                                 &g_oai_log.binary_first_clock);
+    AssertFatal(0 == rv, "Could not write binary log file header : %s",
+                strerror(errno));
+  }
+  g_oai_log.is_binary = true;
+  if (g_oai_log.is_itti_connected) {
+    log_create_task();
+  }
+}
+
 //------------------------------------------------------------------------------
 void log_configure(const log_config_t* const config) {
   if (NULL == config) {
@@ -513,20 +626,17 @@ void log_configure(const log_config_t* const config) {
         biseqcstrcaseless(config->output, LOG_CONFIG_STRING_OUTPUT_SYSLOG)) {
       // Output to syslog
       init_syslog();
-      return;
-    }
-    if (1 ==
-        biseqcstrcaseless(config->output, LOG_CONFIG_STRING_OUTPUT_CONSOLE)) {
+    } else if (1 == biseqcstrcaseless(config->output,
+                                      LOG_CONFIG_STRING_OUTPUT_CONSOLE)) {
       init_console();
-      return;
-    }
-    // if seems to be a file path
-    if (('.' == bchar(config->output, 0)) ||
-        ('/' == bchar(config->output, 0))) {
+    } else if (('.' == bchar(config->output, 0)) ||
+               ('/' == bchar(config->output, 0))) {
+      // if seems to be a file path
       g_oai_log.log_fd = fopen(bdata(config->output), "w");
       AssertFatal(NULL != g_oai_log.log_fd, "Could not open log file %s : %s",
                   bdata(config->output), strerror(errno));
       g_oai_log.is_output_is_fd = true;
+      g_oai_log.is_binary_file = config->is_output_binary;
     } else {
       // may be a TCP server address host:portnum
       g_oai_log.bserver_address = bstrcpy(config->output);
@@ -546,6 +656,9 @@ void log_configure(const log_config_t* const config) {
       log_connect_to_server();
     }
   }
+  if (config->is_output_binary) {
+    log_configure_binary();
+  }
 }
 /*
  * Disabling below function to get actual time of the day in the logs
@@ -567,7 +680,7 @@ static void log_get_readable_cur_time(time_t* cur_time, char* time_str) {
   struct tm* cur_local_time;
   cur_local_time = localtime(cur_time);
   // get the current local time in readable string format
-  strftime(time_str, MAX_TIME_STR_LEN, "%a %b %d %H:%M:%S %Y",
+  strftime(time_str, MAX_TIME_STR_LEN, LOG_CTXT_INFO_TIME_FMT,
            (const struct tm*)cur_local_time);
 }
 
@@ -739,10 +852,9 @@ int log_init(const char* app_name, const log_level_t default_log_levelP,
 //------------------------------------------------------------------------------
 // listen to ITTI events
 void log_itti_connect(void) {
-  if (g_oai_log.is_async) {
-    int rv = 0;
-    rv = itti_create_task(TASK_LOG, &log_thread, NULL);
-    AssertFatal(rv == 0, "Create task for OAI logging failed!\n");
+  g_oai_log.is_itti_connected = true;
+  if (g_oai_log.is_async || g_oai_log.is_binary) {
+    log_create_task();
   }
 }
 //------------------------------------------------------------------------------
@@ -779,11 +891,12 @@ void log_flush_message(struct shared_log_queue_item_s* item_p) {
 
 //------------------------------------------------------------------------------
 static void log_exit(void) {
-  assert(g_oai_log.is_async);
+  assert(g_oai_log.is_async || g_oai_log.is_binary);
 
   OAI_FPRINTF_INFO("[TRACE] Entering %s\n", __FUNCTION__);
   stop_timer(&log_task_zmq_ctx, timer_id);
   destroy_task_context(&log_task_zmq_ctx);
+  log_binary_flush();
   if (g_oai_log.log_fd) {
     int rv = fflush(g_oai_log.log_fd);
 
@@ -802,6 +915,7 @@ static void log_exit(void) {
     closelog();
   }
   hashtable_ts_destroy(g_oai_log.thread_context_htbl);
+  log_binary_strings_free(&g_oai_log.binary_strings);
   bdestroy_wrapper(&g_oai_log.bserver_address);
   bdestroy_wrapper(&g_oai_log.bserver_port);
   OAI_FPRINTF_INFO("[TRACE] Leaving %s\n", __FUNCTION__);
@@ -853,18 +967,8 @@ static void log_stream_hex_async(
   size_t octet_index = 0;
   int rv = 0;
   log_thread_ctxt_t* thread_ctxt = NULL;
-  hashtable_rc_t hash_rc = HASH_TABLE_OK;
 
-  pthread_t p = pthread_self();
-  hash_rc = hashtable_ts_get(g_oai_log.thread_context_htbl, (hash_key_t)p,
-                             (void**)&thread_ctxt);
-  if (HASH_TABLE_KEY_NOT_EXISTS == hash_rc) {
-    // make the thread safe LFDS collections usable by this thread
-    LOG_START_USE();
-  }
-  hash_rc = hashtable_ts_get(g_oai_log.thread_context_htbl, (hash_key_t)p,
-                             (void**)&thread_ctxt);
-  AssertFatal(NULL != thread_ctxt, "Could not get new log thread context\n");
+  get_thread_context(&thread_ctxt);
   if (messageP) {
     log_message_start_async(thread_ctxt, log_levelP, protoP, &message,
                             source_fileP, line_numP, "hex stream ");
@@ -1073,7 +1177,6 @@ void log_message_start_async(
   int rv = 0;
   int filename_length = 0;
   log_thread_ctxt_t* thread_ctxt = thread_ctxtP;
-  hashtable_rc_t hash_rc = HASH_TABLE_OK;
 
   if ((MIN_LOG_PROTOS > protoP) || (MAX_LOG_PROTOS <= protoP)) {
     return;
@@ -1085,19 +1188,7 @@ void log_message_start_async(
     return;
   }
 
-  if (NULL == thread_ctxt) {
-    pthread_t p = pthread_self();
-    hash_rc = hashtable_ts_get(g_oai_log.thread_context_htbl, (hash_key_t)p,
-                               (void**)&thread_ctxt);
-    if (HASH_TABLE_KEY_NOT_EXISTS == hash_rc) {
-      // make the thread safe LFDS collections usable by this thread
-      LOG_START_USE();
-      hash_rc = hashtable_ts_get(g_oai_log.thread_context_htbl, (hash_key_t)p,
-                                 (void**)&thread_ctxt);
-      AssertFatal(NULL != thread_ctxt,
-                  "Could not get new log thread context\n");
-    }
-  }
+  get_thread_context(&thread_ctxt);
 
   if (!*messageP) {
     *messageP = get_new_log_queue_item(SH_TS_LOG_TXT);
@@ -1180,18 +1271,8 @@ void log_func(const bool is_enteringP, const log_proto_t protoP,
               const char* const source_fileP, const unsigned int line_numP,
               const char* const functionP) {
   log_thread_ctxt_t* thread_ctxt = NULL;
-  hashtable_rc_t hash_rc = HASH_TABLE_OK;
-  pthread_t p = pthread_self();
 
-  hash_rc = hashtable_ts_get(g_oai_log.thread_context_htbl, (hash_key_t)p,
-                             (void**)&thread_ctxt);
-  if (HASH_TABLE_KEY_NOT_EXISTS == hash_rc) {
-    // make the thread safe LFDS collections usable by this thread
-    LOG_START_USE();
-  }
-  hash_rc = hashtable_ts_get(g_oai_log.thread_context_htbl, (hash_key_t)p,
-                             (void**)&thread_ctxt);
-  AssertFatal(NULL != thread_ctxt, "Could not get new log thread context\n");
+  get_thread_context(&thread_ctxt);
   if (is_enteringP) {
     log_message(thread_ctxt, OAILOG_LEVEL_TRACE, protoP, source_fileP,
                 line_numP, "Entering %s()\n", functionP);
@@ -1214,23 +1295,42 @@ void log_func_return(const log_proto_t protoP, const char* const source_fileP,
                      const unsigned int line_numP, const char* const functionP,
                      const long return_codeP) {
   log_thread_ctxt_t* thread_ctxt = NULL;
-  hashtable_rc_t hash_rc = HASH_TABLE_OK;
-  pthread_t p = pthread_self();
 
-  hash_rc = hashtable_ts_get(g_oai_log.thread_context_htbl, (hash_key_t)p,
-                             (void**)&thread_ctxt);
-  if (HASH_TABLE_KEY_NOT_EXISTS == hash_rc) {
-    // make the thread safe LFDS collections usable by this thread
-    LOG_START_USE();
-  }
-  hash_rc = hashtable_ts_get(g_oai_log.thread_context_htbl, (hash_key_t)p,
-                             (void**)&thread_ctxt);
-  AssertFatal(NULL != thread_ctxt, "Could not get new log thread context\n");
+  get_thread_context(&thread_ctxt);
   thread_ctxt->indent -= LOG_FUNC_INDENT_SPACES;
   if (thread_ctxt->indent < 0) thread_ctxt->indent = 0;
   log_message(thread_ctxt, OAILOG_LEVEL_TRACE, protoP, source_fileP, line_numP,
               "Leaving %s() (rc=%ld)\n", functionP, return_codeP);
 }
+//------------------------------------------------------------------------------
+// Queues the message for the log thread, returns false if it has to be
+// formatted here
+static bool log_message_binary(log_thread_ctxt_t* thread_ctxtP,
+                               const log_level_t log_levelP,
+                               const log_proto_t protoP,
+                               const char* const source_fileP,
+                               const unsigned int line_numP,
+                               const bool has_prefix_id,
+                               const uint64_t prefix_id, const char* format,
+                               va_list args) {
+  log_thread_ctxt_t* thread_ctxt = thread_ctxtP;
+
+  if (!log_is_enabled(log_levelP, protoP)) {
+    return true;
+  }
+  get_thread_context(&thread_ctxt);
+
+  log_binary_message_t message = {
+      .level = log_levelP,
+      .proto = protoP,
+      .flags = has_prefix_id ? LOG_BINARY_FLAG_PREFIX_ID : 0,
+      .line = line_numP,
+      .indent = thread_ctxt->indent,
+      .tid = (uint64_t)thread_ctxt->tid,
+      .prefix_id = prefix_id};
+  return log_binary_message(&message, source_fileP, format, args);
+}
+
 //------------------------------------------------------------------------------
 void log_message(log_thread_ctxt_t* thread_ctxtP, const log_level_t log_levelP,
                  const log_proto_t protoP, const char* const source_fileP,
@@ -1240,6 +1340,17 @@ void log_message(log_thread_ctxt_t* thread_ctxtP, const log_level_t log_levelP,
   log_queue_item_t* new_item_p_sync = NULL;
   struct shared_log_queue_item_s* new_item_p_async = NULL;
 
+  if (g_oai_log.is_binary) {
+    va_start(args, format);
+    bool is_queued =
+        log_message_binary(thread_ctxtP, log_levelP, protoP, source_fileP,
+                           line_numP, false, 0, format, args);
+    va_end(args);
+    if (is_queued) {
+      return;
+    }
+  }
+
   va_start(args, format);
   log_message_int(thread_ctxtP, log_levelP, protoP, &new_item_p, source_fileP,
                   line_numP, format, args);
@@ -1273,6 +1384,17 @@ void log_message_prefix_id(const log_level_t log_levelP,
   log_queue_item_t* new_item_p_sync = NULL;
   struct shared_log_queue_item_s* new_item_p_async = NULL;
 
+  if (g_oai_log.is_binary) {
+    va_start(args, format);
+    bool is_queued = log_message_binary(NULL, log_levelP, protoP, source_fileP,
+                                        line_numP, true, prefix_id, format,
+                                        args);
+    va_end(args);
+    if (is_queued) {
+      return;
+    }
+  }
+
   va_start(args, format);
   log_message_int_prefix_id(log_levelP, protoP, &new_item_p, source_fileP,
                             line_numP, prefix_id, format, args);
@@ -104,6 +104,7 @@ extern int fd_g_debug_lvl;
 #define ANSI_COLOR_CONCEALED_ON "\x1b[8m"
 
 #define LOG_CONFIG_STRING_ASYNC_SYSTEM_LOG_LEVEL "ASYNC_SYSTEM"
+#define LOG_CONFIG_STRING_OUTPUT_BINARY "BINARY"
 #define LOG_CONFIG_STRING_COLOR "COLOR"
 #define LOG_CONFIG_STRING_OUTPUT_CONSOLE "CONSOLE"
 #define LOG_CONFIG_STRING_GTPV1U_LOG_LEVEL "GTPV1U_LOG_LEVEL"
@@ -220,6 +221,8 @@ typedef struct log_config_s {
                      file`", "`IPv4@`:`TCP port num`"} . */
   bool is_output_thread_safe; /*!< \brief Is final string goes in a thread safe
                                  buffer of is flushed without care . */
+  bool is_output_binary; /*!< \brief Are messages formatted by the log thread,
+                            or by oai_log_decode if output is a file . */
   log_level_t
       udp_log_level; /*!< \brief UDP ITTI task log level starting from
                         OAILOG_LEVEL_EMERGENCY up to MAX_LOG_LEVEL (no log) */
@@ -0,0 +1,888 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define _GNU_SOURCE
+#include <link.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "lte/gateway/c/core/oai/common/log_binary.h"
+
+#define LOG_BINARY_CACHE_LINE 64
+#define LOG_BINARY_RING_MASK (LOG_BINARY_RING_SIZE - 1)
+#define LOG_BINARY_ALIGN(size) (((size) + 7) & ~(size_t)7)
+#define LOG_BINARY_STRING_NULL UINT64_MAX
+// Conversion specification rebuilt with the ll length modifier
+#define LOG_BINARY_SPEC_MAX 32
+#define LOG_BINARY_STRINGS_MIN_CAPACITY 256
+
+typedef struct log_binary_ring_s {
+  uint64_t head __attribute__((aligned(LOG_BINARY_CACHE_LINE)));
+  uint64_t dropped;
+  uint64_t tail __attribute__((aligned(LOG_BINARY_CACHE_LINE)));
+  uint64_t dropped_reported;
+  pthread_t tid;
+  bool exited;
+  struct log_binary_ring_s* next;
+  uint8_t record[LOG_BINARY_RECORD_MAX]
+      __attribute__((aligned(LOG_BINARY_CACHE_LINE)));
+  uint8_t data[LOG_BINARY_RING_SIZE];
+} log_binary_ring_t;
+
+// Read-only segments of the loaded objects, where the format literals are
+typedef struct log_binary_range_s {
+  uintptr_t start;
+  uintptr_t end;
+} log_binary_range_t;
+
+typedef enum {
+  LOG_BINARY_LENGTH_NONE = 0,
+  LOG_BINARY_LENGTH_HH,
+  LOG_BINARY_LENGTH_H,
+  LOG_BINARY_LENGTH_L,
+  LOG_BINARY_LENGTH_LL,
+  LOG_BINARY_LENGTH_J,
+  LOG_BINARY_LENGTH_Z,
+  LOG_BINARY_LENGTH_T,
+} log_binary_length_t;
+
+typedef struct log_binary_spec_s {
+  size_t length;
+  int num_stars;
+  log_binary_length_t length_modifier;
+  char conversion;
+} log_binary_spec_t;
+
+typedef struct log_binary_line_s {
+  char* buffer;
+  size_t size;
+  size_t length;
+} log_binary_line_t;
+
+static pthread_once_t log_binary_once = PTHREAD_ONCE_INIT;
+static log_binary_range_t* log_binary_ranges = NULL;
+static size_t log_binary_num_ranges = 0;
+
+static pthread_key_t log_binary_ring_key;
+static __thread log_binary_ring_t* log_binary_ring = NULL;
+// Rings of the running threads and of the exited threads not drained yet
+static pthread_mutex_t log_binary_rings_mutex = PTHREAD_MUTEX_INITIALIZER;
+static log_binary_ring_t* log_binary_rings = NULL;
+
+//------------------------------------------------------------------------------
+static int log_binary_add_ranges(struct dl_phdr_info* info, size_t size,
+                                 void* data) {
+  (void)size;
+  (void)data;
+  for (int i = 0; i < info->dlpi_phnum; i++) {
+    const ElfW(Phdr)* phdr = &info->dlpi_phdr[i];
+    if ((PT_LOAD != phdr->p_type) || (phdr->p_flags & PF_W)) {
+      continue;
+    }
+    log_binary_range_t* ranges =
+        realloc(log_binary_ranges,
+                (log_binary_num_ranges + 1) * sizeof(log_binary_range_t));
+    if (!ranges) {
+      return 1;
+    }
+    log_binary_ranges = ranges;
+    log_binary_ranges[log_binary_num_ranges].start =
+        info->dlpi_addr + phdr->p_vaddr;
+    log_binary_ranges[log_binary_num_ranges].end =
+        info->dlpi_addr + phdr->p_vaddr + phdr->p_memsz;
+    log_binary_num_ranges++;
+  }
+  return 0;
+}
+
+static int log_binary_compare_ranges(const void* a, const void* b) {
+  const log_binary_range_t* range_a = (const log_binary_range_t*)a;
+  const log_binary_range_t* range_b = (const log_binary_range_t*)b;
+  return (range_a->start > range_b->start) - (range_a->start < range_b->start);
+}
+
+static void log_binary_release_ring(void* ring_p) {
+  log_binary_ring_t* ring = (log_binary_ring_t*)ring_p;
+  // The log thread frees the ring once drained
+  __atomic_store_n(&ring->exited, true, __ATOMIC_RELEASE);
+  log_binary_ring = NULL;
+}
+
+static void log_binary_init_once(void) {
+  dl_iterate_phdr(log_binary_add_ranges, NULL);
+  qsort(log_binary_ranges, log_binary_num_ranges, sizeof(log_binary_range_t),
+        log_binary_compare_ranges);
+  pthread_key_create(&log_binary_ring_key, log_binary_release_ring);
+}
+
+//------------------------------------------------------------------------------
+// Scans the read-only segments of the objects loaded at this point, formats
+// in libraries opened later are logged as text
+void log_binary_init(void) {
+  pthread_once(&log_binary_once, log_binary_init_once);
+}
+
+//------------------------------------------------------------------------------
+// Whether the string is in a read-only segment, so that its address stays
+// valid and identifies the same text until the log thread formats it
+static bool log_binary_is_literal(const char* string) {
+  uintptr_t address = (uintptr_t)string;
+  size_t low = 0;
+  size_t high = log_binary_num_ranges;
+
+  while (low < high) {
+    size_t mid = (low + high) / 2;
+    if (address < log_binary_ranges[mid].start) {
+      high = mid;
+    } else if (address >= log_binary_ranges[mid].end) {
+      low = mid + 1;
+    } else {
+      return true;
+    }
+  }
+  return false;
+}
+
+//------------------------------------------------------------------------------
+static inline uint64_t log_binary_timestamp(void) {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+void log_binary_clock_sample(log_binary_clock_t* clock) {
+  struct timespec ts;
+  clock->timestamp = log_binary_timestamp();
+  clock_gettime(CLOCK_REALTIME, &ts);
+  clock->realtime_ns = ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+//------------------------------------------------------------------------------
+// Converts a message timestamp with the rate measured between the first and
+// the last clock samples, from the last sample
+int64_t log_binary_realtime_ns(const log_binary_clock_t* first,
+                               const log_binary_clock_t* last,
+                               uint64_t timestamp) {
+  double ns_per_tick = 1.0;
+
+  if ((last->timestamp > first->timestamp) &&
+      (last->realtime_ns > first->realtime_ns)) {
+    ns_per_tick = (double)(last->realtime_ns - first->realtime_ns) /
+                  (double)(last->timestamp - first->timestamp);
+  }
+  return last->realtime_ns +
+         (int64_t)((double)(int64_t)(timestamp - last->timestamp) *
+                   ns_per_tick);
+}
+
+//------------------------------------------------------------------------------
+static log_binary_ring_t* log_binary_register_ring(void) {
+  log_binary_ring_t* ring =
+      aligned_alloc(LOG_BINARY_CACHE_LINE, sizeof(log_binary_ring_t));
+  if (!ring) {
+    return NULL;
+  }
+  memset(ring, 0, offsetof(log_binary_ring_t, record));
+  ring->tid = pthread_self();
+
+  log_binary_init();
+  pthread_setspecific(log_binary_ring_key, ring);
+  pthread_mutex_lock(&log_binary_rings_mutex);
+  ring->next = log_binary_rings;
+  log_binary_rings = ring;
+  pthread_mutex_unlock(&log_binary_rings_mutex);
+
+  log_binary_ring = ring;
+  return ring;
+}
+
+//------------------------------------------------------------------------------
+// Parses the conversion specification at spec_start, returns false for the
+// conversions the binary logging does not copy: %n, %m, positional
+// arguments, wide characters and long doubles
+static bool log_binary_parse_spec(const char* spec_start,
+                                  log_binary_spec_t* spec) {
+  const char* s = spec_start + 1;
+
+  spec->num_stars = 0;
+  spec->length_modifier = LOG_BINARY_LENGTH_NONE;
+  while (*s && strchr("-+ #0'I", *s)) s++;
+  if ('*' == *s) {
+    spec->num_stars++;
+    s++;
+  } else {
+    while (*s >= '0' && *s <= '9') s++;
+  }
+  if ('$' == *s) {
+    return false;
+  }
+  if ('.' == *s) {
+    s++;
+    if ('*' == *s) {
+      spec->num_stars++;
+      s++;
+    } else {
+      while (*s >= '0' && *s <= '9') s++;
+    }
+  }
+  switch (*s) {
+    case 'h':
+      s++;
+      spec->length_modifier = LOG_BINARY_LENGTH_H;
+      if ('h' == *s) {
+        s++;
+        spec->length_modifier = LOG_BINARY_LENGTH_HH;
+      }
+      break;
+    case 'l':
+      s++;
+      spec->length_modifier = LOG_BINARY_LENGTH_L;
+      if ('l' == *s) {
+        s++;
+        spec->length_modifier = LOG_BINARY_LENGTH_LL;
+      }
+      break;
+    case 'q':
+      s++;
+      spec->length_modifier = LOG_BINARY_LENGTH_LL;
+      break;
+    case 'j':
+      s++;
+      spec->length_modifier = LOG_BINARY_LENGTH_J;
+      break;
+    case 'z':
+      s++;
+      spec->length_modifier = LOG_BINARY_LENGTH_Z;
+      break;
+    case 't':
+      s++;
+      spec->length_modifier = LOG_BINARY_LENGTH_T;
+      break;
+    default:
+      break;
+  }
+  spec->conversion = *s;
+  spec->length = s + 1 - spec_start;
+  if (spec->length + 2 >= LOG_BINARY_SPEC_MAX) {
+    return false;
+  }
+  switch (spec->conversion) {
+    case 'd':
+    case 'i':
+    case 'o':
+    case 'u':
+    case 'x':
+    case 'X':
+      return true;
+    case 'e':
+    case 'E':
+    case 'f':
+    case 'F':
+    case 'g':
+    case 'G':
+    case 'a':
+    case 'A':
+      // %lf is a double
+      return (LOG_BINARY_LENGTH_NONE == spec->length_modifier) ||
+             (LOG_BINARY_LENGTH_L == spec->length_modifier);
+    case 'c':
+    case 's':
+    case 'p':
+      return LOG_BINARY_LENGTH_NONE == spec->length_modifier;
+    default:
+      return false;
+  }
+}
+
+//------------------------------------------------------------------------------
+static inline bool log_binary_put(uint8_t** out, const uint8_t* end,
+                                  uint64_t value) {
+  if (end - *out < (ptrdiff_t)sizeof(value)) {
+    return false;
+  }
+  memcpy(*out, &value, sizeof(value));
+  *out += sizeof(value);
+  return true;
+}
+
+static bool log_binary_put_string(uint8_t** out, const uint8_t* end,
+                                  const char* string) {
+  if (!string) {
+    return log_binary_put(out, end, LOG_BINARY_STRING_NULL);
+  }
+  size_t length = strlen(string);
+  if (!log_binary_put(out, end, length) ||
+      (end - *out < (ptrdiff_t)LOG_BINARY_ALIGN(length + 1))) {
+    return false;
+  }
+  memcpy(*out, string, length + 1);
+  *out += LOG_BINARY_ALIGN(length + 1);
+  return true;
+}
+
+static int64_t log_binary_signed_arg(log_binary_length_t length_modifier,
+                                     va_list* args) {
+  switch (length_modifier) {
+    case LOG_BINARY_LENGTH_HH:
+      return (signed char)va_arg(*args, int);
+    case LOG_BINARY_LENGTH_H:
+      return (short)va_arg(*args, int);
+    case LOG_BINARY_LENGTH_L:
+      return va_arg(*args, long);
+    case LOG_BINARY_LENGTH_LL:
+      return va_arg(*args, long long);
+    case LOG_BINARY_LENGTH_J:
+      return va_arg(*args, intmax_t);
+    case LOG_BINARY_LENGTH_Z:
+      return va_arg(*args, ssize_t);
+    case LOG_BINARY_LENGTH_T:
+      return va_arg(*args, ptrdiff_t);
+    default:
+      return va_arg(*args, int);
+  }
+}
+
+static uint64_t log_binary_unsigned_arg(log_binary_length_t length_modifier,
+                                        va_list* args) {
+  switch (length_modifier) {
+    case LOG_BINARY_LENGTH_HH:
+      return (unsigned char)va_arg(*args, unsigned int);
+    case LOG_BINARY_LENGTH_H:
+      return (unsigned short)va_arg(*args, unsigned int);
+    case LOG_BINARY_LENGTH_L:
+      return va_arg(*args, unsigned long);
+    case LOG_BINARY_LENGTH_LL:
+      return va_arg(*args, unsigned long long);
+    case LOG_BINARY_LENGTH_J:
+      return va_arg(*args, uintmax_t);
+    case LOG_BINARY_LENGTH_Z:
+      return va_arg(*args, size_t);
+    case LOG_BINARY_LENGTH_T:
+      return (uint64_t)va_arg(*args, ptrdiff_t);
+    default:
+      return va_arg(*args, unsigned int);
+  }
+}
+
+// Copies the arguments after the record header, returns the record size or
+// 0 if the message has to be logged as text
+static size_t log_binary_put_args(uint8_t* record, const char* format,
+                                  va_list* args) {
+  uint8_t* out = record + sizeof(log_binary_message_t);
+  const uint8_t* end = record + LOG_BINARY_RECORD_MAX;
+  const char* p = format;
+  log_binary_spec_t spec;
+
+  while ((p = strchr(p, '%'))) {
+    if ('%' == p[1]) {
+      p += 2;
+      continue;
+    }
+    if (!log_binary_parse_spec(p, &spec)) {
+      return 0;
+    }
+    for (int i = 0; i < spec.num_stars; i++) {
+      if (!log_binary_put(&out, end, (int64_t)va_arg(*args, int))) {
+        return 0;
+      }
+    }
+    bool ok = true;
+    switch (spec.conversion) {
+      case 'd':
+      case 'i':
+        ok = log_binary_put(&out, end,
+                            log_binary_signed_arg(spec.length_modifier, args));
+        break;
+      case 'o':
+      case 'u':
+      case 'x':
+      case 'X':
+        ok = log_binary_put(
+            &out, end, log_binary_unsigned_arg(spec.length_modifier, args));
+        break;
+      case 'c':
+        ok = log_binary_put(&out, end, (int64_t)va_arg(*args, int));
+        break;
+      case 's':
+        ok = log_binary_put_string(&out, end, va_arg(*args, const char*));
+        break;
+      case 'p':
+        ok = log_binary_put(&out, end, (uintptr_t)va_arg(*args, void*));
+        break;
+      default: {
+        double value = va_arg(*args, double);
+        uint64_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        ok = log_binary_put(&out, end, bits);
+      } break;
+    }
+    if (!ok) {
+      return 0;
+    }
+    p += spec.length;
+  }
+  return out - record;
+}
+
+//------------------------------------------------------------------------------
+static void log_binary_push(log_binary_ring_t* ring, uint32_t size) {
+  uint64_t head = ring->head;
+  uint64_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+  uint64_t offset = head & LOG_BINARY_RING_MASK;
+  uint64_t contiguous = LOG_BINARY_RING_SIZE - offset;
+  uint64_t needed = size + ((contiguous < size) ? contiguous : 0);
+
+  if (head + needed - tail > LOG_BINARY_RING_SIZE) {
+    __atomic_store_n(&ring->dropped, ring->dropped + 1, __ATOMIC_RELAXED);
+    return;
+  }
+  if (contiguous < size) {
+    // Records do not wrap, pad up to the end of the ring
+    log_binary_record_t* pad = (log_binary_record_t*)&ring->data[offset];
+    pad->size = contiguous;
+    pad->type = LOG_BINARY_RECORD_PAD;
+    head += contiguous;
+    offset = 0;
+  }
+  memcpy(&ring->data[offset], ring->record, size);
+  __atomic_store_n(&ring->head, head + size, __ATOMIC_RELEASE);
+}
+
+//------------------------------------------------------------------------------
+// Queues the message, with level, proto, line, indent, tid, flags and
+// prefix_id set by the caller, in the ring of the thread. Returns false if it
+// has to be logged as text: format or file not literals, conversion not
+// supported or arguments longer than LOG_BINARY_RECORD_MAX. A message dropped
+// because the ring is full is counted and logged as dropped by the log thread.
+bool log_binary_message(log_binary_message_t* message, const char* file,
+                        const char* format, va_list args) {
+  log_binary_ring_t* ring = log_binary_ring;
+  va_list args_copy;
+  size_t size = 0;
+
+  if (!ring) {
+    ring = log_binary_register_ring();
+    if (!ring) {
+      return false;
+    }
+  }
+  if (!log_binary_is_literal(format) || !log_binary_is_literal(file)) {
+    return false;
+  }
+  va_copy(args_copy, args);
+  size = log_binary_put_args(ring->record, format, &args_copy);
+  va_end(args_copy);
+  if (!size) {
+    return false;
+  }
+
+  message->record.size = size;
+  message->record.type = LOG_BINARY_RECORD_MESSAGE;
+  message->reserved = 0;
+  message->timestamp = log_binary_timestamp();
+  message->format = (uintptr_t)format;
+  message->file = (uintptr_t)file;
+  memcpy(ring->record, message, sizeof(log_binary_message_t));
+  log_binary_push(ring, size);
+  return true;
+}
+
+//------------------------------------------------------------------------------
+// Calls handler with the messages queued since the last drain, thread by
+// thread, and with the count of the messages dropped. The records are valid
+// until handler returns.
+void log_binary_drain(log_binary_handler_t handler, void* arg) {
+  pthread_mutex_lock(&log_binary_rings_mutex);
+  log_binary_ring_t** it = &log_binary_rings;
+  while (*it) {
+    log_binary_ring_t* ring = *it;
+    // Once exited, head does not move anymore
+    bool exited = __atomic_load_n(&ring->exited, __ATOMIC_ACQUIRE);
+    uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    uint64_t tail = ring->tail;
+
+    while (tail != head) {
+      const log_binary_record_t* record =
+          (const log_binary_record_t*)&ring->data[tail & LOG_BINARY_RING_MASK];
+      if (LOG_BINARY_RECORD_PAD != record->type) {
+        handler(record, arg);
+      }
+      tail += record->size;
+    }
+    __atomic_store_n(&ring->tail, tail, __ATOMIC_RELEASE);
+
+    uint64_t dropped = __atomic_load_n(&ring->dropped, __ATOMIC_RELAXED);
+    if (dropped != ring->dropped_reported) {
+      log_binary_dropped_t record = {
+          .record = {sizeof(log_binary_dropped_t), LOG_BINARY_RECORD_DROPPED},
+          .tid = (uint64_t)ring->tid,
+          .count = dropped - ring->dropped_reported};
+      handler(&record.record, arg);
+      ring->dropped_reported = dropped;
+    }
+
+    if (exited) {
+      *it = ring->next;
+      free(ring);
+    } else {
+      it = &ring->next;
+    }
+  }
+  pthread_mutex_unlock(&log_binary_rings_mutex);
+}
+
+//------------------------------------------------------------------------------
+static void log_binary_append(log_binary_line_t* line, const char* format,
+                              ...) {
+  va_list args;
+  size_t available = line->size - line->length;
+
+  va_start(args, format);
+  int rv = vsnprintf(line->buffer + line->length, available, format, args);
+  va_end(args);
+  if (rv > 0) {
+    line->length += ((size_t)rv < available) ? (size_t)rv : available - 1;
+  }
+}
+
+static void log_binary_append_text(log_binary_line_t* line, const char* text,
+                                   size_t length) {
+  size_t available = line->size - line->length - 1;
+
+  if (length > available) {
+    length = available;
+  }
+  memcpy(line->buffer + line->length, text, length);
+  line->length += length;
+  line->buffer[line->length] = '\0';
+}
+
+static inline bool log_binary_get(const uint8_t** in, const uint8_t* end,
+                                  uint64_t* value) {
+  if (end - *in < (ptrdiff_t)sizeof(*value)) {
+    return false;
+  }
+  memcpy(value, *in, sizeof(*value));
+  *in += sizeof(*value);
+  return true;
+}
+
+static bool log_binary_get_string(const uint8_t** in, const uint8_t* end,
+                                  const char** string) {
+  uint64_t length = 0;
+
+  if (!log_binary_get(in, end, &length)) {
+    return false;
+  }
+  if (LOG_BINARY_STRING_NULL == length) {
+    *string = NULL;
+    return true;
+  }
+  if ((length >= LOG_BINARY_RECORD_MAX) ||
+      (end - *in < (ptrdiff_t)LOG_BINARY_ALIGN(length + 1)) ||
+      ((*in)[length] != '\0')) {
+    return false;
+  }
+  *string = (const char*)*in;
+  *in += LOG_BINARY_ALIGN(length + 1);
+  return true;
+}
+
+// Passes the '*' width and precision before the value
+#define LOG_BINARY_APPEND_SPEC(line, spec_format, num_stars, stars, value) \
+  do {                                                                   \
+    if (0 == (num_stars)) {                                              \
+      log_binary_append(line, spec_format, value);                       \
+    } else if (1 == (num_stars)) {                                       \
+      log_binary_append(line, spec_format, (stars)[0], value);           \
+    } else {                                                             \
+      log_binary_append(line, spec_format, (stars)[0], (stars)[1], value); \
+    }                                                                    \
+  } while (0)
+
+// Formats the arguments as vsnprintf would have formatted them in the
+// logging thread, returns false if they do not match the format
+static bool log_binary_format_args(log_binary_line_t* line, const char* format,
+                                   const uint8_t* in, const uint8_t* end) {
+  const char* p = format;
+  const char* text = format;
+  log_binary_spec_t spec;
+
+  while ((p = strchr(p, '%'))) {
+    if ('%' == p[1]) {
+      log_binary_append_text(line, text, p + 1 - text);
+      p += 2;
+      text = p;
+      continue;
+    }
+    log_binary_append_text(line, text, p - text);
+    if (!log_binary_parse_spec(p, &spec)) {
+      return false;
+    }
+
+    // Same specification with the arguments as long long
+    char spec_format[LOG_BINARY_SPEC_MAX];
+    size_t spec_length = 0;
+    for (size_t i = 0; i + 1 < spec.length; i++) {
+      if (!strchr("hlqjzt", p[i])) {
+        spec_format[spec_length++] = p[i];
+      }
+    }
+    if (strchr("diouxX", spec.conversion)) {
+      spec_format[spec_length++] = 'l';
+      spec_format[spec_length++] = 'l';
+    }
+    spec_format[spec_length++] = spec.conversion;
+    spec_format[spec_length] = '\0';
+
+    int stars[2] = {0, 0};
+    uint64_t value = 0;
+    for (int i = 0; i < spec.num_stars; i++) {
+      if (!log_binary_get(&in, end, &value)) {
+        return false;
+      }
+      stars[i] = (int)(int64_t)value;
+    }
+    if ('s' == spec.conversion) {
+      const char* string = NULL;
+      if (!log_binary_get_string(&in, end, &string)) {
+        return false;
+      }
+      LOG_BINARY_APPEND_SPEC(line, spec_format, spec.num_stars, stars, string);
+    } else {
+      if (!log_binary_get(&in, end, &value)) {
+        return false;
+      }
+      switch (spec.conversion) {
+        case 'd':
+        case 'i':
+          LOG_BINARY_APPEND_SPEC(line, spec_format, spec.num_stars, stars,
+                                 (long long)(int64_t)value);
+          break;
+        case 'o':
+        case 'u':
+        case 'x':
+        case 'X':
+          LOG_BINARY_APPEND_SPEC(line, spec_format, spec.num_stars, stars,
+                                 (unsigned long long)value);
+          break;
+        case 'c':
+          LOG_BINARY_APPEND_SPEC(line, spec_format, spec.num_stars, stars,
+                                 (int)(int64_t)value);
+          break;
+        case 'p':
+          LOG_BINARY_APPEND_SPEC(line, spec_format, spec.num_stars, stars,
+                                 (void*)(uintptr_t)value);
+          break;
+        default: {
+          double d;
+          memcpy(&d, &value, sizeof(d));
+          LOG_BINARY_APPEND_SPEC(line, spec_format, spec.num_stars, stars, d);
+        } break;
+      }
+    }
+    p += spec.length;
+    text = p;
+  }
+  log_binary_append_text(line, text, strlen(text));
+  return true;
+}
+
+//------------------------------------------------------------------------------
+// Formats the message as the text logging does, with the line prefix, the
+// file name already shortened. Returns the length of the line or -1 if the
+// record does not match the format.
+int log_binary_format_line(const log_binary_message_t* message,
+                           const char* format, const char* file,
+                           const char* level_name, const char* proto_name,
+                           uint64_t number, int64_t realtime_ns, char* buffer,
+                           size_t size) {
+  log_binary_line_t line = {buffer, size, 0};
+  char time_str[MAX_TIME_STR_LEN];
+  time_t seconds = realtime_ns / 1000000000LL;
+  struct tm local_time;
+  const uint8_t* args = (const uint8_t*)message + sizeof(log_binary_message_t);
+  const uint8_t* end = (const uint8_t*)message + message->record.size;
+
+  if (!size) {
+    return -1;
+  }
+  buffer[0] = '\0';
+  if ((message->record.size < sizeof(log_binary_message_t)) || !format) {
+    return -1;
+  }
+  localtime_r(&seconds, &local_time);
+  strftime(time_str, MAX_TIME_STR_LEN, LOG_CTXT_INFO_TIME_FMT, &local_time);
+  if (message->flags & LOG_BINARY_FLAG_PREFIX_ID) {
+    log_binary_append(
+        &line, LOG_CTXT_INFO_ID_FMT, number, time_str,
+        (unsigned long)message->tid, LOG_DISPLAYED_LOG_LEVEL_NAME_MAX_LENGTH,
+        LOG_DISPLAYED_LOG_LEVEL_NAME_MAX_LENGTH, level_name,
+        LOG_DISPLAYED_PROTO_NAME_MAX_LENGTH,
+        LOG_DISPLAYED_PROTO_NAME_MAX_LENGTH, proto_name,
+        LOG_DISPLAYED_FILENAME_MAX_LENGTH, LOG_DISPLAYED_FILENAME_MAX_LENGTH,
+        file, message->line, (unsigned long)message->prefix_id,
+        message->indent, " ");
+  } else {
+    log_binary_append(
+        &line, LOG_CTXT_INFO_FMT, number, time_str,
+        (unsigned long)message->tid, LOG_DISPLAYED_LOG_LEVEL_NAME_MAX_LENGTH,
+        LOG_DISPLAYED_LOG_LEVEL_NAME_MAX_LENGTH, level_name,
+        LOG_DISPLAYED_PROTO_NAME_MAX_LENGTH,
+        LOG_DISPLAYED_PROTO_NAME_MAX_LENGTH, proto_name,
+        LOG_DISPLAYED_FILENAME_MAX_LENGTH, LOG_DISPLAYED_FILENAME_MAX_LENGTH,
+        file, message->line, message->indent, " ");
+  }
+  if (!log_binary_format_args(&line, format, args, end)) {
+    return -1;
+  }
+  return line.length;
+}
+
+//------------------------------------------------------------------------------
+int log_binary_format_dropped(const log_binary_dropped_t* dropped,
+                              char* buffer, size_t size) {
+  return snprintf(buffer, size,
+                  "%" PRIu64 " log messages of thread %08lX dropped, the "
+                  "log ring was full\n",
+                  dropped->count, (unsigned long)dropped->tid);
+}
+
+//------------------------------------------------------------------------------
+int log_binary_write_header(FILE* file, const char* level_names,
+                            uint32_t num_levels, uint32_t level_name_size,
+                            const char* proto_names, uint32_t num_protos,
+                            uint32_t proto_name_size) {
+  log_binary_file_header_t header = {.num_levels = num_levels,
+                                     .level_name_size = level_name_size,
+                                     .num_protos = num_protos,
+                                     .proto_name_size = proto_name_size};
+
+  memcpy(header.magic, LOG_BINARY_FILE_MAGIC, sizeof(header.magic));
+  if ((1 != fwrite(&header, sizeof(header), 1, file)) ||
+      (num_levels != fwrite(level_names, level_name_size, num_levels, file)) ||
+      (num_protos != fwrite(proto_names, proto_name_size, num_protos, file))) {
+    return -1;
+  }
+  return 0;
+}
+
+int log_binary_write_record(FILE* file, const log_binary_record_t* record) {
+  return (1 == fwrite(record, record->size, 1, file)) ? 0 : -1;
+}
+
+int log_binary_write_string(FILE* file, uint64_t id, const char* string) {
+  size_t length = strlen(string) + 1;
+  log_binary_string_t header = {
+      .record = {sizeof(header) + LOG_BINARY_ALIGN(length),
+                 LOG_BINARY_RECORD_STRING},
+      .id = id};
+  static const char padding[8] = {0};
+
+  if ((1 != fwrite(&header, sizeof(header), 1, file)) ||
+      (1 != fwrite(string, length, 1, file)) ||
+      ((LOG_BINARY_ALIGN(length) != length) &&
+       (1 != fwrite(padding, LOG_BINARY_ALIGN(length) - length, 1, file)))) {
+    return -1;
+  }
+  return 0;
+}
+
+int log_binary_write_clock(FILE* file, const log_binary_clock_t* clock) {
+  log_binary_clock_record_t record = {
+      .record = {sizeof(record), LOG_BINARY_RECORD_CLOCK}, .clock = *clock};
+  return log_binary_write_record(file, &record.record);
+}
+
+//------------------------------------------------------------------------------
+// Open addressing on the ids, 0 marks a free slot
+static size_t log_binary_strings_slot(const log_binary_strings_t* strings,
+                                      uint64_t id) {
+  size_t mask = strings->capacity - 1;
+  size_t slot = ((id * 0x9e3779b97f4a7c15ULL) >> 32) & mask;
+
+  while (strings->ids[slot] && (strings->ids[slot] != id)) {
+    slot = (slot + 1) & mask;
+  }
+  return slot;
+}
+
+const char* log_binary_strings_get(const log_binary_strings_t* strings,
+                                   uint64_t id) {
+  if (!strings->capacity || !id) {
+    return NULL;
+  }
+  return strings->strings[log_binary_strings_slot(strings, id)];
+}
+
+void log_binary_strings_put(log_binary_strings_t* strings, uint64_t id,
+                            const char* string) {
+  if (!id) {
+    return;
+  }
+  if (2 * (strings->count + 1) > strings->capacity) {
+    log_binary_strings_t grown = {0};
+    grown.capacity = strings->capacity ? 2 * strings->capacity
+                                       : LOG_BINARY_STRINGS_MIN_CAPACITY;
+    grown.ids = calloc(grown.capacity, sizeof(uint64_t));
+    grown.strings = calloc(grown.capacity, sizeof(char*));
+    if (!grown.ids || !grown.strings) {
+      free(grown.ids);
+      free(grown.strings);
+      return;
+    }
+    for (size_t i = 0; i < strings->capacity; i++) {
+      if (strings->ids[i]) {
+        size_t slot = log_binary_strings_slot(&grown, strings->ids[i]);
+        grown.ids[slot] = strings->ids[i];
+        grown.strings[slot] = strings->strings[i];
+      }
+    }
+    grown.count = strings->count;
+    free(strings->ids);
+    free(strings->strings);
+    *strings = grown;
+  }
+
+  size_t slot = log_binary_strings_slot(strings, id);
+  if (strings->ids[slot]) {
+    free(strings->strings[slot]);
+  } else {
+    strings->ids[slot] = id;
+    strings->count++;
+  }
+  strings->strings[slot] = strdup(string);
+}
+
+void log_binary_strings_free(log_binary_strings_t* strings) {
+  for (size_t i = 0; i < strings->capacity; i++) {
+    free(strings->strings[i]);
+  }
+  free(strings->ids);
+  free(strings->strings);
+  memset(strings, 0, sizeof(*strings));
+}
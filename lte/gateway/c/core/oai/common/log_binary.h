@@ -0,0 +1,192 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*! \file log_binary.h
+  \brief Binary logging with deferred formatting. The logging threads copy
+  the address of the format literal, the raw arguments and a timestamp in a
+  per thread ring, the log thread or an offline decoder formats them later.
+*/
+#pragma once
+
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Line prefix shared by the text and the binary logging
+#define LOG_DISPLAYED_FILENAME_MAX_LENGTH 32
+#define LOG_DISPLAYED_LOG_LEVEL_NAME_MAX_LENGTH 5
+#define LOG_DISPLAYED_PROTO_NAME_MAX_LENGTH 6
+
+#define LOG_CTXT_INFO_FMT \
+  "%06" PRIu64 " %s %08lX %-*.*s %-*.*s %-*.*s:%04u   %*s"
+#define LOG_CTXT_INFO_ID_FMT \
+  "%06" PRIu64 " %s %08lX %-*.*s %-*.*s %-*.*s:%04u   [%lu]%*s"
+#define LOG_CTXT_INFO_TIME_FMT "%a %b %d %H:%M:%S %Y"
+#define MAX_TIME_STR_LEN 32
+
+// Bytes of the ring of each logging thread, a power of 2
+#define LOG_BINARY_RING_SIZE (1 << 18)
+// Largest record, messages with longer arguments are logged as text
+#define LOG_BINARY_RECORD_MAX 4096
+// Same bound as the text logging
+#define LOG_BINARY_LINE_MAX 4096
+
+#define LOG_BINARY_FILE_MAGIC "OAIBLOG1"
+
+typedef enum {
+  LOG_BINARY_RECORD_PAD = 0,
+  LOG_BINARY_RECORD_MESSAGE,
+  LOG_BINARY_RECORD_DROPPED,
+  LOG_BINARY_RECORD_STRING,
+  LOG_BINARY_RECORD_CLOCK,
+} log_binary_record_type_t;
+
+#define LOG_BINARY_FLAG_PREFIX_ID 0x1
+
+/*! \struct  log_binary_record_t
+ * \brief Common header of the records, in the rings and in the binary log
+ * files. Records are 8 bytes aligned, size includes the header.
+ */
+typedef struct log_binary_record_s {
+  uint32_t size;
+  uint32_t type;
+} log_binary_record_t;
+
+/*! \struct  log_binary_message_t
+ * \brief Message logged with OAILOG_*, followed by the arguments. Integers,
+ * doubles and pointers take 8 bytes, strings take 8 bytes of length and the
+ * string with its terminating null padded to 8 bytes.
+ */
+typedef struct log_binary_message_s {
+  log_binary_record_t record;
+  uint8_t level;
+  uint8_t proto;
+  uint16_t flags;
+  uint32_t line;
+  int32_t indent;
+  uint32_t reserved;
+  uint64_t timestamp;
+  uint64_t tid;
+  uint64_t prefix_id;
+  uint64_t format; /*!< \brief address of the format literal */
+  uint64_t file;   /*!< \brief address of the __FILE__ literal */
+} log_binary_message_t;
+
+/*! \struct  log_binary_dropped_t
+ * \brief Messages of a thread dropped because its ring was full
+ */
+typedef struct log_binary_dropped_s {
+  log_binary_record_t record;
+  uint64_t tid;
+  uint64_t count;
+} log_binary_dropped_t;
+
+/*! \struct  log_binary_string_t
+ * \brief Binary log files only, text of the format or file name logged with
+ * the address id, followed by the null terminated string
+ */
+typedef struct log_binary_string_s {
+  log_binary_record_t record;
+  uint64_t id;
+} log_binary_string_t;
+
+/*! \struct  log_binary_clock_t
+ * \brief Sample of the message timestamps and of the real time, the log
+ * thread samples them each time it drains the rings
+ */
+typedef struct log_binary_clock_s {
+  uint64_t timestamp;
+  int64_t realtime_ns;
+} log_binary_clock_t;
+
+typedef struct log_binary_clock_record_s {
+  log_binary_record_t record;
+  log_binary_clock_t clock;
+} log_binary_clock_record_t;
+
+/*! \struct  log_binary_file_header_t
+ * \brief Start of a binary log file, followed by the level names and the
+ * protocol names, then by the records. Integers are in host byte order.
+ */
+typedef struct log_binary_file_header_s {
+  char magic[8];
+  uint32_t num_levels;
+  uint32_t level_name_size;
+  uint32_t num_protos;
+  uint32_t proto_name_size;
+} log_binary_file_header_t;
+
+typedef void (*log_binary_handler_t)(const log_binary_record_t* record,
+                                     void* arg);
+
+/*! \struct  log_binary_strings_t
+ * \brief Strings by id, ids are the addresses of the logged literals
+ */
+typedef struct log_binary_strings_s {
+  uint64_t* ids;
+  char** strings;
+  size_t capacity;
+  size_t count;
+} log_binary_strings_t;
+
+void log_binary_init(void);
+
+bool log_binary_message(log_binary_message_t* message, const char* file,
+                        const char* format, va_list args);
+
+void log_binary_drain(log_binary_handler_t handler, void* arg);
+
+void log_binary_clock_sample(log_binary_clock_t* clock);
+
+int64_t log_binary_realtime_ns(const log_binary_clock_t* first,
+                               const log_binary_clock_t* last,
+                               uint64_t timestamp);
+
+int log_binary_format_line(const log_binary_message_t* message,
+                           const char* format, const char* file,
+                           const char* level_name, const char* proto_name,
+                           uint64_t number, int64_t realtime_ns, char* buffer,
+                           size_t size);
+
+int log_binary_format_dropped(const log_binary_dropped_t* dropped,
+                              char* buffer, size_t size);
+
+int log_binary_write_header(FILE* file, const char* level_names,
+                            uint32_t num_levels, uint32_t level_name_size,
+                            const char* proto_names, uint32_t num_protos,
+                            uint32_t proto_name_size);
+
+int log_binary_write_record(FILE* file, const log_binary_record_t* record);
+
+int log_binary_write_string(FILE* file, uint64_t id, const char* string);
+
+int log_binary_write_clock(FILE* file, const log_binary_clock_t* clock);
+
+const char* log_binary_strings_get(const log_binary_strings_t* strings,
+                                   uint64_t id);
+
+void log_binary_strings_put(log_binary_strings_t* strings, uint64_t id,
+                            const char* string);
+
+void log_binary_strings_free(log_binary_strings_t* strings);
+
+#ifdef __cplusplus
+}
+#endif
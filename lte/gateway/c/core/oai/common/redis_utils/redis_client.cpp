@@ -27,6 +27,9 @@ extern "C" {
 }
 #endif
 
+#include <algorithm>
+#include <thread>
+
 #include "orc8r/gateway/c/common/config/ServiceConfigLoader.hpp"
 #include <yaml-cpp/yaml.h>  // IWYU pragma: keep
 
@@ -89,15 +92,65 @@ std::string RedisClient::read(const std::string& key) {
   return db_read_reply.as_string();
 }
 
+status_code_e RedisClient::write_batch(
+    const std::vector<std::pair<std::string, std::string>>& key_values) {
+#if !MME_UNIT_TEST
+  if (!is_connected()) {
+    return RETURNerror;
+  }
+  if (key_values.empty()) {
+    return RETURNok;
+  }
+
+  auto db_write_fut = db_client_->mset(key_values);
+  db_client_->sync_commit();
+  auto db_write_reply = db_write_fut.get();
+
+  if (db_write_reply.is_error()) {
+    return RETURNerror;
+  }
+#endif
+  return RETURNok;
+}
+
+std::vector<std::string> RedisClient::read_batch(
+    const std::vector<std::string>& keys,
+    std::vector<std::string>& found_keys) {
+  std::vector<std::future<cpp_redis::reply>> db_read_futs;
+  for (size_t start = 0; start < keys.size(); start += REDIS_READ_BATCH_SIZE) {
+    size_t end = std::min(start + REDIS_READ_BATCH_SIZE, keys.size());
+    db_read_futs.emplace_back(db_client_->mget(
+        std::vector<std::string>(keys.begin() + start, keys.begin() + end)));
+  }
+  db_client_->sync_commit();
+
+  std::vector<std::string> values;
+  values.reserve(keys.size());
+  found_keys.clear();
+  found_keys.reserve(keys.size());
+  size_t key_index = 0;
+  for (auto& db_read_fut : db_read_futs) {
+    auto db_read_reply = db_read_fut.get();
+    if (db_read_reply.is_error() || !db_read_reply.is_array()) {
+      throw std::runtime_error("Could not read from redis");
+    }
+    for (const auto& reply : db_read_reply.as_array()) {
+      // Nil for a key removed since it was listed
+      if (reply.is_string()) {
+        found_keys.push_back(keys[key_index]);
+        values.emplace_back(reply.as_string());
+      }
+      key_index++;
+    }
+  }
+  return values;
+}
+
 status_code_e RedisClient::write_proto_str(const std::string& key,
                                            const std::string& proto_msg,
                                            uint64_t version) {
-  orc8r::RedisState wrapper_proto = orc8r::RedisState();
-  wrapper_proto.set_serialized_msg(proto_msg);
-  wrapper_proto.set_version(version);
-
   std::string str_value;
-  if (serialize(wrapper_proto, str_value) != RETURNok) {
+  if (wrap_proto_str(proto_msg, version, str_value) != RETURNok) {
     return RETURNerror;
   }
   if (write(key, str_value) != RETURNok) {
@@ -106,6 +159,16 @@ status_code_e RedisClient::write_proto_str(const std::string& key,
   return RETURNok;
 }
 
+status_code_e RedisClient::wrap_proto_str(const std::string& proto_msg,
+                                          uint64_t version,
+                                          std::string& wrapped_str) {
+  orc8r::RedisState wrapper_proto = orc8r::RedisState();
+  wrapper_proto.set_serialized_msg(proto_msg);
+  wrapper_proto.set_version(version);
+
+  return serialize(wrapper_proto, wrapped_str);
+}
+
 status_code_e RedisClient::read_proto(const std::string& key,
                                       Message& proto_msg) {
   orc8r::RedisState wrapper_proto = orc8r::RedisState();
@@ -174,6 +237,27 @@ std::vector<std::string> RedisClient::get_keys(const std::string& pattern) {
   return replies;
 }
 
+void RedisClient::parallel_for(size_t num_items,
+                               const std::function<void(size_t)>& func) {
+  size_t num_threads = std::min<size_t>(
+      std::max(std::thread::hardware_concurrency(), 1u), num_items);
+  std::atomic<size_t> next(0);
+  auto worker = [&] {
+    for (size_t i = next++; i < num_items; i = next++) {
+      func(i);
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (size_t t = 1; t < num_threads; t++) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
 status_code_e RedisClient::read_redis_state(const std::string& key,
                                             orc8r::RedisState& state_out) {
   try {
@@ -17,7 +17,11 @@
 
 #pragma once
 
+#include <atomic>
+#include <functional>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <cpp_redis/cpp_redis>
 #include <google/protobuf/message.h>
@@ -25,6 +29,8 @@
 #include "lte/gateway/c/core/common/common_defs.h"
 #include "orc8r/protos/redis.pb.h"
 
+#define REDIS_READ_BATCH_SIZE 512
+
 namespace magma {
 namespace lte {
 
@@ -46,6 +52,16 @@ class RedisClient {
    */
   std::string read(const std::string& key);
 
+  /**
+   * Returns the values on redis db mapped to keys, the keys are read with
+   * MGETs of at most REDIS_READ_BATCH_SIZE keys sent in a single round trip
+   * @param keys
+   * @param found_keys keys that exist on db, in the order of the values
+   * @return string repr of values, missing keys are skipped
+   */
+  std::vector<std::string> read_batch(const std::vector<std::string>& keys,
+                                      std::vector<std::string>& found_keys);
+
   /**
    * Writes a str value to redis mapped to str key
    * @param key
@@ -64,6 +80,26 @@ class RedisClient {
   status_code_e write_proto_str(const std::string& key,
                                 const std::string& proto_msg, uint64_t version);
 
+  /**
+   * Writes str values to redis mapped to str keys, with a single round trip
+   * @param key_values
+   * @return response code of operation
+   */
+  status_code_e write_batch(
+      const std::vector<std::pair<std::string, std::string>>& key_values);
+
+  /**
+   * Wraps a serialized protobuf object with its version, in the format
+   * written by write_proto_str
+   * @param proto_msg
+   * @param version
+   * @param wrapped_str
+   * @return response code of operation
+   */
+  static status_code_e wrap_proto_str(const std::string& proto_msg,
+                                      uint64_t version,
+                                      std::string& wrapped_str);
+
   /**
    * Converts protobuf Message and parses it to string
    * @param proto_msg
@@ -83,6 +119,34 @@ class RedisClient {
 
   int read_version(const std::string& key);
 
+  /**
+   * Parses protobuf objects of the same type written by write_proto_str, on
+   * a pool of threads
+   * @param values wrapped protobuf objects, as returned by read_batch
+   * @param protos parsed objects, in the order of values
+   * @param versions versions of the objects, in the order of values
+   * @return response code of operation, error if any value fails to parse
+   */
+  template <typename ProtoType>
+  static status_code_e parse_protos(const std::vector<std::string>& values,
+                                    std::vector<ProtoType>& protos,
+                                    std::vector<uint64_t>& versions) {
+    std::atomic<bool> failed(false);
+    protos.clear();
+    protos.resize(values.size());
+    versions.assign(values.size(), 0);
+    parallel_for(values.size(), [&](size_t i) {
+      orc8r::RedisState wrapper_proto = orc8r::RedisState();
+      if (deserialize(wrapper_proto, values[i]) != RETURNok ||
+          deserialize(protos[i], wrapper_proto.serialized_msg()) != RETURNok) {
+        failed = true;
+        return;
+      }
+      versions[i] = wrapper_proto.version();
+    });
+    return failed ? RETURNerror : RETURNok;
+  }
+
   status_code_e clear_keys(const std::vector<std::string>& keys_to_clear);
 
   std::vector<std::string> get_keys(const std::string& pattern);
@@ -102,6 +166,15 @@ class RedisClient {
   status_code_e read_redis_state(const std::string& key,
                                  orc8r::RedisState& state_out);
 
+  /**
+   * Calls func for every index lower than num_items, from as many threads as
+   * there are cores
+   * @param num_items
+   * @param func
+   */
+  static void parallel_for(size_t num_items,
+                           const std::function<void(size_t)>& func);
+
   /**
    * Takes a string and parses it to protobuf Message
    * @param proto_msg
@@ -167,7 +167,7 @@ static int handle_message(zloop_t* loop, zsock_t* reader, void* arg) {
 
   switch (ITTI_MSG_ID(received_message_p)) {
     case TERMINATE_MESSAGE: {
-      free(received_message_p);
+      itti_free_msg(received_message_p);
       shared_log_exit();
     } break;
 
@@ -175,7 +175,7 @@ static int handle_message(zloop_t* loop, zsock_t* reader, void* arg) {
     } break;
   }
 
-  free(received_message_p);
+  itti_free_msg(received_message_p);
   return 0;
 }
 
@@ -45,6 +45,12 @@ mme_app_desc_t* get_mme_nas_state(bool read_from_db);
  */
 void put_mme_nas_state(void);
 
+/**
+ * Writes the MME/NAS and UE states put since the last call to data store, in a
+ * single round trip. Called once the processing of a message is done.
+ */
+void flush_mme_nas_state(void);
+
 /**
  * Release the memory allocated for the MME NAS state, this does not clean the
  * state persisted in data store
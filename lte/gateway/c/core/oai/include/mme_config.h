@@ -115,6 +115,7 @@ extern "C" {
 
 #define MME_CONFIG_STRING_INTERTASK_INTERFACE_CONFIG "INTERTASK_INTERFACE"
 #define MME_CONFIG_STRING_INTERTASK_INTERFACE_QUEUE_SIZE "ITTI_QUEUE_SIZE"
+#define MME_CONFIG_STRING_INTERTASK_INTERFACE_TRANSPORT "ITTI_TRANSPORT"
 
 #define MME_CONFIG_STRING_S6A_CONFIG "S6A"
 #define MME_CONFIG_STRING_S6A_CONF_FILE_PATH "S6A_CONF"
@@ -128,6 +129,7 @@ extern "C" {
 #define MME_CONFIG_STRING_SCTP_DOWNSTREAM_SOCK "SCTP_DOWNSTREAM_SOCK"
 #define MME_CONFIG_STRING_SCTP_DOWNSTREAM_SOCK_DEFAULT \
   "unix:///tmp/sctpd_downstream.sock"
+#define MME_CONFIG_STRING_SCTP_DOWNSTREAM_STREAMING "SCTP_DOWNSTREAM_STREAMING"
 
 #define MME_CONFIG_STRING_S1AP_CONFIG "S1AP"
 #define MME_CONFIG_STRING_S1AP_OUTCOME_TIMER "S1AP_OUTCOME_TIMER"
@@ -268,6 +270,8 @@ typedef struct eps_network_feature_config_s {
 typedef struct sctp_config_s {
   bstring upstream_sctp_sock;
   bstring downstream_sctp_sock;
+  // Batch downlink packets over a long-lived SendDlStream to sctpd
+  bool downstream_streaming;
 } sctp_config_t;
 
 typedef struct s1ap_config_s {
@@ -298,6 +302,8 @@ typedef struct s6a_config_s {
 typedef struct itti_config_s {
   uint32_t queue_size;
   bstring log_file;
+  // Pass messages through in-process rings instead of ZMQ sockets
+  bool ring_transport;
 } itti_config_t;
 
 typedef struct apn_map_s {
@@ -39,9 +39,42 @@ oai::S1apState* get_s1ap_state(bool read_from_db);
 
 void put_s1ap_state(void);
 
-proto_map_rc_t s1ap_state_get_enb(oai::S1apState* state,
-                                  sctp_assoc_id_t assoc_id,
-                                  oai::EnbDescription* enb);
+void flush_s1ap_state(void);
+
+/**
+ * Returns the eNB association of assoc_id stored in state, or nullptr if there
+ * is none. The association is not copied: it is modified in place, and the
+ * pointer stays valid until the association is removed from state.
+ * @param state S1AP task state
+ * @param assoc_id SCTP association id of the eNB
+ * @return pointer to the oai::EnbDescription in state
+ */
+oai::EnbDescription* s1ap_state_get_enb(oai::S1apState* state,
+                                        sctp_assoc_id_t assoc_id);
+
+/**
+ * Returns the eNB association with the eNB id enb_id, or nullptr if there is
+ * none. Same pointer semantics as s1ap_state_get_enb.
+ * @param state S1AP task state
+ * @param enb_id eNB id from S1 setup
+ * @return pointer to the oai::EnbDescription in state
+ */
+oai::EnbDescription* s1ap_state_get_enb_by_enb_id(oai::S1apState* state,
+                                                  uint32_t enb_id);
+
+/**
+ * Marks the S1AP task state as modified through an eNB association returned
+ * by s1ap_state_get_enb, so that it is written to db once the processing of
+ * the current message is done.
+ * @param enb modified eNB association
+ */
+void s1ap_state_mark_enb_dirty(const oai::EnbDescription* enb);
+
+/**
+ * @return true if an eNB association was marked dirty since the S1AP task
+ * state was last written to db
+ */
+bool s1ap_state_is_dirty(void);
 
 oai::UeDescription* s1ap_state_get_ue_enbid(sctp_assoc_id_t sctp_assoc_id,
                                             enb_ue_s1ap_id_t enb_ue_s1ap_id);
@@ -90,10 +123,6 @@ void remove_ues_without_imsi_from_ue_id_coll(void);
 void clean_stale_enb_state(oai::S1apState* state,
                            oai::EnbDescription* new_enb_association);
 
-proto_map_rc_t s1ap_state_update_enb_map(oai::S1apState* state,
-                                         sctp_assoc_id_t assoc_id,
-                                         oai::EnbDescription* enb);
-
 void get_s1ap_ueid_imsi_map(magma::proto_map_uint32_uint64_t* ueid_imsi_map);
 
 }  // namespace lte
@@ -39,6 +39,8 @@ void spgw_state_exit(void);
 spgw_state_t* get_spgw_state(bool read_from_db);
 // Function that writes the spgw_state struct into db.
 void put_spgw_state(void);
+// Function that writes the states put since its last call into db.
+void flush_spgw_state(void);
 
 // retunrs pointer to proto map, map_uint64_spgw_ue_context_t
 map_uint64_spgw_ue_context_t* get_spgw_ue_state(void);
@@ -13,9 +13,14 @@ limitations under the License.
 
 #pragma once
 
+#include <algorithm>
+#include <chrono>
 #include <cstdlib>
-
+#include <future>
+#include <string>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #ifdef __cplusplus
 extern "C" {
@@ -29,8 +34,12 @@ extern "C" {
 
 #include "lte/gateway/c/core/oai/common/conversions.h"
 #include "lte/gateway/c/core/oai/common/redis_utils/redis_client.hpp"
+#include "lte/gateway/c/core/oai/include/service303.hpp"
+#include "orc8r/gateway/c/common/service303/MetricsHelpers.hpp"
 
 constexpr char IMSI_STR_PREFIX[] = "IMSI";
+// Number of UE states fetched from db while the previous ones are parsed
+constexpr size_t UE_RESTORE_WINDOW = 8192;
 
 namespace magma {
 namespace lte {
@@ -53,8 +62,12 @@ class StateUtility {
         "StateUtility init() function should be called to initialize state");
 
     if (persist_state_enabled) {
-      std::vector<std::string> keys = {IMSI_STR_PREFIX + imsi_str + ":" +
-                                       task_name};
+      std::string key = IMSI_STR_PREFIX + imsi_str + ":" + task_name;
+      // A staged write must not recreate the state after it is removed, and
+      // the state must be written again if the UE comes back unchanged
+      pending_writes.erase(key);
+      ue_state_hash.erase(imsi_str);
+      std::vector<std::string> keys = {key};
       if (redis_client->clear_keys(keys) != RETURNok) {
         OAILOG_ERROR(log_task, "Failed to remove UE state from db");
         return;
@@ -63,6 +76,50 @@ class StateUtility {
     }
   }
 
+  /**
+   * Writes the task and UE states staged since the last call to db, with a
+   * single round trip. Called once the processing of a message is done.
+   */
+  void flush_state_to_db() {
+    AssertFatal(
+        is_initialized,
+        "StateUtility init() function should be called to initialize state");
+
+    if (pending_writes.empty()) {
+      return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::pair<std::string, std::string>> key_values;
+    size_t num_bytes = 0;
+    key_values.reserve(pending_writes.size());
+    for (auto& pending : pending_writes) {
+      num_bytes += pending.first.size() + pending.second.size();
+      key_values.emplace_back(pending.first, std::move(pending.second));
+    }
+    pending_writes.clear();
+
+    if (redis_client->write_batch(key_values) != RETURNok) {
+      OAILOG_ERROR(log_task, "Failed to write %zu states to db",
+                   key_values.size());
+      // Keep the states staged so that the next flush retries them
+      for (auto& key_value : key_values) {
+        pending_writes.emplace(std::move(key_value.first),
+                               std::move(key_value.second));
+      }
+      return;
+    }
+    double duration_ms = std::chrono::duration<double, std::milli>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();
+    observe_histogram("state_checkpoint_bytes", num_bytes, 1, "task",
+                      task_name.c_str(), NO_BOUNDARIES);
+    observe_histogram("state_checkpoint_duration_ms", duration_ms, 1, "task",
+                      task_name.c_str(), NO_BOUNDARIES);
+    OAILOG_DEBUG(log_task, "Finished writing %zu states, %zu bytes",
+                 key_values.size(), num_bytes);
+  }
+
   bool is_persist_state_enabled() const { return persist_state_enabled; }
 
  protected:
@@ -71,9 +128,117 @@ class StateUtility {
         is_initialized(false),
         state_dirty(false),
         persist_state_enabled(false),
+        task_state_version(0),
+        task_state_hash(0),
         log_task(LOG_UTIL) {}
   virtual ~StateUtility() = default;
 
+  /**
+   * Stages a serialized task state, if it differs from the last one written
+   */
+  void stage_state_write(const std::string& proto_str) {
+    // Comparing with the last state is exact and cheaper than hashing it
+    if (proto_str == last_task_state) {
+      return;
+    }
+    std::string wrapped_str;
+    if (RedisClient::wrap_proto_str(proto_str, task_state_version,
+                                    wrapped_str) != RETURNok) {
+      OAILOG_ERROR(log_task, "Failed to serialize state");
+      return;
+    }
+    pending_writes[table_key] = std::move(wrapped_str);
+    last_task_state = proto_str;
+    task_state_version++;
+    state_dirty = false;
+  }
+
+  /**
+   * Stages a serialized UE state, if it differs from the last one written
+   */
+  void stage_ue_state_write(const std::string& imsi_str,
+                            const std::string& proto_str) {
+    std::size_t new_hash = std::hash<std::string>{}(proto_str);
+    auto hash_it = ue_state_hash.find(imsi_str);
+    if (hash_it != ue_state_hash.end() && hash_it->second == new_hash) {
+      return;
+    }
+    std::string wrapped_str;
+    if (RedisClient::wrap_proto_str(proto_str, ue_state_version[imsi_str],
+                                    wrapped_str) != RETURNok) {
+      OAILOG_ERROR(log_task, "Failed to serialize UE state for IMSI %s",
+                   imsi_str.c_str());
+      return;
+    }
+    pending_writes[IMSI_STR_PREFIX + imsi_str + ":" + task_name] =
+        std::move(wrapped_str);
+    ue_state_version[imsi_str]++;
+    ue_state_hash[imsi_str] = new_hash;
+  }
+
+  /**
+   * Reads the UE states stored under keys from db and calls restore_ue with
+   * each key and parsed UE state, on the calling thread. The states are
+   * fetched by windows of pipelined MGETs, a window being parsed on a pool of
+   * threads while the next one is fetched. Keys that no longer exist, e.g.
+   * removed since they were listed, are skipped.
+   */
+  template <typename ProtoUe, typename RestoreUe>
+  status_code_e read_ue_protos_from_db(const std::vector<std::string>& keys,
+                                       RestoreUe restore_ue) {
+    auto read_window = [&](size_t start, std::vector<std::string>& found_keys,
+                           std::vector<std::string>& values) {
+      size_t end = std::min(start + UE_RESTORE_WINDOW, keys.size());
+      try {
+        values = redis_client->read_batch(
+            std::vector<std::string>(keys.begin() + start, keys.begin() + end),
+            found_keys);
+      } catch (const std::runtime_error& e) {
+        return RETURNerror;
+      }
+      return RETURNok;
+    };
+
+    std::vector<std::string> found_keys;
+    std::vector<std::string> values;
+    if (keys.empty()) {
+      return RETURNok;
+    }
+    if (read_window(0, found_keys, values) != RETURNok) {
+      OAILOG_ERROR(log_task, "Failed to read UE states from db");
+      return RETURNerror;
+    }
+    for (size_t start = 0; start < keys.size(); start += UE_RESTORE_WINDOW) {
+      std::vector<ProtoUe> protos;
+      std::vector<uint64_t> versions;
+      std::vector<std::string> next_found_keys;
+      std::vector<std::string> next_values;
+      status_code_e next_rc = RETURNok;
+      auto parsed = std::async(std::launch::async, [&] {
+        return RedisClient::parse_protos(values, protos, versions);
+      });
+      if (start + UE_RESTORE_WINDOW < keys.size()) {
+        next_rc = read_window(start + UE_RESTORE_WINDOW, next_found_keys,
+                              next_values);
+      }
+      if (parsed.get() != RETURNok || next_rc != RETURNok) {
+        OAILOG_ERROR(log_task, "Failed to read UE states from db");
+        return RETURNerror;
+      }
+
+      for (size_t i = 0; i < protos.size(); i++) {
+        const std::string& key = found_keys[i];
+        OAILOG_DEBUG(log_task, "Reading UE state from db for %s", key.c_str());
+        // Update each UE state version from redis
+        ue_state_version[key.substr(4, key.find(':') - 4)] = versions[i];
+        restore_ue(key, protos[i]);
+      }
+      found_keys = std::move(next_found_keys);
+      values = std::move(next_values);
+    }
+    return RETURNok;
+  }
+
   imsi64_t get_imsi_from_key(const std::string& key) const {
     imsi64_t imsi64;
     std::string imsi_str_prefix = key.substr(0, key.find(':'));
@@ -89,6 +254,16 @@ class StateUtility {
   bool state_dirty;
   // Flag for enabling writing and reading to db.
   bool persist_state_enabled;
+  // State version counters for task and ue context
+  uint64_t task_state_version;
+  std::unordered_map<std::string, uint64_t> ue_state_version;
+  // Last written hash values for task and ue context
+  std::size_t task_state_hash;
+  std::unordered_map<std::string, std::size_t> ue_state_hash;
+  // Last written task state, UE states are only compared by hash
+  std::string last_task_state;
+  // Wrapped states to write on the next flush, by key
+  std::unordered_map<std::string, std::string> pending_writes;
 
   std::string table_key;
   std::string task_name;
@@ -25,3 +25,4 @@
 MESSAGE_DEF(UDP_INIT, udp_init_t, udp_init)
 MESSAGE_DEF(UDP_DATA_REQ, udp_data_req_t, udp_data_req)
 MESSAGE_DEF(UDP_DATA_IND, udp_data_ind_t, udp_data_ind)
+MESSAGE_DEF(UDP_DATA_BATCH_IND, udp_data_batch_ind_t, udp_data_batch_ind)
@@ -55,4 +55,22 @@ typedef struct {
   uint16_t peer_port;
 } udp_data_ind_t;
 
+typedef struct {
+  uint8_t* buffer; /* In the allocation of the datagrams of the batch */
+  uint32_t buffer_length;
+  uint16_t peer_port;
+  union {
+    struct sockaddr_in addrv4;
+    struct sockaddr_in6 addrv6;
+  } sock_addr;
+} udp_datagram_t;
+
+/* Datagrams received together on a socket. datagrams and the payloads are a
+ * single allocation, freed with the message content. */
+typedef struct {
+  uint16_t local_port;
+  uint32_t num_datagrams;
+  udp_datagram_t* datagrams;
+} udp_data_batch_ind_t;
+
 #endif /* FILE_UDP_MESSAGES_TYPES_SEEN */
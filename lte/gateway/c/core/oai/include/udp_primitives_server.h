@@ -32,4 +32,10 @@
 int udp_init(void);
 void udp_exit(void);
 
+/** \brief Sets up the UDP task context on the calling thread, without running
+ its loop. Called by the task thread, and by the unit tests running the loop
+ themselves.
+ **/
+void udp_init_task_context(void);
+
 #endif /* UDP_PRIMITIVES_SERVER_H_ */
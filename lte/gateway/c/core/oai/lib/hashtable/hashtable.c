@@ -165,65 +165,174 @@ hash_table_t* hashtable_init(hash_table_t* const hashtblP,
   return hashtblP;
 }
 
+//------------------------------------------------------------------------------
+/*
+   Mixing hash
+   The result of the hash function is mixed (MurmurHash3 finalizer) before
+   being masked, so that sequential keys like S1AP IDs and TEIDs, or keys only
+   differing in their high bits like IMSIs, are spread over the whole table and
+   do not build long probe sequences.
+*/
+static inline hash_size_t hashtable_ts_mix(uint64_t h) {
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return (hash_size_t)h;
+}
+
+static inline hash_size_t hashtable_ts_home(const hash_table_ts_t* hashtblP,
+                                            const hash_slot_array_t* arrayP,
+                                            const hash_key_t keyP) {
+  return hashtable_ts_mix(hashtblP->hashfunc(keyP)) & (arrayP->size - 1);
+}
+
+// Marks the slot of a removed entry, the probe sequences go on past it
+#define HASH_TABLE_TS_TOMBSTONE ((hash_entry_t*)1)
+
+static inline bool hashtable_ts_is_entry(const hash_entry_t* entryP) {
+  return entryP && entryP != HASH_TABLE_TS_TOMBSTONE;
+}
+
+static hash_slot_array_t* hashtable_ts_alloc_slots(hash_size_t sizeP) {
+  hash_slot_array_t* array =
+      calloc(1, sizeof(hash_slot_array_t) + sizeP * sizeof(hash_slot_t));
+
+  if (array) {
+    array->size = sizeP;
+    array->slots = (hash_slot_t*)(array + 1);
+  }
+  return array;
+}
+
+// Returns the entry of keyP or NULL, without locking. Must be called in an
+// epoch read side critical section. The load is kept below 100% so there is
+// always an empty slot ending the probe.
+static hash_entry_t* hashtable_ts_lookup(const hash_table_ts_t* hashtblP,
+                                         const hash_key_t keyP) {
+  const hash_slot_array_t* array =
+      __atomic_load_n(&hashtblP->slots, __ATOMIC_ACQUIRE);
+  hash_size_t mask = array->size - 1;
+  hash_size_t i = hashtable_ts_home(hashtblP, array, keyP);
+  hash_entry_t* entry = NULL;
+
+  while ((entry = __atomic_load_n(&array->slots[i].entry, __ATOMIC_ACQUIRE))) {
+    // The slot key is written before its entry, when it is reused the entry
+    // may not be the one of the key read, the entry key is authoritative
+    if (hashtable_ts_is_entry(entry) &&
+        __atomic_load_n(&array->slots[i].key, __ATOMIC_RELAXED) == keyP &&
+        entry->key == keyP) {
+      return entry;
+    }
+    i = (i + 1) & mask;
+  }
+  return NULL;
+}
+
+// Returns the slot holding keyP or NULL, the table mutex must be held
+static hash_slot_t* hashtable_ts_find(const hash_table_ts_t* hashtblP,
+                                      const hash_key_t keyP) {
+  hash_slot_array_t* array = hashtblP->slots;
+  hash_size_t mask = array->size - 1;
+  hash_size_t i = hashtable_ts_home(hashtblP, array, keyP);
+
+  while (array->slots[i].entry) {
+    if (hashtable_ts_is_entry(array->slots[i].entry) &&
+        array->slots[i].key == keyP) {
+      return &array->slots[i];
+    }
+    i = (i + 1) & mask;
+  }
+  return NULL;
+}
+
+// Publishes a new entry for a key not present in the table in the first free
+// slot of its probe, the table mutex must be held
+static void hashtable_ts_place(hash_table_ts_t* hashtblP,
+                               hash_slot_array_t* arrayP,
+                               hash_entry_t* entryP) {
+  hash_size_t mask = arrayP->size - 1;
+  hash_size_t i = hashtable_ts_home(hashtblP, arrayP, entryP->key);
+
+  while (hashtable_ts_is_entry(arrayP->slots[i].entry)) {
+    i = (i + 1) & mask;
+  }
+  if (!arrayP->slots[i].entry) {
+    hashtblP->used_slots += 1;
+  }
+  __atomic_store_n(&arrayP->slots[i].key, entryP->key, __ATOMIC_RELAXED);
+  __atomic_store_n(&arrayP->slots[i].entry, entryP, __ATOMIC_RELEASE);
+}
+
+// Moves the entries to a new array of sizeP slots without tombstones, the
+// previous array is freed once no lookup can be probing it anymore
+static bool hashtable_ts_resize(hash_table_ts_t* hashtblP, hash_size_t sizeP) {
+  hash_slot_array_t* old_array = hashtblP->slots;
+  hash_slot_array_t* array = hashtable_ts_alloc_slots(sizeP);
+
+  if (!array) {
+    return false;
+  }
+  hashtblP->used_slots = 0;
+  for (hash_size_t i = 0; i < old_array->size; i++) {
+    if (hashtable_ts_is_entry(old_array->slots[i].entry)) {
+      hashtable_ts_place(hashtblP, array, old_array->slots[i].entry);
+    }
+  }
+  __atomic_store_n(&hashtblP->slots, array, __ATOMIC_RELEASE);
+  hashtblP->size = sizeP;
+  hash_epoch_retire(&hashtblP->retired, &old_array->retired);
+  PRINT_HASHTABLE(hashtblP, "%s(%s) resized to %zu slots\n", __FUNCTION__,
+                  bdata(hashtblP->name), sizeP);
+  return true;
+}
+
+// Replaces the entry of a slot by a tombstone, the entry is freed once no
+// lookup can be reading it anymore
+static void hashtable_ts_delete_slot(hash_table_ts_t* hashtblP,
+                                     hash_slot_t* slotP) {
+  hash_entry_t* entry = slotP->entry;
+
+  __atomic_store_n(&slotP->entry, HASH_TABLE_TS_TOMBSTONE, __ATOMIC_RELEASE);
+  __atomic_fetch_sub(&hashtblP->num_elements, 1, __ATOMIC_RELAXED);
+  hash_epoch_retire(&hashtblP->retired, &entry->retired);
+}
+
 //------------------------------------------------------------------------------
 /*
    Initialization
    hashtable_ts_init() sets up the initial structure of the thread safe hash
-   table. The user specified size will be allocated and initialized to NULL. The
-   user can also specify a hash function. If the hashfunc argument is NULL, a
-   default hash function is used. If an error occurred, NULL is returned. All
-   other values in the returned hash_table_t pointer should be released with
-   hashtable_destroy().
+   table. The user specified size is rounded up to a power of two and used as
+   the initial number of slots, the table grows when it gets loaded over
+   HASH_TABLE_TS_MAX_LOAD percent. The user can also specify a hash function,
+   its result is mixed before use. If the hashfunc argument is NULL, the key is
+   used. If an error occurred, NULL is returned. All other values in the
+   returned hash_table_ts_t pointer should be released with
+   hashtable_ts_destroy().
 */
 hash_table_ts_t* hashtable_ts_init(hash_table_ts_t* const hashtblP,
                                    const hash_size_t sizeP,
                                    hash_size_t (*hashfuncP)(const hash_key_t),
                                    void (*freefuncP)(void**),
                                    bstring display_name_pP) {
-  hash_size_t size = sizeP;
-  // upper power of two:
-  // http://graphics.stanford.edu/~seander/bithacks.html#RoundUpPowerOf2Float
-  //  By Sean Eron Anderson
-  // seander@cs.stanford.edu
-  // Individually, the code snippets here are in the public domain (unless
-  // otherwise noted) — feel free to use them however you please. The aggregate
-  // collection and descriptions are © 1997-2005 Sean Eron Anderson. The code
-  // and descriptions are distributed in the hope that they will be useful, but
-  // WITHOUT ANY WARRANTY and without even the implied warranty of
-  // merchantability or fitness for a particular purpose. As of May 5, 2005, all
-  // the code has been tested thoroughly. Thousands of people have read it.
-  // Moreover, Professor Randal Bryant, the Dean of Computer Science at Carnegie
-  // Mellon University, has personally tested almost everything with his Uclid
-  // code verification system. What he hasn't tested, I have checked against all
-  // possible inputs on a 32-bit machine. To the first person to inform me of a
-  // legitimate bug in the code, I'll pay a bounty of US$10 (by check or
-  // Paypal). If directed to a charity, I'll pay US$20.
-  size--;
-  size |= size >> 1;
-  size |= size >> 2;
-  size |= size >> 4;
-  size |= size >> 8;
-  size |= size >> 16;
-  size++;
-
-  memset(hashtblP, 0, sizeof(*hashtblP));
+  hash_size_t size = HASH_TABLE_TS_MIN_SIZE;
+  pthread_mutexattr_t lock_attr;
 
-  if (!(hashtblP->nodes = calloc(size, sizeof(hash_node_t*)))) {
-    free_wrapper((void**)&hashtblP);
-    return NULL;
+  while (size < sizeP) {
+    size <<= 1;
   }
 
-  if (!(hashtblP->lock_nodes = calloc(size, sizeof(pthread_mutex_t)))) {
-    free_wrapper((void**)&hashtblP->nodes);
-    free_wrapper((void**)&hashtblP->name);
-    free_wrapper((void**)&hashtblP);
+  memset(hashtblP, 0, sizeof(*hashtblP));
+
+  if (!(hashtblP->slots = hashtable_ts_alloc_slots(size))) {
     return NULL;
   }
 
-  pthread_mutex_init(&hashtblP->mutex, NULL);
-  for (int i = 0; i < size; i++) {
-    pthread_mutex_init(&hashtblP->lock_nodes[i], NULL);
-  }
+  pthread_mutexattr_init(&lock_attr);
+  pthread_mutexattr_settype(&lock_attr, PTHREAD_MUTEX_RECURSIVE);
+  pthread_mutex_init(&hashtblP->mutex, &lock_attr);
+  pthread_mutexattr_destroy(&lock_attr);
 
   hashtblP->size = size;
 
@@ -250,11 +359,9 @@ hash_table_ts_t* hashtable_ts_init(hash_table_ts_t* const hashtblP,
 /*
    Initialization
    hashtable_ts_create() allocate and sets up the initial structure of the
-   thread safe hash table. The user specified size will be allocated and
-   initialized to NULL. The user can also specify a hash function. If the
-   hashfunc argument is NULL, a default hash function is used. If an error
-   occurred, NULL is returned. All other values in the returned hash_table_t
-   pointer should be released with hashtable_destroy().
+   thread safe hash table, see hashtable_ts_init(). If an error occurred, NULL
+   is returned. All other values in the returned hash_table_ts_t pointer should
+   be released with hashtable_ts_destroy().
 */
 hash_table_ts_t* hashtable_ts_create(const hash_size_t sizeP,
                                      hash_size_t (*hashfuncP)(const hash_key_t),
@@ -265,8 +372,11 @@ hash_table_ts_t* hashtable_ts_create(const hash_size_t sizeP,
   if (!(hashtbl = calloc(1, sizeof(hash_table_ts_t)))) {
     return NULL;
   }
-  hashtbl =
-      hashtable_ts_init(hashtbl, sizeP, hashfuncP, freefuncP, display_name_pP);
+  if (!hashtable_ts_init(hashtbl, sizeP, hashfuncP, freefuncP,
+                         display_name_pP)) {
+    free_wrapper((void**)&hashtbl);
+    return NULL;
+  }
   hashtbl->is_allocated_by_malloc = true;
   return hashtbl;
 }
@@ -274,41 +384,35 @@ hash_table_ts_t* hashtable_ts_create(const hash_size_t sizeP,
 //------------------------------------------------------------------------------
 /*
    Cleanup
-   The hashtable_destroy() walks through the linked lists for each possible
-   hash value, and releases the elements. It also releases the nodes array and
-   the hash_table_t.
+   The hashtable_ts_destroy() walks through the slots and releases the
+   elements. It also releases the slots array and the hash_table_ts_t. The
+   table must not be accessed by other threads anymore.
 */
 hashtable_rc_t hashtable_ts_destroy(hash_table_ts_t* hashtblP) {
-  hash_size_t n = 0;
-  hash_node_t *node = NULL, *oldnode = NULL;
+  hash_slot_array_t* array = NULL;
 
   if (!hashtblP) {
     return HASH_TABLE_BAD_PARAMETER_HASHTABLE;
   }
 
-  for (n = 0; n < hashtblP->size; ++n) {
-    pthread_mutex_lock(&hashtblP->lock_nodes[n]);
-    node = hashtblP->nodes[n];
-
-    while (node) {
-      oldnode = node;
-      node = node->next;
-
-      if (oldnode->data) {
-        hashtblP->freefunc(&oldnode->data);
+  pthread_mutex_lock(&hashtblP->mutex);
+  array = hashtblP->slots;
+  for (hash_size_t n = 0; n < array->size; ++n) {
+    hash_entry_t* entry = array->slots[n].entry;
+    if (hashtable_ts_is_entry(entry)) {
+      if (entry->data) {
+        hashtblP->freefunc(&entry->data);
       }
-
-      free_wrapper((void**)&oldnode);
+      free_wrapper((void**)&entry);
     }
-
-    pthread_mutex_unlock(&hashtblP->lock_nodes[n]);
-    pthread_mutex_destroy(&hashtblP->lock_nodes[n]);
   }
+  free_wrapper((void**)&hashtblP->slots);
+  hash_epoch_free_all(&hashtblP->retired);
+  hashtblP->num_elements = 0;
+  pthread_mutex_unlock(&hashtblP->mutex);
+  pthread_mutex_destroy(&hashtblP->mutex);
 
-  free_wrapper((void**)&hashtblP->nodes);
   bdestroy_wrapper(&hashtblP->name);
-  free_wrapper((void**)&hashtblP->lock_nodes);
-  free_wrapper((void**)&hashtblP->lock_attr);
   if (hashtblP->is_allocated_by_malloc) {
     free_wrapper((void**)&hashtblP);
   }
@@ -318,28 +422,20 @@ hashtable_rc_t hashtable_ts_destroy(hash_table_ts_t* hashtblP) {
 //------------------------------------------------------------------------------
 hashtable_rc_t hashtable_ts_is_key_exists(const hash_table_ts_t* const hashtblP,
                                           const hash_key_t keyP) {
-  hash_node_t* node = NULL;
-  hash_size_t hash = 0;
+  hash_entry_t* entry = NULL;
 
   if (!hashtblP) {
     return HASH_TABLE_BAD_PARAMETER_HASHTABLE;
   }
 
-  hash = hashtblP->hashfunc(keyP) % hashtblP->size;
-  pthread_mutex_lock(&hashtblP->lock_nodes[hash]);
-  node = hashtblP->nodes[hash];
-
-  while (node) {
-    if (node->key == keyP) {
-      pthread_mutex_unlock(&hashtblP->lock_nodes[hash]);
-      PRINT_HASHTABLE(hashtblP, "%s(%s,key 0x%" PRIx64 ") return OK\n",
-                      __FUNCTION__, bdata(hashtblP->name), keyP);
-      return HASH_TABLE_OK;
-    }
-
-    node = node->next;
+  hash_epoch_enter();
+  entry = hashtable_ts_lookup(hashtblP, keyP);
+  hash_epoch_exit();
+  if (entry) {
+    PRINT_HASHTABLE(hashtblP, "%s(%s,key 0x%" PRIx64 ") return OK\n",
+                    __FUNCTION__, bdata(hashtblP->name), keyP);
+    return HASH_TABLE_OK;
   }
-  pthread_mutex_unlock(&hashtblP->lock_nodes[hash]);
   PRINT_HASHTABLE(hashtblP, "%s(%s,key 0x%" PRIx64 ") return KEY_NOT_EXISTS\n",
                   __FUNCTION__, bdata(hashtblP->name), keyP);
   return HASH_TABLE_KEY_NOT_EXISTS;
@@ -347,65 +443,108 @@ hashtable_rc_t hashtable_ts_is_key_exists(const hash_table_ts_t* const hashtblP,
 
 //------------------------------------------------------------------------------
 // may cost a lot CPU...
+// Walks a snapshot of the slots without locking, entries inserted or removed
+// during the walk may or may not be returned.
 hashtable_key_array_t* hashtable_ts_get_keys(hash_table_ts_t* const hashtblP) {
-  hash_node_t* node = NULL;
-  unsigned int i = 0;
   hashtable_key_array_t* ka = NULL;
+  int max_keys = 0;
 
-  ka = calloc(1, sizeof(hashtable_key_array_t));
-  if (ka == NULL) return NULL;
-
-  if (hashtblP->num_elements == 0) {
-    free(ka);
+  if (!hashtblP) {
+    return NULL;
+  }
+  if (!(max_keys =
+            __atomic_load_n(&hashtblP->num_elements, __ATOMIC_RELAXED))) {
     return NULL;
   }
 
-  ka->keys = calloc(hashtblP->num_elements, sizeof(hash_key_t));
+  ka = calloc(1, sizeof(hashtable_key_array_t));
+  if (ka == NULL) return NULL;
+  ka->keys = calloc(max_keys, sizeof(hash_key_t));
   if (ka->keys == NULL) {
     free(ka);
     return NULL;
   }
 
-  while ((ka->num_keys < hashtblP->num_elements) && (i < hashtblP->size)) {
-    pthread_mutex_lock(&hashtblP->lock_nodes[i]);
-    if (hashtblP->nodes[i] != NULL) {
-      node = hashtblP->nodes[i];
-      while (node) {
-        ka->keys[ka->num_keys++] = node->key;
-        node = node->next;
+  hash_epoch_enter();
+  const hash_slot_array_t* array =
+      __atomic_load_n(&hashtblP->slots, __ATOMIC_ACQUIRE);
+  for (hash_size_t i = 0; i < array->size; i++) {
+    hash_entry_t* entry =
+        __atomic_load_n(&array->slots[i].entry, __ATOMIC_ACQUIRE);
+    if (!hashtable_ts_is_entry(entry)) {
+      continue;
+    }
+    if (ka->num_keys == max_keys) {
+      hash_key_t* keys = realloc(ka->keys, 2 * max_keys * sizeof(hash_key_t));
+      if (!keys) {
+        break;
       }
+      ka->keys = keys;
+      max_keys *= 2;
     }
-    pthread_mutex_unlock(&hashtblP->lock_nodes[i]);
-    i++;
+    ka->keys[ka->num_keys++] = entry->key;
+  }
+  hash_epoch_exit();
+
+  if (ka->num_keys == 0) {
+    free(ka->keys);
+    free(ka);
+    return NULL;
   }
   return ka;
 }
 
 //------------------------------------------------------------------------------
 // may cost a lot CPU...
+// Walks a snapshot of the slots without locking, entries inserted or removed
+// during the walk may or may not be returned.
 hashtable_element_array_t* hashtable_ts_get_elements(
     hash_table_ts_t* const hashtblP) {
-  hash_node_t* node = NULL;
-  unsigned int i = 0;
   hashtable_element_array_t* ea = NULL;
+  int max_elements = 0;
 
-  if ((!hashtblP) || !(hashtblP->num_elements)) {
+  if (!hashtblP) {
     return NULL;
   }
+  if (!(max_elements =
+            __atomic_load_n(&hashtblP->num_elements, __ATOMIC_RELAXED))) {
+    return NULL;
+  }
+
   ea = calloc(1, sizeof(hashtable_element_array_t));
-  ea->elements = calloc(hashtblP->num_elements, sizeof(void*));
+  if (ea == NULL) return NULL;
+  ea->elements = calloc(max_elements, sizeof(void*));
+  if (ea->elements == NULL) {
+    free(ea);
+    return NULL;
+  }
 
-  while ((ea->num_elements < hashtblP->num_elements) && (i < hashtblP->size)) {
-    pthread_mutex_lock(&hashtblP->lock_nodes[i]);
-    if (hashtblP->nodes[i] != NULL) {
-      node = hashtblP->nodes[i];
-      while (node) {
-        ea->elements[ea->num_elements++] = node->data;
-        node = node->next;
+  hash_epoch_enter();
+  const hash_slot_array_t* array =
+      __atomic_load_n(&hashtblP->slots, __ATOMIC_ACQUIRE);
+  for (hash_size_t i = 0; i < array->size; i++) {
+    hash_entry_t* entry =
+        __atomic_load_n(&array->slots[i].entry, __ATOMIC_ACQUIRE);
+    if (!hashtable_ts_is_entry(entry)) {
+      continue;
+    }
+    if (ea->num_elements == max_elements) {
+      void** elements = realloc(ea->elements, 2 * max_elements * sizeof(void*));
+      if (!elements) {
+        break;
       }
+      ea->elements = elements;
+      max_elements *= 2;
     }
-    pthread_mutex_unlock(&hashtblP->lock_nodes[i]);
-    i++;
+    ea->elements[ea->num_elements++] =
+        __atomic_load_n(&entry->data, __ATOMIC_ACQUIRE);
+  }
+  hash_epoch_exit();
+
+  if (ea->num_elements == 0) {
+    free(ea->elements);
+    free(ea);
+    return NULL;
   }
   return ea;
 }
@@ -415,37 +554,38 @@ hashtable_element_array_t* hashtable_ts_get_elements(
 // Also useful if we want to find an element in the collection based on compare
 // criteria different than the single key The compare criteria in implemented
 // in the funct_cb function
+// The keys are collected without locking and the table mutex is only held
+// while calling funct_cb for one element, so that lookups are never stalled
+// and modifications only for one callback. Elements removed by a previous
+// call of funct_cb are skipped, elements inserted during the walk may or may
+// not be visited.
 hashtable_rc_t hashtable_ts_apply_callback_on_elements(
     hash_table_ts_t* const hashtblP,
     bool funct_cb(const hash_key_t keyP, void* const dataP, void* parameterP,
                   void** resultP),
     void* parameterP, void** resultP) {
-  hash_node_t* node = NULL;
-  unsigned int i = 0;
-  unsigned int num_elements = 0;
+  hashtable_key_array_t* ka = NULL;
 
   if (!hashtblP) {
     return HASH_TABLE_BAD_PARAMETER_HASHTABLE;
   }
 
-  while ((num_elements < hashtblP->num_elements) && (i < hashtblP->size)) {
-    pthread_mutex_lock(&hashtblP->lock_nodes[i]);
-    if (hashtblP->nodes[i] != NULL) {
-      node = hashtblP->nodes[i];
+  if (!(ka = hashtable_ts_get_keys(hashtblP))) {
+    return HASH_TABLE_OK;
+  }
 
-      while (node) {
-        num_elements++;
-        if (funct_cb(node->key, node->data, parameterP, resultP)) {
-          pthread_mutex_unlock(&hashtblP->lock_nodes[i]);
-          return HASH_TABLE_OK;
-        }
-        node = node->next;
-      }
+  for (int i = 0; i < ka->num_keys; i++) {
+    pthread_mutex_lock(&hashtblP->mutex);
+    hash_slot_t* slot = hashtable_ts_find(hashtblP, ka->keys[i]);
+    bool done = slot && funct_cb(slot->key, slot->entry->data, parameterP,
+                                 resultP);
+    pthread_mutex_unlock(&hashtblP->mutex);
+    if (done) {
+      break;
     }
-    pthread_mutex_unlock(&hashtblP->lock_nodes[i]);
-    i++;
   }
-
+  free_wrapper((void**)&ka->keys);
+  free_wrapper((void**)&ka);
   return HASH_TABLE_OK;
 }
 
@@ -484,34 +624,31 @@ hashtable_rc_t hashtable_dump_content(const hash_table_t* const hashtblP,
 //------------------------------------------------------------------------------
 hashtable_rc_t hashtable_ts_dump_content(const hash_table_ts_t* const hashtblP,
                                          bstring str) {
-  hash_node_t* node = NULL;
-  unsigned int i = 0;
-
   if (!hashtblP) {
     bcatcstr(str, "HASH_TABLE_BAD_PARAMETER_HASHTABLE");
     return HASH_TABLE_BAD_PARAMETER_HASHTABLE;
   }
 
-  while (i < hashtblP->size) {
-    if (hashtblP->nodes[i] != NULL) {
-      pthread_mutex_lock(&hashtblP->lock_nodes[i]);
-      node = hashtblP->nodes[i];
-
-      while (node) {
-        bstring b0 = bformat("Key 0x%" PRIx64 " Element %p Node %p Next %p\n",
-                             node->key, node->data, node, node->next);
-        if (!b0) {
-          PRINT_HASHTABLE(hashtblP, "Error while dumping hashtable content");
-        } else {
-          bconcat(str, b0);
-          bdestroy_wrapper(&b0);
-        }
-        node = node->next;
-      }
-      pthread_mutex_unlock(&hashtblP->lock_nodes[i]);
+  hash_epoch_enter();
+  const hash_slot_array_t* array =
+      __atomic_load_n(&hashtblP->slots, __ATOMIC_ACQUIRE);
+  for (hash_size_t i = 0; i < array->size; i++) {
+    hash_entry_t* entry =
+        __atomic_load_n(&array->slots[i].entry, __ATOMIC_ACQUIRE);
+    if (!hashtable_ts_is_entry(entry)) {
+      continue;
+    }
+    bstring b0 = bformat("Key 0x%" PRIx64 " Element %p Slot %zu\n",
+                         entry->key,
+                         __atomic_load_n(&entry->data, __ATOMIC_ACQUIRE), i);
+    if (!b0) {
+      PRINT_HASHTABLE(hashtblP, "Error while dumping hashtable content");
+    } else {
+      bconcat(str, b0);
+      bdestroy_wrapper(&b0);
     }
-    i += 1;
   }
+  hash_epoch_exit();
   return HASH_TABLE_OK;
 }
 
@@ -576,198 +713,197 @@ hashtable_rc_t hashtable_insert(hash_table_t* const hashtblP,
 //------------------------------------------------------------------------------
 /*
    Adding a new element
-   To make sure the hash value is not bigger than size, the result of the user
-   provided hash function is used modulo size.
+   Before the insert would take the slots holding an entry or a tombstone over
+   HASH_TABLE_TS_MAX_LOAD, the slots are reallocated without tombstones, twice
+   as many if the entries alone take more than half of it. If this fails the
+   element is still inserted as long as one slot is left empty to end the
+   probe sequences.
 */
 hashtable_rc_t hashtable_ts_insert(hash_table_ts_t* const hashtblP,
                                    const hash_key_t keyP, void* dataP) {
-  hash_node_t* node = NULL;
-  hash_size_t hash = 0;
+  hash_slot_t* slot = NULL;
+  hash_entry_t* entry = NULL;
 
   if (!hashtblP) {
     return HASH_TABLE_BAD_PARAMETER_HASHTABLE;
   }
 
-  hash = hashtblP->hashfunc(keyP) % hashtblP->size;
-  pthread_mutex_lock(&hashtblP->lock_nodes[hash]);
-  node = hashtblP->nodes[hash];
+  pthread_mutex_lock(&hashtblP->mutex);
+  slot = hashtable_ts_find(hashtblP, keyP);
 
-  while (node) {
-    if (node->key == keyP) {
-      if ((node->data) && (node->data != dataP)) {
-        hashtblP->freefunc(&node->data);
-        node->data = dataP;
-        pthread_mutex_unlock(&hashtblP->lock_nodes[hash]);
-        PRINT_HASHTABLE(hashtblP,
-                        "%s(%s,key 0x%" PRIx64
-                        " data %p) return INSERT_OVERWRITTEN_DATA\n",
-                        __FUNCTION__, bdata(hashtblP->name), keyP, dataP);
-        return HASH_TABLE_INSERT_OVERWRITTEN_DATA;
-      }
-      node->data = dataP;
-      pthread_mutex_unlock(&hashtblP->lock_nodes[hash]);
-      PRINT_HASHTABLE(hashtblP, "%s(%s,key 0x%" PRIx64 " data %p) return OK\n",
+  if (slot) {
+    void* old_data =
+        __atomic_exchange_n(&slot->entry->data, dataP, __ATOMIC_ACQ_REL);
+    pthread_mutex_unlock(&hashtblP->mutex);
+    if ((old_data) && (old_data != dataP)) {
+      hashtblP->freefunc(&old_data);
+      PRINT_HASHTABLE(hashtblP,
+                      "%s(%s,key 0x%" PRIx64
+                      " data %p) return INSERT_OVERWRITTEN_DATA\n",
                       __FUNCTION__, bdata(hashtblP->name), keyP, dataP);
-      return HASH_TABLE_OK;
+      return HASH_TABLE_INSERT_OVERWRITTEN_DATA;
     }
-
-    node = node->next;
+    PRINT_HASHTABLE(hashtblP, "%s(%s,key 0x%" PRIx64 " data %p) return OK\n",
+                    __FUNCTION__, bdata(hashtblP->name), keyP, dataP);
+    return HASH_TABLE_OK;
   }
 
-  if (!(node = malloc(sizeof(hash_node_t)))) return -1;
+  if ((hashtblP->used_slots + 1) * 100 >
+      hashtblP->size * HASH_TABLE_TS_MAX_LOAD) {
+    hash_size_t size = hashtblP->size;
+    if ((hashtblP->num_elements + 1) * 200 > size * HASH_TABLE_TS_MAX_LOAD) {
+      size *= 2;
+    }
+    if (!hashtable_ts_resize(hashtblP, size) &&
+        hashtblP->used_slots + 1 >= hashtblP->size) {
+      pthread_mutex_unlock(&hashtblP->mutex);
+      return HASH_TABLE_SYSTEM_ERROR;
+    }
+  }
 
-  node->key = keyP;
-  node->data = dataP;
+  if (!(entry = malloc(sizeof(hash_entry_t)))) {
+    pthread_mutex_unlock(&hashtblP->mutex);
+    return HASH_TABLE_SYSTEM_ERROR;
+  }
+  entry->key = keyP;
+  entry->data = dataP;
+  hashtable_ts_place(hashtblP, hashtblP->slots, entry);
+  __atomic_fetch_add(&hashtblP->num_elements, 1, __ATOMIC_RELAXED);
+  pthread_mutex_unlock(&hashtblP->mutex);
+  PRINT_HASHTABLE(hashtblP, "%s(%s,key 0x%" PRIx64 " data %p) return OK\n",
+                  __FUNCTION__, bdata(hashtblP->name), keyP, dataP);
+  return HASH_TABLE_OK;
+}
 
-  if (hashtblP->nodes[hash]) {
-    node->next = hashtblP->nodes[hash];
-  } else {
-    node->next = NULL;
+//------------------------------------------------------------------------------
+/*
+   Sizes the table for num_elementsP more elements, so that inserting them in
+   bulk reallocates the slots once instead of at every doubling.
+*/
+hashtable_rc_t hashtable_ts_reserve(hash_table_ts_t* const hashtblP,
+                                    const hash_size_t num_elementsP) {
+  if (!hashtblP) {
+    return HASH_TABLE_BAD_PARAMETER_HASHTABLE;
   }
 
-  hashtblP->nodes[hash] = node;
-  __sync_fetch_and_add(&hashtblP->num_elements, 1);
-  pthread_mutex_unlock(&hashtblP->lock_nodes[hash]);
-  PRINT_HASHTABLE(hashtblP,
-                  "%s(%s,key 0x%" PRIx64 " data %p) next %p return OK\n",
-                  __FUNCTION__, bdata(hashtblP->name), keyP, dataP, node->next);
+  pthread_mutex_lock(&hashtblP->mutex);
+  // Beyond this, num_elements * 100 or the load of the doubled size would
+  // overflow, and the slots could not be allocated anyway
+  if (num_elementsP > SIZE_MAX / 200 - hashtblP->num_elements) {
+    pthread_mutex_unlock(&hashtblP->mutex);
+    return HASH_TABLE_SYSTEM_ERROR;
+  }
+  hash_size_t num_elements = hashtblP->num_elements + num_elementsP;
+  hash_size_t size = hashtblP->size;
+  while (num_elements * 100 > size * HASH_TABLE_TS_MAX_LOAD) {
+    size *= 2;
+  }
+  if (size != hashtblP->size && !hashtable_ts_resize(hashtblP, size)) {
+    pthread_mutex_unlock(&hashtblP->mutex);
+    return HASH_TABLE_SYSTEM_ERROR;
+  }
+  pthread_mutex_unlock(&hashtblP->mutex);
   return HASH_TABLE_OK;
 }
 
 //------------------------------------------------------------------------------
 /*
    To free_wrapper an element from the hash table, we just search for it in the
-   linked list for that hash value, and free_wrapper it if it is found. If it
-   was not found, it is an error and -1 is returned.
+   probe sequence of its key, remove it and free_wrapper it if it is found. The
+   element is released once the table mutex has been unlocked. If it was not
+   found, HASH_TABLE_KEY_NOT_EXISTS is returned.
 */
 hashtable_rc_t hashtable_ts_free(hash_table_ts_t* const hashtblP,
                                  const hash_key_t keyP) {
-  hash_node_t *node, *prevnode = NULL;
-  hash_size_t hash = 0;
+  hash_slot_t* slot = NULL;
+  void* data = NULL;
 
   if (!hashtblP) {
     return HASH_TABLE_BAD_PARAMETER_HASHTABLE;
   }
 
-  hash = hashtblP->hashfunc(keyP) % hashtblP->size;
-  pthread_mutex_lock(&hashtblP->lock_nodes[hash]);
-  node = hashtblP->nodes[hash];
-
-  while (node) {
-    if (node->key == keyP) {
-      if (prevnode)
-        prevnode->next = node->next;
-      else
-        hashtblP->nodes[hash] = node->next;
+  pthread_mutex_lock(&hashtblP->mutex);
+  slot = hashtable_ts_find(hashtblP, keyP);
 
-      if (node->data) {
-        hashtblP->freefunc(&node->data);
-      }
-
-      free_wrapper((void**)&node);
-      __sync_fetch_and_sub(&hashtblP->num_elements, 1);
-      pthread_mutex_unlock(&hashtblP->lock_nodes[hash]);
-      PRINT_HASHTABLE(hashtblP, "%s(%s,key 0x%" PRIx64 ") return OK\n",
-                      __FUNCTION__, bdata(hashtblP->name), keyP);
-      return HASH_TABLE_OK;
-    }
-
-    prevnode = node;
-    node = node->next;
+  if (!slot) {
+    pthread_mutex_unlock(&hashtblP->mutex);
+    PRINT_HASHTABLE(hashtblP,
+                    "%s(%s,key 0x%" PRIx64 ") return KEY_NOT_EXISTS\n",
+                    __FUNCTION__, bdata(hashtblP->name), keyP);
+    return HASH_TABLE_KEY_NOT_EXISTS;
   }
 
-  pthread_mutex_unlock(&hashtblP->lock_nodes[hash]);
-  PRINT_HASHTABLE(hashtblP, "%s(%s,key 0x%" PRIx64 ") return KEY_NOT_EXISTS\n",
+  data = slot->entry->data;
+  hashtable_ts_delete_slot(hashtblP, slot);
+  pthread_mutex_unlock(&hashtblP->mutex);
+  if (data) {
+    hashtblP->freefunc(&data);
+  }
+  PRINT_HASHTABLE(hashtblP, "%s(%s,key 0x%" PRIx64 ") return OK\n",
                   __FUNCTION__, bdata(hashtblP->name), keyP);
-  return HASH_TABLE_KEY_NOT_EXISTS;
+  return HASH_TABLE_OK;
 }
 
 //------------------------------------------------------------------------------
 /*
-   To remove an element from the hash table, we just search for it in the linked
-   list for that hash value, and remove it if it is found. If it was not found,
-   it is an error and -1 is returned.
+   To remove an element from the hash table, we just search for it in the probe
+   sequence of its key, and remove it if it is found. If it was not found,
+   HASH_TABLE_KEY_NOT_EXISTS is returned.
 */
 hashtable_rc_t hashtable_ts_remove(hash_table_ts_t* const hashtblP,
                                    const hash_key_t keyP, void** dataP) {
-  hash_node_t *node, *prevnode = NULL;
-  hash_size_t hash = 0;
+  hash_slot_t* slot = NULL;
 
   if (!hashtblP) {
     return HASH_TABLE_BAD_PARAMETER_HASHTABLE;
   }
 
-  hash = hashtblP->hashfunc(keyP) % hashtblP->size;
-  pthread_mutex_lock(&hashtblP->lock_nodes[hash]);
-  node = hashtblP->nodes[hash];
+  pthread_mutex_lock(&hashtblP->mutex);
+  slot = hashtable_ts_find(hashtblP, keyP);
 
-  while (node) {
-    if (node->key == keyP) {
-      if (prevnode)
-        prevnode->next = node->next;
-      else
-        hashtblP->nodes[hash] = node->next;
-
-      *dataP = node->data;
-      free_wrapper((void**)&node);
-      __sync_fetch_and_sub(&hashtblP->num_elements, 1);
-      pthread_mutex_unlock(&hashtblP->lock_nodes[hash]);
-      PRINT_HASHTABLE(hashtblP, "%s(%s,key 0x%" PRIx64 ") return OK\n",
-                      __FUNCTION__, bdata(hashtblP->name), keyP);
-      return HASH_TABLE_OK;
-    }
-
-    prevnode = node;
-    node = node->next;
+  if (!slot) {
+    pthread_mutex_unlock(&hashtblP->mutex);
+    PRINT_HASHTABLE(hashtblP,
+                    "%s(%s,key 0x%" PRIx64 ") return KEY_NOT_EXISTS\n",
+                    __FUNCTION__, bdata(hashtblP->name), keyP);
+    return HASH_TABLE_KEY_NOT_EXISTS;
   }
-  pthread_mutex_unlock(&hashtblP->lock_nodes[hash]);
 
-  PRINT_HASHTABLE(hashtblP, "%s(%s,key 0x%" PRIx64 ") return KEY_NOT_EXISTS\n",
+  *dataP = slot->entry->data;
+  hashtable_ts_delete_slot(hashtblP, slot);
+  pthread_mutex_unlock(&hashtblP->mutex);
+  PRINT_HASHTABLE(hashtblP, "%s(%s,key 0x%" PRIx64 ") return OK\n",
                   __FUNCTION__, bdata(hashtblP->name), keyP);
-  return HASH_TABLE_KEY_NOT_EXISTS;
+  return HASH_TABLE_OK;
 }
 
 //------------------------------------------------------------------------------
 /*
-   Searching for an element is easy. We just search through the linked list for
-   the corresponding hash value. NULL is returned if we didn't find it.
+   Searching for an element takes no lock, see hashtable_ts_lookup(). NULL is
+   returned if we didn't find it.
 */
 hashtable_rc_t hashtable_ts_get(const hash_table_ts_t* const hashtblP,
                                 const hash_key_t keyP, void** dataP) {
-  hash_node_t* node = NULL;
-  hash_size_t hash = 0;
+  hash_entry_t* entry = NULL;
 
   *dataP = NULL;
   if (!hashtblP) {
     return HASH_TABLE_BAD_PARAMETER_HASHTABLE;
   }
 
-  hash = hashtblP->hashfunc(keyP) % hashtblP->size;
-
-  pthread_mutex_lock(&hashtblP->lock_nodes[hash]);
-  node = hashtblP->nodes[hash];
-
-  while (node) {
-    if (node->key == keyP) {
-      *dataP = node->data;
-      pthread_mutex_unlock(&hashtblP->lock_nodes[hash]);
-      PRINT_HASHTABLE(hashtblP, "%s(%s,key 0x%" PRIx64 " data %p) return OK\n",
-                      __FUNCTION__, bdata(hashtblP->name), keyP, *dataP);
-      return HASH_TABLE_OK;
-    }
+  hash_epoch_enter();
+  entry = hashtable_ts_lookup(hashtblP, keyP);
+  if (entry) {
+    *dataP = __atomic_load_n(&entry->data, __ATOMIC_ACQUIRE);
+  }
+  hash_epoch_exit();
 
-    node = node->next;
+  if (entry) {
+    PRINT_HASHTABLE(hashtblP, "%s(%s,key 0x%" PRIx64 " data %p) return OK\n",
+                    __FUNCTION__, bdata(hashtblP->name), keyP, *dataP);
+    return HASH_TABLE_OK;
   }
-  pthread_mutex_unlock(&hashtblP->lock_nodes[hash]);
   PRINT_HASHTABLE(hashtblP, "%s(%s,key 0x%" PRIx64 ") return KEY_NOT_EXISTS\n",
                   __FUNCTION__, bdata(hashtblP->name), keyP);
-
-#define TEMPORARY_DEBUG 1
-#if TEMPORARY_DEBUG
-  bstring b = bfromcstr(" ");
-  hashtable_ts_dump_content(hashtblP, b);
-  PRINT_HASHTABLE(hashtblP, "%s:%s\n", bdata(hashtblP->name), bdata(b));
-  bdestroy(b);
-#endif
   return HASH_TABLE_KEY_NOT_EXISTS;
 }
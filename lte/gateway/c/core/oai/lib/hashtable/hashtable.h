@@ -43,6 +43,7 @@
 #include <stddef.h>
 
 #include "lte/gateway/c/core/oai/lib/bstr/bstrlib.h"
+#include "lte/gateway/c/core/oai/lib/hashtable/hashtable_epoch.h"
 
 typedef size_t hash_size_t;
 typedef uint64_t hash_key_t;
@@ -61,6 +62,9 @@ typedef enum hashtable_return_code_e {
 
 #define HASH_TABLE_DEFAULT_HASH_FUNC NULL
 #define HASH_TABLE_DEFAULT_free_wrapper_FUNC NULL
+// Initial number of slots and maximum load in percent of a hash_table_ts_t
+#define HASH_TABLE_TS_MIN_SIZE 16
+#define HASH_TABLE_TS_MAX_LOAD 70
 #define FREE_HASHTABLE_KEY_ARRAY(key_array_ptr)                        \
   do {                                                                 \
     AssertFatal(key_array_ptr, "Trying to free a NULL array pointer"); \
@@ -92,13 +96,42 @@ typedef struct hash_table_s {
   bool log_enabled;
 } hash_table_t;
 
+typedef struct hash_entry_s {
+  hash_retired_t retired;
+  hash_key_t key;
+  void* data;
+} hash_entry_t;
+
+// The key is a copy of the key of the entry, so that probing does not need
+// to dereference the entries
+typedef struct hash_slot_s {
+  hash_key_t key;
+  hash_entry_t* entry;
+} hash_slot_t;
+
+typedef struct hash_slot_array_s {
+  hash_retired_t retired;
+  hash_size_t size;
+  hash_slot_t* slots;
+} hash_slot_array_t;
+
+// Open addressing table with linear probing, slots are kept contiguous and
+// the table doubles its size when the load gets over HASH_TABLE_TS_MAX_LOAD.
+// Lookups and walks of the table take no lock, they run in an epoch read side
+// critical section while the entries and slot arrays they may see are not
+// freed. Modifications take the table mutex, it is recursive so that
+// callbacks of hashtable_ts_apply_callback_on_elements and free functions may
+// call back into the table. Removed entries leave a tombstone in their slot
+// so that concurrent lookups never miss the following entries of the probe
+// sequence, tombstones are purged when the slots are reallocated.
 typedef struct hash_table_ts_s {
   pthread_mutex_t mutex;
   hash_size_t size;
   hash_size_t num_elements;
-  struct hash_node_s** nodes;
-  pthread_mutex_t* lock_nodes;
-  pthread_mutexattr_t* lock_attr;
+  // Slots holding an entry or a tombstone
+  hash_size_t used_slots;
+  hash_slot_array_t* slots;
+  hash_retired_t* retired;
   hash_size_t (*hashfunc)(const hash_key_t);
   void (*freefunc)(void**);
   bstring name;
@@ -170,6 +203,8 @@ hashtable_rc_t hashtable_ts_dump_content(const hash_table_ts_t* hashtbl,
                                          bstring str);
 hashtable_rc_t hashtable_ts_insert(hash_table_ts_t* hashtbl, hash_key_t key,
                                    void* element);
+hashtable_rc_t hashtable_ts_reserve(hash_table_ts_t* hashtbl,
+                                    hash_size_t num_elements);
 hashtable_rc_t hashtable_ts_free(hash_table_ts_t* hashtbl, hash_key_t key);
 hashtable_rc_t hashtable_ts_remove(hash_table_ts_t* hashtbl, hash_key_t key,
                                    void** element);
@@ -0,0 +1,150 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "lte/gateway/c/core/oai/lib/hashtable/hashtable_epoch.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "lte/gateway/c/core/common/dynamic_memory_check.h"
+
+// Memory retired at epoch E is freed once no reader has announced an epoch
+// lower or equal to E. A reader announces the global epoch when entering, and
+// 0 when it is not reading.
+typedef struct hash_epoch_reader_s {
+  uint64_t epoch;
+  struct hash_epoch_reader_s* next;
+  int depth;
+  bool in_use;
+} hash_epoch_reader_t;
+
+static uint64_t hash_epoch = 1;
+
+// Records of the reader threads, records of exited threads are reused and
+// never freed so that writers can scan the list without locking
+static hash_epoch_reader_t* hash_epoch_readers = NULL;
+static pthread_mutex_t hash_epoch_readers_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t hash_epoch_reader_key;
+static pthread_once_t hash_epoch_reader_key_once = PTHREAD_ONCE_INIT;
+static __thread hash_epoch_reader_t* hash_epoch_reader = NULL;
+
+static void hash_epoch_release_reader(void* reader_p) {
+  hash_epoch_reader_t* reader = (hash_epoch_reader_t*)reader_p;
+  __atomic_store_n(&reader->epoch, 0, __ATOMIC_RELEASE);
+  pthread_mutex_lock(&hash_epoch_readers_mutex);
+  reader->depth = 0;
+  reader->in_use = false;
+  pthread_mutex_unlock(&hash_epoch_readers_mutex);
+}
+
+static void hash_epoch_create_reader_key(void) {
+  pthread_key_create(&hash_epoch_reader_key, hash_epoch_release_reader);
+}
+
+static hash_epoch_reader_t* hash_epoch_register_reader(void) {
+  hash_epoch_reader_t* reader = NULL;
+
+  pthread_once(&hash_epoch_reader_key_once, hash_epoch_create_reader_key);
+  pthread_mutex_lock(&hash_epoch_readers_mutex);
+  for (reader = hash_epoch_readers; reader; reader = reader->next) {
+    if (!reader->in_use) {
+      break;
+    }
+  }
+  if (!reader) {
+    reader = calloc(1, sizeof(hash_epoch_reader_t));
+    reader->next = hash_epoch_readers;
+    __atomic_store_n(&hash_epoch_readers, reader, __ATOMIC_RELEASE);
+  }
+  reader->in_use = true;
+  pthread_mutex_unlock(&hash_epoch_readers_mutex);
+
+  pthread_setspecific(hash_epoch_reader_key, reader);
+  hash_epoch_reader = reader;
+  return reader;
+}
+
+//------------------------------------------------------------------------------
+void hash_epoch_enter(void) {
+  hash_epoch_reader_t* reader = hash_epoch_reader;
+
+  if (!reader) {
+    reader = hash_epoch_register_reader();
+  }
+  if (reader->depth++ == 0) {
+    // Either a writer scanning the readers sees the epoch, or the memory it
+    // unlinked before scanning is not visible to the reads that follow. That
+    // needs the store ordered before the later loads of the table, which
+    // only a seq_cst fence guarantees, pairing with the seq_cst epoch
+    // increment and scan of the writer.
+    __atomic_store_n(&reader->epoch,
+                     __atomic_load_n(&hash_epoch, __ATOMIC_RELAXED),
+                     __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  }
+}
+
+//------------------------------------------------------------------------------
+void hash_epoch_exit(void) {
+  hash_epoch_reader_t* reader = hash_epoch_reader;
+
+  if (--reader->depth == 0) {
+    __atomic_store_n(&reader->epoch, 0, __ATOMIC_RELEASE);
+  }
+}
+
+//------------------------------------------------------------------------------
+void hash_epoch_retire(hash_retired_t** list, hash_retired_t* retired) {
+  // Orders the unlink of the retired memory before the epoch increment
+  retired->epoch = __atomic_fetch_add(&hash_epoch, 1, __ATOMIC_SEQ_CST);
+  retired->next = *list;
+  *list = retired;
+  hash_epoch_reclaim(list);
+}
+
+//------------------------------------------------------------------------------
+void hash_epoch_reclaim(hash_retired_t** list) {
+  uint64_t min_epoch = __atomic_load_n(&hash_epoch, __ATOMIC_SEQ_CST);
+
+  if (!*list) {
+    return;
+  }
+  for (hash_epoch_reader_t* reader =
+           __atomic_load_n(&hash_epoch_readers, __ATOMIC_ACQUIRE);
+       reader; reader = reader->next) {
+    uint64_t epoch = __atomic_load_n(&reader->epoch, __ATOMIC_SEQ_CST);
+    if (epoch && epoch < min_epoch) {
+      min_epoch = epoch;
+    }
+  }
+
+  while (*list) {
+    hash_retired_t* retired = *list;
+    if (retired->epoch < min_epoch) {
+      *list = retired->next;
+      free_wrapper((void**)&retired);
+    } else {
+      list = &retired->next;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+void hash_epoch_free_all(hash_retired_t** list) {
+  while (*list) {
+    hash_retired_t* retired = *list;
+    *list = retired->next;
+    free_wrapper((void**)&retired);
+  }
+}
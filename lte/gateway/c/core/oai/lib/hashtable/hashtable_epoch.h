@@ -0,0 +1,58 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+// Epoch based reclamation of the memory read without locks by the hash
+// tables. Readers enclose their accesses in hash_epoch_enter() and
+// hash_epoch_exit(), which never block. Writers unlink memory from the table
+// and retire it, it is freed once every reader that could still see it has
+// exited.
+
+// Header of the memory retired by a writer, must be the first member of the
+// retired structure, which is released with free()
+typedef struct hash_retired_s {
+  struct hash_retired_s* next;
+  uint64_t epoch;
+} hash_retired_t;
+
+/**
+ * Starts a read side critical section of the calling thread, memory retired
+ * after this call is not freed before hash_epoch_exit(). Critical sections
+ * may be nested.
+ */
+void hash_epoch_enter(void);
+
+/**
+ * Ends the read side critical section of the calling thread
+ */
+void hash_epoch_exit(void);
+
+/**
+ * Adds memory unlinked by a writer to the retired list, then frees the
+ * retired memory no reader can access anymore.
+ * The list is owned by the caller, which serializes calls on it.
+ */
+void hash_epoch_retire(hash_retired_t** list, hash_retired_t* retired);
+
+/**
+ * Frees the retired memory no reader can access anymore
+ */
+void hash_epoch_reclaim(hash_retired_t** list);
+
+/**
+ * Frees all the retired memory, when there can be no reader anymore
+ */
+void hash_epoch_free_all(hash_retired_t** list);
@@ -37,6 +37,8 @@
 #include <string.h>
 #include <malloc.h>
 #include <stdint.h>
+#include <sched.h>
+#include <sys/eventfd.h>
 #include <liblfds710.h>
 
 #include "lte/gateway/c/core/common/assertions.h"
@@ -52,7 +54,9 @@
 #undef CHECK_PROTOTYPE_ONLY
 
 #include "lte/gateway/c/core/common/dynamic_memory_check.h"
+#include "lte/gateway/c/core/oai/common/itti_free_defined_msg.h"
 #include "lte/gateway/c/core/oai/lib/itti/signals.h"
+#include "lte/gateway/c/core/oai/lib/itti/timer_wheel.h"
 
 /* ITTI DEBUG groups */
 #define ITTI_DEBUG_POLL (1 << 0)
@@ -78,6 +82,83 @@ const int itti_debug = ITTI_DEBUG_ISSUES | ITTI_DEBUG_MP_STATISTICS;
 #define likely(x) __builtin_expect(!!(x), 1)
 #define unlikely(x) __builtin_expect(!!(x), 0)
 
+/* Slots of a task ring. A sender blocks while the ring of the destination is
+   full, like a ZMQ PUSH socket does at its high water mark. */
+#define ITTI_RING_SIZE (1 << 14)
+#define ITTI_RING_MASK (ITTI_RING_SIZE - 1)
+/* A sender on a full ring yields this many times, then sleeps with an
+   exponential backoff, and drops the message once the ring stayed full for
+   ITTI_RING_PUSH_TIMEOUT_MSEC, e.g. when a task sends to itself */
+#define ITTI_RING_PUSH_YIELDS 64
+#define ITTI_RING_PUSH_MAX_SLEEP_USEC 1000
+#define ITTI_RING_PUSH_TIMEOUT_MSEC 5000
+/* Messages handled per wakeup before yielding to the other zloop events */
+#define ITTI_RING_BATCH 64
+
+#define ITTI_CACHE_LINE 64
+
+/* Recycle messages in per-thread pools, build with ITTI_MSG_POOL=0 to malloc
+   and free every message, e.g. when looking for memory errors with ASAN */
+#ifndef ITTI_MSG_POOL
+#define ITTI_MSG_POOL 1
+#endif
+/* Free messages kept per size class and thread, the rest go back to malloc */
+#define ITTI_POOL_MAX_FREE 256
+
+typedef struct itti_ring_slot_s {
+  /* Sequence of the slot minus its index, so that zeroed memory is an empty
+     ring and the slots are only paged in when first used */
+  uint64_t seq;
+  MessageDef* msg;
+} itti_ring_slot_t;
+
+/* Bounded MPSC queue of message pointers (D. Vyukov), any thread may send
+   and only the thread running the zloop of the task receives */
+typedef struct itti_ring_s {
+  uint64_t enqueue_pos __attribute__((aligned(ITTI_CACHE_LINE)));
+  uint64_t dequeue_pos __attribute__((aligned(ITTI_CACHE_LINE)));
+  /* Set by the receiver before going back to poll, a sender clearing it
+     signals event_fd */
+  bool waiting __attribute__((aligned(ITTI_CACHE_LINE)));
+  int event_fd;
+  itti_ring_slot_t* slots;
+} itti_ring_t;
+
+/* Trailer after the payload of a message whose ittiMsgSize is the size of its
+   message id, so that it is not overwritten when the header and payload are
+   copied. Written when the message is malloc'ed and kept while it is
+   recycled. */
+typedef struct itti_pool_tag_s {
+  /* Pool the message goes back to, NULL to free it */
+  struct itti_pool_s* owner;
+  /* Next message in a free list of the owner */
+  MessageDef* next;
+  uint16_t msg_class;
+} itti_pool_tag_t;
+
+typedef struct itti_pool_class_s {
+  MessageDef* free_list;
+  uint32_t free_count;
+} itti_pool_class_t;
+
+/* Free messages of a thread, by size class. Messages are malloc'ed one by
+   one so that a message freed with free() instead of itti_free_msg is only
+   lost to the pool. A message always goes back to the pool of the thread
+   that allocated it: one freed by another thread is pushed on remote_free
+   and taken back by the owner thread when it runs out of free messages. */
+typedef struct itti_pool_s {
+  itti_pool_class_t* classes;
+  uint16_t num_classes;
+  /* Only written by the owner thread, read by itti_get_msg_pool_stats */
+  uint64_t hits;
+  uint64_t misses;
+  struct itti_pool_s* next;
+  /* Cleared when the owner thread exits, the pool is then kept for the next
+     thread so that the owner of the messages in flight stays valid */
+  bool owned;
+  MessageDef* remote_free __attribute__((aligned(ITTI_CACHE_LINE)));
+} itti_pool_t;
+
 typedef volatile enum task_state_s {
   TASK_STATE_NOT_CONFIGURED,
   TASK_STATE_STARTING,
@@ -109,14 +190,447 @@ typedef struct itti_desc_s {
 
   volatile uint32_t created_tasks;
   volatile uint32_t ready_tasks;
+
+  itti_transport_t transport;
+  /* Indexed by task id, with ITTI_TRANSPORT_RING only */
+  itti_ring_t* rings;
+
+  /* Pool size class of each message id, messages with the same
+     messages_info[].size share a class */
+  uint16_t* msg_class;
+  MessageHeaderSize* class_size;
+  uint16_t num_classes;
 } itti_desc_t;
 
 static itti_desc_t itti_desc;
 
+static pthread_once_t itti_pool_once = PTHREAD_ONCE_INIT;
+static pthread_key_t itti_pool_key;
+static __thread itti_pool_t* itti_pool = NULL;
+/* Pools of the running threads and counters of the exited ones */
+static pthread_mutex_t itti_pools_mutex = PTHREAD_MUTEX_INITIALIZER;
+static itti_pool_t* itti_pools = NULL;
+/* Pools of the exited threads, reused by the new ones */
+static itti_pool_t* itti_orphan_pools = NULL;
+static uint64_t itti_exited_pool_hits = 0;
+static uint64_t itti_exited_pool_misses = 0;
+
+static inline size_t itti_pool_tag_offset(size_t size) {
+  size_t offset = sizeof(MessageHeader) + size;
+  return (offset + _Alignof(itti_pool_tag_t) - 1) &
+         ~(_Alignof(itti_pool_tag_t) - 1);
+}
+
+/* The header and size of a pooled message are never overwritten */
+static inline itti_pool_tag_t* itti_pool_tag(MessageDef* message) {
+  return (itti_pool_tag_t*)((uint8_t*)message +
+                            itti_pool_tag_offset(
+                                message->ittiMsgHeader.ittiMsgSize));
+}
+
+static inline bool itti_pool_eligible(MessagesIds message_id, size_t size) {
+  return ITTI_MSG_POOL && message_id < itti_desc.messages_id_max &&
+         size == itti_desc.messages_info[message_id].size;
+}
+
+/* Called by the owner thread only */
+static void itti_pool_put(itti_pool_t* pool, MessageDef* message,
+                          itti_pool_tag_t* tag) {
+  itti_pool_class_t* pool_class = &pool->classes[tag->msg_class];
+  if (pool_class->free_count >= ITTI_POOL_MAX_FREE) {
+    free(message);
+    return;
+  }
+  tag->next = pool_class->free_list;
+  pool_class->free_list = message;
+  pool_class->free_count++;
+}
+
+/* Moves the messages freed by other threads to the free lists, called by the
+   owner thread only */
+static void itti_pool_take_remote(itti_pool_t* pool) {
+  MessageDef* message =
+      __atomic_exchange_n(&pool->remote_free, NULL, __ATOMIC_ACQUIRE);
+  while (message) {
+    itti_pool_tag_t* tag = itti_pool_tag(message);
+    MessageDef* next = tag->next;
+    itti_pool_put(pool, message, tag);
+    message = next;
+  }
+}
+
+static void itti_pool_free_lists(itti_pool_t* pool) {
+  for (uint16_t c = 0; c < pool->num_classes; c++) {
+    MessageDef* message = pool->classes[c].free_list;
+    while (message) {
+      MessageDef* next = itti_pool_tag(message)->next;
+      free(message);
+      message = next;
+    }
+    pool->classes[c].free_list = NULL;
+    pool->classes[c].free_count = 0;
+  }
+}
+
+static void itti_pool_destroy(void* arg) {
+  itti_pool_t* pool = (itti_pool_t*)arg;
+
+  // Threads freeing messages of this pool from now on free them directly
+  __atomic_store_n(&pool->owned, false, __ATOMIC_SEQ_CST);
+  itti_pool_take_remote(pool);
+  itti_pool_free_lists(pool);
+
+  pthread_mutex_lock(&itti_pools_mutex);
+  for (itti_pool_t** it = &itti_pools; *it; it = &(*it)->next) {
+    if (*it == pool) {
+      *it = pool->next;
+      break;
+    }
+  }
+  itti_exited_pool_hits += pool->hits;
+  itti_exited_pool_misses += pool->misses;
+  pool->hits = 0;
+  pool->misses = 0;
+  pool->next = itti_orphan_pools;
+  itti_orphan_pools = pool;
+  pthread_mutex_unlock(&itti_pools_mutex);
+  itti_pool = NULL;
+}
+
+static void itti_pool_create_key(void) {
+  pthread_key_create(&itti_pool_key, itti_pool_destroy);
+}
+
+static itti_pool_t* itti_pool_get(void) {
+  if (likely(itti_pool != NULL)) {
+    return itti_pool;
+  }
+
+  pthread_mutex_lock(&itti_pools_mutex);
+  itti_pool_t* pool = itti_orphan_pools;
+  if (pool) {
+    itti_orphan_pools = pool->next;
+  } else {
+    pool = aligned_alloc(ITTI_CACHE_LINE, sizeof(itti_pool_t));
+    AssertFatal(pool != NULL, "Pool memory allocation failed!\n");
+    memset(pool, 0, sizeof(itti_pool_t));
+  }
+  pool->next = itti_pools;
+  itti_pools = pool;
+  pthread_mutex_unlock(&itti_pools_mutex);
+
+  // Messages freed while the pool had no owner thread
+  itti_pool_take_remote(pool);
+  itti_pool_free_lists(pool);
+  if (pool->num_classes < itti_desc.num_classes) {
+    free(pool->classes);
+    pool->num_classes = itti_desc.num_classes;
+    pool->classes = calloc(pool->num_classes, sizeof(itti_pool_class_t));
+    AssertFatal(pool->classes != NULL, "Pool memory allocation failed!\n");
+  }
+  __atomic_store_n(&pool->owned, true, __ATOMIC_SEQ_CST);
+
+  pthread_once(&itti_pool_once, itti_pool_create_key);
+  pthread_setspecific(itti_pool_key, pool);
+
+  itti_pool = pool;
+  return pool;
+}
+
+static void itti_init_msg_classes(void) {
+  free_wrapper((void**)&itti_desc.msg_class);
+  free_wrapper((void**)&itti_desc.class_size);
+  itti_desc.msg_class = calloc(itti_desc.messages_id_max, sizeof(uint16_t));
+  itti_desc.class_size =
+      calloc(itti_desc.messages_id_max, sizeof(MessageHeaderSize));
+  AssertFatal(itti_desc.msg_class && itti_desc.class_size,
+              "Pool memory allocation failed!\n");
+
+  itti_desc.num_classes = 0;
+  for (MessagesIds id = 0; id < itti_desc.messages_id_max; id++) {
+    MessageHeaderSize size = itti_desc.messages_info[id].size;
+    uint16_t c = 0;
+    while (c < itti_desc.num_classes && itti_desc.class_size[c] != size) {
+      c++;
+    }
+    if (c == itti_desc.num_classes) {
+      itti_desc.class_size[itti_desc.num_classes++] = size;
+    }
+    itti_desc.msg_class[id] = c;
+  }
+}
+
+/* Allocates a message of message_id with a payload of size bytes, taken from
+   the pool of the thread when size is the size of message_id */
+static MessageDef* itti_msg_alloc(MessagesIds message_id, size_t size) {
+  if (!itti_pool_eligible(message_id, size)) {
+    MessageDef* message = (MessageDef*)malloc(sizeof(MessageHeader) + size);
+    AssertFatal(message != NULL, "Message memory allocation failed!\n");
+    return message;
+  }
+
+  itti_pool_t* pool = itti_pool_get();
+  uint16_t c = itti_desc.msg_class[message_id];
+
+  if (likely(c < pool->num_classes)) {
+    if (!pool->classes[c].free_list &&
+        __atomic_load_n(&pool->remote_free, __ATOMIC_RELAXED)) {
+      itti_pool_take_remote(pool);
+    }
+    MessageDef* message = pool->classes[c].free_list;
+    if (message) {
+      pool->classes[c].free_list = itti_pool_tag(message)->next;
+      pool->classes[c].free_count--;
+      __atomic_store_n(&pool->hits, pool->hits + 1, __ATOMIC_RELAXED);
+      return message;
+    }
+  }
+  __atomic_store_n(&pool->misses, pool->misses + 1, __ATOMIC_RELAXED);
+
+  MessageDef* message = (MessageDef*)malloc(itti_pool_tag_offset(size) +
+                                            sizeof(itti_pool_tag_t));
+  AssertFatal(message != NULL, "Message memory allocation failed!\n");
+  message->ittiMsgHeader.ittiMsgSize = size;
+  itti_pool_tag_t* tag = itti_pool_tag(message);
+  tag->owner = likely(c < pool->num_classes) ? pool : NULL;
+  tag->msg_class = c;
+  return message;
+}
+
+void itti_free_msg(MessageDef* message) {
+  if (message == NULL) {
+    return;
+  }
+
+  if (itti_pool_eligible(message->ittiMsgHeader.messageId,
+                         message->ittiMsgHeader.ittiMsgSize)) {
+    itti_pool_tag_t* tag = itti_pool_tag(message);
+    itti_pool_t* owner = tag->owner;
+
+    if (likely(owner != NULL && owner == itti_pool)) {
+      itti_pool_put(owner, message, tag);
+      return;
+    }
+    if (owner && __atomic_load_n(&owner->owned, __ATOMIC_SEQ_CST)) {
+      // Released to the owner thread with the push
+      tag->next = __atomic_load_n(&owner->remote_free, __ATOMIC_RELAXED);
+      while (!__atomic_compare_exchange_n(&owner->remote_free, &tag->next,
+                                          message, true, __ATOMIC_RELEASE,
+                                          __ATOMIC_RELAXED)) {
+      }
+      return;
+    }
+  }
+
+  free(message);
+}
+
+void itti_get_msg_pool_stats(uint64_t* hits, uint64_t* misses) {
+  pthread_mutex_lock(&itti_pools_mutex);
+  *hits = itti_exited_pool_hits;
+  *misses = itti_exited_pool_misses;
+  for (itti_pool_t* pool = itti_pools; pool; pool = pool->next) {
+    *hits += __atomic_load_n(&pool->hits, __ATOMIC_RELAXED);
+    *misses += __atomic_load_n(&pool->misses, __ATOMIC_RELAXED);
+  }
+  pthread_mutex_unlock(&itti_pools_mutex);
+}
+
+/* Message popped from the task ring, handed over to receive_msg */
+static __thread MessageDef* itti_ring_msg = NULL;
+
+static bool itti_ring_try_push(itti_ring_t* ring, MessageDef* message) {
+  uint64_t pos = __atomic_load_n(&ring->enqueue_pos, __ATOMIC_RELAXED);
+  itti_ring_slot_t* slot;
+
+  for (;;) {
+    slot = &ring->slots[pos & ITTI_RING_MASK];
+    uint64_t seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) +
+                   (pos & ITTI_RING_MASK);
+    int64_t diff = (int64_t)(seq - pos);
+
+    if (diff == 0) {
+      if (__atomic_compare_exchange_n(&ring->enqueue_pos, &pos, pos + 1, true,
+                                      __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        break;
+      }
+    } else if (diff < 0) {
+      return false;
+    } else {
+      pos = __atomic_load_n(&ring->enqueue_pos, __ATOMIC_RELAXED);
+    }
+  }
+
+  slot->msg = message;
+  __atomic_store_n(&slot->seq, pos + 1 - (pos & ITTI_RING_MASK),
+                   __ATOMIC_RELEASE);
+  return true;
+}
+
+/* Returns false, keeping ownership of the message with the caller, if the
+   ring stayed full for ITTI_RING_PUSH_TIMEOUT_MSEC */
+static bool itti_ring_push(itti_ring_t* ring, MessageDef* message) {
+  if (unlikely(!itti_ring_try_push(ring, message))) {
+    int64_t deadline = zclock_mono() + ITTI_RING_PUSH_TIMEOUT_MSEC;
+    useconds_t sleep_usec = 1;
+    int yields = 0;
+
+    while (!itti_ring_try_push(ring, message)) {
+      if (yields < ITTI_RING_PUSH_YIELDS) {
+        yields++;
+        sched_yield();
+        continue;
+      }
+      if (zclock_mono() >= deadline) {
+        return false;
+      }
+      usleep(sleep_usec);
+      if (sleep_usec < ITTI_RING_PUSH_MAX_SLEEP_USEC) {
+        sleep_usec *= 2;
+      }
+    }
+  }
+
+  // Pairs with the fence in itti_ring_handler, either the receiver sees the
+  // message before sleeping or this sender sees it waiting
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  if (__atomic_exchange_n(&ring->waiting, false, __ATOMIC_SEQ_CST)) {
+    eventfd_write(ring->event_fd, 1);
+  }
+  return true;
+}
+
+static void itti_ring_log_drop(task_id_t destination_task_id,
+                               MessageDef* message) {
+  ITTI_DEBUG(ITTI_DEBUG_ISSUES,
+             "Ring of task %s full for %d ms, dropping message %s\n",
+             itti_get_task_name(destination_task_id),
+             ITTI_RING_PUSH_TIMEOUT_MSEC,
+             itti_get_message_name(message->ittiMsgHeader.messageId));
+}
+
+static MessageDef* itti_ring_pop(itti_ring_t* ring) {
+  uint64_t pos = ring->dequeue_pos;
+  itti_ring_slot_t* slot = &ring->slots[pos & ITTI_RING_MASK];
+  uint64_t seq =
+      __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) + (pos & ITTI_RING_MASK);
+
+  if (seq != pos + 1) {
+    return NULL;
+  }
+
+  MessageDef* message = slot->msg;
+  __atomic_store_n(&slot->seq, pos + ITTI_RING_SIZE - (pos & ITTI_RING_MASK),
+                   __ATOMIC_RELEASE);
+  ring->dequeue_pos = pos + 1;
+  return message;
+}
+
+static inline void itti_msg_batch_end(task_zmq_ctx_t* task_zmq_ctx_p) {
+  if (task_zmq_ctx_p->msg_batch_end_handler) {
+    task_zmq_ctx_p->msg_batch_end_handler(task_zmq_ctx_p);
+  }
+}
+
+static int itti_ring_handler(zloop_t* loop, zmq_pollitem_t* item, void* arg) {
+  task_zmq_ctx_t* task_zmq_ctx_p = (task_zmq_ctx_t*)arg;
+  itti_ring_t* ring = &itti_desc.rings[task_zmq_ctx_p->task_id];
+  eventfd_t events;
+
+  eventfd_read(ring->event_fd, &events);
+
+  for (int i = 0; i < ITTI_RING_BATCH; i++) {
+    MessageDef* message = itti_ring_pop(ring);
+    if (message == NULL) {
+      __atomic_store_n(&ring->waiting, true, __ATOMIC_SEQ_CST);
+      __atomic_thread_fence(__ATOMIC_SEQ_CST);
+      message = itti_ring_pop(ring);
+      if (message == NULL) {
+        itti_msg_batch_end(task_zmq_ctx_p);
+        return 0;
+      }
+      __atomic_store_n(&ring->waiting, false, __ATOMIC_SEQ_CST);
+    }
+
+    itti_ring_msg = message;
+    int rc = task_zmq_ctx_p->msg_handler(loop, NULL, NULL);
+    if (rc != 0) {
+      return rc;
+    }
+  }
+
+  // Batch done with messages left, poll again after the timers and the other
+  // readers of the loop
+  eventfd_write(ring->event_fd, 1);
+  itti_msg_batch_end(task_zmq_ctx_p);
+  return 0;
+}
+
+// ZMQ transport reader of the tasks with a batch end handler, the socket
+// delivers one message at a time
+static int itti_zmq_batch_handler(zloop_t* loop, zsock_t* reader, void* arg) {
+  task_zmq_ctx_t* task_zmq_ctx_p = (task_zmq_ctx_t*)arg;
+
+  int rc = task_zmq_ctx_p->msg_handler(loop, reader, NULL);
+  if (rc == 0) {
+    task_zmq_ctx_p->msg_batch_end_handler(task_zmq_ctx_p);
+  }
+  return rc;
+}
+
+static void itti_init_rings(void) {
+  itti_desc.rings = aligned_alloc(ITTI_CACHE_LINE,
+                                  itti_desc.task_max * sizeof(itti_ring_t));
+  AssertFatal(itti_desc.rings != NULL, "Ring memory allocation failed!\n");
+  memset(itti_desc.rings, 0, itti_desc.task_max * sizeof(itti_ring_t));
+
+  for (task_id_t task_id = 0; task_id < itti_desc.task_max; task_id++) {
+    itti_ring_t* ring = &itti_desc.rings[task_id];
+    ring->slots = calloc(ITTI_RING_SIZE, sizeof(itti_ring_slot_t));
+    AssertFatal(ring->slots != NULL, "Ring memory allocation failed!\n");
+    ring->event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    AssertFatal(ring->event_fd != -1, "Ring eventfd creation failed!\n");
+    ring->waiting = true;
+  }
+}
+
+static void itti_free_rings(void) {
+  if (itti_desc.rings == NULL) {
+    return;
+  }
+  for (task_id_t task_id = 0; task_id < itti_desc.task_max; task_id++) {
+    itti_ring_t* ring = &itti_desc.rings[task_id];
+    MessageDef* message;
+    while ((message = itti_ring_pop(ring)) != NULL) {
+      itti_free_msg_content(message);
+      itti_free_msg(message);
+    }
+    close(ring->event_fd);
+    free(ring->slots);
+  }
+  free_wrapper((void**)&itti_desc.rings);
+}
+
 status_code_e send_msg_to_task(task_zmq_ctx_t* task_zmq_ctx_p,
                                task_id_t destination_task_id,
                                MessageDef* message) {
-  if (likely(task_zmq_ctx_p->ready)) {
+  if (likely(task_zmq_ctx_p->ready) &&
+      itti_desc.transport == ITTI_TRANSPORT_RING) {
+    AssertFatal(task_zmq_ctx_p->push_rings[destination_task_id],
+                "Sending to task without ring. id: %s to %s!\n",
+                itti_get_message_name(message->ittiMsgHeader.messageId),
+                itti_get_task_name(destination_task_id));
+
+    // Ownership of the message moves to the destination task
+    if (!itti_ring_push(task_zmq_ctx_p->push_rings[destination_task_id],
+                        message)) {
+      itti_ring_log_drop(destination_task_id, message);
+      itti_free_msg_content(message);
+      itti_free_msg(message);
+      return RETURNerror;
+    }
+    return RETURNok;
+  } else if (likely(task_zmq_ctx_p->ready)) {
     AssertFatal(task_zmq_ctx_p->push_socks[destination_task_id],
                 "Sending to task without push socket. id: %s to %s!\n",
                 itti_get_message_name(message->ittiMsgHeader.messageId),
@@ -140,17 +654,27 @@ status_code_e send_msg_to_task(task_zmq_ctx_t* task_zmq_ctx_p,
                itti_get_task_name(destination_task_id));
   }
 
-  free(message);
+  itti_free_msg(message);
   return RETURNok;
 }
 
 MessageDef* receive_msg(zsock_t* reader) {
+  if (reader == NULL) {
+    // Popped from the task ring by itti_ring_handler, no copy needed
+    MessageDef* msg = itti_ring_msg;
+    itti_ring_msg = NULL;
+    AssertFatal(msg != NULL, "No message received from the task ring!\n");
+    return msg;
+  }
+
   zframe_t* msg_frame = zframe_recv(reader);
   assert(msg_frame);
 
   // Copy message to avoid memory alignment problems
-  MessageDef* msg = (MessageDef*)malloc(zframe_size(msg_frame));
-  AssertFatal(msg != NULL, "Message memory allocation failed!\n");
+  MessageHeader header;
+  memcpy(&header, zframe_data(msg_frame), sizeof(MessageHeader));
+  MessageDef* msg = itti_msg_alloc(
+      header.messageId, zframe_size(msg_frame) - sizeof(MessageHeader));
   memcpy(msg, zframe_data(msg_frame), zframe_size(msg_frame));
 
   zframe_destroy(&msg_frame);
@@ -158,6 +682,25 @@ MessageDef* receive_msg(zsock_t* reader) {
 }
 
 void send_broadcast_msg(task_zmq_ctx_t* task_zmq_ctx_p, MessageDef* message) {
+  if (itti_desc.transport == ITTI_TRANSPORT_RING) {
+    size_t size = sizeof(MessageHeader) + message->ittiMsgHeader.ittiMsgSize;
+    for (int i = 0; i < TASK_MAX; i++) {
+      if (task_zmq_ctx_p->push_rings[i]) {
+        // Every destination task owns and frees its own copy
+        MessageDef* copy = itti_msg_alloc(message->ittiMsgHeader.messageId,
+                                          message->ittiMsgHeader.ittiMsgSize);
+        memcpy(copy, message, size);
+        if (!itti_ring_push(task_zmq_ctx_p->push_rings[i], copy)) {
+          // The content is shared with the other copies
+          itti_ring_log_drop(i, copy);
+          itti_free_msg(copy);
+        }
+      }
+    }
+    itti_free_msg(message);
+    return;
+  }
+
   zframe_t* frame = zframe_new(
       message, sizeof(MessageHeader) + message->ittiMsgHeader.ittiMsgSize);
   assert(frame);
@@ -172,7 +715,7 @@ void send_broadcast_msg(task_zmq_ctx_t* task_zmq_ctx_p, MessageDef* message) {
 
   // Destroy frame as zframe_send did not destroy it because of ZFRAME_REUSE
   zframe_destroy(&frame);
-  free(message);
+  itti_free_msg(message);
 }
 
 int start_timer(task_zmq_ctx_t* task_zmq_ctx_p, size_t msec,
@@ -191,6 +734,55 @@ void stop_timer(task_zmq_ctx_t* task_zmq_ctx_p, int timer_id) {
   zloop_timer_end(task_zmq_ctx_p->event_loop, timer_id);
 }
 
+// The tick timer only runs while wheel timers are armed, so that idle tasks
+// are not woken up every tick
+static int timer_wheel_tick_handler(zloop_t* loop, int timer_id, void* arg) {
+  task_zmq_ctx_t* task_zmq_ctx_p = (task_zmq_ctx_t*)arg;
+  int rc = timer_wheel_expire(task_zmq_ctx_p->timer_wheel, loop, zclock_mono());
+
+  if (!timer_wheel_size(task_zmq_ctx_p->timer_wheel) &&
+      task_zmq_ctx_p->timer_wheel_ticking) {
+    zloop_timer_end(loop, task_zmq_ctx_p->timer_wheel_tick_id);
+    task_zmq_ctx_p->timer_wheel_ticking = false;
+  }
+  return rc;
+}
+
+int start_wheel_timer(task_zmq_ctx_t* task_zmq_ctx_p, size_t msec,
+                      timer_repeat_t repeat, zloop_timer_fn handler,
+                      void* arg) {
+  if (!task_zmq_ctx_p->timer_wheel) {
+    task_zmq_ctx_p->timer_wheel =
+        timer_wheel_create(TIMER_WHEEL_TICK_MSEC, zclock_mono());
+    AssertFatal(task_zmq_ctx_p->timer_wheel,
+                "Error creating timer wheel for Task: %s\n",
+                itti_get_task_name(task_zmq_ctx_p->task_id));
+  }
+  int timer_id = timer_wheel_add(task_zmq_ctx_p->timer_wheel, zclock_mono(),
+                                 msec, repeat == TIMER_REPEAT_FOREVER, handler,
+                                 arg);
+
+  AssertFatal(timer_id != -1, "Error starting timer for Task: %s\n",
+              itti_get_task_name(task_zmq_ctx_p->task_id));
+
+  if (!task_zmq_ctx_p->timer_wheel_ticking) {
+    task_zmq_ctx_p->timer_wheel_tick_id =
+        zloop_timer(task_zmq_ctx_p->event_loop, TIMER_WHEEL_TICK_MSEC, 0,
+                    timer_wheel_tick_handler, task_zmq_ctx_p);
+    AssertFatal(task_zmq_ctx_p->timer_wheel_tick_id != -1,
+                "Error starting timer wheel tick for Task: %s\n",
+                itti_get_task_name(task_zmq_ctx_p->task_id));
+    task_zmq_ctx_p->timer_wheel_ticking = true;
+  }
+  return timer_id;
+}
+
+void stop_wheel_timer(task_zmq_ctx_t* task_zmq_ctx_p, int timer_id) {
+  if (task_zmq_ctx_p->timer_wheel) {
+    timer_wheel_del(task_zmq_ctx_p->timer_wheel, timer_id);
+  }
+}
+
 void init_task_context(task_id_t task_id, const task_id_t* remote_task_ids,
                        uint8_t remote_tasks_count, zloop_reader_fn msg_handler,
                        task_zmq_ctx_t* task_zmq_ctx_p) {
@@ -201,6 +793,25 @@ void init_task_context(task_id_t task_id, const task_id_t* remote_task_ids,
 
   pthread_mutex_init(&task_zmq_ctx_p->send_mutex, NULL);
 
+  if (itti_desc.transport == ITTI_TRANSPORT_RING) {
+    for (int i = 0; i < remote_tasks_count; i++) {
+      task_zmq_ctx_p->push_rings[remote_task_ids[i]] =
+          &itti_desc.rings[remote_task_ids[i]];
+    }
+
+    if (msg_handler) {
+      task_zmq_ctx_p->msg_handler = msg_handler;
+      zmq_pollitem_t item = {0, itti_desc.rings[task_id].event_fd, ZMQ_POLLIN,
+                             0};
+      int rc = zloop_poller(task_zmq_ctx_p->event_loop, &item,
+                            itti_ring_handler, task_zmq_ctx_p);
+      assert(rc == 0);
+    }
+
+    task_zmq_ctx_p->ready = true;
+    return;
+  }
+
   for (int i = 0; i < remote_tasks_count; i++) {
     task_zmq_ctx_p->push_socks[remote_task_ids[i]] =
         zsock_new_push(itti_desc.tasks_info[remote_task_ids[i]].uri);
@@ -215,8 +826,15 @@ void init_task_context(task_id_t task_id, const task_id_t* remote_task_ids,
     AssertFatal(task_zmq_ctx_p->pull_sock, "task id: %d uri: %s", task_id,
                 itti_desc.tasks_info[task_id].uri);
 
-    int rc = zloop_reader(task_zmq_ctx_p->event_loop, task_zmq_ctx_p->pull_sock,
-                          msg_handler, NULL);
+    int rc;
+    if (task_zmq_ctx_p->msg_batch_end_handler) {
+      task_zmq_ctx_p->msg_handler = msg_handler;
+      rc = zloop_reader(task_zmq_ctx_p->event_loop, task_zmq_ctx_p->pull_sock,
+                        itti_zmq_batch_handler, task_zmq_ctx_p);
+    } else {
+      rc = zloop_reader(task_zmq_ctx_p->event_loop, task_zmq_ctx_p->pull_sock,
+                        msg_handler, NULL);
+    }
     assert(rc == 0);
   }
 
@@ -226,11 +844,15 @@ void init_task_context(task_id_t task_id, const task_id_t* remote_task_ids,
 void destroy_task_context(task_zmq_ctx_t* task_zmq_ctx_p) {
   task_zmq_ctx_p->ready = false;
   zloop_destroy(&task_zmq_ctx_p->event_loop);
+  timer_wheel_destroy(task_zmq_ctx_p->timer_wheel);
+  task_zmq_ctx_p->timer_wheel = NULL;
+  task_zmq_ctx_p->timer_wheel_ticking = false;
   zsock_destroy(&task_zmq_ctx_p->pull_sock);
   for (int i = 0; i < TASK_MAX; i++) {
     if (task_zmq_ctx_p->push_socks[i]) {
       zsock_destroy(&task_zmq_ctx_p->push_socks[i]);
     }
+    task_zmq_ctx_p->push_rings[i] = NULL;
   }
 }
 
@@ -283,8 +905,7 @@ static MessageDef* itti_alloc_new_message_sized(task_id_t origin_task_id,
         itti_get_current_task_id();  // Try to identify real origin task ID
   }
 
-  new_msg = (MessageDef*)malloc(sizeof(MessageHeader) + size);
-  AssertFatal(new_msg != NULL, "Message memory allocation failed!\n");
+  new_msg = itti_msg_alloc(message_id, size);
 
   // better to do it here than in client code
   memset(&new_msg->ittiMsg, 0, size);
@@ -372,11 +993,13 @@ int itti_init(task_id_t task_max, thread_id_t thread_max,
               MessagesIds messages_id_max, const task_info_t* tasks_info,
               const message_info_t* messages_info,
               const char* const messages_definition_xml,
-              const char* const dump_file_name) {
+              const char* const dump_file_name, itti_transport_t transport) {
   thread_id_t thread_id;
 
-  ITTI_DEBUG(ITTI_DEBUG_INIT, " Init: %d tasks, %d threads, %d messages\n",
-             task_max, thread_max, messages_id_max);
+  ITTI_DEBUG(ITTI_DEBUG_INIT,
+             " Init: %d tasks, %d threads, %d messages, %s transport\n",
+             task_max, thread_max, messages_id_max,
+             transport == ITTI_TRANSPORT_RING ? "ring" : "zmq");
   CHECK_INIT_RETURN(signal_mask());
 
   // This assert make sure \ref ittiMsg directly following \ref ittiMsgHeader.
@@ -390,6 +1013,12 @@ int itti_init(task_id_t task_max, thread_id_t thread_max,
   itti_desc.thread_handling_signals = false;
   itti_desc.tasks_info = tasks_info;
   itti_desc.messages_info = messages_info;
+  itti_desc.transport = transport;
+  itti_init_msg_classes();
+
+  if (transport == ITTI_TRANSPORT_RING) {
+    itti_init_rings();
+  }
 
   // Allocates memory for threads info
   itti_desc.threads = calloc(itti_desc.thread_max, sizeof(thread_desc_t));
@@ -477,10 +1106,14 @@ void itti_wait_tasks_end(task_zmq_ctx_t* task_ctx) {
                " Some threads are still running, force exit\n");
     return;
   }
+
+  // Rings may only go once no task is left to send or receive
+  itti_free_rings();
 }
 
 void itti_free_desc_threads() {
   free_wrapper((void**)&itti_desc.threads);
+  itti_free_rings();
   return;
 }
 
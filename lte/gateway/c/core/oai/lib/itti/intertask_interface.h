@@ -67,13 +67,35 @@
 typedef unsigned long message_number_t;
 #define MESSAGE_NUMBER_SIZE (sizeof(unsigned long))
 
+/* Transport used between the tasks of the process, set by itti_init */
+typedef enum itti_transport_e {
+  /* Messages are copied into ZMQ frames over ipc:// PUSH/PULL sockets */
+  ITTI_TRANSPORT_ZMQ = 0,
+  /* Message pointers are passed through an in-process lock-free ring per
+     destination task, the task zloop is woken up through an eventfd */
+  ITTI_TRANSPORT_RING,
+} itti_transport_t;
+
+struct itti_ring_s;
+
 typedef struct task_zmq_ctx_s {
   task_id_t task_id;
   zloop_t* event_loop;
   zsock_t* pull_sock;
   zsock_t* push_socks[TASK_MAX];
+  /* Used instead of the sockets with ITTI_TRANSPORT_RING */
+  struct itti_ring_s* push_rings[TASK_MAX];
+  zloop_reader_fn* msg_handler;
+  /* Optional, set before init_task_context. Called once the messages read
+   * together have been handled: a batch of the task ring, or each message
+   * with the ZMQ transport. Lets a task defer work across messages. */
+  void (*msg_batch_end_handler)(struct task_zmq_ctx_s* task_zmq_ctx_p);
   pthread_mutex_t send_mutex;
   bool ready;
+  /* Per UE timers, expired from a single zloop timer while timers are armed */
+  struct timer_wheel_s* timer_wheel;
+  int timer_wheel_tick_id;
+  bool timer_wheel_ticking;
 } task_zmq_ctx_t;
 
 typedef struct message_info_s {
@@ -108,7 +130,8 @@ status_code_e send_msg_to_task(task_zmq_ctx_t* task_zmq_ctx_p,
                                MessageDef* message);
 
 /** \brief Receive a message from zsock
- \param reader Pointer to ZMQ socket
+ \param reader Pointer to ZMQ socket, NULL when the message handler is called
+ by the ITTI_TRANSPORT_RING transport
  @returns Pointer to the message read (caller to free)
  **/
 MessageDef* receive_msg(zsock_t* reader);
@@ -130,6 +153,24 @@ int start_timer(task_zmq_ctx_t* task_zmq_ctx_p, size_t msec,
  **/
 void stop_timer(task_zmq_ctx_t* task_zmq_ctx_p, int timer_id);
 
+/** \brief Start timer on the timing wheel of the task, for the timers armed in
+ large numbers, like the per UE timers. Expiry is rounded up to the wheel tick.
+ \param task_zmq_ctx_p Pointer to task ZMQ context
+ \param msec Timer duration in millisecond
+ \param repeat Timer type
+ \param handler Callback function on timer expiry
+ \param arg Data to pass to handler
+ @returns -1 on failure, timer ID otherwise
+ **/
+int start_wheel_timer(task_zmq_ctx_t* task_zmq_ctx_p, size_t msec,
+                      timer_repeat_t repeat, zloop_timer_fn handler, void* arg);
+
+/** \brief Stop timer started with start_wheel_timer
+ \param task_zmq_ctx_p Pointer to task ZMQ context
+ \param timer_id Timer ID
+ **/
+void stop_wheel_timer(task_zmq_ctx_t* task_zmq_ctx_p, int timer_id);
+
 /** \brief Initialize task ZMQ context
  \param task_id Task ID
  \param remote_task_ids Array of destination task IDs
@@ -199,6 +240,19 @@ MessageDef* itti_alloc_new_message(task_id_t origin_task_id,
 MessageDef* DEPRECATEDitti_alloc_new_message_fatal(task_id_t origin_task_id,
                                                    MessagesIds message_id);
 
+/** \brief Release a message allocated by itti_alloc_new_message or returned
+ by receive_msg, once its content is freed by itti_free_msg_content. The
+ message is kept in the pool of the calling thread for the next allocation of
+ the same size.
+ \param message Pointer to the message, may be NULL
+ **/
+void itti_free_msg(MessageDef* message);
+
+/** \brief Get the number of message allocations served from the pools (hits)
+ and from malloc (misses) since the start of the process
+ **/
+void itti_get_msg_pool_stats(uint64_t* hits, uint64_t* misses);
+
 /**
  * \brief Returns IMSI of ITTI task
  * @param msg MessageDef struct
@@ -76,12 +76,13 @@ const message_info_t messages_info[] = {
  * this include file
  * \param messages_info Pointer on messages information as created by this
  * include file
+ * \param transport Transport of the messages between the tasks
  **/
 int itti_init(task_id_t task_max, thread_id_t thread_max,
               MessagesIds messages_id_max, const task_info_t* tasks_info,
               const message_info_t* messages_info,
               const char* const messages_definition_xml,
-              const char* const dump_file_name);
+              const char* const dump_file_name, itti_transport_t transport);
 
 #endif /* INTERTASK_INTERFACE_INIT_H_ */
 /* @} */
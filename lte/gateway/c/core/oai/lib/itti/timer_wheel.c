@@ -0,0 +1,335 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "lte/gateway/c/core/oai/lib/itti/timer_wheel.h"
+
+#include <stdlib.h>
+
+#include "lte/gateway/c/core/common/dynamic_memory_check.h"
+
+// Each level has TIMER_WHEEL_SLOTS slots, a slot of level L spans
+// TIMER_WHEEL_SLOTS^L ticks. The timers of the next slot of a level are moved
+// down to the lower levels when the lower level wraps, so that only the slot
+// of level 0 of the current tick is ever expired. 5 levels of 64 slots cover
+// 2^30 ticks, above 120 days with 10 ms ticks, longer timers are clamped.
+#define TIMER_WHEEL_BITS 6
+#define TIMER_WHEEL_SLOTS (1 << TIMER_WHEEL_BITS)
+#define TIMER_WHEEL_MASK (TIMER_WHEEL_SLOTS - 1)
+#define TIMER_WHEEL_LEVELS 5
+#define TIMER_WHEEL_MAX_TICKS (1ULL << (TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS))
+
+// Timers are allocated in chunks which are never moved or freed before the
+// wheel. A timer ID is the index of its node, tagged with a generation number
+// so that a stale ID does not stop the timer reusing the node.
+#define TIMER_WHEEL_CHUNK_BITS 12
+#define TIMER_WHEEL_CHUNK_SIZE (1 << TIMER_WHEEL_CHUNK_BITS)
+#define TIMER_WHEEL_INDEX_BITS 22
+#define TIMER_WHEEL_INDEX_MASK ((1 << TIMER_WHEEL_INDEX_BITS) - 1)
+#define TIMER_WHEEL_MAX_GENERATION ((1 << (31 - TIMER_WHEEL_INDEX_BITS)) - 1)
+
+typedef struct timer_wheel_link_s {
+  struct timer_wheel_link_s* next;
+  struct timer_wheel_link_s* prev;
+} timer_wheel_link_t;
+
+typedef struct timer_wheel_node_s {
+  // Must be the first member, lists link the nodes through it
+  timer_wheel_link_t link;
+  uint64_t expires;
+  // Ticks between the expiries of a repeated timer, 0 if not repeated
+  uint64_t interval;
+  zloop_timer_fn* handler;
+  void* arg;
+  // Generation and index of the node, only the index while the node is free
+  int timer_id;
+  uint16_t generation;
+} timer_wheel_node_t;
+
+struct timer_wheel_s {
+  timer_wheel_link_t slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+  // Next tick to expire, ticks are counted from start_msec
+  uint64_t next_tick;
+  uint64_t start_msec;
+  size_t tick_msec;
+  size_t num_timers;
+  timer_wheel_node_t** chunks;
+  uint32_t num_chunks;
+  uint32_t num_nodes;
+  timer_wheel_node_t* free_nodes;
+};
+
+static void timer_wheel_list_init(timer_wheel_link_t* list) {
+  list->next = list;
+  list->prev = list;
+}
+
+static void timer_wheel_list_add(timer_wheel_link_t* list,
+                                 timer_wheel_link_t* link) {
+  link->next = list;
+  link->prev = list->prev;
+  list->prev->next = link;
+  list->prev = link;
+}
+
+static void timer_wheel_list_del(timer_wheel_link_t* link) {
+  link->prev->next = link->next;
+  link->next->prev = link->prev;
+}
+
+// Moves all the links of list to the empty list to
+static void timer_wheel_list_move(timer_wheel_link_t* list,
+                                  timer_wheel_link_t* to) {
+  if (list->next == list) {
+    timer_wheel_list_init(to);
+    return;
+  }
+  to->next = list->next;
+  to->prev = list->prev;
+  to->next->prev = to;
+  to->prev->next = to;
+  timer_wheel_list_init(list);
+}
+
+static uint64_t timer_wheel_ticks(const timer_wheel_t* wheel, uint64_t msec) {
+  return (msec + wheel->tick_msec - 1) / wheel->tick_msec;
+}
+
+static timer_wheel_node_t* timer_wheel_node(const timer_wheel_t* wheel,
+                                            uint32_t index) {
+  return &wheel->chunks[index >> TIMER_WHEEL_CHUNK_BITS]
+                       [index & (TIMER_WHEEL_CHUNK_SIZE - 1)];
+}
+
+static timer_wheel_node_t* timer_wheel_alloc_node(timer_wheel_t* wheel) {
+  timer_wheel_node_t* node = wheel->free_nodes;
+  uint32_t index;
+
+  if (node) {
+    wheel->free_nodes = (timer_wheel_node_t*)node->link.next;
+    index = node->timer_id;
+  } else {
+    if (wheel->num_nodes > TIMER_WHEEL_INDEX_MASK) {
+      return NULL;
+    }
+    index = wheel->num_nodes;
+    if ((index >> TIMER_WHEEL_CHUNK_BITS) == wheel->num_chunks) {
+      timer_wheel_node_t** chunks =
+          realloc(wheel->chunks,
+                  (wheel->num_chunks + 1) * sizeof(timer_wheel_node_t*));
+      if (!chunks) {
+        return NULL;
+      }
+      wheel->chunks = chunks;
+      wheel->chunks[wheel->num_chunks] =
+          calloc(TIMER_WHEEL_CHUNK_SIZE, sizeof(timer_wheel_node_t));
+      if (!wheel->chunks[wheel->num_chunks]) {
+        return NULL;
+      }
+      wheel->num_chunks++;
+    }
+    wheel->num_nodes++;
+    node = timer_wheel_node(wheel, index);
+  }
+  node->generation = node->generation % TIMER_WHEEL_MAX_GENERATION + 1;
+  node->timer_id = (node->generation << TIMER_WHEEL_INDEX_BITS) | index;
+  return node;
+}
+
+// The free list is linked through link.next, the index of a free node is kept
+// in timer_id until it is reused
+static void timer_wheel_free_node(timer_wheel_t* wheel,
+                                  timer_wheel_node_t* node) {
+  node->timer_id &= TIMER_WHEEL_INDEX_MASK;
+  node->link.next = (timer_wheel_link_t*)wheel->free_nodes;
+  wheel->free_nodes = node;
+}
+
+static bool timer_wheel_node_is_free(const timer_wheel_node_t* node) {
+  return (node->timer_id >> TIMER_WHEEL_INDEX_BITS) == 0;
+}
+
+// Links the node to the slot of the level matching its distance to the next
+// tick
+static void timer_wheel_link(timer_wheel_t* wheel, timer_wheel_node_t* node) {
+  uint64_t delta;
+  int level = 0;
+
+  if (node->expires < wheel->next_tick) {
+    node->expires = wheel->next_tick;
+  }
+  delta = node->expires - wheel->next_tick;
+  if (delta >= TIMER_WHEEL_MAX_TICKS) {
+    delta = TIMER_WHEEL_MAX_TICKS - 1;
+    node->expires = wheel->next_tick + delta;
+  }
+  while (delta >> (TIMER_WHEEL_BITS * (level + 1))) {
+    level++;
+  }
+  timer_wheel_list_add(
+      &wheel->slots[level]
+                   [(node->expires >> (TIMER_WHEEL_BITS * level)) &
+                    TIMER_WHEEL_MASK],
+      &node->link);
+}
+
+// Moves the timers of a slot down to the lower levels
+static void timer_wheel_cascade(timer_wheel_t* wheel, int level, int index) {
+  timer_wheel_link_t list;
+
+  timer_wheel_list_move(&wheel->slots[level][index], &list);
+  while (list.next != &list) {
+    timer_wheel_node_t* node = (timer_wheel_node_t*)list.next;
+    timer_wheel_list_del(&node->link);
+    timer_wheel_link(wheel, node);
+  }
+}
+
+static int timer_wheel_run_tick(timer_wheel_t* wheel, zloop_t* loop) {
+  uint64_t tick = wheel->next_tick;
+  int index = tick & TIMER_WHEEL_MASK;
+  timer_wheel_link_t expired;
+  int rc = 0;
+
+  // The higher level slots are cascaded when the level below wraps
+  for (int level = 1; !index && level < TIMER_WHEEL_LEVELS; level++) {
+    index = (tick >> (TIMER_WHEEL_BITS * level)) & TIMER_WHEEL_MASK;
+    timer_wheel_cascade(wheel, level, index);
+  }
+
+  // Timers added by the handlers expire on the next ticks at the earliest
+  wheel->next_tick++;
+  timer_wheel_list_move(&wheel->slots[0][tick & TIMER_WHEEL_MASK], &expired);
+  while (expired.next != &expired) {
+    timer_wheel_node_t* node = (timer_wheel_node_t*)expired.next;
+    int timer_id = node->timer_id;
+    zloop_timer_fn* handler = node->handler;
+    void* arg = node->arg;
+
+    timer_wheel_list_del(&node->link);
+    if (node->interval) {
+      node->expires = tick + node->interval;
+      timer_wheel_link(wheel, node);
+    } else {
+      timer_wheel_free_node(wheel, node);
+      wheel->num_timers--;
+    }
+    if (handler(loop, timer_id, arg) == -1) {
+      rc = -1;
+    }
+  }
+  return rc;
+}
+
+//------------------------------------------------------------------------------
+timer_wheel_t* timer_wheel_create(size_t tick_msec, uint64_t now_msec) {
+  timer_wheel_t* wheel = calloc(1, sizeof(timer_wheel_t));
+
+  if (!wheel) {
+    return NULL;
+  }
+  for (int level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+    for (int index = 0; index < TIMER_WHEEL_SLOTS; index++) {
+      timer_wheel_list_init(&wheel->slots[level][index]);
+    }
+  }
+  wheel->tick_msec = tick_msec ? tick_msec : 1;
+  wheel->start_msec = now_msec;
+  return wheel;
+}
+
+//------------------------------------------------------------------------------
+void timer_wheel_destroy(timer_wheel_t* wheel) {
+  if (!wheel) {
+    return;
+  }
+  for (uint32_t i = 0; i < wheel->num_chunks; i++) {
+    free_wrapper((void**)&wheel->chunks[i]);
+  }
+  free_wrapper((void**)&wheel->chunks);
+  free_wrapper((void**)&wheel);
+}
+
+//------------------------------------------------------------------------------
+int timer_wheel_add(timer_wheel_t* wheel, uint64_t now_msec, size_t msec,
+                    bool repeat, zloop_timer_fn handler, void* arg) {
+  uint64_t elapsed_msec =
+      now_msec > wheel->start_msec ? now_msec - wheel->start_msec : 0;
+  timer_wheel_node_t* node = timer_wheel_alloc_node(wheel);
+
+  if (!node) {
+    return -1;
+  }
+  // Skips the ticks elapsed while no timer was armed, instead of running them
+  // on the next expiry
+  if (!wheel->num_timers &&
+      wheel->next_tick < elapsed_msec / wheel->tick_msec) {
+    wheel->next_tick = elapsed_msec / wheel->tick_msec;
+  }
+  node->expires = timer_wheel_ticks(wheel, elapsed_msec + msec);
+  node->interval = 0;
+  if (repeat) {
+    node->interval = timer_wheel_ticks(wheel, msec);
+    if (!node->interval) {
+      node->interval = 1;
+    }
+  }
+  node->handler = handler;
+  node->arg = arg;
+  timer_wheel_link(wheel, node);
+  wheel->num_timers++;
+  return node->timer_id;
+}
+
+//------------------------------------------------------------------------------
+bool timer_wheel_del(timer_wheel_t* wheel, int timer_id) {
+  uint32_t index = timer_id & TIMER_WHEEL_INDEX_MASK;
+  timer_wheel_node_t* node;
+
+  if (timer_id < 0 || index >= wheel->num_nodes) {
+    return false;
+  }
+  node = timer_wheel_node(wheel, index);
+  if (timer_wheel_node_is_free(node) || node->timer_id != timer_id) {
+    return false;
+  }
+  timer_wheel_list_del(&node->link);
+  timer_wheel_free_node(wheel, node);
+  wheel->num_timers--;
+  return true;
+}
+
+//------------------------------------------------------------------------------
+int timer_wheel_expire(timer_wheel_t* wheel, zloop_t* loop, uint64_t now_msec) {
+  uint64_t now_tick;
+  int rc = 0;
+
+  if (now_msec < wheel->start_msec) {
+    return 0;
+  }
+  now_tick = (now_msec - wheel->start_msec) / wheel->tick_msec;
+  while (wheel->next_tick <= now_tick) {
+    if (!wheel->num_timers) {
+      wheel->next_tick = now_tick + 1;
+      break;
+    }
+    if (timer_wheel_run_tick(wheel, loop) == -1) {
+      rc = -1;
+    }
+  }
+  return rc;
+}
+
+//------------------------------------------------------------------------------
+size_t timer_wheel_size(const timer_wheel_t* wheel) {
+  return wheel->num_timers;
+}
@@ -0,0 +1,70 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <czmq.h>
+
+// Hierarchical timing wheel holding the per UE timers of a task. Starting and
+// stopping a timer is O(1) whatever the number of armed timers, and the timers
+// are expired by advancing the wheel from a single zloop timer, instead of
+// zloop scanning every armed timer on each loop iteration.
+// Timers expire on tick boundaries, never before their duration has elapsed.
+// The wheel is not thread safe, it is owned by the task running its loop.
+
+#define TIMER_WHEEL_TICK_MSEC 10
+
+typedef struct timer_wheel_s timer_wheel_t;
+
+/**
+ * Creates an empty wheel
+ * \param tick_msec Resolution of the timers in milliseconds
+ * \param now_msec Current monotonic time in milliseconds
+ */
+timer_wheel_t* timer_wheel_create(size_t tick_msec, uint64_t now_msec);
+
+/**
+ * Frees the wheel and its timers, without calling their handlers
+ */
+void timer_wheel_destroy(timer_wheel_t* wheel);
+
+/**
+ * Arms a timer expiring msec milliseconds after now_msec
+ * \param repeat Re-arms the timer with the same duration each time it expires
+ * \param handler Called with the timer ID and arg on expiry
+ * @returns -1 on failure, timer ID otherwise
+ */
+int timer_wheel_add(timer_wheel_t* wheel, uint64_t now_msec, size_t msec,
+                    bool repeat, zloop_timer_fn handler, void* arg);
+
+/**
+ * Disarms a timer, IDs of expired or already stopped timers are ignored
+ * @returns true if the timer was armed
+ */
+bool timer_wheel_del(timer_wheel_t* wheel, int timer_id);
+
+/**
+ * Calls the handlers of all the timers expired at now_msec. Handlers may add
+ * and delete timers, including the other expired timers not called yet.
+ * \param loop Event loop passed to the handlers
+ * @returns -1 if a handler returned -1, to stop the loop, 0 otherwise
+ */
+int timer_wheel_expire(timer_wheel_t* wheel, zloop_t* loop, uint64_t now_msec);
+
+/**
+ * @returns the number of armed timers
+ */
+size_t timer_wheel_size(const timer_wheel_t* wheel);
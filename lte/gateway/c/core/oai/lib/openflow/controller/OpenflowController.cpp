@@ -34,6 +34,22 @@ std::mutex cv_mutex;
 
 namespace openflow {
 
+// Dispatch scheduled on the event loop of a switch connection
+struct ScheduledDispatch {
+  OpenflowController* controller;
+  uint64_t generation;
+};
+
+/**
+ * This callback is called from the event loop to handle the external events
+ * injected since it was scheduled
+ */
+static void* external_events_callback(std::shared_ptr<void> data) {
+  auto dispatch = std::static_pointer_cast<ScheduledDispatch>(data);
+  dispatch->controller->dispatch_external_events(dispatch->generation);
+  return NULL;
+}
+
 OpenflowController::OpenflowController(
     const char* address, const int port, const int n_workers, bool secure,
     std::shared_ptr<OpenflowMessenger> messenger)
@@ -44,7 +60,9 @@ OpenflowController::OpenflowController(
                    .keep_data_ownership(false)),
       running_(true),
       latest_ofconn_(nullptr),
-      messenger_(messenger) {}
+      messenger_(messenger),
+      dispatch_scheduled_(false),
+      dispatch_generation_(0) {}
 
 OpenflowController::OpenflowController(const char* address, const int port,
                                        const int n_workers, bool secure)
@@ -92,6 +110,14 @@ void OpenflowController::connection_callback(OFConnection* ofconn,
                                              OFConnection::Event type) {
   if (type == OFConnection::EVENT_CLOSED || type == OFConnection::EVENT_DEAD) {
     OAILOG_ERROR(LOG_GTPV1U, "Openflow controller lost connection to switch\n");
+    {
+      // The events queued for the lost connection are dropped with it, and
+      // a dispatch it still runs must not handle the next connection's
+      std::lock_guard<std::mutex> lock(pending_events_mutex_);
+      pending_events_.clear();
+      dispatch_scheduled_ = false;
+      dispatch_generation_++;
+    }
     dispatch_event(SwitchDownEvent(ofconn));
   }
 }
@@ -118,7 +144,53 @@ void OpenflowController::inject_external_event(
     }
   }
   ev->set_of_connection(latest_ofconn_);
-  latest_ofconn_->add_immediate_event(cb, ev);
+  uint64_t generation;
+  if (queue_external_event(ev, cb, &generation)) {
+    // The controller outlives the connection, the dispatch does not own it
+    auto dispatch = std::make_shared<ScheduledDispatch>();
+    dispatch->controller = this;
+    dispatch->generation = generation;
+    latest_ofconn_->add_immediate_event(external_events_callback, dispatch);
+  }
+}
+
+bool OpenflowController::queue_external_event(
+    std::shared_ptr<ExternalEvent> ev, void* (*cb)(std::shared_ptr<void>),
+    uint64_t* generation) {
+  std::lock_guard<std::mutex> lock(pending_events_mutex_);
+  pending_events_.push_back({ev, cb});
+  if (dispatch_scheduled_) {
+    return false;
+  }
+  dispatch_scheduled_ = true;
+  *generation = dispatch_generation_;
+  return true;
+}
+
+void OpenflowController::dispatch_external_events(uint64_t generation) {
+  std::vector<PendingExternalEvent> events;
+  {
+    std::lock_guard<std::mutex> lock(pending_events_mutex_);
+    if (generation != dispatch_generation_) {
+      // Scheduled for a lost connection, the events were dropped with it
+      return;
+    }
+    // Events injected from now on are handled by the next dispatch
+    events.swap(pending_events_);
+    dispatch_scheduled_ = false;
+  }
+  if (events.empty()) {
+    return;
+  }
+  OAILOG_DEBUG(LOG_GTPV1U, "Openflow controller handling %zu external events\n",
+               events.size());
+  // The events are all injected for the connection the dispatch runs on
+  auto* ofconn = events.front().ev->get_connection();
+  messenger_->begin_batch(ofconn);
+  for (auto& pending : events) {
+    pending.cb(pending.ev);
+  }
+  messenger_->flush_batch(ofconn);
 }
 
 status_code_e OpenflowController::is_controller_connected_to_switch(
@@ -20,6 +20,8 @@
 #include <unordered_map>
 #include <list>
 #include <memory>
+#include <mutex>
+#include <vector>
 
 #include <fluid/OFServer.hh>
 
@@ -109,7 +111,9 @@ class OpenflowController : public fluid_base::OFServer {
   /**
    * This function can be called by another thread to inject an external event
    * into the main event loop. This can be used for non-standard openflow events
-   * like adding a gtp tunnel flow
+   * like adding a gtp tunnel flow. The events injected until the event loop
+   * gets to them are handled together, and their flows written to the switch
+   * in one batch.
    * @param ev - shared_ptr to ExternalEvent subclass that is to be handled by
    *             the event loop. This needs to be a pointer because it will be
    *             handled indirectly by another thread.
@@ -126,11 +130,42 @@ class OpenflowController : public fluid_base::OFServer {
    */
   fluid_base::OFConnection* get_latest_of_connection();
 
+  /**
+   * Calls the callbacks of the external events injected since the last call,
+   * in order, batching the messages they send. Called by the event loop.
+   * @param generation - the generation returned by queue_external_event, the
+   *                     dispatch does nothing if the connection was lost since
+   */
+  void dispatch_external_events(uint64_t generation);
+
+ protected:
+  /**
+   * Queues an external event to be handled by dispatch_external_events
+   * @param generation - set to the generation to dispatch with, if the caller
+   *                     has to schedule the dispatch
+   * @return true if the caller has to schedule dispatch_external_events
+   */
+  bool queue_external_event(std::shared_ptr<ExternalEvent> ev,
+                            void* (*cb)(std::shared_ptr<void>),
+                            uint64_t* generation);
+
  private:
+  struct PendingExternalEvent {
+    std::shared_ptr<ExternalEvent> ev;
+    void* (*cb)(std::shared_ptr<void>);
+  };
+
   std::shared_ptr<OpenflowMessenger> messenger_;
   std::unordered_map<uint32_t, std::vector<Application*>> event_listeners;
   bool running_;
   fluid_base::OFConnection* latest_ofconn_;
+  std::mutex pending_events_mutex_;
+  // Protected by pending_events_mutex_
+  std::vector<PendingExternalEvent> pending_events_;
+  bool dispatch_scheduled_;
+  // Incremented when the connection is lost, protected by
+  // pending_events_mutex_
+  uint64_t dispatch_generation_;
 };
 
 }  // namespace openflow
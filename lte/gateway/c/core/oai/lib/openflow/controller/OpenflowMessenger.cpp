@@ -19,6 +19,8 @@
 
 namespace openflow {
 
+DefaultMessenger::DefaultMessenger() {}
+
 fluid_msg::of13::FlowMod DefaultMessenger::create_default_flow_mod(
     uint8_t table_id, fluid_msg::of13::ofp_flow_mod_command command,
     uint16_t priority) const {
@@ -43,9 +45,47 @@ void DefaultMessenger::send_of_msg(fluid_msg::OFMsg& of_msg,
                                    fluid_base::OFConnection* ofconn) const {
   uint8_t* buffer;
   buffer = of_msg.pack();
+  {
+    std::lock_guard<std::mutex> lock(batches_mutex_);
+    auto it = batches_.find(ofconn);
+    if (it != batches_.end()) {
+      auto& batch = it->second;
+      if (batch.size() + of_msg.length() > OF_MSG_BATCH_MAX_BYTES) {
+        write_batch(ofconn, &batch);
+      }
+      batch.insert(batch.end(), buffer, buffer + of_msg.length());
+      fluid_msg::OFMsg::free_buffer(buffer);
+      return;
+    }
+  }
   ofconn->send(buffer, of_msg.length());
   // TODO OF_ERROR_HANDLING - check if OF message successfully installed
   fluid_msg::OFMsg::free_buffer(buffer);
 }
 
+void DefaultMessenger::begin_batch(fluid_base::OFConnection* ofconn) const {
+  std::lock_guard<std::mutex> lock(batches_mutex_);
+  batches_[ofconn].reserve(OF_MSG_BATCH_MAX_BYTES);
+}
+
+void DefaultMessenger::flush_batch(fluid_base::OFConnection* ofconn) const {
+  std::lock_guard<std::mutex> lock(batches_mutex_);
+  auto it = batches_.find(ofconn);
+  if (it == batches_.end()) {
+    return;
+  }
+  write_batch(ofconn, &it->second);
+  batches_.erase(it);
+}
+
+void DefaultMessenger::write_batch(fluid_base::OFConnection* ofconn,
+                                   std::vector<uint8_t>* batch) const {
+  if (!batch->empty()) {
+    // The messages are framed by their OpenFlow header, the switch splits
+    // them as if they had been written one by one
+    ofconn->send(batch->data(), batch->size());
+    batch->clear();
+  }
+}
+
 }  // namespace openflow
@@ -17,10 +17,19 @@
 
 #pragma once
 
+#include <stdint.h>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
 #include <fluid/of13msg.hh>
 #include <fluid/OFServer.hh>
 
 namespace openflow {
+
+// Buffered messages are written once they reach this size
+#define OF_MSG_BATCH_MAX_BYTES 65536
+
 /**
  * Abstract helper class with libfluid message utilities
  */
@@ -47,6 +56,23 @@ class OpenflowMessenger {
    */
   virtual void send_of_msg(fluid_msg::OFMsg& of_msg,
                            fluid_base::OFConnection* ofconn) const {}
+
+  /**
+   * Buffers the messages sent to ofconn from now on, until flush_batch is
+   * called, so that they are written to OVS together instead of one write
+   * per message
+   *
+   * @param ofconn - the connection to buffer the messages of
+   */
+  virtual void begin_batch(fluid_base::OFConnection* ofconn) const {}
+
+  /**
+   * Writes the messages buffered for ofconn since begin_batch and stops
+   * buffering them
+   *
+   * @param ofconn - the connection to write the buffered messages to
+   */
+  virtual void flush_batch(fluid_base::OFConnection* ofconn) const {}
 };
 
 /**
@@ -54,12 +80,29 @@ class OpenflowMessenger {
  */
 class DefaultMessenger : public OpenflowMessenger {
  public:
+  DefaultMessenger();
+
   fluid_msg::of13::FlowMod create_default_flow_mod(
       uint8_t table_id, fluid_msg::of13::ofp_flow_mod_command command,
       uint16_t priority) const;
 
   void send_of_msg(fluid_msg::OFMsg& of_msg,
                    fluid_base::OFConnection* ofconn) const;
+
+  void begin_batch(fluid_base::OFConnection* ofconn) const;
+
+  void flush_batch(fluid_base::OFConnection* ofconn) const;
+
+ private:
+  // Messages are sent from the event loop threads of the connections and
+  // from the threads injecting events
+  mutable std::mutex batches_mutex_;
+  // Messages buffered per connection, protected by batches_mutex_
+  mutable std::unordered_map<fluid_base::OFConnection*, std::vector<uint8_t>>
+      batches_;
+
+  void write_batch(fluid_base::OFConnection* ofconn,
+                   std::vector<uint8_t>* batch) const;
 };
 
 }  // namespace openflow
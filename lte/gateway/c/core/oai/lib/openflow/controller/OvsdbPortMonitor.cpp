@@ -0,0 +1,298 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "lte/gateway/c/core/oai/lib/openflow/controller/OvsdbPortMonitor.hpp"
+
+#include <errno.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <chrono>
+#include <memory>
+
+extern "C" {
+#include "lte/gateway/c/core/oai/common/log.h"
+}
+
+#define OVSDB_MONITOR_ID 0
+#define OVSDB_RECONNECT_INTERVAL_MSEC 1000
+
+namespace openflow {
+
+/**
+ * Returns the length of the first complete JSON object of the stream, or 0
+ * if it is incomplete. OVSDB messages are not delimited.
+ */
+static size_t json_message_length(const std::string& buffer) {
+  int depth = 0;
+  bool in_string = false;
+  bool escaped = false;
+  for (size_t i = 0; i < buffer.size(); i++) {
+    char c = buffer[i];
+    if (in_string) {
+      if (escaped) {
+        escaped = false;
+      } else if (c == '\\') {
+        escaped = true;
+      } else if (c == '"') {
+        in_string = false;
+      }
+    } else if (c == '"') {
+      in_string = true;
+    } else if (c == '{' || c == '[') {
+      depth++;
+    } else if ((c == '}' || c == ']') && --depth == 0) {
+      return i + 1;
+    }
+  }
+  return 0;
+}
+
+static bool send_message(int fd, const nlohmann::json& msg) {
+  std::string data = msg.dump();
+  size_t sent = 0;
+  while (sent < data.size()) {
+    ssize_t rc = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+    if (rc < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    sent += rc;
+  }
+  return true;
+}
+
+OvsdbPortMonitor::OvsdbPortMonitor(const std::string& socket_path)
+    : socket_path_(socket_path), running_(false), fd_(-1) {}
+
+OvsdbPortMonitor::~OvsdbPortMonitor() { stop(); }
+
+void OvsdbPortMonitor::start() {
+  if (running_.exchange(true)) {
+    return;
+  }
+  thread_ = std::thread(&OvsdbPortMonitor::run, this);
+}
+
+void OvsdbPortMonitor::stop() {
+  if (!running_.exchange(false)) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (fd_ != -1) {
+      // Wakes up the monitor thread blocked on the connection
+      shutdown(fd_, SHUT_RDWR);
+    }
+  }
+  cond_.notify_all();
+  thread_.join();
+}
+
+uint32_t OvsdbPortMonitor::get_ofport(const std::string& name,
+                                      uint32_t timeout_ms) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  auto found = [this, &name] { return ofports_.count(name) > 0; };
+  if (!found() && timeout_ms > 0) {
+    cond_.wait_for(lock, std::chrono::milliseconds(timeout_ms), found);
+  }
+  auto it = ofports_.find(name);
+  return it == ofports_.end() ? 0 : it->second;
+}
+
+void OvsdbPortMonitor::run() {
+  while (running_) {
+    int fd = connect_monitor();
+    if (fd != -1) {
+      std::string buffer;
+      while (running_ && read_messages(fd, &buffer)) {
+      }
+      std::lock_guard<std::mutex> lock(mutex_);
+      close(fd);
+      fd_ = -1;
+    }
+    if (running_) {
+      OAILOG_WARNING(LOG_GTPV1U, "OVSDB monitor disconnected, retrying\n");
+      std::unique_lock<std::mutex> lock(mutex_);
+      cond_.wait_for(lock,
+                     std::chrono::milliseconds(OVSDB_RECONNECT_INTERVAL_MSEC),
+                     [this] { return !running_; });
+    }
+  }
+}
+
+int OvsdbPortMonitor::connect_monitor() {
+  struct sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  if (socket_path_.size() >= sizeof(addr.sun_path)) {
+    OAILOG_ERROR(LOG_GTPV1U, "OVSDB socket path too long: %s\n",
+                 socket_path_.c_str());
+    return -1;
+  }
+  strncpy(addr.sun_path, socket_path_.c_str(), sizeof(addr.sun_path) - 1);
+
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) {
+    return -1;
+  }
+  if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+    OAILOG_ERROR(LOG_GTPV1U, "Could not connect to OVSDB %s: %s\n",
+                 socket_path_.c_str(), strerror(errno));
+    close(fd);
+    return -1;
+  }
+
+  // The initial rows come in the reply, the changes in update notifications
+  nlohmann::json request = {
+      {"id", OVSDB_MONITOR_ID},
+      {"method", "monitor"},
+      {"params",
+       {"Open_vSwitch", nullptr,
+        {{"Interface", {{"columns", {"name", "ofport"}}}}}}}};
+  if (!send_message(fd, request)) {
+    close(fd);
+    return -1;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!running_) {
+    close(fd);
+    return -1;
+  }
+  fd_ = fd;
+  return fd;
+}
+
+bool OvsdbPortMonitor::read_messages(int fd, std::string* buffer) {
+  char data[4096];
+  ssize_t rc = recv(fd, data, sizeof(data), 0);
+  if (rc < 0 && errno == EINTR) {
+    return true;
+  }
+  if (rc <= 0) {
+    return false;
+  }
+  buffer->append(data, rc);
+
+  size_t len;
+  while ((len = json_message_length(*buffer)) > 0) {
+    auto msg = nlohmann::json::parse(buffer->begin(), buffer->begin() + len,
+                                     nullptr, false);
+    buffer->erase(0, len);
+    if (msg.is_discarded() || !msg.is_object()) {
+      OAILOG_ERROR(LOG_GTPV1U, "Invalid OVSDB message\n");
+      return false;
+    }
+    if (!handle_message(fd, msg)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool OvsdbPortMonitor::handle_message(int fd, const nlohmann::json& msg) {
+  auto id = msg.find("id");
+  auto method = msg.find("method");
+  auto params = msg.find("params");
+  if (method != msg.end()) {
+    if (*method == "echo" && id != msg.end() && params != msg.end()) {
+      nlohmann::json reply = {
+          {"id", *id}, {"result", *params}, {"error", nullptr}};
+      return send_message(fd, reply);
+    }
+    if (*method == "update" && params != msg.end() && params->is_array() &&
+        params->size() == 2) {
+      update_interfaces((*params)[1], false);
+    }
+    return true;
+  }
+
+  if (id != msg.end() && *id == OVSDB_MONITOR_ID) {
+    auto error = msg.find("error");
+    auto result = msg.find("result");
+    if ((error != msg.end() && !error->is_null()) || result == msg.end()) {
+      OAILOG_ERROR(LOG_GTPV1U, "OVSDB monitor failed: %s\n",
+                   msg.dump().c_str());
+      return false;
+    }
+    update_interfaces(*result, true);
+  }
+  return true;
+}
+
+void OvsdbPortMonitor::update_interfaces(const nlohmann::json& table_updates,
+                                         bool initial) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (initial) {
+    // The interfaces may have changed while disconnected
+    ofports_.clear();
+    row_names_.clear();
+  }
+  auto table = table_updates.is_object() ? table_updates.find("Interface")
+                                         : table_updates.end();
+  if (table != table_updates.end() && table->is_object()) {
+    for (const auto& row : table->items()) {
+      auto new_row = row.value().find("new");
+      if (new_row == row.value().end() || !new_row->is_object()) {
+        auto name = row_names_.find(row.key());
+        if (name != row_names_.end()) {
+          ofports_.erase(name->second);
+          row_names_.erase(name);
+        }
+        continue;
+      }
+      // The new row holds all the monitored columns, the ofport of an
+      // interface not added to the bridge yet is an empty set
+      auto name_col = new_row->find("name");
+      auto ofport = new_row->find("ofport");
+      if (name_col == new_row->end() || !name_col->is_string()) {
+        continue;
+      }
+      std::string name = name_col->get<std::string>();
+      row_names_[row.key()] = name;
+      if (ofport != new_row->end() && ofport->is_number_integer() &&
+          ofport->get<int64_t>() > 0) {
+        ofports_[name] = ofport->get<uint32_t>();
+      } else {
+        ofports_.erase(name);
+      }
+    }
+  }
+  cond_.notify_all();
+}
+
+}  // namespace openflow
+
+static std::unique_ptr<openflow::OvsdbPortMonitor> port_monitor;
+
+int ovsdb_port_monitor_start(const char* socket_path) {
+  if (port_monitor) {
+    return 0;
+  }
+  port_monitor.reset(new openflow::OvsdbPortMonitor(socket_path));
+  port_monitor->start();
+  return 0;
+}
+
+void ovsdb_port_monitor_stop(void) { port_monitor.reset(); }
+
+uint32_t ovsdb_port_monitor_get_ofport(const char* port_name,
+                                       uint32_t timeout_ms) {
+  if (!port_monitor) {
+    return 0;
+  }
+  return port_monitor->get_ofport(port_name, timeout_ms);
+}
@@ -0,0 +1,94 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#define OVSDB_SOCKET_PATH "/var/run/openvswitch/db.sock"
+
+#ifdef __cplusplus
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include <nlohmann/json.hpp>
+
+namespace openflow {
+
+/**
+ * Keeps the OpenFlow port numbers of the OVS interfaces, by name, up to date
+ * with a monitor of the Interface table of OVSDB. The monitor runs on its own
+ * thread over the JSON-RPC connection to ovsdb-server, and reconnects if the
+ * connection is lost.
+ */
+class OvsdbPortMonitor {
+ public:
+  explicit OvsdbPortMonitor(const std::string& socket_path);
+  ~OvsdbPortMonitor();
+
+  void start();
+  void stop();
+
+  /**
+   * Returns the port number of the interface, waiting up to timeout_ms for
+   * the interface to be added or to get its port number
+   * @return 0 if the interface has no port number
+   */
+  uint32_t get_ofport(const std::string& name, uint32_t timeout_ms);
+
+ private:
+  std::string socket_path_;
+  std::thread thread_;
+  std::atomic<bool> running_;
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  // Protected by mutex_
+  int fd_;
+  std::unordered_map<std::string, uint32_t> ofports_;
+  // Name of the interface of each row UUID, to handle deleted rows
+  std::unordered_map<std::string, std::string> row_names_;
+
+  void run();
+  int connect_monitor();
+  bool read_messages(int fd, std::string* buffer);
+  bool handle_message(int fd, const nlohmann::json& msg);
+  void update_interfaces(const nlohmann::json& table_updates, bool initial);
+};
+
+}  // namespace openflow
+
+extern "C" {
+#endif
+
+/**
+ * Starts the monitor of the OVS interfaces over the OVSDB unix socket
+ */
+int ovsdb_port_monitor_start(const char* socket_path);
+
+void ovsdb_port_monitor_stop(void);
+
+/**
+ * Returns the port number of the OVS interface, waiting up to timeout_ms for
+ * the interface to be created
+ * @return 0 if the interface has no port number
+ */
+uint32_t ovsdb_port_monitor_get_ofport(const char* port_name,
+                                       uint32_t timeout_ms);
+
+#ifdef __cplusplus
+}
+#endif
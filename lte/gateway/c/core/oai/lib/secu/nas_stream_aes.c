@@ -0,0 +1,56 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <nettle/aes.h>
+
+#include "lte/gateway/c/core/common/assertions.h"
+#include "lte/gateway/c/core/oai/lib/secu/nas_stream_aes.h"
+
+// CMAC subkey generation of RFC 4493 section 2.3: out = in << 1, xored with
+// Rb if the most significant bit of in is set
+static void cmac_subkey(uint8_t out[AES_BLOCK_SIZE],
+                        const uint8_t in[AES_BLOCK_SIZE]) {
+  const uint8_t msb = in[0] & 0x80;
+  for (int i = 0; i < AES_BLOCK_SIZE - 1; i++) {
+    out[i] = (uint8_t)(in[i] << 1) | (in[i + 1] >> 7);
+  }
+  out[AES_BLOCK_SIZE - 1] = (uint8_t)(in[AES_BLOCK_SIZE - 1] << 1);
+  if (msb) {
+    out[AES_BLOCK_SIZE - 1] ^= 0x87;
+  }
+}
+
+void nas_stream_aes_ctx_init(nas_stream_aes_ctx_t* const ctx,
+                             const uint8_t* const key) {
+  uint8_t l[AES_BLOCK_SIZE] = {0};
+
+  DevAssert(ctx != NULL);
+  DevAssert(key != NULL);
+  aes128_set_encrypt_key(&ctx->aes, key);
+  aes128_encrypt(&ctx->aes, AES_BLOCK_SIZE, l, l);
+  cmac_subkey(ctx->cmac_k1, l);
+  cmac_subkey(ctx->cmac_k2, ctx->cmac_k1);
+  memcpy(ctx->key, key, AES128_KEY_SIZE);
+  ctx->scheduled = true;
+}
+
+const nas_stream_aes_ctx_t* nas_stream_aes_ctx_get(
+    nas_stream_aes_ctx_t* const ctx, const uint8_t* const key) {
+  DevAssert(ctx != NULL);
+  if (!ctx->scheduled || memcmp(ctx->key, key, AES128_KEY_SIZE)) {
+    nas_stream_aes_ctx_init(ctx, key);
+  }
+  return ctx;
+}
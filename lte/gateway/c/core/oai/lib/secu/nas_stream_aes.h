@@ -0,0 +1,49 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <nettle/aes.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * AES-128 key schedule of a NAS key for EEA2/EIA2 (NEA2/NIA2 in 5G), with the
+ * CMAC subkeys of EIA2. It is kept in the security context of the UE so that
+ * the key is set up once when it is derived instead of for every NAS message.
+ */
+typedef struct {
+  struct aes128_ctx aes;
+  uint8_t cmac_k1[AES_BLOCK_SIZE];
+  uint8_t cmac_k2[AES_BLOCK_SIZE];
+  /* key the context was set up with */
+  uint8_t key[AES128_KEY_SIZE];
+  bool scheduled;
+} nas_stream_aes_ctx_t;
+
+void nas_stream_aes_ctx_init(nas_stream_aes_ctx_t* const ctx,
+                             const uint8_t* const key);
+
+/*
+ * Returns ctx, set up again first if it was not set up with key, which is the
+ * case of the security contexts restored from the state store.
+ */
+const nas_stream_aes_ctx_t* nas_stream_aes_ctx_get(
+    nas_stream_aes_ctx_t* const ctx, const uint8_t* const key);
+
+#ifdef __cplusplus
+}
+#endif
@@ -26,13 +26,17 @@
 #include "lte/gateway/c/core/oai/lib/secu/secu_defs.h"
 #include "lte/gateway/c/core/oai/lib/secu/snow3g.h"
 
+/* Keystreams of messages up to this size are generated on the stack */
+#define EEA1_STACK_KEY_STREAM_WORDS 512
+
 int nas_stream_encrypt_eea1(nas_stream_cipher_t* const stream_cipher,
                             uint8_t* const out) {
   snow_3g_context_t snow_3g_context;
-  int n;
-  int i = 0;
+  uint32_t stack_ks[EEA1_STACK_KEY_STREAM_WORDS];
+  uint32_t n;
+  uint32_t i = 0;
   uint32_t zero_bit = 0;
-  // uint32_t                                byte_length;
+  uint32_t byte_length;
   uint32_t* KS;
   uint32_t K[4], IV[4];
 
@@ -42,8 +46,7 @@ int nas_stream_encrypt_eea1(nas_stream_cipher_t* const stream_cipher,
   DevAssert(out != NULL);
   n = (stream_cipher->blength + 31) / 32;
   zero_bit = stream_cipher->blength & 0x7;
-  // byte_length = stream_cipher->blength >> 3;
-  memset(&snow_3g_context, 0, sizeof(snow_3g_context));
+  byte_length = (stream_cipher->blength + 7) >> 3;
   /*
    * Initialisation
    */
@@ -79,12 +82,9 @@ int nas_stream_encrypt_eea1(nas_stream_cipher_t* const stream_cipher,
    * Run SNOW 3G algorithm to generate sequence of key stream bits KS
    */
   snow3g_initialize(K, IV, &snow_3g_context);
-  KS = (uint32_t*)calloc(1, 4 * n);
-  snow3g_generate_key_stream(n, (uint32_t*)KS, &snow_3g_context);
-
-  if (zero_bit > 0) {
-    KS[n - 1] = KS[n - 1] & (uint32_t)(0xFFFFFFFF << (8 - zero_bit));
-  }
+  KS = n <= EEA1_STACK_KEY_STREAM_WORDS ? stack_ks
+                                        : (uint32_t*)calloc(1, 4 * n);
+  snow3g_generate_key_stream(n, KS, &snow_3g_context);
 
   for (i = 0; i < n; i++) {
     KS[i] = hton_int32(KS[i]);
@@ -92,27 +92,18 @@ int nas_stream_encrypt_eea1(nas_stream_cipher_t* const stream_cipher,
 
   /*
    * Exclusive-OR the input data with keystream to generate the output bit
-   * stream
+   * stream, out may be the input data
    */
-  for (i = 0; i < n * 4; i++) {
-    stream_cipher->message[i] ^= *(((uint8_t*)KS) + i);
+  for (i = 0; i < byte_length; i++) {
+    out[i] = stream_cipher->message[i] ^ *(((uint8_t*)KS) + i);
   }
 
-  int ceil_index = 0;
-
   if (zero_bit > 0) {
-    ceil_index = (stream_cipher->blength + 7) >> 3;
-    stream_cipher->message[ceil_index - 1] =
-        stream_cipher->message[ceil_index - 1] &
-        (uint8_t)(0xFF << (8 - zero_bit));
+    out[byte_length - 1] &= (uint8_t)(0xFF << (8 - zero_bit));
   }
 
-  free_wrapper((void**)&KS);
-  memcpy(out, stream_cipher->message, n * 4);
-
-  if (zero_bit > 0) {
-    out[ceil_index - 1] = stream_cipher->message[ceil_index - 1];
+  if (KS != stack_ks) {
+    free_wrapper((void**)&KS);
   }
-
   return 0;
 }
@@ -19,23 +19,22 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <string.h>
-#include <nettle/nettle-meta.h>
+#include <nettle/aes.h>
 #include <nettle/ctr.h>
 
 #include "lte/gateway/c/core/common/assertions.h"
-#include "lte/gateway/c/core/common/dynamic_memory_check.h"
 #include "lte/gateway/c/core/oai/common/conversions.h"
 #include "lte/gateway/c/core/oai/lib/secu/secu_defs.h"
 
-int nas_stream_encrypt_eea2(nas_stream_cipher_t* const stream_cipher,
-                            uint8_t* const out) {
-  uint8_t m[16];
+int nas_stream_encrypt_eea2_ctx(const nas_stream_aes_ctx_t* const ctx,
+                                nas_stream_cipher_t* const stream_cipher,
+                                uint8_t* const out) {
+  uint8_t m[AES_BLOCK_SIZE];
   uint32_t local_count;
-  void* ctx;
-  uint8_t* data;
   uint32_t zero_bit = 0;
   uint32_t byte_length;
 
+  DevAssert(ctx != NULL);
   DevAssert(stream_cipher != NULL);
   DevAssert(out != NULL);
   zero_bit = stream_cipher->blength & 0x7;
@@ -43,8 +42,6 @@ int nas_stream_encrypt_eea2(nas_stream_cipher_t* const stream_cipher,
 
   if (zero_bit > 0) byte_length += 1;
 
-  ctx = malloc(nettle_aes128.context_size);
-  data = calloc(1, byte_length);
   local_count = hton_int32(stream_cipher->count);
   memset(m, 0, sizeof(m));
   memcpy(&m[0], &local_count, 4);
@@ -53,18 +50,25 @@ int nas_stream_encrypt_eea2(nas_stream_cipher_t* const stream_cipher,
   /*
    * Other bits are 0
    */
-  nettle_aes128.set_encrypt_key(ctx, stream_cipher->key_length,
-                                stream_cipher->key);
-
-  nettle_ctr_crypt(ctx, nettle_aes128.encrypt, nettle_aes128.block_size, m,
-                   byte_length, data, stream_cipher->message);
+  // CTR mode allows out to be the message. Fat builds of nettle pick their
+  // AES-NI code at runtime when the CPU has it.
+  ctr_crypt(&ctx->aes, (nettle_cipher_func*)aes128_encrypt, AES_BLOCK_SIZE, m,
+            byte_length, out, stream_cipher->message);
 
   if (zero_bit > 0)
-    data[byte_length - 1] =
-        data[byte_length - 1] & (uint8_t)(0xFF << (8 - zero_bit));
+    out[byte_length - 1] =
+        out[byte_length - 1] & (uint8_t)(0xFF << (8 - zero_bit));
 
-  memcpy(out, data, byte_length);
-  free_wrapper((void**)&data);
-  free_wrapper((void**)&ctx);
   return 0;
 }
+
+int nas_stream_encrypt_eea2(nas_stream_cipher_t* const stream_cipher,
+                            uint8_t* const out) {
+  nas_stream_aes_ctx_t ctx;
+
+  DevAssert(stream_cipher != NULL);
+  DevAssert(stream_cipher->key != NULL);
+  DevAssert(stream_cipher->key_length == AES128_KEY_SIZE);
+  nas_stream_aes_ctx_init(&ctx, stream_cipher->key);
+  return nas_stream_encrypt_eea2_ctx(&ctx, stream_cipher, out);
+}
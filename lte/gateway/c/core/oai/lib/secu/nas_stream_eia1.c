@@ -77,8 +77,42 @@ uint64_t MUL64(uint64_t V, uint64_t P, uint64_t c) {
   uint64_t result = 0;
   int i = 0;
 
+  /* V holds MUL64xPOW(V, i, c), computed from the one of i - 1 */
   for (i = 0; i < 64; i++) {
-    if ((P >> i) & 0x1) result ^= MUL64xPOW(V, i, c);
+    if ((P >> i) & 0x1) result ^= V;
+    V = MUL64x(V, c);
+  }
+
+  return result;
+}
+
+/* MUL64 by a P fixed for the whole message.
+   The products of P and each 4-bit digit of V are computed once by
+   mul64_table_init, so that MUL64(V, P, c) is the sum of the 16 products
+   looked up for the digits of V instead of a loop over the 64 bits of P.
+*/
+static void mul64_table_init(uint64_t table[16][16], uint64_t P, uint64_t c) {
+  int j = 0, b = 0, v = 0;
+
+  for (j = 0; j < 16; j++) {
+    table[j][0] = 0;
+    for (b = 0; b < 4; b++) {
+      /* P holds MUL64xPOW(P, 4 * j + b, c) */
+      for (v = 0; v < (1 << b); v++) {
+        table[j][(1 << b) | v] = table[j][v] ^ P;
+      }
+      P = MUL64x(P, c);
+    }
+  }
+}
+
+static uint64_t mul64_table(const uint64_t table[16][16], uint64_t V) {
+  uint64_t result = 0;
+  int j = 0;
+
+  for (j = 0; j < 16; j++) {
+    result ^= table[j][V & 0xf];
+    V >>= 4;
   }
 
   return result;
@@ -116,6 +150,7 @@ int nas_stream_encrypt_eia1(nas_stream_cipher_t* const stream_cipher,
   uint64_t P;
   uint64_t Q;
   uint64_t c;
+  uint64_t P_table[16][16];
   uint64_t M_D_2;
   int rem_bits;
   uint32_t mask = 0;
@@ -186,6 +221,7 @@ int nas_stream_encrypt_eia1(nas_stream_cipher_t* const stream_cipher,
   // printf ("D:%d\n",D);
   EVAL = 0;
   c = 0x1b;
+  mul64_table_init(P_table, P, c);
 
   /*
    * for 0 <= i <= D-3
@@ -193,7 +229,7 @@ int nas_stream_encrypt_eia1(nas_stream_cipher_t* const stream_cipher,
   for (i = 0; i < D - 2; i++) {
     V = EVAL ^ ((uint64_t)hton_int32(message[2 * i]) << 32 |
                 (uint64_t)hton_int32(message[2 * i + 1]));
-    EVAL = MUL64(V, P, c);
+    EVAL = mul64_table(P_table, V);
     // printf ("Mi: %16X %16X\tEVAL:
     // %16lX\n",hton_int32(message[2*i]),hton_int32(message[2*i+1]), EVAL);
   }
@@ -215,7 +251,7 @@ int nas_stream_encrypt_eia1(nas_stream_cipher_t* const stream_cipher,
   }
 
   V = EVAL ^ M_D_2;
-  EVAL = MUL64(V, P, c);
+  EVAL = mul64_table(P_table, V);
   /*
    * for D-1
    */
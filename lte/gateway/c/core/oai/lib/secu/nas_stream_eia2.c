@@ -19,36 +19,53 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <string.h>
-#include <openssl/cmac.h>
-#include <openssl/evp.h>
-#include <openssl/ossl_typ.h>
+#include <nettle/aes.h>
 
 #include "lte/gateway/c/core/common/assertions.h"
-#include "lte/gateway/c/core/common/dynamic_memory_check.h"
 #include "lte/gateway/c/core/oai/common/conversions.h"
 #include "lte/gateway/c/core/oai/common/log.h"
 #include "lte/gateway/c/core/oai/lib/secu/secu_defs.h"
 
+#define EIA2_HEADER_SIZE 8
+
+// Copies n bytes from pos of the EIA2 input, the header followed by the
+// message, to block
+static void eia2_block(uint8_t* const block, const uint8_t* const header,
+                       const uint8_t* const message, uint32_t pos, uint32_t n) {
+  uint32_t from_header = 0;
+
+  if (pos < EIA2_HEADER_SIZE) {
+    from_header = EIA2_HEADER_SIZE - pos < n ? EIA2_HEADER_SIZE - pos : n;
+    memcpy(block, &header[pos], from_header);
+  }
+  if (n > from_header) {
+    memcpy(&block[from_header], &message[pos + from_header - EIA2_HEADER_SIZE],
+           n - from_header);
+  }
+}
+
 /*!
-   @brief Create integrity cmac t for a given message.
+   @brief Create integrity cmac t for a given message, with the AES-CMAC of
+   RFC 4493 run over the key schedule and subkeys of ctx.
+   @param[in] ctx Key of the integrity protection
    @param[in] stream_cipher Structure containing various variables to setup
    encoding
    @param[out] out For EIA2 the output string is 32 bits long
 */
-int nas_stream_encrypt_eia2(nas_stream_cipher_t* const stream_cipher,
-                            uint8_t const out[4]) {
-  uint8_t* m = NULL;
+int nas_stream_encrypt_eia2_ctx(const nas_stream_aes_ctx_t* const ctx,
+                                nas_stream_cipher_t* const stream_cipher,
+                                uint8_t const out[4]) {
+  uint8_t header[EIA2_HEADER_SIZE] = {0};
+  uint8_t block[AES_BLOCK_SIZE];
+  uint8_t x[AES_BLOCK_SIZE] = {0};
   uint32_t local_count = 0;
-  size_t size = 4;
-  uint8_t data[16] = {0};
-  CMAC_CTX* cmac_ctx = NULL;
-  const EVP_CIPHER* cipher = EVP_aes_128_cbc();
   uint32_t zero_bit = 0;
   uint32_t m_length;
+  uint32_t length;
+  uint32_t pos = 0;
 
+  DevAssert(ctx != NULL);
   DevAssert(stream_cipher != NULL);
-  DevAssert(stream_cipher->key != NULL);
-  DevAssert(stream_cipher->key_length > 0);
   DevAssert(out != NULL);
   zero_bit = stream_cipher->blength & 0x7;
   m_length = stream_cipher->blength >> 3;
@@ -56,28 +73,57 @@ int nas_stream_encrypt_eia2(nas_stream_cipher_t* const stream_cipher,
   if (zero_bit > 0) m_length += 1;
 
   local_count = hton_int32(stream_cipher->count);
-  m = calloc(1, m_length + 8);
-  memcpy(&m[0], &local_count, 4);
-  m[4] = ((stream_cipher->bearer & 0x1F) << 3) |
-         ((stream_cipher->direction & 0x01) << 2);
-  memcpy(&m[8], stream_cipher->message, m_length);
+  memcpy(&header[0], &local_count, 4);
+  header[4] = ((stream_cipher->bearer & 0x1F) << 3) |
+              ((stream_cipher->direction & 0x01) << 2);
+  length = m_length + EIA2_HEADER_SIZE;
 
-  OAILOG_TRACE(LOG_NAS, "Byte length: %u, Zero bits: %u:\n", m_length + 8,
-               zero_bit);
-  OAILOG_STREAM_HEX(OAILOG_LEVEL_TRACE, LOG_NAS, "m:", m, m_length + 8);
-  OAILOG_STREAM_HEX(OAILOG_LEVEL_TRACE, LOG_NAS, "Key:", stream_cipher->key,
-                    stream_cipher->key_length);
+  OAILOG_TRACE(LOG_NAS, "Byte length: %u, Zero bits: %u:\n", length, zero_bit);
   OAILOG_STREAM_HEX(OAILOG_LEVEL_TRACE, LOG_NAS,
                     "Message:", stream_cipher->message, m_length);
 
-  cmac_ctx = CMAC_CTX_new();
-  CMAC_Init(cmac_ctx, stream_cipher->key, stream_cipher->key_length, cipher,
-            NULL);
-  CMAC_Update(cmac_ctx, m, m_length + 8);
-  CMAC_Final(cmac_ctx, data, &size);
-  CMAC_CTX_free(cmac_ctx);
-  OAILOG_STREAM_HEX(OAILOG_LEVEL_TRACE, LOG_NAS, "Out:", data, size);
-  memcpy((void*)out, data, 4);
-  free_wrapper((void**)&m);
+  // All the blocks but the last one
+  for (; length - pos > AES_BLOCK_SIZE; pos += AES_BLOCK_SIZE) {
+    eia2_block(block, header, stream_cipher->message, pos, AES_BLOCK_SIZE);
+    for (int i = 0; i < AES_BLOCK_SIZE; i++) {
+      x[i] ^= block[i];
+    }
+    aes128_encrypt(&ctx->aes, AES_BLOCK_SIZE, x, x);
+  }
+  // The last block is xored with K1 if it is complete, else it is padded and
+  // xored with K2
+  eia2_block(block, header, stream_cipher->message, pos, length - pos);
+  if (length - pos == AES_BLOCK_SIZE) {
+    for (int i = 0; i < AES_BLOCK_SIZE; i++) {
+      x[i] ^= block[i] ^ ctx->cmac_k1[i];
+    }
+  } else {
+    block[length - pos] = 0x80;
+    memset(&block[length - pos + 1], 0, AES_BLOCK_SIZE - (length - pos) - 1);
+    for (int i = 0; i < AES_BLOCK_SIZE; i++) {
+      x[i] ^= block[i] ^ ctx->cmac_k2[i];
+    }
+  }
+  aes128_encrypt(&ctx->aes, AES_BLOCK_SIZE, x, x);
+
+  OAILOG_STREAM_HEX(OAILOG_LEVEL_TRACE, LOG_NAS, "Out:", x, 4);
+  memcpy((void*)out, x, 4);
   return 0;
 }
+
+/*!
+   @brief Create integrity cmac t for a given message.
+   @param[in] stream_cipher Structure containing various variables to setup
+   encoding
+   @param[out] out For EIA2 the output string is 32 bits long
+*/
+int nas_stream_encrypt_eia2(nas_stream_cipher_t* const stream_cipher,
+                            uint8_t const out[4]) {
+  nas_stream_aes_ctx_t ctx;
+
+  DevAssert(stream_cipher != NULL);
+  DevAssert(stream_cipher->key != NULL);
+  DevAssert(stream_cipher->key_length == AES128_KEY_SIZE);
+  nas_stream_aes_ctx_init(&ctx, stream_cipher->key);
+  return nas_stream_encrypt_eia2_ctx(&ctx, stream_cipher, out);
+}
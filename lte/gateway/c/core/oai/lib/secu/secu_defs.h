@@ -21,6 +21,7 @@
 #include <stdint.h>
 
 #include "lte/gateway/c/core/oai/common/security_types.h"
+#include "lte/gateway/c/core/oai/lib/secu/nas_stream_aes.h"
 
 #define SECU_DIRECTION_UPLINK 0
 #define SECU_DIRECTION_DOWNLINK 1
@@ -92,6 +93,16 @@ int nas_stream_encrypt_eia1(nas_stream_cipher_t* const stream_cipher,
                             uint8_t const out[4]);
 int nas_stream_encrypt_eia2(nas_stream_cipher_t* const stream_cipher,
                             uint8_t const out[4]);
+/*
+ * EEA2 and EIA2 with the key of ctx, stream_cipher->key is not used. They do
+ * not allocate memory, and out may be stream_cipher->message for EEA2.
+ */
+int nas_stream_encrypt_eea2_ctx(const nas_stream_aes_ctx_t* const ctx,
+                                nas_stream_cipher_t* const stream_cipher,
+                                uint8_t* const out);
+int nas_stream_encrypt_eia2_ctx(const nas_stream_aes_ctx_t* const ctx,
+                                nas_stream_cipher_t* const stream_cipher,
+                                uint8_t const out[4]);
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,196 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Formats the binary log file written by the MME with the logging OUTPUT set
+// to a file and BINARY set to "yes", in the lines of the text logging.
+// Usage: oai_log_decode <binary log file>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "lte/gateway/c/core/oai/common/log_binary.h"
+
+// Formats and file names are short, anything larger is a corrupted file
+#define DECODE_RECORD_MAX (1 << 20)
+
+typedef struct decode_ctx_s {
+  char* level_names;
+  uint32_t num_levels;
+  uint32_t level_name_size;
+  char* proto_names;
+  uint32_t num_protos;
+  uint32_t proto_name_size;
+  log_binary_strings_t strings;
+  log_binary_clock_t first_clock;
+  log_binary_clock_t last_clock;
+  bool has_clock;
+  uint64_t number;
+} decode_ctx_t;
+
+static const char* name(const char* names, uint32_t num_names,
+                        uint32_t name_size, uint8_t index) {
+  if (index >= num_names) {
+    return "?";
+  }
+  return &names[index * name_size];
+}
+
+static int read_header(FILE* file, decode_ctx_t* ctx) {
+  log_binary_file_header_t header;
+
+  if ((1 != fread(&header, sizeof(header), 1, file)) ||
+      memcmp(header.magic, LOG_BINARY_FILE_MAGIC, sizeof(header.magic)) ||
+      !header.level_name_size || !header.proto_name_size) {
+    fprintf(stderr, "Not a binary log file\n");
+    return -1;
+  }
+  ctx->num_levels = header.num_levels;
+  ctx->level_name_size = header.level_name_size;
+  ctx->num_protos = header.num_protos;
+  ctx->proto_name_size = header.proto_name_size;
+  ctx->level_names = calloc(header.num_levels, header.level_name_size);
+  ctx->proto_names = calloc(header.num_protos, header.proto_name_size);
+  if (!ctx->level_names || !ctx->proto_names ||
+      (header.num_levels != fread(ctx->level_names, header.level_name_size,
+                                  header.num_levels, file)) ||
+      (header.num_protos != fread(ctx->proto_names, header.proto_name_size,
+                                  header.num_protos, file))) {
+    fprintf(stderr, "Truncated binary log file header\n");
+    return -1;
+  }
+  // Names are null terminated within their size
+  for (uint32_t i = 0; i < header.num_levels; i++) {
+    ctx->level_names[(i + 1) * header.level_name_size - 1] = '\0';
+  }
+  for (uint32_t i = 0; i < header.num_protos; i++) {
+    ctx->proto_names[(i + 1) * header.proto_name_size - 1] = '\0';
+  }
+  return 0;
+}
+
+static void decode_record(decode_ctx_t* ctx,
+                          const log_binary_record_t* record) {
+  char line[LOG_BINARY_LINE_MAX];
+
+  switch (record->type) {
+    case LOG_BINARY_RECORD_STRING: {
+      const log_binary_string_t* string = (const log_binary_string_t*)record;
+      const char* text = (const char*)(string + 1);
+      if ((record->size > sizeof(*string)) &&
+          memchr(text, '\0', record->size - sizeof(*string))) {
+        log_binary_strings_put(&ctx->strings, string->id, text);
+      }
+    } break;
+
+    case LOG_BINARY_RECORD_CLOCK: {
+      const log_binary_clock_record_t* clock =
+          (const log_binary_clock_record_t*)record;
+      if (record->size < sizeof(*clock)) {
+        return;
+      }
+      if (!ctx->has_clock) {
+        ctx->first_clock = clock->clock;
+        ctx->has_clock = true;
+      }
+      ctx->last_clock = clock->clock;
+    } break;
+
+    case LOG_BINARY_RECORD_MESSAGE: {
+      const log_binary_message_t* message =
+          (const log_binary_message_t*)record;
+      if (record->size < sizeof(*message)) {
+        return;
+      }
+      const char* file = log_binary_strings_get(&ctx->strings, message->file);
+      int length = log_binary_format_line(
+          message, log_binary_strings_get(&ctx->strings, message->format),
+          file ? file : "?",
+          name(ctx->level_names, ctx->num_levels, ctx->level_name_size,
+               message->level),
+          name(ctx->proto_names, ctx->num_protos, ctx->proto_name_size,
+               message->proto),
+          ctx->number++,
+          log_binary_realtime_ns(&ctx->first_clock, &ctx->last_clock,
+                                 message->timestamp),
+          line, sizeof(line));
+      if (length < 0) {
+        fprintf(stderr, "Could not format the message of %s:%u\n",
+                file ? file : "?", message->line);
+        return;
+      }
+      fputs(line, stdout);
+      if (!length || ('\n' != line[length - 1])) {
+        fputc('\n', stdout);
+      }
+    } break;
+
+    case LOG_BINARY_RECORD_DROPPED:
+      if (record->size < sizeof(log_binary_dropped_t)) {
+        return;
+      }
+      log_binary_format_dropped((const log_binary_dropped_t*)record, line,
+                                sizeof(line));
+      fputs(line, stdout);
+      break;
+
+    default:
+      break;
+  }
+}
+
+int main(int argc, char** argv) {
+  decode_ctx_t ctx = {0};
+  log_binary_record_t header;
+  uint8_t* record = malloc(DECODE_RECORD_MAX);
+  int rv = 0;
+
+  if (argc != 2) {
+    fprintf(stderr, "Usage: oai_log_decode <binary log file>\n");
+    return 1;
+  }
+  FILE* file = fopen(argv[1], "rb");
+  if (!file) {
+    perror(argv[1]);
+    return 1;
+  }
+  if (!record || read_header(file, &ctx)) {
+    fclose(file);
+    return 1;
+  }
+
+  while (1 == fread(&header, sizeof(header), 1, file)) {
+    if ((header.size < sizeof(header)) || (header.size > DECODE_RECORD_MAX) ||
+        (header.size % 8)) {
+      fprintf(stderr, "Corrupted record of %u bytes\n", header.size);
+      rv = 1;
+      break;
+    }
+    memcpy(record, &header, sizeof(header));
+    if ((header.size > sizeof(header)) &&
+        (1 != fread(record + sizeof(header), header.size - sizeof(header), 1,
+                    file))) {
+      // The MME may still be writing the last record
+      break;
+    }
+    decode_record(&ctx, (const log_binary_record_t*)record);
+  }
+
+  log_binary_strings_free(&ctx.strings);
+  free(ctx.level_names);
+  free(ctx.proto_names);
+  free(record);
+  fclose(file);
+  return rv;
+}
@@ -95,8 +95,6 @@ int main(int argc, char* argv[]) {
   CHECK_INIT_RETURN(OAILOG_INIT(MME_CONFIG_STRING_MME_CONFIG,
                                 OAILOG_LEVEL_DEBUG, MAX_LOG_PROTOS));
   CHECK_INIT_RETURN(shared_log_init(MAX_LOG_PROTOS));
-  CHECK_INIT_RETURN(itti_init(TASK_MAX, THREAD_MAX, MESSAGES_ID_MAX, tasks_info,
-                              messages_info, NULL, NULL));
 
   /*
    * Parse the command line for options and set the mme_config accordingly.
@@ -107,6 +105,12 @@ int main(int argc, char* argv[]) {
 #else
   CHECK_INIT_RETURN(mme_config_parse_opt_line(argc, argv, &mme_config));
 #endif
+  // The transport is read from the INTERTASK_INTERFACE section of mme.conf
+  CHECK_INIT_RETURN(itti_init(
+      TASK_MAX, THREAD_MAX, MESSAGES_ID_MAX, tasks_info, messages_info, NULL,
+      NULL,
+      mme_config.itti_config.ring_transport ? ITTI_TRANSPORT_RING
+                                            : ITTI_TRANSPORT_ZMQ));
   // Initialize Sentry error collection
   // We have to initialize here for now since itti_init asserts on there being
   // only 1 thread
@@ -191,7 +191,7 @@ static int handle_message(zloop_t* loop, zsock_t* reader, void* arg) {
     /* Handle Terminate message */
     case TERMINATE_MESSAGE:
       itti_free_msg_content(received_message_p);
-      free(received_message_p);
+      itti_free_msg(received_message_p);
       amf_app_exit();
       break;
     default:
@@ -203,6 +203,7 @@ static int handle_message(zloop_t* loop, zsock_t* reader, void* arg) {
   if (!is_task_state_same) {
     put_amf_nas_state();
   }
+  flush_amf_nas_state();
   return RETURNok;
 }
 
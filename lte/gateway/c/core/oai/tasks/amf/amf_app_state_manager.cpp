@@ -55,6 +55,10 @@ void put_amf_nas_state() {
   OAILOG_FUNC_OUT(LOG_AMF_APP);
 }
 
+void flush_amf_nas_state() {
+  magma5g::AmfNasStateManager::getInstance().flush_state_to_db();
+}
+
 /**
  * Release the memory allocated for the AMF NAS state, this does not clean the
  * state persisted in data store
@@ -61,6 +61,12 @@ amf_app_desc_t* get_amf_nas_state(bool read_from_redis);
  */
 void put_amf_nas_state();
 
+/**
+ * Write the AMF/NAS and UE states put since the last call to data store, in a
+ * single round trip
+ */
+void flush_amf_nas_state();
+
 /**
  * Release the memory allocated for the AMF NAS state, this does not clean the
  * state persisted in data store
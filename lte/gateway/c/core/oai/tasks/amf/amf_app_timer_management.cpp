@@ -52,8 +52,8 @@ int AmfUeContext::StartTimer(size_t msec, timer_repeat_t repeat,
   OAILOG_FUNC_IN(LOG_AMF_APP);
 #if !MME_UNIT_TEST
   int timer_id = -1;
-  if ((timer_id = start_timer(&amf_app_task_zmq_ctx, msec, repeat, handler,
-                              nullptr)) != -1) {
+  if ((timer_id = start_wheel_timer(&amf_app_task_zmq_ctx, msec, repeat,
+                                    handler, nullptr)) != -1) {
     amf_app_timers.insert(std::pair<int, timer_arg_t>(timer_id, arg));
   }
   OAILOG_FUNC_RETURN(LOG_AMF_APP, timer_id);
@@ -65,7 +65,7 @@ int AmfUeContext::StartTimer(size_t msec, timer_repeat_t repeat,
 void AmfUeContext::StopTimer(int timer_id) {
   OAILOG_FUNC_IN(LOG_AMF_APP);
 #if !MME_UNIT_TEST
-  stop_timer(&amf_app_task_zmq_ctx, timer_id);
+  stop_wheel_timer(&amf_app_task_zmq_ctx, timer_id);
   amf_app_timers.erase(timer_id);
 #endif /* !MME_UNIT_TEST */
   OAILOG_FUNC_OUT(LOG_AMF_APP);
@@ -106,8 +106,8 @@ int AmfUeContext::StartPduTimer(size_t msec, timer_repeat_t repeat,
                                 zloop_timer_fn handler, ue_pdu_id_t arg) {
   OAILOG_FUNC_IN(LOG_AMF_APP);
   int timer_id = -1;
-  if ((timer_id = start_timer(&amf_app_task_zmq_ctx, msec, repeat, handler,
-                              nullptr)) != -1) {
+  if ((timer_id = start_wheel_timer(&amf_app_task_zmq_ctx, msec, repeat,
+                                    handler, nullptr)) != -1) {
     amf_pdu_timers[timer_id] = arg;
   }
   OAILOG_FUNC_RETURN(LOG_AMF_APP, timer_id);
@@ -115,7 +115,7 @@ int AmfUeContext::StartPduTimer(size_t msec, timer_repeat_t repeat,
 //------------------------------------------------------------------------------
 void AmfUeContext::StopPduTimer(int timer_id) {
   OAILOG_FUNC_IN(LOG_AMF_APP);
-  stop_timer(&amf_app_task_zmq_ctx, timer_id);
+  stop_wheel_timer(&amf_app_task_zmq_ctx, timer_id);
   std::map<int, ue_pdu_id_t>::iterator it = amf_pdu_timers.find(timer_id);
   amf_pdu_timers.erase(it);
   OAILOG_FUNC_OUT(LOG_AMF_APP);
@@ -23,6 +23,7 @@ extern "C" {
 };
 #endif
 #include "lte/gateway/c/core/oai/include/amf_securityDef.h"
+#include "lte/gateway/c/core/oai/lib/secu/nas_stream_aes.h"
 
 typedef uint8_t ksi_t;
 #define AMF_CTXT_MEMBER_AUTH_VECTORS ((uint32_t)1 << 7)
@@ -62,6 +63,8 @@ typedef struct amf_security_context_s {
   int vector_index;                     /* Pointer on vector */
   uint8_t knas_enc[AUTH_KNAS_ENC_SIZE]; /* NAS cyphering key               */
   uint8_t knas_int[AUTH_KNAS_INT_SIZE]; /* NAS integrity key               */
+  /* Key schedule of knas_int for NIA2 */
+  nas_stream_aes_ctx_t knas_int_aes;
   uint8_t kamf[AUTH_KAMF_SIZE];         /* AMF key               */
   uint8_t kgnb[AUTH_KGNB_SIZE];         /* GNB key               */
   count_t dl_count;
@@ -379,6 +379,8 @@ status_code_e amf_proc_security_mode_control(
 
       derive_5gkey_nas(NAS_ENC_ALG, 1, amf_ctx->_security.kamf,
                        amf_ctx->_security.knas_enc);
+      nas_stream_aes_ctx_init(&amf_ctx->_security.knas_int_aes,
+                              amf_ctx->_security.knas_int);
 
       /*
        * Set new security context indicator
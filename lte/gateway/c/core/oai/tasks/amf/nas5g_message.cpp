@@ -31,6 +31,9 @@ namespace magma5g {
 
 #define NAS5G_MESSAGE_SECURITY_HEADER_SIZE 7
 
+/* Plain NAS messages up to this size are encoded and decoded on the stack */
+#define NAS5G_MESSAGE_STACK_BUFFER_SIZE 2048
+
 /* Functions used to decode layer 3 NAS messages */
 int nas5g_message_header_decode(const unsigned char* const buffer,
                                 amf_msg_header* const header,
@@ -504,8 +507,14 @@ static int _nas5g_message_protected_decode(
     amf_nas_message_decode_status_t* const status) {
   OAILOG_FUNC_IN(LOG_AMF_APP);
   int bytes = TLV_BUFFER_TOO_SHORT;
-  unsigned char* const plain_msg = (unsigned char*)calloc(1, length);
+  unsigned char stack_msg[NAS5G_MESSAGE_STACK_BUFFER_SIZE];
+  unsigned char* plain_msg = stack_msg;
 
+  if (length > sizeof(stack_msg)) {
+    plain_msg = (unsigned char*)calloc(1, length);
+  } else {
+    memset(plain_msg, 0, length);
+  }
   if (plain_msg) {
     /*
      * Decrypt the security protected NAS message
@@ -519,7 +528,9 @@ static int _nas5g_message_protected_decode(
      */
     bytes = _nas5g_message_plain_decode(plain_msg, header, msg, length);
 
-    free(plain_msg);
+    if (plain_msg != stack_msg) {
+      free(plain_msg);
+    }
   }
   OAILOG_FUNC_RETURN(LOG_AMF_APP, bytes);
 }
@@ -671,8 +682,14 @@ static int _nas5g_message_protected_encode(
   amf_security_context_t* amf_security_context =
       (amf_security_context_t*)security;
   int bytes = TLV_BUFFER_TOO_SHORT;
-  unsigned char* plain_msg = (unsigned char*)calloc(1, length);
+  unsigned char stack_msg[NAS5G_MESSAGE_STACK_BUFFER_SIZE];
+  unsigned char* plain_msg = stack_msg;
 
+  if (length > sizeof(stack_msg)) {
+    plain_msg = (unsigned char*)calloc(1, length);
+  } else {
+    memset(plain_msg, 0, length);
+  }
   if (plain_msg) {
     /*
      * Encode the security protected NAS message as plain NAS message
@@ -688,8 +705,10 @@ static int _nas5g_message_protected_encode(
           msg->header.message_authentication_code, msg->header.sequence_number,
           amf_security_context->direction_encode, size, amf_security_context);
     }
+    if (plain_msg != stack_msg) {
+      free(plain_msg);
+    }
   }
-  free(plain_msg);
 
   OAILOG_FUNC_RETURN(LOG_AMF_APP, bytes);
 }
@@ -1001,7 +1020,10 @@ static uint32_t _nas5g_message_get_mac(
        * length in bits
        */
       stream_cipher.blength = length << 3;
-      nas_stream_encrypt_eia2(&stream_cipher, mac);
+      nas_stream_encrypt_eia2_ctx(
+          nas_stream_aes_ctx_get(&amf_security_context->knas_int_aes,
+                                 amf_security_context->knas_int),
+          &stream_cipher, mac);
       OAILOG_DEBUG(
           LOG_AMF_APP,
           "M5G_NAS_SECURITY_ALGORITHMS_5G_IA2 returned MAC %x.%x.%x.%x(%u) for "
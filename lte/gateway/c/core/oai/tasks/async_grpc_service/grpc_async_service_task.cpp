@@ -183,7 +183,7 @@ static int handle_message(zloop_t* loop, zsock_t* reader, void* arg) {
 
   switch (ITTI_MSG_ID(received_message_p)) {
     case TERMINATE_MESSAGE:
-      free(received_message_p);
+      itti_free_msg(received_message_p);
       grpc_async_service_exit();
       break;
     default:
@@ -192,7 +192,7 @@ static int handle_message(zloop_t* loop, zsock_t* reader, void* arg) {
                    ITTI_MSG_NAME(received_message_p));
       break;
   }
-  free(received_message_p);
+  itti_free_msg(received_message_p);
   return 0;
 }
 
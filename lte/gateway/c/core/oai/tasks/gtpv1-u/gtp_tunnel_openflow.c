@@ -27,6 +27,7 @@
 #include "lte/gateway/c/core/oai/lib/3gpp/3gpp_23.003.h"
 #include "lte/gateway/c/core/oai/lib/bstr/bstrlib.h"
 #include "lte/gateway/c/core/oai/lib/openflow/controller/ControllerMain.hpp"
+#include "lte/gateway/c/core/oai/lib/openflow/controller/OvsdbPortMonitor.hpp"
 #include "lte/gateway/c/core/oai/tasks/gtpv1-u/gtpv1u.h"
 #include "orc8r/gateway/c/common/ebpf/EbpfMapUtils.h"
 
@@ -39,22 +40,8 @@ static int ebpf_fd;
 
 #define MAX_GTP_PORT_NAME_LENGTH 39
 
-#define INIT_GTP_TABLE_SIZE 64
-#define MAX_GTP_TABLE_SIZE 1024
-
-struct gtp_portno {
-  // GTP port name is limited at 14 char
-  char name[MAX_GTP_PORT_NAME_LENGTH];
-  // zero port number is unknown port
-  uint32_t portno;
-};
-
-struct gtp_portno_record {
-  struct gtp_portno* arr;
-  int allocated;
-  int size;
-};
-static struct gtp_portno_record gtp_portno_rec;
+// Time for the port number of a new GTP port to reach the OVSDB monitor
+#define GTP_PORT_NO_WAIT_MSEC 1000
 
 /**
  * Generate GTP port name from eNodeB IP address
@@ -82,90 +69,6 @@ static void ip_addr_to_gtp_port_name(struct in_addr enb_addr,
   assert(rc > 0);
 }
 
-static uint32_t search_portno_records(char* name) {
-  int i;
-  for (i = 0; i < gtp_portno_rec.allocated; i++) {
-    if (!strncmp(name, gtp_portno_rec.arr[i].name, MAX_GTP_PORT_NAME_LENGTH)) {
-      return gtp_portno_rec.arr[i].portno;
-    }
-  }
-  return 0;
-}
-
-/**
- * Implements basic port number map with linear seach.
- */
-static void add_portno_rec(char* port_name, uint32_t portno) {
-  if (gtp_portno_rec.allocated == gtp_portno_rec.size) {
-    int new_size = gtp_portno_rec.size * 2;
-    if (new_size > MAX_GTP_TABLE_SIZE) {
-      // in case of unpected increase in table size, flush
-      // all records.
-      new_size = INIT_GTP_TABLE_SIZE;
-    }
-    struct gtp_portno* new_arr = calloc(new_size, sizeof(struct gtp_portno));
-    if (!new_arr) {
-      return;
-    }
-    if (new_size > gtp_portno_rec.size) {
-      // In case of table size increase copy existing records.
-      memcpy(new_arr, gtp_portno_rec.arr,
-             sizeof(gtp_portno_rec.arr[0]) * gtp_portno_rec.size);
-    } else {
-      // Flush all records if size resets to init-size.
-      gtp_portno_rec.allocated = 0;
-    }
-    free(gtp_portno_rec.arr);
-    gtp_portno_rec.arr = new_arr;
-    gtp_portno_rec.size = new_size;
-  }
-  // Now we shld have space to add new port.
-  int i;
-
-  for (i = 0; i < gtp_portno_rec.size; i++) {
-    struct gtp_portno* rec = &gtp_portno_rec.arr[i];
-
-    if (!rec->portno) {
-      strncpy(rec->name, port_name, MAX_GTP_PORT_NAME_LENGTH);
-      rec->portno = portno;
-      gtp_portno_rec.allocated++;
-      return;
-    }
-  }
-  // port number caching is best effort.
-}
-
-/**
- * Read GTP tunnel port number from OVSDB.
- */
-static uint32_t get_gtp_port_no(char port_name[]) {
-  FILE* fp;
-  uint32_t port_no = 0;
-  char ovsdb_dump[256];
-
-  /* Open the command for reading. */
-  fp = popen("sudo ovsdb-client dump Interface name ofport", "r");
-  if (fp == NULL) {
-    OAILOG_ERROR(LOG_GTPV1U, "could not read ovsdb");
-    return 0;
-  }
-
-  /* Read the output a line at a time - output it. */
-  while (fgets(ovsdb_dump, sizeof(ovsdb_dump), fp) != NULL) {
-    OAILOG_DEBUG(LOG_GTPV1U, "ovsdb: %s\n", ovsdb_dump);
-    char* p = strstr(ovsdb_dump, port_name);
-    if (p) {
-      int len = strlen(port_name);
-      // ovsdb dump has port number after portname separated by whitespaces.
-      port_no = atoi(&p[len + 1]);
-      break;
-    }
-  }
-
-  pclose(fp);
-  return port_no;
-}
-
 /**
  * Create GTP tunnel using OVS tool
  */
@@ -222,12 +125,12 @@ static uint32_t create_gtp_port(struct in_addr enb_addr,
                  gtp_port_create, inet_ntoa(enb_addr));
   }
 
-  return get_gtp_port_no(port_name);
+  return ovsdb_port_monitor_get_ofport(port_name, GTP_PORT_NO_WAIT_MSEC);
 }
 
 /**
- * seach port in cached table. otherwise create tunnel and
- * retrieve port number from OVSDB.
+ * seach port in the OVSDB monitor. otherwise create tunnel and
+ * wait for its port number.
  */
 static uint32_t find_gtp_port_no(struct in_addr enb_addr,
                                  struct in6_addr* enb_addr_ipv6, bool is_pgw) {
@@ -241,18 +144,16 @@ static uint32_t find_gtp_port_no(struct in_addr enb_addr,
   char port_name[MAX_GTP_PORT_NAME_LENGTH];
   ip_addr_to_gtp_port_name(enb_addr, enb_addr_ipv6, port_name);
 
-  uint32_t portno = search_portno_records(port_name);
+  uint32_t portno = ovsdb_port_monitor_get_ofport(port_name, 0);
   if (portno) {
     return portno;
   }
 
-  portno = create_gtp_port(enb_addr, enb_addr_ipv6, port_name, is_pgw);
-  add_portno_rec(port_name, portno);
-  return portno;
+  return create_gtp_port(enb_addr, enb_addr_ipv6, port_name, is_pgw);
 }
 
 /**
- * Initialize GTP port table for caching GTP tunnel port numbers.
+ * Start the OVSDB monitor caching GTP tunnel port numbers.
  */
 static void openflow_multi_tunnel_init(void) {
   char* probe_gtp_type = "sudo ovs-vsctl list Open_vSwitch | grep gtpu";
@@ -267,9 +168,7 @@ static void openflow_multi_tunnel_init(void) {
   }
   OAILOG_INFO(LOG_GTPV1U, "Using GTP type: %s", ovs_gtp_type);
 
-  gtp_portno_rec.arr = calloc(INIT_GTP_TABLE_SIZE, sizeof(struct gtp_portno));
-  assert(gtp_portno_rec.arr != NULL);
-  gtp_portno_rec.size = INIT_GTP_TABLE_SIZE;
+  ovsdb_port_monitor_start(OVSDB_SOCKET_PATH);
 }
 
 // tunnel flows
@@ -278,6 +177,7 @@ int openflow_uninit(void) {
   if ((ret = stop_of_controller()) < 0) {
     OAILOG_ERROR(LOG_GTPV1U, "Could not stop openflow controller on uninit\n");
   }
+  ovsdb_port_monitor_stop();
   return ret;
 }
 
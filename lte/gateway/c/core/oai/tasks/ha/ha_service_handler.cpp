@@ -99,11 +99,11 @@ bool trigger_agw_offload_for_ue(const hash_key_t keyP, void* const elementP,
 
   IMSI_STRING_TO_IMSI64(offload_request->imsi, &imsi64);
 
-  magma::lte::oai::EnbDescription enb_ref_p;
-  magma::proto_map_rc_t rc = magma::lte::s1ap_state_get_enb(
-      s1ap_state, ue_context_p->sctp_assoc_id_key, &enb_ref_p);
+  const magma::lte::oai::EnbDescription* enb_ref_p =
+      magma::lte::s1ap_state_get_enb(s1ap_state,
+                                     ue_context_p->sctp_assoc_id_key);
 
-  if (rc != magma::PROTO_MAP_OK) {
+  if (enb_ref_p == nullptr) {
     OAILOG_ERROR_UE(LOG_UTIL, imsi64,
                     "Failed to find enb_ref_p for assoc_id :%u",
                     ue_context_p->sctp_assoc_id_key);
@@ -111,7 +111,7 @@ bool trigger_agw_offload_for_ue(const hash_key_t keyP, void* const elementP,
   }
   // Return if this UE does not satisfy any of the filtering criteria
   if ((imsi64 != ue_context_p->emm_context._imsi64) &&
-      (offload_request->eNB_id != enb_ref_p.enb_id())) {
+      (offload_request->eNB_id != enb_ref_p->enb_id())) {
     return false;
   }
 
@@ -128,7 +128,7 @@ bool trigger_agw_offload_for_ue(const hash_key_t keyP, void* const elementP,
         ue_context_p->mme_ue_s1ap_id;
     S1AP_UE_CONTEXT_RELEASE_REQ(message_p).enb_ue_s1ap_id =
         ue_context_p->enb_ue_s1ap_id;
-    S1AP_UE_CONTEXT_RELEASE_REQ(message_p).enb_id = enb_ref_p.enb_id();
+    S1AP_UE_CONTEXT_RELEASE_REQ(message_p).enb_id = enb_ref_p->enb_id();
     S1AP_UE_CONTEXT_RELEASE_REQ(message_p).relCause = S1AP_NAS_MME_OFFLOADING;
 
     OAILOG_INFO(
@@ -141,7 +141,7 @@ bool trigger_agw_offload_for_ue(const hash_key_t keyP, void* const elementP,
         ue_context_p->emm_context._imsi64, offload_request->imsi,
         ue_context_p->mme_ue_s1ap_id, ue_context_p->enb_ue_s1ap_id,
         ue_context_p->e_utran_cgi.cell_identity.enb_id,
-        ue_context_p->e_utran_cgi.cell_identity.cell_id, enb_ref_p.enb_id());
+        ue_context_p->e_utran_cgi.cell_identity.cell_id, enb_ref_p->enb_id());
     OAILOG_INFO(LOG_UTIL, "UE Context Release procedure initiated for IMSI%s",
                 offload_request->imsi);
     IMSI_STRING_TO_IMSI64(offload_request->imsi,
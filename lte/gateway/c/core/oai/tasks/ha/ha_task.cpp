@@ -57,7 +57,7 @@ static int handle_message(zloop_t* loop, zsock_t* reader, void* arg) {
 
     case TERMINATE_MESSAGE: {
       itti_free_msg_content(received_message_p);
-      free(received_message_p);
+      itti_free_msg(received_message_p);
       ha_exit();
     } break;
 
@@ -68,7 +68,7 @@ static int handle_message(zloop_t* loop, zsock_t* reader, void* arg) {
     } break;
   }
   itti_free_msg_content(received_message_p);
-  free(received_message_p);
+  itti_free_msg(received_message_p);
   return 0;
 }
 
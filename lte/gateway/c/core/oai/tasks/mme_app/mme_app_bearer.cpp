@@ -917,7 +917,8 @@ void mme_app_handle_delete_session_rsp(
         delete_sess_resp_pP->teid);
     increment_counter("mme_spgw_delete_session_rsp", 1, 1, "result", "failure");
   }
-  increment_counter("mme_spgw_delete_session_rsp", 1, 1, "result", "success");
+  INCREMENT_COUNTER_HANDLE("mme_spgw_delete_session_rsp", 1, 1, "result",
+                           "success");
   /*
    * Updating statistics
    */
@@ -1167,7 +1168,8 @@ status_code_e mme_app_handle_create_sess_resp(
         (pdn_conn_rsp_cause_t)(create_sess_resp_pP->cause.cause_value);
     goto error_handling_csr_failure;
   }
-  increment_counter("mme_spgw_create_session_rsp", 1, 1, "result", "success");
+  INCREMENT_COUNTER_HANDLE("mme_spgw_create_session_rsp", 1, 1, "result",
+                           "success");
   //---------------------------------------------------------
   // Process itti_sgw_create_session_response_t.bearer_context_created
   //---------------------------------------------------------
@@ -2041,6 +2043,7 @@ int mme_app_handle_mobile_reachability_timer_expiry(zloop_t* loop, int timer_id,
   // change for triggering the update
   mme_app_desc_t* mme_app_desc_p = get_mme_nas_state(false);
   put_mme_ue_state(mme_app_desc_p, ue_context_p->emm_context._imsi64, true);
+  flush_mme_nas_state();
 
   OAILOG_FUNC_RETURN(LOG_MME_APP, rc);
 }
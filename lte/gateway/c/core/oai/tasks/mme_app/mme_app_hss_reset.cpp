@@ -30,6 +30,7 @@
 #ifdef __cplusplus
 extern "C" {
 #endif
+#include "lte/gateway/c/core/common/assertions.h"
 #include "lte/gateway/c/core/common/common_defs.h"
 #include "lte/gateway/c/core/oai/common/log.h"
 #include "lte/gateway/c/core/oai/lib/hashtable/hashtable.h"
@@ -48,9 +49,7 @@ status_code_e mme_app_handle_s6a_reset_req(
     const s6a_reset_req_t* const rsr_pP) {
   status_code_e rc = RETURNok;
   struct ue_mm_context_s* ue_context_p = NULL;
-  hash_node_t* node = NULL;
-  unsigned int i = 0;
-  unsigned int num_elements = 0;
+  hashtable_key_array_t* keys = NULL;
   hash_table_ts_t* hashtblP = NULL;
 
   OAILOG_FUNC_IN(LOG_MME_APP);
@@ -68,43 +67,36 @@ status_code_e mme_app_handle_s6a_reset_req(
     OAILOG_INFO(LOG_MME_APP, "There is no Ue Context in the MME context \n");
     OAILOG_FUNC_RETURN(LOG_MME_APP, RETURNok);
   }
-  while ((num_elements < hashtblP->num_elements) && (i < hashtblP->size)) {
-    pthread_mutex_lock(&hashtblP->lock_nodes[i]);
-    if (hashtblP->nodes[i] != NULL) {
-      node = hashtblP->nodes[i];
-    }
-    pthread_mutex_unlock(&hashtblP->lock_nodes[i]);
-    while (node) {
-      num_elements++;
-      hashtable_ts_get(hashtblP, (const hash_key_t)node->key,
-                       (void**)&ue_context_p);
-      if (ue_context_p != NULL) {
-        if (ue_context_p->mm_state == UE_REGISTERED) {
-          /*
-           * set the flag: location_info_confirmed_in_hss to indicate that,
-           * hss has restarted and MME shall send ULR to hss
-           */
-          ue_context_p->location_info_confirmed_in_hss = true;
-          /*
-           * set the sgs context flag: neaf to indicate that,
-           * hss has restarted and MME shall send SGS Ue Activity Indication to
-           * MSC/VLR to indicate that activity from a UE has been detected
-           */
-          if (ue_context_p->sgs_context != NULL) {
-            ue_context_p->sgs_context->neaf = true;
-          }
+  keys = hashtable_ts_get_keys(hashtblP);
+  if (!keys) {
+    OAILOG_FUNC_RETURN(LOG_MME_APP, RETURNok);
+  }
+  for (int i = 0; i < keys->num_keys; i++) {
+    hashtable_ts_get(hashtblP, (const hash_key_t)keys->keys[i],
+                     (void**)&ue_context_p);
+    if ((ue_context_p != NULL) && (ue_context_p->mm_state == UE_REGISTERED)) {
+      /*
+       * set the flag: location_info_confirmed_in_hss to indicate that,
+       * hss has restarted and MME shall send ULR to hss
+       */
+      ue_context_p->location_info_confirmed_in_hss = true;
+      /*
+       * set the sgs context flag: neaf to indicate that,
+       * hss has restarted and MME shall send SGS Ue Activity Indication to
+       * MSC/VLR to indicate that activity from a UE has been detected
+       */
+      if (ue_context_p->sgs_context != NULL) {
+        ue_context_p->sgs_context->neaf = true;
+      }
 
-          if (ue_context_p->ecm_state == ECM_CONNECTED) {
-            /*
-             * hss has restarted and MME shall send ULR to hss for connected Ue
-             */
-            rc = mme_app_send_s6a_update_location_req(ue_context_p);
-          }
-        }
+      if (ue_context_p->ecm_state == ECM_CONNECTED) {
+        /*
+         * hss has restarted and MME shall send ULR to hss for connected Ue
+         */
+        rc = mme_app_send_s6a_update_location_req(ue_context_p);
       }
-      node = node->next;
     }
-    i++;
   }
+  FREE_HASHTABLE_KEY_ARRAY(keys);
   OAILOG_FUNC_RETURN(LOG_MME_APP, rc);
 }
@@ -468,7 +468,7 @@ static int handle_message(zloop_t* loop, zsock_t* reader, void* arg) {
 
     case TERMINATE_MESSAGE: {
       itti_free_msg_content(received_message_p);
-      free(received_message_p);
+      itti_free_msg(received_message_p);
       mme_app_exit();
     } break;
 
@@ -489,9 +489,10 @@ static int handle_message(zloop_t* loop, zsock_t* reader, void* arg) {
   if (!is_task_state_same) {
     put_mme_nas_state();
   }
+  flush_mme_nas_state();
 
   itti_free_msg_content(received_message_p);
-  free(received_message_p);
+  itti_free_msg(received_message_p);
   return 0;
 }
 
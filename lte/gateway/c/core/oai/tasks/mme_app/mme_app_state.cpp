@@ -48,6 +48,10 @@ void put_mme_nas_state() {
   MmeNasStateManager::getInstance().write_state_to_db();
 }
 
+void flush_mme_nas_state() {
+  MmeNasStateManager::getInstance().flush_state_to_db();
+}
+
 /**
  * Release the memory allocated for the MME NAS state, this does not clean the
  * state persisted in data store
@@ -142,25 +142,10 @@ void MmeNasStateManager::create_hashtables() {
               "Problem with mme_ue_s1ap_id_ue_context_htbl in MME_APP");
   btrunc(b, 0);
   bassigncstr(b, UE_ID_UE_CTXT_TABLE_NAME);
+  // The table mutex is recursive, UE context callbacks may reenter the table
   state_ue_ht = hashtable_ts_create(max_ue_htbl_lists_, nullptr,
                                     mme_app_state_free_ue_context, b);
 
-  if (!(state_ue_ht->lock_attr = (pthread_mutexattr_t*)calloc(
-            max_ue_htbl_lists_, sizeof(pthread_mutexattr_t)))) {
-    free_wrapper((void**)&state_ue_ht->lock_nodes);
-    free_wrapper((void**)&state_ue_ht->nodes);
-    free_wrapper((void**)&state_ue_ht->name);
-    free_wrapper((void**)&state_ue_ht);
-    return;
-  }
-
-  for (int i = 0; i < max_ue_htbl_lists_; i++) {
-    pthread_mutexattr_init(&state_ue_ht->lock_attr[i]);
-    pthread_mutexattr_settype(&state_ue_ht->lock_attr[i],
-                              PTHREAD_MUTEX_RECURSIVE);
-    pthread_mutex_init(&state_ue_ht->lock_nodes[i], &state_ue_ht->lock_attr[i]);
-  }
-
   btrunc(b, 0);
   bassigncstr(b, ENB_UE_ID_MME_UE_ID_TABLE_NAME);
   state_cache_p->mme_ue_contexts.enb_ue_s1ap_id_ue_context_htbl =
@@ -216,31 +201,28 @@ status_code_e MmeNasStateManager::read_ue_state_from_db() {
 #if !MME_UNIT_TEST
   if (persist_state_enabled) {
     auto keys = redis_client->get_keys("IMSI*" + task_name + "*");
-    for (const auto& key : keys) {
-      OAILOG_DEBUG(log_task, "Reading UE state from db for %s", key.c_str());
-      oai::UeContext ue_proto = oai::UeContext();
-      if (redis_client->read_proto(key, ue_proto) != RETURNok) {
-        return RETURNerror;
-      }
-      auto* ue_context = reinterpret_cast<ue_mm_context_t*>(
-          calloc(1, sizeof(ue_mm_context_t)));
-      MmeNasStateConverter::proto_to_ue(ue_proto, ue_context);
-
-      hashtable_rc_t h_rc = hashtable_ts_insert(
-          state_ue_ht, ue_context->mme_ue_s1ap_id, (void*)ue_context);
-      if (HASH_TABLE_OK != h_rc) {
-        OAILOG_ERROR(log_task,
-                     "Failed to insert UE state with key mme_ue_s1ap_id "
-                     " " MME_UE_S1AP_ID_FMT " (Error Code: %s)\n",
-                     ue_context->mme_ue_s1ap_id,
-                     hashtable_rc_code2string(h_rc));
-      } else {
-        OAILOG_DEBUG(
-            log_task,
-            "Inserted UE state with key mme_ue_s1ap_id " MME_UE_S1AP_ID_FMT,
-            ue_context->mme_ue_s1ap_id);
-      }
-    }
+    hashtable_ts_reserve(state_ue_ht, keys.size());
+    return read_ue_protos_from_db<oai::UeContext>(
+        keys, [this](const std::string& key, const oai::UeContext& ue_proto) {
+          auto* ue_context = reinterpret_cast<ue_mm_context_t*>(
+              calloc(1, sizeof(ue_mm_context_t)));
+          MmeNasStateConverter::proto_to_ue(ue_proto, ue_context);
+
+          hashtable_rc_t h_rc = hashtable_ts_insert(
+              state_ue_ht, ue_context->mme_ue_s1ap_id, (void*)ue_context);
+          if (HASH_TABLE_OK != h_rc) {
+            OAILOG_ERROR(log_task,
+                         "Failed to insert UE state with key mme_ue_s1ap_id "
+                         " " MME_UE_S1AP_ID_FMT " (Error Code: %s)\n",
+                         ue_context->mme_ue_s1ap_id,
+                         hashtable_rc_code2string(h_rc));
+          } else {
+            OAILOG_DEBUG(
+                log_task,
+                "Inserted UE state with key mme_ue_s1ap_id " MME_UE_S1AP_ID_FMT,
+                ue_context->mme_ue_s1ap_id);
+          }
+        });
   }
 #endif
   return RETURNok;
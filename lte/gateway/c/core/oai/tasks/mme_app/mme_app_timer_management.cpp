@@ -112,15 +112,15 @@ namespace lte {
 int MmeUeContext::StartTimer(size_t msec, timer_repeat_t repeat,
                              zloop_timer_fn handler, const TimerArgType& arg) {
   int timer_id = -1;
-  if ((timer_id = start_timer(&mme_app_task_zmq_ctx, msec, repeat, handler,
-                              nullptr)) != -1) {
+  if ((timer_id = start_wheel_timer(&mme_app_task_zmq_ctx, msec, repeat,
+                                    handler, nullptr)) != -1) {
     mme_app_timers.insert(std::pair<int, TimerArgType>(timer_id, arg));
   }
   return timer_id;
 }
 //------------------------------------------------------------------------------
 void MmeUeContext::StopTimer(int timer_id) {
-  stop_timer(&mme_app_task_zmq_ctx, timer_id);
+  stop_wheel_timer(&mme_app_task_zmq_ctx, timer_id);
   mme_app_timers.erase(timer_id);
 }
 //------------------------------------------------------------------------------
@@ -85,6 +85,7 @@ void log_config_init(log_config_t* log_conf) {
 
   log_conf->output = NULL;
   log_conf->is_output_thread_safe = false;
+  log_conf->is_output_binary = false;
   log_conf->color = false;
 
   log_conf->udp_log_level = MAX_LOG_LEVEL;  // Means invalid TODO wtf
@@ -137,6 +138,7 @@ void s6a_config_init(s6a_config_t* s6a_conf) {
 void itti_config_init(itti_config_t* itti_conf) {
   itti_conf->queue_size = ITTI_QUEUE_MAX_ELEMENTS;
   itti_conf->log_file = NULL;
+  itti_conf->ring_transport = false;
 }
 
 void sctp_config_init(sctp_config_t* sctp_conf) {
@@ -144,6 +146,7 @@ void sctp_config_init(sctp_config_t* sctp_conf) {
       bfromcstr(MME_CONFIG_STRING_SCTP_UPSTREAM_SOCK);
   sctp_conf->downstream_sctp_sock =
       bfromcstr(MME_CONFIG_STRING_SCTP_DOWNSTREAM_SOCK_DEFAULT);
+  sctp_conf->downstream_streaming = false;
 }
 
 void apn_map_config_init(apn_map_config_t* apn_map_config) {
@@ -384,6 +387,14 @@ void parse_sctp_settings(config_setting_t* setting_mme,
     downstream_sock = astring;
   }
 
+  astring = NULL;
+  if ((config_setting_lookup_string(setting,
+                                    MME_CONFIG_STRING_SCTP_DOWNSTREAM_STREAMING,
+                                    (const char**)&astring)) &&
+      (astring != NULL)) {
+    config_pP->sctp_config.downstream_streaming = parse_bool(astring);
+  }
+
   // TODO(smoeller): This should be pulled out into a function of bstrlib
   if (config_pP->sctp_config.upstream_sctp_sock) {
     bassigncstr(config_pP->sctp_config.upstream_sctp_sock, upstream_sock);
@@ -571,6 +582,14 @@ int mme_config_parse_string(const char* config_string,
         }
       }
 
+      if (config_setting_lookup_string(setting,
+                                       LOG_CONFIG_STRING_OUTPUT_BINARY,
+                                       (const char**)&astring)) {
+        if (astring != NULL) {
+          config_pP->log_config.is_output_binary = parse_bool(astring);
+        }
+      }
+
       if (config_setting_lookup_string(setting, LOG_CONFIG_STRING_COLOR,
                                        (const char**)&astring)) {
         if (strcasecmp("yes", astring) == 0)
@@ -810,6 +829,18 @@ int mme_config_parse_string(const char* config_string,
               &aint))) {
         config_pP->itti_config.queue_size = (uint32_t)aint;
       }
+      if ((config_setting_lookup_string(
+              setting, MME_CONFIG_STRING_INTERTASK_INTERFACE_TRANSPORT,
+              (const char**)&astring))) {
+        if (strcasecmp(astring, "ring") == 0) {
+          config_pP->itti_config.ring_transport = true;
+        } else if (strcasecmp(astring, "zmq") == 0) {
+          config_pP->itti_config.ring_transport = false;
+        } else {
+          Fatal("Error in config file: got \"%s\" but expected zmq or ring\n",
+                astring);
+        }
+      }
     }
 #if !S6A_OVER_GRPC
     // S6A SETTING
@@ -1931,6 +1962,8 @@ void mme_config_display(mme_config_t* config_pP) {
               config_pP->itti_config.queue_size);
   OAILOG_INFO(LOG_CONFIG, "    log file .........: %s\n",
               bdata(config_pP->itti_config.log_file));
+  OAILOG_INFO(LOG_CONFIG, "    transport ........: %s\n",
+              config_pP->itti_config.ring_transport ? "ring" : "zmq");
   OAILOG_INFO(LOG_CONFIG, "- SCTP:\n");
   OAILOG_INFO(LOG_CONFIG, "  upstream_sctp_sock..: %s\n",
               bdata(config_pP->sctp_config.upstream_sctp_sock));
@@ -2088,6 +2121,8 @@ void mme_config_display(mme_config_t* config_pP) {
               bdata(config_pP->log_config.output));
   OAILOG_INFO(LOG_CONFIG, "    Output thread safe ..: %s\n",
               (config_pP->log_config.is_output_thread_safe) ? "true" : "false");
+  OAILOG_INFO(LOG_CONFIG, "    Output binary .......: %s\n",
+              (config_pP->log_config.is_output_binary) ? "true" : "false");
   OAILOG_INFO(LOG_CONFIG, "    Output with color ...: %s\n",
               (config_pP->log_config.color) ? "true" : "false");
   OAILOG_INFO(LOG_CONFIG, "    UDP log level........: %s\n",
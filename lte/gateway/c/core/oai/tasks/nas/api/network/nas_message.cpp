@@ -51,6 +51,9 @@ extern "C" {
 
 #define SR_MAC_SIZE_BYTES 2
 
+/* Plain NAS messages up to this size are encoded and decoded on the stack */
+#define NAS_MESSAGE_STACK_BUFFER_SIZE 2048
+
 /* Functions used to decode layer 3 NAS messages */
 
 static int nas_message_plain_decode(const unsigned char* buffer,
@@ -818,8 +821,14 @@ static int nas_message_protected_decode(
     nas_message_decode_status_t* const status) {
   OAILOG_FUNC_IN(LOG_NAS);
   int bytes = TLV_BUFFER_TOO_SHORT;
-  unsigned char* const plain_msg = (unsigned char*)calloc(1, length);
+  unsigned char stack_msg[NAS_MESSAGE_STACK_BUFFER_SIZE];
+  unsigned char* plain_msg = stack_msg;
 
+  if (length > sizeof(stack_msg)) {
+    plain_msg = (unsigned char*)calloc(1, length);
+  } else {
+    memset(plain_msg, 0, length);
+  }
   if (plain_msg) {
     /*
      * Decrypt the security protected NAS message
@@ -832,7 +841,9 @@ static int nas_message_protected_decode(
      * Decode the decrypted message as plain NAS message
      */
     bytes = nas_message_plain_decode(plain_msg, header, msg, length);
-    free_wrapper((void**)&plain_msg);
+    if (plain_msg != stack_msg) {
+      free_wrapper((void**)&plain_msg);
+    }
   }
 
   OAILOG_FUNC_RETURN(LOG_NAS, bytes);
@@ -981,8 +992,14 @@ static int nas_message_protected_encode(
   emm_security_context_t* emm_security_context =
       (emm_security_context_t*)security;
   int bytes = TLV_BUFFER_TOO_SHORT;
-  unsigned char* plain_msg = (unsigned char*)calloc(1, length);
+  unsigned char stack_msg[NAS_MESSAGE_STACK_BUFFER_SIZE];
+  unsigned char* plain_msg = stack_msg;
 
+  if (length > sizeof(stack_msg)) {
+    plain_msg = (unsigned char*)calloc(1, length);
+  } else {
+    memset(plain_msg, 0, length);
+  }
   if (plain_msg) {
     /*
      * Encode the security protected NAS message as plain NAS message
@@ -1003,7 +1020,9 @@ static int nas_message_protected_encode(
       // seq ++;
     }
 
-    free_wrapper((void**)&plain_msg);
+    if (plain_msg != stack_msg) {
+      free_wrapper((void**)&plain_msg);
+    }
   }
 
   OAILOG_FUNC_RETURN(LOG_NAS, bytes);
@@ -1153,7 +1172,10 @@ static int nas_message_decrypt_a(
              * length in bits
              */
             stream_cipher.blength = length << 3;
-            nas_stream_encrypt_eea2(&stream_cipher, (uint8_t*)dest);
+            nas_stream_encrypt_eea2_ctx(
+                nas_stream_aes_ctx_get(&emm_security_context->knas_enc_aes,
+                                       emm_security_context->knas_enc),
+                &stream_cipher, (uint8_t*)dest);
             /*
              * Decode the first octet (security header type or EPS bearer
              * identity,
@@ -1332,7 +1354,10 @@ static int nas_message_encrypt_a(
            * length in bits
            */
           stream_cipher.blength = length << 3;
-          nas_stream_encrypt_eea2(&stream_cipher, (uint8_t*)dest);
+          nas_stream_encrypt_eea2_ctx(
+              nas_stream_aes_ctx_get(&emm_security_context->knas_enc_aes,
+                                     emm_security_context->knas_enc),
+              &stream_cipher, (uint8_t*)dest);
           OAILOG_FUNC_RETURN(LOG_NAS, length);
         } break;
 
@@ -1483,7 +1508,10 @@ static uint32_t nas_message_get_mac(
        * length in bits
        */
       stream_cipher.blength = length << 3;
-      nas_stream_encrypt_eia2(&stream_cipher, mac);
+      nas_stream_encrypt_eia2_ctx(
+          nas_stream_aes_ctx_get(&emm_security_context->knas_int_aes,
+                                 emm_security_context->knas_int),
+          &stream_cipher, mac);
       OAILOG_DEBUG(
           LOG_NAS,
           "NAS_SECURITY_ALGORITHMS_EIA2 returned MAC %x.%x.%x.%x(%u) for "
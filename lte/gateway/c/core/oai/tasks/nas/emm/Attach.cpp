@@ -800,7 +800,8 @@ status_code_e emm_proc_attach_complete(
                   "\n",
                   ue_id);
       emm_proc_emm_information(ue_mm_context);
-      increment_counter("ue_attach", 1, 1, "result", "attach_proc_successful");
+      INCREMENT_COUNTER_HANDLE("ue_attach", 1, 1, "result",
+                               "attach_proc_successful");
       attach_success_event(ue_mm_context->emm_context._imsi64);
     }
   } else if (esm_sap.err != ESM_SAP_DISCARDED) {
@@ -1789,7 +1790,7 @@ static status_code_e emm_send_attach_accept(emm_context_t* emm_context) {
     OAILOG_WARNING(LOG_NAS_EMM, "ue_mm_context NULL\n");
   }
 
-  increment_counter("ue_attach", 1, 1, "action", "attach_accept_sent");
+  INCREMENT_COUNTER_HANDLE("ue_attach", 1, 1, "action", "attach_accept_sent");
   OAILOG_FUNC_RETURN(LOG_NAS_EMM, rc);
 }
 
@@ -265,6 +265,10 @@ status_code_e emm_proc_security_mode_control(
           emm_ctx->_vector[emm_ctx->_security.eksi % MAX_EPS_AUTH_VECTORS]
               .kasme,
           emm_ctx->_security.knas_enc);
+      nas_stream_aes_ctx_init(&emm_ctx->_security.knas_int_aes,
+                              emm_ctx->_security.knas_int);
+      nas_stream_aes_ctx_init(&emm_ctx->_security.knas_enc_aes,
+                              emm_ctx->_security.knas_enc);
       /*
        * Set new security context indicator
        */
@@ -43,6 +43,7 @@ Description Defines internal private data handled by EPS Mobility
 #include "lte/gateway/c/core/oai/lib/gtpv2-c/nwgtpv2c-0.11/include/queue.h"
 #include "lte/gateway/c/core/oai/lib/hashtable/hashtable.h"
 #include "lte/gateway/c/core/oai/lib/hashtable/obj_hashtable.h"
+#include "lte/gateway/c/core/oai/lib/secu/nas_stream_aes.h"
 #include "lte/gateway/c/core/oai/tasks/nas/emm/sap/emm_fsm.hpp"
 #include "lte/gateway/c/core/oai/tasks/nas/esm/esm_data.hpp"
 #include "lte/gateway/c/core/oai/tasks/nas/ies/AdditionalUpdateType.hpp"
@@ -81,6 +82,9 @@ typedef struct emm_security_context_s {
   int vector_index;                     /* Pointer on vector */
   uint8_t knas_enc[AUTH_KNAS_ENC_SIZE]; /* NAS cyphering key               */
   uint8_t knas_int[AUTH_KNAS_INT_SIZE]; /* NAS integrity key               */
+  /* Key schedules of knas_enc and knas_int for EEA2 and EIA2 */
+  nas_stream_aes_ctx_t knas_enc_aes;
+  nas_stream_aes_ctx_t knas_int_aes;
 
   struct count_s {
     uint32_t spare : 8;
@@ -198,7 +198,7 @@ status_code_e emm_recv_attach_request(
               "EMMAS-SAP - Received Attach Request message for ue "
               "id " MME_UE_S1AP_ID_FMT "\n",
               ue_id);
-  increment_counter("ue_attach", 1, NO_LABELS);
+  INCREMENT_COUNTER_HANDLE("ue_attach", 1, NO_LABELS);
 
   /*
    * Handle message checking error
@@ -258,16 +258,17 @@ status_code_e emm_recv_attach_request(
    */
   params->type = EMM_ATTACH_TYPE_RESERVED;
   if (msg->epsattachtype == EPS_ATTACH_TYPE_EPS) {
-    increment_counter("ue_attach", 1, 1, "attach_type", "eps_attach");
+    INCREMENT_COUNTER_HANDLE("ue_attach", 1, 1, "attach_type", "eps_attach");
     params->type = EMM_ATTACH_TYPE_EPS;
 
   } else if (msg->epsattachtype == EPS_ATTACH_TYPE_COMBINED_EPS_IMSI) {
-    increment_counter("ue_attach", 1, 1, "attach_type",
-                      "combined_eps_imsi_attach");
+    INCREMENT_COUNTER_HANDLE("ue_attach", 1, 1, "attach_type",
+                             "combined_eps_imsi_attach");
     params->type = EMM_ATTACH_TYPE_COMBINED_EPS_IMSI;
   } else if (msg->epsattachtype == EPS_ATTACH_TYPE_EMERGENCY) {
     params->type = EMM_ATTACH_TYPE_EMERGENCY;
-    increment_counter("ue_attach", 1, 1, "attach_type", "emergency_attach");
+    INCREMENT_COUNTER_HANDLE("ue_attach", 1, 1, "attach_type",
+                             "emergency_attach");
   } else if (msg->epsattachtype == EPS_ATTACH_TYPE_RESERVED) {
     params->type = EMM_ATTACH_TYPE_RESERVED;
   } else {
@@ -584,7 +585,7 @@ status_code_e emm_recv_detach_request(
   /*
    * Execute the UE initiated detach procedure completion by the network
    */
-  increment_counter("ue_detach", 1, 1, "cause", "ue_initiated");
+  INCREMENT_COUNTER_HANDLE("ue_detach", 1, 1, "cause", "ue_initiated");
   // Send the SGS Detach indication towards MME App
   rc = emm_proc_sgs_detach_request(ue_id,
                                    (emm_proc_sgs_detach_type_t)params.type);
@@ -835,7 +836,7 @@ status_code_e emm_recv_service_request(
   rc = emm_initiate_default_bearer_re_establishment(emm_ctx);
   if (rc == RETURNok) {
     *emm_cause = EMM_CAUSE_SUCCESS;
-    increment_counter("service_request", 1, 1, "result", "success");
+    INCREMENT_COUNTER_HANDLE("service_request", 1, 1, "result", "success");
   } else {
     increment_counter("service_request", 1, 2, "result", "failure", "cause",
                       "bearer_reestablish_failure");
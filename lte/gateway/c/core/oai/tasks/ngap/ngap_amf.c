@@ -154,7 +154,7 @@ static int handle_message(zloop_t* loop, zsock_t* reader, void* arg) {
 
     case TERMINATE_MESSAGE: {
       itti_free_msg_content(received_message_p);
-      free(received_message_p);
+      itti_free_msg(received_message_p);
       ngap_amf_exit();
     } break;
 
@@ -222,8 +222,9 @@ static int handle_message(zloop_t* loop, zsock_t* reader, void* arg) {
     put_ngap_imsi_map();
     put_ngap_ue_state(imsi64);
   }
+  flush_ngap_state();
   itti_free_msg_content(received_message_p);
-  free(received_message_p);
+  itti_free_msg(received_message_p);
   return 0;
 }
 
@@ -52,6 +52,8 @@ void ngap_state_exit() { NgapStateManager::getInstance().free_state(); }
 
 void put_ngap_state() { NgapStateManager::getInstance().write_state_to_db(); }
 
+void flush_ngap_state() { NgapStateManager::getInstance().flush_state_to_db(); }
+
 gnb_description_t* ngap_state_get_gnb(ngap_state_t* state,
                                       sctp_assoc_id_t assoc_id) {
   OAILOG_FUNC_IN(LOG_NGAP);
@@ -37,6 +37,8 @@ ngap_state_t* get_ngap_state(bool read_from_db);
 
 void put_ngap_state(void);
 
+void flush_ngap_state(void);
+
 gnb_description_t* ngap_state_get_gnb(ngap_state_t* state,
                                       sctp_assoc_id_t assoc_id);
 
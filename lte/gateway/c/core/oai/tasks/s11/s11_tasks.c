@@ -240,7 +240,7 @@ static int handle_message(zloop_t* loop, zsock_t* reader, void* arg) {
 
     case TERMINATE_MESSAGE: {
       itti_free_msg_content(received_message_p);
-      free(received_message_p);
+      itti_free_msg(received_message_p);
       s11_mme_exit();
     } break;
 
@@ -259,6 +259,20 @@ static int handle_message(zloop_t* loop, zsock_t* reader, void* arg) {
       DevAssert(rc == NW_OK);
     } break;
 
+    case UDP_DATA_BATCH_IND: {
+      udp_data_batch_ind_t* udp_data_batch_ind =
+          &received_message_p->ittiMsg.udp_data_batch_ind;
+
+      for (uint32_t i = 0; i < udp_data_batch_ind->num_datagrams; i++) {
+        udp_datagram_t* datagram = &udp_data_batch_ind->datagrams[i];
+        nw_rc_t rc = nwGtpv2cProcessUdpReq(
+            s11_mme_stack_handle, datagram->buffer, datagram->buffer_length,
+            udp_data_batch_ind->local_port, datagram->peer_port,
+            (struct sockaddr*)&datagram->sock_addr);
+        DevAssert(rc == NW_OK);
+      }
+    } break;
+
     default:
       OAILOG_ERROR(LOG_S11, "Unknown message ID %d:%s\n",
                    ITTI_MSG_ID(received_message_p),
@@ -267,7 +281,7 @@ static int handle_message(zloop_t* loop, zsock_t* reader, void* arg) {
   }
 
   itti_free_msg_content(received_message_p);
-  free(received_message_p);
+  itti_free_msg(received_message_p);
   return 0;
 }
 
@@ -287,7 +287,7 @@ static int handle_message(zloop_t* loop, zsock_t* reader, void* arg) {
 
     case TERMINATE_MESSAGE: {
       itti_free_msg_content(received_message_p);
-      free(received_message_p);
+      itti_free_msg(received_message_p);
       s1ap_mme_exit();
     } break;
 
@@ -298,16 +298,18 @@ static int handle_message(zloop_t* loop, zsock_t* reader, void* arg) {
     } break;
   }
 
-  if (!is_task_state_same) {
+  // Handlers mark the eNB associations they modify in place
+  if (!is_task_state_same || s1ap_state_is_dirty()) {
     put_s1ap_state();
   }
   if (!is_ue_state_same) {
     put_s1ap_imsi_map();
     put_s1ap_ue_state(imsi64);
   }
+  flush_s1ap_state();
 
   itti_free_msg_content(received_message_p);
-  free(received_message_p);
+  itti_free_msg(received_message_p);
   return 0;
 }
 
@@ -365,6 +367,7 @@ static void s1ap_mme_exit(void) {
 
   put_s1ap_state();
   put_s1ap_imsi_map();
+  flush_s1ap_state();
 
   s1ap_state_exit();
 
@@ -435,6 +438,7 @@ oai::UeDescription* s1ap_new_ue(oai::EnbDescription* enb_ref,
   }
   // Increment number of UE
   enb_ref->set_nb_ue_associated((enb_ref->nb_ue_associated() + 1));
+  s1ap_state_mark_enb_dirty(enb_ref);
   OAILOG_DEBUG(LOG_S1AP, "Num ue associated: %d on assoc id:%d",
                enb_ref->nb_ue_associated(), sctp_assoc_id);
   return ue_ref;
@@ -442,25 +446,25 @@ oai::UeDescription* s1ap_new_ue(oai::EnbDescription* enb_ref,
 
 //------------------------------------------------------------------------------
 void s1ap_remove_ue(oai::S1apState* state, oai::UeDescription* ue_ref) {
-  oai::EnbDescription enb_ref;
   // NULL reference...
   if (ue_ref == nullptr) return;
 
   mme_ue_s1ap_id_t mme_ue_s1ap_id = ue_ref->mme_ue_s1ap_id();
-  if ((s1ap_state_get_enb(state, ue_ref->sctp_assoc_id(), &enb_ref)) !=
-      PROTO_MAP_OK) {
+  oai::EnbDescription* enb_ref =
+      s1ap_state_get_enb(state, ue_ref->sctp_assoc_id());
+  if (enb_ref == nullptr) {
     OAILOG_ERROR(LOG_S1AP, "Failed to get enb association for assoc_id: %u",
                  ue_ref->sctp_assoc_id());
     return;
   }
-  DevAssert(enb_ref.nb_ue_associated() > 0);
+  DevAssert(enb_ref->nb_ue_associated() > 0);
   // Updating number of UE
-  enb_ref.set_nb_ue_associated((enb_ref.nb_ue_associated() - 1));
+  enb_ref->set_nb_ue_associated((enb_ref->nb_ue_associated() - 1));
   OAILOG_TRACE(LOG_S1AP,
                "Removing UE enb_ue_s1ap_id: " ENB_UE_S1AP_ID_FMT
                " mme_ue_s1ap_id:" MME_UE_S1AP_ID_FMT " in eNB id : %d\n",
                ue_ref->enb_ue_s1ap_id(), ue_ref->mme_ue_s1ap_id(),
-               enb_ref.enb_id);
+               enb_ref->enb_id());
 
   ue_ref->set_s1ap_ue_state(oai::S1AP_UE_INVALID_STATE);
   if (ue_ref->s1ap_ue_context_rel_timer().id() != S1AP_TIMER_INACTIVE_ID) {
@@ -479,7 +483,7 @@ void s1ap_remove_ue(oai::S1apState* state, oai::UeDescription* ue_ref) {
   mmeid2associd_map.remove(mme_ue_s1ap_id);
 
   magma::proto_map_uint32_uint64_t ue_id_coll;
-  ue_id_coll.map = enb_ref.mutable_ue_id_map();
+  ue_id_coll.map = enb_ref->mutable_ue_id_map();
   ue_id_coll.remove(mme_ue_s1ap_id);
 
   imsi64_t imsi64 = INVALID_IMSI64;
@@ -490,20 +494,22 @@ void s1ap_remove_ue(oai::S1apState* state, oai::UeDescription* ue_ref) {
   ueid_imsi_map.remove(mme_ue_s1ap_id);
 
   OAILOG_DEBUG(LOG_S1AP, "Num UEs associated %u num elements in ue_id_coll %lu",
-               enb_ref.nb_ue_associated(), ue_id_coll.size());
-  if (!enb_ref.nb_ue_associated()) {
-    if (enb_ref.s1_enb_state() == oai::S1AP_RESETING) {
+               enb_ref->nb_ue_associated(), ue_id_coll.size());
+  if (!enb_ref->nb_ue_associated()) {
+    if (enb_ref->s1_enb_state() == oai::S1AP_RESETING) {
       OAILOG_INFO(LOG_S1AP, "Moving eNB state to S1AP_INIT \n");
-      enb_ref.set_s1_state(oai::S1AP_INIT);
-      set_gauge("s1_connection", 0, 1, "enb_name", enb_ref.enb_name().c_str());
+      enb_ref->set_s1_state(oai::S1AP_INIT);
+      set_gauge("s1_connection", 0, 1, "enb_name", enb_ref->enb_name().c_str());
       state->set_num_enbs(state->num_enbs() - 1);
-    } else if (enb_ref.s1_enb_state() == oai::S1AP_SHUTDOWN) {
+    } else if (enb_ref->s1_enb_state() == oai::S1AP_SHUTDOWN) {
       OAILOG_INFO(LOG_S1AP, "Deleting eNB \n");
-      set_gauge("s1_connection", 0, 1, "enb_name", enb_ref.enb_name().c_str());
-      s1ap_remove_enb(state, &enb_ref);
+      set_gauge("s1_connection", 0, 1, "enb_name", enb_ref->enb_name().c_str());
+      s1ap_remove_enb(state, enb_ref);
+      // enb_ref is freed with the association
+      return;
     }
   }
-  s1ap_state_update_enb_map(state, enb_ref.sctp_assoc_id(), &enb_ref);
+  s1ap_state_mark_enb_dirty(enb_ref);
 }
 
 //------------------------------------------------------------------------------
@@ -519,6 +525,7 @@ void s1ap_remove_enb(oai::S1apState* state, oai::EnbDescription* enb_ref) {
   ue_id_coll.clear();
   OAILOG_INFO(LOG_S1AP, "Deleting eNB on assoc_id :%u\n",
               enb_ref->sctp_assoc_id());
+  s1ap_state_mark_enb_dirty(enb_ref);
   enb_map.map = state->mutable_enbs();
   enb_map.remove(enb_ref->sctp_assoc_id());
   state->set_num_enbs(state->num_enbs() - 1);
@@ -28,6 +28,7 @@
 #include <stdint.h>
 #include <netinet/in.h>
 #include <string.h>
+#include <vector>
 
 #ifdef __cplusplus
 extern "C" {
@@ -384,50 +385,46 @@ status_code_e s1ap_mme_generate_s1_setup_failure(const sctp_assoc_id_t assoc_id,
 
 void clean_stale_enb_state(oai::S1apState* state,
                            oai::EnbDescription* new_enb_association) {
-  oai::EnbDescription stale_enb_association;
-  oai::EnbDescription enb_association;
+  oai::EnbDescription* stale_enb_association = nullptr;
 
   proto_map_uint32_enb_description_t enb_map;
   enb_map.map = state->mutable_enbs();
-  bool delete_state_enb = false;
 
   for (auto itr = enb_map.map->begin(); itr != enb_map.map->end(); itr++) {
-    stale_enb_association = itr->second;
-    if ((stale_enb_association.sctp_assoc_id() !=
+    if ((itr->second.sctp_assoc_id() !=
          new_enb_association->sctp_assoc_id()) &&
-        (stale_enb_association.enb_id() == new_enb_association->enb_id())) {
+        (itr->second.enb_id() == new_enb_association->enb_id())) {
+      stale_enb_association = &itr->second;
       OAILOG_INFO(LOG_S1AP, "Found stale eNB at association id %u",
-                  stale_enb_association.sctp_assoc_id());
-      delete_state_enb = true;
+                  stale_enb_association->sctp_assoc_id());
       break;
     }
   }
-  if (!delete_state_enb) {
+  if (stale_enb_association == nullptr) {
     return;
   }
 
   OAILOG_INFO(LOG_S1AP, "Found stale eNB at association id %u",
-              stale_enb_association.sctp_assoc_id());
+              stale_enb_association->sctp_assoc_id());
 
-  magma::proto_map_uint32_uint64_t ue_id_coll;
-  ue_id_coll.map = stale_enb_association.mutable_ue_id_map();
   // Remove the S1 context for UEs associated with old eNB association
-  if (ue_id_coll.size()) {
-    oai::UeDescription* ue_ref = nullptr;
-    for (auto itr_map = ue_id_coll.map->begin();
-         itr_map != ue_id_coll.map->end(); ++itr_map) {
-      ue_ref = s1ap_state_get_ue_mmeid((mme_ue_s1ap_id_t)itr_map->first);
-      /* The function s1ap_remove_ue will take care of removing the enb also,
-       * when the last UE is removed
-       */
-      s1ap_remove_ue(state, ue_ref);
+  if (stale_enb_association->ue_id_map_size()) {
+    // s1ap_remove_ue updates the ue_id_map, and removes the eNB with its last
+    // UE when it is shutting down
+    std::vector<mme_ue_s1ap_id_t> mme_ue_s1ap_ids;
+    mme_ue_s1ap_ids.reserve(stale_enb_association->ue_id_map_size());
+    for (const auto& ue_id : stale_enb_association->ue_id_map()) {
+      mme_ue_s1ap_ids.push_back((mme_ue_s1ap_id_t)ue_id.first);
+    }
+    for (mme_ue_s1ap_id_t mme_ue_s1ap_id : mme_ue_s1ap_ids) {
+      s1ap_remove_ue(state, s1ap_state_get_ue_mmeid(mme_ue_s1ap_id));
     }
   } else {
     // Remove the old eNB association
     OAILOG_INFO(LOG_S1AP, "Deleting eNB: %s (Sctp_assoc_id = %u)",
-                stale_enb_association.enb_name().c_str(),
-                stale_enb_association.sctp_assoc_id());
-    s1ap_remove_enb(state, &stale_enb_association);
+                stale_enb_association->enb_name().c_str(),
+                stale_enb_association->sctp_assoc_id());
+    s1ap_remove_enb(state, stale_enb_association);
   }
 
   OAILOG_DEBUG(LOG_S1AP, "Removed stale eNB and all associated UEs.");
@@ -466,7 +463,7 @@ status_code_e s1ap_mme_handle_s1_setup_request(oai::S1apState* state,
   S1ap_S1SetupRequestIEs_t* ie_supported_tas = NULL;
   S1ap_S1SetupRequestIEs_t* ie_default_paging_drx = NULL;
 
-  oai::EnbDescription enb_association;
+  oai::EnbDescription* enb_association = nullptr;
   uint32_t enb_id = 0;
   char* enb_name = NULL;
   int ta_ret = 0;
@@ -524,7 +521,8 @@ status_code_e s1ap_mme_handle_s1_setup_request(oai::S1apState* state,
    * this message when the s1 interface of the MME is in RESETTING stage then we
    * return S1ap_TimeToWait_v20s.
    */
-  if ((s1ap_state_get_enb(state, assoc_id, &enb_association)) != PROTO_MAP_OK) {
+  enb_association = s1ap_state_get_enb(state, assoc_id);
+  if (enb_association == nullptr) {
     /*
      *
      * This should not happen as the thread processing new associations is the
@@ -536,15 +534,15 @@ status_code_e s1ap_mme_handle_s1_setup_request(oai::S1apState* state,
   }
 
   magma::proto_map_uint32_uint64_t ue_id_coll;
-  ue_id_coll.map = enb_association.mutable_ue_id_map();
-  if (enb_association.s1_enb_state() == oai::S1AP_RESETING ||
-      enb_association.s1_enb_state() == oai::S1AP_SHUTDOWN) {
+  ue_id_coll.map = enb_association->mutable_ue_id_map();
+  if (enb_association->s1_enb_state() == oai::S1AP_RESETING ||
+      enb_association->s1_enb_state() == oai::S1AP_SHUTDOWN) {
     OAILOG_WARNING(LOG_S1AP,
                    "Ignoring s1setup from eNB in state %s on assoc id %u",
-                   s1_enb_state2str(enb_association.s1_enb_state()), assoc_id);
+                   s1_enb_state2str(enb_association->s1_enb_state()), assoc_id);
     OAILOG_DEBUG(LOG_S1AP,
                  "Num UEs associated %u num elements in ue_id_coll %zu",
-                 enb_association.nb_ue_associated(), ue_id_coll.size());
+                 enb_association->nb_ue_associated(), ue_id_coll.size());
     rc = s1ap_mme_generate_s1_setup_failure(
         assoc_id, S1ap_Cause_PR_transport,
         S1ap_CauseTransport_transport_resource_unavailable,
@@ -560,12 +558,12 @@ status_code_e s1ap_mme_handle_s1_setup_request(oai::S1apState* state,
     if (ue_id_coll.size() == 0) {
       OAILOG_FUNC_RETURN(LOG_S1AP,
                          s1ap_clear_ue_ctxt_for_unknown_mme_ue_s1ap_id(
-                             state, enb_association.sctp_assoc_id()));
+                             state, enb_association->sctp_assoc_id()));
     }
     arg_s1ap_send_enb_dereg_ind_t arg = {0};
     MessageDef* message_p = NULL;
 
-    arg.associated_enb_id = enb_association.enb_id();
+    arg.associated_enb_id = enb_association->enb_id();
     arg.deregister_ue_count = ue_id_coll.size();
     ue_id_coll.map_apply_callback_on_all_elements(
         s1ap_send_enb_deregistered_ind, reinterpret_cast<void*>(&arg),
@@ -650,7 +648,7 @@ status_code_e s1ap_mme_handle_s1_setup_request(oai::S1apState* state,
 
   S1ap_SupportedTAs_t* ta_list = &ie_supported_tas->value.choice.SupportedTAs;
   oai::SupportedTaList* supported_ta_list_proto =
-      enb_association.mutable_supported_ta_list();
+      enb_association->mutable_supported_ta_list();
   supported_ta_list_proto->set_list_count(ta_list->list.count);
 
   /* Storing supported TAI lists received in S1 SETUP REQUEST message */
@@ -682,32 +680,32 @@ status_code_e s1ap_mme_handle_s1_setup_request(oai::S1apState* state,
                "Adding eNB with enb_id :%d to the list of served eNBs \n",
                enb_id);
 
-  enb_association.set_enb_id(enb_id);
+  enb_association->set_enb_id(enb_id);
 
   S1AP_FIND_PROTOCOLIE_BY_ID(S1ap_S1SetupRequestIEs_t, ie_default_paging_drx,
                              container, S1ap_ProtocolIE_ID_id_DefaultPagingDRX,
                              true);
 
-  enb_association.set_default_paging_drx(
+  enb_association->set_default_paging_drx(
       ie_default_paging_drx->value.choice.PagingDRX);
 
   if (enb_name != NULL) {
-    enb_association.set_enb_name(ie_enb_name->value.choice.ENBname.buf,
-                                 ie_enb_name->value.choice.ENBname.size);
+    enb_association->set_enb_name(ie_enb_name->value.choice.ENBname.buf,
+                                  ie_enb_name->value.choice.ENBname.size);
   }
 
   // Clean any stale eNB association (from Redis) for this enb_id
-  clean_stale_enb_state(state, &enb_association);
+  clean_stale_enb_state(state, enb_association);
 
-  rc = s1ap_generate_s1_setup_response(state, &enb_association);
+  rc = s1ap_generate_s1_setup_response(state, enb_association);
   if (rc == RETURNok) {
     state->set_num_enbs(state->num_enbs() + 1);
     set_gauge("s1_connection", 1, 1, "enb_name",
-              enb_association.enb_name().c_str());
+              enb_association->enb_name().c_str());
     increment_counter("s1_setup", 1, 1, "result", "success");
     s1_setup_success_event(enb_name, enb_id);
   }
-  s1ap_state_update_enb_map(state, assoc_id, &enb_association);
+  s1ap_state_mark_enb_dirty(enb_association);
   OAILOG_FUNC_RETURN(LOG_S1AP, rc);
 }
 
@@ -1063,9 +1061,9 @@ status_code_e s1ap_mme_handle_initial_context_setup_response(
     // information. This feature can be safely used only when NAT uses the same
     // public IP address for both the CP and UP communication to/from the eNB,
     // which typically is the situation.
-    oai::EnbDescription enb_association;
-    if ((s1ap_state_get_enb(state, assoc_id, &enb_association)) !=
-        PROTO_MAP_OK) {
+    const oai::EnbDescription* enb_association =
+        s1ap_state_get_enb(state, assoc_id);
+    if (enb_association == nullptr) {
       OAILOG_ERROR(LOG_S1AP, "Failed to get enb_association for assoc_id:%u",
                    assoc_id);
       OAILOG_FUNC_RETURN(LOG_S1AP, RETURNerror);
@@ -1076,14 +1074,14 @@ status_code_e s1ap_mme_handle_initial_context_setup_response(
       MME_APP_INITIAL_CONTEXT_SETUP_RSP(message_p)
           .e_rab_setup_list.item[item]
           .transport_layer_address =
-          blk2bstr(enb_association.ran_cp_ipaddr().c_str(),
-                   enb_association.ran_cp_ipaddr_sz());
+          blk2bstr(enb_association->ran_cp_ipaddr().c_str(),
+                   enb_association->ran_cp_ipaddr_sz());
     } else {
       // Print a warning message if CP and UP plane eNB IPs are different
-      if (memcmp(enb_association.ran_cp_ipaddr().c_str(),
+      if (memcmp(enb_association->ran_cp_ipaddr().c_str(),
                  eRABSetupItemCtxtSURes_p->value.choice.E_RABSetupItemCtxtSURes
                      .transportLayerAddress.buf,
-                 enb_association.ran_cp_ipaddr_sz())) {
+                 enb_association->ran_cp_ipaddr_sz())) {
         OAILOG_WARNING(
             LOG_S1AP,
             "GTP-U eNB IP addr is different than SCTP eNB IP addr. "
@@ -1134,7 +1132,7 @@ status_code_e s1ap_mme_handle_ue_context_release_request(
   S1ap_UEContextReleaseRequest_t* container;
   S1ap_UEContextReleaseRequest_IEs_t* ie = NULL;
   oai::UeDescription* ue_ref_p = nullptr;
-  oai::EnbDescription enb_ref_p;
+  const oai::EnbDescription* enb_ref_p = nullptr;
   S1ap_Cause_PR cause_type;
   long cause_value;
   enum s1cause s1_release_cause = S1AP_RADIO_EUTRAN_GENERATED_REASON;
@@ -1144,7 +1142,8 @@ status_code_e s1ap_mme_handle_ue_context_release_request(
   imsi64_t imsi64 = INVALID_IMSI64;
 
   OAILOG_FUNC_IN(LOG_S1AP);
-  if ((s1ap_state_get_enb(state, assoc_id, &enb_ref_p)) != PROTO_MAP_OK) {
+  enb_ref_p = s1ap_state_get_enb(state, assoc_id);
+  if (enb_ref_p == nullptr) {
     OAILOG_ERROR(LOG_S1AP,
                  "Ignoring context release request from unknown assoc %u",
                  assoc_id);
@@ -1188,20 +1187,20 @@ status_code_e s1ap_mme_handle_ue_context_release_request(
           "Cause_Value = %ld\n",
           cause_value);
       if (cause_value == S1ap_CauseRadioNetwork_user_inactivity) {
-        increment_counter("ue_context_release_req", 1, 1, "cause",
-                          "user_inactivity");
+        INCREMENT_COUNTER_HANDLE("ue_context_release_req", 1, 1, "cause",
+                                 "user_inactivity");
       } else if (cause_value ==
                  S1ap_CauseRadioNetwork_radio_connection_with_ue_lost) {
-        increment_counter("ue_context_release_req", 1, 1, "cause",
-                          "radio_link_failure");
+        INCREMENT_COUNTER_HANDLE("ue_context_release_req", 1, 1, "cause",
+                                 "radio_link_failure");
       } else if (cause_value ==
                  S1ap_CauseRadioNetwork_ue_not_available_for_ps_service) {
-        increment_counter("ue_context_release_req", 1, 1, "cause",
-                          "ue_not_available_for_ps_service");
+        INCREMENT_COUNTER_HANDLE("ue_context_release_req", 1, 1, "cause",
+                                 "ue_not_available_for_ps_service");
         s1_release_cause = S1AP_NAS_UE_NOT_AVAILABLE_FOR_PS;
       } else if (cause_value == S1ap_CauseRadioNetwork_cs_fallback_triggered) {
-        increment_counter("ue_context_release_req", 1, 1, "cause",
-                          "cs_fallback_triggered");
+        INCREMENT_COUNTER_HANDLE("ue_context_release_req", 1, 1, "cause",
+                                 "cs_fallback_triggered");
         s1_release_cause = S1AP_CSFB_TRIGGERED;
       }
       break;
@@ -1281,7 +1280,7 @@ status_code_e s1ap_mme_handle_ue_context_release_request(
                                             ie->value.choice.Cause, imsi64);
 
       OAILOG_FUNC_RETURN(LOG_S1AP, rc);
-    } else if (enb_ref_p.enb_id() ==
+    } else if (enb_ref_p->enb_id() ==
                    ue_ref_p->s1ap_handover_state().source_enb_id() &&
                ue_ref_p->s1ap_handover_state().source_enb_ue_s1ap_id() ==
                    enb_ue_s1ap_id) {
@@ -2088,8 +2087,8 @@ status_code_e s1ap_mme_handle_handover_request_ack(
     S1ap_S1AP_PDU_t* pdu) {
   S1ap_HandoverRequestAcknowledge_t* container = NULL;
   S1ap_HandoverRequestAcknowledgeIEs_t* ie = NULL;
-  oai::EnbDescription source_enb;
-  oai::EnbDescription target_enb;
+  const oai::EnbDescription* source_enb = nullptr;
+  const oai::EnbDescription* target_enb = nullptr;
   oai::UeDescription* ue_ref_p = nullptr;
   mme_ue_s1ap_id_t mme_ue_s1ap_id = INVALID_MME_UE_S1AP_ID;
   enb_ue_s1ap_id_t tgt_enb_ue_s1ap_id = INVALID_ENB_UE_S1AP_ID;
@@ -2184,30 +2183,19 @@ status_code_e s1ap_mme_handle_handover_request_ack(
                  mme_ue_s1ap_id);
     OAILOG_FUNC_RETURN(LOG_S1AP, RETURNerror);
   }
-  proto_map_uint32_enb_description_t enb_map;
-  enb_map.map = state->mutable_enbs();
-  if (state->enbs_size()) {
-    for (auto itr = enb_map.map->begin(); itr != enb_map.map->end(); itr++) {
-      source_enb = itr->second;
-      if (!source_enb.sctp_assoc_id()) {
-        continue;
-      }
-      if (source_enb.sctp_assoc_id() == ue_ref_p->sctp_assoc_id()) {
-        break;
-      }
-    }
-    if (source_enb.sctp_assoc_id() != ue_ref_p->sctp_assoc_id()) {
-      OAILOG_ERROR_UE(LOG_S1AP, imsi64, "No source eNB found for UE\n");
-      OAILOG_FUNC_RETURN(LOG_S1AP, RETURNerror);
-    }
+  source_enb = s1ap_state_get_enb(state, ue_ref_p->sctp_assoc_id());
+  if (source_enb == nullptr) {
+    OAILOG_ERROR_UE(LOG_S1AP, imsi64, "No source eNB found for UE\n");
+    OAILOG_FUNC_RETURN(LOG_S1AP, RETURNerror);
   }
 
   OAILOG_INFO_UE(LOG_S1AP, imsi64, "Source enb is %u (association id %u)\n",
-                 source_enb.enb_id(), source_enb.sctp_assoc_id());
+                 source_enb->enb_id(), source_enb->sctp_assoc_id());
 
   // get the target eNB -- the one that sent this message, target of the
   // handover
-  if ((s1ap_state_get_enb(state, assoc_id, &target_enb)) != PROTO_MAP_OK) {
+  target_enb = s1ap_state_get_enb(state, assoc_id);
+  if (target_enb == nullptr) {
     OAILOG_ERROR(LOG_S1AP, "Failed to get target_enb for assoc_id: %u",
                  assoc_id);
     OAILOG_FUNC_RETURN(LOG_S1AP, RETURNerror);
@@ -2239,8 +2227,8 @@ status_code_e s1ap_mme_handle_handover_request_ack(
   }
   s1ap_mme_itti_s1ap_handover_request_ack(
       mme_ue_s1ap_id, ue_ref_p->enb_ue_s1ap_id(), tgt_enb_ue_s1ap_id,
-      handover_type, source_enb.sctp_assoc_id(), tgt_src_container,
-      source_enb.enb_id(), target_enb.enb_id(), imsi64);
+      handover_type, source_enb->sctp_assoc_id(), tgt_src_container,
+      source_enb->enb_id(), target_enb->enb_id(), imsi64);
 
   OAILOG_FUNC_RETURN(LOG_S1AP, RETURNok);
 }
@@ -2532,7 +2520,7 @@ status_code_e s1ap_mme_handle_handover_request(
   S1ap_S1AP_PDU_t pdu = {S1ap_S1AP_PDU_PR_NOTHING, {0}};
   S1ap_HandoverRequest_t* out;
   S1ap_HandoverRequestIEs_t* ie = NULL;
-  oai::EnbDescription target_enb;
+  oai::EnbDescription* target_enb = nullptr;
   sctp_stream_id_t stream = 0x0;
   oai::UeDescription* ue_ref_p = nullptr;
 
@@ -2555,28 +2543,27 @@ status_code_e s1ap_mme_handle_handover_request(
     OAILOG_FUNC_RETURN(LOG_S1AP, RETURNerror);
   }
 
-  if ((s1ap_state_get_enb(state, ho_request_p->target_sctp_assoc_id,
-                          &target_enb)) != PROTO_MAP_OK) {
+  target_enb = s1ap_state_get_enb(state, ho_request_p->target_sctp_assoc_id);
+  if (target_enb == nullptr) {
     OAILOG_ERROR(LOG_S1AP, "Could not get enb description for assoc_id %u\n",
                  ho_request_p->target_sctp_assoc_id);
     OAILOG_FUNC_RETURN(LOG_S1AP, RETURNerror);
   }
 
   // set the recv and send streams for UE on the target.
-  stream = target_enb.next_sctp_stream();
+  stream = target_enb->next_sctp_stream();
   ue_ref_p->mutable_s1ap_handover_state()->set_target_sctp_stream_recv(stream);
   ue_ref_p->mutable_s1ap_handover_state()->set_source_sctp_stream_recv(
       ue_ref_p->sctp_stream_recv());
-  target_enb.set_next_sctp_stream(target_enb.next_sctp_stream() + 1);
-  if (target_enb.next_sctp_stream() >= target_enb.instreams()) {
-    target_enb.set_next_sctp_stream(1);
+  target_enb->set_next_sctp_stream(target_enb->next_sctp_stream() + 1);
+  if (target_enb->next_sctp_stream() >= target_enb->instreams()) {
+    target_enb->set_next_sctp_stream(1);
   }
   ue_ref_p->mutable_s1ap_handover_state()->set_target_sctp_stream_send(
-      target_enb.next_sctp_stream());
+      target_enb->next_sctp_stream());
   ue_ref_p->mutable_s1ap_handover_state()->set_source_sctp_stream_send(
       ue_ref_p->sctp_stream_send());
-  s1ap_state_update_enb_map(state, ho_request_p->target_sctp_assoc_id,
-                            &target_enb);
+  s1ap_state_mark_enb_dirty(target_enb);
   // Build and send PDU
   pdu.present = S1ap_S1AP_PDU_PR_initiatingMessage;
   pdu.choice.initiatingMessage.procedureCode =
@@ -2790,7 +2777,7 @@ status_code_e s1ap_mme_handle_handover_required(oai::S1apState* state,
                                                 S1ap_S1AP_PDU_t* pdu) {
   S1ap_HandoverRequired_t* container = NULL;
   S1ap_HandoverRequiredIEs_t* ie = NULL;
-  oai::EnbDescription enb_association;
+  const oai::EnbDescription* enb_association = nullptr;
   mme_ue_s1ap_id_t mme_ue_s1ap_id = INVALID_MME_UE_S1AP_ID;
   enb_ue_s1ap_id_t enb_ue_s1ap_id = INVALID_ENB_UE_S1AP_ID;
   S1ap_HandoverType_t handover_type = -1;
@@ -2800,13 +2787,14 @@ status_code_e s1ap_mme_handle_handover_required(oai::S1apState* state,
   S1ap_TargeteNB_ID_t* targeteNB_ID = NULL;
   bstring src_tgt_container = {0};
   uint8_t* enb_id_buf = NULL;
-  oai::EnbDescription target_enb_association;
+  const oai::EnbDescription* target_enb_association = nullptr;
   uint32_t target_enb_id = 0;
   imsi64_t imsi64 = INVALID_IMSI64;
 
   OAILOG_FUNC_IN(LOG_S1AP);
 
-  if ((s1ap_state_get_enb(state, assoc_id, &enb_association)) != PROTO_MAP_OK) {
+  enb_association = s1ap_state_get_enb(state, assoc_id);
+  if (enb_association == nullptr) {
     OAILOG_ERROR(LOG_S1AP,
                  "Ignore Handover Required from unknown assoc "
                  "%u\n",
@@ -2817,8 +2805,8 @@ status_code_e s1ap_mme_handle_handover_required(oai::S1apState* state,
   OAILOG_INFO(LOG_S1AP,
               "Handover Required from association id %u, "
               "Connected UEs = %u Num elements = %u\n",
-              assoc_id, enb_association.nb_ue_associated(),
-              enb_association.ue_id_map_size());
+              assoc_id, enb_association->nb_ue_associated(),
+              enb_association->ue_id_map_size());
 
   container = &pdu->choice.initiatingMessage.value.choice.HandoverRequired;
 
@@ -2958,31 +2946,19 @@ status_code_e s1ap_mme_handle_handover_required(oai::S1apState* state,
   ueid_imsi_map.get(mme_ue_s1ap_id, &imsi64);
 
   // retrieve enb_description using hash table and match target_enb_id
-  proto_map_uint32_enb_description_t enb_map;
-  enb_map.map = state->mutable_enbs();
-  if (state->enbs_size()) {
-    for (auto itr = enb_map.map->begin(); itr != enb_map.map->end(); itr++) {
-      target_enb_association = itr->second;
-      if (!target_enb_association.sctp_assoc_id()) {
-        continue;
-      }
-      if (target_enb_association.enb_id() == target_enb_id) {
-        break;
-      }
-    }
-    if (target_enb_association.enb_id() != target_enb_id) {
-      bdestroy_wrapper(&src_tgt_container);
-      OAILOG_ERROR(LOG_S1AP, "No eNB for enb_id %d\n", target_enb_id);
-      OAILOG_FUNC_RETURN(LOG_S1AP, RETURNerror);
-    }
+  target_enb_association = s1ap_state_get_enb_by_enb_id(state, target_enb_id);
+  if (target_enb_association == nullptr) {
+    bdestroy_wrapper(&src_tgt_container);
+    OAILOG_ERROR(LOG_S1AP, "No eNB for enb_id %d\n", target_enb_id);
+    OAILOG_FUNC_RETURN(LOG_S1AP, RETURNerror);
   }
 
   OAILOG_INFO_UE(LOG_S1AP, imsi64,
                  "Handing over to enb_id %d (sctp assoc %d)\n", target_enb_id,
-                 target_enb_association.sctp_assoc_id());
+                 target_enb_association->sctp_assoc_id());
 
   s1ap_mme_itti_s1ap_handover_required(
-      target_enb_association.sctp_assoc_id(), target_enb_id, cause,
+      target_enb_association->sctp_assoc_id(), target_enb_id, cause,
       handover_type, mme_ue_s1ap_id, src_tgt_container, imsi64);
 
   OAILOG_FUNC_RETURN(LOG_S1AP, RETURNok);
@@ -3098,7 +3074,7 @@ status_code_e s1ap_mme_handle_handover_notify(oai::S1apState* state,
                                               S1ap_S1AP_PDU_t* pdu) {
   S1ap_HandoverNotify_t* container = NULL;
   S1ap_HandoverNotifyIEs_t* ie = NULL;
-  oai::EnbDescription target_enb;
+  oai::EnbDescription* target_enb = nullptr;
   oai::UeDescription* src_ue_ref_p = nullptr;
   oai::UeDescription* new_ue_ref_p = nullptr;
   mme_ue_s1ap_id_t mme_ue_s1ap_id = INVALID_MME_UE_S1AP_ID;
@@ -3109,7 +3085,8 @@ status_code_e s1ap_mme_handle_handover_notify(oai::S1apState* state,
 
   OAILOG_FUNC_IN(LOG_S1AP);
 
-  if ((s1ap_state_get_enb(state, assoc_id, &target_enb)) != PROTO_MAP_OK) {
+  target_enb = s1ap_state_get_enb(state, assoc_id);
+  if (target_enb == nullptr) {
     OAILOG_ERROR(LOG_S1AP, "Ignore HandoverNotify from unknown assoc %u\n",
                  assoc_id);
     OAILOG_FUNC_RETURN(LOG_S1AP, RETURNerror);
@@ -3190,7 +3167,7 @@ status_code_e s1ap_mme_handle_handover_notify(oai::S1apState* state,
   }
   // create new UE context, remove the old one.
   new_ue_ref_p =
-      s1ap_state_get_ue_enbid(target_enb.sctp_assoc_id(), tgt_enb_ue_s1ap_id);
+      s1ap_state_get_ue_enbid(target_enb->sctp_assoc_id(), tgt_enb_ue_s1ap_id);
   if (new_ue_ref_p != nullptr) {
     OAILOG_ERROR_UE(
         LOG_S1AP, imsi64,
@@ -3199,7 +3176,7 @@ status_code_e s1ap_mme_handle_handover_notify(oai::S1apState* state,
         tgt_enb_ue_s1ap_id);
     OAILOG_FUNC_RETURN(LOG_S1AP, RETURNerror);
   }
-  if ((new_ue_ref_p = s1ap_new_ue(&target_enb, assoc_id, tgt_enb_ue_s1ap_id)) ==
+  if ((new_ue_ref_p = s1ap_new_ue(target_enb, assoc_id, tgt_enb_ue_s1ap_id)) ==
       nullptr) {
     // If we failed to allocate a new UE return -1
     OAILOG_ERROR_UE(LOG_S1AP, imsi64,
@@ -3249,10 +3226,10 @@ status_code_e s1ap_mme_handle_handover_notify(oai::S1apState* state,
       mmeid2associd_map.insert(new_ue_ref_p->mme_ue_s1ap_id(), assoc_id);
 
   magma::proto_map_uint32_uint64_t ue_id_coll;
-  ue_id_coll.map = target_enb.mutable_ue_id_map();
+  ue_id_coll.map = target_enb->mutable_ue_id_map();
   ue_id_coll.insert(new_ue_ref_p->mme_ue_s1ap_id(),
                     new_ue_ref_p->comp_s1ap_id());
-  s1ap_state_update_enb_map(state, assoc_id, &target_enb);
+  s1ap_state_mark_enb_dirty(target_enb);
 
   OAILOG_DEBUG_UE(
       LOG_S1AP, imsi64,
@@ -3271,7 +3248,7 @@ status_code_e s1ap_mme_handle_enb_status_transfer(
   S1ap_ENBStatusTransferIEs_t* ie = NULL;
   oai::UeDescription* ue_ref_p = nullptr;
   mme_ue_s1ap_id_t mme_ue_s1ap_id = INVALID_MME_UE_S1AP_ID;
-  oai::EnbDescription target_enb_association;
+  const oai::EnbDescription* target_enb_association = nullptr;
   uint8_t* buffer = NULL;
   uint32_t length = 0;
 
@@ -3319,25 +3296,12 @@ status_code_e s1ap_mme_handle_enb_status_transfer(
 
   // get the enb_description matching the target_enb_id
   // retrieve enb_description using hash table and match target_enb_id
-  proto_map_uint32_enb_description_t enb_map;
-  enb_map.map = state->mutable_enbs();
-  if (state->enbs_size()) {
-    for (auto itr = enb_map.map->begin(); itr != enb_map.map->end(); itr++) {
-      target_enb_association = itr->second;
-      if (!target_enb_association.sctp_assoc_id()) {
-        continue;
-      }
-      if (target_enb_association.enb_id() ==
-          ue_ref_p->s1ap_handover_state().target_enb_id()) {
-        break;
-      }
-    }
-    if (target_enb_association.enb_id() !=
-        ue_ref_p->s1ap_handover_state().target_enb_id()) {
-      OAILOG_ERROR(LOG_S1AP, "No eNB for enb_id %d\n",
-                   ue_ref_p->s1ap_handover_state().target_enb_id());
-      OAILOG_FUNC_RETURN(LOG_S1AP, RETURNerror);
-    }
+  target_enb_association = s1ap_state_get_enb_by_enb_id(
+      state, ue_ref_p->s1ap_handover_state().target_enb_id());
+  if (target_enb_association == nullptr) {
+    OAILOG_ERROR(LOG_S1AP, "No eNB for enb_id %d\n",
+                 ue_ref_p->s1ap_handover_state().target_enb_id());
+    OAILOG_FUNC_RETURN(LOG_S1AP, RETURNerror);
   }
 
   // change the message type and enb_ue_s1_id to the target eNB's ID
@@ -3358,7 +3322,7 @@ status_code_e s1ap_mme_handle_enb_status_transfer(
   free(buffer);
 
   s1ap_mme_itti_send_sctp_request(
-      &b, target_enb_association.sctp_assoc_id(),
+      &b, target_enb_association->sctp_assoc_id(),
       ue_ref_p->s1ap_handover_state().target_sctp_stream_recv(),
       ue_ref_p->mme_ue_s1ap_id());
 
@@ -3373,7 +3337,7 @@ status_code_e s1ap_mme_handle_path_switch_request(
   S1ap_PathSwitchRequest_t* container = NULL;
   S1ap_PathSwitchRequestIEs_t* ie = NULL;
   S1ap_E_RABToBeSwitchedDLItemIEs_t* eRABToBeSwitchedDlItemIEs_p = NULL;
-  oai::EnbDescription enb_association;
+  oai::EnbDescription* enb_association = nullptr;
   oai::UeDescription* ue_ref_p = nullptr;
   oai::UeDescription* new_ue_ref_p = nullptr;
   mme_ue_s1ap_id_t mme_ue_s1ap_id = INVALID_MME_UE_S1AP_ID;
@@ -3390,7 +3354,8 @@ status_code_e s1ap_mme_handle_path_switch_request(
 
   OAILOG_FUNC_IN(LOG_S1AP);
 
-  if ((s1ap_state_get_enb(state, assoc_id, &enb_association)) != PROTO_MAP_OK) {
+  enb_association = s1ap_state_get_enb(state, assoc_id);
+  if (enb_association == nullptr) {
     OAILOG_ERROR(LOG_S1AP,
                  "Ignore Path Switch Request from unknown assoc "
                  "%u\n",
@@ -3450,7 +3415,7 @@ status_code_e s1ap_mme_handle_path_switch_request(
     OAILOG_FUNC_RETURN(LOG_S1AP, RETURNerror);
   }
   new_ue_ref_p =
-      s1ap_state_get_ue_enbid(enb_association.sctp_assoc_id(), enb_ue_s1ap_id);
+      s1ap_state_get_ue_enbid(enb_association->sctp_assoc_id(), enb_ue_s1ap_id);
   if (new_ue_ref_p != nullptr) {
     OAILOG_ERROR_UE(
         LOG_S1AP, imsi64,
@@ -3463,7 +3428,7 @@ status_code_e s1ap_mme_handle_path_switch_request(
    * Creat New UE Context with target eNB and delete Old UE Context
    * from source eNB.
    */
-  if ((new_ue_ref_p = s1ap_new_ue(&enb_association, assoc_id,
+  if ((new_ue_ref_p = s1ap_new_ue(enb_association, assoc_id,
                                   enb_ue_s1ap_id)) == nullptr) {
     // If we failed to allocate a new UE return -1
     OAILOG_ERROR_UE(
@@ -3484,10 +3449,11 @@ status_code_e s1ap_mme_handle_path_switch_request(
       ue_ref_p->s1ap_ue_context_rel_timer().msec());
   // On which stream we received the message
   new_ue_ref_p->set_sctp_stream_recv(stream);
-  new_ue_ref_p->set_sctp_stream_send(enb_association.next_sctp_stream());
-  enb_association.set_next_sctp_stream(enb_association.next_sctp_stream() + 1);
-  if (enb_association.next_sctp_stream() >= enb_association.instreams()) {
-    enb_association.set_next_sctp_stream(1);
+  new_ue_ref_p->set_sctp_stream_send(enb_association->next_sctp_stream());
+  enb_association->set_next_sctp_stream(enb_association->next_sctp_stream() +
+                                         1);
+  if (enb_association->next_sctp_stream() >= enb_association->instreams()) {
+    enb_association->set_next_sctp_stream(1);
   }
   /* Remove ue description from source eNB */
   s1ap_remove_ue(state, ue_ref_p);
@@ -3498,10 +3464,10 @@ status_code_e s1ap_mme_handle_path_switch_request(
       mmeid2associd_map.insert(new_ue_ref_p->mme_ue_s1ap_id(), assoc_id);
 
   magma::proto_map_uint32_uint64_t ue_id_coll;
-  ue_id_coll.map = enb_association.mutable_ue_id_map();
+  ue_id_coll.map = enb_association->mutable_ue_id_map();
   ue_id_coll.insert(new_ue_ref_p->mme_ue_s1ap_id(),
                     new_ue_ref_p->comp_s1ap_id());
-  s1ap_state_update_enb_map(state, assoc_id, &enb_association);
+  s1ap_state_mark_enb_dirty(enb_association);
   OAILOG_DEBUG_UE(
       LOG_S1AP, imsi64,
       "Associated sctp_assoc_id %d, enb_ue_s1ap_id " ENB_UE_S1AP_ID_FMT
@@ -3583,7 +3549,7 @@ status_code_e s1ap_mme_handle_path_switch_request(
       integrity_algorithm_capabilities);
 
   s1ap_mme_itti_s1ap_path_switch_request(
-      assoc_id, enb_association.enb_id(), new_ue_ref_p->enb_ue_s1ap_id(),
+      assoc_id, enb_association->enb_id(), new_ue_ref_p->enb_ue_s1ap_id(),
       &e_rab_to_be_switched_dl_list, new_ue_ref_p->mme_ue_s1ap_id(), &ecgi,
       &tai, encryption_algorithm_capabilities, integrity_algorithm_capabilities,
       imsi64);
@@ -3701,26 +3667,27 @@ status_code_e s1ap_handle_sctp_disconnection(oai::S1apState* state,
                                              bool reset) {
   arg_s1ap_send_enb_dereg_ind_t arg = {0};
   MessageDef* message_p = NULL;
-  oai::EnbDescription enb_association;
+  oai::EnbDescription* enb_association = nullptr;
 
   OAILOG_FUNC_IN(LOG_S1AP);
 
   // Checking if the assoc id has a valid eNB attached to it
-  if ((s1ap_state_get_enb(state, assoc_id, &enb_association)) != PROTO_MAP_OK) {
+  enb_association = s1ap_state_get_enb(state, assoc_id);
+  if (enb_association == nullptr) {
     OAILOG_ERROR(LOG_S1AP, "No eNB attached to this assoc_id: %u\n", assoc_id);
     OAILOG_FUNC_RETURN(LOG_S1AP, RETURNerror);
   }
 
   magma::proto_map_uint32_uint64_t ue_id_coll;
-  ue_id_coll.map = enb_association.mutable_ue_id_map();
+  ue_id_coll.map = enb_association->mutable_ue_id_map();
   OAILOG_INFO(LOG_S1AP,
               "SCTP disconnection request for association id %u, Reset Flag = "
               "%u. Connected UEs = %u Num elements = %zu\n",
-              assoc_id, reset, enb_association.nb_ue_associated(),
+              assoc_id, reset, enb_association->nb_ue_associated(),
               ue_id_coll.size());
 
   // First check if we can just reset the eNB state if there are no UEs
-  if (!enb_association.nb_ue_associated()) {
+  if (!enb_association->nb_ue_associated()) {
     if (reset) {
       OAILOG_INFO(LOG_S1AP,
                   "SCTP reset request for association id %u. No Connected UEs. "
@@ -3729,9 +3696,9 @@ status_code_e s1ap_handle_sctp_disconnection(oai::S1apState* state,
 
       OAILOG_INFO(LOG_S1AP, "Moving eNB with assoc_id %u to INIT state\n",
                   assoc_id);
-      enb_association.set_s1_enb_state(oai::S1AP_INIT);
+      enb_association->set_s1_enb_state(oai::S1AP_INIT);
       state->set_num_enbs(state->num_enbs() - 1);
-      s1ap_state_update_enb_map(state, assoc_id, &enb_association);
+      s1ap_state_mark_enb_dirty(enb_association);
     } else {
       OAILOG_INFO(
           LOG_S1AP,
@@ -3740,7 +3707,7 @@ status_code_e s1ap_handle_sctp_disconnection(oai::S1apState* state,
           assoc_id, reset);
 
       OAILOG_INFO(LOG_S1AP, "Removing eNB with association id %u \n", assoc_id);
-      s1ap_remove_enb(state, &enb_association);
+      s1ap_remove_enb(state, enb_association);
     }
     OAILOG_FUNC_RETURN(LOG_S1AP, RETURNok);
   }
@@ -3755,7 +3722,7 @@ status_code_e s1ap_handle_sctp_disconnection(oai::S1apState* state,
     if (ue_id_coll.size() == 0) {
       OAILOG_FUNC_RETURN(LOG_S1AP,
                          s1ap_clear_ue_ctxt_for_unknown_mme_ue_s1ap_id(
-                             state, enb_association.sctp_assoc_id()));
+                             state, enb_association->sctp_assoc_id()));
     }
   }
   /*
@@ -3763,7 +3730,7 @@ status_code_e s1ap_handle_sctp_disconnection(oai::S1apState* state,
    * UE count in each batch <= S1AP_ITTI_UE_PER_DEREGISTER_MESSAGE
    */
 
-  arg.associated_enb_id = enb_association.enb_id();
+  arg.associated_enb_id = enb_association->enb_id();
   arg.deregister_ue_count = ue_id_coll.size();
   ue_id_coll.map_apply_callback_on_all_elements(
       s1ap_send_enb_deregistered_ind, reinterpret_cast<void*>(&arg),
@@ -3775,8 +3742,8 @@ status_code_e s1ap_handle_sctp_disconnection(oai::S1apState* state,
    */
   oai::S1apEnbState s1ap_state =
       reset ? oai::S1AP_RESETING : oai::S1AP_SHUTDOWN;
-  enb_association.set_s1_enb_state(s1ap_state);
-  s1ap_state_update_enb_map(state, assoc_id, &enb_association);
+  enb_association->set_s1_enb_state(s1ap_state);
+  s1ap_state_mark_enb_dirty(enb_association);
   OAILOG_INFO(LOG_S1AP,
               "Marked enb s1 status to %s, attached to assoc_id: %d\n",
               reset ? "Reset" : "Shutdown", assoc_id);
@@ -3787,7 +3754,7 @@ status_code_e s1ap_handle_sctp_disconnection(oai::S1apState* state,
 //------------------------------------------------------------------------------
 status_code_e s1ap_handle_new_association(oai::S1apState* state,
                                           sctp_new_peer_t* sctp_new_peer_p) {
-  oai::EnbDescription enb_association;
+  oai::EnbDescription* enb_association = nullptr;
 
   OAILOG_FUNC_IN(LOG_S1AP);
 
@@ -3799,31 +3766,33 @@ status_code_e s1ap_handle_new_association(oai::S1apState* state,
   /*
    * Checking that the assoc id has a valid eNB attached to.
    */
-  if ((s1ap_state_get_enb(state, sctp_new_peer_p->assoc_id,
-                          &enb_association)) != PROTO_MAP_OK) {
+  enb_association = s1ap_state_get_enb(state, sctp_new_peer_p->assoc_id);
+  if (enb_association == nullptr) {
     OAILOG_DEBUG(LOG_S1AP, "Create eNB context for assoc_id: %d\n",
                  sctp_new_peer_p->assoc_id);
     // Create new context
-    s1ap_new_enb(&enb_association);
+    oai::EnbDescription new_enb_association;
+    s1ap_new_enb(&new_enb_association);
 
-    enb_association.set_sctp_assoc_id(sctp_new_peer_p->assoc_id);
-    enb_association.set_enb_id(
+    new_enb_association.set_sctp_assoc_id(sctp_new_peer_p->assoc_id);
+    new_enb_association.set_enb_id(
         0xFFFFFFFF);  // home or macro eNB is 28 or 20bits.
 
     proto_map_uint32_enb_description_t enb_map;
     enb_map.map = state->mutable_enbs();
-    magma::proto_map_rc_t rc =
-        enb_map.insert(enb_association.sctp_assoc_id(), enb_association);
+    magma::proto_map_rc_t rc = enb_map.insert(
+        new_enb_association.sctp_assoc_id(), new_enb_association);
     if (rc != magma::PROTO_MAP_OK) {
       OAILOG_FUNC_RETURN(LOG_S1AP, RETURNerror);
     }
-  } else if ((enb_association.s1_enb_state() == oai::S1AP_SHUTDOWN) ||
-             (enb_association.s1_enb_state() == oai::S1AP_RESETING)) {
+    enb_association = s1ap_state_get_enb(state, sctp_new_peer_p->assoc_id);
+  } else if ((enb_association->s1_enb_state() == oai::S1AP_SHUTDOWN) ||
+             (enb_association->s1_enb_state() == oai::S1AP_RESETING)) {
     OAILOG_WARNING(LOG_S1AP,
                    "Received new association request on an association that "
                    "is being %s, "
                    "ignoring",
-                   s1_enb_state2str(enb_association.s1_enb_state()));
+                   s1_enb_state2str(enb_association->s1_enb_state()));
     OAILOG_FUNC_RETURN(LOG_S1AP, RETURNerror);
   } else {
     OAILOG_DEBUG(LOG_S1AP,
@@ -3831,27 +3800,30 @@ status_code_e s1ap_handle_new_association(oai::S1apState* state,
                  sctp_new_peer_p->assoc_id);
   }
 
-  enb_association.set_sctp_assoc_id(sctp_new_peer_p->assoc_id);
+  enb_association->set_sctp_assoc_id(sctp_new_peer_p->assoc_id);
   /*
    * Fill in in and out number of streams available on SCTP connection.
    */
-  enb_association.set_instreams((sctp_stream_id_t)sctp_new_peer_p->instreams);
-  enb_association.set_outstreams((sctp_stream_id_t)sctp_new_peer_p->outstreams);
+  enb_association->set_instreams(
+      (sctp_stream_id_t)sctp_new_peer_p->instreams);
+  enb_association->set_outstreams(
+      (sctp_stream_id_t)sctp_new_peer_p->outstreams);
   /*
    * Fill in control plane IP address of RAN end point for this association
    */
   if (sctp_new_peer_p->ran_cp_ipaddr) {
-    enb_association.set_ran_cp_ipaddr(sctp_new_peer_p->ran_cp_ipaddr->data,
-                                      sctp_new_peer_p->ran_cp_ipaddr->slen);
-    enb_association.set_ran_cp_ipaddr_sz(sctp_new_peer_p->ran_cp_ipaddr->slen);
+    enb_association->set_ran_cp_ipaddr(sctp_new_peer_p->ran_cp_ipaddr->data,
+                                       sctp_new_peer_p->ran_cp_ipaddr->slen);
+    enb_association->set_ran_cp_ipaddr_sz(
+        sctp_new_peer_p->ran_cp_ipaddr->slen);
   }
   /*
    * initialize the next sctp stream to 1 as 0 is reserved for non
    * * * * ue associated signalling.
    */
-  enb_association.set_next_sctp_stream(1);
-  enb_association.set_s1_enb_state(oai::S1AP_INIT);
-  s1ap_state_update_enb_map(state, sctp_new_peer_p->assoc_id, &enb_association);
+  enb_association->set_next_sctp_stream(1);
+  enb_association->set_s1_enb_state(oai::S1AP_INIT);
+  s1ap_state_mark_enb_dirty(enb_association);
   OAILOG_FUNC_RETURN(LOG_S1AP, RETURNok);
 }
 
@@ -4139,7 +4111,7 @@ status_code_e s1ap_mme_handle_enb_reset(oai::S1apState* state,
   MessageDef* msg = NULL;
   itti_s1ap_enb_initiated_reset_req_t* reset_req = NULL;
   oai::UeDescription* ue_ref_p = nullptr;
-  oai::EnbDescription enb_association;
+  oai::EnbDescription* enb_association = nullptr;
   s1ap_reset_type_t s1ap_reset_type;
   S1ap_Reset_t* container = NULL;
   S1ap_ResetIEs_t* ie = NULL;
@@ -4154,30 +4126,31 @@ status_code_e s1ap_mme_handle_enb_reset(oai::S1apState* state,
 
   OAILOG_FUNC_IN(LOG_S1AP);
 
-  if ((s1ap_state_get_enb(state, assoc_id, &enb_association)) != PROTO_MAP_OK) {
+  enb_association = s1ap_state_get_enb(state, assoc_id);
+  if (enb_association == nullptr) {
     OAILOG_ERROR(LOG_S1AP, "No eNB attached to this assoc_id: %d\n", assoc_id);
     OAILOG_FUNC_RETURN(LOG_S1AP, RETURNerror);
   }
 
-  if (enb_association.s1_enb_state() != oai::S1AP_READY) {
+  if (enb_association->s1_enb_state() != oai::S1AP_READY) {
     // ignore the message if s1 not ready
     OAILOG_INFO(
         LOG_S1AP,
         "S1 setup is not done.Invalid state.Ignoring ENB Initiated Reset.eNB "
         "Id "
         "= %d , S1AP state = %d \n",
-        enb_association.enb_id(), enb_association.s1_enb_state());
+        enb_association->enb_id(), enb_association->s1_enb_state());
     OAILOG_FUNC_RETURN(LOG_S1AP, RETURNok);
   }
 
-  if (enb_association.nb_ue_associated() == 0) {
+  if (enb_association->nb_ue_associated() == 0) {
     // Even if there are no UEs connected, we proceed -- this can happen if we
     // receive a reset during a handover procedure, for example.
     OAILOG_INFO(LOG_S1AP,
                 "No UEs connected, still proceeding with ENB Initiated "
                 "Reset. eNB Id = "
                 "%d\n",
-                enb_association.enb_id());
+                enb_association->enb_id());
   }
 
   // Check the reset type - partial_reset OR reset_all
@@ -4215,7 +4188,7 @@ status_code_e s1ap_mme_handle_enb_reset(oai::S1apState* state,
       // scenario.
       OAILOG_FUNC_RETURN(LOG_S1AP, RETURNerror);
     }
-    if (reset_count > enb_association.nb_ue_associated()) {
+    if (reset_count > enb_association->nb_ue_associated()) {
       // We proceed here since we could encounter this situation when we
       // receive a reset from the target eNB during a handover procedure.
       OAILOG_WARNING(
@@ -4223,7 +4196,7 @@ status_code_e s1ap_mme_handle_enb_reset(oai::S1apState* state,
           "Partial Reset Request. Requested number of UEs %d to be reset is "
           "more "
           "than connected UEs %d \n",
-          reset_count, enb_association.nb_ue_associated());
+          reset_count, enb_association->nb_ue_associated());
     }
   }
   msg = DEPRECATEDitti_alloc_new_message_fatal(TASK_S1AP,
@@ -4231,7 +4204,7 @@ status_code_e s1ap_mme_handle_enb_reset(oai::S1apState* state,
   reset_req = &S1AP_ENB_INITIATED_RESET_REQ(msg);
 
   reset_req->s1ap_reset_type = s1ap_reset_type;
-  reset_req->enb_id = enb_association.enb_id();
+  reset_req->enb_id = enb_association->enb_id();
   reset_req->sctp_assoc_id = assoc_id;
   reset_req->sctp_stream_id = stream;
 
@@ -4239,10 +4212,10 @@ status_code_e s1ap_mme_handle_enb_reset(oai::S1apState* state,
     case RESET_ALL:
       increment_counter("s1_reset_from_enb", 1, 1, "type", "reset_all");
 
-      reset_req->num_ue = enb_association.nb_ue_associated();
+      reset_req->num_ue = enb_association->nb_ue_associated();
 
       reset_req->ue_to_reset_list = reinterpret_cast<s1_sig_conn_id_t*>(
-          calloc(enb_association.nb_ue_associated(),
+          calloc(enb_association->nb_ue_associated(),
                  sizeof(*reset_req->ue_to_reset_list)));
 
       if (reset_req->ue_to_reset_list == NULL) {
@@ -4252,7 +4225,7 @@ status_code_e s1ap_mme_handle_enb_reset(oai::S1apState* state,
       arg.msg = msg;
       arg.current_ue_index = 0;
 
-      ue_id_coll.map = enb_association.mutable_ue_id_map();
+      ue_id_coll.map = enb_association->mutable_ue_id_map();
       ue_id_coll.map_apply_callback_on_all_elements(
           construct_s1ap_mme_full_reset_req, &arg, NULL);
       // EURECOM LG 2020-07-16 added break here
@@ -4356,7 +4329,7 @@ status_code_e s1ap_mme_handle_enb_reset(oai::S1apState* state,
             enb_ue_s1ap_id =
                 (enb_ue_s1ap_id_t) * (s1_sig_conn_id_p->eNB_UE_S1AP_ID);
             if ((ue_ref_p = s1ap_state_get_ue_enbid(
-                     enb_association.sctp_assoc_id(), enb_ue_s1ap_id)) !=
+                     enb_association->sctp_assoc_id(), enb_ue_s1ap_id)) !=
                 NULL) {
               enb_ue_s1ap_id &= ENB_UE_S1AP_ID_MASK;
               reset_req->ue_to_reset_list[i].enb_ue_s1ap_id = enb_ue_s1ap_id;
@@ -4602,7 +4575,6 @@ status_code_e s1ap_handle_paging_request(
   }
 
   /*Fetching eNB list to send paging request message*/
-  oai::EnbDescription enb_ref_p;
   if (state == NULL) {
     OAILOG_ERROR(LOG_S1AP, "eNB Information is NULL!\n");
     OAILOG_FUNC_RETURN(LOG_S1AP, RETURNerror);
@@ -4615,15 +4587,15 @@ status_code_e s1ap_handle_paging_request(
   }
   const paging_tai_list_t* p_tai_list = paging_request->paging_tai_list;
   for (auto itr = enb_map.map->begin(); itr != enb_map.map->end(); itr++) {
-    enb_ref_p = itr->second;
-    if (enb_ref_p.sctp_assoc_id()) {
-      if (enb_ref_p.s1_enb_state() == oai::S1AP_READY) {
-        oai::SupportedTaList enb_ta_list = enb_ref_p.supported_ta_list();
+    const oai::EnbDescription* enb_ref_p = &itr->second;
+    if (enb_ref_p->sctp_assoc_id()) {
+      if (enb_ref_p->s1_enb_state() == oai::S1AP_READY) {
         if ((is_tai_found = s1ap_paging_compare_ta_lists(
-                 enb_ta_list, p_tai_list, paging_request->tai_list_count))) {
+                 enb_ref_p->supported_ta_list(), p_tai_list,
+                 paging_request->tai_list_count))) {
           bstring paging_msg_buffer = blk2bstr(buffer_p, length);
           rc = s1ap_mme_itti_send_sctp_request(
-              &paging_msg_buffer, enb_ref_p.sctp_assoc_id(),
+              &paging_msg_buffer, enb_ref_p->sctp_assoc_id(),
               0,   // Stream id 0 for non UE related
                    // S1AP message
               0);  // mme_ue_s1ap_id 0 because UE in idle
@@ -4913,8 +4885,8 @@ status_code_e s1ap_mme_handle_enb_configuration_transfer(
   S1ap_ENBConfigurationTransferIEs_t* ie = NULL;
   S1ap_TargeteNB_ID_t* targeteNB_ID = NULL;
   uint8_t* enb_id_buf = NULL;
-  oai::EnbDescription enb_association;
-  oai::EnbDescription target_enb_association;
+  const oai::EnbDescription* enb_association = nullptr;
+  const oai::EnbDescription* target_enb_association = nullptr;
   uint32_t target_enb_id = 0;
   uint8_t* buffer = NULL;
   uint32_t length = 0;
@@ -4932,20 +4904,21 @@ status_code_e s1ap_mme_handle_enb_configuration_transfer(
 
   OAILOG_DEBUG(LOG_S1AP, "Received eNB Confiuration Request from assoc_id %u\n",
                assoc_id);
-  if ((s1ap_state_get_enb(state, assoc_id, &enb_association)) != PROTO_MAP_OK) {
+  enb_association = s1ap_state_get_enb(state, assoc_id);
+  if (enb_association == nullptr) {
     OAILOG_ERROR(LOG_S1AP,
                  "Ignoring eNB Confiuration Request from unknown assoc %u\n",
                  assoc_id);
     OAILOG_FUNC_RETURN(LOG_S1AP, RETURNerror);
   }
 
-  if (enb_association.s1_enb_state() != oai::S1AP_READY) {
+  if (enb_association->s1_enb_state() != oai::S1AP_READY) {
     // ignore the message if s1 not ready
     OAILOG_INFO(
         LOG_S1AP,
         "S1 setup is not done.Invalid state.Ignoring eNB Configuration Request "
         "eNB Id = %d , S1AP state = %d \n",
-        enb_association.enb_id(), enb_association.s1_enb_state());
+        enb_association->enb_id(), enb_association->s1_enb_state());
     OAILOG_FUNC_RETURN(LOG_S1AP, RETURNok);
   }
 
@@ -4968,19 +4941,10 @@ status_code_e s1ap_mme_handle_enb_configuration_transfer(
   }
 
   // retrieve enb_description using hash table and match target_enb_id
-  proto_map_uint32_enb_description_t enb_map;
-  enb_map.map = state->mutable_enbs();
-  if (enb_map.size()) {
-    for (auto itr = enb_map.map->begin(); itr != enb_map.map->end(); itr++) {
-      target_enb_association = itr->second;
-      if (target_enb_association.enb_id() == target_enb_id) {
-        break;
-      }
-    }
-    if (target_enb_association.enb_id() != target_enb_id) {
-      OAILOG_ERROR(LOG_S1AP, "No eNB for enb_id %d\n", target_enb_id);
-      OAILOG_FUNC_RETURN(LOG_S1AP, RETURNerror);
-    }
+  target_enb_association = s1ap_state_get_enb_by_enb_id(state, target_enb_id);
+  if (target_enb_association == nullptr) {
+    OAILOG_ERROR(LOG_S1AP, "No eNB for enb_id %d\n", target_enb_id);
+    OAILOG_FUNC_RETURN(LOG_S1AP, RETURNerror);
   }
 
   pdu->choice.initiatingMessage.procedureCode =
@@ -5004,7 +4968,7 @@ status_code_e s1ap_mme_handle_enb_configuration_transfer(
 
   // Send message
   rc = s1ap_mme_itti_send_sctp_request(
-      &b, target_enb_association.sctp_assoc_id(),
+      &b, target_enb_association->sctp_assoc_id(),
       0,   // Stream id 0 for non UE related S1AP message
       0);  // mme_ue_s1ap_id 0 because UE in idle
 
@@ -5391,9 +5355,9 @@ status_code_e s1ap_send_mme_ue_context_release(oai::S1apState* state,
     OAILOG_FUNC_RETURN(LOG_S1AP, RETURNerror);
   }
 
-  oai::EnbDescription enb_ref_p;
-  if ((s1ap_state_get_enb(state, ue_ref_p->sctp_assoc_id(), &enb_ref_p)) !=
-      PROTO_MAP_OK) {
+  const oai::EnbDescription* enb_ref_p =
+      s1ap_state_get_enb(state, ue_ref_p->sctp_assoc_id());
+  if (enb_ref_p == nullptr) {
     OAILOG_ERROR(LOG_S1AP,
                  "Failed to get enb_association context for assoc_id: %u",
                  ue_ref_p->sctp_assoc_id());
@@ -5404,7 +5368,7 @@ status_code_e s1ap_send_mme_ue_context_release(oai::S1apState* state,
       ue_ref_p->mme_ue_s1ap_id();
   S1AP_UE_CONTEXT_RELEASE_REQ(message_p).enb_ue_s1ap_id =
       ue_ref_p->enb_ue_s1ap_id();
-  S1AP_UE_CONTEXT_RELEASE_REQ(message_p).enb_id = enb_ref_p.enb_id();
+  S1AP_UE_CONTEXT_RELEASE_REQ(message_p).enb_id = enb_ref_p->enb_id();
   S1AP_UE_CONTEXT_RELEASE_REQ(message_p).relCause = s1_release_cause;
   S1AP_UE_CONTEXT_RELEASE_REQ(message_p).cause = ie_cause;
 
@@ -215,9 +215,9 @@ static int s1ap_paging_compare_tac(uint8_t enb_tac,
    ENBs
            - tai_matching=1 if both TAC and PLMN matches with list of ENBs
 */
-int s1ap_paging_compare_ta_lists(magma::lte::oai::SupportedTaList& enb_ta_list,
-                                 const paging_tai_list_t* p_tai_list,
-                                 uint8_t p_tai_list_count) {
+int s1ap_paging_compare_ta_lists(
+    const magma::lte::oai::SupportedTaList& enb_ta_list,
+    const paging_tai_list_t* p_tai_list, uint8_t p_tai_list_count) {
   bool tac_ret = false, bplmn_ret = false;
   int enb_tai_count, p_list_count;
 
@@ -227,7 +227,7 @@ int s1ap_paging_compare_ta_lists(magma::lte::oai::SupportedTaList& enb_ta_list,
       OAILOG_ERROR(LOG_S1AP, "TAI Item not found in eNB TA List\n");
       return false;
     }
-    magma::lte::oai::SupportedTaiItems enb_tai_item =
+    const magma::lte::oai::SupportedTaiItems& enb_tai_item =
         enb_ta_list.supported_tai_items(enb_tai_count);
     for (p_list_count = 0; p_list_count < p_tai_list_count; p_list_count++) {
       const paging_tai_list_t* tai = NULL;
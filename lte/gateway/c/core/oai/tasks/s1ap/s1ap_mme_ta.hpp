@@ -39,8 +39,8 @@ enum {
 };
 
 int s1ap_mme_compare_ta_lists(S1ap_SupportedTAs_t* ta_list);
-int s1ap_paging_compare_ta_lists(magma::lte::oai::SupportedTaList& enb_ta_list,
-                                 const paging_tai_list_t* p_tai_list,
-                                 uint8_t p_tai_list_count);
+int s1ap_paging_compare_ta_lists(
+    const magma::lte::oai::SupportedTaList& enb_ta_list,
+    const paging_tai_list_t* p_tai_list, uint8_t p_tai_list_count);
 
 #endif /* FILE_S1AP_MME_TA_SEEN */
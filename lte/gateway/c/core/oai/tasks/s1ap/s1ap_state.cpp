@@ -52,20 +52,36 @@ void put_s1ap_state() {
   S1apStateManager::getInstance().write_s1ap_state_to_db();
 }
 
-proto_map_rc_t s1ap_state_get_enb(oai::S1apState* state,
-                                  sctp_assoc_id_t assoc_id,
-                                  oai::EnbDescription* enb) {
-  proto_map_uint32_enb_description_t enb_map;
-  enb_map.map = state->mutable_enbs();
-  return enb_map.get(assoc_id, enb);
+void flush_s1ap_state() { S1apStateManager::getInstance().flush_state_to_db(); }
+
+oai::EnbDescription* s1ap_state_get_enb(oai::S1apState* state,
+                                        sctp_assoc_id_t assoc_id) {
+  auto enb_it = state->mutable_enbs()->find(assoc_id);
+  if (enb_it == state->mutable_enbs()->end()) {
+    return nullptr;
+  }
+  return &enb_it->second;
 }
 
-proto_map_rc_t s1ap_state_update_enb_map(oai::S1apState* state,
-                                         sctp_assoc_id_t assoc_id,
-                                         oai::EnbDescription* enb) {
-  proto_map_uint32_enb_description_t enb_map;
-  enb_map.map = state->mutable_enbs();
-  return enb_map.update_val(assoc_id, enb);
+oai::EnbDescription* s1ap_state_get_enb_by_enb_id(oai::S1apState* state,
+                                                  uint32_t enb_id) {
+  for (auto& enb_it : *state->mutable_enbs()) {
+    if (enb_it.second.sctp_assoc_id() && enb_it.second.enb_id() == enb_id) {
+      return &enb_it.second;
+    }
+  }
+  return nullptr;
+}
+
+void s1ap_state_mark_enb_dirty(const oai::EnbDescription* enb) {
+  if (enb == nullptr) {
+    return;
+  }
+  S1apStateManager::getInstance().mark_enb_state_dirty();
+}
+
+bool s1ap_state_is_dirty() {
+  return S1apStateManager::getInstance().is_enb_state_dirty();
 }
 
 oai::UeDescription* s1ap_state_get_ue_enbid(sctp_assoc_id_t sctp_assoc_id,
@@ -205,13 +221,13 @@ void remove_ues_without_imsi_from_ue_id_coll() {
 
   // get each eNB in s1ap_state
   for (auto itr = enb_map.map->begin(); itr != enb_map.map->end(); itr++) {
-    struct oai::EnbDescription enb_association_p = itr->second;
-    if (!enb_association_p.sctp_assoc_id()) {
+    oai::EnbDescription* enb_association_p = &itr->second;
+    if (!enb_association_p->sctp_assoc_id()) {
       continue;
     }
 
     magma::proto_map_uint32_uint64_t ue_id_coll;
-    ue_id_coll.map = enb_association_p.mutable_ue_id_map();
+    ue_id_coll.map = enb_association_p->mutable_ue_id_map();
     if (ue_id_coll.isEmpty()) {
       continue;
     }
@@ -237,15 +253,14 @@ void remove_ues_without_imsi_from_ue_id_coll() {
       ue_id_coll.remove(mme_ue_id_no_imsi_list[i]);
 
       ueid_imsi_map.remove(mme_ue_id_no_imsi_list[i]);
-      enb_association_p.set_nb_ue_associated(
-          (enb_association_p.nb_ue_associated() - 1));
+      enb_association_p->set_nb_ue_associated(
+          (enb_association_p->nb_ue_associated() - 1));
 
       OAILOG_DEBUG(LOG_S1AP,
                    "Num UEs associated %u num elements in ue_id_coll %zu",
-                   enb_association_p.nb_ue_associated(), ue_id_coll.size());
+                   enb_association_p->nb_ue_associated(), ue_id_coll.size());
     }
-    s1ap_state_update_enb_map(s1ap_state_p, enb_association_p.sctp_assoc_id(),
-                              &enb_association_p);
+    s1ap_state_mark_enb_dirty(enb_association_p);
   }
 }
 
@@ -34,7 +34,9 @@ namespace magma {
 namespace lte {
 
 S1apStateManager::S1apStateManager()
-    : s1ap_imsi_map_hash_(0), s1ap_imsi_map_(nullptr) {}
+    : s1ap_imsi_map_hash_(0),
+      enb_state_dirty_(false),
+      s1ap_imsi_map_(nullptr) {}
 
 S1apStateManager::~S1apStateManager() { free_state(); }
 
@@ -105,7 +107,7 @@ void free_s1ap_state(oai::S1apState* state_cache_p) {
     OAILOG_DEBUG(LOG_S1AP, "No keys in the enb map");
   } else {
     for (auto itr = enb_map.map->begin(); itr != enb_map.map->end(); itr++) {
-      oai::EnbDescription enb = itr->second;
+      oai::EnbDescription& enb = itr->second;
       enb.clear_ue_id_map();
     }
   }
@@ -136,43 +138,31 @@ status_code_e S1apStateManager::read_ue_state_from_db() {
     return RETURNok;
   }
   auto keys = redis_client->get_keys("IMSI*" + task_name + "*");
-
-  for (const auto& key : keys) {
-    OAILOG_DEBUG(log_task, "Reading UE state from db for %s", key.c_str());
-    oai::UeDescription ue_proto = oai::UeDescription();
-    auto* ue_context = new oai::UeDescription();
-    if (!ue_context) {
-      OAILOG_ERROR(log_task, "Failed to allocate memory for ue context");
-      return RETURNerror;
-    }
-    if (redis_client->read_proto(key, ue_proto) != RETURNok) {
-      return RETURNerror;
-    }
-
-    // Update each UE state version from redis
-    this->ue_state_version[key] = redis_client->read_version(table_key);
-
-    ue_context->MergeFrom(ue_proto);
-
-    proto_map_rc_t rc =
-        state_ue_map.insert(ue_context->comp_s1ap_id(), ue_context);
-    if (rc != PROTO_MAP_OK) {
-      OAILOG_ERROR(
-          log_task,
-          "Failed to insert UE state with key comp_s1ap_id " COMP_S1AP_ID_FMT
-          ", ENB UE S1AP Id: " ENB_UE_S1AP_ID_FMT
-          ", MME UE S1AP Id: " MME_UE_S1AP_ID_FMT " (Error Code: %s)\n",
-          ue_context->comp_s1ap_id(), ue_context->enb_ue_s1ap_id(),
-          ue_context->mme_ue_s1ap_id(), magma::map_rc_code2string(rc));
-    } else {
-      OAILOG_DEBUG(log_task,
-                   "Inserted UE state with key comp_s1ap_id " COMP_S1AP_ID_FMT
-                   ", ENB UE S1AP Id: " ENB_UE_S1AP_ID_FMT
-                   ", MME UE S1AP Id: " MME_UE_S1AP_ID_FMT,
-                   ue_context->comp_s1ap_id(), ue_context->enb_ue_s1ap_id(),
-                   ue_context->mme_ue_s1ap_id());
-    }
-  }
+  return read_ue_protos_from_db<oai::UeDescription>(
+      keys, [this](const std::string& key, oai::UeDescription& ue_proto) {
+        auto* ue_context = new oai::UeDescription();
+        ue_context->Swap(&ue_proto);
+
+        proto_map_rc_t rc =
+            state_ue_map.insert(ue_context->comp_s1ap_id(), ue_context);
+        if (rc != PROTO_MAP_OK) {
+          OAILOG_ERROR(
+              log_task,
+              "Failed to insert UE state with key comp_s1ap_id"
+              " " COMP_S1AP_ID_FMT ", ENB UE S1AP Id: " ENB_UE_S1AP_ID_FMT
+              ", MME UE S1AP Id: " MME_UE_S1AP_ID_FMT " (Error Code: %s)\n",
+              ue_context->comp_s1ap_id(), ue_context->enb_ue_s1ap_id(),
+              ue_context->mme_ue_s1ap_id(), magma::map_rc_code2string(rc));
+        } else {
+          OAILOG_DEBUG(
+              log_task,
+              "Inserted UE state with key comp_s1ap_id " COMP_S1AP_ID_FMT
+              ", ENB UE S1AP Id: " ENB_UE_S1AP_ID_FMT
+              ", MME UE S1AP Id: " MME_UE_S1AP_ID_FMT,
+              ue_context->comp_s1ap_id(), ue_context->enb_ue_s1ap_id(),
+              ue_context->mme_ue_s1ap_id());
+        }
+      });
 #endif
   return RETURNok;
 }
@@ -244,22 +234,11 @@ void S1apStateManager::write_s1ap_state_to_db() {
     return;
   }
 
+  clear_enb_state_dirty();
   if (persist_state_enabled) {
     std::string proto_str;
     redis_client->serialize(*state_cache_p, proto_str);
-    std::size_t new_hash = std::hash<std::string>{}(proto_str);
-
-    if (new_hash != this->task_state_hash) {
-      if (redis_client->write_proto_str(table_key, proto_str,
-                                        this->task_state_version) != RETURNok) {
-        OAILOG_ERROR(log_task, "Failed to write state to db");
-        return;
-      }
-      OAILOG_DEBUG(log_task, "Finished writing state");
-      this->task_state_version++;
-      this->state_dirty = false;
-      this->task_state_hash = new_hash;
-    }
+    stage_state_write(proto_str);
   }
 }
 
@@ -271,20 +250,7 @@ void S1apStateManager::s1ap_write_ue_state_to_db(
 
   std::string proto_str;
   redis_client->serialize(*ue_context, proto_str);
-  std::size_t new_hash = std::hash<std::string>{}(proto_str);
-  if (new_hash != this->ue_state_hash[imsi_str]) {
-    std::string key = IMSI_STR_PREFIX + imsi_str + ":" + task_name;
-    if (redis_client->write_proto_str(key, proto_str,
-                                      ue_state_version[imsi_str]) != RETURNok) {
-      OAILOG_ERROR(log_task, "Failed to write UE state to db for IMSI %s",
-                   imsi_str.c_str());
-      return;
-    }
-    this->ue_state_version[imsi_str]++;
-    this->ue_state_hash[imsi_str] = new_hash;
-    OAILOG_DEBUG(log_task, "Finished writing UE state for IMSI %s",
-                 imsi_str.c_str());
-  }
+  stage_ue_state_write(imsi_str, proto_str);
 }
 
 status_code_e S1apStateManager::read_state_from_db() {
@@ -96,6 +96,15 @@ class S1apStateManager : public StateUtility {
   map_uint64_ue_description_t* get_s1ap_ue_state();
   oai::S1apState* get_state(bool read_from_db);
   void write_s1ap_state_to_db();
+
+  /**
+   * Records that an eNB association was modified in place, the task state is
+   * written to db on the next write_s1ap_state_to_db
+   */
+  void mark_enb_state_dirty() { enb_state_dirty_ = true; }
+  bool is_enb_state_dirty() const { return enb_state_dirty_; }
+  void clear_enb_state_dirty() { enb_state_dirty_ = false; }
+
   void s1ap_write_ue_state_to_db(const oai::UeDescription* ue_context,
                                  const std::string& imsi_str);
   status_code_e read_state_from_db();
@@ -113,15 +122,10 @@ class S1apStateManager : public StateUtility {
   void clear_s1ap_imsi_map();
 
   std::size_t s1ap_imsi_map_hash_;
+  bool enb_state_dirty_;
   oai::S1apImsiMap* s1ap_imsi_map_;
   map_uint64_ue_description_t state_ue_map;
   oai::S1apState* state_cache_p;
-  // State version counters for task and ue context
-  uint64_t task_state_version;
-  std::unordered_map<std::string, uint64_t> ue_state_version;
-  // Last written hash values for task and ue context
-  std::size_t task_state_hash;
-  std::unordered_map<std::string, std::size_t> ue_state_hash;
 };
 
 }  // namespace lte
@@ -57,8 +57,8 @@ int S1apUeContext::StartTimer(size_t msec, timer_repeat_t repeat,
                               zloop_timer_fn handler,
                               const s1ap_timer_arg_t arg) {
   int timer_id = -1;
-  if ((timer_id = start_timer(&s1ap_task_zmq_ctx, msec, repeat, handler,
-                              nullptr)) != -1) {
+  if ((timer_id = start_wheel_timer(&s1ap_task_zmq_ctx, msec, repeat,
+                                    handler, nullptr)) != -1) {
     s1ap_timers.insert(std::pair<int, s1ap_timer_arg_t>(timer_id, arg));
   }
   return timer_id;
@@ -66,7 +66,7 @@ int S1apUeContext::StartTimer(size_t msec, timer_repeat_t repeat,
 
 //------------------------------------------------------------------------------
 void S1apUeContext::StopTimer(int timer_id) {
-  stop_timer(&s1ap_task_zmq_ctx, timer_id);
+  stop_wheel_timer(&s1ap_task_zmq_ctx, timer_id);
   s1ap_timers.erase(timer_id);
 }
 
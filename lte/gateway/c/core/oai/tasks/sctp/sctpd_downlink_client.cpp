@@ -25,47 +25,37 @@ extern "C" {
 #include "lte/gateway/c/core/oai/include/mme_config.h"
 }
 
+#include <chrono>
 #include <memory>  // for make_unique<>
 #include <unistd.h>
 
-#include <grpcpp/grpcpp.h>
-
-#include <lte/protos/sctpd.grpc.pb.h>
-
 #include "lte/gateway/c/core/common/dynamic_memory_check.h"
 
 namespace magma {
 namespace lte {
 
-using grpc::Channel;
 using grpc::ClientContext;
 
-using magma::sctpd::InitReq;
-using magma::sctpd::InitRes;
-using magma::sctpd::SctpdDownlink;
-using magma::sctpd::SendDlReq;
-using magma::sctpd::SendDlRes;
-
-class SctpdDownlinkClient {
- public:
-  explicit SctpdDownlinkClient(const std::shared_ptr<Channel>& channel,
-                               bool force_restart);
-
-  int init(InitReq& req, InitRes* res);
-  int sendDl(SendDlReq& req, SendDlRes* res);
-
-  bool should_force_restart = false;
-
- private:
-  std::unique_ptr<SctpdDownlink::Stub> _stub;
-};
-
 SctpdDownlinkClient::SctpdDownlinkClient(
-    const std::shared_ptr<Channel>& channel, bool force_restart) {
+    const std::shared_ptr<Channel>& channel, bool force_restart)
+    : _channel(channel) {
   _stub = SctpdDownlink::NewStub(channel);
   should_force_restart = force_restart;
 }
 
+SctpdDownlinkClient::~SctpdDownlinkClient() {
+  if (_thread == nullptr) return;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _done = true;
+    if (_context != nullptr) {
+      _context->TryCancel();
+    }
+    _cv.notify_all();
+  }
+  _thread->join();
+}
+
 int SctpdDownlinkClient::init(InitReq& req, InitRes* res) {
   assert(res != nullptr);
 
@@ -96,6 +86,157 @@ int SctpdDownlinkClient::sendDl(SendDlReq& req, SendDlRes* res) {
   return status.ok() ? 0 : -1;
 }
 
+void SctpdDownlinkClient::start_stream() {
+  assert(_thread == nullptr);
+  _thread = std::make_unique<std::thread>(&SctpdDownlinkClient::run_stream,
+                                          this);
+}
+
+int SctpdDownlinkClient::sendDlStream(const SendDlReq& req) {
+  // Fail the packet rather than queue it while sctpd cannot be reached
+  auto state = _channel->GetState(true);
+  if (state == GRPC_CHANNEL_TRANSIENT_FAILURE ||
+      state == GRPC_CHANNEL_SHUTDOWN) {
+    OAILOG_ERROR(LOG_SCTP, "sctpdl.senddlstream error: sctpd unreachable\n");
+    return -1;
+  }
+  std::unique_lock<std::mutex> lock(_mutex);
+  if (_stream_broken) {
+    OAILOG_ERROR(LOG_SCTP, "sctpdl.senddlstream error: stream broken\n");
+    return -1;
+  }
+  // Block the SCTP task rather than queue without bound if sctpd lags
+  bool queued = _cv.wait_for(
+      lock, std::chrono::milliseconds(dl_queue_timeout_ms),
+      [this] { return _done || _queue.size() < max_dl_queue_size; });
+  if (_done) return -1;
+  if (!queued) {
+    OAILOG_ERROR(LOG_SCTP, "sctpdl.senddlstream error: queue full\n");
+    return -1;
+  }
+  _queue.push_back(req);
+  _cv.notify_all();
+  return 0;
+}
+
+void SctpdDownlinkClient::run_stream() {
+  while (true) {
+    ClientContext context;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if (_done) break;
+      _context = &context;
+    }
+    auto stream = _stub->SendDlStream(&context);
+    std::thread reader(&SctpdDownlinkClient::read_acks, this, stream.get());
+
+    SendDlBatchReq batch;
+    while (next_batch(&batch)) {
+      if (!stream->Write(batch)) {
+        // The batch stays unacked and is resent with the ones written before
+        OAILOG_ERROR(LOG_SCTP, "sctpdl.senddlstream write failed\n");
+        break;
+      }
+    }
+
+    stream->WritesDone();
+    reader.join();
+    auto status = stream->Finish();
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _context = nullptr;
+    }
+    if (!status.ok()) {
+      OAILOG_ERROR(LOG_SCTP, "sctpdl.senddlstream error = %s\n",
+                   status.error_message().c_str());
+    }
+
+    resend_unacked();
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if (_done) break;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+}
+
+void SctpdDownlinkClient::resend_unacked() {
+  std::deque<SendDlBatchReq> unacked;
+  {
+    // Left in _unacked until resent
+    std::lock_guard<std::mutex> lock(_mutex);
+    unacked = _unacked;
+    _stream_broken = false;
+  }
+  if (unacked.empty()) return;
+
+  // sctpd may have sent a batch whose ack was lost with the stream, a
+  // duplicate is preferred to a gap in the per association order
+  int resent = 0;
+  for (auto& batch : unacked) {
+    for (auto& msg : *batch.mutable_msgs()) {
+      SendDlRes res;
+      if (sendDl(msg, &res) != 0 || res.result() != SendDlRes::SEND_DL_OK) {
+        OAILOG_ERROR(LOG_SCTP, "assoc_id %u stream %u send failed\n",
+                     msg.assoc_id(), msg.stream());
+      }
+    }
+    resent += batch.msgs_size();
+  }
+  OAILOG_ERROR(LOG_SCTP,
+               "sctpdl.senddlstream broke, resent %d unacked messages\n",
+               resent);
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  _unacked.clear();
+  _cv.notify_all();
+}
+
+bool SctpdDownlinkClient::next_batch(SendDlBatchReq* batch) {
+  std::unique_lock<std::mutex> lock(_mutex);
+  _cv.wait(lock, [this] {
+    return _done || _stream_broken ||
+           (!_queue.empty() && _unacked.size() < max_dl_inflight_batches);
+  });
+  if (_done || _stream_broken) return false;
+
+  batch->Clear();
+  batch->set_seq(_next_seq++);
+  while (!_queue.empty() && batch->msgs_size() < max_dl_batch_size) {
+    *batch->add_msgs() = std::move(_queue.front());
+    _queue.pop_front();
+  }
+  _unacked.push_back(*batch);
+  _cv.notify_all();
+  return true;
+}
+
+void SctpdDownlinkClient::read_acks(
+    ClientReaderWriter<SendDlBatchReq, SendDlBatchRes>* stream) {
+  SendDlBatchRes ack;
+
+  while (stream->Read(&ack)) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    while (!_unacked.empty() && _unacked.front().seq() <= ack.seq()) {
+      const auto& batch = _unacked.front();
+      if (batch.seq() == ack.seq()) {
+        for (int i = 0; i < batch.msgs_size() && i < ack.results_size(); i++) {
+          if (ack.results(i).result() != SendDlRes::SEND_DL_OK) {
+            OAILOG_ERROR(LOG_SCTP, "assoc_id %u stream %u send failed\n",
+                         batch.msgs(i).assoc_id(), batch.msgs(i).stream());
+          }
+        }
+      }
+      _unacked.pop_front();
+    }
+    _cv.notify_all();
+  }
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  _stream_broken = true;
+  _cv.notify_all();
+}
+
 }  // namespace lte
 }  // namespace magma
 
@@ -116,6 +257,10 @@ int init_sctpd_downlink_client(bool force_restart) {
   auto channel = grpc::CreateChannel(downstream_sctp_sock,
                                      grpc::InsecureChannelCredentials());
   client = std::make_unique<SctpdDownlinkClient>(channel, force_restart);
+  if (mme_config.sctp_config.downstream_streaming) {
+    OAILOG_INFO(LOG_SCTP, "Relaying downlink over SendDlStream\n");
+    client->start_stream();
+  }
   return 0;
 }
 
@@ -195,6 +340,15 @@ int sctpd_send_dl(uint32_t ppid, uint32_t assoc_id, uint16_t stream,
   req.set_stream(stream);
   req.set_payload(bdata(payload), blength(payload));
 
+  if (mme_config.sctp_config.downstream_streaming) {
+    auto rc = client->sendDlStream(req);
+    if (rc != 0) {
+      OAILOG_ERROR(LOG_SCTP, "assoc_id %u stream %u rc = %d\n", assoc_id,
+                   (uint32_t)stream, rc);
+    }
+    return rc;
+  }
+
   auto rc = client->sendDl(req, &res);
 
   if (rc != 0) {
@@ -19,10 +19,92 @@
 
 #include <stdint.h>
 
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include <grpcpp/grpcpp.h>
+
+#include <lte/protos/sctpd.grpc.pb.h>
+
 #include "lte/gateway/c/core/oai/lib/bstr/bstrlib.h"
 
 #include "lte/gateway/c/core/oai/include/sctp_messages_types.hpp"
 
+namespace magma {
+namespace lte {
+
+using grpc::Channel;
+using grpc::ClientReaderWriter;
+
+using magma::sctpd::InitReq;
+using magma::sctpd::InitRes;
+using magma::sctpd::SctpdDownlink;
+using magma::sctpd::SendDlBatchReq;
+using magma::sctpd::SendDlBatchRes;
+using magma::sctpd::SendDlReq;
+using magma::sctpd::SendDlRes;
+
+// Max number of downlink packets coalesced into a single SendDlBatchReq
+constexpr int max_dl_batch_size = 64;
+// Max number of batches awaiting acknowledgement from sctpd
+constexpr size_t max_dl_inflight_batches = 8;
+// Max number of queued downlink packets before sendDlStream blocks
+constexpr size_t max_dl_queue_size = 4096;
+// Max time sendDlStream blocks on a full queue before failing the packet
+constexpr int dl_queue_timeout_ms = 2000;
+
+class SctpdDownlinkClient {
+ public:
+  explicit SctpdDownlinkClient(const std::shared_ptr<Channel>& channel,
+                               bool force_restart);
+  ~SctpdDownlinkClient();
+
+  int init(InitReq& req, InitRes* res);
+  int sendDl(SendDlReq& req, SendDlRes* res);
+  // Queue a downlink packet on the SendDlStream. Returns -1 without queuing
+  // when sctpd is unreachable, the stream just broke or the queue stayed
+  // full for dl_queue_timeout_ms. Failures of queued packets are logged when
+  // sctpd acknowledges the batch carrying them.
+  int sendDlStream(const SendDlReq& req);
+  // Start the writer thread relaying queued packets over SendDlStream
+  void start_stream();
+
+  bool should_force_restart = false;
+
+ private:
+  // Writer loop, (re)opens the stream as needed
+  void run_stream();
+  // Pop queued packets into batch, returns false when the stream broke
+  bool next_batch(SendDlBatchReq* batch);
+  // Ack loop reading SendDlBatchRes off the stream
+  void read_acks(ClientReaderWriter<SendDlBatchReq, SendDlBatchRes>* stream);
+  // Relay the batches left unacknowledged by a broken stream over unary
+  // SendDl calls, in order, before any packet still queued
+  void resend_unacked();
+
+  std::shared_ptr<Channel> _channel;
+  std::unique_ptr<SctpdDownlink::Stub> _stub;
+
+  std::mutex _mutex;
+  std::condition_variable _cv;
+  std::deque<SendDlReq> _queue;
+  // Batches written but not yet acknowledged, to report per packet results
+  std::deque<SendDlBatchReq> _unacked;
+  uint64_t _next_seq = 0;
+  bool _stream_broken = false;
+  bool _done = false;
+  // Context of the open stream, cancelled on destruction to unblock the
+  // writer and the ack loop
+  grpc::ClientContext* _context = nullptr;
+  std::unique_ptr<std::thread> _thread;
+};
+
+}  // namespace lte
+}  // namespace magma
+
 int init_sctpd_downlink_client(bool force_restart);
 
 // init
@@ -24,6 +24,7 @@ extern "C" {
 #include "lte/gateway/c/core/oai/include/mme_config.h"
 }
 
+#include <cinttypes>
 #include <memory>
 
 #include <grpcpp/grpcpp.h>
@@ -36,6 +37,7 @@ namespace magma {
 namespace mme {
 
 using grpc::ServerContext;
+using grpc::ServerReaderWriter;
 using grpc::Status;
 
 using magma::sctpd::CloseAssocReq;
@@ -43,6 +45,8 @@ using magma::sctpd::CloseAssocRes;
 using magma::sctpd::NewAssocReq;
 using magma::sctpd::NewAssocRes;
 using magma::sctpd::SctpdUplink;
+using magma::sctpd::SendUlBatchReq;
+using magma::sctpd::SendUlBatchRes;
 using magma::sctpd::SendUlReq;
 using magma::sctpd::SendUlRes;
 
@@ -52,37 +56,71 @@ class SctpdUplinkImpl final : public SctpdUplink::Service {
 
   Status SendUl(ServerContext* context, const SendUlReq* req,
                 SendUlRes* res) override;
+  Status SendUlStream(
+      ServerContext* context,
+      ServerReaderWriter<SendUlBatchRes, SendUlBatchReq>* stream) override;
   Status NewAssoc(ServerContext* context, const NewAssocReq* req,
                   NewAssocRes* res) override;
   Status CloseAssoc(ServerContext* context, const CloseAssocReq* req,
                     CloseAssocRes* res) override;
+
+ private:
+  // Relay an uplink packet to the S1AP/NGAP task
+  void relay_ul(const SendUlReq& req);
 };
 
 SctpdUplinkImpl::SctpdUplinkImpl() {}
 
 Status SctpdUplinkImpl::SendUl(ServerContext* context, const SendUlReq* req,
                                SendUlRes* res) {
+  relay_ul(*req);
+  return Status::OK;
+}
+
+Status SctpdUplinkImpl::SendUlStream(
+    ServerContext* context,
+    ServerReaderWriter<SendUlBatchRes, SendUlBatchReq>* stream) {
+  SendUlBatchReq batch;
+  SendUlBatchRes ack;
+
+  OAILOG_INFO(LOG_SCTP, "sctpd uplink stream opened\n");
+  // The next batch is only read once the previous one has been relayed, so a
+  // congested MME applies backpressure to sctpd through grpc flow control
+  while (stream->Read(&batch)) {
+    for (const auto& msg : batch.msgs()) {
+      relay_ul(msg);
+    }
+    ack.set_seq(batch.seq());
+    if (!stream->Write(ack)) {
+      OAILOG_ERROR(LOG_SCTP, "failed to ack uplink batch %" PRIu64 "\n",
+                   batch.seq());
+      break;
+    }
+  }
+  OAILOG_INFO(LOG_SCTP, "sctpd uplink stream closed\n");
+
+  return Status::OK;
+}
+
+void SctpdUplinkImpl::relay_ul(const SendUlReq& req) {
   bstring payload;
   uint32_t ppid;
   uint32_t assoc_id;
   uint16_t stream;
 
-  payload = blk2bstr(req->payload().c_str(), req->payload().size());
+  payload = blk2bstr(req.payload().c_str(), req.payload().size());
   if (payload == NULL) {
     OAILOG_ERROR(LOG_SCTP, "failed to allocate bstr for SendUl\n");
-    return Status::OK;
+    return;
   }
 
-  ppid = req->ppid();
-  assoc_id = req->assoc_id();
-  stream = req->stream();
+  ppid = req.ppid();
+  assoc_id = req.assoc_id();
+  stream = req.stream();
 
   if (sctp_itti_send_new_message_ind(&payload, ppid, assoc_id, stream) < 0) {
     OAILOG_ERROR(LOG_SCTP, "failed to send new_message_ind for SendUl\n");
-    return Status::OK;
   }
-
-  return Status::OK;
 }
 
 #include <assert.h>
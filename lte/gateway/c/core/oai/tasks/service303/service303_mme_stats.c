@@ -19,6 +19,7 @@
 #include <stddef.h>
 #include "lte/gateway/c/core/oai/common/log.h"
 #include "lte/gateway/c/core/oai/include/service303.hpp"
+#include "lte/gateway/c/core/oai/lib/itti/intertask_interface.h"
 #include "orc8r/gateway/c/common/service303/MetricsHelpers.hpp"
 
 void service303_mme_app_statistics_read(
@@ -40,6 +41,18 @@ void service303_s1ap_statistics_read(
             label);
 }
 
+void service303_itti_statistics_read(void) {
+  static uint64_t last_hits = 0;
+  static uint64_t last_misses = 0;
+  uint64_t hits, misses;
+
+  itti_get_msg_pool_stats(&hits, &misses);
+  increment_counter("itti_msg_pool_hits", hits - last_hits, NO_LABELS);
+  increment_counter("itti_msg_pool_misses", misses - last_misses, NO_LABELS);
+  last_hits = hits;
+  last_misses = misses;
+}
+
 void service303_statistics_display(void) {
   size_t label = 0;
   OAILOG_DEBUG(LOG_SERVICE303,
@@ -45,7 +45,7 @@ static int handle_service303_server_message(zloop_t* loop, zsock_t* reader,
   switch (ITTI_MSG_ID(received_message_p)) {
     case TERMINATE_MESSAGE:
       itti_free_msg_content(received_message_p);
-      free(received_message_p);
+      itti_free_msg(received_message_p);
       service303_server_exit();
       break;
     default: {
@@ -56,7 +56,7 @@ static int handle_service303_server_message(zloop_t* loop, zsock_t* reader,
   }
 
   itti_free_msg_content(received_message_p);
-  free(received_message_p);
+  itti_free_msg(received_message_p);
   return 0;
 }
 
@@ -97,7 +97,7 @@ static int handle_service_message(zloop_t* loop, zsock_t* reader, void* arg) {
           &received_message_p->ittiMsg.application_s1ap_stats_msg);
     } break;
     case TERMINATE_MESSAGE:
-      free(received_message_p);
+      itti_free_msg(received_message_p);
       service303_message_exit();
       break;
     default: {
@@ -107,7 +107,7 @@ static int handle_service_message(zloop_t* loop, zsock_t* reader, void* arg) {
     } break;
   }
 
-  free(received_message_p);
+  itti_free_msg(received_message_p);
   return 0;
 }
 
@@ -159,6 +159,7 @@ static void service303_message_exit(void) {
 }
 
 static int handle_display_timer(zloop_t* loop, int id, void* arg) {
+  service303_itti_statistics_read();
   service303_statistics_display();
   return 0;
 }
@@ -157,7 +157,7 @@ static int handle_message(zloop_t* loop, zsock_t* reader, void* arg) {
       send_ue_unreachable(&SGSAP_UE_UNREACHABLE(received_message_p));
     } break;
     case TERMINATE_MESSAGE: {
-      free(received_message_p);
+      itti_free_msg(received_message_p);
       sgs_exit();
     } break;
 
@@ -168,7 +168,7 @@ static int handle_message(zloop_t* loop, zsock_t* reader, void* arg) {
     } break;
   }
 
-  free(received_message_p);
+  itti_free_msg(received_message_p);
   return 0;
 }
 
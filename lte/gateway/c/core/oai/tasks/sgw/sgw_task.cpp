@@ -204,7 +204,7 @@ static int handle_message(zloop_t* loop, zsock_t* reader, void* arg) {
 
     case TERMINATE_MESSAGE: {
       itti_free_msg_content(received_message_p);
-      free(received_message_p);
+      itti_free_msg(received_message_p);
       spgw_app_exit();
     } break;
 
@@ -219,9 +219,10 @@ static int handle_message(zloop_t* loop, zsock_t* reader, void* arg) {
     put_spgw_state();
   }
   put_spgw_ue_state(imsi64);
+  flush_spgw_state();
 
   itti_free_msg_content(received_message_p);
-  free(received_message_p);
+  itti_free_msg(received_message_p);
   return 0;
 }
 
@@ -277,6 +278,7 @@ extern "C" status_code_e spgw_app_init(spgw_config_t* spgw_config_pP,
 static void spgw_app_exit(void) {
   OAILOG_DEBUG(LOG_SPGW_APP, "Cleaning SGW\n");
   put_spgw_state();
+  flush_spgw_state();
 #if !MME_UNIT_TEST  // No need to initialize OVS data path for unit tests
   gtpv1u_exit();
 #endif
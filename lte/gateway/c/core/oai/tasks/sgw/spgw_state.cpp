@@ -62,6 +62,8 @@ void spgw_state_exit() { SpgwStateManager::getInstance().free_state(); }
 
 void put_spgw_state() { SpgwStateManager::getInstance().write_state_to_db(); }
 
+void flush_spgw_state() { SpgwStateManager::getInstance().flush_state_to_db(); }
+
 void put_spgw_ue_state(imsi64_t imsi64) {
   if (SpgwStateManager::getInstance().is_persist_state_enabled()) {
     spgw_ue_context_t* ue_context_p = nullptr;
@@ -100,16 +100,11 @@ status_code_e SpgwStateManager::read_ue_state_from_db() {
     return RETURNok;
   }
   auto keys = redis_client->get_keys("IMSI*" + task_name + "*");
-  for (const auto& key : keys) {
-    oai::SpgwUeContext ue_proto = oai::SpgwUeContext();
-    if (redis_client->read_proto(key, ue_proto) != RETURNok) {
-      return RETURNerror;
-    }
-    OAILOG_DEBUG(log_task, "Reading UE state from db for key %s", key.c_str());
-    spgw_ue_context_t* ue_context_p = new spgw_ue_context_t();
-    SpgwStateConverter::proto_to_ue(ue_proto, ue_context_p);
-  }
-  return RETURNok;
+  return read_ue_protos_from_db<oai::SpgwUeContext>(
+      keys, [](const std::string& key, const oai::SpgwUeContext& ue_proto) {
+        spgw_ue_context_t* ue_context_p = new spgw_ue_context_t();
+        SpgwStateConverter::proto_to_ue(ue_proto, ue_context_p);
+      });
 }
 
 state_teid_map_t* SpgwStateManager::get_state_teid_map() {
@@ -52,6 +52,7 @@ void sgw_state_exit() {
 
 void put_sgw_state() {
   SgwStateManager::getInstance().write_state_to_db();
+  SgwStateManager::getInstance().flush_state_to_db();
   return;
 }
 
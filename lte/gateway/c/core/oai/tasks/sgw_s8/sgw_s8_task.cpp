@@ -73,7 +73,7 @@ static int handle_message(zloop_t* loop, zsock_t* reader, void* arg) {
   switch (ITTI_MSG_ID(received_message_p)) {
     case TERMINATE_MESSAGE: {
       itti_free_msg_content(received_message_p);
-      free(received_message_p);
+      itti_free_msg(received_message_p);
       sgw_s8_exit();
     } break;
 
@@ -146,7 +146,7 @@ static int handle_message(zloop_t* loop, zsock_t* reader, void* arg) {
   }
 
   itti_free_msg_content(received_message_p);
-  free(received_message_p);
+  itti_free_msg(received_message_p);
   return 0;
 }
 
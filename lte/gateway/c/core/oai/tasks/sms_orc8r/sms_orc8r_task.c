@@ -56,7 +56,7 @@ static int handle_message(zloop_t* loop, zsock_t* reader, void* arg) {
     } break;
 
     case TERMINATE_MESSAGE: {
-      free(received_message_p);
+      itti_free_msg(received_message_p);
       sms_orc8r_exit();
     } break;
 
@@ -67,7 +67,7 @@ static int handle_message(zloop_t* loop, zsock_t* reader, void* arg) {
     } break;
   }
 
-  free(received_message_p);
+  itti_free_msg(received_message_p);
   return 0;
 }
 
@@ -22,6 +22,7 @@
   \email: lionel.gauthier@eurecom.fr
 */
 
+#define _GNU_SOURCE
 #include <arpa/inet.h>
 #include <errno.h>
 #include <fcntl.h>
@@ -48,8 +49,11 @@
 
 task_zmq_ctx_t udp_task_zmq_ctx;
 
+/* Datagrams received with a single recvmmsg and sent with a single sendmmsg */
+#define UDP_RECV_BATCH 32
+#define UDP_SEND_BATCH 32
+
 struct udp_socket_desc_s {
-  uint8_t buffer[4096];
   int sd; /* Socket descriptor to use */
 
   pthread_t listener_thread; /* Thread affected to recv */
@@ -59,13 +63,36 @@ struct udp_socket_desc_s {
 
   task_id_t task_id; /* Task who has requested the new endpoint */
   STAILQ_ENTRY(udp_socket_desc_s) entries;
+
+  /* recvmmsg vectors, set up once for the socket */
+  struct mmsghdr msgs[UDP_RECV_BATCH];
+  struct iovec iovecs[UDP_RECV_BATCH];
+  struct sockaddr_storage peer_addrs[UDP_RECV_BATCH];
+  uint8_t buffers[UDP_RECV_BATCH][UDP_DATA_MAX_MSG_LEN];
 };
 
+/* UDP_DATA_REQ payloads copied until the end of the batch of ITTI messages.
+ * Only used by the UDP task thread. */
+typedef struct udp_send_batch_s {
+  int num_msgs;
+  int sds[UDP_SEND_BATCH];
+  struct mmsghdr msgs[UDP_SEND_BATCH];
+  struct iovec iovecs[UDP_SEND_BATCH];
+  struct sockaddr_storage peer_addrs[UDP_SEND_BATCH];
+  uint8_t buffers[UDP_SEND_BATCH][UDP_DATA_MAX_MSG_LEN];
+} udp_send_batch_t;
+
 static STAILQ_HEAD(udp_socket_list_s, udp_socket_desc_s) udp_socket_list;
 static pthread_mutex_t udp_socket_list_mutex = PTHREAD_MUTEX_INITIALIZER;
+/* Sockets of udp_socket_list indexed by descriptor, for the readiness events */
+static struct udp_socket_desc_s** udp_socket_table = NULL;
+static int udp_socket_table_size = 0;
+
+static udp_send_batch_t udp_send_batch;
 
 static void udp_server_receive_and_process(
     struct udp_socket_desc_s* udp_sock_pP);
+static int udp_socket_handler(zloop_t* loop, zmq_pollitem_t* item, void* arg);
 
 /* @brief Retrieve the descriptor associated with the task_id
  */
@@ -104,74 +131,247 @@ static struct udp_socket_desc_s* udp_server_get_socket_desc(task_id_t task_id,
 }
 
 static struct udp_socket_desc_s* udp_server_get_socket_desc_by_sd(int sdP) {
-  struct udp_socket_desc_s* udp_sock_p = NULL;
+  if ((sdP < 0) || (sdP >= udp_socket_table_size)) {
+    return NULL;
+  }
+  return udp_socket_table[sdP];
+}
 
-  OAILOG_DEBUG(LOG_UDP, "Looking for sd %d\n", sdP);
-  STAILQ_FOREACH(udp_sock_p, &udp_socket_list, entries) {
-    if (udp_sock_p->sd == sdP) {
-      break;
+//------------------------------------------------------------------------------
+static void udp_server_send_data_ind(struct udp_socket_desc_s* udp_sock_pP,
+                                     int index) {
+  MessageDef* message_p = NULL;
+  udp_data_ind_t* udp_data_ind_p;
+  uint32_t bytes_received = udp_sock_pP->msgs[index].msg_len;
+  bool ipv6 = udp_sock_pP->local_addr.sa_family == AF_INET6;
+
+  message_p = DEPRECATEDitti_alloc_new_message_fatal(TASK_UDP, UDP_DATA_IND);
+  udp_data_ind_p = &message_p->ittiMsg.udp_data_ind;
+  memcpy(udp_data_ind_p->msgBuf, udp_sock_pP->buffers[index], bytes_received);
+
+  udp_data_ind_p->buffer_length = bytes_received;
+  udp_data_ind_p->local_port = udp_sock_pP->local_port;
+  if (ipv6) {
+    udp_data_ind_p->sock_addr.addrv6 =
+        *(struct sockaddr_in6*)&udp_sock_pP->peer_addrs[index];
+    udp_data_ind_p->peer_port =
+        ntohs(udp_data_ind_p->sock_addr.addrv6.sin6_port);
+  } else {
+    udp_data_ind_p->sock_addr.addrv4 =
+        *(struct sockaddr_in*)&udp_sock_pP->peer_addrs[index];
+    udp_data_ind_p->peer_port =
+        ntohs(udp_data_ind_p->sock_addr.addrv4.sin_port);
+  }
+
+  if (send_msg_to_task(&udp_task_zmq_ctx, udp_sock_pP->task_id, message_p) <
+      0) {
+    OAILOG_DEBUG(LOG_UDP, "Failed to send message %d to task %d\n",
+                 UDP_DATA_IND, udp_sock_pP->task_id);
+  }
+}
+
+//------------------------------------------------------------------------------
+// One ITTI message for the datagrams received together, with a single copy of
+// the payloads
+static void udp_server_send_data_batch_ind(
+    struct udp_socket_desc_s* udp_sock_pP, const int* indexes,
+    int num_datagrams) {
+  MessageDef* message_p = NULL;
+  udp_data_batch_ind_t* udp_data_batch_ind_p;
+  size_t payload_length = 0;
+  bool ipv6 = udp_sock_pP->local_addr.sa_family == AF_INET6;
+
+  for (int i = 0; i < num_datagrams; i++) {
+    payload_length += udp_sock_pP->msgs[indexes[i]].msg_len;
+  }
+  udp_datagram_t* datagrams =
+      malloc(num_datagrams * sizeof(udp_datagram_t) + payload_length);
+  AssertFatal(datagrams != NULL, "UDP batch allocation failed");
+  uint8_t* payload = (uint8_t*)&datagrams[num_datagrams];
+
+  for (int i = 0; i < num_datagrams; i++) {
+    int index = indexes[i];
+    udp_datagram_t* datagram = &datagrams[i];
+    datagram->buffer = payload;
+    datagram->buffer_length = udp_sock_pP->msgs[index].msg_len;
+    memcpy(payload, udp_sock_pP->buffers[index], datagram->buffer_length);
+    payload += datagram->buffer_length;
+    if (ipv6) {
+      datagram->sock_addr.addrv6 =
+          *(struct sockaddr_in6*)&udp_sock_pP->peer_addrs[index];
+      datagram->peer_port = ntohs(datagram->sock_addr.addrv6.sin6_port);
+    } else {
+      datagram->sock_addr.addrv4 =
+          *(struct sockaddr_in*)&udp_sock_pP->peer_addrs[index];
+      datagram->peer_port = ntohs(datagram->sock_addr.addrv4.sin_port);
     }
   }
-  return udp_sock_p;
+
+  message_p =
+      DEPRECATEDitti_alloc_new_message_fatal(TASK_UDP, UDP_DATA_BATCH_IND);
+  udp_data_batch_ind_p = &message_p->ittiMsg.udp_data_batch_ind;
+  udp_data_batch_ind_p->local_port = udp_sock_pP->local_port;
+  udp_data_batch_ind_p->num_datagrams = num_datagrams;
+  udp_data_batch_ind_p->datagrams = datagrams;
+
+  if (send_msg_to_task(&udp_task_zmq_ctx, udp_sock_pP->task_id, message_p) <
+      0) {
+    OAILOG_DEBUG(LOG_UDP, "Failed to send message %d to task %d\n",
+                 UDP_DATA_BATCH_IND, udp_sock_pP->task_id);
+  }
 }
 
+//------------------------------------------------------------------------------
+// Receives up to UDP_RECV_BATCH datagrams, sent to the task of the socket in a
+// single UDP_DATA_IND or UDP_DATA_BATCH_IND. Datagrams left are received on
+// the next readiness event, after the other events of the loop.
 static void udp_server_receive_and_process(
     struct udp_socket_desc_s* udp_sock_pP) {
-  OAILOG_DEBUG(LOG_UDP, "Inserting new descriptor for task %d, sd %d\n",
-               udp_sock_pP->task_id, udp_sock_pP->sd);
-  {
-    int bytes_received = 0;
-    socklen_t from_len;
-    struct sockaddr_in addr;
-    struct sockaddr_in6 addr6;
+  int indexes[UDP_RECV_BATCH];
+  int num_datagrams = 0;
 
-    bool ipv6 = udp_sock_pP->local_addr.sa_family == AF_INET6;
+  for (int i = 0; i < UDP_RECV_BATCH; i++) {
+    udp_sock_pP->msgs[i].msg_hdr.msg_namelen =
+        sizeof(udp_sock_pP->peer_addrs[i]);
+  }
+  int num_received = recvmmsg(udp_sock_pP->sd, udp_sock_pP->msgs,
+                              UDP_RECV_BATCH, MSG_DONTWAIT, NULL);
+  if (num_received <= 0) {
+    if ((errno != EAGAIN) && (errno != EWOULDBLOCK)) {
+      OAILOG_ERROR(LOG_UDP, "Recvmmsg failed %s\n", strerror(errno));
+    }
+    return;
+  }
 
-    if (ipv6) {
-      from_len = (socklen_t)sizeof(struct sockaddr_in6);
-      memset(&addr6, 0, sizeof(struct sockaddr_in6));
-    } else {
-      from_len = (socklen_t)sizeof(struct sockaddr_in);
-      memset(&addr, 0, sizeof(struct sockaddr_in));
+  for (int i = 0; i < num_received; i++) {
+    if (udp_sock_pP->msgs[i].msg_hdr.msg_flags & MSG_TRUNC) {
+      OAILOG_ERROR(LOG_UDP,
+                   "Dropping datagram longer than %d bytes on port %u\n",
+                   UDP_DATA_MAX_MSG_LEN, udp_sock_pP->local_port);
+      continue;
     }
+    OAILOG_DEBUG(LOG_UDP, "Msg of length %u received on port %u\n",
+                 udp_sock_pP->msgs[i].msg_len, udp_sock_pP->local_port);
+    indexes[num_datagrams++] = i;
+  }
 
-    if ((bytes_received = recvfrom(
-             udp_sock_pP->sd, udp_sock_pP->buffer, sizeof(udp_sock_pP->buffer),
-             0, ipv6 ? (struct sockaddr*)&addr6 : (struct sockaddr*)&addr,
-             &from_len)) <= 0) {
-      OAILOG_ERROR(LOG_UDP, "Recvfrom failed %s\n", strerror(errno));
-      // break;
-    } else {
-      MessageDef* message_p = NULL;
-      udp_data_ind_t* udp_data_ind_p;
-      AssertFatal(sizeof(udp_sock_pP->buffer) >= bytes_received,
-                  "UDP BUFFER OVERFLOW");
-      message_p =
-          DEPRECATEDitti_alloc_new_message_fatal(TASK_UDP, UDP_DATA_IND);
-      udp_data_ind_p = &message_p->ittiMsg.udp_data_ind;
-      memcpy(udp_data_ind_p->msgBuf, udp_sock_pP->buffer, bytes_received);
-
-      udp_data_ind_p->buffer_length = bytes_received;
-      udp_data_ind_p->local_port = udp_sock_pP->local_port;
-      udp_data_ind_p->peer_port =
-          ipv6 ? htons(addr6.sin6_port) : htons(addr.sin_port);
-      memcpy((void*)&udp_data_ind_p->sock_addr,
-             (ipv6) ? (void*)&addr6 : (void*)&addr,
-             (ipv6) ? sizeof(struct sockaddr_in6) : sizeof(struct sockaddr_in));
-
-      OAILOG_DEBUG(LOG_UDP, "Msg of length %d received from %s:%u\n",
-                   bytes_received,
-                   (!ipv6) ? inet_ntoa(addr.sin_addr) : "TODO_IPV6",
-                   ntohs(addr.sin_port));
-
-      if (send_msg_to_task(&udp_task_zmq_ctx, udp_sock_pP->task_id, message_p) <
-          0) {
-        OAILOG_DEBUG(LOG_UDP, "Failed to send message %d to task %d\n",
-                     UDP_DATA_IND, udp_sock_pP->task_id);
-        // break;
+  if (num_datagrams == 1) {
+    udp_server_send_data_ind(udp_sock_pP, indexes[0]);
+  } else if (num_datagrams > 1) {
+    udp_server_send_data_batch_ind(udp_sock_pP, indexes, num_datagrams);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Sends the queued UDP_DATA_REQ payloads, one sendmmsg per run of datagrams
+// on the same socket
+static void udp_server_flush_send_batch(void) {
+  udp_send_batch_t* batch = &udp_send_batch;
+  int start = 0;
+
+  while (start < batch->num_msgs) {
+    int end = start + 1;
+    while ((end < batch->num_msgs) && (batch->sds[end] == batch->sds[start])) {
+      end++;
+    }
+    int sent = sendmmsg(batch->sds[start], &batch->msgs[start], end - start, 0);
+    if (sent <= 0) {
+      OAILOG_ERROR(LOG_UDP,
+                   "There was an error while writing to socket "
+                   "(%d:%s)\n",
+                   errno, strerror(errno));
+      // Drop the datagram that failed, the next ones are tried again
+      start++;
+      continue;
+    }
+    for (int i = start; i < start + sent; i++) {
+      if (batch->msgs[i].msg_len != batch->iovecs[i].iov_len) {
+        OAILOG_ERROR(LOG_UDP,
+                     "Short write to socket %d, %u of %zu bytes written\n",
+                     batch->sds[i], batch->msgs[i].msg_len,
+                     batch->iovecs[i].iov_len);
       }
     }
+    start += sent;
   }
+  batch->num_msgs = 0;
+}
+
+static void udp_msg_batch_end(task_zmq_ctx_t* task_zmq_ctx_p) {
+  udp_server_flush_send_batch();
+}
+
+//------------------------------------------------------------------------------
+// Copies the datagram in the send batch, sent once the ITTI messages read
+// together have been handled
+static void udp_server_queue_send(int sd, const uint8_t* buffer,
+                                  uint32_t buffer_length,
+                                  const struct sockaddr* peer_addr,
+                                  socklen_t peer_addr_len) {
+  udp_send_batch_t* batch = &udp_send_batch;
+
+  if (buffer_length > UDP_DATA_MAX_MSG_LEN) {
+    // Too long to be copied, sent in order right away
+    udp_server_flush_send_batch();
+    ssize_t bytes_written =
+        sendto(sd, buffer, buffer_length, 0, peer_addr, peer_addr_len);
+    if (bytes_written != buffer_length) {
+      OAILOG_ERROR(LOG_UDP,
+                   "There was an error while writing to socket "
+                   "(%d:%s)\n",
+                   errno, strerror(errno));
+    }
+    return;
+  }
+  if (batch->num_msgs == UDP_SEND_BATCH) {
+    udp_server_flush_send_batch();
+  }
+
+  int i = batch->num_msgs++;
+  batch->sds[i] = sd;
+  memcpy(batch->buffers[i], buffer, buffer_length);
+  batch->iovecs[i].iov_base = batch->buffers[i];
+  batch->iovecs[i].iov_len = buffer_length;
+  memcpy(&batch->peer_addrs[i], peer_addr, peer_addr_len);
+  memset(&batch->msgs[i], 0, sizeof(batch->msgs[i]));
+  batch->msgs[i].msg_hdr.msg_name = &batch->peer_addrs[i];
+  batch->msgs[i].msg_hdr.msg_namelen = peer_addr_len;
+  batch->msgs[i].msg_hdr.msg_iov = &batch->iovecs[i];
+  batch->msgs[i].msg_hdr.msg_iovlen = 1;
+}
+
+//------------------------------------------------------------------------------
+// Sets up the recvmmsg vectors, adds the socket to the list and to the table,
+// and to the list of fd monitored by ITTI
+static void udp_server_add_socket_desc(
+    struct udp_socket_desc_s* socket_desc_p) {
+  int sd = socket_desc_p->sd;
+
+  for (int i = 0; i < UDP_RECV_BATCH; i++) {
+    socket_desc_p->iovecs[i].iov_base = socket_desc_p->buffers[i];
+    socket_desc_p->iovecs[i].iov_len = sizeof(socket_desc_p->buffers[i]);
+    socket_desc_p->msgs[i].msg_hdr.msg_name = &socket_desc_p->peer_addrs[i];
+    socket_desc_p->msgs[i].msg_hdr.msg_iov = &socket_desc_p->iovecs[i];
+    socket_desc_p->msgs[i].msg_hdr.msg_iovlen = 1;
+  }
+
+  pthread_mutex_lock(&udp_socket_list_mutex);
+  STAILQ_INSERT_TAIL(&udp_socket_list, socket_desc_p, entries);
+  if (sd >= udp_socket_table_size) {
+    int table_size = sd + 1;
+    struct udp_socket_desc_s** table =
+        realloc(udp_socket_table, table_size * sizeof(*table));
+    AssertFatal(table != NULL, "UDP socket table allocation failed");
+    memset(&table[udp_socket_table_size], 0,
+           (table_size - udp_socket_table_size) * sizeof(*table));
+    udp_socket_table = table;
+    udp_socket_table_size = table_size;
+  }
+  udp_socket_table[sd] = socket_desc_p;
+  pthread_mutex_unlock(&udp_socket_list_mutex);
+
+  zmq_pollitem_t item = {0, sd, ZMQ_POLLIN, 0};
+  zloop_poller(udp_task_zmq_ctx.event_loop, &item, udp_socket_handler, NULL);
 }
 
 static int udp_socket_handler(zloop_t* loop, zmq_pollitem_t* item, void* arg) {
@@ -179,7 +379,9 @@ static int udp_socket_handler(zloop_t* loop, zmq_pollitem_t* item, void* arg) {
 
   pthread_mutex_lock(&udp_socket_list_mutex);
   udp_sock_p = udp_server_get_socket_desc_by_sd(item->fd);
+  pthread_mutex_unlock(&udp_socket_list_mutex);
 
+  // Descriptors are only freed by udp_exit, on this thread
   if (udp_sock_p != NULL) {
     udp_server_receive_and_process(udp_sock_p);
   } else {
@@ -187,8 +389,6 @@ static int udp_socket_handler(zloop_t* loop, zmq_pollitem_t* item, void* arg) {
                  item->fd);
   }
 
-  pthread_mutex_unlock(&udp_socket_list_mutex);
-
   return 0;
 }
 
@@ -263,12 +463,7 @@ static int udp_server_create_socket_v4(uint16_t port, struct in_addr* address,
   socket_desc_p->task_id = task_id;
   OAILOG_DEBUG(LOG_UDP, "(IPv4) Inserting new descriptor for task %d, sd %d\n",
                socket_desc_p->task_id, socket_desc_p->sd);
-  pthread_mutex_lock(&udp_socket_list_mutex);
-  STAILQ_INSERT_TAIL(&udp_socket_list, socket_desc_p, entries);
-  pthread_mutex_unlock(&udp_socket_list_mutex);
-
-  zmq_pollitem_t item = {0, sd, ZMQ_POLLIN, 0};
-  zloop_poller(udp_task_zmq_ctx.event_loop, &item, udp_socket_handler, NULL);
+  udp_server_add_socket_desc(socket_desc_p);
 
   return sd;
 }
@@ -343,12 +538,7 @@ static int udp_server_create_socket_v6(uint16_t port, struct in6_addr* address,
   socket_desc_p->task_id = task_id;
   OAILOG_DEBUG(LOG_UDP, "(IPv6) Inserting new descriptor for task %d, sd %d\n",
                socket_desc_p->task_id, socket_desc_p->sd);
-  pthread_mutex_lock(&udp_socket_list_mutex);
-  STAILQ_INSERT_TAIL(&udp_socket_list, socket_desc_p, entries);
-  pthread_mutex_unlock(&udp_socket_list_mutex);
-
-  zmq_pollitem_t item = {0, sd, ZMQ_POLLIN, 0};
-  zloop_poller(udp_task_zmq_ctx.event_loop, &item, udp_socket_handler, NULL);
+  udp_server_add_socket_desc(socket_desc_p);
 
   return sd;
 }
@@ -363,7 +553,7 @@ static int handle_message(zloop_t* loop, zsock_t* reader, void* arg) {
 
     case TERMINATE_MESSAGE: {
       itti_free_msg_content(received_message_p);
-      free(received_message_p);
+      itti_free_msg(received_message_p);
       udp_exit();
     } break;
 
@@ -379,7 +569,6 @@ static int handle_message(zloop_t* loop, zsock_t* reader, void* arg) {
 
     case UDP_DATA_REQ: {
       int udp_sd = -1;
-      ssize_t bytes_written;
       struct udp_socket_desc_s* udp_sock_p = NULL;
       udp_data_req_t* udp_data_req_p;
       struct sockaddr_in peer_addr;
@@ -421,18 +610,11 @@ static int handle_message(zloop_t* loop, zsock_t* reader, void* arg) {
             PRI_IN_ADDR(
                 ((struct sockaddr_in*)udp_data_req_p->peer_address)->sin_addr),
             udp_data_req_p->peer_port);
-        bytes_written = sendto(
+        udp_server_queue_send(
             udp_sd, &udp_data_req_p->buffer[udp_data_req_p->buffer_offset],
-            udp_data_req_p->buffer_length, 0, (struct sockaddr*)&peer_addr,
+            udp_data_req_p->buffer_length, (struct sockaddr*)&peer_addr,
             sizeof(struct sockaddr_in));
         // no free udp_data_req_p->buffer, statically allocated
-
-        if (bytes_written != udp_data_req_p->buffer_length) {
-          OAILOG_ERROR(LOG_UDP,
-                       "There was an error while writing to socket "
-                       "(%d:%s)\n",
-                       errno, strerror(errno));
-        }
       } else if (udp_data_req_p->peer_address->sa_family == AF_INET6) {
         memset(&peer_addr6, 0, sizeof(struct sockaddr_in6));
         peer_addr6.sin6_family = AF_INET6;
@@ -456,18 +638,11 @@ static int handle_message(zloop_t* loop, zsock_t* reader, void* arg) {
 
         udp_sd = udp_sock_p->sd;
         pthread_mutex_unlock(&udp_socket_list_mutex);
-        bytes_written = sendto(
+        udp_server_queue_send(
             udp_sd, &udp_data_req_p->buffer[udp_data_req_p->buffer_offset],
-            udp_data_req_p->buffer_length, 0, (struct sockaddr*)&peer_addr6,
+            udp_data_req_p->buffer_length, (struct sockaddr*)&peer_addr6,
             sizeof(struct sockaddr_in6));
         // no free udp_data_req_p->buffer, statically allocated
-
-        if (bytes_written != udp_data_req_p->buffer_length) {
-          OAILOG_ERROR(LOG_UDP,
-                       "There was an error while writing to socket "
-                       "(%d:%s)\n",
-                       errno, strerror(errno));
-        }
       }
 
       else {
@@ -484,15 +659,22 @@ static int handle_message(zloop_t* loop, zsock_t* reader, void* arg) {
   }
 
   itti_free_msg_content(received_message_p);
-  free(received_message_p);
+  itti_free_msg(received_message_p);
   return 0;
 }
 
 //------------------------------------------------------------------------------
-static void* udp_thread(void* args) {
-  itti_mark_task_ready(TASK_UDP);
+void udp_init_task_context(void) {
+  STAILQ_INIT(&udp_socket_list);
+  udp_task_zmq_ctx.msg_batch_end_handler = udp_msg_batch_end;
   init_task_context(TASK_UDP, (task_id_t[]){TASK_MME_APP, TASK_S11}, 2,
                     handle_message, &udp_task_zmq_ctx);
+}
+
+//------------------------------------------------------------------------------
+static void* udp_thread(void* args) {
+  itti_mark_task_ready(TASK_UDP);
+  udp_init_task_context();
 
   zloop_start(udp_task_zmq_ctx.event_loop);
   AssertFatal(0, "Asserting as udp_thread should not be exiting on its own!");
@@ -502,7 +684,6 @@ static void* udp_thread(void* args) {
 //------------------------------------------------------------------------------
 int udp_init(void) {
   OAILOG_DEBUG(LOG_UDP, "Initializing UDP task interface\n");
-  STAILQ_INIT(&udp_socket_list);
 
   if (itti_create_task(TASK_UDP, &udp_thread, NULL) < 0) {
     OAILOG_ERROR(LOG_UDP, "udp pthread_create (%s)\n", strerror(errno));
@@ -516,12 +697,15 @@ int udp_init(void) {
 //------------------------------------------------------------------------------
 void udp_exit(void) {
   struct udp_socket_desc_s* socket_desc_p = NULL;
+  udp_server_flush_send_batch();
   while ((socket_desc_p = STAILQ_FIRST(&udp_socket_list))) {
     close(socket_desc_p->sd);
     pthread_mutex_destroy(&udp_socket_list_mutex);
     STAILQ_REMOVE_HEAD(&udp_socket_list, entries);
     free_wrapper((void**)&socket_desc_p);
   }
+  free_wrapper((void**)&udp_socket_table);
+  udp_socket_table_size = 0;
 
   destroy_task_context(&udp_task_zmq_ctx);
   OAI_FPRINTF_INFO("TASK_UDP terminated\n");
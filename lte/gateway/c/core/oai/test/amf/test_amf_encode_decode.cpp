@@ -1057,7 +1057,7 @@ class AmfUeContextTestServiceRequestProc : public ::testing::Test {
 
   virtual void SetUp() {
     itti_init(TASK_MAX, THREAD_MAX, MESSAGES_ID_MAX, tasks_info, messages_info,
-              NULL, NULL);
+              NULL, NULL, ITTI_TRANSPORT_ZMQ);
     amf_config_init(&amf_config);
     amf_nas_state_init(&amf_config);
 
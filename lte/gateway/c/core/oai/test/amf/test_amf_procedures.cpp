@@ -36,7 +36,7 @@ extern task_zmq_ctx_s amf_app_task_zmq_ctx;
 class AMFAppProcedureTest : public ::testing::Test {
   virtual void SetUp() {
     itti_init(TASK_MAX, THREAD_MAX, MESSAGES_ID_MAX, tasks_info, messages_info,
-              NULL, NULL);
+              NULL, NULL, ITTI_TRANSPORT_ZMQ);
 
     amf_config_init(&amf_config);
     amf_config.guamfi.guamfi[0].plmn = plmn;
@@ -599,7 +599,7 @@ class AMFAppStatelessTest : public ::testing::Test {
  protected:
   virtual void SetUp() {
     itti_init(TASK_MAX, THREAD_MAX, MESSAGES_ID_MAX, tasks_info, messages_info,
-              NULL, NULL);
+              NULL, NULL, ITTI_TRANSPORT_ZMQ);
 
     // initialize amf config
     amf_config_init(&amf_config);
@@ -0,0 +1,187 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Compares messages/sec and per hop latency of the ZMQ and ring ITTI
+// transports over a S1AP -> MME_APP -> NAS chain of tasks. NAS runs on the
+// MME_APP thread in the MME, TASK_TEST_1 stands in for it to time the hop.
+// Usage: bench_itti_transport [num_msgs] [num_latency_msgs]
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+extern "C" {
+#define CHECK_PROTOTYPE_ONLY
+#include "lte/gateway/c/core/oai/lib/itti/intertask_interface_init.h"
+#undef CHECK_PROTOTYPE_ONLY
+#include "lte/gateway/c/core/oai/lib/itti/intertask_interface.h"
+#include "lte/gateway/c/core/oai/lib/itti/intertask_interface_types.h"
+}
+
+const task_info_t tasks_info[] = {
+    {THREAD_NULL, "TASK_UNKNOWN", "ipc://IPC_TASK_UNKNOWN"},
+#define TASK_DEF(tHREADiD) \
+  {THREAD_##tHREADiD, #tHREADiD, "ipc://IPC_BENCH_" #tHREADiD},
+#include "lte/gateway/c/core/oai/include/tasks_def.h"
+#undef TASK_DEF
+};
+
+const message_info_t messages_info[] = {
+#define MESSAGE_DEF(iD, sTRUCT, fIELDnAME) {iD, sizeof(sTRUCT), #iD},
+#include "lte/gateway/c/core/oai/include/messages_def.h"
+#undef MESSAGE_DEF
+};
+
+#define NUM_HOPS 3
+
+static const task_id_t chain[NUM_HOPS] = {TASK_S1AP, TASK_MME_APP,
+                                          TASK_TEST_1};
+static const char* hop_names[NUM_HOPS] = {"main->s1ap", "s1ap->mme_app",
+                                          "mme_app->nas"};
+
+static task_zmq_ctx_t main_ctx;
+static task_zmq_ctx_t chain_ctx[NUM_HOPS];
+static std::vector<int64_t> hop_latencies[NUM_HOPS];
+static std::atomic<bool> record_latency;
+static std::atomic<uint64_t> delivered;
+
+static int64_t now_ns() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+  return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static int hop_index(task_id_t task_id) {
+  for (int hop = 0; hop < NUM_HOPS; hop++) {
+    if (chain[hop] == task_id) {
+      return hop;
+    }
+  }
+  return -1;
+}
+
+// Each task allocates a new message for the next one, like the S1AP and
+// MME_APP handlers do, so the header timestamp measures a single hop
+static int handle_message(zloop_t* loop, zsock_t* reader, void* arg) {
+  MessageDef* received_message_p = receive_msg(reader);
+  if (ITTI_MSG_ID(received_message_p) == TERMINATE_MESSAGE) {
+    free(received_message_p);
+    return -1;
+  }
+
+  struct timespec sent = received_message_p->ittiMsgHeader.timestamp;
+  int64_t latency_ns = now_ns() - (sent.tv_sec * 1000000000LL + sent.tv_nsec);
+  int hop = hop_index(ITTI_MSG_DESTINATION_ID(received_message_p));
+  if (record_latency) {
+    hop_latencies[hop].push_back(latency_ns);
+  }
+
+  if (hop + 1 < NUM_HOPS) {
+    MessageDef* message_p = itti_alloc_new_message(chain[hop], TEST_MESSAGE);
+    ITTI_MSG_DESTINATION_ID(message_p) = chain[hop + 1];
+    message_p->ittiMsgHeader.imsi = received_message_p->ittiMsgHeader.imsi;
+    send_msg_to_task(&chain_ctx[hop], chain[hop + 1], message_p);
+  } else {
+    delivered++;
+  }
+  free(received_message_p);
+  return 0;
+}
+
+static void task_thread(int hop) {
+  task_id_t next[1] = {hop + 1 < NUM_HOPS ? chain[hop + 1] : TASK_UNKNOWN};
+  init_task_context(chain[hop], next, hop + 1 < NUM_HOPS ? 1 : 0,
+                    handle_message, &chain_ctx[hop]);
+  zloop_start(chain_ctx[hop].event_loop);
+}
+
+static void send_first_hop(uint64_t seq) {
+  MessageDef* message_p = itti_alloc_new_message(TASK_MAIN, TEST_MESSAGE);
+  ITTI_MSG_DESTINATION_ID(message_p) = chain[0];
+  message_p->ittiMsgHeader.imsi = seq;
+  send_msg_to_task(&main_ctx, chain[0], message_p);
+}
+
+static void wait_delivered(uint64_t count) {
+  while (delivered < count) {
+    std::this_thread::yield();
+  }
+}
+
+static void run(const char* name, itti_transport_t transport, int num_msgs,
+                int num_latency_msgs) {
+  itti_init(TASK_MAX, THREAD_MAX, MESSAGES_ID_MAX, tasks_info, messages_info,
+            NULL, NULL, transport);
+  memset(&main_ctx, 0, sizeof(main_ctx));
+  memset(chain_ctx, 0, sizeof(chain_ctx));
+  delivered = 0;
+  record_latency = false;
+  for (int hop = 0; hop < NUM_HOPS; hop++) {
+    hop_latencies[hop].clear();
+    hop_latencies[hop].reserve(num_latency_msgs);
+  }
+
+  init_task_context(TASK_MAIN, chain, NUM_HOPS, NULL, &main_ctx);
+  std::vector<std::thread> threads;
+  for (int hop = 0; hop < NUM_HOPS; hop++) {
+    threads.emplace_back(task_thread, hop);
+  }
+
+  // Throughput, messages sent back to back through the whole chain
+  int64_t start_ns = now_ns();
+  for (int i = 0; i < num_msgs; i++) {
+    send_first_hop(i);
+  }
+  wait_delivered(num_msgs);
+  double secs = (now_ns() - start_ns) / 1e9;
+
+  // Latency, one message in flight at a time so it is not queued
+  record_latency = true;
+  for (int i = 0; i < num_latency_msgs; i++) {
+    send_first_hop(num_msgs + i);
+    wait_delivered(num_msgs + i + 1);
+  }
+
+  printf("%-4s msgs=%d msgs/sec=%.0f\n", name, num_msgs, num_msgs / secs);
+  for (int hop = 0; hop < NUM_HOPS; hop++) {
+    auto& lat = hop_latencies[hop];
+    std::sort(lat.begin(), lat.end());
+    printf("     %-14s p50=%.1fus p99=%.1fus\n", hop_names[hop],
+           lat[lat.size() / 2] / 1e3, lat[lat.size() * 99 / 100] / 1e3);
+  }
+
+  send_terminate_message_fatal(&main_ctx);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (int hop = 0; hop < NUM_HOPS; hop++) {
+    destroy_task_context(&chain_ctx[hop]);
+  }
+  destroy_task_context(&main_ctx);
+  itti_free_desc_threads();
+}
+
+int main(int argc, char** argv) {
+  int num_msgs = argc > 1 ? atoi(argv[1]) : 100000;
+  int num_latency_msgs = argc > 2 ? atoi(argv[2]) : 10000;
+
+  run("zmq", ITTI_TRANSPORT_ZMQ, num_msgs, num_latency_msgs);
+  run("ring", ITTI_TRANSPORT_RING, num_msgs, num_latency_msgs);
+  return 0;
+}
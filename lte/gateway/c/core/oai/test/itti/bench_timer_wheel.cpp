@@ -0,0 +1,146 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Compares the cost of the per UE timers armed as zloop timers and on the
+// timing wheel of the task, with num_timers timers armed with the durations
+// of the NAS timers: start and stop time per timer, and CPU time of the event
+// loop per wakeup of a 1 ms timer standing in for the task messages.
+// Usage: bench_timer_wheel [duration_ms] [num_timers...]
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <vector>
+
+extern "C" {
+#define CHECK_PROTOTYPE_ONLY
+#include "lte/gateway/c/core/oai/lib/itti/intertask_interface_init.h"
+#undef CHECK_PROTOTYPE_ONLY
+#include "lte/gateway/c/core/oai/lib/itti/intertask_interface.h"
+#include "lte/gateway/c/core/oai/lib/itti/intertask_interface_types.h"
+}
+
+const task_info_t tasks_info[] = {
+    {THREAD_NULL, "TASK_UNKNOWN", "ipc://IPC_TASK_UNKNOWN"},
+#define TASK_DEF(tHREADiD) \
+  {THREAD_##tHREADiD, #tHREADiD, "ipc://IPC_BENCH_" #tHREADiD},
+#include "lte/gateway/c/core/oai/include/tasks_def.h"
+#undef TASK_DEF
+};
+
+const message_info_t messages_info[] = {
+#define MESSAGE_DEF(iD, sTRUCT, fIELDnAME) {iD, sizeof(sTRUCT), #iD},
+#include "lte/gateway/c/core/oai/include/messages_def.h"
+#undef MESSAGE_DEF
+};
+
+// Timers of the UEs detaching during the run
+#define NUM_STOPPED_TIMERS 1000
+
+typedef struct {
+  double start_us;
+  double stop_us;
+  double wakeup_us;
+} result_t;
+
+static int64_t now_ns(clockid_t clock_id) {
+  struct timespec ts;
+  clock_gettime(clock_id, &ts);
+  return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static int count_wakeup(zloop_t* loop, int timer_id, void* arg) {
+  (*(uint64_t*)arg)++;
+  return 0;
+}
+
+static int stop_loop(zloop_t* loop, int timer_id, void* arg) { return -1; }
+
+static int never_called(zloop_t* loop, int timer_id, void* arg) { return 0; }
+
+static void run_loop(task_zmq_ctx_t* task_zmq_ctx, int duration_ms) {
+  zloop_timer(task_zmq_ctx->event_loop, duration_ms, 1, stop_loop, NULL);
+  zloop_start(task_zmq_ctx->event_loop);
+}
+
+static result_t run(bool wheel, int num_timers, int duration_ms) {
+  task_zmq_ctx_t task_zmq_ctx;
+  std::vector<int> timer_ids(num_timers);
+  result_t result;
+  uint64_t num_wakeups = 0;
+
+  memset(&task_zmq_ctx, 0, sizeof(task_zmq_ctx));
+  task_zmq_ctx.task_id = TASK_MME_APP;
+  task_zmq_ctx.event_loop = zloop_new();
+
+  // T3450 to mobile reachability durations, none expires during the run
+  int64_t start_ns = now_ns(CLOCK_MONOTONIC);
+  for (int i = 0; i < num_timers; i++) {
+    size_t msec = 6000 + (i % 3240) * 1000;
+    timer_ids[i] = wheel ? start_wheel_timer(&task_zmq_ctx, msec,
+                                             TIMER_REPEAT_ONCE, never_called,
+                                             NULL)
+                         : start_timer(&task_zmq_ctx, msec, TIMER_REPEAT_ONCE,
+                                       never_called, NULL);
+  }
+  result.start_us = (now_ns(CLOCK_MONOTONIC) - start_ns) / 1e3 / num_timers;
+
+  int wakeup_timer_id = zloop_timer(task_zmq_ctx.event_loop, 1, 0,
+                                    count_wakeup, &num_wakeups);
+  start_ns = now_ns(CLOCK_PROCESS_CPUTIME_ID);
+  run_loop(&task_zmq_ctx, duration_ms);
+  result.wakeup_us =
+      (now_ns(CLOCK_PROCESS_CPUTIME_ID) - start_ns) / 1e3 / num_wakeups;
+  zloop_timer_end(task_zmq_ctx.event_loop, wakeup_timer_id);
+
+  // zloop removes the stopped timers on its next iteration
+  int num_stopped =
+      num_timers < NUM_STOPPED_TIMERS ? num_timers : NUM_STOPPED_TIMERS;
+  start_ns = now_ns(CLOCK_PROCESS_CPUTIME_ID);
+  for (int i = 0; i < num_stopped; i++) {
+    if (wheel) {
+      stop_wheel_timer(&task_zmq_ctx, timer_ids[i]);
+    } else {
+      stop_timer(&task_zmq_ctx, timer_ids[i]);
+    }
+  }
+  run_loop(&task_zmq_ctx, 1);
+  result.stop_us =
+      (now_ns(CLOCK_PROCESS_CPUTIME_ID) - start_ns) / 1e3 / num_stopped;
+
+  destroy_task_context(&task_zmq_ctx);
+  return result;
+}
+
+int main(int argc, char** argv) {
+  int duration_ms = argc > 1 ? atoi(argv[1]) : 2000;
+  std::vector<int> num_timers_runs;
+  for (int i = 2; i < argc; i++) {
+    num_timers_runs.push_back(atoi(argv[i]));
+  }
+  if (num_timers_runs.empty()) {
+    num_timers_runs = {10000, 100000, 500000};
+  }
+
+  for (int num_timers : num_timers_runs) {
+    for (bool wheel : {false, true}) {
+      result_t result = run(wheel, num_timers, duration_ms);
+      printf("%-5s timers=%d start=%.2fus stop=%.2fus wakeup_cpu=%.2fus\n",
+             wheel ? "wheel" : "zloop", num_timers, result.start_us,
+             result.stop_us, result.wakeup_us);
+    }
+  }
+  return 0;
+}
@@ -14,6 +14,7 @@
 #include <string.h>
 #include <gtest/gtest.h>
 #include <thread>
+#include <vector>
 
 extern "C" {
 #include "lte/gateway/c/core/oai/common/conversions.h"
@@ -84,7 +85,7 @@ void* task_thread(task_thread_args_t* args) {
 class ITTIMessagePassingTest : public ::testing::Test {
   virtual void SetUp() {
     itti_init(TASK_MAX, THREAD_MAX, MESSAGES_ID_MAX, tasks_info, messages_info,
-              NULL, NULL);
+              NULL, NULL, ITTI_TRANSPORT_ZMQ);
 
     task_id_t task_id_list[4] = {TASK_TEST_1, TASK_TEST_2};
     init_task_context(TASK_MAIN, task_id_list, 1, NULL, &task_zmq_ctx_main);
@@ -139,10 +140,97 @@ TEST_F(ITTIMessagePassingTest, TestMessageLatency) {
   ASSERT_GE(msg_latency, 1000000);
 }
 
+task_zmq_ctx_t task_zmq_ctx_ring_main, task_zmq_ctx_ring_test1,
+    task_zmq_ctx_ring_test2;
+std::vector<imsi64_t> ring_received;
+
+static int handle_ring_message(zloop_t* loop, zsock_t* reader, void* arg) {
+  MessageDef* received_message_p = receive_msg(reader);
+  bool terminate = ITTI_MSG_ID(received_message_p) == TERMINATE_MESSAGE;
+
+  if (!terminate) {
+    ring_received.push_back(received_message_p->ittiMsgHeader.imsi);
+  }
+  itti_free_msg_content(received_message_p);
+  free(received_message_p);
+  // Stop the loop on terminate so that the task thread can be joined
+  return terminate ? -1 : 0;
+}
+
+static void send_ring_messages(task_zmq_ctx_t* task_zmq_ctx, imsi64_t first,
+                               imsi64_t count) {
+  for (imsi64_t i = 0; i < count; i++) {
+    MessageDef* message_p = DEPRECATEDitti_alloc_new_message_fatal(
+        task_zmq_ctx->task_id, TEST_MESSAGE);
+    message_p->ittiMsgHeader.imsi = first + i;
+    send_msg_to_task(task_zmq_ctx, TASK_TEST_2, message_p);
+  }
+}
+
+class ITTIRingTransportTest : public ::testing::Test {
+ protected:
+  virtual void SetUp() {
+    itti_init(TASK_MAX, THREAD_MAX, MESSAGES_ID_MAX, tasks_info, messages_info,
+              NULL, NULL, ITTI_TRANSPORT_RING);
+    ring_received.clear();
+
+    task_id_t task_id_list[1] = {TASK_TEST_2};
+    init_task_context(TASK_MAIN, task_id_list, 1, NULL,
+                      &task_zmq_ctx_ring_main);
+    init_task_context(TASK_TEST_1, task_id_list, 1, NULL,
+                      &task_zmq_ctx_ring_test1);
+    // Messages sent before the receiver is polling stay in its ring
+    receiver = std::thread([]() {
+      init_task_context(TASK_TEST_2, NULL, 0, handle_ring_message,
+                        &task_zmq_ctx_ring_test2);
+      zloop_start(task_zmq_ctx_ring_test2.event_loop);
+    });
+  }
+
+  virtual void TearDown() {
+    stop_receiver();
+    destroy_task_context(&task_zmq_ctx_ring_test2);
+    destroy_task_context(&task_zmq_ctx_ring_test1);
+    destroy_task_context(&task_zmq_ctx_ring_main);
+    itti_free_desc_threads();
+  }
+
+  void stop_receiver() {
+    if (receiver.joinable()) {
+      send_terminate_message_fatal(&task_zmq_ctx_ring_main);
+      receiver.join();
+    }
+  }
+
+  std::thread receiver;
+};
+
+TEST_F(ITTIRingTransportTest, TestMessagesInOrderPerSender) {
+  // More messages than a ring holds, senders wait for the receiver
+  const imsi64_t msgs_per_sender = 20000;
+
+  std::thread sender(send_ring_messages, &task_zmq_ctx_ring_test1,
+                     msgs_per_sender, msgs_per_sender);
+  send_ring_messages(&task_zmq_ctx_ring_main, 0, msgs_per_sender);
+  sender.join();
+  stop_receiver();
+
+  ASSERT_EQ(ring_received.size(), 2 * msgs_per_sender);
+  imsi64_t next_main = 0;
+  imsi64_t next_test1 = msgs_per_sender;
+  for (imsi64_t seq : ring_received) {
+    if (seq < msgs_per_sender) {
+      ASSERT_EQ(seq, next_main++);
+    } else {
+      ASSERT_EQ(seq, next_test1++);
+    }
+  }
+}
+
 class ITTIApiTest : public ::testing::Test {
   virtual void SetUp() {
     itti_init(TASK_MAX, THREAD_MAX, MESSAGES_ID_MAX, tasks_info, messages_info,
-              NULL, NULL);
+              NULL, NULL, ITTI_TRANSPORT_ZMQ);
   }
 
   virtual void TearDown() { itti_free_desc_threads(); }
@@ -184,6 +272,54 @@ TEST_F(ITTIApiTest, TestInitialContextSetupRsp) {
   free(message_p);
 }
 
+TEST_F(ITTIApiTest, TestMessagePoolRecycling) {
+  uint64_t hits, misses, hits_after, misses_after;
+  MessageDef* message_p =
+      itti_alloc_new_message(TASK_S1AP, MME_APP_INITIAL_CONTEXT_SETUP_RSP);
+  MME_APP_INITIAL_CONTEXT_SETUP_RSP(message_p).ue_id = 10;
+  itti_free_msg_content(message_p);
+  itti_free_msg(message_p);
+
+  itti_get_msg_pool_stats(&hits, &misses);
+  MessageDef* recycled_p =
+      itti_alloc_new_message(TASK_S1AP, MME_APP_INITIAL_CONTEXT_SETUP_RSP);
+  itti_get_msg_pool_stats(&hits_after, &misses_after);
+  EXPECT_EQ(recycled_p, message_p);
+  EXPECT_EQ(hits_after, hits + 1);
+  EXPECT_EQ(misses_after, misses);
+  // Recycled messages are zeroed like new ones
+  EXPECT_EQ(MME_APP_INITIAL_CONTEXT_SETUP_RSP(recycled_p).ue_id, 0u);
+  itti_free_msg(recycled_p);
+}
+
+TEST_F(ITTIApiTest, TestMessagePoolRemoteFree) {
+  MessageDef* message_p =
+      itti_alloc_new_message(TASK_S1AP, MME_APP_INITIAL_CONTEXT_SETUP_RSP);
+
+  // Freed by another thread, the message goes back to the pool of this one
+  std::thread([message_p] { itti_free_msg(message_p); }).join();
+  MessageDef* other_thread_p = nullptr;
+  std::thread([&other_thread_p] {
+    other_thread_p =
+        itti_alloc_new_message(TASK_S1AP, MME_APP_INITIAL_CONTEXT_SETUP_RSP);
+  }).join();
+  EXPECT_NE(other_thread_p, message_p);
+  itti_free_msg(other_thread_p);
+
+  // Taken back once the free messages of this thread run out
+  std::vector<MessageDef*> messages;
+  bool recycled = false;
+  for (int i = 0; i < 1024 && !recycled; i++) {
+    messages.push_back(
+        itti_alloc_new_message(TASK_S1AP, MME_APP_INITIAL_CONTEXT_SETUP_RSP));
+    recycled = messages.back() == message_p;
+  }
+  EXPECT_TRUE(recycled);
+  for (auto* allocated_p : messages) {
+    itti_free_msg(allocated_p);
+  }
+}
+
 TEST_F(ITTIApiTest, TestHandoverRequest) {
   char arbitrary_src_tgt_container[20] = "This is arbitrary";
   MessageDef* message_p = DEPRECATEDitti_alloc_new_message_fatal(
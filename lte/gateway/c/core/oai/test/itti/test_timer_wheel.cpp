@@ -0,0 +1,210 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stdint.h>
+#include <stdlib.h>
+#include <gtest/gtest.h>
+#include <map>
+#include <vector>
+
+extern "C" {
+#include "lte/gateway/c/core/oai/lib/itti/timer_wheel.h"
+}
+
+namespace magma {
+namespace lte {
+
+#define TEST_TICK_MSEC 10
+
+typedef struct {
+  int timer_id;
+  uint64_t msec;
+} expiry_t;
+
+static std::vector<expiry_t> expiries;
+static uint64_t now_msec = 0;
+static timer_wheel_t* wheel = nullptr;
+
+static int record_expiry(zloop_t* loop, int timer_id, void* arg) {
+  expiries.push_back({timer_id, now_msec});
+  return 0;
+}
+
+// Deletes the timer whose ID is pointed to by arg
+static int delete_timer(zloop_t* loop, int timer_id, void* arg) {
+  record_expiry(loop, timer_id, arg);
+  timer_wheel_del(wheel, *(int*)arg);
+  return 0;
+}
+
+// Adds a timer expiring immediately, and stores its ID in arg
+static int add_timer(zloop_t* loop, int timer_id, void* arg) {
+  record_expiry(loop, timer_id, arg);
+  *(int*)arg = timer_wheel_add(wheel, now_msec, 0, false, record_expiry, NULL);
+  return 0;
+}
+
+static int stop_loop(zloop_t* loop, int timer_id, void* arg) {
+  record_expiry(loop, timer_id, arg);
+  return -1;
+}
+
+class TimerWheelTest : public ::testing::Test {
+  virtual void SetUp() {
+    expiries.clear();
+    now_msec = 1000;
+    wheel = timer_wheel_create(TEST_TICK_MSEC, now_msec);
+  }
+
+  virtual void TearDown() { timer_wheel_destroy(wheel); }
+
+ protected:
+  // Expires the wheel every tick, like the zloop tick timer
+  int advance(uint64_t msec) {
+    int rc = 0;
+    for (uint64_t end = now_msec + msec; now_msec < end;) {
+      now_msec += TEST_TICK_MSEC;
+      if (timer_wheel_expire(wheel, nullptr, now_msec) == -1) {
+        rc = -1;
+      }
+    }
+    return rc;
+  }
+};
+
+TEST_F(TimerWheelTest, TestExpiryRoundedUpToTick) {
+  int timer_id = timer_wheel_add(wheel, now_msec, 25, false, record_expiry,
+                                 nullptr);
+  ASSERT_NE(timer_id, -1);
+  EXPECT_EQ(timer_wheel_size(wheel), 1);
+
+  advance(20);
+  EXPECT_TRUE(expiries.empty());
+  advance(10);
+  ASSERT_EQ(expiries.size(), 1);
+  EXPECT_EQ(expiries[0].timer_id, timer_id);
+  EXPECT_EQ(expiries[0].msec, 1030);
+  EXPECT_EQ(timer_wheel_size(wheel), 0);
+
+  advance(1000);
+  EXPECT_EQ(expiries.size(), 1);
+}
+
+TEST_F(TimerWheelTest, TestLongTimersCascade) {
+  // Durations of the NAS and S1AP timers, up to the implicit detach timer,
+  // spread over all the levels of the wheel
+  std::map<int, uint64_t> deadlines;
+  srand(42);
+  for (int i = 0; i < 2000; i++) {
+    uint64_t msec = (rand() % 3600) * 1000 + rand() % 1000;
+    int timer_id =
+        timer_wheel_add(wheel, now_msec, msec, false, record_expiry, nullptr);
+    ASSERT_NE(timer_id, -1);
+    deadlines[timer_id] =
+        (now_msec + msec + TEST_TICK_MSEC - 1) / TEST_TICK_MSEC *
+        TEST_TICK_MSEC;
+    // Arms the next timers at a different tick
+    advance(TEST_TICK_MSEC);
+  }
+
+  advance(3700 * 1000);
+  ASSERT_EQ(expiries.size(), deadlines.size());
+  for (const auto& expiry : expiries) {
+    EXPECT_EQ(expiry.msec, deadlines[expiry.timer_id]);
+  }
+  EXPECT_EQ(timer_wheel_size(wheel), 0);
+}
+
+TEST_F(TimerWheelTest, TestDelete) {
+  int timer_id = timer_wheel_add(wheel, now_msec, 5000, false, record_expiry,
+                                 nullptr);
+  EXPECT_TRUE(timer_wheel_del(wheel, timer_id));
+  EXPECT_FALSE(timer_wheel_del(wheel, timer_id));
+  EXPECT_EQ(timer_wheel_size(wheel), 0);
+
+  // The ID of the deleted timer does not match the timer reusing its node
+  int new_timer_id = timer_wheel_add(wheel, now_msec, 5000, false,
+                                     record_expiry, nullptr);
+  EXPECT_NE(new_timer_id, timer_id);
+  EXPECT_FALSE(timer_wheel_del(wheel, timer_id));
+  EXPECT_FALSE(timer_wheel_del(wheel, -1));
+
+  advance(5000);
+  ASSERT_EQ(expiries.size(), 1);
+  EXPECT_EQ(expiries[0].timer_id, new_timer_id);
+  EXPECT_FALSE(timer_wheel_del(wheel, new_timer_id));
+}
+
+TEST_F(TimerWheelTest, TestRepeat) {
+  int timer_id =
+      timer_wheel_add(wheel, now_msec, 100, true, record_expiry, nullptr);
+
+  advance(1000);
+  ASSERT_EQ(expiries.size(), 10);
+  for (int i = 0; i < 10; i++) {
+    EXPECT_EQ(expiries[i].timer_id, timer_id);
+    EXPECT_EQ(expiries[i].msec, 1100 + i * 100);
+  }
+  EXPECT_EQ(timer_wheel_size(wheel), 1);
+  EXPECT_TRUE(timer_wheel_del(wheel, timer_id));
+  advance(1000);
+  EXPECT_EQ(expiries.size(), 10);
+}
+
+TEST_F(TimerWheelTest, TestHandlersModifyWheel) {
+  int deleted_id = -1;
+  int added_id = -1;
+  int first_id =
+      timer_wheel_add(wheel, now_msec, 50, false, delete_timer, &deleted_id);
+  deleted_id =
+      timer_wheel_add(wheel, now_msec, 50, false, record_expiry, nullptr);
+  int adding_id =
+      timer_wheel_add(wheel, now_msec, 50, false, add_timer, &added_id);
+
+  // The second timer is deleted by the first one before it is called, the
+  // timer added by the third one expires on the next tick
+  advance(50);
+  ASSERT_EQ(expiries.size(), 2);
+  EXPECT_EQ(expiries[0].timer_id, first_id);
+  EXPECT_EQ(expiries[1].timer_id, adding_id);
+  EXPECT_EQ(timer_wheel_size(wheel), 1);
+
+  advance(TEST_TICK_MSEC);
+  ASSERT_EQ(expiries.size(), 3);
+  EXPECT_EQ(expiries[2].timer_id, added_id);
+  EXPECT_EQ(expiries[2].msec, 1060);
+}
+
+TEST_F(TimerWheelTest, TestHandlerStopsLoop) {
+  timer_wheel_add(wheel, now_msec, 10, false, stop_loop, nullptr);
+  timer_wheel_add(wheel, now_msec, 10, false, record_expiry, nullptr);
+
+  EXPECT_EQ(advance(10), -1);
+  EXPECT_EQ(expiries.size(), 2);
+  EXPECT_EQ(advance(10), 0);
+}
+
+TEST_F(TimerWheelTest, TestIdleTicksSkipped) {
+  // A timer armed after a long idle period expires after its duration, not
+  // on the first expiry
+  now_msec += 24 * 3600 * 1000;
+  timer_wheel_add(wheel, now_msec, 100, false, record_expiry, nullptr);
+
+  advance(90);
+  EXPECT_TRUE(expiries.empty());
+  advance(10);
+  ASSERT_EQ(expiries.size(), 1);
+  EXPECT_EQ(expiries[0].msec, now_msec);
+}
+
+}  // namespace lte
+}  // namespace magma
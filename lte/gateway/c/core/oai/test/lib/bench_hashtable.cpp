@@ -0,0 +1,136 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures get/insert/remove throughput of hash_table_ts_t with keys shaped
+// like the UE context table keys, first from a single thread and then with
+// concurrent readers looking up UEs while a writer attaches and detaches UEs.
+// Usage: bench_hashtable [num_keys] [num_readers] [duration_ms]
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+extern "C" {
+#include "lte/gateway/c/core/oai/lib/bstr/bstrlib.h"
+#include "lte/gateway/c/core/oai/lib/hashtable/hashtable.h"
+}
+
+static int64_t now_ns() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// Elements are not owned by the tables
+static void no_free(void** data) {}
+
+static hash_key_t s1ap_id_key(uint64_t i) { return i + 1; }
+static hash_key_t imsi_key(uint64_t i) { return 1010000000000ULL + i; }
+static hash_key_t teid_key(uint64_t i) { return (i << 8) | 0x1; }
+
+static void run_single(const char* name, hash_key_t (*key)(uint64_t),
+                       uint64_t num_keys) {
+  hash_table_ts_t* htbl = hashtable_ts_create(16, nullptr, no_free, nullptr);
+  void* element = nullptr;
+
+  int64_t start_ns = now_ns();
+  for (uint64_t i = 0; i < num_keys; i++) {
+    hashtable_ts_insert(htbl, key(i), (void*)(uintptr_t)(i + 1));
+  }
+  int64_t insert_ns = now_ns() - start_ns;
+
+  start_ns = now_ns();
+  for (uint64_t i = 0; i < num_keys; i++) {
+    hashtable_ts_get(htbl, key((i * 7919) % num_keys), &element);
+  }
+  int64_t get_ns = now_ns() - start_ns;
+
+  start_ns = now_ns();
+  for (uint64_t i = 0; i < num_keys; i++) {
+    hashtable_ts_remove(htbl, key(i), &element);
+  }
+  int64_t remove_ns = now_ns() - start_ns;
+
+  printf("%-8s keys=%" PRIu64 " insert=%.1fns get=%.1fns remove=%.1fns\n",
+         name, num_keys, (double)insert_ns / num_keys,
+         (double)get_ns / num_keys, (double)remove_ns / num_keys);
+  hashtable_ts_destroy(htbl);
+}
+
+// Readers look up attached UEs while a writer keeps detaching and attaching
+// UEs at the end of the key range
+static void run_concurrent(uint64_t num_keys, int num_readers,
+                           int duration_ms) {
+  hash_table_ts_t* htbl = hashtable_ts_create(16, nullptr, no_free, nullptr);
+  for (uint64_t i = 0; i < num_keys; i++) {
+    hashtable_ts_insert(htbl, s1ap_id_key(i), (void*)(uintptr_t)(i + 1));
+  }
+
+  std::atomic<bool> stop(false);
+  std::atomic<uint64_t> num_gets(0);
+  uint64_t num_writes = 0;
+  std::vector<std::thread> readers;
+  for (int r = 0; r < num_readers; r++) {
+    readers.emplace_back([&, r] {
+      uint64_t i = r;
+      uint64_t gets = 0;
+      void* element = nullptr;
+      while (!stop.load(std::memory_order_relaxed)) {
+        hashtable_ts_get(htbl, s1ap_id_key((i * 7919) % num_keys), &element);
+        i++;
+        gets++;
+      }
+      num_gets += gets;
+    });
+  }
+
+  int64_t start_ns = now_ns();
+  int64_t end_ns = start_ns + duration_ms * 1000000LL;
+  uint64_t next = num_keys;
+  void* element = nullptr;
+  while (now_ns() < end_ns) {
+    for (int i = 0; i < 1000; i++, next++) {
+      hashtable_ts_insert(htbl, s1ap_id_key(next), (void*)(uintptr_t)next);
+      hashtable_ts_remove(htbl, s1ap_id_key(next - num_keys / 2), &element);
+      num_writes += 2;
+    }
+  }
+  stop = true;
+  for (auto& reader : readers) {
+    reader.join();
+  }
+  double secs = (now_ns() - start_ns) / 1e9;
+
+  printf("readers=%d gets/sec=%.0f writes/sec=%.0f\n", num_readers,
+         num_gets / secs, num_writes / secs);
+  hashtable_ts_destroy(htbl);
+}
+
+int main(int argc, char** argv) {
+  uint64_t num_keys = argc > 1 ? atoll(argv[1]) : 100000;
+  int num_readers = argc > 2 ? atoi(argv[2]) : 4;
+  int duration_ms = argc > 3 ? atoi(argv[3]) : 2000;
+
+  run_single("s1ap_id", s1ap_id_key, num_keys);
+  run_single("imsi", imsi_key, num_keys);
+  run_single("teid", teid_key, num_keys);
+  for (int readers = 1; readers <= num_readers; readers *= 2) {
+    run_concurrent(num_keys, readers, duration_ms);
+  }
+  return 0;
+}
@@ -0,0 +1,147 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures the cost on the logging threads of OAILOG_INFO and of the
+// OAILOG_FUNC_IN/OAILOG_FUNC_OUT pairs at TRACE level, with the text logging
+// or with the binary logging. In binary mode a consumer thread drains and
+// formats the messages like the log task does, the messages dropped because
+// a ring was full are reported.
+// Usage: bench_log <text|binary> [num_messages] [num_threads] 2>/dev/null
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+extern "C" {
+#include "lte/gateway/c/core/oai/common/log.h"
+#include "lte/gateway/c/core/oai/common/log_binary.h"
+}
+
+typedef struct {
+  uint64_t formatted;
+  uint64_t dropped;
+} drain_stats_t;
+
+static int64_t now_ns() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// OAILOG_FUNC_IN and OAILOG_FUNC_OUT compile to nothing without TRACE_IS_ON
+static void traced_function() {
+  log_func(true, LOG_MME_APP, __FILE__, __LINE__, __FUNCTION__);
+  log_func(false, LOG_MME_APP, __FILE__, __LINE__, __FUNCTION__);
+}
+
+// Formats the messages as the log task would, without writing them
+static void format_record(const log_binary_record_t* record, void* arg) {
+  drain_stats_t* stats = (drain_stats_t*)arg;
+  char line[LOG_BINARY_LINE_MAX];
+
+  if (LOG_BINARY_RECORD_MESSAGE == record->type) {
+    const log_binary_message_t* message = (const log_binary_message_t*)record;
+    log_binary_format_line(message, (const char*)(uintptr_t)message->format,
+                           (const char*)(uintptr_t)message->file, "INFO",
+                           "MME-AP", stats->formatted, 0, line, sizeof(line));
+    stats->formatted++;
+  } else if (LOG_BINARY_RECORD_DROPPED == record->type) {
+    stats->dropped += ((const log_binary_dropped_t*)record)->count;
+  }
+}
+
+static void run(const char* name, int num_messages, int num_threads,
+                bool binary, void (*log_fn)(int)) {
+  std::atomic<bool> done(false);
+  drain_stats_t stats = {0, 0};
+  std::thread consumer;
+  if (binary) {
+    consumer = std::thread([&done, &stats]() {
+      while (!done.load()) {
+        log_binary_drain(format_record, &stats);
+        std::this_thread::yield();
+      }
+      log_binary_drain(format_record, &stats);
+    });
+  }
+
+  std::vector<std::thread> threads;
+  std::vector<int64_t> elapsed_ns(num_threads);
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([t, num_messages, log_fn, &elapsed_ns]() {
+      int64_t start_ns = now_ns();
+      for (int i = 0; i < num_messages; i++) {
+        log_fn(i);
+      }
+      elapsed_ns[t] = now_ns() - start_ns;
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  done.store(true);
+  if (binary) {
+    consumer.join();
+  }
+
+  int64_t total_ns = 0;
+  for (auto ns : elapsed_ns) {
+    total_ns += ns;
+  }
+  printf("%-6s %-5s threads=%d calls=%d %.1fns/call",
+         binary ? "binary" : "text", name, num_threads, num_messages,
+         (double)total_ns / ((int64_t)num_messages * num_threads));
+  if (binary) {
+    printf(" formatted=%" PRIu64 " dropped=%" PRIu64, stats.formatted,
+           stats.dropped);
+  }
+  printf("\n");
+}
+
+static void log_info(int i) {
+  OAILOG_INFO(LOG_MME_APP, "UE id %u state %s count %d\n", (uint32_t)i,
+              "REGISTERED", i);
+}
+
+static void log_trace(int i) { traced_function(); }
+
+int main(int argc, char** argv) {
+  if (argc < 2 || (strcmp(argv[1], "text") && strcmp(argv[1], "binary"))) {
+    fprintf(stderr,
+            "Usage: bench_log <text|binary> [num_messages] [num_threads]\n");
+    return 1;
+  }
+  bool binary = !strcmp(argv[1], "binary");
+  int num_messages = argc > 2 ? atoi(argv[2]) : 100000;
+  int num_threads = argc > 3 ? atoi(argv[3]) : 1;
+  if (num_messages <= 0 || num_threads <= 0) {
+    fprintf(stderr, "Invalid arguments\n");
+    return 1;
+  }
+
+  OAILOG_INIT("BENCH_LOG", OAILOG_LEVEL_TRACE, MAX_LOG_PROTOS);
+  log_config_t config = {};
+  config.is_output_binary = binary;
+  config.mme_app_log_level = OAILOG_LEVEL_TRACE;
+  log_configure(&config);
+
+  run("info", num_messages, num_threads, binary, log_info);
+  run("trace", num_messages, num_threads, binary, log_trace);
+  return 0;
+}
@@ -0,0 +1,132 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures the NAS messages ciphered and integrity protected per second for
+// each message size: EEA1 and EIA1, EEA2 and EIA2 scheduling the AES key on
+// every message as before, and EEA2 and EIA2 with the key schedule cached in
+// the security context.
+// Usage: bench_nas_crypto [num_messages] [message_size...]
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <vector>
+
+#include "lte/gateway/c/core/oai/lib/secu/secu_defs.h"
+
+typedef struct {
+  double eea;
+  double eia;
+} result_t;
+
+static int64_t now_ns() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static uint8_t bench_key[AES128_KEY_SIZE] = {
+    0xd3, 0xc5, 0xd5, 0x92, 0x32, 0x7f, 0xb1, 0x1c,
+    0x40, 0x35, 0xc6, 0x68, 0x0a, 0xf8, 0xc6, 0xd1};
+
+typedef int (*eea_fn_t)(nas_stream_cipher_t* const, uint8_t* const);
+typedef int (*eia_fn_t)(nas_stream_cipher_t* const, uint8_t const[4]);
+
+// Returns the messages handled per second by eea and eia
+static result_t run(int num_messages, std::vector<uint8_t>* message,
+                    eea_fn_t eea, eia_fn_t eia) {
+  std::vector<uint8_t> out(message->size());
+  uint8_t mac[4];
+  nas_stream_cipher_t stream_cipher = {
+      bench_key, AES128_KEY_SIZE, 0, 0, SECU_DIRECTION_DOWNLINK,
+      message->data(), (uint32_t)message->size() << 3};
+  result_t result;
+
+  int64_t start_ns = now_ns();
+  for (int i = 0; i < num_messages; i++) {
+    stream_cipher.count = i;
+    eea(&stream_cipher, out.data());
+  }
+  result.eea = num_messages * 1e9 / (now_ns() - start_ns);
+
+  start_ns = now_ns();
+  for (int i = 0; i < num_messages; i++) {
+    stream_cipher.count = i;
+    eia(&stream_cipher, mac);
+  }
+  result.eia = num_messages * 1e9 / (now_ns() - start_ns);
+  return result;
+}
+
+// Same as run with the key schedules looked up as nas_message does
+static result_t run_ctx(int num_messages, std::vector<uint8_t>* message) {
+  nas_stream_aes_ctx_t enc_ctx = {};
+  nas_stream_aes_ctx_t int_ctx = {};
+  std::vector<uint8_t> out(message->size());
+  uint8_t mac[4];
+  nas_stream_cipher_t stream_cipher = {
+      bench_key, AES128_KEY_SIZE, 0, 0, SECU_DIRECTION_DOWNLINK,
+      message->data(), (uint32_t)message->size() << 3};
+  result_t result;
+
+  int64_t start_ns = now_ns();
+  for (int i = 0; i < num_messages; i++) {
+    stream_cipher.count = i;
+    nas_stream_encrypt_eea2_ctx(nas_stream_aes_ctx_get(&enc_ctx, bench_key),
+                                &stream_cipher, out.data());
+  }
+  result.eea = num_messages * 1e9 / (now_ns() - start_ns);
+
+  start_ns = now_ns();
+  for (int i = 0; i < num_messages; i++) {
+    stream_cipher.count = i;
+    nas_stream_encrypt_eia2_ctx(nas_stream_aes_ctx_get(&int_ctx, bench_key),
+                                &stream_cipher, mac);
+  }
+  result.eia = num_messages * 1e9 / (now_ns() - start_ns);
+  return result;
+}
+
+int main(int argc, char** argv) {
+  int num_messages = argc > 1 ? atoi(argv[1]) : 100000;
+  std::vector<int> sizes;
+  for (int i = 2; i < argc; i++) {
+    sizes.push_back(atoi(argv[i]));
+  }
+  if (sizes.empty()) {
+    sizes = {16, 64, 256, 1024};
+  }
+  if (num_messages <= 0) {
+    fprintf(stderr, "Usage: bench_nas_crypto [num_messages] [sizes...]\n");
+    return 1;
+  }
+
+  printf("%6s %10s %10s %10s %10s %12s %12s\n", "bytes", "eea1/s", "eia1/s",
+         "eea2/s", "eia2/s", "eea2_ctx/s", "eia2_ctx/s");
+  for (int size : sizes) {
+    if (size <= 0) continue;
+    std::vector<uint8_t> message(size);
+    for (int i = 0; i < size; i++) {
+      message[i] = i;
+    }
+    result_t snow3g = run(num_messages, &message, nas_stream_encrypt_eea1,
+                          nas_stream_encrypt_eia1);
+    result_t aes = run(num_messages, &message, nas_stream_encrypt_eea2,
+                       nas_stream_encrypt_eia2);
+    result_t aes_ctx = run_ctx(num_messages, &message);
+    printf("%6d %10.0f %10.0f %10.0f %10.0f %12.0f %12.0f\n", size, snow3g.eea,
+           snow3g.eia, aes.eea, aes.eia, aes_ctx.eea, aes_ctx.eia);
+  }
+  return 0;
+}
@@ -0,0 +1,161 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures the datagrams per second sent and received over the loopback, in
+// bursts shaped like GTP-C bursts during mass session creation: one sendto
+// and one recvfrom per datagram as the UDP task did, and one sendmmsg and one
+// recvmmsg per burst as it does now (UDP_RECV_BATCH and UDP_SEND_BATCH are 32).
+// Usage: bench_udp_batch [num_datagrams] [datagram_size] [batch_size...]
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <vector>
+
+static int64_t now_ns() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static int bind_loopback(struct sockaddr_in* addr) {
+  int sd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+  socklen_t len = sizeof(*addr);
+  int rcvbuf = 4 * 1024 * 1024;
+
+  memset(addr, 0, sizeof(*addr));
+  addr->sin_family = AF_INET;
+  addr->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if ((sd < 0) || bind(sd, (struct sockaddr*)addr, sizeof(*addr)) ||
+      getsockname(sd, (struct sockaddr*)addr, &len)) {
+    perror("socket");
+    exit(1);
+  }
+  setsockopt(sd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+  return sd;
+}
+
+// Returns the datagrams per second, sent a burst at a time then received
+static double run(int num_datagrams, int datagram_size, int batch_size,
+                  bool mmsg) {
+  struct sockaddr_in server_addr, client_addr;
+  int server_sd = bind_loopback(&server_addr);
+  int client_sd = bind_loopback(&client_addr);
+  std::vector<uint8_t> tx(batch_size * datagram_size, 0x48);
+  std::vector<uint8_t> rx(batch_size * 4096);
+  std::vector<struct mmsghdr> tx_msgs(batch_size), rx_msgs(batch_size);
+  std::vector<struct iovec> tx_iovecs(batch_size), rx_iovecs(batch_size);
+  std::vector<struct sockaddr_in> peer_addrs(batch_size);
+
+  for (int i = 0; i < batch_size; i++) {
+    tx_iovecs[i] = {&tx[i * datagram_size], (size_t)datagram_size};
+    tx_msgs[i] = {};
+    tx_msgs[i].msg_hdr.msg_name = &server_addr;
+    tx_msgs[i].msg_hdr.msg_namelen = sizeof(server_addr);
+    tx_msgs[i].msg_hdr.msg_iov = &tx_iovecs[i];
+    tx_msgs[i].msg_hdr.msg_iovlen = 1;
+    rx_iovecs[i] = {&rx[i * 4096], 4096};
+    rx_msgs[i] = {};
+    rx_msgs[i].msg_hdr.msg_name = &peer_addrs[i];
+    rx_msgs[i].msg_hdr.msg_iov = &rx_iovecs[i];
+    rx_msgs[i].msg_hdr.msg_iovlen = 1;
+  }
+
+  int64_t received = 0;
+  int64_t start_ns = now_ns();
+  for (int sent = 0; sent < num_datagrams; sent += batch_size) {
+    int burst = std::min(batch_size, num_datagrams - sent);
+    if (mmsg) {
+      for (int done = 0; done < burst;) {
+        int rc = sendmmsg(client_sd, &tx_msgs[done], burst - done, 0);
+        if (rc <= 0) {
+          perror("sendmmsg");
+          exit(1);
+        }
+        done += rc;
+      }
+      for (int done = 0; done < burst;) {
+        for (int i = done; i < burst; i++) {
+          rx_msgs[i].msg_hdr.msg_namelen = sizeof(peer_addrs[i]);
+        }
+        int rc = recvmmsg(server_sd, &rx_msgs[done], burst - done, 0, nullptr);
+        if (rc <= 0) {
+          perror("recvmmsg");
+          exit(1);
+        }
+        done += rc;
+      }
+    } else {
+      for (int i = 0; i < burst; i++) {
+        if (sendto(client_sd, &tx[i * datagram_size], datagram_size, 0,
+                   (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
+          perror("sendto");
+          exit(1);
+        }
+      }
+      for (int i = 0; i < burst; i++) {
+        socklen_t len = sizeof(peer_addrs[i]);
+        if (recvfrom(server_sd, &rx[i * 4096], 4096, 0,
+                     (struct sockaddr*)&peer_addrs[i], &len) < 0) {
+          perror("recvfrom");
+          exit(1);
+        }
+      }
+    }
+    received += burst;
+  }
+  int64_t elapsed_ns = now_ns() - start_ns;
+
+  close(server_sd);
+  close(client_sd);
+  return received * 1e9 / elapsed_ns;
+}
+
+int main(int argc, char** argv) {
+  int num_datagrams = argc > 1 ? atoi(argv[1]) : 200000;
+  int datagram_size = argc > 2 ? atoi(argv[2]) : 200;
+  std::vector<int> batch_sizes;
+  for (int i = 3; i < argc; i++) {
+    batch_sizes.push_back(atoi(argv[i]));
+  }
+  if (batch_sizes.empty()) {
+    batch_sizes = {1, 8, 32};
+  }
+  if (num_datagrams <= 0 || datagram_size <= 0 || datagram_size > 4096) {
+    fprintf(stderr,
+            "Usage: bench_udp_batch [num_datagrams] [datagram_size] "
+            "[batch_size...]\n");
+    return 1;
+  }
+
+  for (int batch_size : batch_sizes) {
+    if (batch_size <= 0) {
+      fprintf(stderr, "Invalid batch size %d\n", batch_size);
+      return 1;
+    }
+    double single = run(num_datagrams, datagram_size, batch_size, false);
+    double batched = run(num_datagrams, datagram_size, batch_size, true);
+    printf(
+        "size=%d batch=%d sendto/recvfrom=%.0f/s sendmmsg/recvmmsg=%.0f/s "
+        "(x%.2f)\n",
+        datagram_size, batch_size, single, batched, batched / single);
+  }
+  return 0;
+}
@@ -0,0 +1,285 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stdint.h>
+#include <stdlib.h>
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+extern "C" {
+#include "lte/gateway/c/core/oai/lib/bstr/bstrlib.h"
+#include "lte/gateway/c/core/oai/lib/hashtable/hashtable.h"
+}
+
+namespace magma {
+namespace lte {
+
+static int num_freed = 0;
+
+static void count_free(void** data) {
+  num_freed++;
+  free(*data);
+  *data = NULL;
+}
+
+// Sends all keys to the same home slot, so that every key is found through
+// the probe sequence of the others
+static hash_size_t same_hash(const hash_key_t key) { return 42; }
+
+static bool free_element(const hash_key_t key, void* const element,
+                         void* parameter, void** result) {
+  hash_table_ts_t* htbl = (hash_table_ts_t*)parameter;
+  EXPECT_EQ(hashtable_ts_free(htbl, key), HASH_TABLE_OK);
+  (*(int*)*result)++;
+  return false;
+}
+
+static bool find_element(const hash_key_t key, void* const element,
+                         void* parameter, void** result) {
+  if (*(int*)element == *(int*)parameter) {
+    *result = element;
+    return true;
+  }
+  return false;
+}
+
+class HashtableTest : public ::testing::Test {
+  virtual void SetUp() { num_freed = 0; }
+
+ protected:
+  int* new_element(int value) {
+    int* element = (int*)malloc(sizeof(int));
+    *element = value;
+    return element;
+  }
+};
+
+TEST_F(HashtableTest, TestInsertGetFree) {
+  hash_table_ts_t* htbl = hashtable_ts_create(8, nullptr, count_free, nullptr);
+  ASSERT_NE(htbl, nullptr);
+  EXPECT_EQ(htbl->size, HASH_TABLE_TS_MIN_SIZE);
+
+  EXPECT_EQ(hashtable_ts_insert(htbl, 1, new_element(1)), HASH_TABLE_OK);
+  EXPECT_EQ(hashtable_ts_insert(htbl, 2, new_element(2)), HASH_TABLE_OK);
+  EXPECT_EQ(htbl->num_elements, 2);
+
+  void* element = nullptr;
+  EXPECT_EQ(hashtable_ts_get(htbl, 1, &element), HASH_TABLE_OK);
+  EXPECT_EQ(*(int*)element, 1);
+  EXPECT_EQ(hashtable_ts_get(htbl, 3, &element), HASH_TABLE_KEY_NOT_EXISTS);
+  EXPECT_EQ(element, nullptr);
+  EXPECT_EQ(hashtable_ts_is_key_exists(htbl, 2), HASH_TABLE_OK);
+
+  // Overwriting a key frees the previous element
+  EXPECT_EQ(hashtable_ts_insert(htbl, 1, new_element(10)),
+            HASH_TABLE_INSERT_OVERWRITTEN_DATA);
+  EXPECT_EQ(num_freed, 1);
+  EXPECT_EQ(htbl->num_elements, 2);
+  EXPECT_EQ(hashtable_ts_get(htbl, 1, &element), HASH_TABLE_OK);
+  EXPECT_EQ(*(int*)element, 10);
+
+  EXPECT_EQ(hashtable_ts_free(htbl, 1), HASH_TABLE_OK);
+  EXPECT_EQ(num_freed, 2);
+  EXPECT_EQ(hashtable_ts_free(htbl, 1), HASH_TABLE_KEY_NOT_EXISTS);
+
+  EXPECT_EQ(hashtable_ts_remove(htbl, 2, &element), HASH_TABLE_OK);
+  EXPECT_EQ(*(int*)element, 2);
+  EXPECT_EQ(num_freed, 2);
+  EXPECT_EQ(htbl->num_elements, 0);
+  free(element);
+
+  EXPECT_EQ(hashtable_ts_destroy(htbl), HASH_TABLE_OK);
+}
+
+TEST_F(HashtableTest, TestGrow) {
+  const int num_keys = 100000;
+  hash_table_ts_t* htbl = hashtable_ts_create(16, nullptr, count_free, nullptr);
+
+  // S1AP IDs and TEIDs are allocated sequentially
+  for (int i = 0; i < num_keys; i++) {
+    ASSERT_EQ(hashtable_ts_insert(htbl, i, new_element(i)), HASH_TABLE_OK);
+  }
+  EXPECT_EQ(htbl->num_elements, num_keys);
+  EXPECT_LE(htbl->num_elements * 100, htbl->size * HASH_TABLE_TS_MAX_LOAD);
+
+  for (int i = 0; i < num_keys; i++) {
+    void* element = nullptr;
+    ASSERT_EQ(hashtable_ts_get(htbl, i, &element), HASH_TABLE_OK);
+    EXPECT_EQ(*(int*)element, i);
+  }
+
+  EXPECT_EQ(hashtable_ts_destroy(htbl), HASH_TABLE_OK);
+  EXPECT_EQ(num_freed, num_keys);
+}
+
+TEST_F(HashtableTest, TestReserve) {
+  const int num_keys = 10000;
+  hash_table_ts_t* htbl = hashtable_ts_create(16, nullptr, count_free, nullptr);
+
+  EXPECT_EQ(hashtable_ts_reserve(htbl, num_keys), HASH_TABLE_OK);
+  hash_size_t size = htbl->size;
+  EXPECT_LE(num_keys * 100, size * HASH_TABLE_TS_MAX_LOAD);
+
+  // The restored UEs are inserted without reallocating the slots
+  for (int i = 0; i < num_keys; i++) {
+    ASSERT_EQ(hashtable_ts_insert(htbl, i, new_element(i)), HASH_TABLE_OK);
+  }
+  EXPECT_EQ(htbl->size, size);
+  EXPECT_EQ(hashtable_ts_reserve(htbl, 0), HASH_TABLE_OK);
+  EXPECT_EQ(htbl->size, size);
+  // Rejected instead of overflowing the load computation
+  EXPECT_EQ(hashtable_ts_reserve(htbl, SIZE_MAX), HASH_TABLE_SYSTEM_ERROR);
+  EXPECT_EQ(htbl->size, size);
+
+  EXPECT_EQ(hashtable_ts_destroy(htbl), HASH_TABLE_OK);
+  EXPECT_EQ(num_freed, num_keys);
+}
+
+TEST_F(HashtableTest, TestFreeKeepsCollidingKeys) {
+  const int num_keys = 12;
+  hash_table_ts_t* htbl =
+      hashtable_ts_create(16, same_hash, count_free, nullptr);
+
+  for (int i = 0; i < num_keys; i++) {
+    ASSERT_EQ(hashtable_ts_insert(htbl, i, new_element(i)), HASH_TABLE_OK);
+  }
+  // Free every other key, lookups of the following keys of the probe sequence
+  // go past the freed slots
+  for (int i = 0; i < num_keys; i += 2) {
+    EXPECT_EQ(hashtable_ts_free(htbl, i), HASH_TABLE_OK);
+  }
+  EXPECT_EQ(htbl->num_elements, num_keys / 2);
+
+  for (int i = 0; i < num_keys; i++) {
+    void* element = nullptr;
+    if (i % 2) {
+      ASSERT_EQ(hashtable_ts_get(htbl, i, &element), HASH_TABLE_OK);
+      EXPECT_EQ(*(int*)element, i);
+    } else {
+      EXPECT_EQ(hashtable_ts_get(htbl, i, &element),
+                HASH_TABLE_KEY_NOT_EXISTS);
+    }
+  }
+
+  EXPECT_EQ(hashtable_ts_destroy(htbl), HASH_TABLE_OK);
+  EXPECT_EQ(num_freed, num_keys);
+}
+
+TEST_F(HashtableTest, TestGetKeysAndElements) {
+  hash_table_ts_t* htbl = hashtable_ts_create(16, nullptr, count_free, nullptr);
+  EXPECT_EQ(hashtable_ts_get_keys(htbl), nullptr);
+  EXPECT_EQ(hashtable_ts_get_elements(htbl), nullptr);
+
+  uint64_t key_sum = 0;
+  for (int i = 1; i <= 100; i++) {
+    hashtable_ts_insert(htbl, i * 1000, new_element(i));
+    key_sum += i * 1000;
+  }
+
+  hashtable_key_array_t* keys = hashtable_ts_get_keys(htbl);
+  ASSERT_NE(keys, nullptr);
+  EXPECT_EQ(keys->num_keys, 100);
+  for (int i = 0; i < keys->num_keys; i++) {
+    key_sum -= keys->keys[i];
+  }
+  EXPECT_EQ(key_sum, 0);
+  free(keys->keys);
+  free(keys);
+
+  hashtable_element_array_t* elements = hashtable_ts_get_elements(htbl);
+  ASSERT_NE(elements, nullptr);
+  EXPECT_EQ(elements->num_elements, 100);
+  free(elements->elements);
+  free(elements);
+
+  EXPECT_EQ(hashtable_ts_destroy(htbl), HASH_TABLE_OK);
+}
+
+TEST_F(HashtableTest, TestApplyCallback) {
+  hash_table_ts_t* htbl = hashtable_ts_create(16, nullptr, count_free, nullptr);
+  for (int i = 0; i < 100; i++) {
+    hashtable_ts_insert(htbl, i, new_element(i));
+  }
+
+  int value = 57;
+  void* found = nullptr;
+  hashtable_ts_apply_callback_on_elements(htbl, find_element, &value, &found);
+  ASSERT_NE(found, nullptr);
+  EXPECT_EQ(*(int*)found, 57);
+
+  // Callbacks may free elements of the table they are walking
+  int num_visited = 0;
+  void* result = &num_visited;
+  hashtable_ts_apply_callback_on_elements(htbl, free_element, htbl, &result);
+  EXPECT_EQ(num_visited, 100);
+  EXPECT_EQ(num_freed, 100);
+  EXPECT_EQ(htbl->num_elements, 0);
+
+  EXPECT_EQ(hashtable_ts_destroy(htbl), HASH_TABLE_OK);
+}
+
+TEST_F(HashtableTest, TestLookupsDuringModifications) {
+  const int num_keys = 1000;
+  const int num_churn_keys = 100000;
+  hash_table_ts_t* htbl = hashtable_ts_create(16, nullptr, count_free, nullptr);
+  for (int i = 0; i < num_keys; i++) {
+    hashtable_ts_insert(htbl, i, new_element(i));
+  }
+
+  // Readers must find the stable keys while the writer inserts and removes
+  // other keys, leaving tombstones and reallocating the slots
+  std::atomic<bool> stop(false);
+  std::atomic<int> num_errors(0);
+  std::vector<std::thread> readers;
+  for (int r = 0; r < 4; r++) {
+    readers.emplace_back([&] {
+      while (!stop) {
+        for (int i = 0; i < num_keys; i++) {
+          void* element = nullptr;
+          if (hashtable_ts_get(htbl, i, &element) != HASH_TABLE_OK ||
+              *(int*)element != i) {
+            num_errors++;
+          }
+        }
+        hashtable_key_array_t* keys = hashtable_ts_get_keys(htbl);
+        if (!keys || keys->num_keys < num_keys) {
+          num_errors++;
+        }
+        if (keys) {
+          free(keys->keys);
+          free(keys);
+        }
+      }
+    });
+  }
+
+  for (int i = num_keys; i < num_keys + num_churn_keys; i++) {
+    hashtable_ts_insert(htbl, i, new_element(i));
+    if (i % 3) {
+      hashtable_ts_free(htbl, i);
+    }
+  }
+  stop = true;
+  for (auto& reader : readers) {
+    reader.join();
+  }
+  EXPECT_EQ(num_errors, 0);
+  EXPECT_EQ(htbl->num_elements, num_keys + num_churn_keys / 3);
+
+  EXPECT_EQ(hashtable_ts_destroy(htbl), HASH_TABLE_OK);
+  EXPECT_EQ(num_freed, num_keys + num_churn_keys);
+}
+
+}  // namespace lte
+}  // namespace magma
@@ -0,0 +1,146 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+#include "lte/gateway/c/core/oai/common/log_binary.h"
+
+namespace magma {
+namespace lte {
+
+typedef struct {
+  std::vector<std::string> lines;
+  uint64_t dropped;
+} drained_t;
+
+static bool queue(const char* format, ...) {
+  log_binary_message_t message = {};
+  va_list args;
+
+  message.level = 6;
+  message.line = 42;
+  va_start(args, format);
+  bool queued = log_binary_message(&message, __FILE__, format, args);
+  va_end(args);
+  return queued;
+}
+
+// Keeps the message text only, after the line prefix
+static void format_record(const log_binary_record_t* record, void* arg) {
+  drained_t* drained = (drained_t*)arg;
+  char line[LOG_BINARY_LINE_MAX];
+
+  if (LOG_BINARY_RECORD_MESSAGE == record->type) {
+    const log_binary_message_t* message = (const log_binary_message_t*)record;
+    ASSERT_GT(log_binary_format_line(
+                  message, (const char*)(uintptr_t)message->format,
+                  (const char*)(uintptr_t)message->file, "INFO", "MME-AP", 0,
+                  0, line, sizeof(line)),
+              0);
+    const char* text = strstr(line, ":0042 ");
+    ASSERT_NE(text, nullptr);
+    text += strspn(text + strlen(":0042"), " ") + strlen(":0042");
+    drained->lines.push_back(text);
+  } else if (LOG_BINARY_RECORD_DROPPED == record->type) {
+    drained->dropped += ((const log_binary_dropped_t*)record)->count;
+  }
+}
+
+static drained_t drain() {
+  drained_t drained = {{}, 0};
+  log_binary_drain(format_record, &drained);
+  return drained;
+}
+
+TEST(LogBinaryTest, test_format_like_printf) {
+  log_binary_init();
+  drain();
+
+  EXPECT_TRUE(queue("plain\n"));
+  EXPECT_TRUE(queue("%d %u %x %lu %lld %hhu %zu %%\n", -5, 7u, 255u,
+                    (unsigned long)UINT64_MAX, -3LL, 300, (size_t)9));
+  EXPECT_TRUE(queue("[%-8s] [%5.2s] %s\n", "left", "truncated",
+                    (const char*)nullptr));
+  EXPECT_TRUE(queue("[%*d]%-*.*f|%c|%.3e\n", 6, 42, 10, 2, 3.14159, 'z', 1e10));
+  EXPECT_TRUE(queue("%p %#o\n", (void*)0x1234, 8u));
+
+  drained_t drained = drain();
+  char expected[LOG_BINARY_LINE_MAX];
+  std::vector<std::string> expected_lines;
+  snprintf(expected, sizeof(expected), "plain\n");
+  expected_lines.push_back(expected);
+  snprintf(expected, sizeof(expected), "%d %u %x %lu %lld %hhu %zu %%\n", -5,
+           7u, 255u, (unsigned long)UINT64_MAX, -3LL, 300, (size_t)9);
+  expected_lines.push_back(expected);
+  snprintf(expected, sizeof(expected), "[%-8s] [%5.2s] %s\n", "left",
+           "truncated", "(null)");
+  expected_lines.push_back(expected);
+  snprintf(expected, sizeof(expected), "[%*d]%-*.*f|%c|%.3e\n", 6, 42, 10, 2,
+           3.14159, 'z', 1e10);
+  expected_lines.push_back(expected);
+  snprintf(expected, sizeof(expected), "%p %#o\n", (void*)0x1234, 8u);
+  expected_lines.push_back(expected);
+  EXPECT_EQ(drained.lines, expected_lines);
+  EXPECT_EQ(drained.dropped, 0);
+}
+
+// Formats that may change or whose arguments are not copied are logged as
+// text by the caller
+TEST(LogBinaryTest, test_fallback_to_text) {
+  log_binary_init();
+  drain();
+  char format[] = "not a literal %d\n";
+  std::string long_string(LOG_BINARY_RECORD_MAX, 'a');
+
+  EXPECT_FALSE(queue(format, 1));
+  EXPECT_FALSE(queue("%n\n", nullptr));
+  EXPECT_FALSE(queue("%1$d\n", 1));
+  EXPECT_FALSE(queue("%Lf\n", 1.0L));
+  EXPECT_FALSE(queue("%ls\n", L"wide"));
+  EXPECT_FALSE(queue("%s\n", long_string.c_str()));
+
+  drained_t drained = drain();
+  EXPECT_TRUE(drained.lines.empty());
+}
+
+TEST(LogBinaryTest, test_full_ring_counts_dropped) {
+  log_binary_init();
+  drain();
+  std::string string(1000, 'b');
+  int queued = 0;
+
+  // No drain in between, the ring fills up
+  for (int i = 0; i < 2 * LOG_BINARY_RING_SIZE / 1000; i++) {
+    EXPECT_TRUE(queue("%d %s\n", i, string.c_str()));
+    queued++;
+  }
+  drained_t drained = drain();
+  EXPECT_GT(drained.lines.size(), 0);
+  EXPECT_GT(drained.dropped, 0);
+  EXPECT_EQ(drained.lines.size() + drained.dropped, queued);
+  EXPECT_EQ(drained.lines[0], "0 " + string + "\n");
+
+  // The ring is usable again once drained
+  EXPECT_TRUE(queue("after %d\n", 1));
+  drained = drain();
+  EXPECT_EQ(drained.lines, std::vector<std::string>{"after 1\n"});
+  EXPECT_EQ(drained.dropped, 0);
+}
+
+}  // namespace lte
+}  // namespace magma
@@ -0,0 +1,204 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stdint.h>
+#include <string.h>
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+#include "lte/gateway/c/core/oai/lib/secu/secu_defs.h"
+
+extern "C" {
+#include "lte/gateway/c/core/oai/lib/secu/snow3g.h"
+}
+
+namespace magma {
+namespace lte {
+
+static std::vector<uint8_t> from_hex(const std::string& hex) {
+  std::vector<uint8_t> bytes;
+  for (size_t i = 0; i + 1 < hex.size(); i += 2) {
+    bytes.push_back(std::stoi(hex.substr(i, 2), nullptr, 16));
+  }
+  return bytes;
+}
+
+// 3GPP TS 35.222 section 3, SNOW 3G test sets 1 to 4
+TEST(SecuTest, test_snow3g_key_stream) {
+  struct {
+    uint32_t k[4];
+    uint32_t iv[4];
+    uint32_t z1;
+    uint32_t z2;
+  } test_sets[] = {
+      {{0x2bd6459f, 0x82c5b300, 0x952c4910, 0x4881ff48},
+       {0xea024714, 0xad5c4d84, 0xdf1f9b25, 0x1c0bf45f},
+       0xabee9704,
+       0x7ac31373},
+      {{0x8ce33e2c, 0xc3c0b5fc, 0x1f3de8a6, 0xdc66b1f3},
+       {0xd3c5d592, 0x327fb11c, 0xde551988, 0xceb2f9b7},
+       0xeff8a342,
+       0xf751480f},
+      {{0x4035c668, 0x0af8c6d1, 0xa8ff8667, 0xb1714013},
+       {0x62a54098, 0x1ba6f9b7, 0x4592b0e7, 0x8690f71b},
+       0xa8c874a9,
+       0x7ae7c4f8},
+      {{0x0ded7263, 0x109cf92e, 0x3352255a, 0x140e0f76},
+       {0x6b68079a, 0x41a7c4c9, 0x1befd79f, 0x7fdcc233},
+       0xd712c05c,
+       0xa937c2a6},
+  };
+
+  for (auto& test_set : test_sets) {
+    snow_3g_context_t snow_3g_context;
+    uint32_t z[2];
+    snow3g_initialize(test_set.k, test_set.iv, &snow_3g_context);
+    snow3g_generate_key_stream(2, z, &snow_3g_context);
+    EXPECT_EQ(z[0], test_set.z1);
+    EXPECT_EQ(z[1], test_set.z2);
+  }
+
+  // Test set 4 also gives z2500, past many wraps of the LFSR
+  std::vector<uint32_t> z(2500);
+  snow_3g_context_t snow_3g_context;
+  snow3g_initialize(test_sets[3].k, test_sets[3].iv, &snow_3g_context);
+  snow3g_generate_key_stream(z.size(), z.data(), &snow_3g_context);
+  EXPECT_EQ(z[0], test_sets[3].z1);
+  EXPECT_EQ(z[2499], 0x9c0db3aa);
+}
+
+// 3GPP TS 33.401 Annex C.1, 128-EEA1 test set 1
+TEST(SecuTest, test_eea1_test_set_1) {
+  auto key = from_hex("d3c5d592327fb11c4035c6680af8c6d1");
+  auto plaintext = from_hex(
+      "981ba6824c1bfb1ab485472029b71d808ce33e2cc3c0b5fc1f3de8a6dc66b1f0");
+  auto ciphertext = from_hex(
+      "5d5bfe75eb04f68ce0a12377ea00b37d47c6a0ba06309155086a859c4341b378");
+  nas_stream_cipher_t stream_cipher = {
+      key.data(), 16, 0x398a59b4, 0x15, 1, plaintext.data(), 253};
+  std::vector<uint8_t> out(plaintext.size());
+
+  nas_stream_encrypt_eea1(&stream_cipher, out.data());
+  EXPECT_EQ(out, ciphertext);
+
+  // In place
+  std::vector<uint8_t> buffer = plaintext;
+  stream_cipher.message = buffer.data();
+  nas_stream_encrypt_eea1(&stream_cipher, buffer.data());
+  EXPECT_EQ(buffer, ciphertext);
+}
+
+// 3GPP TS 33.401 Annex C.3, 128-EIA1 test set 1
+TEST(SecuTest, test_eia1_test_set_1) {
+  auto key = from_hex("2bd6459f82c5b300952c49104881ff48");
+  auto message = from_hex("3332346263393861373479");
+  nas_stream_cipher_t stream_cipher = {
+      key.data(), 16, 0x38a6f056, 0x1f, 0, message.data(), 88};
+  uint8_t mac[4] = {0};
+
+  nas_stream_encrypt_eia1(&stream_cipher, mac);
+  EXPECT_EQ(std::vector<uint8_t>(mac, mac + 4), from_hex("731f1165"));
+}
+
+// 3GPP TS 33.401 Annex C.1, 128-EEA2 test set 1
+TEST(SecuTest, test_eea2_test_set_1) {
+  auto key = from_hex("d3c5d592327fb11c4035c6680af8c6d1");
+  auto plaintext = from_hex(
+      "981ba6824c1bfb1ab485472029b71d808ce33e2cc3c0b5fc1f3de8a6dc66b1f0");
+  auto ciphertext = from_hex(
+      "e9fed8a63d155304d71df20bf3e82214b20ed7dad2f233dc3c22d7bdeeed8e78");
+  nas_stream_cipher_t stream_cipher = {
+      key.data(), 16, 0x398a59b4, 0x15, 1, plaintext.data(), 253};
+  std::vector<uint8_t> out(plaintext.size());
+
+  nas_stream_encrypt_eea2(&stream_cipher, out.data());
+  EXPECT_EQ(out, ciphertext);
+
+  // In place with the key scheduled beforehand
+  nas_stream_aes_ctx_t ctx = {};
+  std::vector<uint8_t> buffer = plaintext;
+  stream_cipher.message = buffer.data();
+  nas_stream_encrypt_eea2_ctx(nas_stream_aes_ctx_get(&ctx, key.data()),
+                              &stream_cipher, buffer.data());
+  EXPECT_EQ(buffer, ciphertext);
+}
+
+// 3GPP TS 33.401 Annex C.2, 128-EIA2 test set 2
+TEST(SecuTest, test_eia2_test_set_2) {
+  auto key = from_hex("d3c5d592327fb11c4035c6680af8c6d1");
+  auto message = from_hex("484583d5afe082ae");
+  nas_stream_cipher_t stream_cipher = {
+      key.data(), 16, 0x398a59b4, 0x1a, 1, message.data(), 64};
+  uint8_t mac[4] = {0};
+
+  nas_stream_encrypt_eia2(&stream_cipher, mac);
+  EXPECT_EQ(std::vector<uint8_t>(mac, mac + 4), from_hex("b93787e6"));
+
+  nas_stream_aes_ctx_t ctx = {};
+  memset(mac, 0, sizeof(mac));
+  nas_stream_encrypt_eia2_ctx(nas_stream_aes_ctx_get(&ctx, key.data()),
+                              &stream_cipher, mac);
+  EXPECT_EQ(std::vector<uint8_t>(mac, mac + 4), from_hex("b93787e6"));
+}
+
+// RFC 4493 section 4, subkey generation of AES-CMAC
+TEST(SecuTest, test_cmac_subkeys) {
+  auto key = from_hex("2b7e151628aed2a6abf7158809cf4f3c");
+  nas_stream_aes_ctx_t ctx = {};
+
+  nas_stream_aes_ctx_init(&ctx, key.data());
+  EXPECT_EQ(std::vector<uint8_t>(ctx.cmac_k1, ctx.cmac_k1 + 16),
+            from_hex("fbeed618357133667c85e08f7236a8de"));
+  EXPECT_EQ(std::vector<uint8_t>(ctx.cmac_k2, ctx.cmac_k2 + 16),
+            from_hex("f7ddac306ae266ccf90bc11ee46d513b"));
+}
+
+// The MAC covers the 8 bytes of COUNT, BEARER and DIRECTION followed by the
+// message, across every block boundary
+TEST(SecuTest, test_eia2_ctx_message_lengths) {
+  auto key = from_hex("2bd6459f82c5b300952c49104881ff48");
+  nas_stream_aes_ctx_t ctx = {};
+  nas_stream_aes_ctx_init(&ctx, key.data());
+  std::vector<uint8_t> message(100);
+  for (size_t i = 0; i < message.size(); i++) {
+    message[i] = i * 7 + 3;
+  }
+
+  for (uint32_t length = 0; length <= message.size(); length++) {
+    nas_stream_cipher_t stream_cipher = {
+        key.data(), 16, 0x38a6f056, 0x18, 0, message.data(), length << 3};
+    uint8_t expected[4], mac[4];
+    nas_stream_encrypt_eia2(&stream_cipher, expected);
+    nas_stream_encrypt_eia2_ctx(&ctx, &stream_cipher, mac);
+    EXPECT_EQ(memcmp(mac, expected, 4), 0) << "length " << length;
+  }
+}
+
+// A context is scheduled again when the key of the security context changes
+TEST(SecuTest, test_aes_ctx_get_new_key) {
+  auto key = from_hex("d3c5d592327fb11c4035c6680af8c6d1");
+  auto new_key = from_hex("2bd6459f82c5b300952c49104881ff48");
+  nas_stream_aes_ctx_t ctx = {};
+  nas_stream_aes_ctx_t expected = {};
+
+  EXPECT_EQ(nas_stream_aes_ctx_get(&ctx, key.data()), &ctx);
+  EXPECT_TRUE(ctx.scheduled);
+  nas_stream_aes_ctx_get(&ctx, new_key.data());
+  nas_stream_aes_ctx_init(&expected, new_key.data());
+  EXPECT_EQ(memcmp(ctx.key, new_key.data(), 16), 0);
+  EXPECT_EQ(memcmp(ctx.cmac_k1, expected.cmac_k1, 16), 0);
+  EXPECT_EQ(memcmp(ctx.cmac_k2, expected.cmac_k2, 16), 0);
+}
+
+}  // namespace lte
+}  // namespace magma
@@ -0,0 +1,189 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures the time to ready of the MME UE state restore, from the scan of the
+// UE keys until all UE contexts are in the UE table, reading the keys one by
+// one and with the batched restore. Stores the UE states in the redis server
+// configured in redis.yml under a dedicated task name, and removes them after.
+// Skipped when no redis server is reachable.
+// Usage: bench_state_restore [num_ues...]
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <exception>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+extern "C" {
+#include "lte/gateway/c/core/oai/common/log.h"
+#include "lte/gateway/c/core/oai/include/mme_app_ue_context.h"
+#include "lte/gateway/c/core/oai/lib/hashtable/hashtable.h"
+}
+
+#include "lte/gateway/c/core/oai/common/redis_utils/redis_client.hpp"
+#include "lte/gateway/c/core/oai/include/state_utility.hpp"
+#include "lte/gateway/c/core/oai/tasks/mme_app/mme_app_state_converter.hpp"
+#include "lte/protos/oai/mme_nas_state.pb.h"
+
+namespace magma {
+namespace lte {
+
+#define BENCH_TASK_NAME "bench_state_restore"
+#define BENCH_WRITE_BATCH_SIZE 1000
+
+class BenchStateManager : public StateUtility {
+ public:
+  BenchStateManager() {
+    redis_client = std::make_unique<RedisClient>(false);
+    is_initialized = true;
+    persist_state_enabled = true;
+    task_name = BENCH_TASK_NAME;
+    log_task = LOG_MME_APP;
+  }
+
+  RedisClient& client() { return *redis_client; }
+
+  // False if redis.yml cannot be loaded or the server cannot be reached
+  bool connect() {
+    try {
+      redis_client->init_db_connection();
+    } catch (const std::exception& e) {
+      fprintf(stderr, "redis: %s\n", e.what());
+      return false;
+    }
+    return true;
+  }
+
+  using StateUtility::read_ue_protos_from_db;
+};
+
+static double now_secs() {
+  return std::chrono::duration<double>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+static std::string ue_key(int i) {
+  return IMSI_STR_PREFIX + std::to_string(1010000000000ULL + i) + ":" +
+         BENCH_TASK_NAME;
+}
+
+// UE contexts of attached UEs, with a UE radio capability
+static void store_ues(RedisClient& client, int num_ues) {
+  std::vector<std::pair<std::string, std::string>> key_values;
+  for (int i = 0; i < num_ues; i++) {
+    oai::UeContext ue_proto = oai::UeContext();
+    ue_proto.set_msisdn("5550100" + std::to_string(i));
+    ue_proto.set_mm_state(UE_REGISTERED);
+    ue_proto.set_enb_ue_s1ap_id(i + 1);
+    ue_proto.set_mme_ue_s1ap_id(i + 1);
+    ue_proto.set_lai(std::string(5, '\x01'));
+    ue_proto.set_ue_radio_capability(std::string(512, '\x5a'));
+    ue_proto.mutable_emm_context()->set_imsi64(1010000000000ULL + i);
+
+    std::string proto_str;
+    std::string wrapped_str;
+    RedisClient::serialize(ue_proto, proto_str);
+    RedisClient::wrap_proto_str(proto_str, 1, wrapped_str);
+    key_values.emplace_back(ue_key(i), std::move(wrapped_str));
+    if (key_values.size() == BENCH_WRITE_BATCH_SIZE || i == num_ues - 1) {
+      client.write_batch(key_values);
+      key_values.clear();
+    }
+  }
+}
+
+static void clear_ues(RedisClient& client, int num_ues) {
+  std::vector<std::string> keys;
+  for (int i = 0; i < num_ues; i++) {
+    keys.emplace_back(ue_key(i));
+    if (keys.size() == BENCH_WRITE_BATCH_SIZE || i == num_ues - 1) {
+      client.clear_keys(keys);
+      keys.clear();
+    }
+  }
+}
+
+static void restore_ue(hash_table_ts_t* state_ue_ht,
+                       const oai::UeContext& ue_proto) {
+  auto* ue_context =
+      reinterpret_cast<ue_mm_context_t*>(calloc(1, sizeof(ue_mm_context_t)));
+  MmeNasStateConverter::proto_to_ue(ue_proto, ue_context);
+  hashtable_ts_insert(state_ue_ht, ue_context->mme_ue_s1ap_id, ue_context);
+}
+
+// Reads the keys one by one, like the restore did before batching
+static double restore_serial(BenchStateManager& manager) {
+  hash_table_ts_t* state_ue_ht = hashtable_ts_create(
+      16, nullptr, mme_app_state_free_ue_context, nullptr);
+  double start = now_secs();
+  auto keys = manager.client().get_keys("IMSI*" BENCH_TASK_NAME "*");
+  for (const auto& key : keys) {
+    oai::UeContext ue_proto = oai::UeContext();
+    manager.client().read_proto(key, ue_proto);
+    restore_ue(state_ue_ht, ue_proto);
+  }
+  double secs = now_secs() - start;
+  hashtable_ts_destroy(state_ue_ht);
+  return secs;
+}
+
+static double restore_batched(BenchStateManager& manager) {
+  hash_table_ts_t* state_ue_ht = hashtable_ts_create(
+      16, nullptr, mme_app_state_free_ue_context, nullptr);
+  double start = now_secs();
+  auto keys = manager.client().get_keys("IMSI*" BENCH_TASK_NAME "*");
+  hashtable_ts_reserve(state_ue_ht, keys.size());
+  manager.read_ue_protos_from_db<oai::UeContext>(
+      keys, [state_ue_ht](const std::string& key,
+                          const oai::UeContext& ue_proto) {
+        restore_ue(state_ue_ht, ue_proto);
+      });
+  double secs = now_secs() - start;
+  hashtable_ts_destroy(state_ue_ht);
+  return secs;
+}
+
+}  // namespace lte
+}  // namespace magma
+
+int main(int argc, char** argv) {
+  std::vector<int> num_ues_runs;
+  for (int i = 1; i < argc; i++) {
+    num_ues_runs.push_back(atoi(argv[i]));
+  }
+  if (num_ues_runs.empty()) {
+    num_ues_runs = {10000, 100000};
+  }
+
+  // Per UE debug logs would dominate the restore time
+  OAILOG_INIT("MME", OAILOG_LEVEL_ERROR, MAX_LOG_PROTOS);
+  magma::lte::BenchStateManager manager;
+  if (!manager.connect()) {
+    printf("skipped: no redis server reachable\n");
+    return 0;
+  }
+  for (int num_ues : num_ues_runs) {
+    magma::lte::store_ues(manager.client(), num_ues);
+    double serial_secs = magma::lte::restore_serial(manager);
+    double batched_secs = magma::lte::restore_batched(manager);
+    magma::lte::clear_ues(manager.client(), num_ues);
+    printf("ues=%d serial=%.3fs batched=%.3fs speedup=%.1fx\n", num_ues,
+           serial_secs, batched_secs, serial_secs / batched_secs);
+  }
+  return 0;
+}
@@ -104,7 +104,7 @@ class MmeAppProcedureTest : public ::testing::Test {
     spgw_handler = std::make_shared<MockSpgwHandler>();
     service303_handler = std::make_shared<MockService303Handler>();
     itti_init(TASK_MAX, THREAD_MAX, MESSAGES_ID_MAX, tasks_info, messages_info,
-              NULL, NULL);
+              NULL, NULL, ITTI_TRANSPORT_ZMQ);
 
     // initialize mme config
     mme_config_init(&mme_config);
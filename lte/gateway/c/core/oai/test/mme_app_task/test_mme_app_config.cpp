@@ -77,6 +77,7 @@ const char* kHealthyConfig =
     {
         # max queue size per task
         ITTI_QUEUE_SIZE            = 2000000;
+        ITTI_TRANSPORT             = "ring";
     };
 
     S6A :
@@ -91,6 +92,7 @@ const char* kHealthyConfig =
         # Path to sctpd up and downstream unix domain sockets
         SCTP_UPSTREAM_SOCK = "unix:///tmp/sctpd_upstream_test.sock";
         SCTP_DOWNSTREAM_SOCK = "unix:///tmp/sctpd_downstream_test.sock";
+        SCTP_DOWNSTREAM_STREAMING = "yes";
     };
 
     # ------- S1AP definitions
@@ -858,10 +860,23 @@ TEST(MMEConfigTest, TestMissingSctpdConfig) {
             "unix:///tmp/sctpd_upstream.sock");
   EXPECT_EQ(std::string(bdata(mme_config.sctp_config.downstream_sctp_sock)),
             "unix:///tmp/sctpd_downstream.sock");
+  EXPECT_FALSE(mme_config.sctp_config.downstream_streaming);
 
   free_mme_config(&mme_config);
 }
 
+TEST(MMEConfigTest, TestIttiTransportConfig) {
+  mme_config_t mme_config = {0};
+  EXPECT_EQ(mme_config_parse_string(kEmptyConfig, &mme_config), 0);
+  EXPECT_FALSE(mme_config.itti_config.ring_transport);
+  free_mme_config(&mme_config);
+
+  mme_config = {0};
+  EXPECT_EQ(mme_config_parse_string(kHealthyConfig, &mme_config), 0);
+  EXPECT_TRUE(mme_config.itti_config.ring_transport);
+  free_mme_config(&mme_config);
+}
+
 TEST(MMEConfigTest, TestMissingSctpdUpstreamSockConfig) {
   mme_config_t mme_config = {0};
   EXPECT_EQ(mme_config_parse_string(kConfigMissingUpstreamSock, &mme_config),
@@ -881,6 +896,7 @@ TEST(MMEConfigTest, TestHealthySctpdConfig) {
             "unix:///tmp/sctpd_upstream_test.sock");
   EXPECT_EQ(std::string(bdata(mme_config.sctp_config.downstream_sctp_sock)),
             "unix:///tmp/sctpd_downstream_test.sock");
+  EXPECT_TRUE(mme_config.sctp_config.downstream_streaming);
 
   free_mme_config(&mme_config);
 }
@@ -32,7 +32,7 @@ class NgapFlowTest : public testing::Test {
  protected:
   void SetUp() {
     itti_init(TASK_MAX, THREAD_MAX, MESSAGES_ID_MAX, tasks_info, messages_info,
-              NULL, NULL);
+              NULL, NULL, ITTI_TRANSPORT_ZMQ);
 
     amf_config_init(&amf_config);
     amf_config.plmn_support_list.plmn_support_count = 1;
@@ -33,7 +33,7 @@ class NgapStateConverterTest : public testing::Test {
  protected:
   void SetUp() {
     itti_init(TASK_MAX, THREAD_MAX, MESSAGES_ID_MAX, tasks_info, messages_info,
-              NULL, NULL);
+              NULL, NULL, ITTI_TRANSPORT_ZMQ);
 
     amf_config_init(&amf_config);
     amf_config.use_stateless = true;
@@ -68,7 +68,7 @@ class NgapStateConverterTest : public testing::Test {
   // This Function mocks NGAP task Setup.
   void PseudoNgapSetup() {
     itti_init(TASK_MAX, THREAD_MAX, MESSAGES_ID_MAX, tasks_info, messages_info,
-              NULL, NULL);
+              NULL, NULL, ITTI_TRANSPORT_ZMQ);
 
     amf_config_init(&amf_config);
     amf_config.use_stateless = true;
@@ -0,0 +1,306 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Replays a mass attach against a fake switch: num_tunnels GTP tunnels are
+// added in bursts of burst_size, as the SGW does after an eNB restart, and the
+// fake switch counts the flow mods it reads. Reports the time from the first
+// tunnel of a burst to the last flow of the burst, the flows per second and
+// the flows per read of the switch, with the external events batched or
+// written one flow mod at a time.
+// Usage: bench_openflow_controller [num_tunnels] [burst_size] [port]
+
+#include <arpa/inet.h>
+#include <inttypes.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "lte/gateway/c/core/oai/lib/openflow/controller/ControllerEvents.hpp"
+#include "lte/gateway/c/core/oai/lib/openflow/controller/GTPApplication.hpp"
+#include "lte/gateway/c/core/oai/lib/openflow/controller/OpenflowController.hpp"
+
+using namespace fluid_msg;
+using namespace openflow;
+
+#define OF_HEADER_LEN 8
+#define FEATURES_REPLY_LEN 32
+#define BENCH_GTP_PORT 32768
+#define BENCH_MTR_PORT 15577
+#define SETTLE_MSEC 500
+
+// Writes each flow mod on its own, as before the external events were batched
+class UnbatchedMessenger : public DefaultMessenger {
+ public:
+  void begin_batch(fluid_base::OFConnection* ofconn) const {}
+};
+
+/**
+ * Fake switch completing the OpenFlow handshake and counting the flow mods
+ */
+class FakeSwitch {
+ public:
+  FakeSwitch() : fd_(-1), flow_mods_(0), reads_(0), running_(true) {}
+
+  bool connect_to(int port) {
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    for (int i = 0; i < 100; i++) {
+      fd_ = socket(AF_INET, SOCK_STREAM, 0);
+      if (connect(fd_, (struct sockaddr*)&addr, sizeof(addr)) == 0) {
+        int one = 1;
+        setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        send_msg(of13::OFPT_HELLO, 0, nullptr, 0);
+        thread_ = std::thread(&FakeSwitch::run, this);
+        return true;
+      }
+      close(fd_);
+      usleep(10000);
+    }
+    fd_ = -1;
+    return false;
+  }
+
+  void stop() {
+    running_ = false;
+    shutdown(fd_, SHUT_RDWR);
+    thread_.join();
+    close(fd_);
+  }
+
+  uint64_t flow_mods() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return flow_mods_;
+  }
+
+  uint64_t reads() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return reads_;
+  }
+
+  // Waits until the switch has read count flow mods
+  bool wait_flow_mods(uint64_t count) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return cond_.wait_for(lock, std::chrono::seconds(10),
+                          [this, count] { return flow_mods_ >= count; });
+  }
+
+  // Waits until no flow mod has been read for SETTLE_MSEC
+  void wait_idle() {
+    uint64_t count;
+    do {
+      count = flow_mods();
+      usleep(SETTLE_MSEC * 1000);
+    } while (flow_mods() != count);
+  }
+
+ private:
+  int fd_;
+  std::thread thread_;
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  uint64_t flow_mods_;
+  uint64_t reads_;
+  std::atomic<bool> running_;
+
+  void send_msg(uint8_t type, uint32_t xid, const uint8_t* body,
+                size_t body_len) {
+    std::vector<uint8_t> msg(OF_HEADER_LEN + body_len);
+    msg[0] = OpenflowController::OF_13_VERSION;
+    msg[1] = type;
+    uint16_t len = htons(msg.size());
+    memcpy(&msg[2], &len, sizeof(len));
+    memcpy(&msg[4], &xid, sizeof(xid));
+    if (body_len) {
+      memcpy(&msg[OF_HEADER_LEN], body, body_len);
+    }
+    send(fd_, msg.data(), msg.size(), MSG_NOSIGNAL);
+  }
+
+  void handle_msg(const uint8_t* msg, size_t len, uint64_t* flow_mods) {
+    uint32_t xid;
+    memcpy(&xid, msg + 4, sizeof(xid));
+    switch (msg[1]) {
+      case of13::OFPT_ECHO_REQUEST:
+        send_msg(of13::OFPT_ECHO_REPLY, xid, msg + OF_HEADER_LEN,
+                 len - OF_HEADER_LEN);
+        break;
+      case of13::OFPT_FEATURES_REQUEST: {
+        uint8_t features[FEATURES_REPLY_LEN - OF_HEADER_LEN] = {0};
+        // Datapath ID, the number of buffers and tables
+        features[7] = 1;
+        features[12] = 254;
+        send_msg(of13::OFPT_FEATURES_REPLY, xid, features, sizeof(features));
+        break;
+      }
+      case of13::OFPT_FLOW_MOD:
+        (*flow_mods)++;
+        break;
+      default:
+        break;
+    }
+  }
+
+  void run() {
+    std::vector<uint8_t> buffer;
+    uint8_t data[65536];
+    while (running_) {
+      ssize_t rc = recv(fd_, data, sizeof(data), 0);
+      if (rc <= 0) {
+        break;
+      }
+      buffer.insert(buffer.end(), data, data + rc);
+      uint64_t flow_mods = 0;
+      size_t offset = 0;
+      while (buffer.size() - offset >= OF_HEADER_LEN) {
+        uint16_t len;
+        memcpy(&len, &buffer[offset + 2], sizeof(len));
+        len = ntohs(len);
+        if (len < OF_HEADER_LEN || buffer.size() - offset < len) {
+          break;
+        }
+        handle_msg(&buffer[offset], len, &flow_mods);
+        offset += len;
+      }
+      buffer.erase(buffer.begin(), buffer.begin() + offset);
+      std::lock_guard<std::mutex> lock(mutex_);
+      flow_mods_ += flow_mods;
+      reads_++;
+      cond_.notify_all();
+    }
+  }
+};
+
+static OpenflowController* bench_ctrl;
+
+static void* dispatch_callback(std::shared_ptr<void> data) {
+  auto ev = std::static_pointer_cast<ExternalEvent>(data);
+  bench_ctrl->dispatch_event(*ev);
+  return NULL;
+}
+
+static void add_tunnel(uint32_t i) {
+  struct in_addr ue_ip;
+  ue_ip.s_addr = htonl(0xc0a80000 + i);
+  struct in_addr enb_ip;
+  enb_ip.s_addr = htonl(0x0a000001 + i % 16);
+  char imsi[16];
+  snprintf(imsi, sizeof(imsi), "00101%010u", i);
+  auto ev = std::make_shared<AddGTPTunnelEvent>(ue_ip, nullptr, 0, enb_ip,
+                                                nullptr, i, i, imsi, 0);
+  bench_ctrl->inject_external_event(ev, dispatch_callback);
+}
+
+static void run(bool batched, int num_tunnels, int burst_size, int port) {
+  std::shared_ptr<OpenflowMessenger> messenger;
+  if (batched) {
+    messenger = std::make_shared<DefaultMessenger>();
+  } else {
+    messenger = std::make_shared<UnbatchedMessenger>();
+  }
+  OpenflowController ctrl("127.0.0.1", port, 1, false, messenger);
+  bench_ctrl = &ctrl;
+  GTPApplication gtp_app("00:00:00:00:00:01", BENCH_GTP_PORT, BENCH_MTR_PORT,
+                         0, 0, of13::OFPP_LOCAL);
+  ctrl.register_for_event(&gtp_app, EVENT_ADD_GTP_TUNNEL);
+  ctrl.start();
+
+  FakeSwitch fake_switch;
+  if (!fake_switch.connect_to(port)) {
+    fprintf(stderr, "Could not connect the fake switch on port %d\n", port);
+    exit(1);
+  }
+  while (ctrl.get_latest_of_connection() == nullptr) {
+    usleep(1000);
+  }
+  fake_switch.wait_idle();
+
+  // The flows of one tunnel depend on the GTP application
+  uint64_t base = fake_switch.flow_mods();
+  add_tunnel(0);
+  fake_switch.wait_flow_mods(base + 1);
+  fake_switch.wait_idle();
+  uint64_t flows_per_tunnel = fake_switch.flow_mods() - base;
+
+  base = fake_switch.flow_mods();
+  uint64_t base_reads = fake_switch.reads();
+  std::vector<double> latencies_ms;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 1; i <= num_tunnels; i += burst_size) {
+    int burst = std::min(burst_size, num_tunnels - i + 1);
+    auto burst_start = std::chrono::steady_clock::now();
+    for (int j = 0; j < burst; j++) {
+      add_tunnel(i + j);
+    }
+    uint64_t tunnels = i + burst - 1;
+    if (!fake_switch.wait_flow_mods(base + tunnels * flows_per_tunnel)) {
+      fprintf(stderr, "Timed out waiting for the flows\n");
+      exit(1);
+    }
+    latencies_ms.push_back(std::chrono::duration<double, std::milli>(
+                               std::chrono::steady_clock::now() - burst_start)
+                               .count());
+  }
+  double elapsed_s = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+  uint64_t flows = fake_switch.flow_mods() - base;
+  uint64_t reads = fake_switch.reads() - base_reads;
+
+  std::sort(latencies_ms.begin(), latencies_ms.end());
+  double sum = 0;
+  for (double latency : latencies_ms) {
+    sum += latency;
+  }
+  printf("%-9s %10" PRIu64 " %12.2f %12.2f %12.0f %12.1f\n",
+         batched ? "batched" : "unbatched", flows, sum / latencies_ms.size(),
+         latencies_ms[latencies_ms.size() * 99 / 100], flows / elapsed_s,
+         reads ? (double)flows / reads : 0.0);
+
+  fake_switch.stop();
+  ctrl.stop();
+}
+
+int main(int argc, char** argv) {
+  int num_tunnels = argc > 1 ? atoi(argv[1]) : 20000;
+  int burst_size = argc > 2 ? atoi(argv[2]) : 1000;
+  int port = argc > 3 ? atoi(argv[3]) : 6699;
+  if (num_tunnels <= 0 || burst_size <= 0) {
+    fprintf(stderr,
+            "Usage: bench_openflow_controller [num_tunnels] [burst_size] "
+            "[port]\n");
+    return 1;
+  }
+
+  printf("%d tunnels in bursts of %d\n", num_tunnels, burst_size);
+  printf("%-9s %10s %12s %12s %12s %12s\n", "mode", "flows", "burst_ms",
+         "p99_burst_ms", "flows/s", "flows/read");
+  run(false, num_tunnels, burst_size, port);
+  run(true, num_tunnels, burst_size, port + 1);
+  return 0;
+}
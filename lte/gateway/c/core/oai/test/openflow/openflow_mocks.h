@@ -47,4 +47,6 @@ class MockMessenger : public OpenflowMessenger {
 
   MOCK_CONST_METHOD2(send_of_msg, void(fluid_msg::OFMsg& of_msg,
                                        fluid_base::OFConnection* ofconn));
+  MOCK_CONST_METHOD1(begin_batch, void(fluid_base::OFConnection* ofconn));
+  MOCK_CONST_METHOD1(flush_batch, void(fluid_base::OFConnection* ofconn));
 };
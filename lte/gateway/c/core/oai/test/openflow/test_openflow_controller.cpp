@@ -108,4 +108,84 @@ TEST_F(ControllerTest, TestMultipleApplications) {
   default_message_callback(OFPT_PACKET_IN_TYPE);
   default_connection_callback(OFConnection::EVENT_CLOSED);
 }
+
+/**
+ * Controller exposing the queue of the external events, which are otherwise
+ * dispatched from the event loop of the switch connection
+ */
+class QueueingController : public OpenflowController {
+ public:
+  QueueingController(std::shared_ptr<OpenflowMessenger> messenger)
+      : OpenflowController("127.0.0.1", 6666, 2, false, messenger) {}
+
+  using OpenflowController::queue_external_event;
+};
+
+static QueueingController* queueing_controller;
+
+static void* dispatch_callback(std::shared_ptr<void> data) {
+  auto ev = std::static_pointer_cast<ExternalEvent>(data);
+  queueing_controller->dispatch_event(*ev);
+  return NULL;
+}
+
+// Test that the external events injected before the event loop handles them
+// are dispatched in order, in one batch of messages
+TEST(ExternalEventsTest, TestBatchedDispatch) {
+  auto messenger = std::make_shared<MockMessenger>();
+  QueueingController controller(messenger);
+  queueing_controller = &controller;
+  MockApplication add_app, del_app;
+  controller.register_for_event(&add_app, EVENT_ADD_GTP_TUNNEL);
+  controller.register_for_event(&del_app, EVENT_DELETE_GTP_TUNNEL);
+  {
+    InSequence dummy;
+    EXPECT_CALL(*messenger, begin_batch(_)).Times(1);
+    EXPECT_CALL(add_app, event_callback(_, _)).Times(2);
+    EXPECT_CALL(del_app, event_callback(_, _)).Times(1);
+    EXPECT_CALL(*messenger, flush_batch(_)).Times(1);
+  }
+
+  // Only the first event schedules the dispatch
+  uint64_t generation;
+  EXPECT_TRUE(controller.queue_external_event(
+      std::make_shared<ExternalEvent>(EVENT_ADD_GTP_TUNNEL), dispatch_callback,
+      &generation));
+  uint64_t unused;
+  EXPECT_FALSE(controller.queue_external_event(
+      std::make_shared<ExternalEvent>(EVENT_ADD_GTP_TUNNEL), dispatch_callback,
+      &unused));
+  EXPECT_FALSE(controller.queue_external_event(
+      std::make_shared<ExternalEvent>(EVENT_DELETE_GTP_TUNNEL),
+      dispatch_callback, &unused));
+  controller.dispatch_external_events(generation);
+  // Nothing left to send
+  controller.dispatch_external_events(generation);
+  testing::Mock::VerifyAndClearExpectations(messenger.get());
+  testing::Mock::VerifyAndClearExpectations(&add_app);
+  testing::Mock::VerifyAndClearExpectations(&del_app);
+
+  // The events dropped with a lost connection are not dispatched
+  EXPECT_CALL(add_app, event_callback(_, _)).Times(0);
+  EXPECT_TRUE(controller.queue_external_event(
+      std::make_shared<ExternalEvent>(EVENT_ADD_GTP_TUNNEL), dispatch_callback,
+      &generation));
+  controller.connection_callback(NULL, OFConnection::EVENT_CLOSED);
+  controller.dispatch_external_events(generation);
+
+  // The dispatch scheduled for the lost connection does not handle the events
+  // of the next one, which are handled by their own dispatch
+  uint64_t next_generation;
+  EXPECT_TRUE(controller.queue_external_event(
+      std::make_shared<ExternalEvent>(EVENT_DELETE_GTP_TUNNEL),
+      dispatch_callback, &next_generation));
+  EXPECT_NE(next_generation, generation);
+  EXPECT_CALL(del_app, event_callback(_, _)).Times(0);
+  controller.dispatch_external_events(generation);
+  testing::Mock::VerifyAndClearExpectations(&del_app);
+  EXPECT_CALL(*messenger, begin_batch(_)).Times(1);
+  EXPECT_CALL(del_app, event_callback(_, _)).Times(1);
+  EXPECT_CALL(*messenger, flush_batch(_)).Times(1);
+  controller.dispatch_external_events(next_generation);
+}
 }  // namespace
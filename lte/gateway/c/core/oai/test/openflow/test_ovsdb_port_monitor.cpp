@@ -0,0 +1,168 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <gtest/gtest.h>
+#include <string>
+
+#include <nlohmann/json.hpp>
+
+#include "lte/gateway/c/core/oai/lib/openflow/controller/OvsdbPortMonitor.hpp"
+
+namespace openflow {
+
+#define WAIT_MSEC 2000
+
+// Stands in for ovsdb-server, on a unix socket accepting one client at a time
+class OvsdbPortMonitorTest : public ::testing::Test {
+ protected:
+  virtual void SetUp() {
+    snprintf(socket_path, sizeof(socket_path), "/tmp/test_ovsdb_%d.sock",
+             getpid());
+    unlink(socket_path);
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, socket_path, sizeof(addr.sun_path) - 1);
+    listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    ASSERT_EQ(bind(listen_fd, (struct sockaddr*)&addr, sizeof(addr)), 0);
+    ASSERT_EQ(listen(listen_fd, 1), 0);
+    client_fd = -1;
+    monitor = new OvsdbPortMonitor(socket_path);
+    monitor->start();
+  }
+
+  virtual void TearDown() {
+    delete monitor;
+    if (client_fd != -1) {
+      close(client_fd);
+    }
+    close(listen_fd);
+    unlink(socket_path);
+  }
+
+  // Accepts the monitor connection and returns the ID of its request
+  nlohmann::json accept_monitor() {
+    client_fd = accept(listen_fd, nullptr, nullptr);
+    nlohmann::json request = receive();
+    EXPECT_EQ(request["method"], "monitor");
+    EXPECT_EQ(request["params"][0], "Open_vSwitch");
+    EXPECT_EQ(request["params"][2]["Interface"]["columns"],
+              nlohmann::json({"name", "ofport"}));
+    return request["id"];
+  }
+
+  nlohmann::json receive() {
+    char buf[4096];
+    ssize_t len = recv(client_fd, buf, sizeof(buf), 0);
+    EXPECT_GT(len, 0);
+    return nlohmann::json::parse(std::string(buf, len > 0 ? len : 0), nullptr,
+                                 false);
+  }
+
+  void send_data(const std::string& data) {
+    ASSERT_EQ(send(client_fd, data.data(), data.size(), 0),
+              (ssize_t)data.size());
+  }
+
+  void send_update(const nlohmann::json& rows) {
+    nlohmann::json update = {{"id", nullptr},
+                             {"method", "update"},
+                             {"params", {nullptr, {{"Interface", rows}}}}};
+    send_data(update.dump());
+  }
+
+  static nlohmann::json row(const std::string& name, int ofport) {
+    return {{"name", name}, {"ofport", ofport}};
+  }
+
+  char socket_path[64];
+  int listen_fd;
+  int client_fd;
+  OvsdbPortMonitor* monitor;
+};
+
+TEST_F(OvsdbPortMonitorTest, TestInitialRowsAndUpdates) {
+  nlohmann::json id = accept_monitor();
+  nlohmann::json reply = {
+      {"id", id},
+      {"result",
+       {{"Interface",
+         {{"uuid-1", {{"new", row("g_a01a8c0", 5)}}},
+          {"uuid-2", {{"new", row("gtp0", 32768)}}}}}}},
+      {"error", nullptr}};
+  send_data(reply.dump());
+  EXPECT_EQ(monitor->get_ofport("g_a01a8c0", WAIT_MSEC), 5u);
+  EXPECT_EQ(monitor->get_ofport("gtp0", WAIT_MSEC), 32768u);
+  EXPECT_EQ(monitor->get_ofport("g_b01a8c0", 0), 0u);
+
+  // Port numbers are assigned after the interface is added to the bridge
+  nlohmann::json unassigned = {{"name", "g_b01a8c0"},
+                               {"ofport", {"set", nlohmann::json::array()}}};
+  send_update({{"uuid-3", {{"new", unassigned}}}});
+  send_update({{"uuid-3",
+                {{"old", {{"ofport", {"set", nlohmann::json::array()}}}},
+                 {"new", row("g_b01a8c0", 7)}}}});
+  EXPECT_EQ(monitor->get_ofport("g_b01a8c0", WAIT_MSEC), 7u);
+
+  send_update({{"uuid-1", {{"old", row("g_a01a8c0", 5)}}}});
+  for (int i = 0; i < WAIT_MSEC && monitor->get_ofport("g_a01a8c0", 0); i++) {
+    usleep(1000);
+  }
+  EXPECT_EQ(monitor->get_ofport("g_a01a8c0", 0), 0u);
+  EXPECT_EQ(monitor->get_ofport("g_b01a8c0", 0), 7u);
+}
+
+TEST_F(OvsdbPortMonitorTest, TestSplitMessagesAndEcho) {
+  nlohmann::json id = accept_monitor();
+  nlohmann::json reply = {
+      {"id", id},
+      {"result", {{"Interface", {{"uuid-1", {{"new", row("g_{\"}", 3)}}}}}}},
+      {"error", nullptr}};
+  // Messages are not delimited and may be split over several reads
+  std::string data = reply.dump() +
+                     R"({"id":"echo","method":"echo","params":[]})";
+  send_data(data.substr(0, 20));
+  usleep(10000);
+  send_data(data.substr(20));
+  EXPECT_EQ(monitor->get_ofport("g_{\"}", WAIT_MSEC), 3u);
+
+  nlohmann::json echo_reply = receive();
+  EXPECT_EQ(echo_reply["id"], "echo");
+  EXPECT_EQ(echo_reply["result"], nlohmann::json::array());
+}
+
+TEST_F(OvsdbPortMonitorTest, TestReconnect) {
+  nlohmann::json id = accept_monitor();
+  nlohmann::json reply = {
+      {"id", id},
+      {"result", {{"Interface", {{"uuid-1", {{"new", row("g_1", 3)}}}}}}},
+      {"error", nullptr}};
+  send_data(reply.dump());
+  EXPECT_EQ(monitor->get_ofport("g_1", WAIT_MSEC), 3u);
+
+  // The rows of the new connection replace the ones of the lost connection
+  close(client_fd);
+  id = accept_monitor();
+  reply["id"] = id;
+  reply["result"]["Interface"] = {{"uuid-2", {{"new", row("g_2", 4)}}}};
+  send_data(reply.dump());
+  EXPECT_EQ(monitor->get_ofport("g_2", WAIT_MSEC), 4u);
+  EXPECT_EQ(monitor->get_ofport("g_1", 0), 0u);
+}
+
+}  // namespace openflow
@@ -0,0 +1,124 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Compares the per message cost of the eNB association access of the S1AP
+// handlers with num_ues UEs on the eNB: the association copied out of the
+// task state and copied back as before, and modified in place through
+// s1ap_state_get_enb. The cost of serializing the task state, paid once per
+// message when it is written to db, is printed for reference.
+// Usage: bench_s1ap_enb_access [num_messages] [num_ues...]
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <string>
+#include <vector>
+
+#include "lte/gateway/c/core/oai/include/s1ap_state.hpp"
+#include "lte/gateway/c/core/oai/tasks/s1ap/s1ap_state_manager.hpp"
+
+using magma::lte::create_s1ap_state;
+using magma::lte::free_s1ap_state;
+using magma::lte::s1ap_state_get_enb;
+using magma::lte::s1ap_state_mark_enb_dirty;
+using magma::lte::oai::EnbDescription;
+using magma::lte::oai::S1apState;
+
+#define BENCH_ASSOC_ID 1
+
+typedef struct {
+  double copy_us;
+  double in_place_us;
+  double serialize_us;
+} result_t;
+
+static int64_t now_ns() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// Same update as a handler allocating the SCTP stream of a new UE
+static void next_sctp_stream(EnbDescription* enb) {
+  enb->set_next_sctp_stream(enb->next_sctp_stream() + 1);
+  if (enb->next_sctp_stream() >= enb->instreams()) {
+    enb->set_next_sctp_stream(1);
+  }
+}
+
+static result_t run(int num_messages, int num_ues) {
+  S1apState* state = create_s1ap_state();
+  EnbDescription enb;
+  enb.set_sctp_assoc_id(BENCH_ASSOC_ID);
+  enb.set_enb_id(0xe000);
+  enb.set_instreams(32);
+  enb.set_next_sctp_stream(1);
+  enb.set_nb_ue_associated(num_ues);
+  for (int ue = 0; ue < num_ues; ue++) {
+    (*enb.mutable_ue_id_map())[ue + 1] = ((uint64_t)ue << 32) | (ue + 1);
+  }
+  (*state->mutable_enbs())[BENCH_ASSOC_ID] = enb;
+  result_t result;
+
+  int64_t start_ns = now_ns();
+  for (int i = 0; i < num_messages; i++) {
+    EnbDescription enb_copy = state->enbs().at(BENCH_ASSOC_ID);
+    next_sctp_stream(&enb_copy);
+    (*state->mutable_enbs())[BENCH_ASSOC_ID] = enb_copy;
+  }
+  result.copy_us = (now_ns() - start_ns) / 1e3 / num_messages;
+
+  start_ns = now_ns();
+  for (int i = 0; i < num_messages; i++) {
+    EnbDescription* enb_ref = s1ap_state_get_enb(state, BENCH_ASSOC_ID);
+    next_sctp_stream(enb_ref);
+    s1ap_state_mark_enb_dirty(enb_ref);
+  }
+  result.in_place_us = (now_ns() - start_ns) / 1e3 / num_messages;
+
+  std::string serialized;
+  start_ns = now_ns();
+  for (int i = 0; i < num_messages; i++) {
+    state->SerializeToString(&serialized);
+  }
+  result.serialize_us = (now_ns() - start_ns) / 1e3 / num_messages;
+
+  free_s1ap_state(state);
+  return result;
+}
+
+int main(int argc, char** argv) {
+  int num_messages = argc > 1 ? atoi(argv[1]) : 10000;
+  std::vector<int> num_ues_runs;
+  for (int i = 2; i < argc; i++) {
+    num_ues_runs.push_back(atoi(argv[i]));
+  }
+  if (num_ues_runs.empty()) {
+    num_ues_runs = {0, 100, 1000, 10000};
+  }
+  if (num_messages <= 0) {
+    fprintf(stderr,
+            "Usage: bench_s1ap_enb_access [num_messages] [num_ues...]\n");
+    return 1;
+  }
+
+  printf("%8s %12s %12s %14s\n", "ues", "copy_us", "in_place_us",
+         "serialize_us");
+  for (int num_ues : num_ues_runs) {
+    result_t result = run(num_messages, num_ues);
+    printf("%8d %12.3f %12.3f %14.3f\n", num_ues, result.copy_us,
+           result.in_place_us, result.serialize_us);
+  }
+  return 0;
+}
@@ -67,12 +67,9 @@ TEST(test_s1ap_handle_new_association, shutdown) {
   EXPECT_EQ(s1ap_handle_new_association(s, &p), RETURNok);
 
   // set enb to shutdown state
-  EnbDescription enbd;
-  proto_map_uint32_enb_description_t enb_map;
-  enb_map.map = s->mutable_enbs();
-  EXPECT_EQ(enb_map.get(p.assoc_id, &enbd), magma::PROTO_MAP_OK);
-  enbd.set_s1_enb_state(oai::S1AP_SHUTDOWN);
-  s1ap_state_update_enb_map(s, p.assoc_id, &enbd);
+  EnbDescription* enbd = s1ap_state_get_enb(s, p.assoc_id);
+  ASSERT_NE(enbd, nullptr);
+  enbd->set_s1_enb_state(oai::S1AP_SHUTDOWN);
 
   // expect error
   EXPECT_EQ(s1ap_handle_new_association(s, &p), RETURNerror);
@@ -86,12 +83,9 @@ TEST(test_s1ap_handle_new_association, resetting) {
   EXPECT_EQ(s1ap_handle_new_association(s, &p), RETURNok);
 
   // set enb to shutdown state
-  EnbDescription enbd;
-  proto_map_uint32_enb_description_t enb_map;
-  enb_map.map = s->mutable_enbs();
-  EXPECT_EQ(enb_map.get(p.assoc_id, &enbd), magma::PROTO_MAP_OK);
-  enbd.set_s1_enb_state(oai::S1AP_RESETING);
-  s1ap_state_update_enb_map(s, p.assoc_id, &enbd);
+  EnbDescription* enbd = s1ap_state_get_enb(s, p.assoc_id);
+  ASSERT_NE(enbd, nullptr);
+  enbd->set_s1_enb_state(oai::S1AP_RESETING);
 
   // expect error
   EXPECT_EQ(s1ap_handle_new_association(s, &p), RETURNerror);
@@ -105,18 +99,15 @@ TEST(test_s1ap_handle_new_association, reassociate) {
   EXPECT_EQ(s1ap_handle_new_association(s, &p), RETURNok);
 
   // make sure first association worked
-  EnbDescription enbd;
-  proto_map_uint32_enb_description_t enb_map;
-  enb_map.map = s->mutable_enbs();
-  EXPECT_EQ(enb_map.get(p.assoc_id, &enbd), magma::PROTO_MAP_OK);
-  EXPECT_EQ(enbd.sctp_assoc_id(), 1);
-  EXPECT_EQ(enbd.instreams(), 0);
-  EXPECT_EQ(enbd.outstreams(), 0);
-  EXPECT_STREQ(enbd.ran_cp_ipaddr().c_str(), "");
-  EXPECT_EQ(enbd.ran_cp_ipaddr_sz(), 0);
+  EnbDescription* enbd = s1ap_state_get_enb(s, p.assoc_id);
+  ASSERT_NE(enbd, nullptr);
+  EXPECT_EQ(enbd->sctp_assoc_id(), 1);
+  EXPECT_EQ(enbd->instreams(), 0);
+  EXPECT_EQ(enbd->outstreams(), 0);
+  EXPECT_STREQ(enbd->ran_cp_ipaddr().c_str(), "");
+  EXPECT_EQ(enbd->ran_cp_ipaddr_sz(), 0);
   // should be OK if enb status is READY
-  enbd.set_s1_enb_state(oai::S1AP_READY);
-  s1ap_state_update_enb_map(s, p.assoc_id, &enbd);
+  enbd->set_s1_enb_state(oai::S1AP_READY);
 
   // new assoc with same id should overwrite
   bstring ran_cp_ipaddr = bfromcstr("\xc0\xa8\x3c\x8d");
@@ -127,14 +118,15 @@ TEST(test_s1ap_handle_new_association, reassociate) {
       .ran_cp_ipaddr = ran_cp_ipaddr,
   };
   EXPECT_EQ(s1ap_handle_new_association(s, &p2), RETURNok);
-  EXPECT_EQ(enb_map.get(p2.assoc_id, &enbd), magma::PROTO_MAP_OK);
+  enbd = s1ap_state_get_enb(s, p2.assoc_id);
+  ASSERT_NE(enbd, nullptr);
 
-  EXPECT_EQ(enbd.sctp_assoc_id(), 1);
-  EXPECT_EQ(enbd.instreams(), 10);
-  EXPECT_EQ(enbd.outstreams(), 20);
-  EXPECT_STREQ(enbd.ran_cp_ipaddr().c_str(), "\300\250<\215");
-  EXPECT_EQ(enbd.ran_cp_ipaddr_sz(), 4);
-  EXPECT_EQ(enbd.s1_enb_state(), oai::S1AP_INIT);
+  EXPECT_EQ(enbd->sctp_assoc_id(), 1);
+  EXPECT_EQ(enbd->instreams(), 10);
+  EXPECT_EQ(enbd->outstreams(), 20);
+  EXPECT_STREQ(enbd->ran_cp_ipaddr().c_str(), "\300\250<\215");
+  EXPECT_EQ(enbd->ran_cp_ipaddr_sz(), 4);
+  EXPECT_EQ(enbd->s1_enb_state(), oai::S1AP_INIT);
 
   bdestroy(ran_cp_ipaddr);
   free_s1ap_state(s);
@@ -170,5 +162,44 @@ TEST(test_s1ap_handle_new_association, clean_stale_association) {
   free_s1ap_state(s);
 }
 
+class S1apEnbInPlaceTest : public ::testing::Test {
+ protected:
+  // The dirty flag lives in the state manager singleton, which is shared
+  // with the other tests of the binary
+  virtual void SetUp() {
+    S1apStateManager::getInstance().clear_enb_state_dirty();
+  }
+};
+
+TEST_F(S1apEnbInPlaceTest, get_enb_in_place) {
+  oai::S1apState* s = create_s1ap_state();
+  sctp_new_peer_t p = {.assoc_id = 1};
+  EXPECT_FALSE(s1ap_state_is_dirty());
+  EXPECT_EQ(s1ap_handle_new_association(s, &p), RETURNok);
+  // the handler marks the association it created for the next state write
+  EXPECT_TRUE(s1ap_state_is_dirty());
+
+  EXPECT_EQ(s1ap_state_get_enb(s, 2), nullptr);
+  EnbDescription* enbd = s1ap_state_get_enb(s, p.assoc_id);
+  ASSERT_NE(enbd, nullptr);
+
+  // edits through the returned pointer are made on the state itself, and
+  // only reach the next state write once marked
+  S1apStateManager::getInstance().clear_enb_state_dirty();
+  ASSERT_FALSE(s1ap_state_is_dirty());
+  enbd->set_enb_id(0xe000);
+  enbd->set_s1_enb_state(oai::S1AP_READY);
+  EXPECT_EQ(s->enbs().at(p.assoc_id).enb_id(), 0xe000);
+  EXPECT_EQ(s->enbs().at(p.assoc_id).s1_enb_state(), oai::S1AP_READY);
+  EXPECT_FALSE(s1ap_state_is_dirty());
+  s1ap_state_mark_enb_dirty(enbd);
+  EXPECT_TRUE(s1ap_state_is_dirty());
+
+  EXPECT_EQ(s1ap_state_get_enb_by_enb_id(s, 0xe000), enbd);
+  EXPECT_EQ(s1ap_state_get_enb_by_enb_id(s, 0xe001), nullptr);
+
+  free_s1ap_state(s);
+}
+
 }  // namespace lte
 }  // namespace magma
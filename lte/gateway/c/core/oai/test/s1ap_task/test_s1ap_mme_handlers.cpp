@@ -58,7 +58,7 @@ class S1apMmeHandlersTest : public ::testing::Test {
     sctp_handler = std::make_shared<MockSctpHandler>();
 
     itti_init(TASK_MAX, THREAD_MAX, MESSAGES_ID_MAX, tasks_info, messages_info,
-              NULL, NULL);
+              NULL, NULL, ITTI_TRANSPORT_ZMQ);
 
     // initialize mme config
     mme_config_init(&mme_config);
@@ -135,12 +135,9 @@ TEST_F(S1apMmeHandlersTest, HandleS1SetupRequestFailureHss) {
 TEST_F(S1apMmeHandlersTest, HandleS1SetupRequestFailureReseting) {
   EXPECT_CALL(*sctp_handler, sctpd_send_dl()).Times(1);
 
-  oai::EnbDescription enb_associated;
-  proto_map_uint32_enb_description_t enb_map;
-  enb_map.map = state->mutable_enbs();
-  enb_map.get(assoc_id, &enb_associated);
-  enb_associated.set_s1_enb_state(magma::lte::oai::S1AP_RESETING);
-  s1ap_state_update_enb_map(state, assoc_id, &enb_associated);
+  oai::EnbDescription* enb_associated = s1ap_state_get_enb(state, assoc_id);
+  ASSERT_NE(enb_associated, nullptr);
+  enb_associated->set_s1_enb_state(magma::lte::oai::S1AP_RESETING);
 
   S1ap_S1AP_PDU_t pdu_s1;
   memset(&pdu_s1, 0, sizeof(pdu_s1));
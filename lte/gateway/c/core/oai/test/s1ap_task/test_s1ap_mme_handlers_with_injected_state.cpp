@@ -56,7 +56,7 @@ class S1apMmeHandlersWithInjectedStatesTest : public ::testing::Test {
     sctp_handler = std::make_shared<MockSctpHandler>();
 
     itti_init(TASK_MAX, THREAD_MAX, MESSAGES_ID_MAX, tasks_info, messages_info,
-              NULL, NULL);
+              NULL, NULL, ITTI_TRANSPORT_ZMQ);
 
     // initialize mme config
     mme_config_init(&mme_config);
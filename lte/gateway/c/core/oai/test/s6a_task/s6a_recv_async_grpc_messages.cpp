@@ -49,7 +49,7 @@ void S6aMessagesTest::SetUp() {
   async_service_handler =
       std::make_shared<magma::S6aProxyAsyncResponderHandler>();
   itti_init(TASK_MAX, THREAD_MAX, MESSAGES_ID_MAX, tasks_info, messages_info,
-            NULL, NULL);
+            NULL, NULL, ITTI_TRANSPORT_ZMQ);
   task_id_t task_id_list[2] = {TASK_S6A, TASK_MME_APP};
   init_task_context(TASK_MAIN, task_id_list, 2, handle_message,
                     &task_zmq_ctx_main_s6a);
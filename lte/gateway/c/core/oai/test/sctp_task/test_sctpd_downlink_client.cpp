@@ -0,0 +1,156 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <grpcpp/grpcpp.h>
+#include <gtest/gtest.h>
+#include <lte/protos/sctpd.grpc.pb.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include "lte/gateway/c/core/oai/include/mme_config.h"
+}
+
+#include "lte/gateway/c/core/oai/tasks/sctp/sctpd_downlink_client.hpp"
+
+using grpc::Server;
+using grpc::ServerBuilder;
+using grpc::ServerContext;
+using grpc::ServerReaderWriter;
+using grpc::Status;
+
+struct mme_config_s mme_config;
+
+namespace magma {
+namespace lte {
+
+// Records downlink packets in the order sctpd would send them to the eNBs
+class FakeSctpdDownlinkServer final : public SctpdDownlink::Service {
+ public:
+  Status SendDl(ServerContext* context, const SendDlReq* req,
+                SendDlRes* res) override {
+    std::lock_guard<std::mutex> lock(mutex);
+    record_locked(*req);
+    unary_calls++;
+    res->set_result(SendDlRes::SEND_DL_OK);
+    return Status::OK;
+  }
+
+  Status SendDlStream(
+      ServerContext* context,
+      ServerReaderWriter<SendDlBatchRes, SendDlBatchReq>* stream) override {
+    SendDlBatchReq batch;
+    SendDlBatchRes ack;
+    while (stream->Read(&batch)) {
+      ack.Clear();
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (failing_streams > 0) {
+          // Lose the batch, as if sctpd restarted before sending it
+          failing_streams--;
+          return Status(grpc::StatusCode::UNAVAILABLE, "sctpd restarting");
+        }
+        for (const auto& msg : batch.msgs()) {
+          record_locked(msg);
+          ack.add_results()->set_result(SendDlRes::SEND_DL_OK);
+        }
+        batches++;
+      }
+      ack.set_seq(batch.seq());
+      stream->Write(ack);
+    }
+    return Status::OK;
+  }
+
+  void record_locked(const SendDlReq& req) {
+    events.push_back(std::to_string(req.assoc_id()) + ":" +
+                     std::to_string(req.stream()) + ":" + req.payload());
+  }
+
+  std::mutex mutex;
+  std::vector<std::string> events;
+  int batches = 0;
+  int unary_calls = 0;
+  // Number of streams failing on their first batch
+  int failing_streams = 0;
+};
+
+class SctpdDownlinkClientTest : public ::testing::Test {
+ protected:
+  virtual void SetUp() {
+    ServerBuilder builder;
+    builder.RegisterService(&_service);
+    _server = builder.BuildAndStart();
+    _client = std::make_unique<SctpdDownlinkClient>(
+        _server->InProcessChannel(grpc::ChannelArguments()), false);
+  }
+
+  virtual void TearDown() {
+    _client.reset();
+    _server->Shutdown();
+  }
+
+  // Queues num_msgs packets, returns them as the server records them
+  std::vector<std::string> queue_msgs(int num_msgs) {
+    std::vector<std::string> expected;
+    for (int i = 0; i < num_msgs; i++) {
+      SendDlReq req;
+      req.set_ppid(18);
+      req.set_assoc_id(i % 4);
+      req.set_stream(i % 3);
+      req.set_payload(std::to_string(i));
+      expected.push_back(std::to_string(req.assoc_id()) + ":" +
+                         std::to_string(req.stream()) + ":" + req.payload());
+      EXPECT_EQ(_client->sendDlStream(req), 0);
+    }
+    return expected;
+  }
+
+  FakeSctpdDownlinkServer _service;
+  std::unique_ptr<Server> _server;
+  std::unique_ptr<SctpdDownlinkClient> _client;
+};
+
+TEST_F(SctpdDownlinkClientTest, test_send_dl_stream_batches_in_order) {
+  const int num_msgs = 1000;
+
+  // Queued before the writer starts, so every batch is full but the last
+  auto expected = queue_msgs(num_msgs);
+  _client->start_stream();
+  _client->flush();
+
+  std::lock_guard<std::mutex> lock(_service.mutex);
+  EXPECT_EQ(_service.events, expected);
+  EXPECT_EQ(_service.batches,
+            (num_msgs + max_dl_batch_size - 1) / max_dl_batch_size);
+  EXPECT_EQ(_service.unary_calls, 0);
+}
+
+TEST_F(SctpdDownlinkClientTest, test_unacked_batches_resent_in_order) {
+  const int num_msgs = 1000;
+
+  _service.failing_streams = 1;
+  auto expected = queue_msgs(num_msgs);
+  _client->start_stream();
+  _client->flush();
+
+  // The batches lost with the first stream are relayed over SendDl, ahead of
+  // the packets still queued
+  std::lock_guard<std::mutex> lock(_service.mutex);
+  EXPECT_EQ(_service.events, expected);
+  EXPECT_GE(_service.unary_calls, max_dl_batch_size);
+}
+
+}  // namespace lte
+}  // namespace magma
@@ -41,7 +41,7 @@ void SgwS8MessagesTest::SetUp() {
   s8_message_receiver = std::make_shared<magma::S8ServiceImpl>();
   sgw_s8_handler = std::make_shared<MockS8Handler>();
   itti_init(TASK_MAX, THREAD_MAX, MESSAGES_ID_MAX, tasks_info, messages_info,
-            NULL, NULL);
+            NULL, NULL, ITTI_TRANSPORT_ZMQ);
   task_id_t task_id_list[2] = {TASK_GRPC_SERVICE, TASK_SGW_S8};
   init_task_context(TASK_MAIN, task_id_list, 2, handle_message_test_s8_grpc,
                     &task_zmq_ctx_main_grpc);
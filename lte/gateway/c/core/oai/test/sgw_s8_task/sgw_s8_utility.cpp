@@ -316,7 +316,7 @@ void SgwS8ConfigAndCreateMock::SetUp() {
   mme_app_handler = std::make_shared<MockMmeAppHandler>();
 
   itti_init(TASK_MAX, THREAD_MAX, MESSAGES_ID_MAX, tasks_info, messages_info,
-            NULL, NULL);
+            NULL, NULL, ITTI_TRANSPORT_ZMQ);
   sgw_s8_config_init();
   task_id_t task_id_list[3] = {TASK_SGW_S8, TASK_MME_APP, TASK_GRPC_SERVICE};
   init_task_context(TASK_MAIN, task_id_list, 3, handle_message_test_sgw_s8,
@@ -102,7 +102,7 @@ class SPGWAppInjectedStateProcedureTest : public ::testing::Test {
     // setup mock MME app task
     mme_app_handler = std::make_shared<MockMmeAppHandler>();
     itti_init(TASK_MAX, THREAD_MAX, MESSAGES_ID_MAX, tasks_info, messages_info,
-              NULL, NULL);
+              NULL, NULL, ITTI_TRANSPORT_ZMQ);
 
     // initialize configs
     mme_config_init(&mme_config);
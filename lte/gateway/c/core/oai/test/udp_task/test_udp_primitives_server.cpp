@@ -0,0 +1,250 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <arpa/inet.h>
+#include <gtest/gtest.h>
+#include <netinet/in.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+
+extern "C" {
+#define CHECK_PROTOTYPE_ONLY
+#include "lte/gateway/c/core/oai/lib/itti/intertask_interface_init.h"
+#undef CHECK_PROTOTYPE_ONLY
+#include "lte/gateway/c/core/oai/common/itti_free_defined_msg.h"
+#include "lte/gateway/c/core/oai/include/udp_primitives_server.h"
+#include "lte/gateway/c/core/oai/lib/itti/intertask_interface.h"
+#include "lte/gateway/c/core/oai/lib/itti/intertask_interface_types.h"
+
+extern task_zmq_ctx_t udp_task_zmq_ctx;
+}
+
+const task_info_t tasks_info[] = {
+    {THREAD_NULL, "TASK_UNKNOWN", "ipc://IPC_TASK_UNKNOWN"},
+#define TASK_DEF(tHREADiD) \
+  {THREAD_##tHREADiD, #tHREADiD, "ipc://IPC_" #tHREADiD},
+#include "lte/gateway/c/core/oai/include/tasks_def.h"
+#undef TASK_DEF
+};
+
+/* Map message id to message information */
+const message_info_t messages_info[] = {
+#define MESSAGE_DEF(iD, sTRUCT, fIELDnAME) {iD, sizeof(sTRUCT), #iD},
+#include "lte/gateway/c/core/oai/include/messages_def.h"
+#undef MESSAGE_DEF
+};
+
+#define UDP_TEST_LOOP_MS 200
+
+struct ReceivedDatagram {
+  std::string payload;
+  uint16_t peer_port;
+  in_addr_t peer_addr;
+};
+
+struct ReceivedMessage {
+  MessagesIds msg_id;
+  uint16_t local_port;
+  std::vector<ReceivedDatagram> datagrams;
+};
+
+task_zmq_ctx_t task_zmq_ctx_s11_udp_test;
+std::vector<ReceivedMessage> received_msgs;
+
+static int handle_s11_message(zloop_t* loop, zsock_t* reader, void* arg) {
+  MessageDef* received_message_p = receive_msg(reader);
+
+  switch (ITTI_MSG_ID(received_message_p)) {
+    case UDP_DATA_IND: {
+      udp_data_ind_t* ind = &received_message_p->ittiMsg.udp_data_ind;
+      received_msgs.push_back(
+          {UDP_DATA_IND,
+           ind->local_port,
+           {{std::string(reinterpret_cast<char*>(ind->msgBuf),
+                         ind->buffer_length),
+             ind->peer_port, ind->sock_addr.addrv4.sin_addr.s_addr}}});
+    } break;
+
+    case UDP_DATA_BATCH_IND: {
+      udp_data_batch_ind_t* batch =
+          &received_message_p->ittiMsg.udp_data_batch_ind;
+      ReceivedMessage received = {UDP_DATA_BATCH_IND, batch->local_port, {}};
+      for (uint32_t i = 0; i < batch->num_datagrams; i++) {
+        udp_datagram_t* datagram = &batch->datagrams[i];
+        received.datagrams.push_back(
+            {std::string(reinterpret_cast<char*>(datagram->buffer),
+                         datagram->buffer_length),
+             datagram->peer_port, datagram->sock_addr.addrv4.sin_addr.s_addr});
+      }
+      received_msgs.push_back(received);
+    } break;
+
+    default: {
+    } break;
+  }
+  itti_free_msg_content(received_message_p);
+  itti_free_msg(received_message_p);
+  return 0;
+}
+
+static int stop_loop(zloop_t* loop, int timer_id, void* arg) { return -1; }
+
+// Runs the loop of the task on the test thread until it is idle
+static void run_loop(task_zmq_ctx_t* task_zmq_ctx) {
+  zloop_timer(task_zmq_ctx->event_loop, UDP_TEST_LOOP_MS, 1, stop_loop, NULL);
+  zloop_start(task_zmq_ctx->event_loop);
+}
+
+class UdpPrimitivesServerTest : public ::testing::Test {
+ protected:
+  virtual void SetUp() {
+    itti_init(TASK_MAX, THREAD_MAX, MESSAGES_ID_MAX, tasks_info, messages_info,
+              NULL, NULL, ITTI_TRANSPORT_RING);
+    received_msgs.clear();
+
+    task_id_t task_id_list[1] = {TASK_UDP};
+    init_task_context(TASK_S11, task_id_list, 1, handle_s11_message,
+                      &task_zmq_ctx_s11_udp_test);
+    // Neither loop runs on its own, messages and datagrams stay queued until
+    // the test runs the loop
+    udp_init_task_context();
+
+    loopback.s_addr = htonl(INADDR_LOOPBACK);
+    peer_sd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    ASSERT_GE(peer_sd, 0);
+    memset(&peer_addr, 0, sizeof(peer_addr));
+    peer_addr.sin_family = AF_INET;
+    peer_addr.sin_addr = loopback;
+    ASSERT_EQ(
+        bind(peer_sd, reinterpret_cast<sockaddr*>(&peer_addr), sizeof(peer_addr)),
+        0);
+    socklen_t len = sizeof(peer_addr);
+    ASSERT_EQ(
+        getsockname(peer_sd, reinterpret_cast<sockaddr*>(&peer_addr), &len), 0);
+  }
+
+  virtual void TearDown() {
+    close(peer_sd);
+    destroy_task_context(&udp_task_zmq_ctx);
+    destroy_task_context(&task_zmq_ctx_s11_udp_test);
+    itti_free_desc_threads();
+  }
+
+  // Each test binds its own port, the sockets of the UDP task stay open
+  void init_udp_socket(uint16_t port) {
+    MessageDef* message_p =
+        DEPRECATEDitti_alloc_new_message_fatal(TASK_S11, UDP_INIT);
+    UDP_INIT(message_p).in_addr = &loopback;
+    UDP_INIT(message_p).port = port;
+    send_msg_to_task(&task_zmq_ctx_s11_udp_test, TASK_UDP, message_p);
+    run_loop(&udp_task_zmq_ctx);
+  }
+
+  void send_to_udp_task(const std::string& payload, uint16_t port) {
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr = loopback;
+    addr.sin_port = htons(port);
+    ASSERT_EQ(sendto(peer_sd, payload.data(), payload.size(), 0,
+                     reinterpret_cast<sockaddr*>(&addr), sizeof(addr)),
+              payload.size());
+  }
+
+  void send_data_req(const std::string& payload, uint16_t port) {
+    MessageDef* message_p =
+        DEPRECATEDitti_alloc_new_message_fatal(TASK_S11, UDP_DATA_REQ);
+    udp_data_req_t* req = &message_p->ittiMsg.udp_data_req;
+    req->buffer = (uint8_t*)payload.data();
+    req->buffer_offset = 0;
+    req->buffer_length = payload.size();
+    req->local_port = port;
+    req->peer_address = reinterpret_cast<sockaddr*>(&peer_addr);
+    req->peer_port = ntohs(peer_addr.sin_port);
+    send_msg_to_task(&task_zmq_ctx_s11_udp_test, TASK_UDP, message_p);
+  }
+
+  void expect_datagram_from_peer(const ReceivedDatagram& datagram,
+                                 const std::string& payload) {
+    EXPECT_EQ(datagram.payload, payload);
+    EXPECT_EQ(datagram.peer_port, ntohs(peer_addr.sin_port));
+    EXPECT_EQ(datagram.peer_addr, peer_addr.sin_addr.s_addr);
+  }
+
+  in_addr loopback;
+  int peer_sd;
+  sockaddr_in peer_addr;
+};
+
+TEST_F(UdpPrimitivesServerTest, test_single_datagram) {
+  init_udp_socket(38123);
+  send_to_udp_task("single", 38123);
+  run_loop(&udp_task_zmq_ctx);
+  run_loop(&task_zmq_ctx_s11_udp_test);
+
+  ASSERT_EQ(received_msgs.size(), 1);
+  EXPECT_EQ(received_msgs[0].msg_id, UDP_DATA_IND);
+  EXPECT_EQ(received_msgs[0].local_port, 38123);
+  ASSERT_EQ(received_msgs[0].datagrams.size(), 1);
+  expect_datagram_from_peer(received_msgs[0].datagrams[0], "single");
+}
+
+TEST_F(UdpPrimitivesServerTest, test_datagrams_received_together) {
+  init_udp_socket(38124);
+  // All queued on the socket before the UDP task reads it. The oversized
+  // datagram is truncated by recvmmsg and dropped.
+  send_to_udp_task("first", 38124);
+  send_to_udp_task(std::string(UDP_DATA_MAX_MSG_LEN + 1, 'x'), 38124);
+  send_to_udp_task("second", 38124);
+  send_to_udp_task("third", 38124);
+  run_loop(&udp_task_zmq_ctx);
+  run_loop(&task_zmq_ctx_s11_udp_test);
+
+  ASSERT_EQ(received_msgs.size(), 1);
+  EXPECT_EQ(received_msgs[0].msg_id, UDP_DATA_BATCH_IND);
+  EXPECT_EQ(received_msgs[0].local_port, 38124);
+  ASSERT_EQ(received_msgs[0].datagrams.size(), 3);
+  expect_datagram_from_peer(received_msgs[0].datagrams[0], "first");
+  expect_datagram_from_peer(received_msgs[0].datagrams[1], "second");
+  expect_datagram_from_peer(received_msgs[0].datagrams[2], "third");
+}
+
+TEST_F(UdpPrimitivesServerTest, test_oversized_datagram_dropped) {
+  init_udp_socket(38125);
+  send_to_udp_task(std::string(UDP_DATA_MAX_MSG_LEN + 1, 'x'), 38125);
+  run_loop(&udp_task_zmq_ctx);
+  run_loop(&task_zmq_ctx_s11_udp_test);
+
+  EXPECT_EQ(received_msgs.size(), 0);
+}
+
+TEST_F(UdpPrimitivesServerTest, test_data_reqs_sent_in_order) {
+  init_udp_socket(38126);
+  // The payloads are copied when the requests are handled, and the copies
+  // are sent once the requests popped together have all been handled
+  std::vector<std::string> payloads = {"req-0", "req-1", "req-2"};
+  for (const auto& payload : payloads) {
+    send_data_req(payload, 38126);
+  }
+  char buffer[UDP_DATA_MAX_MSG_LEN];
+  EXPECT_LT(recv(peer_sd, buffer, sizeof(buffer), MSG_DONTWAIT), 0);
+  run_loop(&udp_task_zmq_ctx);
+
+  for (const auto& payload : payloads) {
+    ssize_t received = recv(peer_sd, buffer, sizeof(buffer), MSG_DONTWAIT);
+    ASSERT_EQ(received, payload.size());
+    EXPECT_EQ(std::string(buffer, received), payload);
+  }
+  EXPECT_LT(recv(peer_sd, buffer, sizeof(buffer), MSG_DONTWAIT), 0);
+}
@@ -66,7 +66,10 @@ int InterfaceMonitor::start_capture() {
         pcap_ = nullptr;
       }
       return -1;
-    } else if (ret == 0) {
+    }
+    pkt_gen_->process_resolved_lookups();
+    pkt_gen_->flush_records();
+    if (ret == 0) {
       pkt_gen_->delete_inactive_tasks();
       usleep(100);
     }
@@ -27,14 +27,17 @@
 #include <sys/socket.h>
 #include <sys/time.h>
 #include <uuid/uuid.h>
-#include <future>
+#include <deque>
 #include <memory>
+#include <mutex>
 #include <ostream>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "lte/gateway/c/li_agent/src/Utilities.hpp"
 #include "orc8r/gateway/c/common/logging/magma_logging.hpp"
+#include "orc8r/gateway/c/common/service303/MetricsHelpers.hpp"
 
 namespace magma {
 namespace lte {
@@ -51,6 +54,18 @@ namespace lte {
 #define SEQNBR_ATTRID 8
 #define TIMESTAMP_ATTRID 9
 
+// IPs of subscribers are cached longer than IPs not allocated to any
+// subscriber, which are mostly the remote ends of the flows
+#define SUBSCRIBER_CACHE_TTL_SEC 30
+#define SUBSCRIBER_NEGATIVE_CACHE_TTL_SEC 5
+#define MAX_SUBSCRIBER_CACHE_SIZE 65536
+#define MAX_PENDING_PACKETS 1024
+
+// Records are exported in batches of at most one TLS record, and are never
+// held longer than the batching delay while packets keep being captured
+#define EXPORT_BATCH_MAX_BYTES 16384
+#define EXPORT_BATCH_MAX_DELAY_USEC 1000
+
 #define SET_INT64_TLV(tlv, id, value)      \
   do {                                     \
     (tlv)->type = htons(id);               \
@@ -75,15 +90,38 @@ FlowInformation extract_flow_information(const u_char* packet) {
   return ret;
 }
 
+std::shared_ptr<std::atomic<uint64_t>> InterceptSequences::get(
+    const std::string& task_id, const std::string& ip) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& sequence = sequences_[task_id + ":" + ip];
+  auto shared = sequence.lock();
+  if (shared != nullptr) {
+    return shared;
+  }
+  // Drop the sequences of the intercepts deleted by every worker
+  auto it = sequences_.begin();
+  while (it != sequences_.end()) {
+    if (it->second.expired() && &it->second != &sequence) {
+      it = sequences_.erase(it);
+    } else {
+      it++;
+    }
+  }
+  shared = std::make_shared<std::atomic<uint64_t>>(0);
+  sequence = shared;
+  return shared;
+}
+
 static InterceptState build_new_intercept_state(
-    std::string subid, const magma::mconfig::NProbeTask& task) {
+    std::string subid, const magma::mconfig::NProbeTask& task,
+    std::shared_ptr<std::atomic<uint64_t>> sequence_number) {
   MLOG(MDEBUG) << "Create new intercept state for task " << task.task_id();
   InterceptState state;
   state.target_id = subid;
   state.task_id = task.task_id();
   state.domain_id = task.domain_id();
   state.correlation_id = task.correlation_id();
-  state.sequence_number = 0;
+  state.sequence_number = std::move(sequence_number);
   return state;
 }
 
@@ -92,15 +130,34 @@ PDUGenerator::PDUGenerator(const std::string& pkt_dst_mac,
                            int inactivity_time,
                            std::unique_ptr<ProxyConnector> proxy_connector,
                            std::unique_ptr<MobilitydClient> mobilityd_client,
-                           magma::mconfig::LIAgentD mconfig)
+                           magma::mconfig::LIAgentD mconfig,
+                           std::shared_ptr<InterceptSequences> sequences)
     : pkt_dst_mac_(pkt_dst_mac),
       pkt_src_mac_(pkt_src_mac),
       sync_interval_(sync_interval),
       inactivity_time_(inactivity_time),
       prev_sync_time_(0),
+      sequences_(std::move(sequences)),
       proxy_connector_(std::move(proxy_connector)),
       mobilityd_client_(std::move(mobilityd_client)),
-      mconfig_(mconfig) {}
+      mconfig_(mconfig),
+      cache_hits_(0),
+      cache_misses_(0),
+      pending_drops_(0),
+      export_drops_(0),
+      last_metrics_report_(0),
+      export_buffer_(EXPORT_BATCH_MAX_BYTES),
+      export_buffer_len_(0),
+      export_buffer_records_(0),
+      export_buffer_ts_{0, 0} {
+  memset(&x3_header_template_, 0, sizeof(x3_header_template_));
+  x3_header_template_.version = htons(PDU_VERSION);
+  x3_header_template_.pdu_type = htons(PDU_TYPE);
+  x3_header_template_.header_length = htonl(sizeof(X3Header));
+  x3_header_template_.payload_format = htons(IP_PAYLOAD_FORMAT);
+  SET_INT64_TLV(&x3_header_template_.attrs.timestamp, TIMESTAMP_ATTRID, 0);
+  SET_INT64_TLV(&x3_header_template_.attrs.sequence_number, SEQNBR_ATTRID, 0);
+}
 
 bool PDUGenerator::process_packet(const struct pcap_pkthdr* phdr,
                                   const u_char* pdata) {
@@ -118,27 +175,154 @@ bool PDUGenerator::process_packet(const struct pcap_pkthdr* phdr,
     prev_sync_time_ = get_time_in_sec_since_epoch();
   }
 
+  InterceptLookupResult result;
+  auto exported = process_flow_packet(phdr, pdata, flow, &result);
+  if (result == INTERCEPT_PENDING) {
+    // Lookups may have completed without waiting, the queued packets of the
+    // flow are processed first to keep the packet order
+    process_resolved_lookups();
+    exported = process_flow_packet(phdr, pdata, flow, &result);
+    if (result == INTERCEPT_PENDING) {
+      queue_pending_packet(phdr, pdata, flow);
+    }
+  }
+  return exported;
+}
+
+bool PDUGenerator::process_flow_packet(const struct pcap_pkthdr* phdr,
+                                       const u_char* pdata,
+                                       const FlowInformation& flow,
+                                       InterceptLookupResult* result) {
   std::string idx;
-  if (get_intercept_state_idx(flow, &idx) == false) {
-    MLOG(MERROR) << "Could not find subscriber for src ip - " << flow.src_ip
+  *result = get_intercept_state_idx(flow, &idx);
+  if (*result == INTERCEPT_PENDING) {
+    return false;
+  }
+  if (*result == INTERCEPT_NOT_FOUND) {
+    MLOG(MDEBUG) << "Could not find subscriber for src ip - " << flow.src_ip
                  << ", and dst ip - " << flow.dst_ip;
     return false;
   }
 
-  uint32_t rlen;
   uint16_t direction =
       (idx == flow.src_ip) ? DIRECTION_FROM_TARGET : DIRECTION_TO_TARGET;
+  return generate_record(phdr, pdata, idx, direction);
+}
+
+bool PDUGenerator::flush_records() {
+  if (export_buffer_records_ == 0) {
+    return true;
+  }
+  auto exported = export_record(export_buffer_.data(), export_buffer_len_,
+                                MAX_EXPORT_RETRIES);
+  MLOG(MDEBUG) << "Exported " << export_buffer_records_
+               << " records with length " << export_buffer_len_;
+  if (!exported) {
+    export_drops_ += export_buffer_records_;
+  }
+  export_buffer_len_ = 0;
+  export_buffer_records_ = 0;
+  return exported;
+}
+
+void PDUGenerator::queue_pending_packet(const struct pcap_pkthdr* phdr,
+                                        const u_char* pdata,
+                                        const FlowInformation& flow) {
+  if (pending_packets_.size() >= MAX_PENDING_PACKETS) {
+    MLOG(MDEBUG) << "Too many packets waiting for subscriber lookups, "
+                 << "dropping packet for src ip - " << flow.src_ip
+                 << ", and dst ip - " << flow.dst_ip;
+    pending_drops_++;
+    return;
+  }
+  PendingPacket packet;
+  packet.phdr = *phdr;
+  packet.pdata.assign(pdata, pdata + phdr->caplen);
+  packet.flow = flow;
+  pending_packets_.push_back(std::move(packet));
+}
+
+void PDUGenerator::process_resolved_lookups() {
+  report_metrics();
+  if (!update_subscriber_cache() || pending_packets_.empty()) {
+    return;
+  }
+  std::deque<PendingPacket> packets;
+  packets.swap(pending_packets_);
+  for (auto& packet : packets) {
+    InterceptLookupResult result;
+    process_flow_packet(&packet.phdr, packet.pdata.data(), packet.flow,
+                        &result);
+    if (result == INTERCEPT_PENDING) {
+      pending_packets_.push_back(std::move(packet));
+    }
+  }
+}
 
-  void* record = generate_record(phdr, pdata, idx, direction, &rlen);
-  if (record == nullptr) {
+bool PDUGenerator::update_subscriber_cache() {
+  std::vector<std::pair<std::string, std::string>> resolved;
+  {
+    std::lock_guard<std::mutex> lock(resolved_lookups_mutex_);
+    resolved.swap(resolved_lookups_);
+  }
+  if (resolved.empty()) {
     return false;
   }
 
-  auto exported = export_record(record, rlen, MAX_EXPORT_RETRIES);
-  MLOG(MDEBUG) << "Exported packet " << state_map_[idx].sequence_number
-               << " with length " << rlen;
-  free(record);
-  return exported;
+  auto now = get_time_in_sec_since_epoch();
+  if (subscriber_cache_.size() + resolved.size() > MAX_SUBSCRIBER_CACHE_SIZE) {
+    purge_subscriber_cache();
+    if (subscriber_cache_.size() + resolved.size() >
+        MAX_SUBSCRIBER_CACHE_SIZE) {
+      subscriber_cache_.clear();
+    }
+  }
+  for (auto& lookup : resolved) {
+    pending_lookups_.erase(lookup.first);
+    auto& entry = subscriber_cache_[lookup.first];
+    entry.expires = now + (lookup.second.empty()
+                               ? SUBSCRIBER_NEGATIVE_CACHE_TTL_SEC
+                               : SUBSCRIBER_CACHE_TTL_SEC);
+    entry.subid = std::move(lookup.second);
+  }
+  return true;
+}
+
+void PDUGenerator::report_metrics() {
+  auto now = get_time_in_sec_since_epoch();
+  if (now == last_metrics_report_) {
+    return;
+  }
+  last_metrics_report_ = now;
+  if (cache_hits_) {
+    increment_counter("li_subscriber_cache_lookups", cache_hits_, 1, "result",
+                      "hit");
+  }
+  if (cache_misses_) {
+    increment_counter("li_subscriber_cache_lookups", cache_misses_, 1,
+                      "result", "miss");
+  }
+  if (pending_drops_) {
+    increment_counter("li_dropped_packets", pending_drops_, 1, "reason",
+                      "lookup_pending");
+  }
+  if (export_drops_) {
+    increment_counter("li_dropped_packets", export_drops_, 1, "reason",
+                      "export_failed");
+  }
+  cache_hits_ = cache_misses_ = pending_drops_ = export_drops_ = 0;
+}
+
+void PDUGenerator::purge_subscriber_cache() {
+  auto now = get_time_in_sec_since_epoch();
+  auto it = subscriber_cache_.begin();
+  while (it != subscriber_cache_.end()) {
+    if (it->second.expires <= now) {
+      it = subscriber_cache_.erase(it);
+    } else {
+      it++;
+    }
+  }
 }
 
 void PDUGenerator::delete_inactive_tasks() {
@@ -157,107 +341,126 @@ void PDUGenerator::delete_inactive_tasks() {
       it++;
     }
   }
+  purge_subscriber_cache();
   return;
 }
 
-void* PDUGenerator::generate_record(const struct pcap_pkthdr* phdr,
-                                    const u_char* pdata, std::string idx,
-                                    uint16_t direction, uint32_t* record_len) {
+bool PDUGenerator::generate_record(const struct pcap_pkthdr* phdr,
+                                   const u_char* pdata, const std::string& idx,
+                                   uint16_t direction) {
   auto& state = state_map_[idx];
   uint32_t hdr_len = sizeof(X3Header);
-  uint32_t pld_len =
-      phdr->len -
-      ETHERNET_HDR_LEN;  // Skip eth layer as defined in ETSI 103 221-2.
+  if (phdr->caplen < ETHERNET_HDR_LEN) {
+    MLOG(MERROR) << "Packet too short " << phdr->caplen;
+    return false;
+  }
+  // Skip eth layer as defined in ETSI 103 221-2.
+  uint32_t pld_len = phdr->caplen - ETHERNET_HDR_LEN;
+  uint32_t record_len = hdr_len + pld_len;
+  if (record_len > export_buffer_.size()) {
+    MLOG(MERROR) << "Record too large " << record_len;
+    return false;
+  }
 
-  *record_len = hdr_len + pld_len;
-  uint8_t* record = static_cast<uint8_t*>(calloc(1, *record_len));
-  if (record == nullptr) {
-    MLOG(MERROR) << "Failed to allocate memory " << *record_len;
-    *record_len = 0;
-    return nullptr;
+  if (export_buffer_records_ > 0) {
+    struct timeval delay;
+    timersub(&phdr->ts, &export_buffer_ts_, &delay);
+    if (export_buffer_len_ + record_len > export_buffer_.size() ||
+        delay.tv_sec > 0 || delay.tv_usec > EXPORT_BATCH_MAX_DELAY_USEC) {
+      flush_records();
+    }
   }
 
+  uint8_t* record = export_buffer_.data() + export_buffer_len_;
   X3Header* pdu = reinterpret_cast<X3Header*>(record);
-  pdu->version = htons(PDU_VERSION);
-  pdu->pdu_type = htons(PDU_TYPE);
-  pdu->header_length = htonl(hdr_len);
+  memcpy(pdu, &x3_header_template_, hdr_len);
   pdu->payload_length = htonl(pld_len);
-  pdu->payload_format = htons(IP_PAYLOAD_FORMAT);
   pdu->correlation_id = htobe64(state.correlation_id);
   pdu->payload_direction = htons(direction);
 
   uint64_t tm = (uint64_t)phdr->ts.tv_sec << 32 | phdr->ts.tv_usec;
-  SET_INT64_TLV(&pdu->attrs.timestamp, TIMESTAMP_ATTRID, tm);
-
-  SET_INT64_TLV(&pdu->attrs.sequence_number, SEQNBR_ATTRID,
-                state.sequence_number);
+  pdu->attrs.timestamp.data = htobe64(tm);
 
   auto ret = uuid_parse(state.task_id.c_str(), pdu->xid);
   if (ret != 0) {
     MLOG(MERROR) << "Failed to parse task_id " << state.task_id.c_str();
-    free(record);
-    *record_len = 0;
-    return nullptr;
+    return false;
   }
+  pdu->attrs.sequence_number.data =
+      htobe64(state.sequence_number->fetch_add(1, std::memory_order_relaxed));
 
   memcpy(record + hdr_len, pdata + ETHERNET_HDR_LEN, pld_len);
   state.last_exported = phdr->ts.tv_sec;
-  state.sequence_number++;
 
-  return reinterpret_cast<void*>(record);
+  if (export_buffer_records_ == 0) {
+    export_buffer_ts_ = phdr->ts;
+  }
+  export_buffer_len_ += record_len;
+  export_buffer_records_++;
+  return true;
 }
 
 bool PDUGenerator::export_record(void* record, uint32_t size, int retries) {
   for (auto i = 0; i < retries; i++) {
     int ret = proxy_connector_->send_data(record, size);
     if (ret > 0) {
-      break;
-    } else {
-      proxy_connector_->cleanup();
-      if (proxy_connector_->setup_proxy_socket() < 0) {
-        return false;
-      }
+      return true;
+    }
+    proxy_connector_->cleanup();
+    if (proxy_connector_->setup_proxy_socket() < 0) {
+      return false;
     }
   }
-  return true;
+  return false;
 }
 
-bool PDUGenerator::get_subscriber_id_from_ip(const char* ip_addr,
-                                             std::string* subid) {
+InterceptLookupResult PDUGenerator::get_subscriber_id_from_ip(
+    const std::string& ip_addr, std::string* subid) {
+  auto it = subscriber_cache_.find(ip_addr);
+  if (it != subscriber_cache_.end() &&
+      it->second.expires > get_time_in_sec_since_epoch()) {
+    cache_hits_++;
+    if (it->second.subid.empty()) {
+      return INTERCEPT_NOT_FOUND;
+    }
+    *subid = it->second.subid;
+    return INTERCEPT_FOUND;
+  }
+  if (pending_lookups_.find(ip_addr) != pending_lookups_.end()) {
+    return INTERCEPT_PENDING;
+  }
+  cache_misses_++;
+
   struct in_addr addr;
-  if (inet_aton(ip_addr, &addr) <= 0) {
+  if (inet_aton(ip_addr.c_str(), &addr) <= 0) {
     MLOG(MERROR) << "Bad IPv4 address format " << ip_addr;
-    return false;
+    return INTERCEPT_NOT_FOUND;
   }
 
-  std::promise<std::string> lookup_res;
-  std::future<std::string> lookup_future = lookup_res.get_future();
+  // The response is handled on the mobilityd response thread, the result is
+  // added to the cache by the capture loop
+  pending_lookups_.insert(ip_addr);
   mobilityd_client_->get_subscriber_id_from_ip(
-      addr, [&lookup_res, ip_addr](grpc::Status status, SubscriberID resp) {
+      addr, [this, ip_addr](grpc::Status status, SubscriberID resp) {
+        std::string subid_str;
         if (!status.ok()) {
           MLOG(MDEBUG) << "Could not find subscriber_id for ip " << ip_addr;
-          lookup_res.set_value("");
-          return;
+        } else {
+          MLOG(MDEBUG) << "Found subscriber " << resp.id() << " for ip "
+                       << ip_addr;
+          subid_str = resp.id();
+          if (subid_str.find("IMSI") == std::string::npos) {
+            subid_str = "IMSI" + subid_str;
+          }
         }
-        MLOG(MDEBUG) << "Found subscriber " << resp.id() << " for ip "
-                     << ip_addr;
-        lookup_res.set_value(resp.id());
+        std::lock_guard<std::mutex> lock(resolved_lookups_mutex_);
+        resolved_lookups_.emplace_back(ip_addr, std::move(subid_str));
       });
-
-  std::string subid_str = lookup_future.get();
-  if (subid_str.empty()) {
-    return false;
-  }
-
-  if (subid_str.find("IMSI") == std::string::npos) {
-    subid_str = "IMSI" + subid_str;
-  }
-  *subid = subid_str.c_str();
-  return true;
+  return INTERCEPT_PENDING;
 }
 
-bool PDUGenerator::get_intercept_state_idx(const FlowInformation& flow,
-                                           std::string* idx) {
+InterceptLookupResult PDUGenerator::get_intercept_state_idx(
+    const FlowInformation& flow, std::string* idx) {
   if (state_map_.find(flow.src_ip) != state_map_.end()) {
     *idx = flow.src_ip;
   } else if (state_map_.find(flow.dst_ip) != state_map_.end()) {
@@ -266,7 +469,7 @@ bool PDUGenerator::get_intercept_state_idx(const FlowInformation& flow,
 
   if (!idx->empty()) {
     if (is_still_valid_state(*idx)) {
-      return true;
+      return INTERCEPT_FOUND;
     }
     MLOG(MDEBUG) << "Delete invalid state for " << idx;
     state_map_.erase(*idx);
@@ -274,24 +477,32 @@ bool PDUGenerator::get_intercept_state_idx(const FlowInformation& flow,
   return create_new_intercept_state(flow, idx);
 }
 
-bool PDUGenerator::create_new_intercept_state(const FlowInformation& flow,
-                                              std::string* idx) {
+InterceptLookupResult PDUGenerator::create_new_intercept_state(
+    const FlowInformation& flow, std::string* idx) {
   std::string subid;
-  if (get_subscriber_id_from_ip(flow.src_ip.c_str(), &subid)) {
+  auto src_result = get_subscriber_id_from_ip(flow.src_ip, &subid);
+  if (src_result == INTERCEPT_FOUND) {
     *idx = flow.src_ip;
-  } else if (get_subscriber_id_from_ip(flow.dst_ip.c_str(), &subid)) {
-    *idx = flow.dst_ip;
   } else {
-    return false;
+    // Both lookups are started at once, the source still takes precedence
+    auto dst_result = get_subscriber_id_from_ip(flow.dst_ip, &subid);
+    if (src_result == INTERCEPT_PENDING || dst_result == INTERCEPT_PENDING) {
+      return INTERCEPT_PENDING;
+    }
+    if (dst_result == INTERCEPT_NOT_FOUND) {
+      return INTERCEPT_NOT_FOUND;
+    }
+    *idx = flow.dst_ip;
   }
 
   for (const auto& it : mconfig_.nprobe_tasks()) {
     if (it.target_id() == subid) {
-      state_map_[*idx] = build_new_intercept_state(subid, it);
-      return true;
+      state_map_[*idx] = build_new_intercept_state(
+          subid, it, sequences_->get(it.task_id(), *idx));
+      return INTERCEPT_FOUND;
     }
   }
-  return false;
+  return INTERCEPT_NOT_FOUND;
 }
 
 bool PDUGenerator::is_still_valid_state(const std::string& idx) {
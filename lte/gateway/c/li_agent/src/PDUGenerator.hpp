@@ -13,14 +13,21 @@
 #pragma once
 
 #include <lte/protos/mconfig/mconfigs.pb.h>
+#include <pcap.h>
 #include <stdint.h>
 #include <sys/types.h>
 #include <tins/network_interface.h>
 #include <tins/tins.h>
 #include <uuid/uuid.h>
+#include <atomic>
+#include <deque>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "lte/gateway/c/li_agent/src/MobilitydClient.hpp"
 #include "lte/gateway/c/li_agent/src/ProxyConnector.hpp"
@@ -67,30 +74,100 @@ typedef struct {
   std::string domain_id;
   uint64_t last_exported;
   uint64_t correlation_id;
-  uint64_t sequence_number;
+  // Shared with the other capture workers, see InterceptSequences
+  std::shared_ptr<std::atomic<uint64_t>> sequence_number;
 } InterceptState;
 
 typedef std::unordered_map<std::string, InterceptState> InterceptStateMap;
 
+typedef struct {
+  // Empty if the IP is not allocated to a subscriber
+  std::string subid;
+  uint64_t expires;
+} SubscriberCacheEntry;
+
+typedef std::unordered_map<std::string, SubscriberCacheEntry> SubscriberCache;
+
+// Copy of a packet waiting for the subscriber lookup of its flow
+typedef struct {
+  struct pcap_pkthdr phdr;
+  std::vector<u_char> pdata;
+  FlowInformation flow;
+} PendingPacket;
+
+/**
+ * InterceptSequences numbers the records of each intercept across the
+ * PDUGenerators of the capture workers. The fanout spreads the flows of a
+ * subscriber over several workers, their records must still be numbered in
+ * a single sequence.
+ */
+class InterceptSequences {
+ public:
+  /**
+   * get returns the sequence number of the next record of task_id for the
+   * subscriber at ip. The sequence starts again from 0 once no worker holds
+   * an intercept state for it.
+   * @param task_id - the intercept task id
+   * @param ip - the subscriber ip
+   * @return the shared sequence number
+   */
+  std::shared_ptr<std::atomic<uint64_t>> get(const std::string& task_id,
+                                             const std::string& ip);
+
+ private:
+  std::mutex mutex_;
+  std::unordered_map<std::string, std::weak_ptr<std::atomic<uint64_t>>>
+      sequences_;
+};
+
+enum InterceptLookupResult {
+  INTERCEPT_FOUND,
+  INTERCEPT_NOT_FOUND,
+  // Waiting for mobilityd to resolve the subscriber of the flow
+  INTERCEPT_PENDING,
+};
+
 class PDUGenerator {
  public:
   PDUGenerator(const std::string& pkt_dst_mac, const std::string& pkt_src_mac,
                int sync_interval, int inactivity_time,
                std::unique_ptr<ProxyConnector> proxy_connector,
                std::unique_ptr<MobilitydClient> mobilityd_client,
-               magma::mconfig::LIAgentD mconfig);
+               magma::mconfig::LIAgentD mconfig,
+               std::shared_ptr<InterceptSequences> sequences =
+                   std::make_shared<InterceptSequences>());
 
   /**
    * process_packet retrieves the state of the current interception for
    * this packet by looking in the intercept map or interrogating mobility
    * service and creating a new one. Then it generates the corresponding
    * x3 records and exports it to remote destination over TLS.
+   * Subscriber lookups are cached and never block, the packets of a flow
+   * whose subscriber is being resolved are queued until the lookup completes.
+   * Records are batched in the export buffer, see flush_records.
    * @param phdr - packet header
    * @param pdata - packet data
    * @return true if the operation was successful
    */
   bool process_packet(const struct pcap_pkthdr* phdr, const u_char* pdata);
 
+  /**
+   * flush_records exports the records batched in the export buffer in a
+   * single TLS write. Records are also flushed when the buffer is full or
+   * when the oldest buffered record exceeds the batching delay, this is
+   * called from the capture loop after each capture batch.
+   * @return true if the operation was successful
+   */
+  bool flush_records();
+
+  /**
+   * process_resolved_lookups adds the completed mobilityd lookups to the
+   * subscriber cache and processes the queued packets whose flow is now
+   * resolved. It is called from the capture loop and never blocks.
+   * @return void
+   */
+  void process_resolved_lookups();
+
   /**
    * delete_inactive_tasks loops over all tasks and deletes all inactive states
    * with no exported records for inactivity_time seconds.
@@ -107,28 +184,94 @@ class PDUGenerator {
   uint64_t prev_sync_time_;
   Tins::NetworkInterface iface_;
   InterceptStateMap state_map_;
+  std::shared_ptr<InterceptSequences> sequences_;
   std::unique_ptr<ProxyConnector> proxy_connector_;
   std::unique_ptr<MobilitydClient> mobilityd_client_;
   magma::mconfig::LIAgentD mconfig_;
+  SubscriberCache subscriber_cache_;
+  // IPs with a mobilityd lookup in flight
+  std::unordered_set<std::string> pending_lookups_;
+  std::deque<PendingPacket> pending_packets_;
+  // Lookups completed by the mobilityd response thread, as (ip, subid)
+  std::vector<std::pair<std::string, std::string>> resolved_lookups_;
+  std::mutex resolved_lookups_mutex_;
+  // Counted per packet and added to the metrics once per second, to keep the
+  // metrics registry lookups out of the capture loop
+  uint64_t cache_hits_;
+  uint64_t cache_misses_;
+  uint64_t pending_drops_;
+  uint64_t export_drops_;
+  uint64_t last_metrics_report_;
+  // Records are built in place in the export buffer and exported together,
+  // instead of one allocation and one TLS write per packet
+  std::vector<uint8_t> export_buffer_;
+  uint32_t export_buffer_len_;
+  uint32_t export_buffer_records_;
+  // Capture time of the first buffered record
+  struct timeval export_buffer_ts_;
+  // Fields of the x3 header common to all records, in network byte order
+  X3Header x3_header_template_;
+
+  /**
+   * process_flow_packet exports the packet if its flow belongs to an
+   * intercepted subscriber.
+   * @param phdr - packet header
+   * @param pdata - packet data
+   * @param flow - describes the ip sources and destination address
+   * @param result - output intercept lookup result
+   * @return true if the operation was successful
+   */
+  bool process_flow_packet(const struct pcap_pkthdr* phdr,
+                           const u_char* pdata, const FlowInformation& flow,
+                           InterceptLookupResult* result);
+
+  /**
+   * queue_pending_packet copies the packet until the subscriber lookup of
+   * its flow completes, or drops it if too many packets are queued.
+   * @param phdr - packet header
+   * @param pdata - packet data
+   * @param flow - describes the ip sources and destination address
+   * @return void
+   */
+  void queue_pending_packet(const struct pcap_pkthdr* phdr,
+                            const u_char* pdata, const FlowInformation& flow);
+
+  /**
+   * update_subscriber_cache adds the completed lookups to the cache.
+   * @return true if a lookup completed since the last call
+   */
+  bool update_subscriber_cache();
+
+  /**
+   * report_metrics adds the cache hits and misses and the dropped packets
+   * counted since the last report to the service metrics.
+   * @return void
+   */
+  void report_metrics();
+
+  /**
+   * purge_subscriber_cache removes the expired cache entries.
+   * @return void
+   */
+  void purge_subscriber_cache();
 
   /**
    * generate_record builds an x3 record from the current packet as specified
-   * in ETSI 103 221-2.
+   * in ETSI 103 221-2, at the end of the export buffer. The buffer is flushed
+   * first if the record does not fit or the batching delay is exceeded.
    * @param phdr - packet header
    * @param pdata - packet data
-   * @param state - intercept state
+   * @param idx - the intercept state index
    * @param direction - direction of packet
-   * @param record_len - output record length
    * @return true if the operation was successful
    */
-  void* generate_record(const struct pcap_pkthdr* phdr, const u_char* pdata,
-                        std::string idx, uint16_t direction,
-                        uint32_t* record_len);
+  bool generate_record(const struct pcap_pkthdr* phdr, const u_char* pdata,
+                       const std::string& idx, uint16_t direction);
 
   /**
-   * export_record exports the x3 record over tls to a remote server.
-   * @param record- x3 record packet
-   * @param size - x3 record length
+   * export_record exports x3 records over tls to a remote server.
+   * @param record- x3 records
+   * @param size - x3 records length
    * @param retries - number of retries
    * @return true if the operation was successful
    */
@@ -136,12 +279,15 @@ class PDUGenerator {
 
   /**
    * get_subscriber_id_from_ip retrieves a subscriber id from the ip address
-   * from mobilityd service
+   * from the subscriber cache. On a miss, it starts an asynchronous lookup
+   * to mobilityd service.
    * @param ip_addr - ip address
    * @param subid - subscriber id
-   * @return true if subscriber is found, false otherwise
+   * @return INTERCEPT_FOUND if subscriber is found, INTERCEPT_PENDING if the
+   *         lookup is in flight, INTERCEPT_NOT_FOUND otherwise
    */
-  bool get_subscriber_id_from_ip(const char* ip_addr, std::string* subid);
+  InterceptLookupResult get_subscriber_id_from_ip(const std::string& ip_addr,
+                                                  std::string* subid);
 
   /**
    * get_intercept_state_idx retrieves a state for the current flow from
@@ -149,19 +295,22 @@ class PDUGenerator {
    * create new one.
    * @param flow - describes the ip sources and destination address
    * @param idx - the intercept state index
-   * @return true if a new state is found, false otherwise
+   * @return INTERCEPT_FOUND if a state is found, INTERCEPT_PENDING if the
+   *         subscriber of the flow is being resolved
    */
-  bool get_intercept_state_idx(const FlowInformation& flow, std::string* idx);
+  InterceptLookupResult get_intercept_state_idx(const FlowInformation& flow,
+                                                std::string* idx);
 
   /**
    * create_new_intercept_state creates a new state for the current flow from
    * the corresponding mconfig nprobe task
    * @param flow - describes the ip sources and destination address
    * @param idx - the newly created state index
-   * @return true if a new state is created, false otherwise
+   * @return INTERCEPT_FOUND if a new state is created, INTERCEPT_PENDING if
+   *         the subscriber of the flow is being resolved
    */
-  bool create_new_intercept_state(const FlowInformation& flow,
-                                  std::string* idx);
+  InterceptLookupResult create_new_intercept_state(const FlowInformation& flow,
+                                                   std::string* idx);
 
   /**
    * is_still_valid_state validates that the current state belongs to non
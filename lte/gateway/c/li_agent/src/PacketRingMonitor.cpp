@@ -0,0 +1,260 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "lte/gateway/c/li_agent/src/PacketRingMonitor.hpp"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <glog/logging.h>
+#include <linux/filter.h>
+#include <linux/if_ether.h>
+#include <net/if.h>
+#include <pcap.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <ostream>
+#include <thread>
+#include <utility>
+
+#include "lte/gateway/c/li_agent/src/InterfaceMonitor.hpp"
+#include "lte/gateway/c/li_agent/src/Utilities.hpp"
+#include "orc8r/gateway/c/common/logging/magma_logging.hpp"
+#include "orc8r/gateway/c/common/service303/MetricsHelpers.hpp"
+
+namespace magma {
+namespace lte {
+
+PacketRingMonitor::PacketRingMonitor(
+    const std::string& iface_name,
+    std::vector<std::unique_ptr<PDUGenerator>> pkt_gens)
+    : iface_name_(iface_name), stopping_(false) {
+  for (auto& pkt_gen : pkt_gens) {
+    RingWorker worker;
+    worker.fd = -1;
+    worker.ring = nullptr;
+    worker.ring_len = 0;
+    worker.block_idx = 0;
+    worker.pkt_gen = std::move(pkt_gen);
+    worker.last_stats_report = 0;
+    workers_.push_back(std::move(worker));
+  }
+}
+
+PacketRingMonitor::~PacketRingMonitor() {
+  for (auto& worker : workers_) {
+    close_worker(&worker);
+  }
+}
+
+int PacketRingMonitor::init_interface_monitor() {
+  int ifindex = if_nametoindex(iface_name_.c_str());
+  if (ifindex == 0) {
+    MLOG(MFATAL) << "Could not find interface " << iface_name_ << ", exiting";
+    return -1;
+  }
+  // The fanout group is shared by the sockets of this process only
+  int fanout_id = getpid() & 0xffff;
+  for (auto& worker : workers_) {
+    if (init_worker(&worker, ifindex, fanout_id) < 0) {
+      MLOG(MFATAL) << "Could not capture packets on " << iface_name_
+                   << ", exiting";
+      return -1;
+    }
+  }
+  MLOG(MINFO) << "Successfully started packet ring sniffing with "
+              << workers_.size() << " workers";
+  return 0;
+}
+
+int PacketRingMonitor::init_worker(RingWorker* worker, int ifindex,
+                                   int fanout_id) {
+  worker->fd = socket(AF_PACKET, SOCK_RAW, htons(ETH_P_ALL));
+  if (worker->fd < 0) {
+    MLOG(MERROR) << "Could not open packet socket, " << strerror(errno);
+    return -1;
+  }
+
+  int version = TPACKET_V3;
+  if (setsockopt(worker->fd, SOL_PACKET, PACKET_VERSION, &version,
+                 sizeof(version)) < 0) {
+    MLOG(MERROR) << "Could not set TPACKET_V3, " << strerror(errno);
+    return -1;
+  }
+
+  // Truncates the packets to the capture length of the pcap capture
+  struct sock_filter snaplen_code[] = {{BPF_RET | BPF_K, 0, 0, MAX_PKT_SIZE}};
+  struct sock_fprog snaplen_filter = {1, snaplen_code};
+  if (setsockopt(worker->fd, SOL_SOCKET, SO_ATTACH_FILTER, &snaplen_filter,
+                 sizeof(snaplen_filter)) < 0) {
+    MLOG(MERROR) << "Could not set capture length, " << strerror(errno);
+    return -1;
+  }
+
+  struct tpacket_req3 req;
+  memset(&req, 0, sizeof(req));
+  req.tp_block_size = RING_BLOCK_SIZE;
+  req.tp_block_nr = RING_BLOCK_NR;
+  req.tp_frame_size = RING_FRAME_SIZE;
+  req.tp_frame_nr = (RING_BLOCK_SIZE * RING_BLOCK_NR) / RING_FRAME_SIZE;
+  req.tp_retire_blk_tov = RING_BLOCK_TIMEOUT_MS;
+  if (setsockopt(worker->fd, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req)) <
+      0) {
+    MLOG(MERROR) << "Could not set up packet ring, " << strerror(errno);
+    return -1;
+  }
+
+  worker->ring_len = (size_t)req.tp_block_size * req.tp_block_nr;
+  void* ring = mmap(nullptr, worker->ring_len, PROT_READ | PROT_WRITE,
+                    MAP_SHARED, worker->fd, 0);
+  if (ring == MAP_FAILED) {
+    MLOG(MERROR) << "Could not map packet ring, " << strerror(errno);
+    worker->ring_len = 0;
+    return -1;
+  }
+  worker->ring = static_cast<uint8_t*>(ring);
+
+  struct sockaddr_ll addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sll_family = AF_PACKET;
+  addr.sll_protocol = htons(ETH_P_ALL);
+  addr.sll_ifindex = ifindex;
+  if (bind(worker->fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+    MLOG(MERROR) << "Could not bind packet socket, " << strerror(errno);
+    return -1;
+  }
+
+  // Both directions of a flow are hashed to the same worker
+  int fanout = fanout_id | (PACKET_FANOUT_HASH << 16);
+  if (setsockopt(worker->fd, SOL_PACKET, PACKET_FANOUT, &fanout,
+                 sizeof(fanout)) < 0) {
+    MLOG(MERROR) << "Could not join fanout group, " << strerror(errno);
+    return -1;
+  }
+  return 0;
+}
+
+int PacketRingMonitor::start_capture() {
+  std::vector<std::thread> threads;
+  std::vector<int> results(workers_.size(), 0);
+  stopping_ = false;
+  for (size_t i = 0; i < workers_.size(); i++) {
+    threads.emplace_back([this, i, &results]() {
+      results[i] = run_worker(&workers_[i]);
+      if (results[i] < 0) {
+        stopping_ = true;
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (auto result : results) {
+    if (result < 0) {
+      return -1;
+    }
+  }
+  return 0;
+}
+
+int PacketRingMonitor::run_worker(RingWorker* worker) {
+  struct pollfd pfd;
+  pfd.fd = worker->fd;
+  pfd.events = POLLIN | POLLERR;
+  while (!stopping_.load(std::memory_order_relaxed)) {
+    auto* block = reinterpret_cast<struct tpacket_block_desc*>(
+        worker->ring + (size_t)worker->block_idx * RING_BLOCK_SIZE);
+    if ((__atomic_load_n(&block->hdr.bh1.block_status, __ATOMIC_ACQUIRE) &
+         TP_STATUS_USER) == 0) {
+      // Lookups and batched records are completed while waiting, the timeout
+      // of the blocks keeps the wait short while packets are captured
+      worker->pkt_gen->process_resolved_lookups();
+      worker->pkt_gen->flush_records();
+      pfd.revents = 0;
+      int ret = poll(&pfd, 1, RING_POLL_TIMEOUT_MS);
+      if (ret < 0 && errno != EINTR) {
+        MLOG(MERROR) << "Could not capture packets, " << strerror(errno);
+        return -1;
+      }
+      if (ret == 0) {
+        worker->pkt_gen->delete_inactive_tasks();
+        report_ring_drops(worker);
+      }
+      continue;
+    }
+
+    process_block(worker, block);
+    __atomic_store_n(&block->hdr.bh1.block_status, TP_STATUS_KERNEL,
+                     __ATOMIC_RELEASE);
+    worker->block_idx = (worker->block_idx + 1) % RING_BLOCK_NR;
+    worker->pkt_gen->process_resolved_lookups();
+    worker->pkt_gen->flush_records();
+    report_ring_drops(worker);
+  }
+  // Another worker failed
+  return -1;
+}
+
+void PacketRingMonitor::process_block(RingWorker* worker,
+                                      struct tpacket_block_desc* block) {
+  auto* ppd = reinterpret_cast<struct tpacket3_hdr*>(
+      reinterpret_cast<uint8_t*>(block) + block->hdr.bh1.offset_to_first_pkt);
+  for (uint32_t i = 0; i < block->hdr.bh1.num_pkts; i++) {
+    struct pcap_pkthdr phdr;
+    phdr.ts.tv_sec = ppd->tp_sec;
+    phdr.ts.tv_usec = ppd->tp_nsec / 1000;
+    phdr.caplen = ppd->tp_snaplen;
+    phdr.len = ppd->tp_len;
+    const u_char* pdata = reinterpret_cast<const u_char*>(ppd) + ppd->tp_mac;
+    worker->pkt_gen->process_packet(&phdr, pdata);
+    ppd = reinterpret_cast<struct tpacket3_hdr*>(
+        reinterpret_cast<uint8_t*>(ppd) + ppd->tp_next_offset);
+  }
+}
+
+void PacketRingMonitor::report_ring_drops(RingWorker* worker) {
+  auto now = get_time_in_sec_since_epoch();
+  if (now == worker->last_stats_report) {
+    return;
+  }
+  worker->last_stats_report = now;
+  // Reading the statistics resets them
+  struct tpacket_stats_v3 stats;
+  socklen_t len = sizeof(stats);
+  if (getsockopt(worker->fd, SOL_PACKET, PACKET_STATISTICS, &stats, &len) <
+      0) {
+    return;
+  }
+  if (stats.tp_drops) {
+    MLOG(MDEBUG) << "Packet ring full, dropped " << stats.tp_drops
+                 << " packets";
+    increment_counter("li_dropped_packets", stats.tp_drops, 1, "reason",
+                      "ring_full");
+  }
+}
+
+void PacketRingMonitor::close_worker(RingWorker* worker) {
+  if (worker->ring != nullptr) {
+    munmap(worker->ring, worker->ring_len);
+    worker->ring = nullptr;
+  }
+  if (worker->fd != -1) {
+    close(worker->fd);
+    worker->fd = -1;
+  }
+}
+
+}  // namespace lte
+}  // namespace magma
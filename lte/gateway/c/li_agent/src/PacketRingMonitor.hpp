@@ -0,0 +1,90 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <linux/if_packet.h>
+#include <stdint.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "lte/gateway/c/li_agent/src/PDUGenerator.hpp"
+
+namespace magma {
+namespace lte {
+
+// Each worker maps a ring of RING_BLOCK_NR blocks of RING_BLOCK_SIZE bytes,
+// a block is handed over to the worker when it is full or after
+// RING_BLOCK_TIMEOUT_MS
+#define RING_BLOCK_SIZE (1 << 20)
+#define RING_BLOCK_NR 64
+#define RING_FRAME_SIZE 2048
+#define RING_BLOCK_TIMEOUT_MS 10
+#define RING_POLL_TIMEOUT_MS 100
+
+typedef struct {
+  int fd;
+  uint8_t* ring;
+  size_t ring_len;
+  // Next block handed over by the kernel
+  uint32_t block_idx;
+  std::unique_ptr<PDUGenerator> pkt_gen;
+  uint64_t last_stats_report;
+} RingWorker;
+
+/**
+ * PacketRingMonitor captures the packets of an interface through memory
+ * mapped TPACKET_V3 rings, without the copies of the pcap capture. The
+ * packets are spread over the workers by a fanout group hashing the flows,
+ * each worker runs on its own thread with its own PDUGenerator, so the
+ * intercept states and the TLS connection to the proxy are per worker. The
+ * flows of a subscriber can reach several workers, the PDUGenerators share
+ * the sequence numbers of the intercepts through InterceptSequences.
+ */
+class PacketRingMonitor {
+ public:
+  PacketRingMonitor(const std::string& iface_name,
+                    std::vector<std::unique_ptr<PDUGenerator>> pkt_gens);
+
+  ~PacketRingMonitor();
+
+  /**
+   * init_interface_monitor opens, maps and binds the ring of each worker,
+   * and adds it to the fanout group of the interface.
+   * @return return positif integer if interface monitoring starts successfully.
+   */
+  int init_interface_monitor();
+
+  /**
+   * start_capture runs the workers until one of them fails, the others then
+   * stop within RING_POLL_TIMEOUT_MS.
+   * @return -1 on failure
+   */
+  int start_capture();
+
+ private:
+  std::string iface_name_;
+  std::vector<RingWorker> workers_;
+  // Set by a failing worker to stop the others
+  std::atomic<bool> stopping_;
+
+  int init_worker(RingWorker* worker, int ifindex, int fanout_id);
+  int run_worker(RingWorker* worker);
+  void process_block(RingWorker* worker, struct tpacket_block_desc* block);
+  void report_ring_drops(RingWorker* worker);
+  void close_worker(RingWorker* worker);
+};
+
+}  // namespace lte
+}  // namespace magma
@@ -17,15 +17,18 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <yaml-cpp/yaml.h>
+#include <algorithm>
 #include <memory>
 #include <ostream>
 #include <string>
 #include <thread>
 #include <utility>
+#include <vector>
 
 #include "lte/gateway/c/li_agent/src/InterfaceMonitor.hpp"
 #include "lte/gateway/c/li_agent/src/MobilitydClient.hpp"
 #include "lte/gateway/c/li_agent/src/PDUGenerator.hpp"
+#include "lte/gateway/c/li_agent/src/PacketRingMonitor.hpp"
 #include "lte/gateway/c/li_agent/src/ProxyConnector.hpp"
 #include "lte/gateway/c/li_agent/src/Utilities.hpp"
 #include "orc8r/gateway/c/common/config/MConfigLoader.hpp"
@@ -91,35 +94,63 @@ int main(void) {
   int proxy_port = config["proxy_port"].as<int>();
   int sync_interval = config["sync_interval"].as<int>();
   int inactivity_time = config["inactivity_time"].as<int>();
-
-  auto mobilityd_client = std::make_unique<magma::lte::AsyncMobilitydClient>();
-  std::thread mobilitydd_response_handling_thread([&]() {
-    MLOG(MINFO) << "Started MobilityD response thread";
-    mobilityd_client->rpc_response_loop();
-  });
+  // The packet ring capture spreads the packets over capture_workers threads
+  bool packet_ring = config["capture_mode"].IsDefined() &&
+                     config["capture_mode"].as<std::string>() == "tpacket_v3";
+  int capture_workers = 1;
+  if (packet_ring && config["capture_workers"].IsDefined()) {
+    capture_workers = std::max(config["capture_workers"].as<int>(), 1);
+  }
 
   magma::service303::MagmaService server(LIAGENTD, LIAGENTD_VERSION);
   server.Start();
 
-  auto proxy_connector = std::make_unique<magma::lte::ProxyConnectorImpl>(
-      proxy_addr, proxy_port, cert_file, key_file);
-  if (proxy_connector->setup_proxy_socket() < 0) {
-    MLOG(MERROR) << "Coudn't setup proxy socket, terminating";
-    return -1;
+  // Each capture worker has its own connection to mobilityd and to the proxy,
+  // the records of an intercept are numbered across the workers
+  auto sequences = std::make_shared<magma::lte::InterceptSequences>();
+  std::vector<std::unique_ptr<magma::lte::PDUGenerator>> pkt_generators;
+  std::vector<std::thread> mobilityd_response_handling_threads;
+  for (int i = 0; i < capture_workers; i++) {
+    auto mobilityd_client =
+        std::make_unique<magma::lte::AsyncMobilitydClient>();
+    auto* mobilityd_receiver = mobilityd_client.get();
+    mobilityd_response_handling_threads.emplace_back([mobilityd_receiver]() {
+      MLOG(MINFO) << "Started MobilityD response thread";
+      mobilityd_receiver->rpc_response_loop();
+    });
+
+    auto proxy_connector = std::make_unique<magma::lte::ProxyConnectorImpl>(
+        proxy_addr, proxy_port, cert_file, key_file);
+    if (proxy_connector->setup_proxy_socket() < 0) {
+      MLOG(MERROR) << "Coudn't setup proxy socket, terminating";
+      return -1;
+    }
+
+    pkt_generators.push_back(std::make_unique<magma::lte::PDUGenerator>(
+        pkt_dst_mac, pkt_src_mac, sync_interval, inactivity_time,
+        std::move(proxy_connector), std::move(mobilityd_client), mconfig,
+        sequences));
   }
 
-  auto pkt_generator = std::make_unique<magma::lte::PDUGenerator>(
-      pkt_dst_mac, pkt_src_mac, sync_interval, inactivity_time,
-      std::move(proxy_connector), std::move(mobilityd_client), mconfig);
-
-  auto interface_watcher = std::make_unique<magma::lte::InterfaceMonitor>(
-      interface_name, std::move(pkt_generator));
-  if (interface_watcher->init_interface_monitor() < 0) {
-    MLOG(MERROR) << "Coudn't setup interface sniffing, terminating";
-    return -1;
+  int ret;
+  if (packet_ring) {
+    auto interface_watcher = std::make_unique<magma::lte::PacketRingMonitor>(
+        interface_name, std::move(pkt_generators));
+    if (interface_watcher->init_interface_monitor() < 0) {
+      MLOG(MERROR) << "Coudn't setup interface sniffing, terminating";
+      return -1;
+    }
+    ret = interface_watcher->start_capture();
+  } else {
+    auto interface_watcher = std::make_unique<magma::lte::InterfaceMonitor>(
+        interface_name, std::move(pkt_generators[0]));
+    if (interface_watcher->init_interface_monitor() < 0) {
+      MLOG(MERROR) << "Coudn't setup interface sniffing, terminating";
+      return -1;
+    }
+    ret = interface_watcher->start_capture();
   }
-
-  if (interface_watcher->start_capture() < 0) {
+  if (ret < 0) {
     MLOG(MERROR) << "Coudn't start interface sniffing, terminating";
     return -1;
   }
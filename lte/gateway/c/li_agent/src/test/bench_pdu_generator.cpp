@@ -0,0 +1,234 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Replays the packets of a pcap file through the PDUGenerator, with all the
+// IPs resolved to an intercepted subscriber, and exports the x3 records over
+// TLS to a local sink. Reports the packets processed per second and the
+// number of TLS writes. The certificate and key are used by both ends.
+// Usage: bench_pdu_generator pcap_file cert_file key_file [iterations]
+
+#include <arpa/inet.h>
+#include <grpcpp/impl/codegen/status.h>
+#include <lte/protos/subscriberdb.pb.h>
+#include <netinet/in.h>
+#include <openssl/err.h>
+#include <openssl/ssl.h>
+#include <pcap.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <chrono>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "lte/gateway/c/li_agent/src/MobilitydClient.hpp"
+#include "lte/gateway/c/li_agent/src/PDUGenerator.hpp"
+#include "lte/gateway/c/li_agent/src/ProxyConnector.hpp"
+#include "lte/gateway/c/li_agent/src/Utilities.hpp"
+
+namespace magma {
+namespace lte {
+
+#define BENCH_TARGET_ID "IMSI001010000000001"
+#define BENCH_TASK_ID "29f28e1c-f230-486a-a860-f5a784ab9177"
+
+typedef struct {
+  struct pcap_pkthdr phdr;
+  std::vector<u_char> pdata;
+} Packet;
+
+// Resolves every IP to the intercepted subscriber without waiting
+class BenchMobilitydClient : public MobilitydClient {
+ public:
+  void get_subscriber_id_from_ip(
+      const struct in_addr& addr,
+      std::function<void(grpc::Status, SubscriberID)> callback) override {
+    SubscriberID response;
+    response.set_id(BENCH_TARGET_ID);
+    callback(grpc::Status::OK, response);
+  }
+};
+
+// Counts the bytes and TLS writes received by the sink
+class CountingProxyConnector : public ProxyConnector {
+ public:
+  explicit CountingProxyConnector(std::unique_ptr<ProxyConnector> connector)
+      : connector_(std::move(connector)), writes(0) {}
+
+  int send_data(void* data, uint32_t size) override {
+    writes++;
+    return connector_->send_data(data, size);
+  }
+  int setup_proxy_socket() override { return connector_->setup_proxy_socket(); }
+  void cleanup() override { connector_->cleanup(); }
+
+  std::unique_ptr<ProxyConnector> connector_;
+  uint64_t writes;
+};
+
+static bool load_packets(const char* pcap_file, std::vector<Packet>* packets) {
+  char errbuf[PCAP_ERRBUF_SIZE];
+  pcap_t* pcap = pcap_open_offline(pcap_file, errbuf);
+  if (pcap == nullptr) {
+    fprintf(stderr, "Could not open %s: %s\n", pcap_file, errbuf);
+    return false;
+  }
+  struct pcap_pkthdr* phdr;
+  const u_char* pdata;
+  while (pcap_next_ex(pcap, &phdr, &pdata) == 1) {
+    Packet packet;
+    packet.phdr = *phdr;
+    packet.pdata.assign(pdata, pdata + phdr->caplen);
+    packets->push_back(std::move(packet));
+  }
+  pcap_close(pcap);
+  return !packets->empty();
+}
+
+// Accepts a single TLS connection on listen_fd and reads until it is closed
+static void run_sink(int listen_fd, SSL_CTX* ctx, uint64_t* received) {
+  int fd = accept(listen_fd, nullptr, nullptr);
+  if (fd < 0) {
+    return;
+  }
+  SSL* ssl = SSL_new(ctx);
+  SSL_set_fd(ssl, fd);
+  if (SSL_accept(ssl) == 1) {
+    char buf[16384];
+    int ret;
+    while ((ret = SSL_read(ssl, buf, sizeof(buf))) > 0) {
+      *received += ret;
+    }
+  } else {
+    ERR_print_errors_fp(stderr);
+  }
+  SSL_free(ssl);
+  close(fd);
+}
+
+static int listen_sink(int* port) {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  struct sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t addr_len = sizeof(addr);
+  if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 ||
+      listen(fd, 1) != 0 ||
+      getsockname(fd, (struct sockaddr*)&addr, &addr_len) != 0) {
+    close(fd);
+    return -1;
+  }
+  *port = ntohs(addr.sin_port);
+  return fd;
+}
+
+static SSL_CTX* create_sink_ctx(const std::string& cert_file,
+                                const std::string& key_file) {
+  SSL_CTX* ctx = SSL_CTX_new(TLS_server_method());
+  if (ctx == nullptr ||
+      SSL_CTX_use_certificate_file(ctx, cert_file.c_str(), SSL_FILETYPE_PEM) <=
+          0 ||
+      SSL_CTX_use_PrivateKey_file(ctx, key_file.c_str(), SSL_FILETYPE_PEM) <=
+          0) {
+    ERR_print_errors_fp(stderr);
+    SSL_CTX_free(ctx);
+    return nullptr;
+  }
+  return ctx;
+}
+
+static int run(const std::vector<Packet>& packets, const std::string& cert_file,
+               const std::string& key_file, int iterations) {
+  SSL_library_init();
+  SSL_CTX* sink_ctx = create_sink_ctx(cert_file, key_file);
+  int port;
+  int listen_fd = listen_sink(&port);
+  if (sink_ctx == nullptr || listen_fd < 0) {
+    fprintf(stderr, "Could not start the TLS sink\n");
+    return 1;
+  }
+  uint64_t received = 0;
+  std::thread sink(run_sink, listen_fd, sink_ctx, &received);
+
+  std::string proxy_addr = "127.0.0.1";
+  auto connector = std::make_unique<CountingProxyConnector>(
+      std::make_unique<ProxyConnectorImpl>(proxy_addr, port, cert_file,
+                                           key_file));
+  auto* counting_connector = connector.get();
+  if (connector->setup_proxy_socket() < 0) {
+    fprintf(stderr, "Could not connect to the TLS sink\n");
+    return 1;
+  }
+
+  auto mconfig = get_default_mconfig();
+  auto* task = mconfig.add_nprobe_tasks();
+  task->set_task_id(BENCH_TASK_ID);
+  task->set_target_id(BENCH_TARGET_ID);
+  int sync_time = std::numeric_limits<int>::max();  // Prevent sync
+  PDUGenerator pkt_generator("", "", sync_time, sync_time,
+                             std::move(connector),
+                             std::make_unique<BenchMobilitydClient>(),
+                             mconfig);
+
+  uint64_t exported = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; i++) {
+    for (const auto& packet : packets) {
+      exported += pkt_generator.process_packet(&packet.phdr,
+                                               packet.pdata.data());
+      pkt_generator.process_resolved_lookups();
+    }
+  }
+  pkt_generator.flush_records();
+  std::chrono::duration<double> secs = std::chrono::steady_clock::now() - start;
+
+  uint64_t writes = counting_connector->writes;
+  counting_connector->cleanup();
+  sink.join();
+  close(listen_fd);
+  SSL_CTX_free(sink_ctx);
+
+  uint64_t num_packets = packets.size() * (uint64_t)iterations;
+  printf("packets=%lu exported=%lu writes=%lu bytes=%lu time=%.3fs "
+         "rate=%.0fpps\n",
+         num_packets, exported, writes, received, secs.count(),
+         num_packets / secs.count());
+  return 0;
+}
+
+}  // namespace lte
+}  // namespace magma
+
+int main(int argc, char** argv) {
+  if (argc < 4) {
+    fprintf(stderr,
+            "Usage: %s pcap_file cert_file key_file [iterations]\n", argv[0]);
+    return 1;
+  }
+  std::string cert_file = argv[2];
+  std::string key_file = argv[3];
+  int iterations = argc > 4 ? atoi(argv[4]) : 10;
+
+  std::vector<magma::lte::Packet> packets;
+  if (!magma::lte::load_packets(argv[1], &packets)) {
+    return 1;
+  }
+  return magma::lte::run(packets, cert_file, key_file, iterations);
+}
@@ -11,6 +11,7 @@
  * limitations under the License.
  */
 
+#include <endian.h>
 #include <gmock/gmock.h>
 #include <grpcpp/impl/codegen/status.h>
 #include <grpcpp/impl/codegen/status_code_enum.h>
@@ -21,12 +22,15 @@
 #include <netinet/ip.h>
 #include <pcap.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/time.h>
 #include <sys/types.h>
+#include <functional>
 #include <limits>
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "lte/gateway/c/li_agent/src/PDUGenerator.hpp"
 #include "lte/gateway/c/li_agent/src/test/Consts.hpp"
@@ -55,15 +59,35 @@ class PDUGeneratorTest : public ::testing::Test {
         std::move(proxy_connector_p), std::move(mobilityd_client_p), mconfig);
   }
 
+  // Builds an IP packet from the subscriber at src_ip
+  void build_ip_packet(uint32_t src_ip, uint32_t dst_ip) {
+    pkt_len = sizeof(struct ether_header) + sizeof(struct ip);
+    memset(&phdr, 0, sizeof(phdr));
+    phdr.len = pkt_len;
+    phdr.caplen = pkt_len;
+    phdr.ts.tv_sec = 56;
+    pdata = std::make_unique<u_char[]>(pkt_len);
+    struct ether_header* ethernetHeader = (struct ether_header*)pdata.get();
+    ethernetHeader->ether_type = htons(ETHERTYPE_IP);
+    struct ip* ipHeader =
+        (struct ip*)(pdata.get() + sizeof(struct ether_header));
+    ipHeader->ip_src.s_addr = src_ip;
+    ipHeader->ip_dst.s_addr = dst_ip;
+  }
+
   MockProxyConnector* proxy_connector;
   MockMobilitydClient* mobilityd_client;
   std::unique_ptr<PDUGenerator> pkt_generator;
+  struct pcap_pkthdr phdr;
+  std::unique_ptr<u_char[]> pdata;
+  uint32_t pkt_len;
 };
 
 TEST_F(PDUGeneratorTest, test_pdu_generator) {
   struct pcap_pkthdr* phdr =
       (struct pcap_pkthdr*)malloc(sizeof(struct pcap_pkthdr));
   phdr->len = sizeof(struct ether_header) + sizeof(struct ip);
+  phdr->caplen = phdr->len;
   phdr->ts.tv_sec = 56;
   u_char* pdata = reinterpret_cast<u_char*>(
       malloc(sizeof(struct ether_header) + sizeof(struct ip)));
@@ -86,6 +110,7 @@ TEST_F(PDUGeneratorTest, test_pdu_generator) {
 
   auto succeeded = pkt_generator->process_packet(phdr, pdata);
   EXPECT_TRUE(succeeded);
+  EXPECT_TRUE(pkt_generator->flush_records());
   free(pdata);
   free(phdr);
 }
@@ -130,5 +155,135 @@ TEST_F(PDUGeneratorTest, test_generator_non_ip_packet) {
   free(pdata);
   free(phdr);
 }
+
+TEST_F(PDUGeneratorTest, test_generator_async_lookup) {
+  build_ip_packet(3232235522, 3232235521);
+  std::vector<std::function<void(grpc::Status, SubscriberID)>> callbacks;
+  EXPECT_CALL(*mobilityd_client,
+              get_subscriber_id_from_ip(testing::_, testing::_))
+      .Times(2)
+      .WillRepeatedly(testing::Invoke(
+          [&callbacks](const struct in_addr& addr,
+                       std::function<void(grpc::Status, SubscriberID)> cb) {
+            callbacks.push_back(cb);
+          }));
+  EXPECT_CALL(*proxy_connector, send_data(testing::_, testing::_)).Times(0);
+
+  // Packets are queued without waiting for mobilityd, and looked up once
+  EXPECT_FALSE(pkt_generator->process_packet(&phdr, pdata.get()));
+  EXPECT_FALSE(pkt_generator->process_packet(&phdr, pdata.get()));
+  pkt_generator->process_resolved_lookups();
+  ASSERT_EQ(callbacks.size(), 2);
+  testing::Mock::VerifyAndClearExpectations(proxy_connector);
+
+  SubscriberID response;
+  response.set_id("12345");
+  callbacks[0](grpc::Status::OK, response);
+  callbacks[1](grpc::Status(grpc::NOT_FOUND, "not found"), SubscriberID());
+
+  // The queued packets and the next one are exported in a single write
+  uint32_t record_len = sizeof(X3Header) + sizeof(struct ip);
+  EXPECT_CALL(*proxy_connector, send_data(testing::_, 3 * record_len))
+      .Times(1)
+      .WillOnce(testing::Return(3 * record_len));
+  pkt_generator->process_resolved_lookups();
+
+  // The subscriber is now cached
+  EXPECT_TRUE(pkt_generator->process_packet(&phdr, pdata.get()));
+  EXPECT_TRUE(pkt_generator->flush_records());
+}
+
+TEST_F(PDUGeneratorTest, test_generator_negative_cache) {
+  build_ip_packet(3232235522, 3232235521);
+
+  // The source and destination IPs are looked up once, the next packets of
+  // the flow hit the cache
+  SubscriberID response;
+  EXPECT_CALL(*mobilityd_client,
+              get_subscriber_id_from_ip(testing::_, testing::_))
+      .Times(2)
+      .WillRepeatedly(testing::InvokeArgument<1>(
+          grpc::Status(grpc::NOT_FOUND, "not found"), response));
+  EXPECT_CALL(*proxy_connector, send_data(testing::_, testing::_)).Times(0);
+
+  for (int i = 0; i < 10; i++) {
+    EXPECT_FALSE(pkt_generator->process_packet(&phdr, pdata.get()));
+  }
+  EXPECT_TRUE(pkt_generator->flush_records());
+}
+
+TEST_F(PDUGeneratorTest, test_generator_export_batching) {
+  build_ip_packet(3232235522, 3232235521);
+  SubscriberID response;
+  response.set_id("12345");
+  EXPECT_CALL(*mobilityd_client,
+              get_subscriber_id_from_ip(testing::_, testing::_))
+      .WillRepeatedly(testing::InvokeArgument<1>(grpc::Status::OK, response));
+
+  // Records captured within the batching delay are exported together
+  uint32_t record_len = sizeof(X3Header) + sizeof(struct ip);
+  EXPECT_CALL(*proxy_connector, send_data(testing::_, 3 * record_len))
+      .Times(1)
+      .WillOnce(testing::Return(3 * record_len));
+  for (int i = 0; i < 3; i++) {
+    phdr.ts.tv_usec = i * 400;
+    EXPECT_TRUE(pkt_generator->process_packet(&phdr, pdata.get()));
+  }
+  phdr.ts.tv_usec = 1200;
+  EXPECT_TRUE(pkt_generator->process_packet(&phdr, pdata.get()));
+  testing::Mock::VerifyAndClearExpectations(proxy_connector);
+
+  // Failed writes are retried after reconnecting to the proxy
+  EXPECT_CALL(*proxy_connector, send_data(testing::_, record_len))
+      .Times(2)
+      .WillOnce(testing::Return(-1))
+      .WillOnce(testing::Return(record_len));
+  EXPECT_CALL(*proxy_connector, cleanup()).Times(1);
+  EXPECT_CALL(*proxy_connector, setup_proxy_socket())
+      .Times(1)
+      .WillOnce(testing::Return(0));
+  EXPECT_TRUE(pkt_generator->flush_records());
+  EXPECT_TRUE(pkt_generator->flush_records());
+}
+
+TEST_F(PDUGeneratorTest, test_generator_shared_sequence_numbers) {
+  build_ip_packet(3232235522, 3232235521);
+  SubscriberID response;
+  response.set_id("12345");
+  auto sequences = std::make_shared<InterceptSequences>();
+  std::vector<uint64_t> sequence_numbers;
+  auto record_sequence_number = [&sequence_numbers](void* data,
+                                                    uint32_t size) {
+    auto* pdu = reinterpret_cast<X3Header*>(data);
+    sequence_numbers.push_back(be64toh(pdu->attrs.sequence_number.data));
+    return static_cast<int>(size);
+  };
+
+  // Two capture workers receiving flows of the same subscriber
+  std::vector<std::unique_ptr<PDUGenerator>> workers;
+  for (int i = 0; i < 2; i++) {
+    auto proxy_connector_p = std::make_unique<MockProxyConnector>();
+    EXPECT_CALL(*proxy_connector_p, send_data(testing::_, testing::_))
+        .WillRepeatedly(testing::Invoke(record_sequence_number));
+    auto mobilityd_client_p = std::make_unique<MockMobilitydClient>();
+    EXPECT_CALL(*mobilityd_client_p,
+                get_subscriber_id_from_ip(testing::_, testing::_))
+        .WillRepeatedly(testing::InvokeArgument<1>(grpc::Status::OK, response));
+    int sync_time = std::numeric_limits<int>::max();
+    workers.push_back(std::make_unique<PDUGenerator>(
+        PKT_DST_MAC, PKT_SRC_MAC, sync_time, sync_time,
+        std::move(proxy_connector_p), std::move(mobilityd_client_p),
+        create_liagentd_mconfig("29f28e1c-f230-486a-a860-f5a784ab9177",
+                                "IMSI12345"),
+        sequences));
+  }
+
+  // The records are numbered in a single sequence across the workers
+  for (int i = 0; i < 4; i++) {
+    EXPECT_TRUE(workers[i % 2]->process_packet(&phdr, pdata.get()));
+    EXPECT_TRUE(workers[i % 2]->flush_records());
+  }
+  EXPECT_EQ(sequence_numbers, std::vector<uint64_t>({0, 1, 2, 3}));
+}
 }  // namespace lte
 }  // namespace magma
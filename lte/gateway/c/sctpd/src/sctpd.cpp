@@ -31,6 +31,7 @@
 #include "lte/gateway/c/sctpd/src/sctpd_downlink_impl.hpp"
 #include "lte/gateway/c/sctpd/src/sctpd_event_handler.hpp"
 #include "lte/gateway/c/sctpd/src/sctpd_uplink_client.hpp"
+#include "lte/gateway/c/sctpd/src/sctpd_uplink_stream_client.hpp"
 #include "orc8r/gateway/c/common/config/MConfigLoader.hpp"
 #include "orc8r/gateway/c/common/config/ServiceConfigLoader.hpp"
 #include "orc8r/gateway/c/common/logging/magma_logging.hpp"
@@ -45,6 +46,8 @@ using grpc::ServerBuilder;
 using magma::sctpd::SctpdDownlinkImpl;
 using magma::sctpd::SctpdEventHandler;
 using magma::sctpd::SctpdUplinkClient;
+using magma::sctpd::SctpdUplinkStreamClient;
+using magma::sctpd::UplinkStreamConfig;
 
 int signalMask(void) {
   sigset_t set;
@@ -116,6 +119,31 @@ static uint32_t get_log_verbosity(const YAML::Node& config,
   }
 }
 
+static std::unique_ptr<SctpdUplinkClient> create_uplink_client(
+    const YAML::Node& config, std::shared_ptr<grpc::Channel> channel) {
+  if (!config["uplink_stream_mode"].IsDefined() ||
+      !config["uplink_stream_mode"].as<bool>()) {
+    return std::make_unique<SctpdUplinkClient>(channel);
+  }
+
+  UplinkStreamConfig stream_config;
+  if (config["uplink_max_batch_size"].IsDefined()) {
+    stream_config.max_batch_size =
+        config["uplink_max_batch_size"].as<uint32_t>();
+  }
+  if (config["uplink_max_inflight_batches"].IsDefined()) {
+    stream_config.max_inflight_batches =
+        config["uplink_max_inflight_batches"].as<uint32_t>();
+  }
+  if (config["uplink_max_queue_size"].IsDefined()) {
+    stream_config.max_queue_size =
+        config["uplink_max_queue_size"].as<uint32_t>();
+  }
+  MLOG(MINFO) << "Relaying uplink over SendUlStream, max batch size "
+              << std::to_string(stream_config.max_batch_size);
+  return std::make_unique<SctpdUplinkStreamClient>(channel, stream_config);
+}
+
 int main() {
   signalMask();
 
@@ -130,8 +158,8 @@ int main() {
   auto channel =
       grpc::CreateChannel(UPSTREAM_SOCK, grpc::InsecureChannelCredentials());
 
-  SctpdUplinkClient client(channel);
-  SctpdEventHandler handler(client);
+  auto client = create_uplink_client(config, channel);
+  SctpdEventHandler handler(*client);
   SctpdDownlinkImpl service(handler);
 
   ServerBuilder builder;
@@ -80,19 +80,47 @@ Status SctpdDownlinkImpl::SendDl(ServerContext* context, const SendDlReq* req,
                                  SendDlRes* res) {
   MLOG(MDEBUG) << "SctpdDownlinkImpl::SendDl starting";
 
+  res->set_result(send_dl(*req));
+  return Status::OK;
+}
+
+Status SctpdDownlinkImpl::SendDlStream(
+    ServerContext* context,
+    ServerReaderWriter<SendDlBatchRes, SendDlBatchReq>* stream) {
+  MLOG(MINFO) << "SctpdDownlinkImpl::SendDlStream starting";
+
+  SendDlBatchReq batch;
+  SendDlBatchRes ack;
+  // Batches are read one at a time so a slow sctp send applies backpressure
+  // to the MME through grpc flow control
+  while (stream->Read(&batch)) {
+    ack.Clear();
+    ack.set_seq(batch.seq());
+    for (const auto& msg : batch.msgs()) {
+      ack.add_results()->set_result(send_dl(msg));
+    }
+    if (!stream->Write(ack)) {
+      MLOG(MERROR) << "SctpdDownlinkImpl::SendDlStream ack write failed";
+      break;
+    }
+  }
+
+  MLOG(MINFO) << "SctpdDownlinkImpl::SendDlStream closed";
+  return Status::OK;
+}
+
+SendDlRes::SendDlResult SctpdDownlinkImpl::send_dl(const SendDlReq& req) {
   try {
-    if (req->ppid() == S1AP)
-      _sctp_4G_connection->Send(req->assoc_id(), req->stream(), req->payload());
+    if (req.ppid() == S1AP)
+      _sctp_4G_connection->Send(req.assoc_id(), req.stream(), req.payload());
     else
-      _sctp_5G_connection->Send(req->assoc_id(), req->stream(), req->payload());
+      _sctp_5G_connection->Send(req.assoc_id(), req.stream(), req.payload());
 
   } catch (...) {
-    res->set_result(SendDlRes::SEND_DL_FAIL);
-    return Status::OK;
+    return SendDlRes::SEND_DL_FAIL;
   }
 
-  res->set_result(SendDlRes::SEND_DL_OK);
-  return Status::OK;
+  return SendDlRes::SEND_DL_OK;
 }
 
 void SctpdDownlinkImpl::stop() {
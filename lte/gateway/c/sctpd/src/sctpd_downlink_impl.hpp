@@ -29,6 +29,8 @@ namespace magma {
 namespace sctpd {
 class InitReq;
 class InitRes;
+class SendDlBatchReq;
+class SendDlBatchRes;
 class SendDlReq;
 class SendDlRes;
 }  // namespace sctpd
@@ -41,6 +43,7 @@ namespace magma {
 namespace sctpd {
 
 using grpc::ServerContext;
+using grpc::ServerReaderWriter;
 using grpc::Status;
 
 // Implements the sctpd downlink server
@@ -58,6 +61,12 @@ class SctpdDownlinkImpl final : public SctpdDownlink::Service {
   Status SendDl(ServerContext* context, const SendDlReq* request,
                 SendDlRes* response) override;
 
+  // Implementation of SctpdDownlink.SendDlStream method (see sctpd.proto for
+  // more info)
+  Status SendDlStream(
+      ServerContext* context,
+      ServerReaderWriter<SendDlBatchRes, SendDlBatchReq>* stream) override;
+
   // Implementation of SctpdDownlink.create_sctp_connection method
   //(creates 4G/5G sctp connection)
   Status create_sctp_connection(
@@ -68,6 +77,9 @@ class SctpdDownlinkImpl final : public SctpdDownlink::Service {
   void stop();
 
  private:
+  // Send a single downlink packet on the 4G/5G sctp connection
+  SendDlRes::SendDlResult send_dl(const SendDlReq& req);
+
   SctpEventHandler& _uplink_handler;
   std::unique_ptr<SctpConnection> _sctp_4G_connection;
   std::unique_ptr<SctpConnection> _sctp_5G_connection;
@@ -0,0 +1,260 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "lte/gateway/c/sctpd/src/sctpd_uplink_stream_client.hpp"
+
+#include <assert.h>
+#include <glog/logging.h>
+#include <grpcpp/impl/codegen/client_context.h>
+#include <grpcpp/impl/codegen/status.h>
+#include <chrono>
+#include <ostream>
+#include <string>
+
+#include "lte/gateway/c/sctpd/src/util.hpp"
+#include "orc8r/gateway/c/common/logging/magma_logging.hpp"
+
+namespace magma {
+namespace sctpd {
+
+using grpc::ClientContext;
+using grpc::ClientReaderWriter;
+
+// Delay before reopening the stream after it broke
+const std::chrono::milliseconds STREAM_RETRY_DELAY(100);
+
+SctpdUplinkStreamClient::SctpdUplinkStreamClient(
+    std::shared_ptr<Channel> channel, const UplinkStreamConfig& config)
+    : SctpdUplinkClient(channel),
+      _config(config),
+      _pending(0),
+      _next_seq(0),
+      _stream_broken(false),
+      _done(false),
+      _context(nullptr) {
+  assert(_config.max_batch_size > 0);
+  assert(_config.max_inflight_batches > 0);
+  assert(_config.max_queue_size > 0);
+  _stream_stub = SctpdUplink::NewStub(channel);
+  _thread = std::make_unique<std::thread>(&SctpdUplinkStreamClient::run, this);
+}
+
+SctpdUplinkStreamClient::~SctpdUplinkStreamClient() { stop(); }
+
+int SctpdUplinkStreamClient::sendUl(const SendUlReq& req, SendUlRes* res) {
+  assert(res != nullptr);
+
+  std::unique_lock<std::mutex> lock(_mutex);
+  bool queued = _cv.wait_for(
+      lock, std::chrono::milliseconds(_config.queue_timeout_ms), [this] {
+        return _done || _queue.size() < _config.max_queue_size;
+      });
+  if (_done) {
+    MLOG(MERROR) << "sctpul.sendul error: uplink stream stopped";
+    return -1;
+  }
+  if (!queued) {
+    MLOG(MERROR) << "sctpul.sendul error: uplink queue full, dropping packet";
+    return -1;
+  }
+  _queue.push_back(req);
+  _cv.notify_all();
+  res->Clear();
+  return 0;
+}
+
+int SctpdUplinkStreamClient::closeAssoc(const CloseAssocReq& req,
+                                        CloseAssocRes* res) {
+  if (!flush()) {
+    MLOG(MERROR) << "sctpul.closeassoc: uplink packets still pending, "
+                 << "closing association " << std::to_string(req.assoc_id());
+  }
+  return SctpdUplinkClient::closeAssoc(req, res);
+}
+
+bool SctpdUplinkStreamClient::flush() {
+  std::unique_lock<std::mutex> lock(_mutex);
+  return _cv.wait_for(lock,
+                      std::chrono::milliseconds(_config.flush_timeout_ms),
+                      [this] { return _queue.empty() && _pending == 0; });
+}
+
+void SctpdUplinkStreamClient::stop() {
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_done) return;
+  }
+  flush();
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _done = true;
+    if (_context != nullptr) {
+      _context->TryCancel();
+    }
+    _cv.notify_all();
+  }
+  _thread->join();
+}
+
+void SctpdUplinkStreamClient::run() {
+  while (true) {
+    ClientContext context;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if (_done) break;
+      _context = &context;
+    }
+    auto stream = _stream_stub->SendUlStream(&context);
+    std::thread reader(&SctpdUplinkStreamClient::read_acks, this,
+                       stream.get());
+
+    bool ok = run_stream(stream.get());
+
+    stream->WritesDone();
+    reader.join();
+    auto status = stream->Finish();
+    bool stopping;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _context = nullptr;
+      stopping = _done;
+    }
+    // stop cancels the stream once flushed
+    if (!status.ok() &&
+        !(stopping && status.error_code() == grpc::StatusCode::CANCELLED)) {
+      MLOG(MERROR) << "sctpul.sendulstream error";
+      MLOG_grpcerr(status);
+    }
+
+    resend_unacked();
+
+    if (!ok) {
+      std::this_thread::sleep_for(STREAM_RETRY_DELAY);
+    }
+  }
+  drop_pending();
+}
+
+bool SctpdUplinkStreamClient::run_stream(
+    ClientReaderWriter<SendUlBatchReq, SendUlBatchRes>* stream) {
+  SendUlBatchReq batch;
+
+  while (next_batch(&batch)) {
+    if (!stream->Write(batch)) {
+      // The batch stays unacked and is resent with the ones written before
+      MLOG(MERROR) << "sctpul.sendulstream write failed on batch "
+                   << std::to_string(batch.seq());
+      return false;
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  // Stopping, stop already waited for the acks until its flush timed out
+  return !_stream_broken;
+}
+
+void SctpdUplinkStreamClient::read_acks(
+    ClientReaderWriter<SendUlBatchReq, SendUlBatchRes>* stream) {
+  SendUlBatchRes ack;
+
+  while (stream->Read(&ack)) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    while (!_unacked.empty() && _unacked.front().seq() <= ack.seq()) {
+      _pending -= _unacked.front().msgs_size();
+      _unacked.pop_front();
+    }
+    _cv.notify_all();
+  }
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  _stream_broken = true;
+  _cv.notify_all();
+}
+
+bool SctpdUplinkStreamClient::next_batch(SendUlBatchReq* batch) {
+  std::unique_lock<std::mutex> lock(_mutex);
+  _cv.wait(lock, [this] {
+    return _stream_broken || _done ||
+           (!_queue.empty() &&
+            _unacked.size() < _config.max_inflight_batches);
+  });
+  if (_stream_broken || _done) return false;
+
+  batch->Clear();
+  batch->set_seq(_next_seq++);
+  while (!_queue.empty() &&
+         static_cast<uint32_t>(batch->msgs_size()) < _config.max_batch_size) {
+    *batch->add_msgs() = std::move(_queue.front());
+    _queue.pop_front();
+  }
+  _pending += batch->msgs_size();
+  _unacked.push_back(*batch);
+  // Wake up callers blocked on a full queue
+  _cv.notify_all();
+  return true;
+}
+
+void SctpdUplinkStreamClient::resend_unacked() {
+  std::deque<SendUlBatchReq> unacked;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    unacked.swap(_unacked);
+    _stream_broken = false;
+  }
+  if (unacked.empty()) return;
+
+  // The MME may have relayed a batch whose ack was lost with the stream, a
+  // duplicate is preferred to a gap in the per association order. Once the
+  // MME is found unreachable, or the client stops, the rest is dropped
+  // rather than waiting for each SendUl to time out.
+  uint32_t resent = 0;
+  uint32_t dropped = 0;
+  bool failed = false;
+  for (const auto& batch : unacked) {
+    for (const auto& msg : batch.msgs()) {
+      if (!failed) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        failed = _done;
+      }
+      SendUlRes res;
+      if (!failed && SctpdUplinkClient::sendUl(msg, &res) == 0) {
+        resent++;
+      } else {
+        failed = true;
+        dropped++;
+      }
+    }
+  }
+  MLOG(MERROR) << "sctpul.sendulstream broke, resent " << std::to_string(resent)
+               << " unacked messages over SendUl, dropped "
+               << std::to_string(dropped);
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  _pending -= resent + dropped;
+  _cv.notify_all();
+}
+
+void SctpdUplinkStreamClient::drop_pending() {
+  std::lock_guard<std::mutex> lock(_mutex);
+  uint32_t dropped = _queue.size() + _pending;
+  _queue.clear();
+  _unacked.clear();
+  _pending = 0;
+  _cv.notify_all();
+  if (dropped > 0) {
+    MLOG(MERROR) << "sctpul.sendulstream stopped, dropped "
+                 << std::to_string(dropped) << " pending messages";
+  }
+}
+
+}  // namespace sctpd
+}  // namespace magma
@@ -0,0 +1,116 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <grpcpp/grpcpp.h>
+#include <lte/protos/sctpd.grpc.pb.h>
+#include <stdint.h>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "lte/gateway/c/sctpd/src/sctpd_uplink_client.hpp"
+
+namespace magma {
+namespace sctpd {
+
+// Tunables for the streaming uplink transport
+struct UplinkStreamConfig {
+  // Max number of uplink packets coalesced into a single SendUlBatchReq
+  uint32_t max_batch_size = 64;
+  // Max number of batches written to the stream but not yet acknowledged
+  uint32_t max_inflight_batches = 8;
+  // Max number of uplink packets queued before sendUl blocks the caller
+  uint32_t max_queue_size = 4096;
+  // Max time sendUl blocks on a full queue before failing the packet
+  uint32_t queue_timeout_ms = 2000;
+  // Max time flush waits for the queued packets to be acknowledged
+  uint32_t flush_timeout_ms = 2000;
+};
+
+// Grpc uplink client relaying uplink packets to MME over a long-lived
+// SendUlStream. sendUl only queues the packet; a writer thread coalesces
+// queued packets into batches in receive order, which preserves the per
+// association and per stream ordering of the unary client. When the queue or
+// the window of unacknowledged batches is full sendUl blocks, which stops the
+// sctp listener from reading and lets sctp flow control push back on the eNB.
+// No wait is unbounded, packets that cannot be relayed in time are dropped
+// and logged.
+class SctpdUplinkStreamClient : public SctpdUplinkClient {
+ public:
+  // Construct SctpdUplinkStreamClient with the specified channel and config
+  SctpdUplinkStreamClient(std::shared_ptr<Channel> channel,
+                          const UplinkStreamConfig& config);
+  ~SctpdUplinkStreamClient();
+
+  // Queue an uplink packet for MME (see sctpd.proto for more info). Returns 0
+  // once the packet is queued; res is cleared as SendUlRes carries no result.
+  // Returns -1 if the queue stayed full for queue_timeout_ms or if stopped.
+  int sendUl(const SendUlReq& req, SendUlRes* res) override;
+  // Flush queued uplink packets, then notify MME of closing/reseting
+  // association so that no packet of the association trails the close
+  int closeAssoc(const CloseAssocReq& req, CloseAssocRes* res) override;
+
+  // Block until every queued packet has been acknowledged or resent, for at
+  // most flush_timeout_ms. Returns false if packets are still pending.
+  bool flush();
+  // Flush and stop the writer thread, the packets still pending are dropped
+  // and further sendUl calls fail
+  void stop();
+
+ private:
+  // Writer loop run in separate thread, (re)opens the stream as needed
+  void run();
+  // Write batches on an open stream until it breaks or the client stops
+  bool run_stream(
+      grpc::ClientReaderWriter<SendUlBatchReq, SendUlBatchRes>* stream);
+  // Ack loop reading SendUlBatchRes off the stream
+  void read_acks(
+      grpc::ClientReaderWriter<SendUlBatchReq, SendUlBatchRes>* stream);
+  // Pop up to max_batch_size queued packets into batch, blocking until
+  // at least one packet is queued. Returns false when stopping.
+  bool next_batch(SendUlBatchReq* batch);
+  // Relay the batches left unacknowledged by a broken stream over unary
+  // SendUl calls, in order, before any packet still queued. Once a SendUl
+  // fails or the client stops, the remaining packets are dropped.
+  void resend_unacked();
+  // Drop the packets still queued or unacknowledged once stopped
+  void drop_pending();
+
+  UplinkStreamConfig _config;
+  std::unique_ptr<SctpdUplink::Stub> _stream_stub;
+
+  std::mutex _mutex;
+  // Signalled when packets are queued, acked or the client stops
+  std::condition_variable _cv;
+  std::deque<SendUlReq> _queue;
+  // Batches written but not yet acked on the stream
+  std::deque<SendUlBatchReq> _unacked;
+  // Number of packets popped off the queue but not yet acked or resent
+  uint32_t _pending;
+  uint64_t _next_seq;
+  // Set by the ack loop once the current stream can no longer be read
+  bool _stream_broken;
+  bool _done;
+  // Context of the open stream, cancelled by stop to unblock the writer and
+  // the ack loop
+  grpc::ClientContext* _context;
+
+  std::unique_ptr<std::thread> _thread;
+};
+
+}  // namespace sctpd
+}  // namespace magma
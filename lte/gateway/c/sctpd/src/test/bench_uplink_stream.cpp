@@ -0,0 +1,159 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Compares uplink messages/sec and p99 latency of the unary SendUl client
+// against the SendUlStream client over a unix domain socket, with a fake MME
+// uplink server. Usage: bench_uplink_stream [num_msgs] [payload_size]
+
+#include <grpcpp/grpcpp.h>
+#include <lte/protos/sctpd.grpc.pb.h>
+#include <lte/protos/sctpd.pb.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "lte/gateway/c/sctpd/src/sctpd_uplink_client.hpp"
+#include "lte/gateway/c/sctpd/src/sctpd_uplink_stream_client.hpp"
+
+using grpc::Server;
+using grpc::ServerBuilder;
+using grpc::ServerContext;
+using grpc::ServerReaderWriter;
+using grpc::Status;
+using magma::sctpd::SctpdUplink;
+using magma::sctpd::SctpdUplinkClient;
+using magma::sctpd::SctpdUplinkStreamClient;
+using magma::sctpd::SendUlBatchReq;
+using magma::sctpd::SendUlBatchRes;
+using magma::sctpd::SendUlReq;
+using magma::sctpd::SendUlRes;
+using magma::sctpd::UplinkStreamConfig;
+
+#define BENCH_SOCK "unix:///tmp/sctpd_bench_upstream.sock"
+
+static int64_t now_ns() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// Fake MME uplink server, records the latency of every received message
+// from the send timestamp carried in the first bytes of the payload
+class BenchUplinkServer final : public SctpdUplink::Service {
+ public:
+  Status SendUl(ServerContext* context, const SendUlReq* req,
+                SendUlRes* res) override {
+    std::lock_guard<std::mutex> lock(_mutex);
+    record(*req);
+    return Status::OK;
+  }
+
+  Status SendUlStream(
+      ServerContext* context,
+      ServerReaderWriter<SendUlBatchRes, SendUlBatchReq>* stream) override {
+    SendUlBatchReq batch;
+    SendUlBatchRes ack;
+    while (stream->Read(&batch)) {
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (const auto& msg : batch.msgs()) {
+          record(msg);
+        }
+      }
+      ack.set_seq(batch.seq());
+      stream->Write(ack);
+    }
+    return Status::OK;
+  }
+
+  void reset(size_t num_msgs) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    latencies.clear();
+    latencies.reserve(num_msgs);
+  }
+
+  std::vector<int64_t> latencies;
+  int64_t last_recv_ns = 0;
+
+ private:
+  void record(const SendUlReq& req) {
+    int64_t sent_ns;
+    memcpy(&sent_ns, req.payload().data(), sizeof(sent_ns));
+    last_recv_ns = now_ns();
+    latencies.push_back(last_recv_ns - sent_ns);
+  }
+
+  std::mutex _mutex;
+};
+
+static void run(const char* name, SctpdUplinkClient& client,
+                BenchUplinkServer& server, int num_msgs, size_t payload_size) {
+  std::string payload(std::max(payload_size, sizeof(int64_t)), 'x');
+  SendUlReq req;
+  SendUlRes res;
+
+  server.reset(num_msgs);
+  req.set_ppid(18);
+  int64_t start_ns = now_ns();
+  for (int i = 0; i < num_msgs; i++) {
+    int64_t sent_ns = now_ns();
+    memcpy(&payload[0], &sent_ns, sizeof(sent_ns));
+    req.set_assoc_id(i % 64);
+    req.set_stream(i % 16);
+    req.set_payload(payload);
+    client.sendUl(req, &res);
+  }
+  auto stream_client = dynamic_cast<SctpdUplinkStreamClient*>(&client);
+  if (stream_client != nullptr) {
+    stream_client->flush();
+  }
+
+  auto& lat = server.latencies;
+  std::sort(lat.begin(), lat.end());
+  double secs = (server.last_recv_ns - start_ns) / 1e9;
+  printf("%-8s msgs=%zu msgs/sec=%.0f p50=%.1fus p99=%.1fus\n", name,
+         lat.size(), lat.size() / secs, lat[lat.size() / 2] / 1e3,
+         lat[lat.size() * 99 / 100] / 1e3);
+}
+
+int main(int argc, char** argv) {
+  int num_msgs = argc > 1 ? atoi(argv[1]) : 100000;
+  size_t payload_size = argc > 2 ? atoi(argv[2]) : 128;
+
+  BenchUplinkServer service;
+  ServerBuilder builder;
+  builder.AddListeningPort(BENCH_SOCK, grpc::InsecureServerCredentials());
+  builder.RegisterService(&service);
+  auto server = builder.BuildAndStart();
+
+  auto channel =
+      grpc::CreateChannel(BENCH_SOCK, grpc::InsecureChannelCredentials());
+  {
+    SctpdUplinkClient unary(channel);
+    run("unary", unary, service, num_msgs, payload_size);
+  }
+  {
+    SctpdUplinkStreamClient stream(channel, UplinkStreamConfig());
+    run("stream", stream, service, num_msgs, payload_size);
+  }
+
+  server->Shutdown();
+  return 0;
+}
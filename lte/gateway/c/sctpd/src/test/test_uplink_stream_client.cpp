@@ -0,0 +1,264 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <grpcpp/grpcpp.h>
+#include <gtest/gtest.h>
+#include <lte/protos/sctpd.grpc.pb.h>
+#include <lte/protos/sctpd.pb.h>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "lte/gateway/c/sctpd/src/sctpd_uplink_stream_client.hpp"
+
+using grpc::Server;
+using grpc::ServerBuilder;
+using grpc::ServerContext;
+using grpc::ServerReaderWriter;
+using grpc::Status;
+
+namespace magma {
+namespace sctpd {
+
+// Records uplink events in the order the MME side would see them
+class FakeSctpdUplinkServer final : public SctpdUplink::Service {
+ public:
+  Status SendUl(ServerContext* context, const SendUlReq* req,
+                SendUlRes* res) override {
+    record(*req);
+    return Status::OK;
+  }
+
+  Status SendUlStream(
+      ServerContext* context,
+      ServerReaderWriter<SendUlBatchRes, SendUlBatchReq>* stream) override {
+    SendUlBatchReq batch;
+    SendUlBatchRes ack;
+    while (stream->Read(&batch)) {
+      std::unique_lock<std::mutex> lock(mutex);
+      if (failing_streams > 0) {
+        // Lose the batch, as if the MME restarted before relaying it
+        failing_streams--;
+        return Status(grpc::StatusCode::UNAVAILABLE, "mme restarting");
+      }
+      for (const auto& msg : batch.msgs()) {
+        record_locked(msg);
+      }
+      batches++;
+      cv.notify_all();
+      // Acks are cumulative, hold them until the test opens the gate
+      if (batches < gate_after_batches) continue;
+      if (batches == gate_after_batches) {
+        cv.wait(lock, [this] { return gate_open; });
+      }
+      lock.unlock();
+      ack.set_seq(batch.seq());
+      stream->Write(ack);
+    }
+    return Status::OK;
+  }
+
+  Status NewAssoc(ServerContext* context, const NewAssocReq* req,
+                  NewAssocRes* res) override {
+    return Status::OK;
+  }
+
+  Status CloseAssoc(ServerContext* context, const CloseAssocReq* req,
+                    CloseAssocRes* res) override {
+    std::lock_guard<std::mutex> lock(mutex);
+    events.push_back("close:" + std::to_string(req->assoc_id()));
+    return Status::OK;
+  }
+
+  void record(const SendUlReq& req) {
+    std::lock_guard<std::mutex> lock(mutex);
+    record_locked(req);
+  }
+
+  void record_locked(const SendUlReq& req) {
+    events.push_back(std::to_string(req.assoc_id()) + ":" +
+                     std::to_string(req.stream()) + ":" + req.payload());
+  }
+
+  void wait_for_batches(int n) {
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [this, n] { return batches >= n; });
+  }
+
+  void open_gate() {
+    std::lock_guard<std::mutex> lock(mutex);
+    gate_open = true;
+    cv.notify_all();
+  }
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::vector<std::string> events;
+  int batches = 0;
+  // Number of streams failing on their first batch
+  int failing_streams = 0;
+  // Batches read before acking, 0 acks every batch as it is read
+  int gate_after_batches = 0;
+  bool gate_open = false;
+};
+
+class UplinkStreamClientTest : public ::testing::Test {
+ protected:
+  virtual void SetUp() {
+    ServerBuilder builder;
+    builder.RegisterService(&_service);
+    _server = builder.BuildAndStart();
+
+    UplinkStreamConfig config;
+    config.max_batch_size = 16;
+    config.max_inflight_batches = 2;
+    config.max_queue_size = 32;
+    _client = std::make_unique<SctpdUplinkStreamClient>(
+        _server->InProcessChannel(grpc::ChannelArguments()), config);
+  }
+
+  virtual void TearDown() {
+    _service.open_gate();
+    _client.reset();
+    _server->Shutdown();
+  }
+
+  SendUlReq make_req(uint32_t assoc_id, uint32_t stream, int n) {
+    SendUlReq req;
+    req.set_ppid(18);
+    req.set_assoc_id(assoc_id);
+    req.set_stream(stream);
+    req.set_payload(std::to_string(n));
+    return req;
+  }
+
+  FakeSctpdUplinkServer _service;
+  std::unique_ptr<Server> _server;
+  std::unique_ptr<SctpdUplinkStreamClient> _client;
+};
+
+TEST_F(UplinkStreamClientTest, test_send_ul_preserves_order) {
+  const int num_msgs = 1000;
+  std::vector<std::string> expected;
+  SendUlRes res;
+
+  for (int i = 0; i < num_msgs; i++) {
+    auto req = make_req(i % 4, i % 3, i);
+    expected.push_back(std::to_string(req.assoc_id()) + ":" +
+                       std::to_string(req.stream()) + ":" + req.payload());
+    EXPECT_EQ(_client->sendUl(req, &res), 0);
+  }
+  EXPECT_TRUE(_client->flush());
+
+  std::lock_guard<std::mutex> lock(_service.mutex);
+  EXPECT_EQ(_service.events, expected);
+}
+
+TEST_F(UplinkStreamClientTest, test_send_ul_coalesces_queued_msgs) {
+  SendUlRes res;
+
+  // Fill the window of 2 unacked batches, the next packets wait in the queue
+  _service.gate_after_batches = 2;
+  EXPECT_EQ(_client->sendUl(make_req(1, 0, 0), &res), 0);
+  _service.wait_for_batches(1);
+  EXPECT_EQ(_client->sendUl(make_req(1, 0, 1), &res), 0);
+  _service.wait_for_batches(2);
+  for (int i = 2; i < 32; i++) {
+    EXPECT_EQ(_client->sendUl(make_req(1, 0, i), &res), 0);
+  }
+  _service.open_gate();
+  EXPECT_TRUE(_client->flush());
+
+  std::lock_guard<std::mutex> lock(_service.mutex);
+  ASSERT_EQ(_service.events.size(), 32);
+  EXPECT_EQ(_service.events.back(), "1:0:31");
+  // The 30 queued packets go out as 2 batches of at most 16
+  EXPECT_EQ(_service.batches, 4);
+}
+
+TEST_F(UplinkStreamClientTest, test_unacked_batches_resent_in_order) {
+  const int num_msgs = 100;
+  std::vector<std::string> expected;
+  SendUlRes res;
+
+  _service.failing_streams = 1;
+  for (int i = 0; i < num_msgs; i++) {
+    EXPECT_EQ(_client->sendUl(make_req(2, 1, i), &res), 0);
+    expected.push_back("2:1:" + std::to_string(i));
+  }
+  EXPECT_TRUE(_client->flush());
+
+  // What the broken stream lost is relayed over SendUl, ahead of the rest
+  std::lock_guard<std::mutex> lock(_service.mutex);
+  EXPECT_EQ(_service.events, expected);
+}
+
+TEST_F(UplinkStreamClientTest, test_close_assoc_after_queued_msgs) {
+  SendUlRes res;
+  CloseAssocReq close_req;
+  CloseAssocRes close_res;
+
+  for (int i = 0; i < 100; i++) {
+    EXPECT_EQ(_client->sendUl(make_req(7, 0, i), &res), 0);
+  }
+  close_req.set_ppid(18);
+  close_req.set_assoc_id(7);
+  EXPECT_EQ(_client->closeAssoc(close_req, &close_res), 0);
+
+  std::lock_guard<std::mutex> lock(_service.mutex);
+  ASSERT_EQ(_service.events.size(), 101);
+  EXPECT_EQ(_service.events.back(), "close:7");
+}
+
+TEST_F(UplinkStreamClientTest, test_stop_with_unresponsive_mme) {
+  SendUlRes res;
+  CloseAssocReq close_req;
+  CloseAssocRes close_res;
+
+  UplinkStreamConfig config;
+  config.flush_timeout_ms = 100;
+  _client = std::make_unique<SctpdUplinkStreamClient>(
+      _server->InProcessChannel(grpc::ChannelArguments()), config);
+  // The MME reads the first batch and never acks it
+  _service.gate_after_batches = 1;
+  for (int i = 0; i < 3; i++) {
+    EXPECT_EQ(_client->sendUl(make_req(3, 0, i), &res), 0);
+  }
+  _service.wait_for_batches(1);
+  EXPECT_FALSE(_client->flush());
+
+  // The close is not held back forever by the unacked packets
+  close_req.set_ppid(18);
+  close_req.set_assoc_id(3);
+  EXPECT_EQ(_client->closeAssoc(close_req, &close_res), 0);
+  {
+    std::lock_guard<std::mutex> lock(_service.mutex);
+    EXPECT_EQ(_service.events.back(), "close:3");
+  }
+
+  // Returns once the flush timed out, the pending packets are dropped
+  _client->stop();
+  EXPECT_EQ(_client->sendUl(make_req(3, 0, 3), &res), -1);
+}
+
+TEST_F(UplinkStreamClientTest, test_send_ul_after_stop) {
+  SendUlRes res;
+
+  _client->stop();
+  EXPECT_EQ(_client->sendUl(make_req(1, 0, 0), &res), -1);
+}
+
+}  // namespace sctpd
+}  // namespace magma
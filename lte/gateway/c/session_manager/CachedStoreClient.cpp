@@ -0,0 +1,199 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "lte/gateway/c/session_manager/CachedStoreClient.hpp"
+
+#include <glog/logging.h>
+#include <chrono>
+#include <exception>
+#include <ostream>
+#include <utility>
+
+#include "orc8r/gateway/c/common/logging/magma_logging.hpp"
+
+namespace magma {
+namespace lte {
+
+CachedStoreClient::CachedStoreClient(std::shared_ptr<StoreClient> backing_store,
+                                     CacheConsistency consistency,
+                                     uint32_t flush_interval_ms)
+    : backing_store_(backing_store),
+      consistency_(consistency),
+      flush_interval_ms_(flush_interval_ms),
+      stopping_(false) {}
+
+CachedStoreClient::~CachedStoreClient() {
+  if (flush_thread_.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(flush_mutex_);
+      stopping_ = true;
+    }
+    flush_cv_.notify_all();
+    flush_thread_.join();
+  }
+  flush();
+}
+
+void CachedStoreClient::load() {
+  auto session_map = backing_store_->read_all_sessions();
+  std::lock_guard<std::mutex> lock(mutex_);
+  MLOG(MINFO) << "Loaded sessions of " << session_map.size()
+              << " subscribers into the session cache";
+  // Subscribers missing from the backing store are dropped from the cache
+  cache_.clear();
+  cache_sessions(std::move(session_map));
+  dirty_.clear();
+}
+
+bool CachedStoreClient::flush() {
+  std::lock_guard<std::mutex> store_lock(store_mutex_);
+  SessionMap session_map;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (dirty_.empty()) {
+      return true;
+    }
+    // Deleted subscribers are cloned as empty vectors, which the backing
+    // store deletes
+    for (const auto& subscriber_id : dirty_) {
+      session_map[subscriber_id] = clone_sessions(subscriber_id);
+    }
+    dirty_.clear();
+  }
+
+  std::set<std::string> subscriber_ids;
+  for (const auto& it : session_map) {
+    subscriber_ids.insert(it.first);
+  }
+  bool success = false;
+  try {
+    success = backing_store_->write_sessions_in_place(session_map);
+  } catch (const std::exception& e) {
+    MLOG(MERROR) << "Exception flushing session cache: " << e.what();
+  }
+  if (!success) {
+    MLOG(MERROR) << "Failed to flush " << subscriber_ids.size()
+                 << " subscribers from the session cache, will retry";
+    std::lock_guard<std::mutex> lock(mutex_);
+    dirty_.insert(subscriber_ids.begin(), subscriber_ids.end());
+  }
+  return success;
+}
+
+void CachedStoreClient::start_flush_loop() {
+  if (flush_thread_.joinable()) {
+    return;
+  }
+  flush_thread_ = std::thread(&CachedStoreClient::flush_loop, this);
+}
+
+void CachedStoreClient::flush_loop() {
+  MLOG(MINFO) << "Started session cache flush thread, interval "
+              << flush_interval_ms_ << "ms";
+  std::unique_lock<std::mutex> lock(flush_mutex_);
+  while (!stopping_) {
+    flush_cv_.wait_for(lock, std::chrono::milliseconds(flush_interval_ms_),
+                       [this] { return stopping_; });
+    lock.unlock();
+    flush();
+    lock.lock();
+  }
+}
+
+void CachedStoreClient::cache_sessions(SessionMap session_map) {
+  for (auto& it : session_map) {
+    if (it.second.empty()) {
+      cache_.erase(it.first);
+    } else {
+      cache_[it.first] = std::move(it.second);
+    }
+  }
+}
+
+SessionVector CachedStoreClient::clone_sessions(
+    const std::string& subscriber_id) {
+  SessionVector sessions;
+  auto it = cache_.find(subscriber_id);
+  if (it == cache_.end()) {
+    return sessions;
+  }
+  sessions.reserve(it->second.size());
+  for (const auto& session : it->second) {
+    sessions.push_back(session->clone());
+  }
+  return sessions;
+}
+
+SessionMap CachedStoreClient::read_sessions(
+    std::set<std::string> subscriber_ids) {
+  SessionMap session_map;
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const auto& subscriber_id : subscriber_ids) {
+    session_map[subscriber_id] = clone_sessions(subscriber_id);
+  }
+  return session_map;
+}
+
+SessionMap CachedStoreClient::read_all_sessions() {
+  SessionMap session_map;
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const auto& it : cache_) {
+    session_map[it.first] = clone_sessions(it.first);
+  }
+  return session_map;
+}
+
+bool CachedStoreClient::write_sessions(SessionMap session_map) {
+  if (consistency_ == WRITE_BEHIND) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& it : session_map) {
+      dirty_.insert(it.first);
+    }
+    cache_sessions(std::move(session_map));
+    return true;
+  }
+
+  // Keep the store lock until cached, so that concurrent writes reach the
+  // backing store in the same order as they hit the cache. The sessions are
+  // written through before being moved into the cache, nothing is copied.
+  std::lock_guard<std::mutex> store_lock(store_mutex_);
+  bool success = false;
+  try {
+    success = backing_store_->write_sessions_in_place(session_map);
+  } catch (const std::exception& e) {
+    MLOG(MERROR) << "Exception writing through session cache: " << e.what();
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!success) {
+    // The cache stays authoritative, retry on the next flush
+    for (const auto& it : session_map) {
+      dirty_.insert(it.first);
+    }
+  }
+  cache_sessions(std::move(session_map));
+  return success;
+}
+
+bool CachedStoreClient::write_sessions_in_place(SessionMap& session_map) {
+  SessionMap copy;
+  for (const auto& it : session_map) {
+    auto& sessions = copy[it.first];
+    for (const auto& session : it.second) {
+      sessions.push_back(session->clone());
+    }
+  }
+  return write_sessions(std::move(copy));
+}
+
+}  // namespace lte
+}  // namespace magma
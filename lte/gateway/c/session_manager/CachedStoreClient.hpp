@@ -0,0 +1,110 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+
+#include "lte/gateway/c/session_manager/StoreClient.hpp"
+
+namespace magma {
+namespace lte {
+
+enum CacheConsistency {
+  // Every write is applied to the cache and synchronously to the backing
+  // store, so the backing store is always current for restart recovery
+  WRITE_THROUGH = 0,
+  // Writes are applied to the cache and subscribers written since the last
+  // flush are written to the backing store every flush interval. A crash can
+  // lose up to one flush interval of updates.
+  WRITE_BEHIND = 1,
+};
+
+/**
+ * StoreClient serving all reads from an authoritative in-memory copy of the
+ * sessions, loaded once from a persistent backing store on startup. Reads no
+ * longer round-trip to the backing store and deserialize every subscriber,
+ * which is what made read_all_sessions expensive with RedisStoreClient. The
+ * sessions written are kept as is, reads return clones of them.
+ */
+class CachedStoreClient final : public StoreClient {
+ public:
+  CachedStoreClient(std::shared_ptr<StoreClient> backing_store,
+                    CacheConsistency consistency, uint32_t flush_interval_ms);
+  CachedStoreClient(CachedStoreClient const&) = delete;
+  ~CachedStoreClient();
+
+  /**
+   * Load all sessions from the backing store into the cache, replacing its
+   * contents. Called on startup to recover the state of the previous run.
+   */
+  void load();
+
+  /**
+   * Write every subscriber modified since the last flush to the backing
+   * store. Subscribers that fail to be written are retried on the next flush.
+   * @return True if all modified subscribers have been written.
+   */
+  bool flush();
+
+  /**
+   * Start the thread flushing to the backing store every flush interval.
+   * With WRITE_THROUGH this only retries writes that failed.
+   */
+  void start_flush_loop();
+
+  bool is_ready() { return backing_store_->is_ready(); }
+
+  SessionMap read_sessions(std::set<std::string> subscriber_ids);
+
+  SessionMap read_all_sessions();
+
+  bool write_sessions(SessionMap session_map);
+
+  bool write_sessions_in_place(SessionMap& session_map);
+
+ private:
+  void flush_loop();
+  // Replace the cached sessions of the subscribers in session_map, the ones
+  // with no session are dropped. Called with mutex_ held.
+  void cache_sessions(SessionMap session_map);
+  // Clone the cached sessions of subscriber_id. Called with mutex_ held.
+  SessionVector clone_sessions(const std::string& subscriber_id);
+
+ private:
+  std::shared_ptr<StoreClient> backing_store_;
+  CacheConsistency consistency_;
+  uint32_t flush_interval_ms_;
+
+  // Guards cache_ and dirty_, sessions are read and written by the
+  // main event base as well as the restart handler and flush threads
+  std::mutex mutex_;
+  SessionMap cache_;
+  // Subscribers written to the cache but not yet to the backing store
+  std::set<std::string> dirty_;
+  // Serializes writes to the backing store, acquired before mutex_
+  std::mutex store_mutex_;
+
+  std::mutex flush_mutex_;
+  std::condition_variable flush_cv_;
+  bool stopping_;
+  std::thread flush_thread_;
+};
+
+}  // namespace lte
+}  // namespace magma
@@ -0,0 +1,157 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "lte/gateway/c/session_manager/EventBaseShards.hpp"
+
+#include <folly/io/async/EventBaseManager.h>
+#include <utility>
+
+namespace magma {
+
+// Shards of the current thread, if it is a shard thread
+static thread_local const EventBaseShards* current_shards = nullptr;
+
+EventBaseShards::EventBaseShards(folly::EventBase* main_evb,
+                                 uint32_t num_shards)
+    : main_evb_(main_evb),
+      pause_generation_(0),
+      resumed_generation_(0),
+      paused_shards_(0),
+      paused_(false) {
+  for (uint32_t i = 0; i < num_shards; i++) {
+    shards_.emplace_back(new folly::EventBase());
+  }
+}
+
+EventBaseShards::~EventBaseShards() { stop(); }
+
+void EventBaseShards::start() {
+  if (!threads_.empty()) {
+    return;
+  }
+  for (auto& shard : shards_) {
+    threads_.emplace_back([this, evb = shard.get()]() {
+      current_shards = this;
+      folly::EventBaseManager::get()->setEventBase(evb, false);
+      evb->loopForever();
+      folly::EventBaseManager::get()->clearEventBase();
+    });
+  }
+}
+
+void EventBaseShards::stop() {
+  for (auto& shard : shards_) {
+    shard->terminateLoopSoon();
+  }
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+  threads_.clear();
+}
+
+uint32_t EventBaseShards::get_shard_id(const std::string& imsi) const {
+  if (shards_.empty()) {
+    return 0;
+  }
+  return std::hash<std::string>()(imsi) % shards_.size();
+}
+
+bool EventBaseShards::in_shard() const { return current_shards == this; }
+
+void EventBaseShards::run_in_shard(const std::string& imsi,
+                                   std::function<void()> fn) {
+  if (shards_.empty()) {
+    main_evb_->runInEventBaseThread(std::move(fn));
+    return;
+  }
+  shards_[get_shard_id(imsi)]->runInEventBaseThread(std::move(fn));
+}
+
+void EventBaseShards::run_after_delay(const std::string& imsi,
+                                      std::function<void()> fn,
+                                      uint32_t delay_ms) {
+  if (shards_.empty()) {
+    main_evb_->runAfterDelay(std::move(fn), delay_ms);
+    return;
+  }
+  folly::EventBase* evb = shards_[get_shard_id(imsi)].get();
+  if (in_shard() && evb->isInEventBaseThread()) {
+    evb->runAfterDelay(std::move(fn), delay_ms);
+    return;
+  }
+  // Timeouts can only be scheduled from the thread of the event base
+  evb->runInEventBaseThread(
+      [evb, fn, delay_ms]() { evb->runAfterDelay(fn, delay_ms); });
+}
+
+void EventBaseShards::run_exclusive(std::function<void()> fn) {
+  main_evb_->runInEventBaseThread([this, fn]() { run_with_shards_paused(fn); });
+}
+
+void EventBaseShards::run_exclusive_after_delay(std::function<void()> fn,
+                                                uint32_t delay_ms) {
+  if (shards_.empty()) {
+    main_evb_->runAfterDelay(std::move(fn), delay_ms);
+    return;
+  }
+  main_evb_->runInEventBaseThread([this, fn, delay_ms]() {
+    main_evb_->runAfterDelay([this, fn]() { run_with_shards_paused(fn); },
+                             delay_ms);
+  });
+}
+
+void EventBaseShards::run_with_shards_paused(const std::function<void()>& fn) {
+  // A shard waiting here for the other shards to pause would never pause
+  // itself, so the work is handed to the main event base instead
+  if (in_shard()) {
+    run_exclusive(fn);
+    return;
+  }
+  // The shards do not run any work until they are started
+  if (paused_ || threads_.empty()) {
+    fn();
+    return;
+  }
+  uint64_t generation;
+  {
+    std::lock_guard<std::mutex> lock(pause_mutex_);
+    generation = ++pause_generation_;
+    paused_shards_ = 0;
+  }
+  for (auto& shard : shards_) {
+    shard->runInEventBaseThread([this, generation]() {
+      std::unique_lock<std::mutex> lock(pause_mutex_);
+      paused_shards_++;
+      pause_cv_.notify_all();
+      pause_cv_.wait(lock, [this, generation]() {
+        return resumed_generation_ >= generation;
+      });
+    });
+  }
+  {
+    std::unique_lock<std::mutex> lock(pause_mutex_);
+    pause_cv_.wait(lock, [this]() { return paused_shards_ == shards_.size(); });
+  }
+
+  paused_ = true;
+  fn();
+  paused_ = false;
+
+  {
+    std::lock_guard<std::mutex> lock(pause_mutex_);
+    resumed_generation_ = generation;
+  }
+  pause_cv_.notify_all();
+}
+
+}  // namespace magma
@@ -0,0 +1,109 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <folly/io/async/EventBase.h>
+#include <stdint.h>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace magma {
+
+/**
+ * EventBaseShards runs the work of each subscriber on one of num_shards event
+ * base threads, picked from a hash of the IMSI. The sessions of a subscriber
+ * are only read and written from its shard, so the shards run in parallel.
+ * The work across subscribers (stats aggregation, PipelineD setup, restart
+ * sync) runs on the main event base with every shard paused.
+ *
+ * With 0 shards, all the work runs on the main event base.
+ */
+class EventBaseShards {
+ public:
+  EventBaseShards(folly::EventBase* main_evb, uint32_t num_shards);
+  EventBaseShards(EventBaseShards const&) = delete;
+  ~EventBaseShards();
+
+  /**
+   * Start the shard threads. Work posted to a shard before it is started
+   * runs once it starts.
+   */
+  void start();
+
+  void stop();
+
+  uint32_t size() const { return shards_.size(); }
+
+  uint32_t get_shard_id(const std::string& imsi) const;
+
+  folly::EventBase* get_main_event_base() const { return main_evb_; }
+
+  /**
+   * Returns true when called from the thread of one of the shards
+   */
+  bool in_shard() const;
+
+  /**
+   * Run fn on the shard of imsi. Can be called from any thread.
+   */
+  void run_in_shard(const std::string& imsi, std::function<void()> fn);
+
+  /**
+   * Run fn on the shard of imsi after delay_ms. Without shards, this must be
+   * called from the main event base.
+   */
+  void run_after_delay(const std::string& imsi, std::function<void()> fn,
+                       uint32_t delay_ms);
+
+  /**
+   * Run fn on the main event base with every shard paused. Can be called
+   * from any thread.
+   */
+  void run_exclusive(std::function<void()> fn);
+
+  /**
+   * Run fn on the main event base after delay_ms with every shard paused.
+   * Without shards, this must be called from the main event base.
+   */
+  void run_exclusive_after_delay(std::function<void()> fn, uint32_t delay_ms);
+
+  /**
+   * Run fn right away on the main event base with every shard paused. This
+   * blocks until the work queued on the shards before is done. From a shard
+   * thread, fn is queued with run_exclusive and runs after this returns.
+   */
+  void run_with_shards_paused(const std::function<void()>& fn);
+
+ private:
+  folly::EventBase* main_evb_;
+  std::vector<std::unique_ptr<folly::EventBase>> shards_;
+  std::vector<std::thread> threads_;
+
+  // Shards are paused by a task waiting until the pause generation is
+  // resumed, a shard still waking up from a previous pause does not count
+  // for the next one
+  std::mutex pause_mutex_;
+  std::condition_variable pause_cv_;
+  uint64_t pause_generation_;
+  uint64_t resumed_generation_;
+  uint32_t paused_shards_;
+  // Only accessed from the main event base
+  bool paused_;
+};
+
+}  // namespace magma
@@ -61,6 +61,10 @@ namespace magma {
 bool LocalEnforcer::SEND_ACCESS_TIMEZONE = false;
 bool LocalEnforcer::CLEANUP_DANGLING_FLOWS = true;
 bool LocalEnforcer::SEND_IPFIX = true;
+bool LocalEnforcer::POLL_STATS_DELTA_ONLY = false;
+uint32_t LocalEnforcer::POLL_STATS_MIN_INTERVAL_MS = 1000;
+uint32_t LocalEnforcer::POLL_STATS_MAX_INTERVAL_MS = 30000;
+float LocalEnforcer::POLL_STATS_QUOTA_PROXIMITY_THRESHOLD = 0.8;
 
 using google::protobuf::RepeatedPtrField;
 
@@ -105,13 +109,31 @@ LocalEnforcer::LocalEnforcer(std::shared_ptr<SessionReporter> reporter,
           quota_exhaustion_termination_on_init_ms),
       retry_timeout_(2000),
       mconfig_(mconfig),
-      access_timezone_(compute_access_timezone()) {}
+      access_timezone_(compute_access_timezone()),
+      last_poll_time_(std::chrono::steady_clock::now()),
+      next_poll_interval_ms_(0) {}
 
-void LocalEnforcer::start() { evb_->loopForever(); }
+void LocalEnforcer::start() {
+  shards_->start();
+  evb_->loopForever();
+}
 
-void LocalEnforcer::attachEventBase(folly::EventBase* evb) { evb_ = evb; }
+void LocalEnforcer::attachEventBase(folly::EventBase* evb) {
+  evb_ = evb;
+  shards_ = std::make_shared<EventBaseShards>(evb, 0);
+}
 
-void LocalEnforcer::stop() { evb_->terminateLoopSoon(); }
+void LocalEnforcer::attachShards(std::shared_ptr<EventBaseShards> shards) {
+  evb_ = shards->get_main_event_base();
+  shards_ = shards;
+}
+
+void LocalEnforcer::stop() {
+  evb_->terminateLoopSoon();
+  shards_->stop();
+}
+
+EventBaseShards& LocalEnforcer::get_shards() { return *shards_; }
 
 folly::EventBase& LocalEnforcer::get_event_base() { return *evb_; }
 
@@ -209,6 +231,11 @@ void LocalEnforcer::handle_session_update_response(
     const UpdateSessionRequest& request,
     std::shared_ptr<SessionMap> session_map_ptr, SessionUpdate& session_uc,
     Status status, UpdateSessionResponse response) {
+  if (shards_ && shards_->size() > 0 && !shards_->in_shard()) {
+    dispatch_session_update_response(request, *session_map_ptr, session_uc,
+                                     status, response);
+    return;
+  }
   PrintGrpcMessage(static_cast<const google::protobuf::Message&>(response));
 
   // clear all the reporting flags
@@ -229,6 +256,71 @@ void LocalEnforcer::handle_session_update_response(
   session_store_.update_sessions(session_uc);
 }
 
+void LocalEnforcer::dispatch_session_update_response(
+    const UpdateSessionRequest& request, SessionMap& session_map,
+    SessionUpdate& session_uc, Status status,
+    const UpdateSessionResponse& response) {
+  struct ShardUpdate {
+    // Any subscriber of the shard, to route the update
+    std::string imsi;
+    UpdateSessionRequest request;
+    UpdateSessionResponse response;
+    std::shared_ptr<SessionMap> session_map;
+    SessionUpdate session_uc;
+  };
+  std::unordered_map<uint32_t, ShardUpdate> shard_updates;
+  auto get_shard_update = [&](const std::string& imsi) -> ShardUpdate& {
+    auto& shard_update = shard_updates[shards_->get_shard_id(imsi)];
+    if (!shard_update.session_map) {
+      shard_update.imsi = imsi;
+      shard_update.session_map = std::make_shared<SessionMap>();
+    }
+    auto session_it = session_map.find(imsi);
+    if (session_it != session_map.end()) {
+      (*shard_update.session_map)[imsi] = std::move(session_it->second);
+      session_map.erase(session_it);
+    }
+    auto uc_it = session_uc.find(imsi);
+    if (uc_it != session_uc.end()) {
+      shard_update.session_uc[imsi] = std::move(uc_it->second);
+      session_uc.erase(uc_it);
+    }
+    return shard_update;
+  };
+  for (const auto& update : request.updates()) {
+    *get_shard_update(update.common_context().sid().id())
+         .request.add_updates() = update;
+  }
+  for (const auto& monitor : request.usage_monitors()) {
+    *get_shard_update(monitor.sid()).request.add_usage_monitors() = monitor;
+  }
+  for (const auto& credit_response : response.responses()) {
+    *get_shard_update(credit_response.sid()).response.add_responses() =
+        credit_response;
+  }
+  for (const auto& monitor_response : response.usage_monitor_responses()) {
+    *get_shard_update(monitor_response.sid())
+         .response.add_usage_monitor_responses() = monitor_response;
+  }
+  // The other subscribers checked for reporting have changes to save as well
+  std::vector<std::string> remaining_imsis;
+  for (const auto& it : session_uc) {
+    remaining_imsis.push_back(it.first);
+  }
+  for (const auto& imsi : remaining_imsis) {
+    get_shard_update(imsi);
+  }
+
+  for (auto& it : shard_updates) {
+    auto shard_update = std::make_shared<ShardUpdate>(std::move(it.second));
+    shards_->run_in_shard(shard_update->imsi, [this, shard_update, status]() {
+      handle_session_update_response(
+          shard_update->request, shard_update->session_map,
+          shard_update->session_uc, status, shard_update->response);
+    });
+  }
+}
+
 void LocalEnforcer::check_usage_for_reporting(SessionMap& session_map,
                                               SessionUpdate& session_uc) {
   std::vector<std::unique_ptr<ServiceAction>> actions;
@@ -272,23 +364,136 @@ void LocalEnforcer::handle_pipelined_response(Status status,
                  << status.error_message();
   } else {
     auto session_map = session_store_.read_all_sessions();
+    auto usage_by_imsi = get_usage_since_last_poll(resp);
+    if (POLL_STATS_DELTA_ONLY) {
+      remove_idle_records(usage_by_imsi, session_map, resp);
+    }
     SessionUpdate update =
         SessionStore::get_default_session_update(session_map);
     MLOG(MDEBUG) << "Aggregating " << resp.records_size() << " records";
     aggregate_records(session_map, resp, update);
+    update_poll_interval(session_map, usage_by_imsi);
 
     check_usage_for_reporting(session_map, update);
   }
 }
 
 void LocalEnforcer::poll_stats_enforcer(int cookie, int cookie_mask) {
-  // we need to pass in a function pointer. Binding is required because
-  // the function is part of the LocalEnforcer class and has arguments
-  // so we bind to the object and the two arguments the function needs
-  // which are the status and RuleRecordTable response
   pipelined_client_->poll_stats(
-      cookie, cookie_mask,
-      std::bind(&LocalEnforcer::handle_pipelined_response, this, _1, _2));
+      cookie, cookie_mask, [this](Status status, RuleRecordTable resp) {
+        // The response is read on the PipelineD client thread, and the
+        // records span the subscribers of every shard
+        shards_->run_exclusive([this, status, resp]() {
+          handle_pipelined_response(status, resp);
+        });
+      });
+}
+
+std::chrono::milliseconds LocalEnforcer::get_next_poll_interval() const {
+  uint32_t interval_ms = next_poll_interval_ms_;
+  // Until the first poll is aggregated
+  if (interval_ms == 0) {
+    interval_ms = POLL_STATS_MIN_INTERVAL_MS;
+  }
+  return std::chrono::milliseconds(interval_ms);
+}
+
+std::unordered_map<std::string, uint64_t>
+LocalEnforcer::get_usage_since_last_poll(const RuleRecordTable& records) {
+  auto delta = [](uint64_t current, uint64_t previous) {
+    return current >= previous ? current - previous : current;
+  };
+  std::unordered_map<std::string, uint64_t> usage_by_imsi;
+  std::unordered_map<std::string, RuleCounters> polled_counters;
+  polled_counters.reserve(records.records_size());
+  for (const RuleRecord& record : records.records()) {
+    RuleCounters counters{record.rule_version(), record.bytes_tx(),
+                          record.bytes_rx(), record.dropped_tx(),
+                          record.dropped_rx()};
+    std::string key = record.sid() + "|" + std::to_string(record.teid()) +
+                      "|" + record.ue_ipv4() + "|" + record.ue_ipv6() + "|" +
+                      record.rule_id();
+    auto it = polled_counters_.find(key);
+    if (it == polled_counters_.end()) {
+      usage_by_imsi[record.sid()] += counters.bytes_tx + counters.bytes_rx;
+    } else {
+      const RuleCounters& previous = it->second;
+      if (counters.version != previous.version ||
+          counters.bytes_tx != previous.bytes_tx ||
+          counters.bytes_rx != previous.bytes_rx ||
+          counters.dropped_tx != previous.dropped_tx ||
+          counters.dropped_rx != previous.dropped_rx) {
+        usage_by_imsi[record.sid()] +=
+            delta(counters.bytes_tx, previous.bytes_tx) +
+            delta(counters.bytes_rx, previous.bytes_rx);
+      }
+    }
+    polled_counters[key] = counters;
+  }
+  polled_counters_ = std::move(polled_counters);
+  return usage_by_imsi;
+}
+
+void LocalEnforcer::remove_idle_records(
+    const std::unordered_map<std::string, uint64_t>& usage_by_imsi,
+    const SessionMap& session_map, RuleRecordTable& records) {
+  std::unordered_set<std::string> idle_imsis;
+  for (const auto& session_pair : session_map) {
+    const std::string& imsi = session_pair.first;
+    if (usage_by_imsi.find(imsi) != usage_by_imsi.end()) {
+      continue;
+    }
+    // A released session is terminated once PipelineD stops reporting it
+    bool has_released_session = false;
+    for (const auto& session : session_pair.second) {
+      if (session->get_state() == SESSION_RELEASED) {
+        has_released_session = true;
+        break;
+      }
+    }
+    if (!has_released_session) {
+      idle_imsis.insert(imsi);
+    }
+  }
+  if (idle_imsis.empty()) {
+    return;
+  }
+  auto* record_list = records.mutable_records();
+  auto last = std::remove_if(
+      record_list->begin(), record_list->end(),
+      [&idle_imsis](const RuleRecord& record) {
+        return idle_imsis.find(record.sid()) != idle_imsis.end();
+      });
+  record_list->DeleteSubrange(last - record_list->begin(),
+                              record_list->end() - last);
+  MLOG(MDEBUG) << "Skipping the stats of " << idle_imsis.size()
+               << " idle subscribers";
+}
+
+void LocalEnforcer::update_poll_interval(
+    const SessionMap& session_map,
+    const std::unordered_map<std::string, uint64_t>& usage_by_imsi) {
+  auto now = std::chrono::steady_clock::now();
+  double elapsed_ms =
+      std::chrono::duration<double, std::milli>(now - last_poll_time_).count();
+  last_poll_time_ = now;
+
+  double interval_ms = POLL_STATS_MAX_INTERVAL_MS;
+  for (const auto& usage : usage_by_imsi) {
+    auto it = session_map.find(usage.first);
+    if (usage.second == 0 || it == session_map.end()) {
+      continue;
+    }
+    for (const auto& session : it->second) {
+      uint64_t remaining = session->get_min_remaining_credit(
+          POLL_STATS_QUOTA_PROXIMITY_THRESHOLD);
+      // Time until the credit runs out at the rate of the last interval
+      interval_ms =
+          std::min(interval_ms, remaining * elapsed_ms / usage.second);
+    }
+  }
+  interval_ms = std::max(interval_ms, (double)POLL_STATS_MIN_INTERVAL_MS);
+  next_poll_interval_ms_ = static_cast<uint32_t>(interval_ms);
 }
 
 void LocalEnforcer::increment_all_policy_versions(SessionMap& session_map) {
@@ -399,6 +604,9 @@ void LocalEnforcer::aggregate_records(SessionMap& session_map,
   // In some failure cases, PipelineD may still hold onto flows for sessions
   // that do not exist in SessionD. In this case, send DeactivateFlowsRequest
   RuleRecordSet dead_sessions_to_cleanup;
+  // Records are matched to sessions by UE IP or TEID, index them once instead
+  // of scanning the sessions of the subscriber for every record
+  SessionIndex session_index(session_map);
 
   for (const RuleRecord& record : records.records()) {
     const std::string& imsi = record.sid();
@@ -407,7 +615,7 @@ void LocalEnforcer::aggregate_records(SessionMap& session_map,
     const uint32_t teid = record.teid();
     SessionSearchCriteria criteria(imsi, IMSI_AND_UE_IPV4_OR_IPV6_OR_UPF_TEID,
                                    ip_v4, ip_v6, teid);
-    auto session_it = session_store_.find_session(session_map, criteria);
+    auto session_it = session_index.find_session(criteria);
     if (!session_it) {
       MLOG(MERROR) << "Could not find a 4G and 5G active session for " << imsi
                    << " and ip" << ip_v4 << "or ipv6" << ip_v6 << " or teid "
@@ -578,7 +786,8 @@ void LocalEnforcer::start_session_termination(
   // terminate the session.
   MLOG(MDEBUG) << "Scheduling a force termination timeout for " << session_id
                << " in " << session_force_termination_timeout_ms_ << "ms";
-  evb_->runAfterDelay(
+  shards_->run_after_delay(
+      imsi,
       [this, imsi, session_id] {
         handle_force_termination_timeout(imsi, session_id);
       },
@@ -782,7 +991,8 @@ void LocalEnforcer::schedule_static_rule_activation(
   MLOG(MDEBUG) << "Scheduling " << session_id << " static rule " << rule_id
                << " activation in " << (delta.count() / 1000) << " secs";
 
-  evb_->runAfterDelay(
+  shards_->run_after_delay(
+      imsi,
       [=] {
         auto session_map = session_store_.read_sessions(SessionRead{imsi});
         auto session_update =
@@ -839,7 +1049,8 @@ void LocalEnforcer::schedule_dynamic_rule_activation(
   auto delta = magma::time_difference_from_now(activation_time);
   MLOG(MDEBUG) << "Scheduling " << session_id << " dynamic rule " << rule_id
                << " activation in " << (delta.count() / 1000) << " secs";
-  evb_->runAfterDelay(
+  shards_->run_after_delay(
+      imsi,
       [=] {
         auto session_map = session_store_.read_sessions(SessionRead{imsi});
         auto session_update =
@@ -898,7 +1109,8 @@ void LocalEnforcer::schedule_static_rule_deactivation(
   auto delta = magma::time_difference_from_now(deactivation_time);
   MLOG(MDEBUG) << "Scheduling " << session_id << " static rule " << rule_id
                << " deactivation in " << (delta.count() / 1000) << " secs";
-  evb_->runAfterDelay(
+  shards_->run_after_delay(
+      imsi,
       [=] {
         auto session_map = session_store_.read_sessions(SessionRead{imsi});
         auto session_update =
@@ -949,7 +1161,8 @@ void LocalEnforcer::schedule_dynamic_rule_deactivation(
   auto delta = magma::time_difference_from_now(deactivation_time);
   MLOG(MDEBUG) << "Scheduling " << session_id << " dynamic rule " << rule_id
                << " deactivation in " << (delta.count() / 1000) << " secs";
-  evb_->runAfterDelay(
+  shards_->run_after_delay(
+      imsi,
       [=] {
         auto session_map = session_store_.read_sessions(SessionRead{imsi});
         auto session_update =
@@ -1156,7 +1369,8 @@ bool LocalEnforcer::update_tunnel_ids(SessionMap& session_map,
 
       // schedule the removal of rules to avoid problems with install-unistall
       // order
-      evb_->runAfterDelay(
+      shards_->run_after_delay(
+          imsi,
           [this, imsi, session_id, credit] {
             auto session_map = session_store_.read_sessions({imsi});
             SessionSearchCriteria criteria(imsi, IMSI_AND_SESSION_ID,
@@ -1233,7 +1447,7 @@ void LocalEnforcer::handle_session_activate_subscriber_quota_state(
 
 void LocalEnforcer::schedule_termination(
     std::unordered_set<ImsiAndSessionID>& sessions) {
-  evb_->runAfterDelay(
+  shards_->run_exclusive_after_delay(
       [this, sessions] {
         SessionRead req;
         for (auto& imsi_and_session_id : sessions) {
@@ -1932,7 +2146,8 @@ void LocalEnforcer::schedule_revalidation(
   auto delta = magma::time_difference_from_now(revalidation_time);
   MLOG(MINFO) << "Scheduling revalidation in " << delta.count() << "ms for "
               << session_id;
-  evb_->runAfterDelay(
+  shards_->run_after_delay(
+      imsi,
       [=] {
         MLOG(MINFO) << "Revalidation timeout! for " << session_id;
         auto session_map = session_store_.read_sessions(req);
@@ -1966,7 +2181,7 @@ void LocalEnforcer::handle_activate_ue_flows_callback(
                << ", terminating session...";
 
   // start_session_termination
-  evb_->runInEventBaseThread([this, imsi, session_id] {
+  shards_->run_in_shard(imsi, [this, imsi, session_id] {
     auto session_map = session_store_.read_sessions({imsi});
     auto update = SessionStore::get_default_session_update(session_map);
     bool success =
@@ -21,6 +21,7 @@
 #include <lte/protos/session_manager.grpc.pb.h>
 #include <lte/protos/session_manager.pb.h>
 #include <stdint.h>
+#include <atomic>
 #include <chrono>
 #include <ctime>
 #include <experimental/optional>
@@ -37,6 +38,7 @@
 #include "lte/gateway/c/session_manager/AAAClient.hpp"
 #include "lte/gateway/c/session_manager/CreditKey.hpp"
 #include "lte/gateway/c/session_manager/DirectorydClient.hpp"
+#include "lte/gateway/c/session_manager/EventBaseShards.hpp"
 #include "lte/gateway/c/session_manager/PipelinedClient.hpp"
 #include "lte/gateway/c/session_manager/RuleStore.hpp"
 #include "lte/gateway/c/session_manager/SessionEvents.hpp"
@@ -166,6 +168,12 @@ class LocalEnforcer {
 
   void attachEventBase(folly::EventBase* evb);
 
+  /**
+   * Run the work of each subscriber on the shard of its IMSI instead of the
+   * main event base, see EventBaseShards
+   */
+  void attachShards(std::shared_ptr<EventBaseShards> shards);
+
   // blocks
   void start();
 
@@ -173,6 +181,8 @@ class LocalEnforcer {
 
   folly::EventBase& get_event_base();
 
+  EventBaseShards& get_shards();
+
   /**
    * Setup rules for all sessions in pipelined, used whenever pipelined
    * restarts and needs to recover state
@@ -369,7 +379,24 @@ class LocalEnforcer {
       SessionUpdate& session_update, grpc::Status status,
       UpdateSessionResponse response);
 
+  /**
+   * Split an UpdateSession response received outside of the shards by
+   * subscriber shard, and handle each part on its shard
+   */
+  void dispatch_session_update_response(
+      const UpdateSessionRequest& request, SessionMap& session_map,
+      SessionUpdate& session_update, grpc::Status status,
+      const UpdateSessionResponse& response);
+
   void poll_stats_enforcer(int cookie, int cookie_mask);
+
+  /**
+   * Returns the time to wait before the next stats poll: the time until the
+   * closest grant of an active subscriber is exhausted at the usage rate seen
+   * in the last poll, bounded by POLL_STATS_MIN/MAX_INTERVAL_MS.
+   * Can be called from any thread.
+   */
+  std::chrono::milliseconds get_next_poll_interval() const;
   /**
    * Sends enb_teid and agw_teid for a specific bearer to a flow for a specific
    * UE on pipelined. UE will be identified by pipelined using its IP
@@ -396,6 +423,15 @@ class LocalEnforcer {
   static bool CLEANUP_DANGLING_FLOWS;
   // If true, send ipfix related updates to PipelineD
   static bool SEND_IPFIX;
+  // If true, the stats polled from PipelineD are only aggregated for the
+  // subscribers with a rule whose counters changed since the previous poll
+  static bool POLL_STATS_DELTA_ONLY;
+  // Bounds of the adaptive stats poll interval
+  static uint32_t POLL_STATS_MIN_INTERVAL_MS;
+  static uint32_t POLL_STATS_MAX_INTERVAL_MS;
+  // Subscribers with a grant used over this ratio are polled at the minimum
+  // interval while they have traffic
+  static float POLL_STATS_QUOTA_PROXIMITY_THRESHOLD;
 
  private:
   std::shared_ptr<SessionReporter> reporter_;
@@ -407,6 +443,7 @@ class LocalEnforcer {
   std::shared_ptr<aaa::AAAClient> aaa_client_;
   std::shared_ptr<ShardTracker> shard_tracker_;
   folly::EventBase* evb_;
+  std::shared_ptr<EventBaseShards> shards_;
   long session_force_termination_timeout_ms_;
   // [CWF-ONLY] This configures how long we should wait before terminating a
   // session after it is created without any monitoring quota
@@ -414,6 +451,18 @@ class LocalEnforcer {
   std::chrono::milliseconds retry_timeout_;
   magma::mconfig::SessionD mconfig_;
   std::unique_ptr<Timezone> access_timezone_;
+  struct RuleCounters {
+    uint64_t version;
+    uint64_t bytes_tx;
+    uint64_t bytes_rx;
+    uint64_t dropped_tx;
+    uint64_t dropped_rx;
+  };
+  // Counters of the rule records of the previous stats poll, by subscriber,
+  // tunnel, UE IPs and rule
+  std::unordered_map<std::string, RuleCounters> polled_counters_;
+  std::chrono::steady_clock::time_point last_poll_time_;
+  std::atomic<uint32_t> next_poll_interval_ms_;
 
  private:
   /**
@@ -431,6 +480,36 @@ class LocalEnforcer {
       std::unordered_set<ImsiAndSessionID> sessions_with_active_flows,
       SessionUpdate& session_update);
 
+  /**
+   * Returns the bytes used by each subscriber since the previous stats poll,
+   * for the subscribers with a rule whose counters changed, and keeps the
+   * records for the next poll. Counters lower than in the previous poll were
+   * reset in PipelineD.
+   */
+  std::unordered_map<std::string, uint64_t> get_usage_since_last_poll(
+      const RuleRecordTable& records);
+
+  /**
+   * Removes the records of the subscribers without any changed rule counter,
+   * so that they are not aggregated. The subscribers stay in session_map for
+   * their pending updates, e.g. RAR, revalidation or retried CCR-U. The
+   * records of subscribers with a released session are kept to complete its
+   * termination, and the records matching no subscriber to clean up their
+   * flows.
+   * @param usage_by_imsi the subscribers with changed counters
+   */
+  void remove_idle_records(
+      const std::unordered_map<std::string, uint64_t>& usage_by_imsi,
+      const SessionMap& session_map, RuleRecordTable& records);
+
+  /**
+   * Estimates the next stats poll interval from the usage of the subscribers
+   * since the previous poll and the credit they have left
+   */
+  void update_poll_interval(
+      const SessionMap& session_map,
+      const std::unordered_map<std::string, uint64_t>& usage_by_imsi);
+
   void filter_rule_installs(
       bool online, std::vector<StaticRuleInstall>& static_installs,
       std::vector<DynamicRuleInstall>& dynamic_installs,
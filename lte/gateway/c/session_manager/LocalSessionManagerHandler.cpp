@@ -78,7 +78,8 @@ void LocalSessionManagerHandlerImpl::ReportRuleStats(
     PrintGrpcMessage(
         static_cast<const google::protobuf::Message&>(request_cpy));
   }
-  enforcer_->get_event_base().runInEventBaseThread([this, request_cpy]() {
+  // The records span the subscribers of every shard
+  enforcer_->get_shards().run_exclusive([this, request_cpy]() {
     if (!session_store_.is_ready()) {
       // Since PipelineD reports a delta value for usage, this could lead to
       // SessionD missing some usage if Redis becomes unavailable. However,
@@ -103,7 +104,7 @@ void LocalSessionManagerHandlerImpl::ReportRuleStats(
                 << " old epoch = " << current_epoch_
                 << ", new epoch = " << reported_epoch_;
 
-    enforcer_->get_event_base().runInEventBaseThread(
+    enforcer_->get_shards().run_exclusive(
         [this, epoch = reported_epoch_,
          update_rule_versions = request_cpy.update_rule_versions()]() {
           call_setup_pipelined(epoch, update_rule_versions);
@@ -195,7 +196,7 @@ void LocalSessionManagerHandlerImpl::handle_setup_callback(
                      << "after delay, for epoch: " << epoch;
     }
 
-    enforcer_->get_event_base().runAfterDelay(
+    enforcer_->get_shards().run_exclusive_after_delay(
         [=] { call_setup_pipelined(epoch, false); }, retry_timeout_ms_.count());
   });
 }
@@ -282,7 +283,8 @@ void LocalSessionManagerHandlerImpl::CreateSession(
     std::function<void(Status, LocalCreateSessionResponse)> response_callback) {
   auto& request_cpy = *request;
   PrintGrpcMessage(static_cast<const google::protobuf::Message&>(request_cpy));
-  enforcer_->get_event_base().runInEventBaseThread([this, response_callback,
+  const auto& shard_imsi = request_cpy.common_context().sid().id();
+  enforcer_->get_shards().run_in_shard(shard_imsi, [this, response_callback,
                                                     request_cpy]() {
     SessionConfig cfg(request_cpy);
     const std::string& imsi = cfg.get_imsi();
@@ -555,8 +557,8 @@ void LocalSessionManagerHandlerImpl::EndSession(
   auto& sid = request->sid();
   auto& apn = request->apn();
   PrintGrpcMessage(static_cast<const google::protobuf::Message&>(request_cpy));
-  enforcer_->get_event_base().runInEventBaseThread(
-      [this, sid, apn, response_callback]() {
+  enforcer_->get_shards().run_in_shard(
+      sid.id(), [this, sid, apn, response_callback]() {
         auto session_map = session_store_.read_sessions({sid.id()});
         MLOG(MINFO) << "Received a termination request from Access for "
                     << sid.id() << " apn " << apn;
@@ -603,7 +605,8 @@ void LocalSessionManagerHandlerImpl::BindPolicy2Bearer(
               << " created dedicated bearerID: " << request->bearer_id()
               << " agw TEID: " << request->teids().agw_teid()
               << " eNB TEID: " << request->teids().enb_teid();
-  enforcer_->get_event_base().runInEventBaseThread([this, request_cpy]() {
+  const auto& imsi = request_cpy.sid().id();
+  enforcer_->get_shards().run_in_shard(imsi, [this, request_cpy]() {
     auto session_map = session_store_.read_sessions({request_cpy.sid().id()});
     SessionUpdate update =
         SessionStore::get_default_session_update(session_map);
@@ -635,8 +638,8 @@ void LocalSessionManagerHandlerImpl::UpdateTunnelIds(
               << " with default bearer id: " << request->bearer_id()
               << " enb_teid= " << request->enb_teid()
               << " agw_teid= " << request->agw_teid();
-  enforcer_->get_event_base().runInEventBaseThread([this, request_cpy, imsi,
-                                                    response_callback]() {
+  enforcer_->get_shards().run_in_shard(imsi, [this, request_cpy, imsi,
+                                              response_callback]() {
     auto session_map = session_store_.read_sessions({imsi});
     auto success = enforcer_->update_tunnel_ids(session_map, request_cpy);
     if (!success) {
@@ -666,7 +669,8 @@ void LocalSessionManagerHandlerImpl::SetSessionRules(
   PrintGrpcMessage(static_cast<const google::protobuf::Message&>(request_cpy));
   MLOG(MDEBUG) << "Received session <-> rule associations";
 
-  enforcer_->get_event_base().runInEventBaseThread([this, request_cpy]() {
+  // The rules can span the subscribers of every shard
+  enforcer_->get_shards().run_exclusive([this, request_cpy]() {
     SessionRead req = {};
     for (const auto& rule_sets : request_cpy.rules_per_subscriber()) {
       req.insert(rule_sets.imsi());
@@ -17,6 +17,7 @@
 #include <lte/protos/session_manager.grpc.pb.h>
 #include <orc8r/protos/common.pb.h>
 #include <stdint.h>
+#include <atomic>
 #include <chrono>
 #include <experimental/optional>
 #include <functional>
@@ -234,7 +235,8 @@ class LocalSessionManagerHandlerImpl : public LocalSessionManagerHandler {
   uint64_t current_epoch_;
   uint64_t reported_epoch_;
   std::chrono::milliseconds retry_timeout_ms_;
-  PipelineDState pipelined_state_;
+  // Read from the shards of the enforcer to check if sessiond is ready
+  std::atomic<PipelineDState> pipelined_state_;
   static const std::string hex_digit_;
 
  private:
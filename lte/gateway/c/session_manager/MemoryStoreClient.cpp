@@ -61,6 +61,10 @@ SessionMap MemoryStoreClient::read_all_sessions() {
 }
 
 bool MemoryStoreClient::write_sessions(SessionMap session_map) {
+  return write_sessions_in_place(session_map);
+}
+
+bool MemoryStoreClient::write_sessions_in_place(SessionMap& session_map) {
   for (auto& it : session_map) {
     auto sessions = std::vector<StoredSessionState>{};
     for (auto const& session : it.second) {
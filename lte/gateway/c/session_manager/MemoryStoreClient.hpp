@@ -46,6 +46,8 @@ class MemoryStoreClient final : public StoreClient {
 
   bool write_sessions(SessionMap session_map);
 
+  bool write_sessions_in_place(SessionMap& session_map);
+
  private:
   std::unordered_map<std::string, std::vector<StoredSessionState>> session_map_;
   std::shared_ptr<StaticRuleStore> rule_store_;
@@ -501,11 +501,7 @@ void AsyncPipelinedClient::poll_stats(
     int cookie, int cookie_mask,
     std::function<void(Status, RuleRecordTable)> callback) {
   auto req = make_stat_req(cookie, cookie_mask);
-  poll_stats_rpc(req, [](Status status, RuleRecordTable table) {
-    if (!status.ok()) {
-      MLOG(MERROR) << "Could not poll stats " << status.error_message();
-    }
-  });
+  poll_stats_rpc(req, callback);
 }
 
 void AsyncPipelinedClient::add_gy_final_action_flow(
@@ -16,14 +16,13 @@
 #include <cpp_redis/core/client.hpp>
 #include <cpp_redis/core/reply.hpp>
 #include <cpp_redis/misc/error.hpp>
-#include <folly/Range.h>
-#include <folly/dynamic.h>
-#include <folly/json.h>
 #include <glog/logging.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <yaml-cpp/yaml.h>  // IWYU pragma: keep
+#include <functional>
 #include <future>
+#include <mutex>
 #include <ostream>
 #include <unordered_map>
 #include <utility>
@@ -33,6 +32,7 @@
 #include "lte/gateway/c/session_manager/StoredState.hpp"
 #include "orc8r/gateway/c/common/config/ServiceConfigLoader.hpp"
 #include "orc8r/gateway/c/common/logging/magma_logging.hpp"
+#include "orc8r/gateway/c/common/service303/MetricsHelpers.hpp"
 
 namespace magma {
 class StaticRuleStore;
@@ -43,21 +43,31 @@ namespace lte {
 
 RedisStoreClient::RedisStoreClient(std::shared_ptr<cpp_redis::client> client,
                                    const std::string& redis_table,
-                                   std::shared_ptr<StaticRuleStore> rule_store)
-    : client_(client), redis_table_(redis_table), rule_store_(rule_store) {}
+                                   std::shared_ptr<StaticRuleStore> rule_store,
+                                   SessionStoreEncoding encoding)
+    : client_(client),
+      redis_table_(redis_table),
+      rule_store_(rule_store),
+      encoding_(encoding),
+      reset_written_values_(std::make_shared<std::atomic<bool>>(true)) {}
 
 bool RedisStoreClient::try_redis_connect() {
   ServiceConfigLoader loader;
   auto config = loader.load_service_config("redis");
   auto port = config["port"].as<uint32_t>();
   auto addr = config["bind"].as<std::string>();
+  // The connection may be (re)established from a reading thread, the values
+  // written are only cleared by the writes
+  reset_written_values_->store(true);
   try {
     client_->connect(
         addr, port,
-        [](const std::string& host, std::size_t port,
-           cpp_redis::client::connect_state status) {
+        [reset_written_values = reset_written_values_](
+            const std::string& host, std::size_t port,
+            cpp_redis::client::connect_state status) {
           if (status == cpp_redis::client::connect_state::dropped) {
             MLOG(MERROR) << "Client disconnected from " << host << ":" << port;
+            reset_written_values->store(true);
           }
         });
     return client_->is_connected();
@@ -140,6 +150,11 @@ SessionMap RedisStoreClient::read_all_sessions() {
 }
 
 bool RedisStoreClient::write_sessions(SessionMap session_map) {
+  return write_sessions_in_place(session_map);
+}
+
+bool RedisStoreClient::write_sessions_in_place(SessionMap& session_map) {
+  std::lock_guard<std::mutex> write_lock(write_mutex_);
   // Writes should happen via a transaction, otherwise the state inside in
   // Redis may not be recoverable or consistent.
   // For reference, see https://redis.io/topics/transactions
@@ -152,9 +167,43 @@ bool RedisStoreClient::write_sessions(SessionMap session_map) {
       throw RedisWriteFailed();
     }
   }
+
+  if (reset_written_values_->exchange(false)) {
+    written_values_.clear();
+  }
+
+  // Most updates leave the stored state of the other subscribers they are
+  // written with unchanged, only the subscribers whose serialized sessions
+  // differ from their last write are sent
+  std::vector<std::pair<std::string, std::string>> values;
+  std::vector<std::string> keys_to_delete;
   std::vector<std::string> keys;
+  uint64_t bytes_written = 0;
   for (auto& it : session_map) {
+    if (it.second.empty()) {
+      // if session is empty we shouldn't write back this subs anymore
+      keys_to_delete.push_back(it.first);
+      keys.push_back(it.first);
+      continue;
+    }
+    auto value = serialize_session_vec(it.second);
+    auto last_written = written_values_.find(it.first);
+    if (last_written != written_values_.end() &&
+        last_written->second == value) {
+      continue;
+    }
+    bytes_written += value.size();
     keys.push_back(it.first);
+    values.emplace_back(it.first, std::move(value));
+  }
+  increment_counter("session_store_subscribers_unchanged",
+                    session_map.size() - keys.size(), size_t(0));
+  if (keys.empty()) {
+    return true;
+  }
+  // Until the transaction succeeds the stored values of the keys are unknown
+  for (const auto& key : keys) {
+    written_values_.erase(key);
   }
   client_->watch(keys);
 
@@ -164,16 +213,11 @@ bool RedisStoreClient::write_sessions(SessionMap session_map) {
   // the entire EXEC does not execute.
   client_->multi();
 
-  // Queue up HSET commands after we've set up some sort of safety
-  // guarantees.
-  std::vector<std::string> keys_to_delete;
-  for (auto& it : session_map) {
-    if (it.second.empty()) {
-      // if session is empty we shouldn't write back this subs anymore
-      keys_to_delete.push_back(it.first);
-      continue;
-    }
-    client_->hset(redis_table_, it.first, serialize_session_vec(it.second));
+  // Queue up a single HMSET of all the subscribers after we've set up some
+  // sort of safety guarantees. All the commands are sent in one round trip
+  // by the commit.
+  if (!values.empty()) {
+    client_->hmset(redis_table_, values);
   }
   if (!keys_to_delete.empty()) {
     client_->hdel(redis_table_, keys_to_delete);
@@ -184,37 +228,46 @@ bool RedisStoreClient::write_sessions(SessionMap session_map) {
   auto reply = exec_future.get();
   if (!reply.ok()) {
     MLOG(MERROR) << "Failed to write sessions to Redis.";
+    written_values_.clear();
     return false;
   }
+  for (auto& it : values) {
+    written_values_[it.first] = std::move(it.second);
+  }
+  for (const auto& key : keys_to_delete) {
+    written_values_.erase(key);
+  }
+  // Divided by session_store_updates, this is the write amplification of the
+  // session updates
+  increment_counter("session_store_bytes_written", bytes_written, size_t(0));
   return true;
 }
 
 std::string RedisStoreClient::serialize_session_vec(
     SessionVector& session_vec) {
-  folly::dynamic marshaled = folly::dynamic::array;
+  std::vector<StoredSessionState> stored_sessions;
+  stored_sessions.reserve(session_vec.size());
   for (auto& session_ptr : session_vec) {
-    auto stored_session = session_ptr->marshal();
-    marshaled.push_back(serialize_stored_session(stored_session));
+    stored_sessions.push_back(session_ptr->marshal());
   }
-  std::string serialized = folly::toJson(marshaled);
-  return serialized;
+  return serialize_stored_session_vector(stored_sessions, encoding_);
 }
 
 SessionVector RedisStoreClient::deserialize_session_vec(
     std::string serialized) {
   SessionVector session_vec;
-  auto folly_serialized = folly::StringPiece(serialized);
   try {
-    folly::dynamic marshaled = folly::parseJson(folly_serialized);
-    for (auto& it : marshaled) {
-      auto stored_session = deserialize_stored_session(it.getString());
+    // Rows still encoded as JSON by an older release are read transparently
+    // and rewritten with encoding_ on the next update of the subscriber
+    auto stored_sessions = deserialize_stored_session_vector(serialized);
+    for (auto& stored_session : stored_sessions) {
       session_vec.push_back(
           SessionState::unmarshal(stored_session, *rule_store_));
     }
   } catch (std::exception const& e) {
     // Very rare but we've seen a crash here
     MLOG(MERROR) << "Exception " << e.what()
-                 << " parsing serialized states as JSON " << folly_serialized;
+                 << " parsing serialized states of size " << serialized.size();
   }
   return session_vec;
 }
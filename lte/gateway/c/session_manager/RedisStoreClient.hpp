@@ -16,12 +16,16 @@
 #include <bits/exception.h>
 #include <cpp_redis/core/client.hpp>
 #include <cpp_redis/cpp_redis>
+#include <atomic>
 #include <exception>  // IWYU pragma: keep
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
+#include <unordered_map>
 
 #include "lte/gateway/c/session_manager/StoreClient.hpp"
+#include "lte/gateway/c/session_manager/StoredState.hpp"
 
 namespace magma {
 class StaticRuleStore;
@@ -47,10 +51,11 @@ class RedisStoreClient final : public StoreClient {
  public:
   RedisStoreClient(std::shared_ptr<cpp_redis::client> client,
                    const std::string& redis_table,
-                   std::shared_ptr<StaticRuleStore> rule_store);
+                   std::shared_ptr<StaticRuleStore> rule_store,
+                   SessionStoreEncoding encoding = JSON_ENCODING);
 
   RedisStoreClient(RedisStoreClient const&) = delete;
-  RedisStoreClient(RedisStoreClient&&) = default;
+  RedisStoreClient(RedisStoreClient&&) = delete;
   ~RedisStoreClient() = default;
 
   bool try_redis_connect();
@@ -63,10 +68,24 @@ class RedisStoreClient final : public StoreClient {
 
   bool write_sessions(SessionMap session_map);
 
+  bool write_sessions_in_place(SessionMap& session_map);
+
  private:
   std::shared_ptr<cpp_redis::client> client_;
   std::string redis_table_;
   std::shared_ptr<StaticRuleStore> rule_store_;
+  // Encoding of the sessions written, either encoding can be read
+  SessionStoreEncoding encoding_;
+  // Serializes the writes, the WATCH/MULTI/EXEC sequence of a write and
+  // written_values_ are not safe to share between concurrent writers
+  std::mutex write_mutex_;
+  // Serialized sessions last written for each subscriber, to skip writing
+  // subscribers whose sessions are unchanged. Guarded by write_mutex_.
+  std::unordered_map<std::string, std::string> written_values_;
+  // Set when the connection to redis is (re)established or dropped, redis
+  // may have lost or been restarted without the values last written, so
+  // written_values_ is cleared before the next write
+  std::shared_ptr<std::atomic<bool>> reset_written_values_;
 
  private:
   std::string serialize_session_vec(SessionVector& session_vec);
@@ -100,6 +100,14 @@ static bool should_track_monitoring_key(
          tracking_type == PolicyRule::OCS_AND_PCRF;
 }
 
+PolicyRuleBiMap::PolicyRuleBiMap(const PolicyRuleBiMap& other)
+    : rules_by_charging_key_(&ccHash, &ccEqual) {
+  std::lock_guard<std::mutex> lock(other.map_mutex_);
+  rules_by_rule_id_ = other.rules_by_rule_id_;
+  rules_by_charging_key_ = other.rules_by_charging_key_;
+  rules_by_monitoring_key_ = other.rules_by_monitoring_key_;
+}
+
 void PolicyRuleBiMap::sync_rules(const std::vector<PolicyRule>& rules) {
   std::lock_guard<std::mutex> lock(map_mutex_);
   rules_by_rule_id_.clear();
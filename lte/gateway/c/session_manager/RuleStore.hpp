@@ -69,6 +69,8 @@ class PoliciesByKeyMap {
 class PolicyRuleBiMap {
  public:
   PolicyRuleBiMap() : rules_by_charging_key_(&ccHash, &ccEqual) {}
+  // Copies share the rule definitions, which are never modified in place
+  PolicyRuleBiMap(const PolicyRuleBiMap& other);
   /**
    * Clear the maps and add in the given rules
    */
@@ -124,7 +126,7 @@ class PolicyRuleBiMap {
 
  protected:
   // guards all three maps below
-  std::mutex map_mutex_;
+  mutable std::mutex map_mutex_;
   // rule_id -> PolicyRule
   std::unordered_map<std::string, std::shared_ptr<PolicyRule>>
       rules_by_rule_id_;
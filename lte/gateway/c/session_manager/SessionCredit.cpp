@@ -15,6 +15,7 @@
 
 #include <glog/logging.h>
 #include <stdlib.h>
+#include <algorithm>
 #include <cstdint>
 #include <ostream>
 #include <string>
@@ -437,6 +438,36 @@ Usage SessionCredit::get_unreported_usage() const {
   return usage;
 }
 
+uint64_t SessionCredit::get_remaining_credit(float usage_ratio) const {
+  if (credit_limit_type_ != FINITE || grant_tracking_type_ == TRACKING_UNSET) {
+    return UINT64_MAX;
+  }
+  if (is_quota_exhausted(usage_ratio)) {
+    return 0;
+  }
+  auto remaining = [](uint64_t allowed, uint64_t used) {
+    return allowed > used ? allowed - used : 0;
+  };
+  uint64_t rx = remaining(buckets_[ALLOWED_RX], buckets_[USED_RX]);
+  uint64_t tx = remaining(buckets_[ALLOWED_TX], buckets_[USED_TX]);
+  uint64_t total = remaining(buckets_[ALLOWED_TOTAL],
+                             buckets_[USED_TX] + buckets_[USED_RX]);
+  switch (grant_tracking_type_) {
+    case ALL_TOTAL_TX_RX:
+      return std::min({rx, tx, total});
+    case RX_ONLY:
+      return rx;
+    case TX_ONLY:
+      return tx;
+    case TX_AND_RX:
+      return std::min(rx, tx);
+    case TOTAL_ONLY:
+      return total;
+    default:
+      return UINT64_MAX;
+  }
+}
+
 bool SessionCredit::compute_quota_exhausted(const uint64_t allowed,
                                             const uint64_t used,
                                             float threshold_ratio,
@@ -143,6 +143,13 @@ class SessionCredit {
    */
   bool is_quota_exhausted(float usage_reporting_threshold) const;
 
+  /**
+   * Returns the volume left on the tracked legs of the current grant, or 0
+   * once the credit is exhausted at usage_ratio (see is_quota_exhausted).
+   * Returns UINT64_MAX for credits without a finite grant.
+   */
+  uint64_t get_remaining_credit(float usage_ratio) const;
+
   bool current_grant_contains_zero() const;
 
   /**
@@ -12,6 +12,7 @@
  */
 #include "lte/gateway/c/session_manager/SessionID.hpp"
 
+#include <mutex>
 #include <sstream>
 #include <string>
 
@@ -23,6 +24,7 @@ SessionIDGenerator::SessionIDGenerator() {
 
 std::string SessionIDGenerator::gen_session_id(const std::string& imsi) {
   // imsi- + random 6 digit number
+  std::lock_guard<std::mutex> lock(mutex_);
   return imsi + "-" + std::to_string(idist_(rgen_));
 }
 
@@ -13,6 +13,7 @@
 
 #pragma once
 
+#include <mutex>
 #include <random>
 #include <string>
 
@@ -33,6 +34,8 @@ class SessionIDGenerator {
                                 std::string& imsi_out);
 
  private:
+  // Session ids are generated from the enforcer shards
+  std::mutex mutex_;
   std::mt19937 rgen_;
   std::uniform_int_distribution<int> idist_;
 };
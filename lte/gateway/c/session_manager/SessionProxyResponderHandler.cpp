@@ -59,7 +59,8 @@ void SessionProxyResponderHandlerImpl::ChargingReAuth(
   MLOG(MDEBUG) << "Received a Gy (Charging) ReAuthRequest for "
                << request->session_id() << " and charging_key "
                << request->charging_key();
-  enforcer_->get_event_base().runInEventBaseThread([this, request_cpy,
+  const auto& shard_imsi = request_cpy.sid();
+  enforcer_->get_shards().run_in_shard(shard_imsi, [this, request_cpy,
                                                     response_callback]() {
     auto session_map = session_store_.read_sessions({request_cpy.sid()});
     SessionUpdate update =
@@ -98,7 +99,8 @@ void SessionProxyResponderHandlerImpl::PolicyReAuth(
   PrintGrpcMessage(static_cast<const google::protobuf::Message&>(request_cpy));
   MLOG(MDEBUG) << "Received a Gx (Policy) ReAuthRequest for session_id "
                << request->session_id();
-  enforcer_->get_event_base().runInEventBaseThread([this, request_cpy,
+  const auto& shard_imsi = request_cpy.imsi();
+  enforcer_->get_shards().run_in_shard(shard_imsi, [this, request_cpy,
                                                     response_callback]() {
     PolicyReAuthAnswer ans;
     const std::string& imsi = request_cpy.imsi();
@@ -125,6 +127,8 @@ void SessionProxyResponderHandlerImpl::PolicyReAuth(
     const auto rat_type = common_context.rat_type();
     const std::string& interface = (rat_type == TGPP_NR) ? "5G N7" : "4G Gx";
     if (rat_type == TGPP_NR) {
+      // Only changes the sessions of the subscriber, so unlike the other 5G
+      // work it can run on the shard of the subscriber
       m5genforcer_->init_policy_reauth(imsi, session_map, request_cpy, ans,
                                        update);
     } else {
@@ -167,8 +171,8 @@ void SessionProxyResponderHandlerImpl::AbortSession(
   }
   const auto session_id = request->session_id();
   MLOG(MINFO) << "Received an ASR for session_id " << session_id;
-  enforcer_->get_event_base().runInEventBaseThread([this, imsi, session_id,
-                                                    response_callback]() {
+  enforcer_->get_shards().run_in_shard(imsi, [this, imsi, session_id,
+                                              response_callback]() {
     grpc::Status status = Status::OK;
     AbortSessionResult answer;
     auto session_map = session_store_.read_sessions({imsi});
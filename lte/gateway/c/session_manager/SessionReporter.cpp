@@ -12,6 +12,7 @@
  */
 #include "lte/gateway/c/session_manager/SessionReporter.hpp"
 
+#include <folly/io/async/EventBaseManager.h>
 #include <glog/logging.h>
 #include <grpcpp/channel.h>
 #include <grpcpp/impl/codegen/status.h>
@@ -68,13 +69,21 @@ SessionReporterImpl::SessionReporterImpl(folly::EventBase* base,
                                          std::shared_ptr<grpc::Channel> channel)
     : base_(base), stub_(CentralSessionController::NewStub(channel)) {}
 
+folly::EventBase* SessionReporterImpl::get_response_event_base() {
+  auto* evb = folly::EventBaseManager::get()->getExistingEventBase();
+  if (evb != nullptr && evb->isRunning() && evb->isInEventBaseThread()) {
+    return evb;
+  }
+  return base_;
+}
+
 void SessionReporterImpl::report_updates(
     const UpdateSessionRequest& request,
     ReporterCallbackFn<UpdateSessionResponse> callback) {
   PrintGrpcMessage(static_cast<const google::protobuf::Message&>(request));
 
   auto controller_response = new AsyncEvbResponse<UpdateSessionResponse>(
-      base_, callback, RESPONSE_TIMEOUT);
+      get_response_event_base(), callback, RESPONSE_TIMEOUT);
   controller_response->set_response_reader(stub_->AsyncUpdateSession(
       controller_response->get_context(), request, &queue_));
 }
@@ -84,7 +93,7 @@ void SessionReporterImpl::report_create_session(
     ReporterCallbackFn<CreateSessionResponse> callback) {
   PrintGrpcMessage(static_cast<const google::protobuf::Message&>(request));
   auto controller_response = new AsyncEvbResponse<CreateSessionResponse>(
-      base_, callback, RESPONSE_TIMEOUT);
+      get_response_event_base(), callback, RESPONSE_TIMEOUT);
   controller_response->set_response_reader(stub_->AsyncCreateSession(
       controller_response->get_context(), request, &queue_));
 }
@@ -94,7 +103,7 @@ void SessionReporterImpl::report_terminate_session(
     ReporterCallbackFn<SessionTerminateResponse> callback) {
   PrintGrpcMessage(static_cast<const google::protobuf::Message&>(request));
   auto controller_response = new AsyncEvbResponse<SessionTerminateResponse>(
-      base_, callback, RESPONSE_TIMEOUT);
+      get_response_event_base(), callback, RESPONSE_TIMEOUT);
   controller_response->set_response_reader(
       std::move(stub_->AsyncTerminateSession(controller_response->get_context(),
                                              request, &queue_)));
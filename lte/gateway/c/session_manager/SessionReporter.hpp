@@ -123,6 +123,14 @@ class SessionReporterImpl : public SessionReporter {
  private:
   folly::EventBase* base_;
   std::unique_ptr<CentralSessionController::Stub> stub_;
+
+  /**
+   * Responses are handled on the event base the request is sent from, so
+   * that the work of a subscriber stays on its enforcer shard. Requests sent
+   * from other threads are handled on base_.
+   */
+  folly::EventBase* get_response_event_base();
+
   static const uint32_t RESPONSE_TIMEOUT = 6;  // seconds
 };
 
@@ -59,6 +59,10 @@ std::unique_ptr<SessionState> SessionState::unmarshal(
   return std::make_unique<SessionState>(marshaled, rule_store);
 }
 
+std::unique_ptr<SessionState> SessionState::clone() const {
+  return std::unique_ptr<SessionState>(new SessionState(*this));
+}
+
 StoredSessionState SessionState::marshal() {
   StoredSessionState marshaled{};
 
@@ -187,6 +191,44 @@ SessionState::SessionState(const StoredSessionState& marshaled,
   }
 }
 
+SessionState::SessionState(const SessionState& other)
+    : imsi_(other.imsi_),
+      session_id_(other.session_id_),
+      local_teid_(other.local_teid_),
+      request_number_(other.request_number_),
+      curr_state_(other.curr_state_),
+      config_(other.config_),
+      pdp_start_time_(other.pdp_start_time_),
+      pdp_end_time_(other.pdp_end_time_),
+      current_version_(other.current_version_),
+      // Not stored, reset as on unmarshal
+      rtx_counter_(0),
+      pdr_list_(other.pdr_list_),
+      subscriber_quota_state_(other.subscriber_quota_state_),
+      tgpp_context_(other.tgpp_context_),
+      create_session_response_(other.create_session_response_),
+      policy_version_and_stats_(other.policy_version_and_stats_),
+      static_rules_(other.static_rules_),
+      active_static_rules_(other.active_static_rules_),
+      dynamic_rules_(other.dynamic_rules_),
+      gy_dynamic_rules_(other.gy_dynamic_rules_),
+      scheduled_static_rules_(other.scheduled_static_rules_),
+      scheduled_dynamic_rules_(other.scheduled_dynamic_rules_),
+      rule_lifetimes_(other.rule_lifetimes_),
+      pending_event_triggers_(other.pending_event_triggers_),
+      revalidation_time_(other.revalidation_time_),
+      credit_map_(4, &ccHash, &ccEqual),
+      session_level_key_(other.session_level_key_),
+      bearer_id_by_policy_(other.bearer_id_by_policy_),
+      shard_id_(other.shard_id_) {
+  for (const auto& it : other.credit_map_) {
+    credit_map_[it.first] = std::make_unique<ChargingGrant>(*it.second);
+  }
+  for (const auto& it : other.monitor_map_) {
+    monitor_map_[it.first] = std::make_unique<Monitor>(*it.second);
+  }
+}
+
 SessionState::SessionState(const std::string& session_id,
                            const SessionConfig& cfg,
                            StaticRuleStore& rule_store, uint64_t pdp_start_time)
@@ -2245,6 +2287,19 @@ uint64_t SessionState::get_monitor(const std::string& key,
   return it->second->credit.get_credit(bucket);
 }
 
+uint64_t SessionState::get_min_remaining_credit(float usage_ratio) const {
+  uint64_t remaining = UINT64_MAX;
+  for (const auto& credit_pair : credit_map_) {
+    const auto& credit = credit_pair.second->credit;
+    remaining = std::min(remaining, credit.get_remaining_credit(usage_ratio));
+  }
+  for (const auto& monitor_pair : monitor_map_) {
+    const auto& credit = monitor_pair.second->credit;
+    remaining = std::min(remaining, credit.get_remaining_credit(usage_ratio));
+  }
+  return remaining;
+}
+
 bool SessionState::set_monitor_reporting(
     const std::string& key, bool reporting,
     SessionStateUpdateCriteria* session_uc) {
@@ -158,6 +158,10 @@ class SessionState {
 
   StoredSessionState marshal();
 
+  // Copy of the session as unmarshal(marshal()) would return it, without the
+  // proto copies, the dynamic rule definitions are shared with this session
+  std::unique_ptr<SessionState> clone() const;
+
   // 5G processing constructor without response contxt as set-interface msg
   SessionState(const std::string& imsi, const std::string& session_ctx_id,
                const SessionConfig& cfg, StaticRuleStore& rule_store);
@@ -558,6 +562,12 @@ class SessionState {
   bool add_to_monitor(const std::string& key, uint64_t used_tx,
                       uint64_t used_rx, SessionStateUpdateCriteria* session_uc);
 
+  /**
+   * Returns the smallest volume left on the charging credits and monitors of
+   * the session, see SessionCredit::get_remaining_credit
+   */
+  uint64_t get_min_remaining_credit(float usage_ratio) const;
+
   // TODO #12593 clean up this function as it is used for testing only
   void set_monitor(const std::string& key, Monitor monitor,
                    SessionStateUpdateCriteria* session_uc);
@@ -814,6 +824,9 @@ class SessionState {
   uint16_t shard_id_;
 
  private:
+  // Used by clone(), sessions are otherwise only moved around
+  SessionState(const SessionState& other);
+
   /**
    * For this session, add the CreditUsageUpdate to the UpdateSessionRequest.
    * Also
@@ -64,8 +64,7 @@ void call_back_upf(grpc::Status, magma::UPFSessionContextState response) {
   const std::string session_id = response.session_snapshot().subscriber_id();
   MLOG(MDEBUG) << " Async Response received from UPF: imsi " << imsi
                << " local fteid : " << fteid;
-  conv_session_enforcer->get_event_base().runInEventBaseThread([imsi, fteid,
-                                                                version]() {
+  conv_session_enforcer->get_shards().run_exclusive([imsi, fteid, version]() {
     /* Update the state change, and notifiy to AMF */
     // For now fteid will be zero in all cases
     conv_session_enforcer->m5g_process_response_from_upf(imsi, fteid, version);
@@ -99,12 +98,21 @@ SessionStateEnforcer::SessionStateEnforcer(
 
 void SessionStateEnforcer::attachEventBase(folly::EventBase* evb) {
   evb_ = evb;
+  shards_ = std::make_shared<EventBaseShards>(evb, 0);
+}
+
+void SessionStateEnforcer::attachShards(
+    std::shared_ptr<EventBaseShards> shards) {
+  evb_ = shards->get_main_event_base();
+  shards_ = shards;
 }
 
 void SessionStateEnforcer::stop() { evb_->terminateLoopSoon(); }
 
 folly::EventBase& SessionStateEnforcer::get_event_base() { return *evb_; }
 
+EventBaseShards& SessionStateEnforcer::get_shards() { return *shards_; }
+
 bool SessionStateEnforcer::m5g_init_session_credit(
     SessionMap& session_map, const std::string& imsi,
     const std::string& session_id, const SessionConfig& cfg) {
@@ -342,7 +350,7 @@ void SessionStateEnforcer::m5g_start_session_termination(
                << session_id << " in " << session_force_termination_timeout_ms_
                << "ms";
 
-  evb_->runAfterDelay(
+  shards_->run_exclusive_after_delay(
       [this, imsi, session_id] {
         m5g_handle_termination_on_timeout(imsi, session_id);
       },
@@ -37,6 +37,7 @@ limitations under the License.
 #include <vector>
 
 #include "lte/gateway/c/session_manager/AmfServiceClient.hpp"
+#include "lte/gateway/c/session_manager/EventBaseShards.hpp"
 #include "lte/gateway/c/session_manager/PipelinedClient.hpp"
 #include "lte/gateway/c/session_manager/RuleStore.hpp"
 #include "lte/gateway/c/session_manager/SessionEvents.hpp"
@@ -86,10 +87,19 @@ class SessionStateEnforcer {
 
   void attachEventBase(folly::EventBase* evb);
 
+  /**
+   * Share the shards of the LocalEnforcer. The 5G session state is not
+   * partitioned, all of its work runs exclusively of the shards, which may
+   * update the same subscribers in the session store.
+   */
+  void attachShards(std::shared_ptr<EventBaseShards> shards);
+
   void stop();
 
   folly::EventBase& get_event_base();
 
+  EventBaseShards& get_shards();
+
   /*Member functions*/
   bool m5g_init_session_credit(SessionMap& session_map, const std::string& imsi,
                                const std::string& session_id,
@@ -258,6 +268,7 @@ class SessionStateEnforcer {
   long session_force_termination_timeout_ms_;
   uint32_t session_max_rtx_count_;
   folly::EventBase* evb_;
+  std::shared_ptr<EventBaseShards> shards_;
   std::chrono::seconds retry_timeout_;
   std::string upf_node_id_;
   uint32_t teid_counter_;
@@ -16,6 +16,7 @@
 #include <glog/logging.h>
 #include <lte/protos/session_manager.pb.h>
 #include <lte/protos/subscriberdb.pb.h>
+#include <functional>
 #include <ostream>
 #include <utility>
 #include <vector>
@@ -27,6 +28,7 @@
 #include "lte/gateway/c/session_manager/StoredState.hpp"
 #include "lte/gateway/c/session_manager/Types.hpp"
 #include "orc8r/gateway/c/common/logging/magma_logging.hpp"
+#include "orc8r/gateway/c/common/service303/MetricsHelpers.hpp"
 
 namespace magma {
 class StaticRuleStore;
@@ -44,7 +46,7 @@ SessionStore::SessionStore(
 SessionStore::SessionStore(
     std::shared_ptr<StaticRuleStore> rule_store,
     std::shared_ptr<magma::MeteringReporter> metering_reporter,
-    std::shared_ptr<RedisStoreClient> store_client)
+    std::shared_ptr<StoreClient> store_client)
     : rule_store_(rule_store),
       store_client_(store_client),
       metering_reporter_(metering_reporter) {}
@@ -66,7 +68,21 @@ void SessionStore::set_and_save_reporting_flag(
     bool value, const UpdateSessionRequest& update_session_request,
     SessionUpdate& session_uc) {
   MLOG(MDEBUG) << "saving flag is_reporting = " << value << " on session store";
-  auto session_map = store_client_->read_all_sessions();
+  // Only the subscribers of the request are read and written back, the others
+  // may be updated concurrently by another enforcer shard
+  std::set<std::string> subscriber_ids;
+  for (const CreditUsageUpdate& credit_update :
+       update_session_request.updates()) {
+    subscriber_ids.insert(credit_update.common_context().sid().id());
+  }
+  for (const UsageMonitoringUpdateRequest& monitor_update :
+       update_session_request.usage_monitors()) {
+    subscriber_ids.insert(monitor_update.sid());
+  }
+  if (subscriber_ids.empty()) {
+    return;
+  }
+  auto session_map = store_client_->read_sessions(subscriber_ids);
 
   for (const CreditUsageUpdate& credit_update :
        update_session_request.updates()) {
@@ -176,18 +192,21 @@ bool SessionStore::update_sessions(const SessionUpdate& update_criteria) {
     subscriber_ids.insert(it.first);
   }
   auto session_map = store_client_->read_sessions(subscriber_ids);
+  uint64_t session_updates = 0;
   // Now attempt to modify the state
   for (auto& it : session_map) {
     auto imsi = it.first;
+    const auto& updates = update_criteria.find(it.first)->second;
     auto it2 = it.second.begin();
     while (it2 != it.second.end()) {
-      auto updates = update_criteria.find(it.first)->second;
       auto session_id = (*it2)->get_session_id();
-      if (updates.find(session_id) != updates.end()) {
-        auto update = updates[session_id];
+      auto update_it = updates.find(session_id);
+      if (update_it != updates.end()) {
+        auto update = update_it->second;
         if (!(*it2)->apply_update_criteria(update)) {
           return false;
         }
+        session_updates++;
         if (update.is_session_ended) {
           // TODO: Instead of deleting from session_map, mark as ended and
           //       no longer mark on read
@@ -207,6 +226,7 @@ bool SessionStore::update_sessions(const SessionUpdate& update_criteria) {
       ++it2;
     }
   }
+  increment_counter("session_store_updates", session_updates, size_t(0));
   return store_client_->write_sessions(std::move(session_map));
 }
 
@@ -353,6 +373,99 @@ optional<SessionVector::iterator> SessionStore::find_session(
   return {};
 }
 
+SessionIndex::SessionIndex(SessionMap& session_map) {
+  lte_by_ue_ipv4_.reserve(session_map.size());
+  lte_by_ue_ipv6_.reserve(session_map.size());
+  for (auto& it : session_map) {
+    const std::string* imsi = &it.first;
+    auto& sessions = it.second;
+    // emplace keeps the first session of the subscriber matching each key
+    for (size_t i = 0; i < sessions.size(); ++i) {
+      const auto& context = sessions[i]->get_config().common_context;
+      SessionPosition position{&sessions, i};
+      switch (context.rat_type()) {
+        case RATType::TGPP_WLAN:
+          wlan_by_imsi_.emplace(*imsi, position);
+          break;
+        case RATType::TGPP_LTE:
+          lte_by_ue_ipv4_.emplace(StringKey{imsi, &context.ue_ipv4()},
+                                  position);
+          lte_by_ue_ipv6_.emplace(StringKey{imsi, &context.ue_ipv6()},
+                                  position);
+          break;
+        case RATType::TGPP_NR:
+          nr_by_upf_teid_.emplace(
+              TeidKey{imsi, sessions[i]->get_upf_local_teid()}, position);
+          break;
+        default:
+          MLOG(MERROR)
+              << "Search criteria for IMSI_AND_UE_IPV4_OR_IPV6_OR_UPF_TEID"
+                 " not implemented for this RAT "
+              << context.rat_type();
+          break;
+      }
+    }
+  }
+}
+
+optional<SessionVector::iterator> SessionIndex::find_session(
+    const SessionSearchCriteria& criteria) {
+  optional<SessionPosition> first;
+  auto keep_first = [&first](const SessionPosition& position) {
+    if (!first || position.index < first->index) {
+      first = position;
+    }
+  };
+
+  auto wlan_it = wlan_by_imsi_.find(criteria.imsi);
+  if (wlan_it != wlan_by_imsi_.end()) {
+    keep_first(wlan_it->second);
+  }
+  auto ipv4_it =
+      lte_by_ue_ipv4_.find(StringKey{&criteria.imsi, &criteria.secondary_key});
+  if (ipv4_it != lte_by_ue_ipv4_.end()) {
+    keep_first(ipv4_it->second);
+  }
+  auto ipv6_it =
+      lte_by_ue_ipv6_.find(StringKey{&criteria.imsi, &criteria.tertiary_key});
+  if (ipv6_it != lte_by_ue_ipv6_.end()) {
+    keep_first(ipv6_it->second);
+  }
+  auto teid_it = nr_by_upf_teid_.find(
+      TeidKey{&criteria.imsi, criteria.quaternary_key_unit32});
+  if (teid_it != nr_by_upf_teid_.end()) {
+    keep_first(teid_it->second);
+  }
+
+  if (!first) {
+    return {};
+  }
+  return first->sessions->begin() + first->index;
+}
+
+std::size_t SessionIndex::StringKeyHash::operator()(
+    const StringKey& key) const {
+  std::size_t h1 = std::hash<std::string>{}(*key.imsi);
+  std::size_t h2 = std::hash<std::string>{}(*key.value);
+  return h1 ^ (h2 << 1);
+}
+
+bool SessionIndex::StringKeyEqual::operator()(const StringKey& lhs,
+                                              const StringKey& rhs) const {
+  return *lhs.value == *rhs.value && *lhs.imsi == *rhs.imsi;
+}
+
+std::size_t SessionIndex::TeidKeyHash::operator()(const TeidKey& key) const {
+  std::size_t h1 = std::hash<std::string>{}(*key.imsi);
+  std::size_t h2 = std::hash<uint32_t>{}(key.teid);
+  return h1 ^ (h2 << 1);
+}
+
+bool SessionIndex::TeidKeyEqual::operator()(const TeidKey& lhs,
+                                            const TeidKey& rhs) const {
+  return lhs.teid == rhs.teid && *lhs.imsi == *rhs.imsi;
+}
+
 SessionUpdate SessionStore::get_default_session_update(
     SessionMap& session_map) {
   SessionUpdate update = {};
@@ -87,6 +87,64 @@ struct SessionSearchCriteria {
         quaternary_key_unit32(p_quaternary_key_unit32) {}
 };
 
+/**
+ * Index of the sessions of a SessionMap by UE IPv4, UE IPv6 and UPF TEID, so
+ * that many IMSI_AND_UE_IPV4_OR_IPV6_OR_UPF_TEID searches on the same map,
+ * as done when aggregating a RuleRecordTable, take a few hash lookups instead
+ * of a scan of the sessions of the subscriber each.
+ * The index holds references into the map, it is invalidated when sessions
+ * are added to or removed from the map.
+ */
+class SessionIndex {
+ public:
+  explicit SessionIndex(SessionMap& session_map);
+
+  /**
+   * Returns the same session as SessionStore::find_session for
+   * IMSI_AND_UE_IPV4_OR_IPV6_OR_UPF_TEID criteria
+   */
+  optional<SessionVector::iterator> find_session(
+      const SessionSearchCriteria& criteria);
+
+ private:
+  // Keys point to strings owned by the map or by the criteria searched
+  struct StringKey {
+    const std::string* imsi;
+    const std::string* value;
+  };
+  struct StringKeyHash {
+    std::size_t operator()(const StringKey& key) const;
+  };
+  struct StringKeyEqual {
+    bool operator()(const StringKey& lhs, const StringKey& rhs) const;
+  };
+  struct TeidKey {
+    const std::string* imsi;
+    uint32_t teid;
+  };
+  struct TeidKeyHash {
+    std::size_t operator()(const TeidKey& key) const;
+  };
+  struct TeidKeyEqual {
+    bool operator()(const TeidKey& lhs, const TeidKey& rhs) const;
+  };
+  // Position of the first session matching a key in the SessionVector of the
+  // subscriber, positions keep find_session's first match semantics
+  struct SessionPosition {
+    SessionVector* sessions;
+    size_t index;
+  };
+
+ private:
+  std::unordered_map<std::string, SessionPosition> wlan_by_imsi_;
+  std::unordered_map<StringKey, SessionPosition, StringKeyHash, StringKeyEqual>
+      lte_by_ue_ipv4_;
+  std::unordered_map<StringKey, SessionPosition, StringKeyHash, StringKeyEqual>
+      lte_by_ue_ipv6_;
+  std::unordered_map<TeidKey, SessionPosition, TeidKeyHash, TeidKeyEqual>
+      nr_by_upf_teid_;
+};
+
 /**
  * SessionStore acts as a broker to storage of sessiond state.
  *
@@ -109,7 +167,7 @@ class SessionStore {
 
   SessionStore(std::shared_ptr<StaticRuleStore> rule_store,
                std::shared_ptr<magma::MeteringReporter> metering_reporter,
-               std::shared_ptr<RedisStoreClient> store_client);
+               std::shared_ptr<StoreClient> store_client);
 
   /**
    * @brief Return a boolean to indicate whether the storage client is ready to
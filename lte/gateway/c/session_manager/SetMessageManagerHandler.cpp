@@ -106,8 +106,8 @@ void SetMessageManagerHandler::SetAmfSessionContext(
   PrintGrpcMessage(static_cast<const google::protobuf::Message&>(request_cpy));
 
   // Requested message from AMF to release the session
-  m5g_enforcer_->get_event_base().runInEventBaseThread([this, response_callback,
-                                                        request_cpy]() {
+  m5g_enforcer_->get_shards().run_exclusive([this, response_callback,
+                                             request_cpy]() {
     // extract values from proto
     std::string imsi = request_cpy.common_context().sid().id();
     const auto rat_type = request_cpy.common_context().rat_type();
@@ -203,8 +203,8 @@ void SetMessageManagerHandler::SetSmfNotification(
   PrintGrpcMessage(static_cast<const google::protobuf::Message&>(*notif));
   // Read the event type from the proto message
   auto& noti = *notif;
-  m5g_enforcer_->get_event_base().runInEventBaseThread([this, response_callback,
-                                                        noti]() {
+  m5g_enforcer_->get_shards().run_exclusive([this, response_callback,
+                                             noti]() {
     NotifyUeEvents Uevent = noti.rat_specific_notification().notify_ue_event();
     MLOG(MINFO) << "Notification of imsi: " << noti.common_context().sid().id()
                 << " from AMF  Event value:" << Uevent;
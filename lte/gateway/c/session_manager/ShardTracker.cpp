@@ -15,6 +15,7 @@
 
 #include <stddef.h>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
 #include <vector>
@@ -27,6 +28,7 @@ ShardTracker::ShardTracker() {
 }
 
 uint16_t ShardTracker::add_ue(const std::string imsi) {
+  std::lock_guard<std::mutex> lock(mutex_);
   for (size_t shard_id = 0; shard_id < imsis_per_shard_.size(); shard_id++) {
     // If the UE is already in the shard, return the shard id. This check
     // is meant to avoid multiple sessions for a UE being assigned duplicate
@@ -45,6 +47,7 @@ uint16_t ShardTracker::add_ue(const std::string imsi) {
 }
 
 bool ShardTracker::remove_ue(const std::string imsi, const uint16_t shard_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
   // Check if the shard id exists(shard ids are index based),
   // and whether the UE is actually part of the shard, before removal
   if (shard_id >= imsis_per_shard_.size() ||
@@ -12,6 +12,7 @@
  */
 #pragma once
 #include <stdint.h>
+#include <mutex>
 #include <set>
 #include <string>
 #include <vector>
@@ -49,6 +50,8 @@ class ShardTracker {
    * largest number of UEs that can fill a shard
    */
   const uint16_t max_shard_size_ = 100;
+  // UEs are added and removed from the enforcer shards
+  std::mutex mutex_;
 };
 
 }  // namespace magma
@@ -33,4 +33,12 @@ void StatsPoller::start_loop(
   }
 }
 
+void StatsPoller::start_adaptive_loop(
+    std::shared_ptr<magma::LocalEnforcer> local_enforcer) {
+  while (true) {
+    local_enforcer->poll_stats_enforcer(COOKIE, COOKIE_MASK);
+    std::this_thread::sleep_for(local_enforcer->get_next_poll_interval());
+  }
+}
+
 }  // namespace magma
@@ -28,5 +28,12 @@ class StatsPoller {
    */
   void start_loop(std::shared_ptr<LocalEnforcer> local_enforcer,
                   uint32_t loop_interval_seconds);
+
+  /**
+   * start_adaptive_loop polls stats from Pipelined like start_loop, but waits
+   * the interval estimated by the LocalEnforcer from the previous poll, so
+   * subscribers close to exhausting their grant are polled more often
+   */
+  void start_adaptive_loop(std::shared_ptr<LocalEnforcer> local_enforcer);
 };
 }  // namespace magma
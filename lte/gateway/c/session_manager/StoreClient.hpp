@@ -69,6 +69,15 @@ class StoreClient {
    * @return True if writes have completed successfully for all sessions.
    */
   virtual bool write_sessions(SessionMap sessions) = 0;
+
+  /**
+   * Same as write_sessions, but the sessions are left with the caller. Lets
+   * a cache write through the sessions it keeps without copying them.
+   *
+   * @param sessions Sessions to write into storage
+   * @return True if writes have completed successfully for all sessions.
+   */
+  virtual bool write_sessions_in_place(SessionMap& sessions) = 0;
 };
 
 }  // namespace lte
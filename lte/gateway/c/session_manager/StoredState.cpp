@@ -20,6 +20,8 @@
 #include <google/protobuf/timestamp.pb.h>
 #include <google/protobuf/util/time_util.h>
 #include <lte/protos/apn.pb.h>
+#include <lte/protos/session_store.pb.h>
+#include <stddef.h>
 #include <algorithm>
 #include <ostream>
 #include <stdexcept>
@@ -646,6 +648,281 @@ StoredSessionState deserialize_stored_session(std::string& serialized) {
   return stored;
 }
 
+// Binary session vectors start with a NUL byte, which never starts a JSON
+// document, followed by the version of the encoding
+const char BINARY_SESSION_VECTOR_MAGIC = '\0';
+const char BINARY_SESSION_VECTOR_VERSION = 1;
+const size_t BINARY_SESSION_VECTOR_HEADER_SIZE = 2;
+
+static void serialize_stored_credit_record(
+    const StoredSessionCredit& stored, magma::lte::StoredCreditRecord* record) {
+  record->set_reporting(stored.reporting);
+  record->set_credit_limit_type(stored.credit_limit_type);
+  for (int bucket_int = USED_TX; bucket_int != BUCKET_ENUM_MAX_VALUE;
+       bucket_int++) {
+    auto it = stored.buckets.find(static_cast<Bucket>(bucket_int));
+    record->add_buckets(it == stored.buckets.end() ? 0 : it->second);
+  }
+  record->set_grant_tracking_type(stored.grant_tracking_type);
+  *record->mutable_received_granted_units() = stored.received_granted_units;
+  record->set_report_last_credit(stored.report_last_credit);
+  record->set_time_of_first_usage(stored.time_of_first_usage);
+  record->set_time_of_last_usage(stored.time_of_last_usage);
+}
+
+static StoredSessionCredit deserialize_stored_credit_record(
+    const magma::lte::StoredCreditRecord& record) {
+  auto stored = StoredSessionCredit{};
+  stored.reporting = record.reporting();
+  stored.credit_limit_type = record.credit_limit_type();
+  for (int bucket_int = USED_TX; bucket_int != BUCKET_ENUM_MAX_VALUE;
+       bucket_int++) {
+    stored.buckets[static_cast<Bucket>(bucket_int)] =
+        bucket_int < record.buckets_size() ? record.buckets(bucket_int) : 0;
+  }
+  stored.grant_tracking_type =
+      static_cast<GrantTrackingType>(record.grant_tracking_type());
+  stored.received_granted_units = record.received_granted_units();
+  stored.report_last_credit = record.report_last_credit();
+  stored.time_of_first_usage = record.time_of_first_usage();
+  stored.time_of_last_usage = record.time_of_last_usage();
+  return stored;
+}
+
+void serialize_stored_session_record(StoredSessionState& stored,
+                                     magma::lte::StoredSessionRecord* record) {
+  record->set_fsm_state(stored.fsm_state);
+  *record->mutable_common_context() = stored.config.common_context;
+  *record->mutable_rat_specific_context() = stored.config.rat_specific_context;
+
+  for (const auto& credit_pair : stored.credit_map) {
+    const auto& grant = credit_pair.second;
+    auto grant_record = record->add_credit_map();
+    grant_record->set_rating_group(credit_pair.first.rating_group);
+    grant_record->set_service_identifier(credit_pair.first.service_identifier);
+    serialize_stored_credit_record(grant.credit,
+                                   grant_record->mutable_credit());
+    grant_record->set_is_final(grant.is_final);
+    auto final_action_info = grant_record->mutable_final_action_info();
+    final_action_info->set_final_action(grant.final_action_info.final_action);
+    *final_action_info->mutable_redirect_server() =
+        grant.final_action_info.redirect_server;
+    for (const auto& rule_id : grant.final_action_info.restrict_rules) {
+      final_action_info->add_restrict_rules(rule_id);
+    }
+    grant_record->set_reauth_state(grant.reauth_state);
+    grant_record->set_service_state(grant.service_state);
+    grant_record->set_expiry_time(grant.expiry_time);
+    grant_record->set_suspended(grant.suspended);
+  }
+
+  for (const auto& monitor_pair : stored.monitor_map) {
+    auto monitor_record = record->add_monitor_map();
+    monitor_record->set_monitoring_key(monitor_pair.first);
+    serialize_stored_credit_record(monitor_pair.second.credit,
+                                   monitor_record->mutable_credit());
+    monitor_record->set_level(monitor_pair.second.level);
+  }
+
+  record->set_session_level_key(stored.session_level_key);
+  record->set_imsi(stored.imsi);
+  record->set_shard_id(stored.shard_id);
+  record->set_session_id(stored.session_id);
+  record->set_pdp_start_time(stored.pdp_start_time);
+  record->set_pdp_end_time(stored.pdp_end_time);
+  *record->mutable_create_session_response() = stored.create_session_response;
+  record->set_subscriber_quota_state(stored.subscriber_quota_state);
+  *record->mutable_tgpp_context() = stored.tgpp_context;
+
+  for (const auto& rule_id : stored.static_rule_ids) {
+    record->add_static_rule_ids(rule_id);
+  }
+  for (const auto& rule : stored.dynamic_rules) {
+    *record->add_dynamic_rules() = rule;
+  }
+  for (const auto& rule : stored.gy_dynamic_rules) {
+    *record->add_gy_dynamic_rules() = rule;
+  }
+  record->set_request_number(stored.request_number);
+
+  auto pending_event_triggers = record->mutable_pending_event_triggers();
+  for (const auto& trigger_pair : stored.pending_event_triggers) {
+    (*pending_event_triggers)[static_cast<int32_t>(trigger_pair.first)] =
+        trigger_pair.second;
+  }
+  *record->mutable_revalidation_time() = stored.revalidation_time;
+
+  for (const auto& bearer_pair : stored.bearer_id_by_policy) {
+    auto bearer_record = record->add_bearer_id_by_policy();
+    bearer_record->set_policy_type(bearer_pair.first.policy_type);
+    bearer_record->set_rule_id(bearer_pair.first.rule_id);
+    bearer_record->set_bearer_id(bearer_pair.second.bearer_id);
+    *bearer_record->mutable_teids() = bearer_pair.second.teids;
+  }
+
+  for (const auto& pdr : stored.pdr_list) {
+    *record->add_pdr_list() = pdr;
+  }
+
+  for (const auto& policy_pair : stored.policy_version_and_stats) {
+    auto stats_record = record->add_policy_version_and_stats();
+    stats_record->set_rule_id(policy_pair.first);
+    stats_record->set_current_version(policy_pair.second.current_version);
+    stats_record->set_last_reported_version(
+        policy_pair.second.last_reported_version);
+    auto stats_map = stats_record->mutable_stats_map();
+    for (const auto& stat : policy_pair.second.stats_map) {
+      auto& stats = (*stats_map)[stat.first];
+      stats.set_tx(stat.second.tx);
+      stats.set_rx(stat.second.rx);
+      stats.set_dropped_tx(stat.second.dropped_tx);
+      stats.set_dropped_rx(stat.second.dropped_rx);
+    }
+  }
+}
+
+StoredSessionState deserialize_stored_session_record(
+    const magma::lte::StoredSessionRecord& record) {
+  auto stored = StoredSessionState{};
+  stored.fsm_state = SessionFsmState(record.fsm_state());
+  stored.config.common_context = record.common_context();
+  stored.config.rat_specific_context = record.rat_specific_context();
+
+  stored.credit_map = StoredChargingCreditMap(4, &ccHash, &ccEqual);
+  for (const auto& grant_record : record.credit_map()) {
+    auto credit_key = CreditKey(grant_record.rating_group(),
+                                grant_record.service_identifier());
+    auto grant = StoredChargingGrant{};
+    grant.credit = deserialize_stored_credit_record(grant_record.credit());
+    grant.is_final = grant_record.is_final();
+    const auto& final_action_info = grant_record.final_action_info();
+    grant.final_action_info.final_action = final_action_info.final_action();
+    grant.final_action_info.redirect_server =
+        final_action_info.redirect_server();
+    for (const auto& rule_id : final_action_info.restrict_rules()) {
+      grant.final_action_info.restrict_rules.push_back(rule_id);
+    }
+    grant.reauth_state = static_cast<ReAuthState>(grant_record.reauth_state());
+    grant.service_state =
+        static_cast<ServiceState>(grant_record.service_state());
+    grant.expiry_time = static_cast<std::time_t>(grant_record.expiry_time());
+    grant.suspended = grant_record.suspended();
+    stored.credit_map[credit_key] = grant;
+  }
+
+  for (const auto& monitor_record : record.monitor_map()) {
+    auto monitor = StoredMonitor{};
+    monitor.credit = deserialize_stored_credit_record(monitor_record.credit());
+    monitor.level = monitor_record.level();
+    stored.monitor_map[monitor_record.monitoring_key()] = monitor;
+  }
+
+  stored.session_level_key = record.session_level_key();
+  stored.imsi = record.imsi();
+  stored.shard_id = static_cast<uint16_t>(record.shard_id());
+  stored.session_id = record.session_id();
+  stored.pdp_start_time = record.pdp_start_time();
+  stored.pdp_end_time = record.pdp_end_time();
+  stored.create_session_response = record.create_session_response();
+  stored.subscriber_quota_state = record.subscriber_quota_state();
+  stored.tgpp_context = record.tgpp_context();
+
+  for (const auto& rule_id : record.static_rule_ids()) {
+    stored.static_rule_ids.push_back(rule_id);
+  }
+  for (const auto& rule : record.dynamic_rules()) {
+    stored.dynamic_rules.push_back(rule);
+  }
+  for (const auto& rule : record.gy_dynamic_rules()) {
+    stored.gy_dynamic_rules.push_back(rule);
+  }
+  stored.request_number = record.request_number();
+
+  for (const auto& trigger_pair : record.pending_event_triggers()) {
+    stored.pending_event_triggers[magma::lte::EventTrigger(
+        trigger_pair.first)] = EventTriggerState(trigger_pair.second);
+  }
+  stored.revalidation_time = record.revalidation_time();
+
+  for (const auto& bearer_record : record.bearer_id_by_policy()) {
+    auto policy_id = PolicyID(PolicyType(bearer_record.policy_type()),
+                              bearer_record.rule_id());
+    stored.bearer_id_by_policy[policy_id] = BearerIDAndTeid();
+    stored.bearer_id_by_policy[policy_id].bearer_id = bearer_record.bearer_id();
+    stored.bearer_id_by_policy[policy_id].teids = bearer_record.teids();
+  }
+
+  for (const auto& pdr : record.pdr_list()) {
+    stored.pdr_list.push_back(pdr);
+  }
+
+  for (const auto& stats_record : record.policy_version_and_stats()) {
+    StatsPerPolicy stats;
+    stats.current_version = stats_record.current_version();
+    stats.last_reported_version = stats_record.last_reported_version();
+    for (const auto& stat : stats_record.stats_map()) {
+      stats.stats_map[stat.first] =
+          RuleStats{stat.second.tx(), stat.second.rx(),
+                    stat.second.dropped_tx(), stat.second.dropped_rx()};
+    }
+    stored.policy_version_and_stats[stats_record.rule_id()] = stats;
+  }
+  return stored;
+}
+
+std::string serialize_stored_session_vector(
+    std::vector<StoredSessionState>& stored, SessionStoreEncoding encoding) {
+  if (encoding == JSON_ENCODING) {
+    folly::dynamic marshaled = folly::dynamic::array;
+    for (auto& stored_session : stored) {
+      marshaled.push_back(serialize_stored_session(stored_session));
+    }
+    return folly::toJson(marshaled);
+  }
+
+  magma::lte::StoredSessionVector session_vector;
+  for (auto& stored_session : stored) {
+    serialize_stored_session_record(stored_session,
+                                    session_vector.add_sessions());
+  }
+  std::string serialized;
+  serialized.reserve(BINARY_SESSION_VECTOR_HEADER_SIZE +
+                     session_vector.ByteSizeLong());
+  serialized.push_back(BINARY_SESSION_VECTOR_MAGIC);
+  serialized.push_back(BINARY_SESSION_VECTOR_VERSION);
+  session_vector.AppendToString(&serialized);
+  return serialized;
+}
+
+std::vector<StoredSessionState> deserialize_stored_session_vector(
+    const std::string& serialized) {
+  std::vector<StoredSessionState> stored;
+  if (serialized.empty() || serialized[0] != BINARY_SESSION_VECTOR_MAGIC) {
+    folly::dynamic marshaled = folly::parseJson(serialized);
+    for (auto& it : marshaled) {
+      std::string stored_session = it.getString();
+      stored.push_back(deserialize_stored_session(stored_session));
+    }
+    return stored;
+  }
+
+  if (serialized.size() < BINARY_SESSION_VECTOR_HEADER_SIZE ||
+      serialized[1] != BINARY_SESSION_VECTOR_VERSION) {
+    throw std::invalid_argument("unsupported session encoding version");
+  }
+  magma::lte::StoredSessionVector session_vector;
+  if (!session_vector.ParseFromArray(
+          serialized.data() + BINARY_SESSION_VECTOR_HEADER_SIZE,
+          serialized.size() - BINARY_SESSION_VECTOR_HEADER_SIZE)) {
+    throw std::invalid_argument("malformed binary session encoding");
+  }
+  stored.reserve(session_vector.sessions_size());
+  for (const auto& record : session_vector.sessions()) {
+    stored.push_back(deserialize_stored_session_record(record));
+  }
+  return stored;
+}
+
 RuleLifetime::RuleLifetime(const StaticRuleInstall& rule_install) {
   activation_time =
       std::time_t(TimeUtil::TimestampToSeconds(rule_install.activation_time()));
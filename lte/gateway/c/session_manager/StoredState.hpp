@@ -21,6 +21,7 @@
 #include <lte/protos/policydb.pb.h>
 #include <lte/protos/session_manager.grpc.pb.h>
 #include <lte/protos/session_manager.pb.h>
+#include <lte/protos/session_store.pb.h>
 #include <sys/types.h>
 #include <cstdint>
 #include <experimental/optional>
@@ -221,4 +222,31 @@ StoredSessionState deserialize_stored_session(std::string& serialized);
 std::string serialize_policy_stats_map(PolicyStatsMap stats_map);
 
 PolicyStatsMap deserialize_policy_stats_map(std::string& serialized);
+
+/**
+ * Encoding of the vector of sessions stored for a subscriber
+ */
+enum SessionStoreEncoding {
+  // JSON array of serialize_stored_session strings, written by older releases
+  JSON_ENCODING = 0,
+  // Versioned StoredSessionVector protobuf, see lte/protos/session_store.proto
+  BINARY_ENCODING = 1,
+};
+
+void serialize_stored_session_record(StoredSessionState& stored,
+                                     magma::lte::StoredSessionRecord* record);
+
+StoredSessionState deserialize_stored_session_record(
+    const magma::lte::StoredSessionRecord& record);
+
+std::string serialize_stored_session_vector(
+    std::vector<StoredSessionState>& stored, SessionStoreEncoding encoding);
+
+/**
+ * Deserialize sessions written with any SessionStoreEncoding, so that rows
+ * written as JSON by older releases can still be read after an upgrade.
+ * @throws std::exception if the sessions cannot be decoded
+ */
+std::vector<StoredSessionState> deserialize_stored_session_vector(
+    const std::string& serialized);
 }  // namespace magma
@@ -71,9 +71,8 @@ void UpfMsgManageHandler::SetUPFNodeState(
   // Print the message from UPF
   PrintGrpcMessage(static_cast<const google::protobuf::Message&>(request));
   Status status;
-  conv_enforcer_->get_event_base().runInEventBaseThread([this,
-                                                         response_callback,
-                                                         request]() {
+  conv_enforcer_->get_shards().run_exclusive([this, response_callback,
+                                              request]() {
     switch (request.upf_node_messages_case()) {
       case UPFNodeState::kAssociatonState: {
         std::string upf_id = request.upf_id();
@@ -108,8 +107,7 @@ void UpfMsgManageHandler::SetUPFSessionsConfig(
     std::function<void(Status, SmContextVoid)> response_callback) {
   auto& ses_config = *sess_config;
   int32_t count = 0;
-  conv_enforcer_->get_event_base().runInEventBaseThread([this, &count,
-                                                         ses_config]() {
+  conv_enforcer_->get_shards().run_exclusive([this, &count, ses_config]() {
     for (auto& upf_session : ses_config.upf_session_state()) {
       // Deleting the IMSI prefix from imsi
       std::string imsi_upf = upf_session.subscriber_id();
@@ -187,8 +185,8 @@ void UpfMsgManageHandler::SendPagingRequest(
 void UpfMsgManageHandler::get_session_from_imsi(
     const std::string& imsi, uint32_t te_id,
     std::function<void(Status, SmContextVoid)> response_callback) {
-  conv_enforcer_->get_event_base().runInEventBaseThread([this, imsi, te_id,
-                                                         response_callback]() {
+  conv_enforcer_->get_shards().run_exclusive([this, imsi, te_id,
+                                              response_callback]() {
     if (!imsi.length()) {
       MLOG(MERROR) << "get_subscriberid_from_ipv4 for IP"
                       "returned an empty subscriber ID";
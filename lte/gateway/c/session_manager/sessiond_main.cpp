@@ -36,6 +36,7 @@
 #include "lte/gateway/c/session_manager/AAAClient.hpp"
 #include "lte/gateway/c/session_manager/AmfServiceClient.hpp"
 #include "lte/gateway/c/session_manager/DirectorydClient.hpp"
+#include "lte/gateway/c/session_manager/EventBaseShards.hpp"
 #include "lte/gateway/c/session_manager/GrpcMagmaUtils.hpp"
 #include "lte/gateway/c/session_manager/LocalEnforcer.hpp"
 #include "lte/gateway/c/session_manager/LocalSessionManagerHandler.hpp"
@@ -44,6 +45,7 @@
 #include "lte/gateway/c/session_manager/OperationalStatesHandler.hpp"
 #include "lte/gateway/c/session_manager/PipelinedClient.hpp"
 #include "lte/gateway/c/session_manager/PolicyLoader.hpp"
+#include "lte/gateway/c/session_manager/CachedStoreClient.hpp"
 #include "lte/gateway/c/session_manager/RedisStoreClient.hpp"
 #include "lte/gateway/c/session_manager/RestartHandler.hpp"
 #include "lte/gateway/c/session_manager/RuleStore.hpp"
@@ -82,6 +84,7 @@ class Channel;
 #define DEFAULT_QUOTA_EXHAUSTION_TERMINATION_MS 30000  // 30sec
 #define DEFAULT_SESSION_MAX_RTX_COUNT 3
 #define DEFAULT_POLL_INTERVAL_TIME 5
+#define DEFAULT_SESSION_CACHE_FLUSH_INTERVAL_MS 1000
 
 #ifdef DEBUG
 extern "C" void __gcov_flush(void);
@@ -173,6 +176,22 @@ void set_consts(const YAML::Node& config) {
   if (config["enable_ipfix"].IsDefined()) {
     magma::LocalEnforcer::SEND_IPFIX = config["enable_ipfix"].as<bool>();
   }
+  if (config["poll_stats_delta_only"].IsDefined()) {
+    magma::LocalEnforcer::POLL_STATS_DELTA_ONLY =
+        config["poll_stats_delta_only"].as<bool>();
+  }
+  if (config["poll_stats_min_interval_ms"].IsDefined()) {
+    magma::LocalEnforcer::POLL_STATS_MIN_INTERVAL_MS =
+        config["poll_stats_min_interval_ms"].as<uint32_t>();
+  }
+  if (config["poll_stats_max_interval_ms"].IsDefined()) {
+    magma::LocalEnforcer::POLL_STATS_MAX_INTERVAL_MS =
+        config["poll_stats_max_interval_ms"].as<uint32_t>();
+  }
+  if (config["poll_stats_quota_proximity_threshold"].IsDefined()) {
+    magma::LocalEnforcer::POLL_STATS_QUOTA_PROXIMITY_THRESHOLD =
+        config["poll_stats_quota_proximity_threshold"].as<float>();
+  }
 
   // log all configs on startup
   MLOG(MINFO) << "==== Constants/Configs loaded from sessiond.yml ====";
@@ -187,9 +206,42 @@ void set_consts(const YAML::Node& config) {
   MLOG(MINFO) << "CLEANUP_DANGLING_FLOWS: "
               << magma::LocalEnforcer::CLEANUP_DANGLING_FLOWS;
   MLOG(MINFO) << "SEND_IPFIX: " << magma::LocalEnforcer::SEND_IPFIX;
+  MLOG(MINFO) << "POLL_STATS_DELTA_ONLY: "
+              << magma::LocalEnforcer::POLL_STATS_DELTA_ONLY;
+  MLOG(MINFO) << "POLL_STATS_MIN_INTERVAL_MS: "
+              << magma::LocalEnforcer::POLL_STATS_MIN_INTERVAL_MS;
+  MLOG(MINFO) << "POLL_STATS_MAX_INTERVAL_MS: "
+              << magma::LocalEnforcer::POLL_STATS_MAX_INTERVAL_MS;
+  MLOG(MINFO) << "POLL_STATS_QUOTA_PROXIMITY_THRESHOLD: "
+              << magma::LocalEnforcer::POLL_STATS_QUOTA_PROXIMITY_THRESHOLD;
   MLOG(MINFO) << "==== Constants/Configs loaded from sessiond.yml ====";
 }
 
+std::shared_ptr<magma::lte::CachedStoreClient> create_session_cache(
+    const YAML::Node& config,
+    std::shared_ptr<magma::lte::StoreClient> backing_store) {
+  auto consistency = magma::lte::WRITE_THROUGH;
+  if (config["session_cache_consistency"].IsDefined() &&
+      config["session_cache_consistency"].as<std::string>() ==
+          "write_behind") {
+    consistency = magma::lte::WRITE_BEHIND;
+  }
+  uint32_t flush_interval_ms = DEFAULT_SESSION_CACHE_FLUSH_INTERVAL_MS;
+  if (config["session_cache_flush_interval_ms"].IsDefined()) {
+    flush_interval_ms =
+        config["session_cache_flush_interval_ms"].as<uint32_t>();
+  }
+  auto session_cache = std::make_shared<magma::lte::CachedStoreClient>(
+      backing_store, consistency, flush_interval_ms);
+  // Recover the sessions of the previous run before serving any request
+  session_cache->load();
+  session_cache->start_flush_loop();
+  MLOG(MINFO) << "Session store cached in memory, "
+              << (consistency == magma::lte::WRITE_BEHIND ? "write behind"
+                                                          : "write through");
+  return session_cache;
+}
+
 magma::SessionStore* create_session_store(
     const YAML::Node& config,
     std::shared_ptr<magma::StaticRuleStore> rule_store,
@@ -197,9 +249,14 @@ magma::SessionStore* create_session_store(
   bool is_stateless = config["support_stateless"].IsDefined() &&
                       config["support_stateless"].as<bool>();
   if (is_stateless) {
+    auto encoding = magma::JSON_ENCODING;
+    if (config["session_store_encoding"].IsDefined() &&
+        config["session_store_encoding"].as<std::string>() == "binary") {
+      encoding = magma::BINARY_ENCODING;
+    }
     auto store_client = std::make_shared<magma::lte::RedisStoreClient>(
         std::make_shared<cpp_redis::client>(),
-        config["sessions_table"].as<std::string>(), rule_store);
+        config["sessions_table"].as<std::string>(), rule_store, encoding);
     bool connected;
     do {
       MLOG(MINFO) << "Attempting to connect to Redis";
@@ -207,6 +264,12 @@ magma::SessionStore* create_session_store(
       std::this_thread::sleep_for(std::chrono::milliseconds(100));
     } while (!connected);
     MLOG(MINFO) << "Successfully connected to Redis";
+    if (config["enable_session_cache"].IsDefined() &&
+        config["enable_session_cache"].as<bool>()) {
+      return new magma::SessionStore(
+          rule_store, metering_reporter,
+          create_session_cache(config, store_client));
+    }
     return new magma::SessionStore(rule_store, metering_reporter, store_client);
   } else {
     MLOG(MINFO) << "Session store in memory";
@@ -226,6 +289,25 @@ long get_quota_exhaust_termination_time(const YAML::Node& config) {
   return quota_exhaust_termination_on_init_ms;
 }
 
+uint32_t get_enforcer_shards(const YAML::Node& config) {
+  if (!config["enforcer_shards"].IsDefined()) {
+    return 0;
+  }
+  uint32_t num_shards = config["enforcer_shards"].as<uint32_t>();
+  // The shards share the session store, only the session cache can be read
+  // and written from several threads
+  bool is_cached = config["support_stateless"].IsDefined() &&
+                   config["support_stateless"].as<bool>() &&
+                   config["enable_session_cache"].IsDefined() &&
+                   config["enable_session_cache"].as<bool>();
+  if (num_shards > 0 && !is_cached) {
+    MLOG(MWARNING) << "enforcer_shards requires enable_session_cache, "
+                   << "running the enforcer on the main event base";
+    return 0;
+  }
+  return num_shards;
+}
+
 int main(int argc, char* argv[]) {
 #ifdef DEBUG
   __gcov_flush();
@@ -361,6 +443,17 @@ int main(int argc, char* argv[]) {
       spgw_client, aaa_client, shard_tracker,
       config["session_force_termination_timeout_ms"].as<long>(),
       get_quota_exhaust_termination_time(config), mconfig);
+  // Attached before the stats poller starts, the poll responses are handled
+  // on the event base
+  local_enforcer->attachEventBase(evb);
+  MLOG(MDEBUG) << "local enforcer Attached EventBase to evb";
+  uint32_t num_shards = get_enforcer_shards(config);
+  // Also shared with the 5G enforcer, whose work runs exclusively of them
+  auto shards = std::make_shared<magma::EventBaseShards>(evb, num_shards);
+  local_enforcer->attachShards(shards);
+  if (num_shards > 0) {
+    MLOG(MINFO) << "Running the enforcer on " << num_shards << " shards";
+  }
 
   // RestartHandler will cleanup sessions from previous SessionD run. We do not
   // care about the return value of this thread.
@@ -379,13 +472,18 @@ int main(int argc, char* argv[]) {
   });
 
   // Start off a thread to periodically poll stats from Pipelined
-  // every fixed interval of time
+  // every fixed interval of time, or an interval adapted to the usage
   std::thread periodic_stats_requester_thread;
   uint32_t interval;
   if (config["enable_pull_stats"].IsDefined() &&
       config["enable_pull_stats"].as<bool>()) {
     auto periodic_stats_requester = std::make_shared<magma::StatsPoller>();
     periodic_stats_requester_thread = std::thread([&]() {
+      if (config["poll_stats_adaptive_interval"].IsDefined() &&
+          config["poll_stats_adaptive_interval"].as<bool>()) {
+        periodic_stats_requester->start_adaptive_loop(local_enforcer);
+        return;
+      }
       // random value assigned for interval period, the value will be loaded
       // from a config field later
       interval = DEFAULT_POLL_INTERVAL_TIME;
@@ -408,10 +506,10 @@ int main(int argc, char* argv[]) {
   MLOG(MINFO) << "Added LocalSessionManagerAsyncService to service's server";
 
   // Register state polling callback
-  server.SetOperationalStatesCallback([evb, session_store]() {
+  server.SetOperationalStatesCallback([local_enforcer, session_store]() {
     std::promise<magma::OpState> result;
     std::future<magma::OpState> future = result.get_future();
-    evb->runInEventBaseThread([session_store, &result]() {
+    local_enforcer->get_shards().run_exclusive([session_store, &result]() {
       result.set_value(magma::get_operational_states(session_store));
     });
     return future.get();
@@ -459,7 +557,7 @@ int main(int argc, char* argv[]) {
     MLOG(MINFO) << "Add converged UPF message service";
     // 5G related SessionStateEnforcer main thread start to handled session
     // state
-    conv_session_enforcer->attachEventBase(evb);
+    conv_session_enforcer->attachShards(shards);
   } else {
     proxy_handler = std::make_shared<magma::SessionProxyResponderHandlerImpl>(
         local_enforcer, *session_store);
@@ -521,11 +619,12 @@ int main(int argc, char* argv[]) {
   }
 
   // Block on main local_enforcer (to keep evb in this thread)
-  local_enforcer->attachEventBase(evb);
-  MLOG(MDEBUG) << "local enforcer Attached EventBase to evb";
   local_enforcer->sync_sessions_on_restart(time(NULL));
   MLOG(MDEBUG) << "Synced session on restart";
+  // The sessions are synced before any shard runs
+  local_enforcer->get_shards().start();
   evb->loopForever();
+  local_enforcer->get_shards().stop();
   MLOG(MINFO) << "Stoping.. session manager GRPC server";
 
   server.Stop();
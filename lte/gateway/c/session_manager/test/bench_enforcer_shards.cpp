@@ -0,0 +1,175 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Measures the rate at which LocalEnforcer handles CCR-U responses with its
+// work sharded over num_shards event base threads, 0 handling them all on the
+// calling thread as without sharding. Each response grants new credit to
+// subs_per_response subscribers, the responses are received outside of the
+// shards as from the FeG/PolicyDB client thread.
+// Usage: bench_enforcer_shards [num_subscribers] [subs_per_response]
+//        [num_shards...]
+
+#include <folly/io/async/EventBase.h>
+#include <gmock/gmock.h>
+#include <grpcpp/impl/codegen/status.h>
+#include <lte/protos/session_manager.pb.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "lte/gateway/c/session_manager/CachedStoreClient.hpp"
+#include "lte/gateway/c/session_manager/EventBaseShards.hpp"
+#include "lte/gateway/c/session_manager/LocalEnforcer.hpp"
+#include "lte/gateway/c/session_manager/MemoryStoreClient.hpp"
+#include "lte/gateway/c/session_manager/MeteringReporter.hpp"
+#include "lte/gateway/c/session_manager/RuleStore.hpp"
+#include "lte/gateway/c/session_manager/SessionStore.hpp"
+#include "lte/gateway/c/session_manager/ShardTracker.hpp"
+#include "lte/gateway/c/session_manager/test/ProtobufCreators.hpp"
+#include "lte/gateway/c/session_manager/test/SessiondMocks.hpp"
+
+using namespace magma;
+using ::testing::NiceMock;
+
+#define BENCH_RESPONSES 20
+
+static std::string get_imsi(int sub) {
+  return "IMSI00101" + std::to_string(1000000000 + sub);
+}
+
+static std::string get_session_id(int sub) { return get_imsi(sub) + "-1"; }
+
+// CCR-U request and response of a batch of subscribers
+struct CreditUpdate {
+  UpdateSessionRequest request;
+  UpdateSessionResponse response;
+  SessionRead imsis;
+};
+
+static std::vector<CreditUpdate> make_updates(int num_subscribers,
+                                              int subs_per_response) {
+  std::vector<CreditUpdate> updates;
+  for (int sub = 0; sub < num_subscribers; sub += subs_per_response) {
+    CreditUpdate update;
+    for (int i = sub; i < std::min(sub + subs_per_response, num_subscribers);
+         i++) {
+      auto usage = update.request.add_updates();
+      usage->mutable_common_context()->mutable_sid()->set_id(get_imsi(i));
+      usage->set_session_id(get_session_id(i));
+      usage->mutable_usage()->set_charging_key(1);
+      usage->mutable_usage()->set_bytes_tx(1024);
+      create_credit_update_response(get_imsi(i), get_session_id(i), 1, 4096,
+                                    update.response.add_responses());
+      update.imsis.insert(get_imsi(i));
+    }
+    updates.push_back(update);
+  }
+  return updates;
+}
+
+// Returns the responses handled per second
+static double run(int num_subscribers, int subs_per_response,
+                  uint32_t num_shards) {
+  auto rule_store = std::make_shared<StaticRuleStore>();
+  // The sessions are only shared across threads through the cache
+  auto store_client = std::make_shared<lte::CachedStoreClient>(
+      std::make_shared<lte::MemoryStoreClient>(rule_store), lte::WRITE_BEHIND,
+      1000);
+  SessionStore session_store(rule_store, std::make_shared<MeteringReporter>(),
+                             store_client);
+  auto enforcer = std::make_shared<LocalEnforcer>(
+      std::make_shared<NiceMock<MockSessionReporter>>(), rule_store,
+      session_store, std::make_shared<NiceMock<MockPipelinedClient>>(),
+      std::make_shared<NiceMock<MockEventsReporter>>(),
+      std::make_shared<NiceMock<MockSpgwServiceClient>>(),
+      std::make_shared<NiceMock<MockAAAClient>>(),
+      std::make_shared<ShardTracker>(), 0, 0, get_default_mconfig());
+  folly::EventBase evb;
+  enforcer->attachShards(std::make_shared<EventBaseShards>(&evb, num_shards));
+
+  for (int sub = 0; sub < num_subscribers; sub++) {
+    SessionConfig cfg;
+    Teids teids;
+    cfg.common_context =
+        build_common_context(get_imsi(sub), "192.168.128.12", "", teids,
+                             "magma.ipv4", "5100001234", TGPP_LTE);
+    CreateSessionResponse response;
+    create_credit_update_response(get_imsi(sub), get_session_id(sub), 1, 4096,
+                                  response.mutable_credits()->Add());
+    auto session =
+        enforcer->create_initializing_session(get_session_id(sub), cfg);
+    enforcer->update_session_with_policy_response(session, response, nullptr);
+    SessionVector sessions;
+    sessions.push_back(std::move(session));
+    session_store.create_sessions(get_imsi(sub), std::move(sessions));
+  }
+
+  auto updates = make_updates(num_subscribers, subs_per_response);
+  auto& shards = enforcer->get_shards();
+  shards.start();
+  auto start = std::chrono::steady_clock::now();
+  for (int round = 0; round < BENCH_RESPONSES; round++) {
+    for (auto& update : updates) {
+      auto session_map = std::make_shared<SessionMap>(
+          session_store.read_sessions(update.imsis));
+      auto session_uc = SessionStore::get_default_session_update(*session_map);
+      enforcer->handle_session_update_response(update.request, session_map,
+                                               session_uc, grpc::Status::OK,
+                                               update.response);
+    }
+  }
+  // Returns once the responses dispatched to the shards are handled
+  shards.run_with_shards_paused([]() {});
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  shards.stop();
+  return BENCH_RESPONSES * updates.size() / elapsed.count();
+}
+
+int main(int argc, char** argv) {
+  int num_subscribers = argc > 1 ? atoi(argv[1]) : 10000;
+  int subs_per_response = argc > 2 ? atoi(argv[2]) : 10;
+  std::vector<uint32_t> shard_counts;
+  for (int i = 3; i < argc; i++) {
+    shard_counts.push_back(atoi(argv[i]));
+  }
+  if (shard_counts.empty()) {
+    uint32_t cores = std::max(1u, std::thread::hardware_concurrency());
+    shard_counts.push_back(0);
+    for (uint32_t shards = 1; shards <= cores; shards *= 2) {
+      shard_counts.push_back(shards);
+    }
+  }
+  if (num_subscribers <= 0 || subs_per_response <= 0) {
+    fprintf(stderr,
+            "Usage: bench_enforcer_shards [num_subscribers] "
+            "[subs_per_response] [num_shards...]\n");
+    return 1;
+  }
+
+  printf("%d subscribers, %d subscribers per response\n", num_subscribers,
+         subs_per_response);
+  printf("%8s %14s %14s\n", "shards", "responses/s", "updates/s");
+  for (uint32_t num_shards : shard_counts) {
+    double responses = run(num_subscribers, subs_per_response, num_shards);
+    printf("%8u %14.0f %14.0f\n", num_shards, responses,
+           responses * subs_per_response);
+  }
+  return 0;
+}
@@ -0,0 +1,139 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Compares encode/decode time and bytes per session of the JSON and binary
+// encodings of the sessions stored in Redis by RedisStoreClient.
+// Usage: bench_session_serialization [num_subscribers] [sessions_per_sub]
+
+#include <lte/protos/pipelined.pb.h>
+#include <lte/protos/session_manager.pb.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "lte/gateway/c/session_manager/CreditKey.hpp"
+#include "lte/gateway/c/session_manager/StoredState.hpp"
+#include "lte/gateway/c/session_manager/Types.hpp"
+#include "lte/gateway/c/session_manager/test/ProtobufCreators.hpp"
+
+using namespace magma;
+
+static int64_t now_ns() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// Session with the state of a typical LTE subscriber: a few charging and
+// monitoring credits, static and dynamic rules and their bearers
+static StoredSessionState make_session(int sub, int index) {
+  StoredSessionState stored{};
+  std::string imsi = "IMSI00101000000" + std::to_string(1000 + sub);
+  Teids teids;
+  teids.set_agw_teid(2 * sub);
+  teids.set_enb_teid(2 * sub + 1);
+
+  stored.config.common_context =
+      build_common_context(imsi, "192.168.128.12", "2001:db8::12", teids,
+                           "magma.ipv4", "5100001234", TGPP_LTE);
+  stored.config.rat_specific_context.mutable_lte_context()->CopyFrom(
+      build_lte_context("192.168.60.142", "3533150000000", "00101", "00101",
+                        "user_location", 5, nullptr));
+  stored.imsi = imsi;
+  stored.session_id = imsi + "-" + std::to_string(index);
+  stored.session_level_key = "session_level_key";
+  stored.fsm_state = SESSION_ACTIVE;
+  stored.subscriber_quota_state = SubscriberQuotaUpdate_Type_VALID_QUOTA;
+  stored.tgpp_context.set_gx_dest_host("pcrf.magma.com");
+  stored.tgpp_context.set_gy_dest_host("ocs.magma.com");
+  stored.pdp_start_time = 1650000000;
+  stored.request_number = 12;
+  stored.revalidation_time.set_seconds(1650003600);
+  stored.pending_event_triggers[REVALIDATION_TIMEOUT] = PENDING;
+
+  stored.credit_map = StoredChargingCreditMap(4, &ccHash, &ccEqual);
+  for (uint32_t rg = 1; rg <= 4; rg++) {
+    StoredChargingGrant grant{};
+    grant.credit.credit_limit_type = FINITE;
+    grant.credit.grant_tracking_type = TOTAL_ONLY;
+    grant.credit.buckets[USED_TX] = 123456789;
+    grant.credit.buckets[USED_RX] = 987654321;
+    grant.credit.buckets[ALLOWED_TOTAL] = 2000000000;
+    grant.expiry_time = 1650003600;
+    stored.credit_map[CreditKey(rg, 0)] = grant;
+  }
+  for (int m = 0; m < 2; m++) {
+    StoredMonitor monitor{};
+    monitor.level = m == 0 ? SESSION_LEVEL : PCC_RULE_LEVEL;
+    monitor.credit.buckets[USED_TX] = 1234567;
+    monitor.credit.buckets[ALLOWED_TOTAL] = 10000000;
+    stored.monitor_map["mkey" + std::to_string(m)] = monitor;
+  }
+  for (int r = 0; r < 8; r++) {
+    std::string rule_id = "static_rule" + std::to_string(r);
+    stored.static_rule_ids.push_back(rule_id);
+    stored.policy_version_and_stats[rule_id] = StatsPerPolicy();
+    stored.policy_version_and_stats[rule_id].current_version = 1;
+    stored.bearer_id_by_policy[PolicyID(STATIC, rule_id)].bearer_id = 5 + r;
+  }
+  for (int r = 0; r < 2; r++) {
+    std::string rule_id = "dynamic_rule" + std::to_string(r);
+    stored.dynamic_rules.push_back(create_policy_rule(rule_id, "mkey1", r + 1));
+    stored.policy_version_and_stats[rule_id] = StatsPerPolicy();
+  }
+  return stored;
+}
+
+static void run(const char* name, SessionStoreEncoding encoding,
+                std::vector<std::vector<StoredSessionState>>& subscribers) {
+  std::vector<std::string> serialized;
+  size_t num_sessions = 0;
+  size_t num_bytes = 0;
+
+  int64_t start_ns = now_ns();
+  for (auto& sessions : subscribers) {
+    serialized.push_back(serialize_stored_session_vector(sessions, encoding));
+  }
+  int64_t encode_ns = now_ns() - start_ns;
+
+  start_ns = now_ns();
+  for (const auto& value : serialized) {
+    num_sessions += deserialize_stored_session_vector(value).size();
+    num_bytes += value.size();
+  }
+  int64_t decode_ns = now_ns() - start_ns;
+
+  printf("%-6s sessions=%zu encode=%.2fus/session decode=%.2fus/session "
+         "bytes=%zu/session\n",
+         name, num_sessions, encode_ns / 1e3 / num_sessions,
+         decode_ns / 1e3 / num_sessions, num_bytes / num_sessions);
+}
+
+int main(int argc, char** argv) {
+  int num_subscribers = argc > 1 ? atoi(argv[1]) : 10000;
+  int sessions_per_sub = argc > 2 ? atoi(argv[2]) : 2;
+
+  std::vector<std::vector<StoredSessionState>> subscribers(num_subscribers);
+  for (int sub = 0; sub < num_subscribers; sub++) {
+    for (int i = 0; i < sessions_per_sub; i++) {
+      subscribers[sub].push_back(make_session(sub, i));
+    }
+  }
+
+  run("json", JSON_ENCODING, subscribers);
+  run("binary", BINARY_ENCODING, subscribers);
+  return 0;
+}
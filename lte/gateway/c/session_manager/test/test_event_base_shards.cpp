@@ -0,0 +1,187 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <folly/io/async/EventBase.h>
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "lte/gateway/c/session_manager/EventBaseShards.hpp"
+
+using ::testing::Test;
+
+namespace magma {
+
+class EventBaseShardsTest : public ::testing::Test {
+ protected:
+  std::string get_imsi(int i) {
+    return "IMSI00101000000" + std::to_string(1000 + i);
+  }
+
+ protected:
+  folly::EventBase evb;
+};
+
+// The work of a subscriber runs in order on the thread of its shard
+TEST_F(EventBaseShardsTest, test_run_in_shard) {
+  EventBaseShards shards(&evb, 4);
+  shards.start();
+
+  const int num_subscribers = 32, tasks_per_subscriber = 100;
+  std::mutex mutex;
+  std::unordered_map<std::string, std::vector<int>> order;
+  std::unordered_map<std::string, std::thread::id> thread_ids;
+  bool same_thread = true;
+  for (int t = 0; t < tasks_per_subscriber; t++) {
+    for (int i = 0; i < num_subscribers; i++) {
+      const auto imsi = get_imsi(i);
+      shards.run_in_shard(imsi, [&, imsi, t]() {
+        EXPECT_TRUE(shards.in_shard());
+        std::lock_guard<std::mutex> lock(mutex);
+        order[imsi].push_back(t);
+        auto it = thread_ids.find(imsi);
+        if (it == thread_ids.end()) {
+          thread_ids[imsi] = std::this_thread::get_id();
+        } else if (it->second != std::this_thread::get_id()) {
+          same_thread = false;
+        }
+      });
+    }
+  }
+  // Returns once the work queued on every shard before is done
+  shards.run_with_shards_paused([]() {});
+
+  EXPECT_TRUE(same_thread);
+  EXPECT_FALSE(shards.in_shard());
+  EXPECT_EQ(order.size(), num_subscribers);
+  for (auto& it : order) {
+    EXPECT_EQ(it.second.size(), tasks_per_subscriber);
+    for (int t = 0; t < tasks_per_subscriber; t++) {
+      EXPECT_EQ(it.second[t], t);
+    }
+  }
+  shards.stop();
+}
+
+// Delayed work runs on the shard of the subscriber
+TEST_F(EventBaseShardsTest, test_run_after_delay) {
+  EventBaseShards shards(&evb, 4);
+  shards.start();
+  const auto imsi = get_imsi(1);
+
+  std::promise<std::thread::id> shard_thread, delayed_thread;
+  shards.run_in_shard(imsi, [&]() {
+    shard_thread.set_value(std::this_thread::get_id());
+  });
+  shards.run_after_delay(
+      imsi, [&]() { delayed_thread.set_value(std::this_thread::get_id()); },
+      10);
+  auto delayed_future = delayed_thread.get_future();
+  ASSERT_EQ(delayed_future.wait_for(std::chrono::seconds(5)),
+            std::future_status::ready);
+  EXPECT_EQ(delayed_future.get(), shard_thread.get_future().get());
+  shards.stop();
+}
+
+// No shard runs any work while the shards are paused
+TEST_F(EventBaseShardsTest, test_run_with_shards_paused) {
+  EventBaseShards shards(&evb, 4);
+  shards.start();
+
+  std::atomic<bool> exclusive(false);
+  std::atomic<int> ran(0), overlaps(0);
+  const int num_tasks = 2000;
+  for (int t = 0; t < num_tasks; t++) {
+    shards.run_in_shard(get_imsi(t % 64), [&]() {
+      if (exclusive) {
+        overlaps++;
+      }
+      ran++;
+    });
+    if (t % 200 == 0) {
+      shards.run_with_shards_paused([&]() {
+        exclusive = true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        exclusive = false;
+      });
+    }
+  }
+  shards.run_with_shards_paused([]() {});
+
+  EXPECT_EQ(ran, num_tasks);
+  EXPECT_EQ(overlaps, 0);
+  shards.stop();
+}
+
+// The exclusive work runs on the main event base
+TEST_F(EventBaseShardsTest, test_run_exclusive) {
+  EventBaseShards shards(&evb, 2);
+  shards.start();
+  std::thread main_thread([this]() { evb.loopForever(); });
+
+  std::promise<bool> in_main;
+  shards.run_exclusive([&]() { in_main.set_value(evb.isInEventBaseThread()); });
+  EXPECT_TRUE(in_main.get_future().get());
+
+  evb.terminateLoopSoon();
+  main_thread.join();
+  shards.stop();
+}
+
+// From a shard, the work waits for the main event base to pause every shard
+TEST_F(EventBaseShardsTest, test_run_with_shards_paused_from_shard) {
+  EventBaseShards shards(&evb, 2);
+  shards.start();
+  std::thread main_thread([this]() { evb.loopForever(); });
+
+  std::promise<bool> in_main;
+  shards.run_in_shard(get_imsi(1), [&]() {
+    shards.run_with_shards_paused(
+        [&]() { in_main.set_value(evb.isInEventBaseThread()); });
+  });
+  auto in_main_future = in_main.get_future();
+  ASSERT_EQ(in_main_future.wait_for(std::chrono::seconds(5)),
+            std::future_status::ready);
+  EXPECT_TRUE(in_main_future.get());
+
+  evb.terminateLoopSoon();
+  main_thread.join();
+  shards.stop();
+}
+
+// Without shards, all the work runs on the main event base
+TEST_F(EventBaseShardsTest, test_no_shards) {
+  EventBaseShards shards(&evb, 0);
+  shards.start();
+  EXPECT_EQ(shards.size(), 0);
+
+  std::vector<std::string> ran;
+  shards.run_in_shard(get_imsi(1), [&]() {
+    EXPECT_TRUE(evb.isInEventBaseThread());
+    ran.push_back("shard");
+  });
+  shards.run_exclusive([&]() { ran.push_back("exclusive"); });
+  shards.run_with_shards_paused([&]() { ran.push_back("paused"); });
+  EXPECT_EQ(ran, std::vector<std::string>({"paused"}));
+
+  evb.loop();
+  EXPECT_EQ(ran, std::vector<std::string>({"paused", "shard", "exclusive"}));
+  shards.stop();
+}
+
+}  // namespace magma
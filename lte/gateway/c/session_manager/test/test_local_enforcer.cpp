@@ -35,9 +35,12 @@
 #include <utility>
 #include <vector>
 
+#include "lte/gateway/c/session_manager/CachedStoreClient.hpp"
 #include "lte/gateway/c/session_manager/CreditKey.hpp"
 #include "lte/gateway/c/session_manager/DiameterCodes.hpp"
+#include "lte/gateway/c/session_manager/EventBaseShards.hpp"
 #include "lte/gateway/c/session_manager/LocalEnforcer.hpp"
+#include "lte/gateway/c/session_manager/MemoryStoreClient.hpp"
 #include "lte/gateway/c/session_manager/MeteringReporter.hpp"
 #include "lte/gateway/c/session_manager/RuleStore.hpp"
 #include "lte/gateway/c/session_manager/ServiceAction.hpp"
@@ -3432,6 +3435,62 @@ TEST_F(LocalEnforcerTest, test_receiving_stats_for_subset_of_rules) {
   EXPECT_EQ(1, session_map[IMSI1][0]->get_current_rule_version("rule2"));
 }
 
+TEST_F(LocalEnforcerTest, test_session_update_response_on_shards) {
+  // The sessions are only shared across threads through the cache
+  auto store_client = std::make_shared<lte::CachedStoreClient>(
+      std::make_shared<lte::MemoryStoreClient>(rule_store), lte::WRITE_BEHIND,
+      1000);
+  SessionStore sharded_store(rule_store, std::make_shared<MeteringReporter>(),
+                             store_client);
+  auto sharded_enforcer = std::make_unique<LocalEnforcer>(
+      reporter, rule_store, sharded_store, pipelined_client, events_reporter,
+      spgw_client, aaa_client, std::make_shared<ShardTracker>(), 0, 0,
+      get_default_mconfig());
+  sharded_enforcer->attachShards(std::make_shared<EventBaseShards>(evb, 2));
+
+  insert_static_rule(1, "", "rule1");
+  CreateSessionResponse response;
+  create_credit_update_response(IMSI1, SESSION_ID_1, 1, 1024,
+                                response.mutable_credits()->Add());
+  initialize_session(session_map, SESSION_ID_1, default_cfg_1, response);
+  initialize_session(session_map, SESSION_ID_2, default_cfg_2,
+                     CreateSessionResponse());
+  sharded_store.create_sessions(IMSI1, std::move(session_map[IMSI1]));
+  sharded_store.create_sessions(IMSI2, std::move(session_map[IMSI2]));
+
+  auto session_map_ptr = std::make_shared<SessionMap>(
+      sharded_store.read_sessions(SessionRead{IMSI1, IMSI2}));
+  auto session_uc = SessionStore::get_default_session_update(*session_map_ptr);
+  // IMSI2 was checked for reporting along with IMSI1, but only IMSI1 is in
+  // the request. The change to IMSI2 has to be saved on its shard as well.
+  auto& uc = session_uc[IMSI2][SESSION_ID_2];
+  uc.is_current_version_updated = true;
+  uc.updated_current_version = 5;
+
+  UpdateSessionRequest request;
+  auto usage = request.add_updates();
+  usage->mutable_common_context()->mutable_sid()->set_id(IMSI1);
+  usage->set_session_id(SESSION_ID_1);
+  usage->mutable_usage()->set_charging_key(1);
+  UpdateSessionResponse update_response;
+  create_credit_update_response(IMSI1, SESSION_ID_1, 1, 2048,
+                                update_response.add_responses());
+
+  auto& shards = sharded_enforcer->get_shards();
+  shards.start();
+  sharded_enforcer->handle_session_update_response(
+      request, session_map_ptr, session_uc, grpc::Status::OK, update_response);
+  // Returns once the update dispatched to the shards is handled
+  shards.run_with_shards_paused([]() {});
+  shards.stop();
+
+  auto stored_map = sharded_store.read_sessions(SessionRead{IMSI1, IMSI2});
+  assert_charging_credit(stored_map, IMSI1, SESSION_ID_1, ALLOWED_TOTAL,
+                         {{1, 3072}});
+  EXPECT_EQ(stored_map[IMSI2].size(), 1);
+  EXPECT_EQ(stored_map[IMSI2][0]->get_current_version(), 5);
+}
+
 TEST_F(LocalEnforcerTest, test_sharding_of_sessions) {
   // create 501 UEs and check whether they are sharded in to
   // six, add random amounts of sessions between 1 and 4
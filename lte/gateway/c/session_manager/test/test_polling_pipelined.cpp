@@ -11,12 +11,15 @@
  * limitations under the License.
  */
 #include <gmock/gmock.h>
+#include <grpcpp/impl/codegen/status.h>
 #include <gtest/gtest.h>
 #include <lte/protos/session_manager.pb.h>
 #include <stdint.h>
+#include <chrono>
 #include <functional>
 #include <memory>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <utility>
 
@@ -33,7 +36,6 @@
 
 namespace grpc {
 class ServerContext;
-class Status;
 }  // namespace grpc
 
 using grpc::ServerContext;
@@ -105,6 +107,26 @@ class LocalEnforcerStatsPollerTest : public ::testing::Test {
     session_map[imsi].push_back(std::move(session));
   }
 
+  // Creates a session of imsi with rule1 charged on rating group 1
+  void create_session_with_credit(const std::string& imsi, uint64_t volume) {
+    CreateSessionResponse response;
+    create_credit_update_response(imsi, SESSION_ID_1, 1, volume,
+                                  response.mutable_credits()->Add());
+    session_map = session_store->read_sessions(SessionRead{imsi});
+    initialize_session(session_map, SESSION_ID_1, get_default_config(imsi),
+                       response);
+    local_enforcer->update_tunnel_ids(
+        session_map,
+        create_update_tunnel_ids_request(imsi, BEARER_ID_1, teids1));
+    session_store->create_sessions(imsi, std::move(session_map[imsi]));
+  }
+
+  uint64_t get_used_credit(const std::string& imsi) {
+    session_map = session_store->read_sessions(SessionRead{imsi});
+    return session_map[imsi].front()->get_charging_credit(1, USED_TX) +
+           session_map[imsi].front()->get_charging_credit(1, USED_RX);
+  }
+
  protected:
   std::shared_ptr<MockSessionReporter> reporter;
   std::shared_ptr<StaticRuleStore> rule_store;
@@ -163,4 +185,72 @@ TEST_F(LocalEnforcerStatsPollerTest, test_poll_stats) {
       .Times(1);
   local_enforcer->poll_stats_enforcer(cookie, cookie_mask);
 }
+
+TEST_F(LocalEnforcerStatsPollerTest, test_adaptive_poll_interval) {
+  LocalEnforcer::POLL_STATS_MIN_INTERVAL_MS = 100;
+  LocalEnforcer::POLL_STATS_MAX_INTERVAL_MS = 60000;
+  LocalEnforcer::POLL_STATS_QUOTA_PROXIMITY_THRESHOLD = 0.8;
+  insert_static_rule(1, "", "rule1");
+  create_session_with_credit(IMSI1, 100000);
+  auto ue_ipv4 = test_cfg_.common_context.ue_ipv4();
+
+  // Polled at the minimum interval until the first stats are aggregated
+  EXPECT_EQ(local_enforcer->get_next_poll_interval().count(), 100);
+
+  RuleRecordTable table;
+  create_rule_record(IMSI1, ue_ipv4, "rule1", 0, 0,
+                     table.mutable_records()->Add());
+  local_enforcer->handle_pipelined_response(Status::OK, table);
+  EXPECT_EQ(local_enforcer->get_next_poll_interval().count(), 60000);
+
+  // 2000 bytes in at least 100ms, the 98000 bytes left last at least 4.9s
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  table.mutable_records(0)->set_bytes_tx(1000);
+  table.mutable_records(0)->set_bytes_rx(1000);
+  local_enforcer->handle_pipelined_response(Status::OK, table);
+  EXPECT_EQ(get_used_credit(IMSI1), 2000);
+  auto interval = local_enforcer->get_next_poll_interval().count();
+  EXPECT_GE(interval, 4900);
+  EXPECT_LT(interval, 60000);
+
+  // Over the quota proximity threshold
+  table.mutable_records(0)->set_bytes_tx(42500);
+  table.mutable_records(0)->set_bytes_rx(42500);
+  local_enforcer->handle_pipelined_response(Status::OK, table);
+  EXPECT_EQ(local_enforcer->get_next_poll_interval().count(), 100);
+
+  // A subscriber without traffic does not need to be polled
+  local_enforcer->handle_pipelined_response(Status::OK, table);
+  EXPECT_EQ(local_enforcer->get_next_poll_interval().count(), 60000);
+}
+
+TEST_F(LocalEnforcerStatsPollerTest, test_delta_only_stats) {
+  LocalEnforcer::POLL_STATS_DELTA_ONLY = true;
+  insert_static_rule(1, "", "rule1");
+  create_session_with_credit(IMSI1, 100000);
+  create_session_with_credit(IMSI2, 100000);
+  auto ue_ipv4 = test_cfg_.common_context.ue_ipv4();
+
+  RuleRecordTable table;
+  auto record_list = table.mutable_records();
+  create_rule_record(IMSI1, ue_ipv4, "rule1", 100, 200, record_list->Add());
+  create_rule_record(IMSI2, ue_ipv4, "rule1", 300, 400, record_list->Add());
+  // Flows of a subscriber without session are cleaned up on every poll
+  create_rule_record(IMSI3, ue_ipv4, "rule1", 10, 10, record_list->Add());
+  EXPECT_CALL(*pipelined_client, deactivate_flows_for_rules_for_termination(
+                                     IMSI3, testing::_, testing::_,
+                                     testing::_, testing::_))
+      .Times(2);
+
+  local_enforcer->handle_pipelined_response(Status::OK, table);
+  EXPECT_EQ(get_used_credit(IMSI1), 300);
+  EXPECT_EQ(get_used_credit(IMSI2), 700);
+
+  // Only the usage of IMSI1 changed
+  table.mutable_records(0)->set_bytes_tx(1100);
+  local_enforcer->handle_pipelined_response(Status::OK, table);
+  EXPECT_EQ(get_used_credit(IMSI1), 1300);
+  EXPECT_EQ(get_used_credit(IMSI2), 700);
+  LocalEnforcer::POLL_STATS_DELTA_ONLY = false;
+}
 }  // namespace magma
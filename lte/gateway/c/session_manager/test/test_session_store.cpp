@@ -645,4 +645,63 @@ TEST_F(SessionStoreTest, test_get_session) {
   auto optional_it7 = session_store->find_session(session_map, id7_success_sid);
   EXPECT_FALSE(optional_it7);
 }
+
+TEST_F(SessionStoreTest, test_session_index) {
+  SessionMap session_map = {};
+  Teids teid1;
+  teid1.set_enb_teid(0);
+  teid1.set_agw_teid(0);
+  Teids teid3;
+  teid3.set_enb_teid(TEID_3_DL);
+  teid3.set_agw_teid(TEID_3_UL);
+  Teids teid4;
+  teid4.set_enb_teid(TEID_4_DL);
+  teid4.set_agw_teid(TEID_4_UL);
+
+  // cwag session
+  session_map[IMSI1].push_back(
+      get_session(IMSI1, SESSION_ID_1, IP1, IPv6_1, teid1, "APN1"));
+  // lte sessions, the second one sharing the IPv6 address of the first
+  session_map[IMSI3].push_back(
+      get_lte_session(IMSI3, SESSION_ID_3, IP3, IPv6_3, teid3, "APN1"));
+  session_map[IMSI3].push_back(
+      get_lte_session(IMSI3, SESSION_ID_4, IP4, IPv6_3, teid4, "APN2"));
+  // 5G session
+  SessionConfig cfg;
+  cfg.common_context = build_common_context(IMSI2, IP2, IPv6_2, teid1, "APN1",
+                                            MSISDN, TGPP_NR);
+  cfg.rat_specific_context.mutable_m5gsm_session_context()
+      ->mutable_upf_endpoint()
+      ->set_teid_value(TEID_2_UL);
+  session_map[IMSI2].push_back(
+      std::make_unique<SessionState>(SESSION_ID_2, cfg, *rule_store, 12345));
+
+  SessionIndex session_index(session_map);
+  std::vector<SessionSearchCriteria> searches{
+      {IMSI1, IMSI_AND_UE_IPV4_OR_IPV6_OR_UPF_TEID, "", "", 0},
+      {IMSI3, IMSI_AND_UE_IPV4_OR_IPV6_OR_UPF_TEID, IP4, "", 0},
+      {IMSI3, IMSI_AND_UE_IPV4_OR_IPV6_OR_UPF_TEID, IP4, IPv6_3, 0},
+      {IMSI3, IMSI_AND_UE_IPV4_OR_IPV6_OR_UPF_TEID, "", IPv6_3, 0},
+      {IMSI2, IMSI_AND_UE_IPV4_OR_IPV6_OR_UPF_TEID, "", "", TEID_2_UL},
+      // Not found
+      {IMSI3, IMSI_AND_UE_IPV4_OR_IPV6_OR_UPF_TEID, IP1, IPv6_1, 0},
+      {IMSI2, IMSI_AND_UE_IPV4_OR_IPV6_OR_UPF_TEID, IP2, IPv6_2, TEID_1_UL},
+      {IMSI4, IMSI_AND_UE_IPV4_OR_IPV6_OR_UPF_TEID, IP1, IPv6_1, 0},
+  };
+  std::vector<std::string> expected{SESSION_ID_1, SESSION_ID_4, SESSION_ID_3,
+                                    SESSION_ID_3, SESSION_ID_2, "",
+                                    "",           ""};
+  for (size_t i = 0; i < searches.size(); i++) {
+    auto index_it = session_index.find_session(searches[i]);
+    auto scan_it = session_store->find_session(session_map, searches[i]);
+    ASSERT_EQ(static_cast<bool>(index_it), static_cast<bool>(scan_it));
+    if (expected[i].empty()) {
+      EXPECT_FALSE(index_it);
+      continue;
+    }
+    ASSERT_TRUE(index_it);
+    EXPECT_TRUE(*index_it == *scan_it);
+    EXPECT_EQ((**index_it)->get_session_id(), expected[i]);
+  }
+}
 }  // namespace magma
@@ -20,6 +20,7 @@
 #include <unordered_map>
 #include <utility>
 
+#include "lte/gateway/c/session_manager/CachedStoreClient.hpp"
 #include "lte/gateway/c/session_manager/MemoryStoreClient.hpp"
 #include "lte/gateway/c/session_manager/RuleStore.hpp"
 #include "lte/gateway/c/session_manager/SessionID.hpp"
@@ -36,6 +37,19 @@ namespace magma {
 
 class StoreClientTest : public ::testing::Test {
  protected:
+  std::unique_ptr<SessionState> make_session(const std::string& imsi,
+                                             const std::string& session_id,
+                                             StaticRuleStore& rule_store) {
+    SessionConfig cfg;
+    Teids teids;
+    cfg.common_context =
+        build_common_context(imsi, IP1, IPv6_1, teids, APN1, MSISDN, TGPP_WLAN);
+    auto session =
+        std::make_unique<SessionState>(session_id, cfg, rule_store, 12345);
+    session->set_fsm_state(SESSION_ACTIVE, nullptr);
+    return session;
+  }
+
   SessionIDGenerator id_gen_;
 };
 
@@ -157,6 +171,94 @@ TEST_F(StoreClientTest, test_read_and_write) {
       response3.DebugString());
 }
 
+/**
+ * CachedStoreClient in WRITE_BEHIND mode only reaches the backing store on
+ * flush, and then only with the subscribers written since the last flush.
+ */
+TEST_F(StoreClientTest, test_cached_store_client_write_behind) {
+  auto rule_store = std::make_shared<StaticRuleStore>();
+  auto backing_store = std::make_shared<MemoryStoreClient>(rule_store);
+  CachedStoreClient store_client(backing_store, WRITE_BEHIND, 1000);
+
+  SessionMap session_map;
+  session_map[IMSI1].push_back(make_session(IMSI1, SESSION_ID_1, *rule_store));
+  session_map[IMSI2].push_back(make_session(IMSI2, SESSION_ID_2, *rule_store));
+  EXPECT_TRUE(store_client.write_sessions(std::move(session_map)));
+
+  auto cached = store_client.read_all_sessions();
+  EXPECT_EQ(cached.size(), 2);
+  EXPECT_EQ(cached[IMSI1].front()->get_session_id(), SESSION_ID_1);
+  EXPECT_EQ(backing_store->read_all_sessions().size(), 0);
+
+  EXPECT_TRUE(store_client.flush());
+  auto backed = backing_store->read_all_sessions();
+  EXPECT_EQ(backed.size(), 2);
+  EXPECT_EQ(backed[IMSI2].front()->get_session_id(), SESSION_ID_2);
+
+  // Deleting IMSI1 is only propagated on the next flush
+  session_map = SessionMap{};
+  session_map[IMSI1] = SessionVector{};
+  EXPECT_TRUE(store_client.write_sessions(std::move(session_map)));
+  EXPECT_EQ(store_client.read_all_sessions().size(), 1);
+  EXPECT_EQ(backing_store->read_all_sessions().size(), 2);
+  EXPECT_TRUE(store_client.flush());
+  backed = backing_store->read_all_sessions();
+  EXPECT_EQ(backed.size(), 1);
+  EXPECT_EQ(backed.count(IMSI1), 0);
+}
+
+/**
+ * CachedStoreClient in WRITE_THROUGH mode keeps the backing store current,
+ * and recovers its state from the backing store on load.
+ */
+TEST_F(StoreClientTest, test_cached_store_client_write_through_and_load) {
+  auto rule_store = std::make_shared<StaticRuleStore>();
+  auto backing_store = std::make_shared<MemoryStoreClient>(rule_store);
+  {
+    CachedStoreClient store_client(backing_store, WRITE_THROUGH, 1000);
+    SessionMap session_map;
+    session_map[IMSI1].push_back(
+        make_session(IMSI1, SESSION_ID_1, *rule_store));
+    EXPECT_TRUE(store_client.write_sessions(std::move(session_map)));
+    auto backed = backing_store->read_sessions({IMSI1});
+    EXPECT_EQ(backed[IMSI1].size(), 1);
+    EXPECT_EQ(backed[IMSI1].front()->get_session_id(), SESSION_ID_1);
+  }
+
+  // Emulate a restart with a fresh cache over the same backing store
+  CachedStoreClient store_client(backing_store, WRITE_THROUGH, 1000);
+  EXPECT_EQ(store_client.read_all_sessions().size(), 0);
+  store_client.load();
+  auto cached = store_client.read_sessions({IMSI1, IMSI2});
+  EXPECT_EQ(cached[IMSI1].size(), 1);
+  EXPECT_EQ(cached[IMSI1].front()->get_session_id(), SESSION_ID_1);
+  EXPECT_EQ(cached[IMSI2].size(), 0);
+}
+
+/**
+ * CachedStoreClient returns copies of the sessions it keeps, changes to a
+ * read session are only cached once written back.
+ */
+TEST_F(StoreClientTest, test_cached_store_client_reads_copies) {
+  auto rule_store = std::make_shared<StaticRuleStore>();
+  auto backing_store = std::make_shared<MemoryStoreClient>(rule_store);
+  CachedStoreClient store_client(backing_store, WRITE_BEHIND, 1000);
+
+  SessionMap session_map;
+  session_map[IMSI1].push_back(make_session(IMSI1, SESSION_ID_1, *rule_store));
+  EXPECT_TRUE(store_client.write_sessions(std::move(session_map)));
+
+  auto read = store_client.read_sessions({IMSI1});
+  SessionStateUpdateCriteria uc;
+  read[IMSI1].front()->set_fsm_state(SESSION_RELEASED, &uc);
+  EXPECT_EQ(store_client.read_sessions({IMSI1})[IMSI1].front()->get_state(),
+            SESSION_ACTIVE);
+
+  EXPECT_TRUE(store_client.write_sessions(std::move(read)));
+  EXPECT_EQ(store_client.read_sessions({IMSI1})[IMSI1].front()->get_state(),
+            SESSION_RELEASED);
+}
+
 TEST_F(StoreClientTest, test_lambdas) {
   auto sm = std::make_unique<int>(1);
 
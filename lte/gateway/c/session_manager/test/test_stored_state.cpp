@@ -17,6 +17,7 @@
 #include <lte/protos/session_manager.pb.h>
 #include <algorithm>
 #include <cstdint>
+#include <stdexcept>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -372,6 +373,93 @@ TEST_F(StoredStateTest, test_stored_session) {
       40);
 }
 
+TEST_F(StoredStateTest, test_stored_session_vector_binary) {
+  std::vector<StoredSessionState> stored{get_stored_session(),
+                                         get_stored_session()};
+  stored[1].session_id = "session_id2";
+  stored[1].static_rule_ids.push_back("static_rule");
+  PolicyRule dynamic_rule;
+  dynamic_rule.set_id("dynamic_rule");
+  stored[1].dynamic_rules.push_back(dynamic_rule);
+
+  auto serialized = serialize_stored_session_vector(stored, BINARY_ENCODING);
+  EXPECT_LT(serialized.size(),
+            serialize_stored_session_vector(stored, JSON_ENCODING).size());
+  auto deserialized = deserialize_stored_session_vector(serialized);
+
+  ASSERT_EQ(deserialized.size(), 2);
+  EXPECT_EQ(deserialized[0].session_id, "session_id");
+  EXPECT_EQ(deserialized[1].session_id, "session_id2");
+  EXPECT_EQ(deserialized[1].config, get_stored_session_config());
+  EXPECT_EQ(deserialized[1].fsm_state, SESSION_RELEASED);
+  EXPECT_EQ(deserialized[1].imsi, "IMSI1");
+  EXPECT_EQ(deserialized[1].session_level_key, "session_level_key");
+  EXPECT_EQ(deserialized[1].subscriber_quota_state,
+            SubscriberQuotaUpdate_Type_VALID_QUOTA);
+  EXPECT_EQ(deserialized[1].tgpp_context.gy_dest_host(), "gy");
+  EXPECT_EQ(deserialized[1].pdp_start_time, 112233);
+  EXPECT_EQ(deserialized[1].pdp_end_time, 332211);
+  EXPECT_EQ(deserialized[1].request_number, 1);
+  EXPECT_EQ(deserialized[1].static_rule_ids,
+            std::vector<std::string>{"static_rule"});
+  ASSERT_EQ(deserialized[1].dynamic_rules.size(), 1);
+  EXPECT_EQ(deserialized[1].dynamic_rules[0].id(), "dynamic_rule");
+
+  auto grant = deserialized[1].credit_map[CreditKey(1, 2)];
+  EXPECT_EQ(grant.is_final, true);
+  EXPECT_EQ(grant.final_action_info.redirect_server.redirect_server_address(),
+            "redirect_server_address");
+  EXPECT_EQ(grant.reauth_state, REAUTH_REQUIRED);
+  EXPECT_EQ(grant.service_state, SERVICE_NEEDS_ACTIVATION);
+  EXPECT_EQ(grant.expiry_time, 32);
+  EXPECT_EQ(grant.credit.buckets[USED_TX], 12345);
+  EXPECT_EQ(grant.credit.buckets[ALLOWED_TOTAL], 54321);
+  EXPECT_EQ(grant.credit.credit_limit_type, INFINITE_METERED);
+  EXPECT_EQ(grant.credit.grant_tracking_type, TX_ONLY);
+
+  auto monitor = deserialized[1].monitor_map["mk1"];
+  EXPECT_EQ(monitor.credit.buckets[USED_TX], 12345);
+  EXPECT_EQ(monitor.level, MonitoringLevel::PCC_RULE_LEVEL);
+
+  EXPECT_EQ(deserialized[1].pending_event_triggers[REVALIDATION_TIMEOUT],
+            READY);
+  EXPECT_EQ(deserialized[1].revalidation_time.seconds(), 32);
+  EXPECT_EQ(deserialized[1].bearer_id_by_policy, get_bearer_id_by_policy());
+  EXPECT_EQ(
+      deserialized[1].policy_version_and_stats["rule2"].stats_map[2].dropped_rx,
+      40);
+}
+
+TEST_F(StoredStateTest, test_stored_session_vector_json_migration) {
+  std::vector<StoredSessionState> stored{get_stored_session()};
+
+  // Sessions written as JSON before the binary encoding are still read
+  auto serialized = serialize_stored_session_vector(stored, JSON_ENCODING);
+  EXPECT_EQ(serialized[0], '[');
+  auto deserialized = deserialize_stored_session_vector(serialized);
+
+  ASSERT_EQ(deserialized.size(), 1);
+  EXPECT_EQ(deserialized[0].session_id, "session_id");
+  EXPECT_EQ(deserialized[0].credit_map[CreditKey(1, 2)].credit.buckets[USED_TX],
+            12345);
+  EXPECT_EQ(deserialized[0].bearer_id_by_policy, get_bearer_id_by_policy());
+
+  // And rewritten in binary
+  auto rewritten = serialize_stored_session_vector(deserialized,
+                                                   BINARY_ENCODING);
+  EXPECT_EQ(deserialize_stored_session_vector(rewritten)[0].session_id,
+            "session_id");
+}
+
+TEST_F(StoredStateTest, test_stored_session_vector_unknown_version) {
+  std::vector<StoredSessionState> stored{get_stored_session()};
+
+  auto serialized = serialize_stored_session_vector(stored, BINARY_ENCODING);
+  serialized[1] = 0x7f;
+  EXPECT_THROW(deserialize_stored_session_vector(serialized),
+               std::invalid_argument);
+}
+
 TEST_F(StoredStateTest, test_policy_stats_map) {
   PolicyStatsMap original;
   StatsPerPolicy og_stats1, og_stats2;
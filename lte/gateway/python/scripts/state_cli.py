@@ -20,6 +20,7 @@ from typing import Union
 
 import fire
 import jsonpickle
+from google.protobuf.json_format import MessageToJson
 from lte.protos.keyval_pb2 import IPDesc
 from lte.protos.oai.mme_nas_state_pb2 import (
     MmeNasState,
@@ -33,6 +34,7 @@ from lte.protos.policydb_pb2 import (
     PolicyRule,
     SubscriberPolicySet,
 )
+from lte.protos.session_store_pb2 import StoredSessionVector
 from magma.common.redis.client import get_default_client
 from magma.common.redis.serializers import (
     get_json_deserializer,
@@ -45,6 +47,9 @@ from magma.mobilityd.serialize_utils import (
 )
 
 NO_DESERIAL_MSG = "No deserializer exists for type '{}'"
+# First byte of sessiond:sessions values in the binary encoding, followed by
+# the encoding version
+BINARY_SESSION_VECTOR_MAGIC = b'\x00'
 
 
 def _deserialize_session_json(serialized_json_str: bytes) -> str:
@@ -52,6 +57,11 @@ def _deserialize_session_json(serialized_json_str: bytes) -> str:
     Helper function to deserialize sessiond:sessions hash list values
     :param serialized_json_str
     """
+    if serialized_json_str[:1] == BINARY_SESSION_VECTOR_MAGIC:
+        # Binary encoding, see lte/protos/session_store.proto
+        sessions = StoredSessionVector()
+        sessions.ParseFromString(serialized_json_str[2:])
+        return MessageToJson(sessions, indent=2, sort_keys=True)
     res = _deserialize_generic_json(str(serialized_json_str, 'utf-8', 'ignore'))
     dumped = json.dumps(res, indent=2, sort_keys=True)
     return dumped
@@ -150,6 +150,7 @@ Status MagmaService::GetMetrics(__attribute__((unused)) ServerContext* context,
   setSharedMetrics();
 
   MetricsSingleton& instance = MetricsSingleton::Instance();
+  instance.MergeCounterHandles();
   const std::vector<MetricFamily>& collected = instance.registry_->Collect();
   for (auto it = collected.begin(); it != collected.end(); it++) {
     MetricFamily* family = response->add_family();
@@ -17,6 +17,8 @@
 
 #include "orc8r/gateway/c/common/service303/MetricsSingleton.hpp"  // for MetricsSingleton
 
+using magma::service303::CounterHandle;
+using magma::service303::GaugeHandle;
 using magma::service303::MetricsSingleton;
 
 void remove_counter(const char* name, size_t n_labels, ...) {
@@ -78,3 +80,40 @@ void observe_histogram(const char* name, double observation, size_t n_labels,
                                                 ap);
   va_end(ap);
 }
+
+counter_handle_t* get_counter_handle(const char* name, size_t n_labels, ...) {
+  va_list ap;
+  va_start(ap, n_labels);
+  CounterHandle* handle =
+      MetricsSingleton::Instance().GetCounterHandle(name, n_labels, ap);
+  va_end(ap);
+  return reinterpret_cast<counter_handle_t*>(handle);
+}
+
+void increment_counter_handle(counter_handle_t* handle, double increment) {
+  reinterpret_cast<CounterHandle*>(handle)->Increment(increment);
+}
+
+gauge_handle_t* get_gauge_handle(const char* name, size_t n_labels, ...) {
+  va_list ap;
+  va_start(ap, n_labels);
+  GaugeHandle* handle =
+      MetricsSingleton::Instance().GetGaugeHandle(name, n_labels, ap);
+  va_end(ap);
+  return reinterpret_cast<gauge_handle_t*>(handle);
+}
+
+void increment_gauge_handle(gauge_handle_t* handle, double increment) {
+  MetricsSingleton::Instance().IncrementGaugeHandle(
+      reinterpret_cast<GaugeHandle*>(handle), increment);
+}
+
+void decrement_gauge_handle(gauge_handle_t* handle, double decrement) {
+  MetricsSingleton::Instance().DecrementGaugeHandle(
+      reinterpret_cast<GaugeHandle*>(handle), decrement);
+}
+
+void set_gauge_handle(gauge_handle_t* handle, double value) {
+  MetricsSingleton::Instance().SetGaugeHandle(
+      reinterpret_cast<GaugeHandle*>(handle), value);
+}
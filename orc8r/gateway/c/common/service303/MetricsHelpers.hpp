@@ -19,6 +19,9 @@
 extern "C" {
 #endif
 
+typedef struct counter_handle_s counter_handle_t;
+typedef struct gauge_handle_s gauge_handle_t;
+
 /**
  * Remove the counter metric that matches name+labels given
  * @param name
@@ -90,6 +93,39 @@ double get_gauge(const char* name, size_t n_labels, ...);
 void observe_histogram(const char* name, double observation, size_t n_labels,
                        ...);
 
+/**
+ * Resolves the counter of this name and label set once, for the hot paths
+ * incrementing the same counter on every call. Increments through the handle
+ * skip the lookup of increment_counter and are lock free, they are added to
+ * the counter when the metrics are collected.
+ */
+counter_handle_t* get_counter_handle(const char* name, size_t n_labels, ...);
+
+void increment_counter_handle(counter_handle_t* handle, double increment);
+
+/**
+ * Resolves the gauge of this name and label set once, changes through the
+ * handle skip the lookup of the gauge
+ */
+gauge_handle_t* get_gauge_handle(const char* name, size_t n_labels, ...);
+
+void increment_gauge_handle(gauge_handle_t* handle, double increment);
+
+void decrement_gauge_handle(gauge_handle_t* handle, double decrement);
+
+void set_gauge_handle(gauge_handle_t* handle, double value);
+
 #ifdef __cplusplus
 }
+
+/**
+ * Increments a counter through a handle resolved on the first call from the
+ * call site, the name and labels must be the same on every call
+ */
+#define INCREMENT_COUNTER_HANDLE(name, increment, n_labels, ...)         \
+  do {                                                                   \
+    static counter_handle_t* const counter_handle_ =                     \
+        get_counter_handle(name, n_labels, ##__VA_ARGS__);               \
+    increment_counter_handle(counter_handle_, increment);                \
+  } while (0)
 #endif
@@ -22,10 +22,14 @@
 #include <prometheus/registry.h>
 #include <stdarg.h>
 #include <algorithm>
+#include <utility>
 #include <vector>
 
 #include "orc8r/gateway/c/common/service303/MetricsRegistry.hpp"
 
+using magma::service303::CounterHandle;
+using magma::service303::GaugeHandle;
+using magma::service303::MetricKey;
 using magma::service303::MetricsSingleton;
 using prometheus::BuildCounter;
 using prometheus::BuildGauge;
@@ -42,10 +46,64 @@ MetricsSingleton& MetricsSingleton::Instance() {
 }
 
 void MetricsSingleton::flush() {
+  // The handles are kept for the call sites holding them, their metrics are
+  // created again in the new registry when they are next changed
+  std::map<MetricKey, std::unique_ptr<CounterHandle>> counter_handles;
+  std::map<MetricKey, std::unique_ptr<GaugeHandle>> gauge_handles;
+  if (instance_ != nullptr) {
+    counter_handles = std::move(instance_->counter_handles_);
+    gauge_handles = std::move(instance_->gauge_handles_);
+  }
   delete instance_;
   instance_ = new MetricsSingleton();
+  for (auto& it : counter_handles) {
+    it.second->TakePending();
+    it.second->counter_ = nullptr;
+  }
+  for (auto& it : gauge_handles) {
+    it.second->gauge_ = nullptr;
+  }
+  instance_->counter_handles_ = std::move(counter_handles);
+  instance_->gauge_handles_ = std::move(gauge_handles);
+}
+
+static std::atomic<size_t> next_shard(0);
+
+static size_t thread_shard() {
+  static thread_local size_t shard = next_shard++ % COUNTER_HANDLE_SHARDS;
+  return shard;
 }
 
+CounterHandle::CounterHandle(const MetricKey& key, Counter* counter)
+    : key_(key), counter_(counter) {
+  for (auto& shard : shards_) {
+    shard.value.store(0);
+  }
+}
+
+void CounterHandle::Increment(double increment) {
+  if (increment < 0.0) {
+    return;
+  }
+  auto& value = shards_[thread_shard()].value;
+  // Only contended when more threads than shards increment the counter
+  double current = value.load(std::memory_order_relaxed);
+  while (!value.compare_exchange_weak(current, current + increment,
+                                      std::memory_order_relaxed)) {
+  }
+}
+
+double CounterHandle::TakePending() {
+  double pending = 0;
+  for (auto& shard : shards_) {
+    pending += shard.value.exchange(0, std::memory_order_relaxed);
+  }
+  return pending;
+}
+
+GaugeHandle::GaugeHandle(const MetricKey& key, Gauge* gauge)
+    : key_(key), gauge_(gauge) {}
+
 MetricsSingleton::MetricsSingleton()
     : registry_(std::make_shared<Registry>()),
       counters_(registry_, BuildCounter),
@@ -63,6 +121,12 @@ void MetricsSingleton::RemoveCounter(const char* name, size_t label_count,
                                      va_list& args) {
   std::map<std::string, std::string> labels;
   args_to_map(labels, label_count, args);
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto handle = counter_handles_.find({name, labels});
+  if (handle != counter_handles_.end()) {
+    handle->second->TakePending();
+    handle->second->counter_ = nullptr;
+  }
   counters_.Remove(name, labels);
 }
 
@@ -70,6 +134,7 @@ void MetricsSingleton::IncrementCounter(const char* name, double increment,
                                         size_t label_count, va_list& args) {
   std::map<std::string, std::string> labels;
   args_to_map(labels, label_count, args);
+  std::lock_guard<std::mutex> lock(mutex_);
   counters_.Get(name, labels).Increment(increment);
 }
 
@@ -77,6 +142,11 @@ void MetricsSingleton::RemoveGauge(const char* name, size_t label_count,
                                    va_list& args) {
   std::map<std::string, std::string> labels;
   args_to_map(labels, label_count, args);
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto handle = gauge_handles_.find({name, labels});
+  if (handle != gauge_handles_.end()) {
+    handle->second->gauge_ = nullptr;
+  }
   gauges_.Remove(name, labels);
 }
 
@@ -84,6 +154,7 @@ void MetricsSingleton::IncrementGauge(const char* name, double increment,
                                       size_t label_count, va_list& args) {
   std::map<std::string, std::string> labels;
   args_to_map(labels, label_count, args);
+  std::lock_guard<std::mutex> lock(mutex_);
   gauges_.Get(name, labels).Increment(increment);
 }
 
@@ -91,6 +162,7 @@ void MetricsSingleton::DecrementGauge(const char* name, double decrement,
                                       size_t label_count, va_list& args) {
   std::map<std::string, std::string> labels;
   args_to_map(labels, label_count, args);
+  std::lock_guard<std::mutex> lock(mutex_);
   gauges_.Get(name, labels).Decrement(decrement);
 }
 
@@ -98,6 +170,7 @@ void MetricsSingleton::SetGauge(const char* name, double value,
                                 size_t label_count, va_list& args) {
   std::map<std::string, std::string> labels;
   args_to_map(labels, label_count, args);
+  std::lock_guard<std::mutex> lock(mutex_);
   gauges_.Get(name, labels).Set(value);
 }
 
@@ -105,6 +178,7 @@ double MetricsSingleton::GetGauge(const char* name, size_t label_count,
                                   va_list& args) {
   std::map<std::string, std::string> labels;
   args_to_map(labels, label_count, args);
+  std::lock_guard<std::mutex> lock(mutex_);
   return gauges_.Get(name, labels).Value();
 }
 
@@ -118,6 +192,76 @@ void MetricsSingleton::ObserveHistogram(const char* name, double observation,
   for (size_t i = 0; i < boundary_count; i++) {
     boundaries.push_back(va_arg(args, double));
   }
+  std::lock_guard<std::mutex> lock(mutex_);
   histograms_.Get(name, labels, Histogram::BucketBoundaries(boundaries))
       .Observe(observation);
 }
+
+CounterHandle* MetricsSingleton::GetCounterHandle(const char* name,
+                                                 size_t label_count,
+                                                 va_list& args) {
+  std::map<std::string, std::string> labels;
+  args_to_map(labels, label_count, args);
+  MetricKey key(name, labels);
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& handle = counter_handles_[key];
+  if (handle == nullptr) {
+    handle.reset(new CounterHandle(key, &counters_.Get(name, labels)));
+  }
+  return handle.get();
+}
+
+GaugeHandle* MetricsSingleton::GetGaugeHandle(const char* name,
+                                             size_t label_count,
+                                             va_list& args) {
+  std::map<std::string, std::string> labels;
+  args_to_map(labels, label_count, args);
+  MetricKey key(name, labels);
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& handle = gauge_handles_[key];
+  if (handle == nullptr) {
+    handle.reset(new GaugeHandle(key, &gauges_.Get(name, labels)));
+  }
+  return handle.get();
+}
+
+Gauge* MetricsSingleton::ResolveGaugeHandle(GaugeHandle* handle) {
+  if (handle->gauge_ == nullptr) {
+    handle->gauge_ = &gauges_.Get(handle->key_.first, handle->key_.second);
+  }
+  return handle->gauge_;
+}
+
+// The gauge is changed under the lock, RemoveGauge frees it
+void MetricsSingleton::IncrementGaugeHandle(GaugeHandle* handle,
+                                            double increment) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ResolveGaugeHandle(handle)->Increment(increment);
+}
+
+void MetricsSingleton::DecrementGaugeHandle(GaugeHandle* handle,
+                                            double decrement) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ResolveGaugeHandle(handle)->Decrement(decrement);
+}
+
+void MetricsSingleton::SetGaugeHandle(GaugeHandle* handle, double value) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ResolveGaugeHandle(handle)->Set(value);
+}
+
+void MetricsSingleton::MergeCounterHandles() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto& it : counter_handles_) {
+    CounterHandle* handle = it.second.get();
+    double pending = handle->TakePending();
+    if (pending == 0) {
+      continue;
+    }
+    if (handle->counter_ == nullptr) {
+      const MetricKey& key = handle->key_;
+      handle->counter_ = &counters_.Get(key.first, key.second);
+    }
+    handle->counter_->Increment(pending);
+  }
+}
@@ -14,9 +14,12 @@
 
 #include <stdarg.h>  // for va_list
 #include <stddef.h>  // for size_t
+#include <atomic>    // for atomic
 #include <map>       // for map
 #include <memory>    // for shared_ptr
+#include <mutex>     // for mutex
 #include <string>    // for string
+#include <utility>   // for pair
 
 #include "orc8r/gateway/c/common/service303/MetricsRegistry.hpp"  // for MetricsRegistry, Registry
 
@@ -80,6 +83,59 @@ namespace service303 {
 // Forward decleration
 class MetricsSingleton;
 
+// Threads are spread over the shards of a counter handle in the order they
+// first increment a counter handle
+#define COUNTER_HANDLE_SHARDS 16
+#define CACHE_LINE_SIZE 64
+
+typedef std::map<std::string, std::string> MetricLabels;
+typedef std::pair<std::string, MetricLabels> MetricKey;
+
+/**
+ * CounterHandle is a counter resolved once by name and label set. Increments
+ * are added without locking to the shard of the calling thread, the shards
+ * are merged into the prometheus counter when the metrics are collected.
+ */
+class CounterHandle {
+  friend class MetricsSingleton;
+
+ public:
+  CounterHandle(const MetricKey& key, Counter* counter);
+  void Increment(double increment);
+
+ private:
+  struct Shard {
+    std::atomic<double> value;
+    // Keeps the shards of different threads on different cache lines
+    char padding[CACHE_LINE_SIZE - sizeof(std::atomic<double>)];
+  };
+  // Returns the sum of the increments since the last call
+  double TakePending();
+
+  const MetricKey key_;
+  // Null once the counter is removed, until it is incremented again
+  Counter* counter_;
+  Shard shards_[COUNTER_HANDLE_SHARDS];
+};
+
+/**
+ * GaugeHandle is a gauge resolved once by name and label set. The gauge is
+ * changed under the lock of the singleton, so that it cannot be removed
+ * meanwhile, the handle saves building and looking up the label set.
+ */
+class GaugeHandle {
+  friend class MetricsSingleton;
+
+ public:
+  GaugeHandle(const MetricKey& key, Gauge* gauge);
+
+ private:
+  const MetricKey key_;
+  // Null once the gauge is removed, until it is changed again. Protected by
+  // the mutex of the singleton.
+  Gauge* gauge_;
+};
+
 /*
  * MetricsSingleton is a singleton used to contain metrics registries and
  * interfaces to interact with unique prometheus timeseries each uniquely
@@ -104,6 +160,17 @@ class MetricsSingleton {
   void ObserveHistogram(const char* name, double observation,
                         size_t label_count, va_list& args);
   double GetGauge(const char* name, size_t label_count, va_list& args);
+  // Handles are owned by the singleton and stay valid across flush()
+  CounterHandle* GetCounterHandle(const char* name, size_t label_count,
+                                  va_list& args);
+  GaugeHandle* GetGaugeHandle(const char* name, size_t label_count,
+                              va_list& args);
+  void IncrementGaugeHandle(GaugeHandle* handle, double increment);
+  void DecrementGaugeHandle(GaugeHandle* handle, double decrement);
+  void SetGaugeHandle(GaugeHandle* handle, double value);
+  // Adds the increments of the counter handles to the counters, before the
+  // metrics are collected
+  void MergeCounterHandles();
 
  private:
   MetricsSingleton();                         // Prevent construction
@@ -118,6 +185,13 @@ class MetricsSingleton {
   MetricsRegistry<Counter, CounterBuilder (&)()> counters_;
   MetricsRegistry<Gauge, GaugeBuilder (&)()> gauges_;
   MetricsRegistry<Histogram, HistogramBuilder (&)()> histograms_;
+  // Called with mutex_ held
+  Gauge* ResolveGaugeHandle(GaugeHandle* handle);
+  // Protects the lookups of metrics by name, and the handles against their
+  // removal and merge
+  std::mutex mutex_;
+  std::map<MetricKey, std::unique_ptr<CounterHandle>> counter_handles_;
+  std::map<MetricKey, std::unique_ptr<GaugeHandle>> gauge_handles_;
   static MetricsSingleton* instance_;
 };
 
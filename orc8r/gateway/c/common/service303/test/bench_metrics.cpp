@@ -0,0 +1,79 @@
+/**
+ * Copyright 2022 The Magma Authors.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Compares the cost of incrementing a counter with increment_counter, which
+// looks the counter up by name and labels on every call, and through a
+// counter handle, with num_threads threads incrementing the same counter.
+// Usage: bench_metrics [increments_per_thread] [num_threads...]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "orc8r/gateway/c/common/service303/MetricsHelpers.hpp"
+#include "orc8r/gateway/c/common/service303/MetricsSingleton.hpp"
+
+using magma::service303::MetricsSingleton;
+
+// Increments with the labels of the MME counters, e.g. ue_attach results
+static void increment_by_name(int increments) {
+  for (int i = 0; i < increments; i++) {
+    increment_counter("bench_counter", 1, 2, "result", "failure", "cause",
+                      "emm_cause_illegal_ue");
+  }
+}
+
+static void increment_by_handle(int increments) {
+  for (int i = 0; i < increments; i++) {
+    INCREMENT_COUNTER_HANDLE("bench_counter", 1, 2, "result", "failure",
+                             "cause", "emm_cause_illegal_ue");
+  }
+}
+
+// Returns the time per increment in ns
+static double run(void (*increment)(int), int increments, int num_threads) {
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_threads; i++) {
+    threads.emplace_back(increment, increments);
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  MetricsSingleton::Instance().MergeCounterHandles();
+  std::chrono::duration<double, std::nano> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count() / ((double)increments * num_threads);
+}
+
+int main(int argc, char** argv) {
+  int increments = argc > 1 ? atoi(argv[1]) : 1000000;
+  std::vector<int> thread_counts;
+  for (int i = 2; i < argc; i++) {
+    thread_counts.push_back(atoi(argv[i]));
+  }
+  if (thread_counts.empty()) {
+    thread_counts = {1, 2, 4, 8};
+  }
+
+  printf("%d increments per thread\n", increments);
+  printf("%8s %14s %14s\n", "threads", "by_name_ns", "by_handle_ns");
+  for (int num_threads : thread_counts) {
+    double by_name = run(increment_by_name, increments, num_threads);
+    double by_handle = run(increment_by_handle, increments, num_threads);
+    printf("%8d %14.1f %14.1f\n", num_threads, by_name, by_handle);
+  }
+  return 0;
+}
@@ -28,6 +28,7 @@
 #include <memory>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include "orc8r/gateway/c/common/service303/MagmaService.hpp"
 #include "orc8r/gateway/c/common/service303/MetricsHelpers.hpp"
@@ -213,6 +214,66 @@ TEST_F(Service303Test, test_gauges) {
   EXPECT_EQ(gauge->value(), 10);
 }
 
+// Tests that the increments through counter handles from several threads are
+// merged into the counters read over gRPC.
+TEST_F(Service303Test, test_counter_handles) {
+  counter_handle_t* handle = get_counter_handle("test_counter", 1, "key", "v");
+  EXPECT_EQ(handle, get_counter_handle("test_counter", 1, "key", "v"));
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; i++) {
+    threads.emplace_back([handle]() {
+      for (int j = 0; j < 1000; j++) {
+        increment_counter_handle(handle, 1);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  increment_counter("test_counter", 2, 1, "key", "v");
+  MetricsContainer metrics_container;
+  EXPECT_EQ(0, service303_client->GetMetrics(&metrics_container));
+  const MetricFamily* family =
+      &Service303Test::findFamily(metrics_container, "test_counter");
+  EXPECT_EQ(family->metric().size(), 1);
+  EXPECT_EQ(family->metric().Get(0).counter().value(), 4002);
+
+  // The handle recreates the removed counter once incremented again
+  remove_counter("test_counter", 1, "key", "v");
+  increment_counter_handle(handle, 3);
+  EXPECT_EQ(0, service303_client->GetMetrics(&metrics_container));
+  family = &Service303Test::findFamily(metrics_container, "test_counter");
+  EXPECT_EQ(family->metric().Get(0).counter().value(), 3);
+}
+
+// Tests that gauges changed through handles are read over gRPC.
+TEST_F(Service303Test, test_gauge_handles) {
+  gauge_handle_t* handle = get_gauge_handle("test_gauge", NO_LABELS);
+  set_gauge_handle(handle, 10);
+  increment_gauge_handle(handle, 3);
+  decrement_gauge_handle(handle, 1);
+  MetricsContainer metrics_container;
+  EXPECT_EQ(0, service303_client->GetMetrics(&metrics_container));
+  EXPECT_EQ(Service303Test::findGauge(metrics_container, "test_gauge"), 12);
+
+  remove_gauge("test_gauge", NO_LABELS);
+  increment_gauge_handle(handle, 1);
+  EXPECT_EQ(get_gauge("test_gauge", NO_LABELS), 1);
+
+  // Removing the gauge while it is changed through the handle is safe
+  std::thread remover([]() {
+    for (int i = 0; i < 1000; i++) {
+      remove_gauge("test_gauge", NO_LABELS);
+    }
+  });
+  for (int i = 0; i < 1000; i++) {
+    set_gauge_handle(handle, i);
+  }
+  remover.join();
+  set_gauge_handle(handle, 5);
+  EXPECT_EQ(get_gauge("test_gauge", NO_LABELS), 5);
+}
+
 // Tests that Service303 can instrument histograms and read them over gRPC.
 TEST_F(Service303Test, test_histograms) {
   // First observation in a histogram without buckets